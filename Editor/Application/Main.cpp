@@ -2,13 +2,69 @@
 
 #include "Source/Application.hpp"
 
+#include "Backend/Utility.hpp"
+
+#include <spdlog/spdlog.h>
+
+#include <string_view>
+#include <cstdlib>
+#include <limits>
+
 #ifdef main 
 #	undef main
 
 #endif
 
-int main()
+int main(int argc, char** argv)
 {
-	auto application = Application();
+	// "--benchmark [frames] [image]" builds the UI without a window or a GPU, and reports how long the frames took. If an
+	// image is given, the last frame is rendered on the CPU and saved to it.
+	uint32_t benchmarkFrameCount = 0;
+	std::string_view benchmarkImage;
+	if (argc > 1 && std::string_view(argv[1]) == "--benchmark")
+	{
+		benchmarkFrameCount = 1000;
+		if (argc > 2)
+		{
+			// A count of 0 would launch the editor instead, so anything which isn't a positive number is rejected.
+			char* pEnd = nullptr;
+			const auto frameCount = std::strtoull(argv[2], &pEnd, 10);
+			if (pEnd == argv[2] || *pEnd != '\0' || argv[2][0] == '-' || frameCount == 0 || frameCount > std::numeric_limits<uint32_t>::max())
+			{
+				spdlog::error("Invalid benchmark frame count {}! It needs to be a positive number.", argv[2]);
+				return 1;
+			}
+
+			benchmarkFrameCount = static_cast<uint32_t>(frameCount);
+		}
+
+		benchmarkImage = argc > 3 ? argv[3] : "";
+	}
+
+	// "--present-mode <fifo|fifo-relaxed|mailbox|immediate>" and "--image-count <count>" set how the frames are presented,
+	// and "--measure-latency" logs the input latency. These can be changed from the view menu as well.
+	rapid::PresentSettings presentSettings;
+	bool measureLatency = false;
+	for (int i = 1; i < argc; i++)
+	{
+		const auto argument = std::string_view(argv[i]);
+		if (argument == "--present-mode" && i + 1 < argc)
+		{
+			const auto name = std::string_view(argv[++i]);
+			if (const auto presentMode = rapid::utility::ParsePresentMode(name))
+				presentSettings.m_PresentMode = *presentMode;
+
+			else
+				spdlog::warn("Unknown present mode {}, using {}.", name, rapid::utility::GetPresentModeName(presentSettings.m_PresentMode));
+		}
+
+		else if (argument == "--image-count" && i + 1 < argc)
+			presentSettings.m_ImageCount = static_cast<uint32_t>(std::strtoul(argv[++i], nullptr, 10));
+
+		else if (argument == "--measure-latency")
+			measureLatency = true;
+	}
+
+	auto application = Application(benchmarkFrameCount, benchmarkImage, presentSettings, measureLatency);
 	return 0;
-}
\ No newline at end of file
+}
@@ -0,0 +1,13 @@
+#version 450
+
+layout (location = 0) in vec4 inColor;
+layout (location = 1) in vec2 inEdge;
+
+layout (location = 0) out vec4 outColor;
+
+void main() 
+{
+	// The distance to the center line is interpolated across the strip, so the coverage falls off over a single pixel.
+	float coverage = clamp(inEdge.y + 0.5 - abs(inEdge.x), 0.0, 1.0);
+	outColor = vec4(inColor.rgb, inColor.a * coverage);
+}
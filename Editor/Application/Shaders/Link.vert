@@ -0,0 +1,51 @@
+#version 450
+
+// Per instance data. The links are cubic bezier curves from the start point (an output pin) to the end point (an input pin).
+layout (location = 0) in vec4 inPoints;
+layout (location = 1) in vec4 inColor;
+
+layout (push_constant) uniform PushConstants {
+	vec2 scale;
+	vec2 translate;
+	float thickness;
+	float segmentCount;
+} pushConstants;
+
+layout (location = 0) out vec4 outColor;
+layout (location = 1) out vec2 outEdge;
+
+out gl_PerVertex 
+{
+	vec4 gl_Position;   
+};
+
+void main() 
+{
+	// Every segment is a quad made of two triangles, with the corners (0, 1, 2) and (1, 2, 3).
+	int segment = gl_VertexIndex / 6;
+	int corner = gl_VertexIndex % 6;
+	int quadCorner = corner % 3 + corner / 3;
+
+	float t = (float(segment) + float(quadCorner / 2)) / pushConstants.segmentCount;
+	float side = float(quadCorner % 2) * 2.0 - 1.0;
+
+	// Same control points as ImNodes uses, so the curves match the interaction.
+	vec2 p0 = inPoints.xy;
+	vec2 p3 = inPoints.zw;
+	vec2 offset = vec2(0.25 * distance(p0, p3), 0.0);
+	vec2 p1 = p0 + offset;
+	vec2 p2 = p3 - offset;
+
+	float u = 1.0 - t;
+	vec2 position = (u * u * u) * p0 + (3.0 * u * u * t) * p1 + (3.0 * u * t * t) * p2 + (t * t * t) * p3;
+	vec2 tangent = (3.0 * u * u) * (p1 - p0) + (6.0 * u * t) * (p2 - p1) + (3.0 * t * t) * (p3 - p2);
+	tangent = length(tangent) > 0.0001 ? normalize(tangent) : vec2(1.0, 0.0);
+
+	// Extrude along the normal, with an extra pixel on each side for the anti-aliasing.
+	float halfThickness = pushConstants.thickness * 0.5;
+	float edgeDistance = side * (halfThickness + 1.0);
+
+	outColor = inColor;
+	outEdge = vec2(edgeDistance, halfThickness);
+	gl_Position = vec4((position + vec2(-tangent.y, tangent.x) * edgeDistance) * pushConstants.scale + pushConstants.translate, 0.0, 1.0);
+}
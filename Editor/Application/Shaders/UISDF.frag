@@ -0,0 +1,19 @@
+#version 450
+
+layout (binding = 0) uniform sampler2D fontSampler;
+
+layout (location = 0) in vec2 inUV;
+layout (location = 1) in vec4 inColor;
+
+layout (location = 0) out vec4 outColor;
+
+void main() 
+{
+	// The atlas stores the distance to the glyph edge, where 0.5 is the edge itself.
+	// Anti-alias over a single screen pixel, regardless of the scale the text is drawn at.
+	float edgeDistance = texture(fontSampler, inUV.st).a;
+	float width = max(fwidth(edgeDistance), 0.0001);
+	float coverage = clamp((edgeDistance - 0.5) / width + 0.5, 0.0, 1.0);
+
+	outColor = vec4(inColor.rgb, inColor.a * coverage);
+}
@@ -3,46 +3,250 @@
 #include "Application.hpp"
 
 #include "Backend/ImGuiNode.hpp"
+#include "Backend/SoftwareRenderer.hpp"
 #include "Frontend/Console.hpp"
 #include "Frontend/Globals.hpp"
 
+#include "Core/AllocationCounter.hpp"
+
 #include <imgui.h>
+#include <spdlog/spdlog.h>
+#include <SDL.h>
+
+#include <algorithm>
+#include <chrono>
 #include <fstream>
 
-Application::Application()
-	: m_Engine(rapid::GraphicsEngine())
-	, m_Window(rapid::Window(m_Engine, "Rapid Editor"))
-	, m_NodeEditor(__FILE__, {})
-	, m_Limiter(60)
+namespace
 {
-	// Create the node.
-	m_Window.createNode<rapid::ImGuiNode>();
+	/**
+	 * Benchmark frame structure.
+	 */
+	struct BenchmarkFrame final
+	{
+		double m_Milliseconds = 0.0;
+		uint64_t m_AllocationCount = 0;
+		uint64_t m_AllocatedBytes = 0;
+	};
+
+	/**
+	 * Get the refresh rate of the display a window is on.
+	 *
+	 * @param pWindow The window.
+	 * @return The refresh rate, or 0 if it's unknown.
+	 */
+	double GetRefreshRate(SDL_Window* pWindow)
+	{
+		SDL_DisplayMode displayMode = {};
+		if (SDL_GetCurrentDisplayMode(SDL_GetWindowDisplayIndex(pWindow), &displayMode) != 0)
+			return 0.0;
+
+		return static_cast<double>(displayMode.refresh_rate);
+	}
+
+	/**
+	 * Get the activity of a window.
+	 * The window counts as focused while any of the application's windows has the focus, like its viewports.
+	 *
+	 * @param pWindow The window.
+	 * @return The activity.
+	 */
+	rapid::FramePacer::Activity GetActivity(SDL_Window* pWindow)
+	{
+		if (SDL_GetWindowFlags(pWindow) & (SDL_WINDOW_MINIMIZED | SDL_WINDOW_HIDDEN))
+			return rapid::FramePacer::Activity::Minimized;
+
+		return SDL_GetKeyboardFocus() ? rapid::FramePacer::Activity::Focused : rapid::FramePacer::Activity::Unfocused;
+	}
+}
 
+Application::Application(uint32_t benchmarkFrameCount, std::string_view benchmarkImage, const rapid::PresentSettings& presentSettings, bool measureLatency)
+	: m_pEngine(benchmarkFrameCount == 0 ? std::make_unique<rapid::GraphicsEngine>() : nullptr)
+	, m_pWindow(m_pEngine ? std::make_unique<rapid::Window>(*m_pEngine, "Rapid Editor", presentSettings) : nullptr)
+	, m_pNullWindow(m_pEngine ? nullptr : std::make_unique<rapid::NullWindow>())
+	, m_NodeEditor(__FILE__, {})
+{
 	showSourceCode();
 
-	while (m_Window.pollEvents() && rapid::GetGlobals().m_ShouldRun)
+	if (m_pNullWindow)
+		runBenchmark(benchmarkFrameCount, benchmarkImage);
+
+	else
 	{
-		// Show the menu bar.
-		singleShot(m_MenuBar);
+		m_pWindow->setLatencyMeasurement(measureLatency);
+		run();
+	}
+}
+
+void Application::run()
+{
+	auto& window = *m_pWindow;
+	rapid::GetGlobals().m_pWindow = &window;
+	rapid::GetGlobals().m_pGraphicsEngine = m_pEngine.get();
+	rapid::GetGlobals().m_pFramePacer = &m_FramePacer;
 
-		// Show the file explorer in a single shot.
-		singleShot(m_FileExplorer);
+	// Create the node.
+	auto& imGuiNode = window.createNode<rapid::ImGuiNode>();
+	rapid::GetGlobals().m_pImGuiNode = &imGuiNode;
+	rapid::GetGlobals().m_pDistanceFieldFont = imGuiNode.getDistanceFieldFont();
+	rapid::GetGlobals().m_pImageLoader = &imGuiNode.getImageLoader();
 
-		// Show the code view.
-		singleShot(m_CodeView);
+	auto& profiler = window.getGpuProfiler();
+	while (window.pollEvents() && rapid::GetGlobals().m_ShouldRun)
+	{
+		const auto buildStart = rapid::GpuProfiler::clock_type::now();
+		showComponents();
 
-		// Show the node editor.
-		singleShot(m_NodeEditor);
+		// Add the requested fonts. The font atlas is rebuilt in the background.
+		for (auto& [file, size] : rapid::GetGlobals().m_FontRequests)
+			imGuiNode.addFont(std::move(file), size);
 
-		// Show the console.
-		singleShot(rapid::GetConsole());
+		rapid::GetGlobals().m_FontRequests.clear();
 
 		// Finally submit the frame.
-		m_Window.submitFrame();
+		window.submitFrame();
+		const auto buildEnd = rapid::GpuProfiler::clock_type::now();
+
+		// The display or the focus could have changed during the frame.
+		m_FramePacer.setRefreshRate(GetRefreshRate(window.getWindowHandle()));
+		m_FramePacer.setActivity(GetActivity(window.getWindowHandle()));
+		m_FramePacer.wait();
+
+		// The UI thread's frames are traced along with the GPU's.
+		if (profiler.isEnabled())
+		{
+			profiler.addCpuScope({ .m_Name = "Build frame", .m_Thread = "UI thread", .m_Start = buildStart, .m_End = buildEnd });
+			profiler.addCpuScope({ .m_Name = "Pace frame", .m_Thread = "UI thread", .m_Start = buildEnd, .m_End = rapid::GpuProfiler::clock_type::now() });
+		}
 	}
 
-	// Make sure to terminate the window when exiting.
-	m_Window.terminate();
+	// Make sure to terminate the window when exiting. The node and everything it owns go with it.
+	rapid::GetGlobals().m_pImageLoader = nullptr;
+	rapid::GetGlobals().m_pDistanceFieldFont = nullptr;
+	rapid::GetGlobals().m_pImGuiNode = nullptr;
+	rapid::GetGlobals().m_pFramePacer = nullptr;
+	rapid::GetGlobals().m_pGraphicsEngine = nullptr;
+	rapid::GetGlobals().m_pWindow = nullptr;
+	window.terminate();
+}
+
+void Application::runBenchmark(uint32_t frameCount, std::string_view image)
+{
+	using clock_type = std::chrono::high_resolution_clock;
+
+	auto& window = *m_pNullWindow;
+
+	std::vector<BenchmarkFrame> frames;
+	frames.reserve(frameCount);
+
+	for (uint32_t i = 0; i < frameCount && window.pollEvents(); i++)
+	{
+		// The first sample is taken after starting the frame, so it's counted as well.
+		const auto startAllocations = rapid::GetAllocationStatistics();
+		const auto startTime = clock_type::now();
+
+		showComponents();
+
+		// There's nothing to load fonts to.
+		rapid::GetGlobals().m_FontRequests.clear();
+
+		window.submitFrame();
+
+		const auto endTime = clock_type::now();
+		const auto endAllocations = rapid::GetAllocationStatistics();
+
+		frames.emplace_back(BenchmarkFrame{
+			.m_Milliseconds = std::chrono::duration<double, std::milli>(endTime - startTime).count(),
+			.m_AllocationCount = endAllocations.m_AllocationCount - startAllocations.m_AllocationCount,
+			.m_AllocatedBytes = endAllocations.m_AllocatedBytes - startAllocations.m_AllocatedBytes
+			});
+	}
+
+	if (frames.empty())
+		return;
+
+	// The first frame creates the windows and most of the persistent state, so it's reported on its own.
+	const auto& firstFrame = frames.front();
+	if constexpr (rapid::IsAllocationCountingEnabled)
+		spdlog::info("Benchmark: First frame took {:.3f} ms with {} allocations ({} bytes).", firstFrame.m_Milliseconds, firstFrame.m_AllocationCount, firstFrame.m_AllocatedBytes);
+
+	else
+		spdlog::info("Benchmark: First frame took {:.3f} ms. Allocations are only counted with the RAPID_COUNT_ALLOCATIONS option.", firstFrame.m_Milliseconds);
+
+	if (frames.size() > 1)
+	{
+		// The frame times are summarized the same way the frame pacer summarizes them.
+		auto frameTimes = rapid::FrameTimeHistory(static_cast<uint32_t>(frames.size() - 1));
+
+		double totalMilliseconds = 0.0;
+		uint64_t totalAllocations = 0, totalBytes = 0, maxAllocations = 0;
+		for (auto itr = frames.begin() + 1; itr != frames.end(); ++itr)
+		{
+			frameTimes.add(itr->m_Milliseconds);
+			totalMilliseconds += itr->m_Milliseconds;
+			totalAllocations += itr->m_AllocationCount;
+			totalBytes += itr->m_AllocatedBytes;
+			maxAllocations = std::max(maxAllocations, itr->m_AllocationCount);
+		}
+
+		const auto summary = frameTimes.summarize();
+		const auto sampleCount = static_cast<double>(frameTimes.size());
+		spdlog::info("Benchmark: {} frames, {:.3f} ms average, {:.3f} ms median, {:.3f} ms 99th percentile, {:.3f} ms max.", frameTimes.size(),
+			totalMilliseconds / sampleCount, summary.m_Median, summary.m_Percentile99, summary.m_Maximum);
+
+		if constexpr (rapid::IsAllocationCountingEnabled)
+		{
+			spdlog::info("Benchmark: {:.1f} allocations ({:.0f} bytes) per frame on average, {} at most.",
+				static_cast<double>(totalAllocations) / sampleCount, static_cast<double>(totalBytes) / sampleCount, maxAllocations);
+		}
+	}
+
+	const auto pDrawData = window.getDrawData();
+	if (!pDrawData)
+		return;
+
+	spdlog::info("Benchmark: The last frame has {} draw lists, {} vertices and {} indices.", pDrawData->CmdListsCount, pDrawData->TotalVtxCount, pDrawData->TotalIdxCount);
+
+	if (image.empty())
+		return;
+
+	// The draw data stays valid till the next frame begins, so it can be rendered after the loop.
+	auto renderer = rapid::SoftwareRenderer();
+
+	const auto startTime = clock_type::now();
+	renderer.render(*pDrawData, IM_COL32_BLACK);
+	const auto endTime = clock_type::now();
+
+	spdlog::info("Benchmark: Rendering the last frame on the CPU took {:.3f} ms for {} triangles.", std::chrono::duration<double, std::milli>(endTime - startTime).count(), renderer.getTriangleCount());
+
+	if (renderer.save(image))
+		spdlog::info("Benchmark: Saved the last frame to {}.", image);
+}
+
+void Application::showComponents()
+{
+	// Show the menu bar.
+	singleShot(m_MenuBar);
+
+	// Show the file explorer in a single shot.
+	singleShot(m_FileExplorer);
+
+	// Show the code view.
+	singleShot(m_CodeView);
+
+	// Show the node editor.
+	singleShot(m_NodeEditor);
+
+	// Show the console.
+	singleShot(rapid::GetConsole());
+
+	// Show the memory panel if it's enabled.
+	if (rapid::GetGlobals().m_ShowMemoryPanel)
+		singleShot(m_MemoryPanel);
+
+	// Show the profiler panel if it's enabled.
+	if (rapid::GetGlobals().m_ShowProfilerPanel)
+		singleShot(m_ProfilerPanel);
 }
 
 void Application::singleShot(rapid::UIComponent& component) const
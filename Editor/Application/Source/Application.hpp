@@ -3,14 +3,17 @@
 #pragma once
 
 #include "Core/UndoStack.hpp"
-#include "Core/Limiter.hpp"
+#include "Core/FramePacer.hpp"
 
 #include "Backend/Window.hpp"
+#include "Backend/NullWindow.hpp"
 
 #include "Frontend/FileExplorer.hpp"
 #include "Frontend/NodeEditor.hpp"
 #include "Frontend/MenuBar.hpp"
 #include "Frontend/CodeView.hpp"
+#include "Frontend/MemoryPanel.hpp"
+#include "Frontend/ProfilerPanel.hpp"
 
 /**
  * Application class.
@@ -20,11 +23,37 @@ class Application final
 {
 public:
 	/**
-	 * Default constructor.
+	 * Explicit constructor.
+	 * This runs the editor until it's closed.
+	 *
+	 * @param benchmarkFrameCount If not 0, the UI is built this many times using the null window instead, and the CPU
+	 * time and allocations of the frames are reported. Default is 0.
+	 * @param benchmarkImage If not empty, the last benchmark frame is rendered using the software renderer and saved to
+	 * this file. Default is empty.
+	 * @param presentSettings The window's present settings. These can be changed later from the view menu.
+	 * @param measureLatency Whether or not to measure and log the input latency. Default is false.
 	 */
-	Application();
+	explicit Application(uint32_t benchmarkFrameCount = 0, std::string_view benchmarkImage = "", const rapid::PresentSettings& presentSettings = {}, bool measureLatency = false);
 
 private:
+	/**
+	 * Run the editor.
+	 */
+	void run();
+
+	/**
+	 * Build the UI of the null window's frames and report their costs.
+	 *
+	 * @param frameCount The number of frames to build.
+	 * @param image The file to save the software rendered last frame to. Nothing is rendered if this is empty.
+	 */
+	void runBenchmark(uint32_t frameCount, std::string_view image);
+
+	/**
+	 * Show all the UI components.
+	 */
+	void showComponents();
+
 	/**
 	 * Show a UI component in a single shot.
 	 *
@@ -38,14 +67,17 @@ private:
 	void showSourceCode();
 
 private:
-	rapid::GraphicsEngine m_Engine;
-	rapid::Window m_Window;
+	std::unique_ptr<rapid::GraphicsEngine> m_pEngine = nullptr;
+	std::unique_ptr<rapid::Window> m_pWindow = nullptr;
+	std::unique_ptr<rapid::NullWindow> m_pNullWindow = nullptr;
 
 	rapid::UndoStack m_UndoStack;
-	rapid::Limiter m_Limiter;
+	rapid::FramePacer m_FramePacer;
 
 	rapid::FileExplorer m_FileExplorer;
 	rapid::NodeEditor m_NodeEditor;
 	rapid::MenuBar m_MenuBar;
 	rapid::CodeView m_CodeView;
+	rapid::MemoryPanel m_MemoryPanel;
+	rapid::ProfilerPanel m_ProfilerPanel;
 };
\ No newline at end of file
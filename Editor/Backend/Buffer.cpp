@@ -5,6 +5,29 @@
 
 #include <spdlog/spdlog.h>
 
+namespace
+{
+	/**
+	 * Get the memory category of a buffer type.
+	 *
+	 * @param type The buffer type.
+	 * @return The memory category.
+	 */
+	rapid::MemoryCategory GetMemoryCategory(rapid::BufferType type)
+	{
+		switch (type)
+		{
+		case rapid::BufferType::Vertex:			return rapid::MemoryCategory::VertexBuffer;
+		case rapid::BufferType::Index:			return rapid::MemoryCategory::IndexBuffer;
+		case rapid::BufferType::ShallowVertex:	return rapid::MemoryCategory::ShallowVertexBuffer;
+		case rapid::BufferType::ShallowIndex:	return rapid::MemoryCategory::ShallowIndexBuffer;
+		case rapid::BufferType::Uniform:		return rapid::MemoryCategory::UniformBuffer;
+		case rapid::BufferType::Staging:		return rapid::MemoryCategory::StagingBuffer;
+		default:								return rapid::MemoryCategory::ReadbackBuffer;
+		}
+	}
+}
+
 namespace rapid
 {
 	Buffer::Buffer(GraphicsEngine& engine, uint64_t size, BufferType type)
@@ -40,6 +63,11 @@ namespace rapid
 			vmaFlags = VMA_ALLOCATION_CREATE_HOST_ACCESS_SEQUENTIAL_WRITE_BIT;
 			break;
 
+		case BufferType::Readback:
+			memoryUsage = VMA_MEMORY_USAGE_AUTO_PREFER_HOST;
+			vmaFlags = VMA_ALLOCATION_CREATE_HOST_ACCESS_RANDOM_BIT;
+			break;
+
 		default:
 			spdlog::error("Invalid buffer type!");
 			return;
@@ -57,12 +85,18 @@ namespace rapid
 			.pQueueFamilyIndices = nullptr,
 		};
 
+		// The user data lets the defragmenter find the buffer of an allocation.
 		VmaAllocationCreateInfo vmaAllocationCreateInfo = {
 			.flags = vmaFlags,
 			.usage = memoryUsage,
+			.pUserData = this
 		};
 
-		utility::ValidateResult(vmaCreateBuffer(engine.getAllocator(), &crateInfo, &vmaAllocationCreateInfo, &m_Buffer, &m_Allocation, nullptr), "Failed to create the buffer!");
+		VmaAllocationInfo allocationInfo = {};
+		utility::ValidateResult(vmaCreateBuffer(engine.getAllocator(), &crateInfo, &vmaAllocationCreateInfo, &m_Buffer, &m_Allocation, &allocationInfo), "Failed to create the buffer!");
+
+		m_AllocationSize = allocationInfo.size;
+		m_Engine.getMemoryStatistics().add(GetMemoryCategory(m_Type), m_AllocationSize);
 	}
 
 	Buffer::~Buffer()
@@ -77,7 +111,21 @@ namespace rapid
 		if (m_IsMapped)
 			unmapMemory();
 
-		vmaDestroyBuffer(m_Engine.getAllocator(), m_Buffer, m_Allocation);
+		if (m_Allocation)
+			m_Engine.getMemoryStatistics().remove(GetMemoryCategory(m_Type), m_AllocationSize);
+
+		// The allocation can't be freed while it's being moved, so the allocator frees it when the pass ends.
+		if (m_pPendingMove)
+		{
+			m_Engine.getDeviceTable().vkDestroyBuffer(m_Engine.getLogicalDevice(), m_Buffer, nullptr);
+			m_pPendingMove->operation = VMA_DEFRAGMENTATION_MOVE_OPERATION_DESTROY;
+			m_pPendingMove = nullptr;
+		}
+		else
+		{
+			vmaDestroyBuffer(m_Engine.getAllocator(), m_Buffer, m_Allocation);
+		}
+
 		m_IsTerminated = true;
 	}
 
@@ -87,6 +135,7 @@ namespace rapid
 		utility::ValidateResult(vmaMapMemory(m_Engine.getAllocator(), m_Allocation, reinterpret_cast<void**>(&pDataPointer)), "Failed to map the buffer memory!");
 
 		m_IsMapped = true;
+		m_LastMappedFrame = m_Engine.getCurrentFrameIndex();
 		return pDataPointer;
 	}
 
@@ -100,6 +149,16 @@ namespace rapid
 		}
 	}
 
+	void Buffer::flushMemory(uint64_t offset, uint64_t size) const
+	{
+		utility::ValidateResult(vmaFlushAllocation(m_Engine.getAllocator(), m_Allocation, offset, size), "Failed to flush the buffer memory!");
+	}
+
+	void Buffer::invalidateMemory(uint64_t offset, uint64_t size) const
+	{
+		utility::ValidateResult(vmaInvalidateAllocation(m_Engine.getAllocator(), m_Allocation, offset, size), "Failed to invalidate the buffer memory!");
+	}
+
 	void Buffer::copyFrom(const Buffer& buffer)
 	{
 		// Validate the incoming buffer size.
@@ -121,4 +180,44 @@ namespace rapid
 		m_Engine.getDeviceTable().vkCmdCopyBuffer(vCommandBuffer, buffer.m_Buffer, m_Buffer, 1, &bufferCopy);
 		m_Engine.executeRecordedCommands();
 	}
+
+	bool Buffer::isMovable() const
+	{
+		if (m_IsMapped || m_pPendingMove)
+			return false;
+
+		return m_Type == BufferType::Vertex || m_Type == BufferType::Index || m_Type == BufferType::ShallowVertex || m_Type == BufferType::ShallowIndex;
+	}
+
+	VkBuffer Buffer::move(VmaDefragmentationMove& move, VkCommandBuffer vCommandBuffer)
+	{
+		const VkBufferCreateInfo createInfo = {
+			.sType = VK_STRUCTURE_TYPE_BUFFER_CREATE_INFO,
+			.pNext = nullptr,
+			.flags = 0,
+			.size = m_Size,
+			.usage = static_cast<VkBufferUsageFlags>(m_Type),
+			.sharingMode = VK_SHARING_MODE_EXCLUSIVE,
+			.queueFamilyIndexCount = 0,
+			.pQueueFamilyIndices = nullptr,
+		};
+
+		VkBuffer vBuffer = VK_NULL_HANDLE;
+		utility::ValidateResult(m_Engine.getDeviceTable().vkCreateBuffer(m_Engine.getLogicalDevice(), &createInfo, nullptr, &vBuffer), "Failed to create the moved buffer!");
+		utility::ValidateResult(vmaBindBufferMemory(m_Engine.getAllocator(), move.dstTmpAllocation, vBuffer), "Failed to bind the moved buffer memory!");
+
+		// Copy the contents over.
+		const VkBufferCopy bufferCopy = {
+			.srcOffset = 0,
+			.dstOffset = 0,
+			.size = m_Size
+		};
+
+		m_Engine.getDeviceTable().vkCmdCopyBuffer(vCommandBuffer, m_Buffer, vBuffer, 1, &bufferCopy);
+
+		const auto vOldBuffer = m_Buffer;
+		m_Buffer = vBuffer;
+		m_pPendingMove = &move;
+		return vOldBuffer;
+	}
 }
\ No newline at end of file
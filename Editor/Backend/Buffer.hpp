@@ -12,10 +12,12 @@ namespace rapid
 	enum class BufferType : uint32_t
 	{
 		// Used to store vertex data. Note that in order to supply data to this type, we need a staging buffer.
-		Vertex = VK_BUFFER_USAGE_VERTEX_BUFFER_BIT | VK_BUFFER_USAGE_TRANSFER_DST_BIT,
+		// The source usage lets the defragmenter copy the contents when moving it.
+		Vertex = VK_BUFFER_USAGE_VERTEX_BUFFER_BIT | VK_BUFFER_USAGE_TRANSFER_SRC_BIT | VK_BUFFER_USAGE_TRANSFER_DST_BIT,
 
 		// Used to store index data. Note that in order to supply data to this type, we need a staging buffer.
-		Index = VK_BUFFER_USAGE_INDEX_BUFFER_BIT | VK_BUFFER_USAGE_TRANSFER_DST_BIT,
+		// The source usage lets the defragmenter copy the contents when moving it.
+		Index = VK_BUFFER_USAGE_INDEX_BUFFER_BIT | VK_BUFFER_USAGE_TRANSFER_SRC_BIT | VK_BUFFER_USAGE_TRANSFER_DST_BIT,
 
 		// Used to store vertex data. Note that unlike the other, this can directly receive data.
 		ShallowVertex = VK_BUFFER_USAGE_VERTEX_BUFFER_BIT | VK_BUFFER_USAGE_TRANSFER_SRC_BIT | VK_BUFFER_USAGE_TRANSFER_DST_BIT,
@@ -27,7 +29,10 @@ namespace rapid
 		Uniform = VK_BUFFER_USAGE_UNIFORM_BUFFER_BIT | VK_BUFFER_USAGE_TRANSFER_SRC_BIT | VK_BUFFER_USAGE_TRANSFER_DST_BIT,
 
 		// Used for data transferring purposes.
-		Staging = VK_BUFFER_USAGE_TRANSFER_SRC_BIT | VK_BUFFER_USAGE_TRANSFER_DST_BIT
+		Staging = VK_BUFFER_USAGE_TRANSFER_SRC_BIT | VK_BUFFER_USAGE_TRANSFER_DST_BIT,
+
+		// Used to read data back from the device. The memory is host cached, so reading it is fast.
+		Readback = VK_BUFFER_USAGE_TRANSFER_DST_BIT
 	};
 
 	/**
@@ -68,6 +73,24 @@ namespace rapid
 		 */
 		void unmapMemory();
 
+		/**
+		 * Flush a range of the mapped memory, so the writes are visible to the device.
+		 * This is only required if the memory is not host coherent, and does nothing otherwise.
+		 *
+		 * @param offset The offset to flush from.
+		 * @param size The number of bytes to flush.
+		 */
+		void flushMemory(uint64_t offset, uint64_t size) const;
+
+		/**
+		 * Invalidate a range of the mapped memory, so the device writes are visible to the host.
+		 * This is only required if the memory is not host coherent, and does nothing otherwise.
+		 *
+		 * @param offset The offset to invalidate from.
+		 * @param size The number of bytes to invalidate.
+		 */
+		void invalidateMemory(uint64_t offset, uint64_t size) const;
+
 		/**
 		 * Copy content from another buffer to this.
 		 *
@@ -75,6 +98,42 @@ namespace rapid
 		 */
 		void copyFrom(const Buffer& buffer);
 
+		/**
+		 * Check if the buffer can be moved by the defragmenter.
+		 * Only the vertex and index buffers which are not mapped are moved, as the others are mapped or used by descriptors
+		 * which would need to be updated.
+		 *
+		 * @return Whether or not the buffer can be moved.
+		 */
+		bool isMovable() const;
+
+		/**
+		 * Move the buffer to the destination allocation of a defragmentation move.
+		 * This creates a new buffer in the allocation and records a copy of the contents. The allocation handle of this
+		 * object stays the same, as the allocator swaps the memory when the defragmentation pass ends. The buffer must not
+		 * be mapped till then.
+		 *
+		 * If the buffer is terminated before the pass ends, the move is marked to be destroyed, and the allocator frees the
+		 * memory when the pass ends.
+		 *
+		 * @param move The defragmentation move. This needs to stay valid till the pass ends.
+		 * @param vCommandBuffer The command buffer to record the copy to.
+		 * @return The old buffer. This needs to be destroyed once the copy is done.
+		 */
+		VkBuffer move(VmaDefragmentationMove& move, VkCommandBuffer vCommandBuffer);
+
+		/**
+		 * Complete the move once the defragmentation pass ends.
+		 */
+		void completeMove() { m_pPendingMove = nullptr; }
+
+		/**
+		 * Get the frame index the buffer was last mapped in.
+		 *
+		 * @return The frame index set in the graphics engine when the buffer was last mapped, or 0 if it was never mapped.
+		 */
+		uint32_t getLastMappedFrame() const { return m_LastMappedFrame; }
+
 		/**
 		 * Get the size of the buffer.
 		 *
@@ -101,6 +160,10 @@ namespace rapid
 
 		VkBuffer m_Buffer = VK_NULL_HANDLE;
 		VmaAllocation m_Allocation = nullptr;
+		VkDeviceSize m_AllocationSize = 0;
+
+		VmaDefragmentationMove* m_pPendingMove = nullptr;
+		uint32_t m_LastMappedFrame = 0;
 
 		const uint64_t m_Size;
 		const BufferType m_Type;
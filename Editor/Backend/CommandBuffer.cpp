@@ -35,24 +35,77 @@ namespace rapid
 
 	void CommandBuffer::bindWindow(const Window& window, const std::vector<VkClearValue>& vClearColors) const
 	{
-		VkRenderPassBeginInfo renderPassBeginInfo = {
-			.sType = VkStructureType::VK_STRUCTURE_TYPE_RENDER_PASS_BEGIN_INFO,
-			.pNext = VK_NULL_HANDLE,
-			.renderPass = window.getRenderPass(),
-			.framebuffer = window.getCurrentFrameBuffer(),
-			.renderArea = {
-				.extent = window.extent()
-			},
-			.clearValueCount = static_cast<uint32_t>(vClearColors.size()),
-			.pClearValues = vClearColors.data(),
-		};
+		if (m_Engine.isDynamicRenderingEnabled())
+		{
+			const VkRenderingAttachmentInfo colorAttachment = {
+				.sType = VK_STRUCTURE_TYPE_RENDERING_ATTACHMENT_INFO,
+				.pNext = nullptr,
+				.imageView = window.getCurrentImageView(),
+				.imageLayout = VK_IMAGE_LAYOUT_COLOR_ATTACHMENT_OPTIMAL,
+				.resolveMode = VK_RESOLVE_MODE_NONE,
+				.resolveImageView = VK_NULL_HANDLE,
+				.resolveImageLayout = VK_IMAGE_LAYOUT_UNDEFINED,
+				.loadOp = window.shouldLoadPreviousContent() || vClearColors.empty() ? VK_ATTACHMENT_LOAD_OP_LOAD : VK_ATTACHMENT_LOAD_OP_CLEAR,
+				.storeOp = VK_ATTACHMENT_STORE_OP_STORE,
+				.clearValue = vClearColors.empty() ? VkClearValue{} : vClearColors.front()
+			};
+
+			const VkRenderingInfo renderingInfo = {
+				.sType = VK_STRUCTURE_TYPE_RENDERING_INFO,
+				.pNext = nullptr,
+				.flags = 0,
+				.renderArea = window.getRenderArea(),
+				.layerCount = 1,
+				.viewMask = 0,
+				.colorAttachmentCount = 1,
+				.pColorAttachments = &colorAttachment,
+				.pDepthAttachment = nullptr,
+				.pStencilAttachment = nullptr
+			};
+
+			m_Engine.getDeviceTable().vkCmdBeginRendering(m_CommandBuffer, &renderingInfo);
+		}
+		else
+		{
+			VkRenderPassBeginInfo renderPassBeginInfo = {
+				.sType = VkStructureType::VK_STRUCTURE_TYPE_RENDER_PASS_BEGIN_INFO,
+				.pNext = VK_NULL_HANDLE,
+				.renderPass = window.getCurrentRenderPass(),
+				.framebuffer = window.getCurrentFrameBuffer(),
+				.renderArea = window.getRenderArea(),
+				.clearValueCount = static_cast<uint32_t>(vClearColors.size()),
+				.pClearValues = vClearColors.data(),
+			};
+
+			m_Engine.getDeviceTable().vkCmdBeginRenderPass(m_CommandBuffer, &renderPassBeginInfo, VkSubpassContents::VK_SUBPASS_CONTENTS_INLINE);
+		}
 
-		m_Engine.getDeviceTable().vkCmdBeginRenderPass(m_CommandBuffer, &renderPassBeginInfo, VkSubpassContents::VK_SUBPASS_CONTENTS_INLINE);
+		// If the previous contents are loaded, we need to clear the area we're about to redraw.
+		if (window.shouldLoadPreviousContent() && !vClearColors.empty())
+		{
+			const VkClearAttachment clearAttachment = {
+				.aspectMask = VK_IMAGE_ASPECT_COLOR_BIT,
+				.colorAttachment = 0,
+				.clearValue = vClearColors.front()
+			};
+
+			const VkClearRect clearRect = {
+				.rect = window.getRenderArea(),
+				.baseArrayLayer = 0,
+				.layerCount = 1
+			};
+
+			m_Engine.getDeviceTable().vkCmdClearAttachments(m_CommandBuffer, 1, &clearAttachment, 1, &clearRect);
+		}
 	}
 
 	void CommandBuffer::unbindWindow() const
 	{
-		m_Engine.getDeviceTable().vkCmdEndRenderPass(m_CommandBuffer);
+		if (m_Engine.isDynamicRenderingEnabled())
+			m_Engine.getDeviceTable().vkCmdEndRendering(m_CommandBuffer);
+
+		else
+			m_Engine.getDeviceTable().vkCmdEndRenderPass(m_CommandBuffer);
 	}
 
 	void CommandBuffer::bindPipeline(const GraphicsPipeline& pipeline) const
@@ -110,9 +163,9 @@ namespace rapid
 		m_Engine.getDeviceTable().vkCmdPushConstants(m_CommandBuffer, pipeline.getPipelineLayout(), flags, 0, static_cast<uint32_t>(size), pDataStore);
 	}
 
-	void CommandBuffer::drawVertices(const uint32_t vertexCount) const
+	void CommandBuffer::drawVertices(const uint32_t vertexCount, const uint32_t instanceCount) const
 	{
-		m_Engine.getDeviceTable().vkCmdDraw(m_CommandBuffer, vertexCount, 1, 0, 0);
+		m_Engine.getDeviceTable().vkCmdDraw(m_CommandBuffer, vertexCount, instanceCount, 0, 0);
 	}
 
 	void CommandBuffer::drawIndices(const uint32_t indexCount, const uint32_t indexOffset, const uint32_t vertexOffset) const
@@ -132,24 +185,28 @@ namespace rapid
 
 	void CommandBuffer::submit(VkSemaphore& vRenderFinishedSemaphore, VkSemaphore& vInFlightSemaphore, bool shouldWait)
 	{
-		VkPipelineStageFlags vWaitStageMask = VkPipelineStageFlagBits::VK_PIPELINE_STAGE_COLOR_ATTACHMENT_OUTPUT_BIT;
+		Submit(m_Engine, std::span(&m_CommandBuffer, 1), std::span(&vInFlightSemaphore, 1), std::span(&vRenderFinishedSemaphore, 1), shouldWait);
+	}
+
+	void CommandBuffer::Submit(GraphicsEngine& engine, std::span<const VkCommandBuffer> vCommandBuffers, std::span<const VkSemaphore> vWaitSemaphores, std::span<const VkSemaphore> vSignalSemaphores, bool shouldWait, VkFence vFence)
+	{
+		const auto vWaitStageMasks = std::vector<VkPipelineStageFlags>(vWaitSemaphores.size(), VkPipelineStageFlagBits::VK_PIPELINE_STAGE_COLOR_ATTACHMENT_OUTPUT_BIT);
 
 		// Create the submit info structure.
 		VkSubmitInfo submitInfo = {
 			.sType = VK_STRUCTURE_TYPE_SUBMIT_INFO,
-			.waitSemaphoreCount = 1,
-			.pWaitSemaphores = &vInFlightSemaphore,
-			.pWaitDstStageMask = &vWaitStageMask,
-			.commandBufferCount = 1,
-			.pCommandBuffers = &m_CommandBuffer,
-			.signalSemaphoreCount = 1,
-			.pSignalSemaphores = &vRenderFinishedSemaphore
+			.waitSemaphoreCount = static_cast<uint32_t>(vWaitSemaphores.size()),
+			.pWaitSemaphores = vWaitSemaphores.data(),
+			.pWaitDstStageMask = vWaitStageMasks.data(),
+			.commandBufferCount = static_cast<uint32_t>(vCommandBuffers.size()),
+			.pCommandBuffers = vCommandBuffers.data(),
+			.signalSemaphoreCount = static_cast<uint32_t>(vSignalSemaphores.size()),
+			.pSignalSemaphores = vSignalSemaphores.data()
 		};
 
-		VkFence vFence = VK_NULL_HANDLE;
-
-		// Create the fence if we need to wait.
-		if (shouldWait)
+		// Create a fence if we need to wait and none was given.
+		const auto isTemporaryFence = shouldWait && vFence == VK_NULL_HANDLE;
+		if (isTemporaryFence)
 		{
 			VkFenceCreateInfo fenceCreateInfo = {
 				.sType = VK_STRUCTURE_TYPE_FENCE_CREATE_INFO,
@@ -157,17 +214,20 @@ namespace rapid
 				.flags = 0
 			};
 
-			utility::ValidateResult(m_Engine.getDeviceTable().vkCreateFence(m_Engine.getLogicalDevice(), &fenceCreateInfo, nullptr, &vFence), "Failed to create the synchronization fence!");
+			utility::ValidateResult(engine.getDeviceTable().vkCreateFence(engine.getLogicalDevice(), &fenceCreateInfo, nullptr, &vFence), "Failed to create the synchronization fence!");
 		}
 
 		// Submit the queue.
-		utility::ValidateResult(m_Engine.getDeviceTable().vkQueueSubmit(m_Engine.getQueue().getGraphicsQueue(), 1, &submitInfo, vFence), "Failed to submit the queue!");
-
-		// Destroy the fence if we created it.
-		if (shouldWait)
 		{
-			utility::ValidateResult(m_Engine.getDeviceTable().vkWaitForFences(m_Engine.getLogicalDevice(), 1, &vFence, VK_TRUE, std::numeric_limits<uint64_t>::max()), "Failed to wait for the fence!");
-			m_Engine.getDeviceTable().vkDestroyFence(m_Engine.getLogicalDevice(), vFence, nullptr);
+			const auto lock = engine.lockQueue();
+			utility::ValidateResult(engine.getDeviceTable().vkQueueSubmit(engine.getQueue().getGraphicsQueue(), 1, &submitInfo, vFence), "Failed to submit the queue!");
 		}
+
+		if (shouldWait)
+			utility::ValidateResult(engine.getDeviceTable().vkWaitForFences(engine.getLogicalDevice(), 1, &vFence, VK_TRUE, std::numeric_limits<uint64_t>::max()), "Failed to wait for the fence!");
+
+		// Destroy the fence if we created it.
+		if (isTemporaryFence)
+			engine.getDeviceTable().vkDestroyFence(engine.getLogicalDevice(), vFence, nullptr);
 	}
 }
\ No newline at end of file
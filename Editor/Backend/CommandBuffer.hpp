@@ -4,6 +4,8 @@
 
 #include "GraphicsEngine.hpp"
 
+#include <span>
+
 namespace rapid
 {
 	class Window;
@@ -34,6 +36,8 @@ namespace rapid
 
 		/**
 		 * Bind a window to the command buffer.
+		 * This begins rendering to the window's current image over the window's current render area, using dynamic
+		 * rendering if it's enabled, or the window's render pass otherwise.
 		 *
 		 * @param window The window to bind.
 		 * @param vClearColors The screen clear color values.
@@ -103,8 +107,9 @@ namespace rapid
 		 * Draw vertices to the command buffer.
 		 *
 		 * @param vertexCount The vertex count to draw.
+		 * @param instanceCount The instance count to draw. Default is 1.
 		 */
-		void drawVertices(const uint32_t vertexCount) const;
+		void drawVertices(const uint32_t vertexCount, const uint32_t instanceCount = 1) const;
 
 		/**
 		 * Draw indices to the command buffer.
@@ -130,6 +135,21 @@ namespace rapid
 		 */
 		void submit(VkSemaphore& vRenderFinishedSemaphore, VkSemaphore& vInFlightSemaphore, bool shouldWait = false);
 
+		/**
+		 * Submit a batch of command buffers to the GPU using a single queue submission.
+		 * The command buffers are executed in the given order, and the wait semaphores are waited on before writing to
+		 * any color attachment.
+		 *
+		 * @param engine The engine to submit to.
+		 * @param vCommandBuffers The command buffers to submit.
+		 * @param vWaitSemaphores The semaphores to wait on.
+		 * @param vSignalSemaphores The semaphores to be signaled once every command buffer finishes.
+		 * @param shouldWait Whether or not to wait till the submission finishes. Default is false.
+		 * @param vFence The fence to be signaled once every command buffer finishes. It needs to be unsignaled. If this is
+		 * VK_NULL_HANDLE and the submission is waited on, a temporary fence is used. Default is VK_NULL_HANDLE.
+		 */
+		static void Submit(GraphicsEngine& engine, std::span<const VkCommandBuffer> vCommandBuffers, std::span<const VkSemaphore> vWaitSemaphores, std::span<const VkSemaphore> vSignalSemaphores, bool shouldWait = false, VkFence vFence = VK_NULL_HANDLE);
+
 		/**
 		 * Get the buffer primitive.
 		 *
@@ -0,0 +1,41 @@
+// Copyright (c) 2022 Dhiraj Wishal
+
+#include "DamageTracker.hpp"
+#include "Utility.hpp"
+
+namespace rapid
+{
+	void DamageTracker::reset(uint32_t imageCount, VkExtent2D extent)
+	{
+		m_Extent = extent;
+		m_DamagedAreas.assign(imageCount, VkRect2D{ .offset = {}, .extent = extent });
+		m_IsValid.assign(imageCount, false);
+	}
+
+	VkRect2D DamageTracker::addDamage(const VkRect2D& area)
+	{
+		const auto damage = utility::Intersect(area, VkRect2D{ .offset = {}, .extent = m_Extent });
+		if (utility::IsEmpty(damage))
+			return damage;
+
+		for (auto& damagedArea : m_DamagedAreas)
+			damagedArea = utility::Combine(damagedArea, damage);
+
+		return damage;
+	}
+
+	VkRect2D DamageTracker::getDamage(uint32_t imageIndex) const
+	{
+		// Invalid images need to be redrawn completely.
+		if (!m_IsValid[imageIndex])
+			return VkRect2D{ .offset = {}, .extent = m_Extent };
+
+		return m_DamagedAreas[imageIndex];
+	}
+
+	void DamageTracker::validate(uint32_t imageIndex)
+	{
+		m_DamagedAreas[imageIndex] = VkRect2D{};
+		m_IsValid[imageIndex] = true;
+	}
+}
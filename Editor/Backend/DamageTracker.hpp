@@ -0,0 +1,68 @@
+// Copyright (c) 2022 Dhiraj Wishal
+
+#pragma once
+
+#include <volk.h>
+
+#include <vector>
+
+namespace rapid
+{
+	/**
+	 * Damage tracker object.
+	 * This object keeps track of the regions of each swapchain image which are out of date. Since every swapchain image
+	 * holds the contents of the frame it was last rendered in, the damage of every frame rendered since then needs to be
+	 * redrawn when the image is reused.
+	 */
+	class DamageTracker final
+	{
+	public:
+		/**
+		 * Reset the tracker.
+		 * This will mark all the images as invalid so that they get fully redrawn.
+		 *
+		 * @param imageCount The number of swapchain images.
+		 * @param extent The extent of the images.
+		 */
+		void reset(uint32_t imageCount, VkExtent2D extent);
+
+		/**
+		 * Add the damaged region of a new frame.
+		 * The region is clamped to the image extent.
+		 *
+		 * @param area The damaged area.
+		 * @return The clamped area.
+		 */
+		VkRect2D addDamage(const VkRect2D& area);
+
+		/**
+		 * Get the area which needs to be redrawn in an image.
+		 *
+		 * @param imageIndex The image index.
+		 * @return The damaged area.
+		 */
+		VkRect2D getDamage(uint32_t imageIndex) const;
+
+		/**
+		 * Check if the image has valid contents from a previous frame.
+		 *
+		 * @param imageIndex The image index.
+		 * @return Whether or not the image contents can be reused.
+		 */
+		bool isValid(uint32_t imageIndex) const { return m_IsValid[imageIndex]; }
+
+		/**
+		 * Mark an image as up to date.
+		 * This needs to be called once the damaged area of the image is redrawn.
+		 *
+		 * @param imageIndex The image index.
+		 */
+		void validate(uint32_t imageIndex);
+
+	private:
+		std::vector<VkRect2D> m_DamagedAreas = {};
+		std::vector<bool> m_IsValid = {};
+
+		VkExtent2D m_Extent = {};
+	};
+}
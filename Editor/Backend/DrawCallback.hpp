@@ -0,0 +1,75 @@
+// Copyright (c) 2022 Dhiraj Wishal
+
+#pragma once
+
+#include "CommandBuffer.hpp"
+
+#include <imgui.h>
+
+namespace rapid
+{
+	/**
+	 * Draw callback class.
+	 * Objects implementing this can be added to ImGui draw lists, and are drawn with their own pipelines at that point of
+	 * the draw list. This is used for content which is a lot cheaper to generate on the GPU than as ImGui geometry.
+	 *
+	 * The scissor is set to the command's clip rect before drawing, and the ImGui render state is restored afterwards.
+	 * The contents are built on the UI thread and drawn on the render thread, so the drawn contents need to be kept apart
+	 * from the ones being built.
+	 */
+	class DrawCallback
+	{
+	public:
+		/**
+		 * Virtual destructor.
+		 */
+		virtual ~DrawCallback() = default;
+
+		/**
+		 * Draw the contents.
+		 *
+		 * @param commandBuffer The command buffer to record to.
+		 * @param scale The scale which converts screen space coordinates to clip space.
+		 * @param translate The translation which converts screen space coordinates to clip space.
+		 */
+		virtual void draw(CommandBuffer commandBuffer, const ImVec2& scale, const ImVec2& translate) = 0;
+
+		/**
+		 * Get the version of the contents being built on the UI thread.
+		 * This needs to change whenever the drawn contents change, so the damaged area gets redrawn.
+		 *
+		 * @return The version.
+		 */
+		virtual uint64_t getVersion() const = 0;
+
+		/**
+		 * Get the version of the contents the render thread draws.
+		 * This is the version of the last frame handed over to the render thread.
+		 *
+		 * @return The version.
+		 */
+		virtual uint64_t getFrameVersion() const = 0;
+
+		/**
+		 * Add the callback to a draw list.
+		 *
+		 * @param drawList The draw list to add to.
+		 */
+		void addTo(ImDrawList& drawList) { drawList.AddCallback(&Callback, this); }
+
+		/**
+		 * Get the draw callback of a draw command.
+		 *
+		 * @param command The draw command.
+		 * @return The draw callback pointer. This is nullptr if the command is not a draw callback.
+		 */
+		static DrawCallback* Get(const ImDrawCmd& command) { return command.UserCallback == &Callback ? static_cast<DrawCallback*>(command.UserCallbackData) : nullptr; }
+
+	private:
+		/**
+		 * The callback added to the draw lists.
+		 * This only identifies the command, the drawing is done by the renderer.
+		 */
+		static void Callback(const ImDrawList*, const ImDrawCmd*) {}
+	};
+}
@@ -0,0 +1,30 @@
+// Copyright (c) 2022 Dhiraj Wishal
+
+#include "DrawDataSnapshot.hpp"
+
+namespace rapid
+{
+	void DrawDataSnapshot::capture(const ImDrawData& drawData)
+	{
+		m_CommandListCount = static_cast<size_t>(drawData.CmdListsCount);
+		if (m_CommandLists.size() < m_CommandListCount)
+			m_CommandLists.resize(m_CommandListCount);
+
+		// Assigning keeps the capacity, so the lists only allocate when they grow.
+		for (size_t i = 0; i < m_CommandListCount; i++)
+		{
+			const auto pDrawList = drawData.CmdLists[static_cast<int32_t>(i)];
+			auto& commandList = m_CommandLists[i];
+
+			commandList.m_Commands.assign(pDrawList->CmdBuffer.begin(), pDrawList->CmdBuffer.end());
+			commandList.m_Vertices.assign(pDrawList->VtxBuffer.begin(), pDrawList->VtxBuffer.end());
+			commandList.m_Indices.assign(pDrawList->IdxBuffer.begin(), pDrawList->IdxBuffer.end());
+		}
+
+		m_DisplayPosition = drawData.DisplayPos;
+		m_DisplaySize = drawData.DisplaySize;
+		m_VertexCount = static_cast<uint64_t>(drawData.TotalVtxCount);
+		m_IndexCount = static_cast<uint64_t>(drawData.TotalIdxCount);
+		m_IsValid = true;
+	}
+}
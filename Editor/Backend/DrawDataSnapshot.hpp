@@ -0,0 +1,95 @@
+// Copyright (c) 2022 Dhiraj Wishal
+
+#pragma once
+
+#include <imgui.h>
+
+#include <span>
+#include <vector>
+
+namespace rapid
+{
+	/**
+	 * Draw data snapshot class.
+	 * This holds a deep copy of ImGui's draw data, so a frame can be rendered after ImGui moved on to the next one. The
+	 * buffers are reused between captures, so capturing a steady UI doesn't allocate.
+	 */
+	class DrawDataSnapshot final
+	{
+	public:
+		/**
+		 * Command list structure.
+		 * This is a copy of an ImDrawList's output buffers.
+		 */
+		struct CommandList final
+		{
+			std::vector<ImDrawCmd> m_Commands = {};
+			std::vector<ImDrawVert> m_Vertices = {};
+			std::vector<ImDrawIdx> m_Indices = {};
+		};
+
+	public:
+		/**
+		 * Capture the draw data.
+		 * Draw callbacks are copied as they are, so the objects they point to need to outlive the snapshot.
+		 *
+		 * @param drawData The draw data to copy.
+		 */
+		void capture(const ImDrawData& drawData);
+
+		/**
+		 * Check if the snapshot holds any draw data.
+		 *
+		 * @return Whether or not a frame was captured.
+		 */
+		bool isValid() const { return m_IsValid; }
+
+		/**
+		 * Get the captured command lists.
+		 *
+		 * @return The command lists.
+		 */
+		std::span<const CommandList> getCommandLists() const { return std::span(m_CommandLists.data(), m_CommandListCount); }
+
+		/**
+		 * Get the display position of the captured frame.
+		 * This is the top left corner of the viewport, which is not zero if the draw data is in desktop coordinates.
+		 *
+		 * @return The display position.
+		 */
+		ImVec2 getDisplayPosition() const { return m_DisplayPosition; }
+
+		/**
+		 * Get the display size of the captured frame.
+		 *
+		 * @return The display size.
+		 */
+		ImVec2 getDisplaySize() const { return m_DisplaySize; }
+
+		/**
+		 * Get the total number of vertices.
+		 *
+		 * @return The vertex count.
+		 */
+		uint64_t getVertexCount() const { return m_VertexCount; }
+
+		/**
+		 * Get the total number of indices.
+		 *
+		 * @return The index count.
+		 */
+		uint64_t getIndexCount() const { return m_IndexCount; }
+
+	private:
+		std::vector<CommandList> m_CommandLists = {};
+
+		ImVec2 m_DisplayPosition = {};
+		ImVec2 m_DisplaySize = {};
+
+		uint64_t m_VertexCount = 0;
+		uint64_t m_IndexCount = 0;
+		size_t m_CommandListCount = 0;
+
+		bool m_IsValid = false;
+	};
+}
@@ -0,0 +1,176 @@
+// Copyright (c) 2022 Dhiraj Wishal
+
+#include "FontAtlasBuilder.hpp"
+#include "FontAtlasCache.hpp"
+#include "Utility.hpp"
+
+#include "Core/StreamingCopy.hpp"
+
+#include <spdlog/spdlog.h>
+#include <SDL_events.h>
+
+#include <cstring>
+#include <limits>
+
+namespace
+{
+	// Only the alpha channel of a font atlas is needed, so atlases are stored as single channel images and swizzled to (1, 1, 1, alpha).
+	constexpr VkComponentMapping AlphaSwizzle = {
+		.r = VK_COMPONENT_SWIZZLE_ONE,
+		.g = VK_COMPONENT_SWIZZLE_ONE,
+		.b = VK_COMPONENT_SWIZZLE_ONE,
+		.a = VK_COMPONENT_SWIZZLE_R
+	};
+}
+
+namespace rapid
+{
+	FontAtlasBuilder::FontAtlasBuilder(GraphicsEngine& engine, const ImFontAtlas& source, std::vector<FontRequest>&& requests)
+		: m_Engine(engine)
+	{
+		auto pAtlas = IM_NEW(ImFontAtlas)();
+		pAtlas->Flags = source.Flags;
+		pAtlas->TexDesiredWidth = source.TexDesiredWidth;
+		pAtlas->TexGlyphPadding = source.TexGlyphPadding;
+		pAtlas->FontBuilderFlags = source.FontBuilderFlags;
+
+		// Copy the existing fonts. The new atlas owns a copy of the font data, since the source atlas will be destroyed once replaced.
+		for (const auto& sourceConfig : source.ConfigData)
+		{
+			auto config = sourceConfig;
+			config.FontData = IM_ALLOC(sourceConfig.FontDataSize);
+			config.FontDataOwnedByAtlas = true;
+			config.DstFont = nullptr;
+			std::memcpy(config.FontData, sourceConfig.FontData, sourceConfig.FontDataSize);
+
+			pAtlas->AddFont(&config);
+		}
+
+		m_Result = std::async(std::launch::async, [this, pAtlas, requests = std::move(requests)] { return build(pAtlas, requests); });
+	}
+
+	FontAtlasBuilder::~FontAtlasBuilder()
+	{
+		if (!m_Result.valid())
+			return;
+
+		auto result = m_Result.get();
+		result.m_Image->terminate();
+		IM_DELETE(result.m_pAtlas);
+	}
+
+	bool FontAtlasBuilder::isReady() const
+	{
+		return m_Result.valid() && m_Result.wait_for(std::chrono::seconds(0)) == std::future_status::ready;
+	}
+
+	FontAtlasBuilder::Result FontAtlasBuilder::get()
+	{
+		return m_Result.get();
+	}
+
+	FontAtlasBuilder::Result FontAtlasBuilder::build(ImFontAtlas* pAtlas, const std::vector<FontRequest>& requests) const
+	{
+		// Add the requested fonts.
+		for (const auto& request : requests)
+		{
+			if (!std::filesystem::exists(request.m_File))
+			{
+				spdlog::warn("The font file {} does not exist!", request.m_File.string());
+				continue;
+			}
+
+			pAtlas->AddFontFromFileTTF(request.m_File.string().c_str(), request.m_Size);
+		}
+
+		// Build the atlas (or load it from the cache) and copy the pixels to a staging buffer.
+		Result result = { .m_pAtlas = pAtlas };
+		{
+			const auto fontAtlasCache = FontAtlasCache(*pAtlas);
+			result.m_Image = std::make_unique<Image>(m_Engine, VkExtent3D{ fontAtlasCache.width(), fontAtlasCache.height(), 1u }, VkFormat::VK_FORMAT_R8_UNORM, AlphaSwizzle);
+
+			auto stagingBuffer = Buffer(m_Engine, result.m_Image->size(), BufferType::Staging);
+			StreamingCopy(stagingBuffer.mapMemory(), fontAtlasCache.data(), result.m_Image->size());
+			stagingBuffer.unmapMemory();
+
+			upload(*result.m_Image, stagingBuffer);
+		}
+
+		// We don't need the pixels on the CPU side anymore.
+		pAtlas->ClearTexData();
+
+		// Wake up the event loop so the atlas gets swapped in without waiting for any input.
+		SDL_Event sdlEvent = {};
+		sdlEvent.type = SDL_USEREVENT;
+		SDL_PushEvent(&sdlEvent);
+
+		return result;
+	}
+
+	void FontAtlasBuilder::upload(Image& image, const Buffer& stagingBuffer) const
+	{
+		const auto& deviceTable = m_Engine.getDeviceTable();
+		const auto logicalDevice = m_Engine.getLogicalDevice();
+
+		// Create the command pool and allocate the command buffer.
+		const VkCommandPoolCreateInfo commandPoolCreateInfo = {
+			.sType = VK_STRUCTURE_TYPE_COMMAND_POOL_CREATE_INFO,
+			.pNext = VK_NULL_HANDLE,
+			.flags = VK_COMMAND_POOL_CREATE_TRANSIENT_BIT,
+			.queueFamilyIndex = m_Engine.getQueue().getTransferFamily().value()
+		};
+
+		VkCommandPool commandPool = VK_NULL_HANDLE;
+		utility::ValidateResult(deviceTable.vkCreateCommandPool(logicalDevice, &commandPoolCreateInfo, nullptr, &commandPool), "Failed to create the command pool!");
+
+		const VkCommandBufferAllocateInfo allocateInfo = {
+			.sType = VK_STRUCTURE_TYPE_COMMAND_BUFFER_ALLOCATE_INFO,
+			.pNext = VK_NULL_HANDLE,
+			.commandPool = commandPool,
+			.level = VK_COMMAND_BUFFER_LEVEL_PRIMARY,
+			.commandBufferCount = 1,
+		};
+
+		VkCommandBuffer vCommandBuffer = VK_NULL_HANDLE;
+		utility::ValidateResult(deviceTable.vkAllocateCommandBuffers(logicalDevice, &allocateInfo, &vCommandBuffer), "Failed to allocate command buffer!");
+
+		// Record the copy.
+		const VkCommandBufferBeginInfo beginInfo = {
+			.sType = VkStructureType::VK_STRUCTURE_TYPE_COMMAND_BUFFER_BEGIN_INFO,
+			.pNext = nullptr,
+			.flags = VkCommandBufferUsageFlagBits::VK_COMMAND_BUFFER_USAGE_ONE_TIME_SUBMIT_BIT
+		};
+
+		utility::ValidateResult(deviceTable.vkBeginCommandBuffer(vCommandBuffer, &beginInfo), "Failed to begin command buffer recording!");
+		image.fromBuffer(stagingBuffer, vCommandBuffer);
+		image.changeImageLayout(VK_IMAGE_LAYOUT_SHADER_READ_ONLY_OPTIMAL, vCommandBuffer);
+		utility::ValidateResult(deviceTable.vkEndCommandBuffer(vCommandBuffer), "Failed to end command buffer recording!");
+
+		// Submit it and wait till it's done. We're on the worker thread, so waiting here is fine.
+		const VkFenceCreateInfo fenceCreateInfo = {
+			.sType = VkStructureType::VK_STRUCTURE_TYPE_FENCE_CREATE_INFO,
+			.pNext = VK_NULL_HANDLE,
+			.flags = 0
+		};
+
+		VkFence fence = VK_NULL_HANDLE;
+		utility::ValidateResult(deviceTable.vkCreateFence(logicalDevice, &fenceCreateInfo, nullptr, &fence), "Failed to create the synchronization fence!");
+
+		const VkSubmitInfo submitInfo = {
+			.sType = VkStructureType::VK_STRUCTURE_TYPE_SUBMIT_INFO,
+			.commandBufferCount = 1,
+			.pCommandBuffers = &vCommandBuffer
+		};
+
+		{
+			const auto lock = m_Engine.lockQueue();
+			utility::ValidateResult(deviceTable.vkQueueSubmit(m_Engine.getQueue().getTransferQueue(), 1, &submitInfo, fence), "Failed to submit the queue!");
+		}
+
+		utility::ValidateResult(deviceTable.vkWaitForFences(logicalDevice, 1, &fence, VK_TRUE, std::numeric_limits<uint64_t>::max()), "Failed to wait for the fence!");
+
+		deviceTable.vkDestroyFence(logicalDevice, fence, nullptr);
+		deviceTable.vkFreeCommandBuffers(logicalDevice, commandPool, 1, &vCommandBuffer);
+		deviceTable.vkDestroyCommandPool(logicalDevice, commandPool, nullptr);
+	}
+}
@@ -0,0 +1,98 @@
+// Copyright (c) 2022 Dhiraj Wishal
+
+#pragma once
+
+#include "Image.hpp"
+
+#include <imgui.h>
+
+#include <filesystem>
+#include <future>
+
+namespace rapid
+{
+	/**
+	 * Font request structure.
+	 * This contains the information needed to add a new font to the atlas.
+	 */
+	struct FontRequest final
+	{
+		std::filesystem::path m_File;
+		float m_Size = 0.0f;
+	};
+
+	/**
+	 * Font atlas builder class.
+	 * This builds a new font atlas containing the fonts of an existing atlas and the requested fonts on a worker thread.
+	 * Rasterizing the glyphs and uploading the atlas image are done on the worker thread, so the UI never stalls. Once
+	 * ready, the atlas and its image can be swapped in at a frame boundary.
+	 */
+	class FontAtlasBuilder final
+	{
+	public:
+		/**
+		 * Build result structure.
+		 */
+		struct Result final
+		{
+			ImFontAtlas* m_pAtlas = nullptr;	// Allocated using IM_NEW, so it can be owned by the ImGui context.
+			std::unique_ptr<Image> m_Image = nullptr;
+		};
+
+		/**
+		 * Explicit constructor.
+		 * The configuration of the source atlas is copied on the calling thread, so the source atlas can be used as usual
+		 * while the new atlas is being built.
+		 *
+		 * @param engine The graphics engine.
+		 * @param source The source atlas.
+		 * @param requests The fonts to add.
+		 */
+		explicit FontAtlasBuilder(GraphicsEngine& engine, const ImFontAtlas& source, std::vector<FontRequest>&& requests);
+
+		/**
+		 * Destructor.
+		 * This will wait till the worker is done, and will destroy the result if it was not taken.
+		 */
+		~FontAtlasBuilder();
+
+		/**
+		 * Check if the atlas is built and uploaded.
+		 *
+		 * @return Whether or not the result is ready.
+		 */
+		bool isReady() const;
+
+		/**
+		 * Get the result.
+		 * This will block till the result is ready.
+		 *
+		 * @return The result.
+		 */
+		[[nodiscard]] Result get();
+
+	private:
+		/**
+		 * Build the atlas and upload it to an image.
+		 * This runs on the worker thread.
+		 *
+		 * @param pAtlas The atlas to build.
+		 * @param requests The fonts to add.
+		 * @return The build result.
+		 */
+		Result build(ImFontAtlas* pAtlas, const std::vector<FontRequest>& requests) const;
+
+		/**
+		 * Upload the atlas pixels to the image.
+		 * This uses its own command buffer, since the utility command buffer of the engine cannot be used from another thread.
+		 *
+		 * @param image The image to upload to.
+		 * @param stagingBuffer The staging buffer containing the pixels.
+		 */
+		void upload(Image& image, const Buffer& stagingBuffer) const;
+
+	private:
+		GraphicsEngine& m_Engine;
+		std::future<Result> m_Result;
+	};
+}
@@ -0,0 +1,394 @@
+// Copyright (c) 2022 Dhiraj Wishal
+
+#include "FontAtlasCache.hpp"
+
+#include "Core/Hash.hpp"
+
+#include <spdlog/spdlog.h>
+
+#include <algorithm>
+#include <cstring>
+#include <fstream>
+#include <sstream>
+
+namespace
+{
+	constexpr uint32_t CacheMagic = 0x43414652;	// "RFAC"
+	constexpr uint32_t CacheVersion = 1;
+
+	/**
+	 * Cache file header.
+	 */
+	struct CacheHeader final
+	{
+		uint32_t m_Magic = CacheMagic;
+		uint32_t m_Version = CacheVersion;
+		uint64_t m_Key = 0;
+
+		uint32_t m_Width = 0;
+		uint32_t m_Height = 0;
+		uint32_t m_FontCount = 0;
+		uint32_t m_CustomRectCount = 0;
+
+		ImVec2 m_UvScale = {};
+		ImVec2 m_UvWhitePixel = {};
+		ImVec4 m_UvLines[IM_DRAWLIST_TEX_LINES_WIDTH_MAX + 1] = {};
+
+		int32_t m_PackIdMouseCursors = -1;
+		int32_t m_PackIdLines = -1;
+	};
+
+	/**
+	 * Font header.
+	 * This is followed by the font's glyphs.
+	 */
+	struct FontHeader final
+	{
+		float m_FontSize = 0.0f;
+		float m_Ascent = 0.0f;
+		float m_Descent = 0.0f;
+		int32_t m_MetricsTotalSurface = 0;
+
+		uint32_t m_FallbackChar = 0;
+		uint32_t m_EllipsisChar = 0;
+		uint32_t m_GlyphCount = 0;
+	};
+
+	/**
+	 * Custom rect entry.
+	 * The font pointer is stored as an index to the atlas' fonts.
+	 */
+	struct CustomRect final
+	{
+		uint16_t m_Width = 0;
+		uint16_t m_Height = 0;
+		uint16_t m_X = 0;
+		uint16_t m_Y = 0;
+		uint32_t m_GlyphID = 0;
+		float m_GlyphAdvanceX = 0.0f;
+		ImVec2 m_GlyphOffset = {};
+		int32_t m_FontIndex = -1;
+	};
+
+	/**
+	 * Reader object.
+	 * This is used to read data from the mapped file while making sure we don't go out of bounds.
+	 */
+	class Reader final
+	{
+	public:
+		/**
+		 * Explicit constructor.
+		 *
+		 * @param pData The data pointer.
+		 * @param size The data size.
+		 */
+		explicit Reader(const std::byte* pData, uint64_t size) : m_pData(pData), m_Size(size) {}
+
+		/**
+		 * Read a number of bytes.
+		 *
+		 * @param pDestination The destination pointer.
+		 * @param size The number of bytes to read.
+		 * @return Whether or not the data was available.
+		 */
+		bool read(void* pDestination, uint64_t size)
+		{
+			const auto pSource = skip(size);
+			if (!pSource)
+				return false;
+
+			std::memcpy(pDestination, pSource, size);
+			return true;
+		}
+
+		/**
+		 * Skip a number of bytes.
+		 *
+		 * @param size The number of bytes to skip.
+		 * @return The pointer to the skipped bytes. This will be nullptr if the data was not available.
+		 */
+		const std::byte* skip(uint64_t size)
+		{
+			if (m_Size - m_Offset < size)
+				return nullptr;
+
+			const auto pData = m_pData + m_Offset;
+			m_Offset += size;
+			return pData;
+		}
+
+	private:
+		const std::byte* m_pData = nullptr;
+		uint64_t m_Size = 0;
+		uint64_t m_Offset = 0;
+	};
+
+	/**
+	 * Write a trivially copyable value to a stream.
+	 *
+	 * @param stream The stream to write to.
+	 * @param value The value to write.
+	 */
+	template<class Type>
+	void Write(std::ofstream& stream, const Type& value)
+	{
+		stream.write(reinterpret_cast<const char*>(&value), sizeof(Type));
+	}
+}
+
+namespace rapid
+{
+	FontAtlasCache::FontAtlasCache(ImFontAtlas& atlas)
+		: m_Atlas(atlas)
+	{
+		const auto key = computeKey();
+
+		std::stringstream fileName;
+		fileName << "FontAtlas-" << std::hex << key << ".bin";
+
+		const auto path = std::filesystem::current_path() / "Cache" / fileName.str();
+
+		// Try and load the atlas from the cache.
+		if (load(path, key))
+		{
+			m_IsCacheHit = true;
+			return;
+		}
+
+		// If not, we need to build it and store it for the next time.
+		m_Atlas.Build();
+
+		uint8_t* pPixels = nullptr;
+		int32_t width = 0, height = 0;
+		m_Atlas.GetTexDataAsAlpha8(&pPixels, &width, &height);
+
+		m_pPixels = reinterpret_cast<const std::byte*>(pPixels);
+		m_Width = static_cast<uint32_t>(width);
+		m_Height = static_cast<uint32_t>(height);
+
+		store(path, key);
+	}
+
+	uint64_t FontAtlasCache::computeKey() const
+	{
+		uint64_t hash = HashValue(CacheVersion);
+		hash = HashValue(IMGUI_VERSION_NUM, hash);
+		hash = HashValue(sizeof(ImFontGlyph), hash);
+		hash = HashValue(sizeof(ImWchar), hash);
+
+		// Hash the atlas configuration.
+		hash = HashValue(m_Atlas.Flags, hash);
+		hash = HashValue(m_Atlas.TexDesiredWidth, hash);
+		hash = HashValue(m_Atlas.TexGlyphPadding, hash);
+		hash = HashValue(m_Atlas.FontBuilderFlags, hash);
+		hash = HashValue(m_Atlas.Fonts.Size, hash);
+
+		// Hash the font data and the configuration of every font.
+		for (const auto& config : m_Atlas.ConfigData)
+		{
+			hash = HashBytes(config.FontData, config.FontDataSize, hash);
+			hash = HashValue(config.FontNo, hash);
+			hash = HashValue(config.SizePixels, hash);
+			hash = HashValue(config.OversampleH, hash);
+			hash = HashValue(config.OversampleV, hash);
+			hash = HashValue(config.PixelSnapH, hash);
+			hash = HashValue(config.GlyphExtraSpacing, hash);
+			hash = HashValue(config.GlyphOffset, hash);
+			hash = HashValue(config.GlyphMinAdvanceX, hash);
+			hash = HashValue(config.GlyphMaxAdvanceX, hash);
+			hash = HashValue(config.MergeMode, hash);
+			hash = HashValue(config.FontBuilderFlags, hash);
+			hash = HashValue(config.RasterizerMultiply, hash);
+			hash = HashValue(config.EllipsisChar, hash);
+
+			// Hash the glyph ranges. The list is terminated by a zero.
+			const ImWchar* pRanges = config.GlyphRanges ? config.GlyphRanges : m_Atlas.GetGlyphRangesDefault();
+			for (; *pRanges; pRanges++)
+				hash = HashValue(*pRanges, hash);
+		}
+
+		return hash;
+	}
+
+	bool FontAtlasCache::load(const std::filesystem::path& path, uint64_t key)
+	{
+		if (!std::filesystem::exists(path))
+			return false;
+
+		auto pMappedFile = std::make_unique<MappedFile>(path);
+		if (!pMappedFile->isValid())
+			return false;
+
+		Reader reader(pMappedFile->data(), pMappedFile->size());
+
+		CacheHeader header = {};
+		if (!reader.read(&header, sizeof(CacheHeader)))
+			return false;
+
+		if (header.m_Magic != CacheMagic || header.m_Version != CacheVersion || header.m_Key != key || header.m_FontCount != static_cast<uint32_t>(m_Atlas.Fonts.Size))
+		{
+			spdlog::warn("The font atlas cache file {} is invalid. Rebuilding the atlas.", path.string());
+			return false;
+		}
+
+		// Read the fonts.
+		std::vector<FontHeader> fontHeaders(header.m_FontCount);
+		std::vector<ImVector<ImFontGlyph>> fontGlyphs(header.m_FontCount);
+		for (uint32_t i = 0; i < header.m_FontCount; i++)
+		{
+			if (!reader.read(&fontHeaders[i], sizeof(FontHeader)))
+				return false;
+
+			fontGlyphs[i].resize(fontHeaders[i].m_GlyphCount);
+			if (!reader.read(fontGlyphs[i].Data, sizeof(ImFontGlyph) * fontHeaders[i].m_GlyphCount))
+				return false;
+		}
+
+		// Read the custom rects.
+		std::vector<CustomRect> customRects(header.m_CustomRectCount);
+		if (!reader.read(customRects.data(), sizeof(CustomRect) * header.m_CustomRectCount))
+			return false;
+
+		// Get the pixels. These are used directly from the mapped memory.
+		const auto pPixels = reader.skip(static_cast<uint64_t>(header.m_Width) * header.m_Height);
+		if (!pPixels)
+			return false;
+
+		// Now that we know the file is complete, we can restore the fonts.
+		for (uint32_t i = 0; i < header.m_FontCount; i++)
+		{
+			const auto& fontHeader = fontHeaders[i];
+			auto pFont = m_Atlas.Fonts[i];
+
+			pFont->ClearOutputData();
+			pFont->FontSize = fontHeader.m_FontSize;
+			pFont->Ascent = fontHeader.m_Ascent;
+			pFont->Descent = fontHeader.m_Descent;
+			pFont->MetricsTotalSurface = fontHeader.m_MetricsTotalSurface;
+			pFont->FallbackChar = static_cast<ImWchar>(fontHeader.m_FallbackChar);
+			pFont->EllipsisChar = static_cast<ImWchar>(fontHeader.m_EllipsisChar);
+			pFont->ContainerAtlas = &m_Atlas;
+			pFont->Glyphs.swap(fontGlyphs[i]);
+
+			// Resolve the font's configuration data.
+			pFont->ConfigData = nullptr;
+			pFont->ConfigDataCount = 0;
+			for (auto& config : m_Atlas.ConfigData)
+			{
+				if (config.DstFont != pFont)
+					continue;
+
+				if (!pFont->ConfigData)
+					pFont->ConfigData = &config;
+
+				pFont->ConfigDataCount++;
+			}
+
+			pFont->BuildLookupTable();
+		}
+
+		// Restore the custom rects.
+		m_Atlas.CustomRects.resize(header.m_CustomRectCount);
+		for (uint32_t i = 0; i < header.m_CustomRectCount; i++)
+		{
+			const auto& customRect = customRects[i];
+			auto& atlasRect = m_Atlas.CustomRects[i];
+
+			atlasRect.Width = customRect.m_Width;
+			atlasRect.Height = customRect.m_Height;
+			atlasRect.X = customRect.m_X;
+			atlasRect.Y = customRect.m_Y;
+			atlasRect.GlyphID = customRect.m_GlyphID;
+			atlasRect.GlyphAdvanceX = customRect.m_GlyphAdvanceX;
+			atlasRect.GlyphOffset = customRect.m_GlyphOffset;
+			atlasRect.Font = customRect.m_FontIndex >= 0 && customRect.m_FontIndex < m_Atlas.Fonts.Size ? m_Atlas.Fonts[customRect.m_FontIndex] : nullptr;
+		}
+
+		// Restore the atlas information.
+		m_Atlas.TexWidth = static_cast<int32_t>(header.m_Width);
+		m_Atlas.TexHeight = static_cast<int32_t>(header.m_Height);
+		m_Atlas.TexUvScale = header.m_UvScale;
+		m_Atlas.TexUvWhitePixel = header.m_UvWhitePixel;
+		std::copy(std::begin(header.m_UvLines), std::end(header.m_UvLines), std::begin(m_Atlas.TexUvLines));
+		m_Atlas.PackIdMouseCursors = header.m_PackIdMouseCursors;
+		m_Atlas.PackIdLines = header.m_PackIdLines;
+		m_Atlas.TexReady = true;
+
+		m_pPixels = pPixels;
+		m_Width = header.m_Width;
+		m_Height = header.m_Height;
+		m_pMappedFile = std::move(pMappedFile);
+
+		return true;
+	}
+
+	void FontAtlasCache::store(const std::filesystem::path& path, uint64_t key) const
+	{
+		std::error_code errorCode;
+		std::filesystem::create_directories(path.parent_path(), errorCode);
+
+		std::ofstream file(path, std::ios::binary | std::ios::out);
+		if (!file.is_open())
+		{
+			spdlog::warn("Failed to open the font atlas cache file {}!", path.string());
+			return;
+		}
+
+		CacheHeader header = {};
+		header.m_Key = key;
+		header.m_Width = m_Width;
+		header.m_Height = m_Height;
+		header.m_FontCount = static_cast<uint32_t>(m_Atlas.Fonts.Size);
+		header.m_CustomRectCount = static_cast<uint32_t>(m_Atlas.CustomRects.Size);
+		header.m_UvScale = m_Atlas.TexUvScale;
+		header.m_UvWhitePixel = m_Atlas.TexUvWhitePixel;
+		std::copy(std::begin(m_Atlas.TexUvLines), std::end(m_Atlas.TexUvLines), std::begin(header.m_UvLines));
+		header.m_PackIdMouseCursors = m_Atlas.PackIdMouseCursors;
+		header.m_PackIdLines = m_Atlas.PackIdLines;
+		Write(file, header);
+
+		// Write the fonts and their glyphs.
+		for (const auto pFont : m_Atlas.Fonts)
+		{
+			FontHeader fontHeader = {
+				.m_FontSize = pFont->FontSize,
+				.m_Ascent = pFont->Ascent,
+				.m_Descent = pFont->Descent,
+				.m_MetricsTotalSurface = pFont->MetricsTotalSurface,
+				.m_FallbackChar = pFont->FallbackChar,
+				.m_EllipsisChar = pFont->EllipsisChar,
+				.m_GlyphCount = static_cast<uint32_t>(pFont->Glyphs.Size)
+			};
+
+			Write(file, fontHeader);
+			file.write(reinterpret_cast<const char*>(pFont->Glyphs.Data), sizeof(ImFontGlyph) * pFont->Glyphs.Size);
+		}
+
+		// Write the custom rects.
+		for (const auto& atlasRect : m_Atlas.CustomRects)
+		{
+			CustomRect customRect = {
+				.m_Width = atlasRect.Width,
+				.m_Height = atlasRect.Height,
+				.m_X = atlasRect.X,
+				.m_Y = atlasRect.Y,
+				.m_GlyphID = atlasRect.GlyphID,
+				.m_GlyphAdvanceX = atlasRect.GlyphAdvanceX,
+				.m_GlyphOffset = atlasRect.GlyphOffset,
+				.m_FontIndex = -1
+			};
+
+			for (int32_t i = 0; i < m_Atlas.Fonts.Size; i++)
+			{
+				if (m_Atlas.Fonts[i] == atlasRect.Font)
+					customRect.m_FontIndex = i;
+			}
+
+			Write(file, customRect);
+		}
+
+		// Finally write the pixels.
+		file.write(reinterpret_cast<const char*>(m_pPixels), static_cast<std::streamsize>(m_Width) * m_Height);
+	}
+}
@@ -0,0 +1,97 @@
+// Copyright (c) 2022 Dhiraj Wishal
+
+#pragma once
+
+#include "Core/MappedFile.hpp"
+
+#include <imgui.h>
+
+#include <memory>
+
+namespace rapid
+{
+	/**
+	 * Font atlas cache class.
+	 * Rasterizing the glyphs of every font is expensive, so the baked atlas (glyph metrics and a single channel alpha
+	 * image) is stored on disk. The cache is keyed by the font data hash, the font sizes, the glyph ranges and the rest of
+	 * the font configuration, so any change in them results in a new cache entry.
+	 *
+	 * Loading from the cache maps the file to memory and restores the atlas without rasterizing anything. The pixel data
+	 * is then used straight from the mapped file.
+	 */
+	class FontAtlasCache final
+	{
+	public:
+		/**
+		 * Explicit constructor.
+		 * This will either load the atlas from the cache, or build it and store it in the cache.
+		 *
+		 * @param atlas The font atlas with all the fonts added. It should not be built.
+		 */
+		explicit FontAtlasCache(ImFontAtlas& atlas);
+
+		/**
+		 * Get the alpha pixels of the atlas.
+		 * Note that the pointer is only valid while this object is alive.
+		 *
+		 * @return The pixel data pointer.
+		 */
+		const std::byte* data() const { return m_pPixels; }
+
+		/**
+		 * Get the atlas width.
+		 *
+		 * @return The width.
+		 */
+		uint32_t width() const { return m_Width; }
+
+		/**
+		 * Get the atlas height.
+		 *
+		 * @return The height.
+		 */
+		uint32_t height() const { return m_Height; }
+
+		/**
+		 * Check if the atlas was loaded from the cache.
+		 *
+		 * @return Whether or not it was a cache hit.
+		 */
+		bool isCacheHit() const { return m_IsCacheHit; }
+
+	private:
+		/**
+		 * Compute the cache key of the atlas.
+		 *
+		 * @return The key.
+		 */
+		uint64_t computeKey() const;
+
+		/**
+		 * Try and load the atlas from a cache file.
+		 *
+		 * @param path The cache file path.
+		 * @param key The expected key.
+		 * @return Whether or not the atlas was loaded.
+		 */
+		bool load(const std::filesystem::path& path, uint64_t key);
+
+		/**
+		 * Store the built atlas to a cache file.
+		 *
+		 * @param path The cache file path.
+		 * @param key The cache key.
+		 */
+		void store(const std::filesystem::path& path, uint64_t key) const;
+
+	private:
+		ImFontAtlas& m_Atlas;
+		std::unique_ptr<MappedFile> m_pMappedFile = nullptr;
+
+		const std::byte* m_pPixels = nullptr;
+		uint32_t m_Width = 0;
+		uint32_t m_Height = 0;
+
+		bool m_IsCacheHit = false;
+	};
+}
@@ -0,0 +1,275 @@
+// Copyright (c) 2022 Dhiraj Wishal
+
+#include "GpuProfiler.hpp"
+#include "Utility.hpp"
+
+#include <spdlog/spdlog.h>
+
+#include <fstream>
+
+namespace
+{
+	/**
+	 * The maximum number of scopes of a single frame. The scopes after these are not measured.
+	 */
+	constexpr uint32_t MaximumScopeCount = 64;
+
+	/**
+	 * The number of frames whose results are kept.
+	 */
+	constexpr uint32_t HistorySize = 240;
+
+	/**
+	 * The number of CPU scopes which are kept.
+	 */
+	constexpr uint32_t CpuScopeCount = 1024;
+
+	/**
+	 * The open scope index used for the scopes which are not measured.
+	 */
+	constexpr uint32_t InvalidScope = ~0u;
+
+	/**
+	 * The pipeline statistics which are queried, in the order they're written.
+	 */
+	constexpr VkQueryPipelineStatisticFlags PipelineStatisticFlags =
+		VK_QUERY_PIPELINE_STATISTIC_INPUT_ASSEMBLY_VERTICES_BIT |
+		VK_QUERY_PIPELINE_STATISTIC_INPUT_ASSEMBLY_PRIMITIVES_BIT |
+		VK_QUERY_PIPELINE_STATISTIC_VERTEX_SHADER_INVOCATIONS_BIT |
+		VK_QUERY_PIPELINE_STATISTIC_CLIPPING_PRIMITIVES_BIT |
+		VK_QUERY_PIPELINE_STATISTIC_FRAGMENT_SHADER_INVOCATIONS_BIT;
+}
+
+namespace rapid
+{
+	GpuProfiler::GpuProfiler(GraphicsEngine& engine, uint32_t frameCount)
+		: m_Engine(engine), m_FrameRecords(frameCount), m_Timestamps(MaximumScopeCount * 2), m_History(HistorySize, CpuScopeCount), m_StartTime(clock_type::now())
+	{
+		// Nothing can be measured if the graphics queue doesn't support timestamps.
+		if (!m_Engine.getPhysicalDeviceProperties().limits.timestampComputeAndGraphics)
+		{
+			spdlog::warn("The device doesn't support timestamp queries. The GPU profiler is disabled.");
+			return;
+		}
+
+		// Every scope needs two timestamps, one at the beginning and one at the end.
+		const VkQueryPoolCreateInfo timestampCreateInfo = {
+			.sType = VK_STRUCTURE_TYPE_QUERY_POOL_CREATE_INFO,
+			.pNext = nullptr,
+			.flags = 0,
+			.queryType = VK_QUERY_TYPE_TIMESTAMP,
+			.queryCount = frameCount * MaximumScopeCount * 2,
+			.pipelineStatistics = 0
+		};
+
+		utility::ValidateResult(m_Engine.getDeviceTable().vkCreateQueryPool(m_Engine.getLogicalDevice(), &timestampCreateInfo, nullptr, &m_TimestampPool), "Failed to create the profiler's timestamp query pool!");
+
+		if (!m_Engine.isPipelineStatisticsEnabled())
+			return;
+
+		const VkQueryPoolCreateInfo statisticsCreateInfo = {
+			.sType = VK_STRUCTURE_TYPE_QUERY_POOL_CREATE_INFO,
+			.pNext = nullptr,
+			.flags = 0,
+			.queryType = VK_QUERY_TYPE_PIPELINE_STATISTICS,
+			.queryCount = frameCount * MaximumScopeCount,
+			.pipelineStatistics = PipelineStatisticFlags
+		};
+
+		utility::ValidateResult(m_Engine.getDeviceTable().vkCreateQueryPool(m_Engine.getLogicalDevice(), &statisticsCreateInfo, nullptr, &m_StatisticsPool), "Failed to create the profiler's pipeline statistics query pool!");
+	}
+
+	GpuProfiler::~GpuProfiler()
+	{
+		if (m_StatisticsPool != VK_NULL_HANDLE)
+			m_Engine.getDeviceTable().vkDestroyQueryPool(m_Engine.getLogicalDevice(), m_StatisticsPool, nullptr);
+
+		if (m_TimestampPool != VK_NULL_HANDLE)
+			m_Engine.getDeviceTable().vkDestroyQueryPool(m_Engine.getLogicalDevice(), m_TimestampPool, nullptr);
+	}
+
+	void GpuProfiler::beginFrame(VkCommandBuffer vCommandBuffer, uint32_t frameIndex)
+	{
+		m_FrameIndex = frameIndex;
+		m_pFrame = nullptr;
+		m_OpenScopes.clear();
+
+		// The frame which used this index before is done by now.
+		auto& record = m_FrameRecords[m_FrameIndex];
+		if (record.m_IsRecorded)
+			readResults(record, m_FrameIndex);
+
+		record.m_IsRecorded = false;
+		record.m_ScopeCount = 0;
+
+		if (!m_IsEnabled || !isSupported())
+			return;
+
+		const auto firstQuery = getFirstQuery(m_FrameIndex);
+		m_Engine.getDeviceTable().vkCmdResetQueryPool(vCommandBuffer, m_TimestampPool, firstQuery * 2, MaximumScopeCount * 2);
+
+		if (m_StatisticsPool != VK_NULL_HANDLE)
+			m_Engine.getDeviceTable().vkCmdResetQueryPool(vCommandBuffer, m_StatisticsPool, firstQuery, MaximumScopeCount);
+
+		record.m_FrameNumber = ++m_FrameNumber;
+		record.m_IsRecorded = true;
+
+		m_pFrame = &record;
+		m_RecordStart = clock_type::now();
+	}
+
+	void GpuProfiler::markSubmit()
+	{
+		if (!m_pFrame)
+			return;
+
+		if (!m_OpenScopes.empty())
+			spdlog::warn("The GPU profiler has {} scopes which were not ended.", m_OpenScopes.size());
+
+		m_pFrame->m_SubmitTime = clock_type::now();
+		addCpuScope(CpuScope{ .m_Name = "Record frame", .m_Thread = "Render thread", .m_Start = m_RecordStart, .m_End = m_pFrame->m_SubmitTime });
+
+		// Scopes can't be added after the command buffer is submitted.
+		m_pFrame = nullptr;
+	}
+
+	void GpuProfiler::beginScope(VkCommandBuffer vCommandBuffer, std::string_view name)
+	{
+		if (!m_pFrame)
+			return;
+
+		auto& record = *m_pFrame;
+		if (record.m_ScopeCount == MaximumScopeCount)
+		{
+			m_OpenScopes.emplace_back(InvalidScope);
+			return;
+		}
+
+		const auto scope = record.m_ScopeCount++;
+		if (scope == record.m_Scopes.size())
+			record.m_Scopes.emplace_back();
+
+		// Pipeline statistics queries can't be nested, so only the top level scopes get them.
+		auto& scopeRecord = record.m_Scopes[scope];
+		scopeRecord.m_Name.assign(name);
+		scopeRecord.m_Depth = static_cast<uint32_t>(m_OpenScopes.size());
+		scopeRecord.m_HasPipelineStatistics = m_StatisticsPool != VK_NULL_HANDLE && scopeRecord.m_Depth == 0;
+
+		const auto query = getFirstQuery(m_FrameIndex) + scope;
+		m_Engine.getDeviceTable().vkCmdWriteTimestamp(vCommandBuffer, VK_PIPELINE_STAGE_TOP_OF_PIPE_BIT, m_TimestampPool, query * 2);
+
+		if (scopeRecord.m_HasPipelineStatistics)
+			m_Engine.getDeviceTable().vkCmdBeginQuery(vCommandBuffer, m_StatisticsPool, query, 0);
+
+		m_OpenScopes.emplace_back(scope);
+	}
+
+	void GpuProfiler::endScope(VkCommandBuffer vCommandBuffer)
+	{
+		if (!m_pFrame || m_OpenScopes.empty())
+			return;
+
+		const auto scope = m_OpenScopes.back();
+		m_OpenScopes.pop_back();
+
+		if (scope == InvalidScope)
+			return;
+
+		const auto query = getFirstQuery(m_FrameIndex) + scope;
+		if (m_pFrame->m_Scopes[scope].m_HasPipelineStatistics)
+			m_Engine.getDeviceTable().vkCmdEndQuery(vCommandBuffer, m_StatisticsPool, query);
+
+		m_Engine.getDeviceTable().vkCmdWriteTimestamp(vCommandBuffer, VK_PIPELINE_STAGE_BOTTOM_OF_PIPE_BIT, m_TimestampPool, query * 2 + 1);
+	}
+
+	void GpuProfiler::addCpuScope(const CpuScope& scope)
+	{
+		const auto lock = std::scoped_lock(m_HistoryMutex);
+
+		m_History.addCpuScope(scope);
+	}
+
+	std::vector<GpuProfiler::FrameResult> GpuProfiler::getResults() const
+	{
+		const auto lock = std::scoped_lock(m_HistoryMutex);
+
+		return m_History.getFrames();
+	}
+
+	bool GpuProfiler::exportTrace(const std::filesystem::path& file) const
+	{
+		std::vector<FrameResult> results;
+		std::vector<CpuScope> cpuScopes;
+		{
+			const auto lock = std::scoped_lock(m_HistoryMutex);
+
+			results = m_History.getFrames();
+			cpuScopes = m_History.getCpuScopes();
+		}
+
+		std::ofstream stream(file, std::ios::out);
+		if (!stream.is_open())
+		{
+			spdlog::error("Failed to open the trace file {}!", file.string());
+			return false;
+		}
+
+		WriteProfilerTrace(stream, results, cpuScopes, m_StartTime);
+		spdlog::info("Exported {} GPU frames and {} CPU scopes to {}.", results.size(), cpuScopes.size(), file.string());
+		return true;
+	}
+
+	void GpuProfiler::readResults(FrameRecord& record, uint32_t frameIndex)
+	{
+		if (record.m_ScopeCount == 0)
+			return;
+
+		// The results are not waited on. If they're not ready yet, the frame is dropped.
+		const auto firstQuery = getFirstQuery(frameIndex);
+		const auto& deviceTable = m_Engine.getDeviceTable();
+		const auto result = deviceTable.vkGetQueryPoolResults(m_Engine.getLogicalDevice(), m_TimestampPool, firstQuery * 2, record.m_ScopeCount * 2, record.m_ScopeCount * 2 * sizeof(uint64_t), m_Timestamps.data(), sizeof(uint64_t), VK_QUERY_RESULT_64_BIT);
+		if (result != VK_SUCCESS)
+			return;
+
+		FrameResult frameResult = {
+			.m_SubmitTime = record.m_SubmitTime,
+			.m_FrameNumber = record.m_FrameNumber
+		};
+
+		frameResult.m_Scopes.reserve(record.m_ScopeCount);
+		for (uint32_t i = 0; i < record.m_ScopeCount; i++)
+		{
+			const auto& scopeRecord = record.m_Scopes[i];
+			auto& scope = frameResult.m_Scopes.emplace_back(ScopeResult{ .m_Name = scopeRecord.m_Name, .m_Depth = scopeRecord.m_Depth });
+
+			if (!scopeRecord.m_HasPipelineStatistics)
+				continue;
+
+			uint64_t statistics[5] = {};
+			if (deviceTable.vkGetQueryPoolResults(m_Engine.getLogicalDevice(), m_StatisticsPool, firstQuery + i, 1, sizeof(statistics), statistics, sizeof(statistics), VK_QUERY_RESULT_64_BIT) != VK_SUCCESS)
+				continue;
+
+			scope.m_PipelineStatistics = PipelineStatistics{
+				.m_InputVertices = statistics[0],
+				.m_InputPrimitives = statistics[1],
+				.m_VertexShaderInvocations = statistics[2],
+				.m_ClippingPrimitives = statistics[3],
+				.m_FragmentShaderInvocations = statistics[4]
+			};
+
+			scope.m_HasPipelineStatistics = true;
+		}
+
+		// The timestamp period is the number of nanoseconds per tick.
+		SetScopeTimes(frameResult.m_Scopes, m_Timestamps, m_Engine.getPhysicalDeviceProperties().limits.timestampPeriod);
+
+		const auto lock = std::scoped_lock(m_HistoryMutex);
+
+		m_History.addFrame(std::move(frameResult));
+	}
+
+	uint32_t GpuProfiler::getFirstQuery(uint32_t frameIndex) const
+	{
+		return frameIndex * MaximumScopeCount;
+	}
+}
@@ -0,0 +1,237 @@
+// Copyright (c) 2022 Dhiraj Wishal
+
+#pragma once
+
+#include "GraphicsEngine.hpp"
+
+#include "Core/ProfilerHistory.hpp"
+
+#include <atomic>
+#include <filesystem>
+#include <mutex>
+#include <string>
+#include <string_view>
+#include <vector>
+
+namespace rapid
+{
+	/**
+	 * GPU profiler class.
+	 * This measures how long the GPU spends on the scopes of a frame, like the render graph's passes and the nodes. The
+	 * scopes are wrapped in timestamp queries, and the top level scopes are also wrapped in pipeline statistics queries if
+	 * the device supports them. Scopes can be nested.
+	 *
+	 * Every frame in flight has its own queries. They're read back when the frame index comes around again, so the
+	 * results are a few frames late but the CPU never waits for them. Frames whose results are not ready by then are
+	 * dropped.
+	 *
+	 * The profiler also keeps CPU scopes, so the recent frames can be exported as a single trace which can be opened in
+	 * chrome://tracing or Perfetto. The scopes are recorded by the render thread only, while the results and the CPU
+	 * scopes can be used from any thread.
+	 */
+	class GpuProfiler final
+	{
+	public:
+		using clock_type = ProfilerHistory::clock_type;
+		using PipelineStatistics = ProfilerHistory::PipelineStatistics;
+		using ScopeResult = ProfilerHistory::ScopeResult;
+		using FrameResult = ProfilerHistory::FrameResult;
+		using CpuScope = ProfilerHistory::CpuScope;
+
+	public:
+		/**
+		 * Explicit constructor.
+		 *
+		 * @param engine The graphics engine.
+		 * @param frameCount The number of frames in flight.
+		 */
+		explicit GpuProfiler(GraphicsEngine& engine, uint32_t frameCount);
+
+		/**
+		 * Destructor.
+		 */
+		~GpuProfiler();
+
+		GpuProfiler(const GpuProfiler&) = delete;
+		GpuProfiler& operator=(const GpuProfiler&) = delete;
+
+		/**
+		 * Begin profiling a frame.
+		 * This reads the results of the last frame which used the frame index, and needs to be called right after beginning
+		 * the frame's command buffer.
+		 *
+		 * @param vCommandBuffer The frame's command buffer.
+		 * @param frameIndex The frame index.
+		 */
+		void beginFrame(VkCommandBuffer vCommandBuffer, uint32_t frameIndex);
+
+		/**
+		 * Mark the frame as submitted.
+		 * This needs to be called right before the frame's command buffer is submitted.
+		 */
+		void markSubmit();
+
+		/**
+		 * Begin a scope.
+		 * Scopes must not cross the boundary of a render pass, if they begin outside one.
+		 *
+		 * @param vCommandBuffer The frame's command buffer.
+		 * @param name The name of the scope.
+		 */
+		void beginScope(VkCommandBuffer vCommandBuffer, std::string_view name);
+
+		/**
+		 * End the last scope which was begun.
+		 *
+		 * @param vCommandBuffer The frame's command buffer.
+		 */
+		void endScope(VkCommandBuffer vCommandBuffer);
+
+		/**
+		 * Add a CPU scope to the trace.
+		 * Only the scopes of the recent frames are kept.
+		 *
+		 * @param scope The scope. The names need to outlive the profiler.
+		 */
+		void addCpuScope(const CpuScope& scope);
+
+		/**
+		 * Enable or disable the profiler.
+		 * It takes effect from the next frame.
+		 *
+		 * @param enable Whether or not to profile the frames.
+		 */
+		void setEnabled(bool enable) { m_IsEnabled = enable; }
+
+		/**
+		 * Check if the profiler is enabled.
+		 *
+		 * @return Whether or not the frames are profiled.
+		 */
+		bool isEnabled() const { return m_IsEnabled; }
+
+		/**
+		 * Check if the profiler can measure anything.
+		 *
+		 * @return Whether or not the device supports timestamps on the graphics queue.
+		 */
+		bool isSupported() const { return m_TimestampPool != VK_NULL_HANDLE; }
+
+		/**
+		 * Get the results of the recent frames.
+		 *
+		 * @return The frame results, from the oldest to the newest.
+		 */
+		std::vector<FrameResult> getResults() const;
+
+		/**
+		 * Export the recent frames to a trace file.
+		 * The file uses the trace event format. The GPU scopes are placed from the time their frame was submitted.
+		 *
+		 * @param file The file to write to.
+		 * @return Whether or not the trace was written.
+		 */
+		bool exportTrace(const std::filesystem::path& file) const;
+
+	private:
+		/**
+		 * Scope record structure.
+		 */
+		struct ScopeRecord final
+		{
+			std::string m_Name;
+			uint32_t m_Depth = 0;
+			bool m_HasPipelineStatistics = false;
+		};
+
+		/**
+		 * Frame record structure.
+		 * This holds the scopes of a frame in flight till its results are read.
+		 */
+		struct FrameRecord final
+		{
+			std::vector<ScopeRecord> m_Scopes = {};	// The records are reused, so only the first m_ScopeCount are valid.
+			clock_type::time_point m_SubmitTime = {};
+			uint64_t m_FrameNumber = 0;
+			uint32_t m_ScopeCount = 0;
+			bool m_IsRecorded = false;
+		};
+
+		/**
+		 * Read the results of a frame which is done.
+		 *
+		 * @param record The frame's record.
+		 * @param frameIndex The frame index.
+		 */
+		void readResults(FrameRecord& record, uint32_t frameIndex);
+
+		/**
+		 * Get the first query of a frame.
+		 *
+		 * @param frameIndex The frame index.
+		 * @return The query index.
+		 */
+		uint32_t getFirstQuery(uint32_t frameIndex) const;
+
+	private:
+		GraphicsEngine& m_Engine;
+
+		std::vector<FrameRecord> m_FrameRecords = {};
+		std::vector<uint64_t> m_Timestamps = {};
+		std::vector<uint32_t> m_OpenScopes = {};
+
+		ProfilerHistory m_History;
+		mutable std::mutex m_HistoryMutex;
+
+		VkQueryPool m_TimestampPool = VK_NULL_HANDLE;
+		VkQueryPool m_StatisticsPool = VK_NULL_HANDLE;
+
+		FrameRecord* m_pFrame = nullptr;
+
+		clock_type::time_point m_StartTime = {};
+		clock_type::time_point m_RecordStart = {};
+
+		uint64_t m_FrameNumber = 0;
+		uint32_t m_FrameIndex = 0;
+
+		std::atomic_bool m_IsEnabled = false;
+	};
+
+	/**
+	 * GPU scope class.
+	 * This begins a profiler scope when created and ends it when destroyed. Nothing is recorded without a profiler.
+	 */
+	class GpuScope final
+	{
+	public:
+		/**
+		 * Explicit constructor.
+		 *
+		 * @param pProfiler The profiler. This can be nullptr.
+		 * @param vCommandBuffer The frame's command buffer.
+		 * @param name The name of the scope.
+		 */
+		explicit GpuScope(GpuProfiler* pProfiler, VkCommandBuffer vCommandBuffer, std::string_view name)
+			: m_pProfiler(pProfiler), m_vCommandBuffer(vCommandBuffer)
+		{
+			if (m_pProfiler)
+				m_pProfiler->beginScope(m_vCommandBuffer, name);
+		}
+
+		/**
+		 * Destructor.
+		 */
+		~GpuScope()
+		{
+			if (m_pProfiler)
+				m_pProfiler->endScope(m_vCommandBuffer);
+		}
+
+		GpuScope(const GpuScope&) = delete;
+		GpuScope& operator=(const GpuScope&) = delete;
+
+	private:
+		GpuProfiler* m_pProfiler = nullptr;
+		VkCommandBuffer m_vCommandBuffer = VK_NULL_HANDLE;
+	};
+}
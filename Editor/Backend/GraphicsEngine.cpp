@@ -123,6 +123,52 @@ namespace
 
 #endif
 
+	/**
+	 * Convert synchronization2 stage flags to the legacy stage flags.
+	 * The legacy flags have the same values, so only the stages which are new in synchronization2 need to be converted.
+	 *
+	 * @param stages The synchronization2 stages.
+	 * @param noneStage The stage to use if there are no stages. Legacy barriers need at least one.
+	 * @return The legacy stages.
+	 */
+	VkPipelineStageFlags GetLegacyStageFlags(const VkPipelineStageFlags2 stages, const VkPipelineStageFlags noneStage)
+	{
+		if (stages == VK_PIPELINE_STAGE_2_NONE)
+			return noneStage;
+
+		auto legacyStages = static_cast<VkPipelineStageFlags>(stages & 0xffffffff);
+
+		if (stages & (VK_PIPELINE_STAGE_2_COPY_BIT | VK_PIPELINE_STAGE_2_BLIT_BIT | VK_PIPELINE_STAGE_2_RESOLVE_BIT | VK_PIPELINE_STAGE_2_CLEAR_BIT))
+			legacyStages |= VK_PIPELINE_STAGE_TRANSFER_BIT;
+
+		if (stages & (VK_PIPELINE_STAGE_2_INDEX_INPUT_BIT | VK_PIPELINE_STAGE_2_VERTEX_ATTRIBUTE_INPUT_BIT))
+			legacyStages |= VK_PIPELINE_STAGE_VERTEX_INPUT_BIT;
+
+		if (stages & VK_PIPELINE_STAGE_2_PRE_RASTERIZATION_SHADERS_BIT)
+			legacyStages |= VK_PIPELINE_STAGE_VERTEX_SHADER_BIT | VK_PIPELINE_STAGE_TESSELLATION_CONTROL_SHADER_BIT | VK_PIPELINE_STAGE_TESSELLATION_EVALUATION_SHADER_BIT | VK_PIPELINE_STAGE_GEOMETRY_SHADER_BIT;
+
+		return legacyStages;
+	}
+
+	/**
+	 * Convert synchronization2 access flags to the legacy access flags.
+	 *
+	 * @param access The synchronization2 access flags.
+	 * @return The legacy access flags.
+	 */
+	VkAccessFlags GetLegacyAccessFlags(const VkAccessFlags2 access)
+	{
+		auto legacyAccess = static_cast<VkAccessFlags>(access & 0xffffffff);
+
+		if (access & (VK_ACCESS_2_SHADER_SAMPLED_READ_BIT | VK_ACCESS_2_SHADER_STORAGE_READ_BIT))
+			legacyAccess |= VK_ACCESS_SHADER_READ_BIT;
+
+		if (access & VK_ACCESS_2_SHADER_STORAGE_WRITE_BIT)
+			legacyAccess |= VK_ACCESS_SHADER_WRITE_BIT;
+
+		return legacyAccess;
+	}
+
 	/**
 	 * Check device extension support.
 	 *
@@ -154,6 +200,37 @@ namespace
 		return requiredExtensions.empty();
 	}
 
+	/**
+	 * Get the extensions from the list which are supported by the physical device.
+	 *
+	 * @param vPhysicalDevice The physical device to check.
+	 * @param deviceExtensions The extensions to check.
+	 * @return The supported extensions.
+	 */
+	std::vector<const char*> GetSupportedDeviceExtensions(VkPhysicalDevice vPhysicalDevice, const std::vector<const char*>& deviceExtensions)
+	{
+		// Get the extension count.
+		uint32_t extensionCount = 0;
+		rapid::utility::ValidateResult(vkEnumerateDeviceExtensionProperties(vPhysicalDevice, nullptr, &extensionCount, nullptr), "Failed to enumerate physical device extension property count!");
+
+		// Load the extensions.
+		std::vector<VkExtensionProperties> availableExtensions(extensionCount);
+		rapid::utility::ValidateResult(vkEnumerateDeviceExtensionProperties(vPhysicalDevice, nullptr, &extensionCount, availableExtensions.data()), "Failed to enumerate physical device extension properties!");
+
+		std::set<std::string_view> availableExtensionNames;
+		for (const VkExtensionProperties& extension : availableExtensions)
+			availableExtensionNames.insert(extension.extensionName);
+
+		std::vector<const char*> supportedExtensions;
+		for (const auto pExtension : deviceExtensions)
+		{
+			if (availableExtensionNames.contains(pExtension))
+				supportedExtensions.emplace_back(pExtension);
+		}
+
+		return supportedExtensions;
+	}
+
 	/**
 	 * Check if a physical device is suitable.
 	 *
@@ -187,8 +264,7 @@ namespace
 			SDL_Init(SDL_INIT_VIDEO);
 
 			// Initialize ImGui.
-			ImGui::CreateContext();
-			setupImGui();
+			rapid::InitializeImGui();
 		}
 
 		/**
@@ -199,57 +275,60 @@ namespace
 			ImGui::DestroyContext();
 			SDL_Quit();
 		}
-
-	private:
-		/**
-		 * Setup ImGui.
-		 */
-		void setupImGui() const
-		{
-			auto& style = ImGui::GetStyle();
-
-			// Background - 20, 23, 27
-			// Tabs - 242, 84, 91
-			// Menus - 25, 133, 161
-
-			style.Colors[ImGuiCol_TitleBg] = ImVec4(CreateColor256(26), CreateColor256(30), CreateColor256(35), 0.5f);
-			style.Colors[ImGuiCol_TitleBgActive] = ImVec4(CreateColor256(26), CreateColor256(30), CreateColor256(35), 0.75f);
-
-			style.Colors[ImGuiCol_WindowBg] = ImVec4(CreateColor256(26), CreateColor256(30), CreateColor256(35), 1.0f);
-			style.Colors[ImGuiCol_MenuBarBg] = ImVec4(CreateColor256(26), CreateColor256(30), CreateColor256(35), 1.0f);
-
-			style.Colors[ImGuiCol_Header] = ImVec4(CreateColor256(25), CreateColor256(133), CreateColor256(161), 0.5f);
-			style.Colors[ImGuiCol_HeaderHovered] = ImVec4(CreateColor256(25), CreateColor256(133), CreateColor256(161), 1.0f);
-
-			style.Colors[ImGuiCol_Tab] = ImVec4(CreateColor256(242), CreateColor256(84), CreateColor256(91), 0.25f);
-			style.Colors[ImGuiCol_TabActive] = ImVec4(CreateColor256(242), CreateColor256(84), CreateColor256(91), 0.75f);
-			style.Colors[ImGuiCol_TabHovered] = ImVec4(CreateColor256(242), CreateColor256(84), CreateColor256(91), 1.0f);
-			style.Colors[ImGuiCol_TabUnfocusedActive] = ImVec4(CreateColor256(242), CreateColor256(84), CreateColor256(91), 0.5f);
-			style.Colors[ImGuiCol_TabUnfocused] = ImVec4(CreateColor256(242), CreateColor256(84), CreateColor256(91), 0.25f);
-
-			style.ChildRounding = 6.0f;
-			style.FrameRounding = 1.0f;
-			style.FramePadding.x = 5.0f;
-			style.FramePadding.y = 2.0f;
-			style.PopupRounding = 3.0f;
-			style.TabRounding = 1.0f;
-			style.WindowRounding = 3.0f;
-			//style.WindowPadding.x = 5.0f;
-
-			ImGuiIO& imGuiIO = ImGui::GetIO();
-			imGuiIO.Fonts->AddFontFromFileTTF((std::filesystem::current_path() / "Fonts" / "Manrope" / "static" / "Manrope-Regular.ttf").string().c_str(), 16.0f);
-
-			//imGuiIO.ConfigFlags |= ImGuiConfigFlags_NavEnableGamepad;      // Enable Gamepad Controls
-			imGuiIO.ConfigFlags |= ImGuiConfigFlags_NavEnableKeyboard;		 // Enable Keyboard Controls
-			imGuiIO.ConfigFlags |= ImGuiConfigFlags_DockingEnable;           // Enable Docking
-			imGuiIO.ConfigFlags |= ImGuiConfigFlags_ViewportsEnable;         // Enable Multi-Viewport / Platform Windows
-			imGuiIO.MouseDrawCursor = true;
-		}
 	};
 }
 
 namespace rapid
 {
+	bool InitializeImGui()
+	{
+		if (ImGui::GetCurrentContext())
+			return false;
+
+		ImGui::CreateContext();
+
+		auto& style = ImGui::GetStyle();
+
+		// Background - 20, 23, 27
+		// Tabs - 242, 84, 91
+		// Menus - 25, 133, 161
+
+		style.Colors[ImGuiCol_TitleBg] = ImVec4(CreateColor256(26), CreateColor256(30), CreateColor256(35), 0.5f);
+		style.Colors[ImGuiCol_TitleBgActive] = ImVec4(CreateColor256(26), CreateColor256(30), CreateColor256(35), 0.75f);
+
+		style.Colors[ImGuiCol_WindowBg] = ImVec4(CreateColor256(26), CreateColor256(30), CreateColor256(35), 1.0f);
+		style.Colors[ImGuiCol_MenuBarBg] = ImVec4(CreateColor256(26), CreateColor256(30), CreateColor256(35), 1.0f);
+
+		style.Colors[ImGuiCol_Header] = ImVec4(CreateColor256(25), CreateColor256(133), CreateColor256(161), 0.5f);
+		style.Colors[ImGuiCol_HeaderHovered] = ImVec4(CreateColor256(25), CreateColor256(133), CreateColor256(161), 1.0f);
+
+		style.Colors[ImGuiCol_Tab] = ImVec4(CreateColor256(242), CreateColor256(84), CreateColor256(91), 0.25f);
+		style.Colors[ImGuiCol_TabActive] = ImVec4(CreateColor256(242), CreateColor256(84), CreateColor256(91), 0.75f);
+		style.Colors[ImGuiCol_TabHovered] = ImVec4(CreateColor256(242), CreateColor256(84), CreateColor256(91), 1.0f);
+		style.Colors[ImGuiCol_TabUnfocusedActive] = ImVec4(CreateColor256(242), CreateColor256(84), CreateColor256(91), 0.5f);
+		style.Colors[ImGuiCol_TabUnfocused] = ImVec4(CreateColor256(242), CreateColor256(84), CreateColor256(91), 0.25f);
+
+		style.ChildRounding = 6.0f;
+		style.FrameRounding = 1.0f;
+		style.FramePadding.x = 5.0f;
+		style.FramePadding.y = 2.0f;
+		style.PopupRounding = 3.0f;
+		style.TabRounding = 1.0f;
+		style.WindowRounding = 3.0f;
+		//style.WindowPadding.x = 5.0f;
+
+		ImGuiIO& imGuiIO = ImGui::GetIO();
+		imGuiIO.Fonts->AddFontFromFileTTF((std::filesystem::current_path() / "Fonts" / "Manrope" / "static" / "Manrope-Regular.ttf").string().c_str(), 16.0f);
+
+		//imGuiIO.ConfigFlags |= ImGuiConfigFlags_NavEnableGamepad;      // Enable Gamepad Controls
+		imGuiIO.ConfigFlags |= ImGuiConfigFlags_NavEnableKeyboard;		 // Enable Keyboard Controls
+		imGuiIO.ConfigFlags |= ImGuiConfigFlags_DockingEnable;           // Enable Docking
+		imGuiIO.ConfigFlags |= ImGuiConfigFlags_ViewportsEnable;         // Enable Multi-Viewport / Platform Windows
+		imGuiIO.MouseDrawCursor = true;
+
+		return true;
+	}
+
 	GraphicsEngine::GraphicsEngine()
 	{
 		// Set up the static initializer.
@@ -342,7 +421,10 @@ namespace rapid
 		}
 
 		// Submit the queue.
-		utility::ValidateResult(m_DeviceTable.vkQueueSubmit(m_Queue.getTransferQueue(), 1, &submitInfo, fence), "Failed to submit the queue!");
+		{
+			const auto lock = lockQueue();
+			utility::ValidateResult(m_DeviceTable.vkQueueSubmit(m_Queue.getTransferQueue(), 1, &submitInfo, fence), "Failed to submit the queue!");
+		}
 
 		// Destroy the fence if we created it.
 		if (shouldWait)
@@ -354,6 +436,7 @@ namespace rapid
 
 	void GraphicsEngine::waitIdle() const
 	{
+		const auto lock = lockQueue();
 		m_DeviceTable.vkDeviceWaitIdle(m_LogicalDevice);
 	}
 
@@ -502,6 +585,132 @@ namespace rapid
 
 		// Create the queue.
 		m_Queue = Queue(m_PhysicalDevice);
+
+		// Enable the optional extensions which are supported by the selected device.
+		const std::vector<const char*> optionalExtensions = {
+			VK_KHR_INCREMENTAL_PRESENT_EXTENSION_NAME,
+			VK_EXT_MEMORY_BUDGET_EXTENSION_NAME,
+			VK_EXT_CALIBRATED_TIMESTAMPS_EXTENSION_NAME
+		};
+
+		for (const auto pExtension : GetSupportedDeviceExtensions(m_PhysicalDevice, optionalExtensions))
+		{
+			spdlog::info("Enabling the optional device extension {}.", pExtension);
+			m_DeviceExtensions.emplace_back(pExtension);
+		}
+
+		// Dynamic rendering and synchronization2 are core in Vulkan 1.3. Older drivers use render passes and the legacy barriers.
+		if (volkGetInstanceVersion() >= VK_API_VERSION_1_3 && m_Properties.apiVersion >= VK_API_VERSION_1_3)
+		{
+			VkPhysicalDeviceVulkan13Features vulkan13Features = {
+				.sType = VK_STRUCTURE_TYPE_PHYSICAL_DEVICE_VULKAN_1_3_FEATURES,
+				.pNext = nullptr
+			};
+
+			VkPhysicalDeviceFeatures2 features = {
+				.sType = VK_STRUCTURE_TYPE_PHYSICAL_DEVICE_FEATURES_2,
+				.pNext = &vulkan13Features
+			};
+
+			vkGetPhysicalDeviceFeatures2(m_PhysicalDevice, &features);
+
+			m_IsDynamicRenderingEnabled = vulkan13Features.dynamicRendering == VK_TRUE;
+			m_IsSynchronization2Enabled = vulkan13Features.synchronization2 == VK_TRUE;
+		}
+
+		spdlog::info("Dynamic rendering is {}, synchronization2 is {}.", m_IsDynamicRenderingEnabled ? "enabled" : "disabled", m_IsSynchronization2Enabled ? "enabled" : "disabled");
+	}
+
+	void GraphicsEngine::setCurrentFrameIndex(uint32_t frameIndex)
+	{
+		m_CurrentFrameIndex = frameIndex;
+		vmaSetCurrentFrameIndex(m_vAllocator, frameIndex);
+	}
+
+	std::vector<GraphicsEngine::HeapBudget> GraphicsEngine::getHeapBudgets() const
+	{
+		const VkPhysicalDeviceMemoryProperties* pMemoryProperties = nullptr;
+		vmaGetMemoryProperties(m_vAllocator, &pMemoryProperties);
+
+		std::vector<VmaBudget> budgets(pMemoryProperties->memoryHeapCount);
+		vmaGetHeapBudgets(m_vAllocator, budgets.data());
+
+		std::vector<HeapBudget> heapBudgets;
+		heapBudgets.reserve(budgets.size());
+
+		for (uint32_t i = 0; i < pMemoryProperties->memoryHeapCount; i++)
+		{
+			heapBudgets.emplace_back(HeapBudget{
+				.m_Usage = budgets[i].usage,
+				.m_Budget = budgets[i].budget,
+				.m_AllocatedBytes = budgets[i].statistics.allocationBytes,
+				.m_BlockBytes = budgets[i].statistics.blockBytes,
+				.m_IsDeviceLocal = (pMemoryProperties->memoryHeaps[i].flags & VK_MEMORY_HEAP_DEVICE_LOCAL_BIT) != 0
+				});
+		}
+
+		return heapBudgets;
+	}
+
+	bool GraphicsEngine::isExtensionEnabled(std::string_view extension) const
+	{
+		for (const auto pExtension : m_DeviceExtensions)
+		{
+			if (extension == pExtension)
+				return true;
+		}
+
+		return false;
+	}
+
+	void GraphicsEngine::recordImageBarriers(VkCommandBuffer vCommandBuffer, const std::vector<VkImageMemoryBarrier2>& barriers) const
+	{
+		if (barriers.empty())
+			return;
+
+		if (m_IsSynchronization2Enabled)
+		{
+			const VkDependencyInfo dependencyInfo = {
+				.sType = VK_STRUCTURE_TYPE_DEPENDENCY_INFO,
+				.pNext = nullptr,
+				.dependencyFlags = 0,
+				.memoryBarrierCount = 0,
+				.pMemoryBarriers = nullptr,
+				.bufferMemoryBarrierCount = 0,
+				.pBufferMemoryBarriers = nullptr,
+				.imageMemoryBarrierCount = static_cast<uint32_t>(barriers.size()),
+				.pImageMemoryBarriers = barriers.data()
+			};
+
+			m_DeviceTable.vkCmdPipelineBarrier2(vCommandBuffer, &dependencyInfo);
+			return;
+		}
+
+		std::vector<VkImageMemoryBarrier> legacyBarriers;
+		legacyBarriers.reserve(barriers.size());
+
+		VkPipelineStageFlags sourceStages = 0;
+		VkPipelineStageFlags destinationStages = 0;
+		for (const auto& barrier : barriers)
+		{
+			sourceStages |= GetLegacyStageFlags(barrier.srcStageMask, VK_PIPELINE_STAGE_TOP_OF_PIPE_BIT);
+			destinationStages |= GetLegacyStageFlags(barrier.dstStageMask, VK_PIPELINE_STAGE_BOTTOM_OF_PIPE_BIT);
+
+			legacyBarriers.emplace_back(VkImageMemoryBarrier{
+				.sType = VK_STRUCTURE_TYPE_IMAGE_MEMORY_BARRIER,
+				.pNext = nullptr,
+				.srcAccessMask = GetLegacyAccessFlags(barrier.srcAccessMask),
+				.dstAccessMask = GetLegacyAccessFlags(barrier.dstAccessMask),
+				.oldLayout = barrier.oldLayout,
+				.newLayout = barrier.newLayout,
+				.srcQueueFamilyIndex = barrier.srcQueueFamilyIndex,
+				.dstQueueFamilyIndex = barrier.dstQueueFamilyIndex,
+				.image = barrier.image,
+				.subresourceRange = barrier.subresourceRange
+				});
+		}
+
+		m_DeviceTable.vkCmdPipelineBarrier(vCommandBuffer, sourceStages, destinationStages, 0, 0, nullptr, 0, nullptr, static_cast<uint32_t>(legacyBarriers.size()), legacyBarriers.data());
 	}
 
 	VmaVulkanFunctions GraphicsEngine::getVmaFunctions() const
@@ -569,10 +778,23 @@ namespace rapid
 		features.tessellationShader = VK_TRUE;
 		features.geometryShader = VK_TRUE;
 
+		// Pipeline statistics are only used by the profiler, so they're optional.
+		VkPhysicalDeviceFeatures supportedFeatures = {};
+		vkGetPhysicalDeviceFeatures(m_PhysicalDevice, &supportedFeatures);
+		features.pipelineStatisticsQuery = supportedFeatures.pipelineStatisticsQuery;
+		m_IsPipelineStatisticsEnabled = supportedFeatures.pipelineStatisticsQuery == VK_TRUE;
+
+		VkPhysicalDeviceVulkan13Features vulkan13Features = {
+			.sType = VK_STRUCTURE_TYPE_PHYSICAL_DEVICE_VULKAN_1_3_FEATURES,
+			.pNext = nullptr,
+			.synchronization2 = m_IsSynchronization2Enabled ? VK_TRUE : VK_FALSE,
+			.dynamicRendering = m_IsDynamicRenderingEnabled ? VK_TRUE : VK_FALSE
+		};
+
 		// Device create info.
 		VkDeviceCreateInfo deviceCreateInfo = {
 			.sType = VK_STRUCTURE_TYPE_DEVICE_CREATE_INFO,
-			.pNext = nullptr,
+			.pNext = m_IsDynamicRenderingEnabled || m_IsSynchronization2Enabled ? &vulkan13Features : nullptr,
 			.flags = 0,
 			.queueCreateInfoCount = static_cast<uint32_t>(queueCreateInfos.size()),
 			.pQueueCreateInfos = queueCreateInfos.data(),
@@ -601,9 +823,12 @@ namespace rapid
 		vkGetDeviceQueue(m_LogicalDevice, m_Queue.getGraphicsFamily().value(), 0, &m_Queue.getGraphicsQueue());
 
 		// Create VMA allocator.
+		// The memory budget extension lets the allocator know how much memory the other processes leave for us.
+		m_IsMemoryBudgetEnabled = isExtensionEnabled(VK_EXT_MEMORY_BUDGET_EXTENSION_NAME);
+
 		const auto functions = getVmaFunctions();
 		VmaAllocatorCreateInfo vmaCreateInfo = {
-			.flags = 0,
+			.flags = m_IsMemoryBudgetEnabled ? static_cast<VmaAllocatorCreateFlags>(VMA_ALLOCATOR_CREATE_EXT_MEMORY_BUDGET_BIT) : 0,
 			.physicalDevice = m_PhysicalDevice,
 			.device = m_LogicalDevice,
 			.pVulkanFunctions = &functions,
@@ -4,6 +4,7 @@
 
 #include "BackendObject.hpp"
 #include "Queue.hpp"
+#include "MemoryStatistics.hpp"
 
 #include <vk_mem_alloc.h>
 #include <volk.h>
@@ -11,6 +12,8 @@
 #include <string>
 #include <vector>
 #include <memory>
+#include <mutex>
+#include <atomic>
 
 namespace rapid
 {
@@ -20,6 +23,21 @@ namespace rapid
 	 */
 	class GraphicsEngine final : public BackendObject
 	{
+	public:
+		/**
+		 * Heap budget structure.
+		 * The budget is how much memory the process can use from the heap. It's the heap's size if the device doesn't
+		 * support VK_EXT_memory_budget.
+		 */
+		struct HeapBudget final
+		{
+			VkDeviceSize m_Usage = 0;
+			VkDeviceSize m_Budget = 0;
+			VkDeviceSize m_AllocatedBytes = 0;	// The bytes allocated by the editor's allocations.
+			VkDeviceSize m_BlockBytes = 0;		// The bytes of the memory blocks the allocations are made from.
+			bool m_IsDeviceLocal = false;
+		};
+
 	public:
 		/**
 		 * Constructor.
@@ -61,6 +79,47 @@ namespace rapid
 		 */
 		void waitIdle() const;
 
+		/**
+		 * Check if a device extension is enabled.
+		 * Optional extensions are only enabled if the physical device supports them.
+		 *
+		 * @param extension The extension name.
+		 * @return Whether or not the extension is enabled.
+		 */
+		bool isExtensionEnabled(std::string_view extension) const;
+
+		/**
+		 * Check if dynamic rendering is enabled.
+		 * If enabled, the window and the render targets render without render passes and frame buffers.
+		 *
+		 * @return Whether or not dynamic rendering is enabled.
+		 */
+		bool isDynamicRenderingEnabled() const { return m_IsDynamicRenderingEnabled; }
+
+		/**
+		 * Check if synchronization2 is enabled.
+		 *
+		 * @return Whether or not synchronization2 is enabled.
+		 */
+		bool isSynchronization2Enabled() const { return m_IsSynchronization2Enabled; }
+
+		/**
+		 * Check if pipeline statistics queries are enabled.
+		 *
+		 * @return Whether or not the device supports pipeline statistics queries.
+		 */
+		bool isPipelineStatisticsEnabled() const { return m_IsPipelineStatisticsEnabled; }
+
+		/**
+		 * Record image memory barriers.
+		 * The barriers are recorded as they are if synchronization2 is enabled. Otherwise they're converted to the legacy
+		 * barriers, whose stages are combined into a single source and destination mask.
+		 *
+		 * @param vCommandBuffer The command buffer to record to.
+		 * @param barriers The barriers to record.
+		 */
+		void recordImageBarriers(VkCommandBuffer vCommandBuffer, const std::vector<VkImageMemoryBarrier2>& barriers) const;
+
 		/**
 		 * Get the device table.
 		 *
@@ -110,6 +169,60 @@ namespace rapid
 		 */
 		Queue getQueue() const { return m_Queue; }
 
+		/**
+		 * Lock the queues.
+		 * Queue submissions and presentation need to be externally synchronized, so this must be held while doing them,
+		 * as they could happen from worker threads.
+		 *
+		 * @return The lock.
+		 */
+		[[nodiscard]] std::unique_lock<std::mutex> lockQueue() const { return std::unique_lock(m_QueueMutex); }
+
+		/**
+		 * Set the current frame index.
+		 * The allocator refreshes the heap budgets once every frame, so this should be called at the start of every frame.
+		 *
+		 * @param frameIndex The frame index. This needs to change every frame.
+		 */
+		void setCurrentFrameIndex(uint32_t frameIndex);
+
+		/**
+		 * Get the current frame index.
+		 * This can be called from any thread.
+		 *
+		 * @return The frame index. This is 0 till the first frame.
+		 */
+		uint32_t getCurrentFrameIndex() const { return m_CurrentFrameIndex; }
+
+		/**
+		 * Get the budgets of the memory heaps.
+		 *
+		 * @return The heap budgets.
+		 */
+		std::vector<HeapBudget> getHeapBudgets() const;
+
+		/**
+		 * Check if the memory budget is tracked.
+		 * If not, the budgets are estimated from the heap sizes.
+		 *
+		 * @return Whether or not VK_EXT_memory_budget is enabled.
+		 */
+		bool isMemoryBudgetEnabled() const { return m_IsMemoryBudgetEnabled; }
+
+		/**
+		 * Get the memory statistics.
+		 *
+		 * @return The statistics.
+		 */
+		MemoryStatistics& getMemoryStatistics() { return m_MemoryStatistics; }
+
+		/**
+		 * Get the memory statistics.
+		 *
+		 * @return The statistics.
+		 */
+		const MemoryStatistics& getMemoryStatistics() const { return m_MemoryStatistics; }
+
 	private:
 		/**
 		 * Initialize the instance.
@@ -143,10 +256,13 @@ namespace rapid
 		VkPhysicalDeviceProperties m_Properties = {};
 
 		Queue m_Queue = {};
+		mutable std::mutex m_QueueMutex;
 
 		std::vector<const char*> m_ValidationLayers = {};
 		std::vector<const char*> m_DeviceExtensions = {};
 
+		MemoryStatistics m_MemoryStatistics;
+
 		VmaAllocator m_vAllocator;
 
 		VkInstance m_Instance = VK_NULL_HANDLE;
@@ -162,6 +278,21 @@ namespace rapid
 		VkCommandPool m_CommandPool = VK_NULL_HANDLE;
 		VkCommandBuffer m_CommandBuffer = VK_NULL_HANDLE;
 
+		std::atomic<uint32_t> m_CurrentFrameIndex = 0;
+
 		bool m_IsRecording = false;
+		bool m_IsDynamicRenderingEnabled = false;
+		bool m_IsSynchronization2Enabled = false;
+		bool m_IsMemoryBudgetEnabled = false;
+		bool m_IsPipelineStatisticsEnabled = false;
 	};
+
+	/**
+	 * Create the ImGui context and set up the editor's style, font and configuration.
+	 * The first graphics engine does this, so this only needs to be called when there's no graphics engine, like when
+	 * using the null window.
+	 *
+	 * @return Whether or not a context was created. Nothing is done if there already is one.
+	 */
+	bool InitializeImGui();
 }
\ No newline at end of file
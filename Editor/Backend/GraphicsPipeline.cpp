@@ -4,10 +4,18 @@
 #include "Utility.hpp"
 
 #include <spdlog/spdlog.h>
+
+#include <algorithm>
 #include <fstream>
 
 namespace
 {
+	/**
+	 * The number of descriptor sets a single descriptor pool can hold.
+	 * Once every pool is full, another one is created.
+	 */
+	constexpr uint32_t DescriptorPoolSetCount = 64;
+
 	/**
 	 * Get the stage flag bits from the flags.
 	 *
@@ -81,8 +89,8 @@ namespace
 
 namespace rapid
 {
-	GraphicsPipeline::GraphicsPipeline(GraphicsEngine& engine, Window& window, std::filesystem::path&& cache, const ShaderCode& vertex, const ShaderCode& fragment)
-		: m_CacheFile(std::move(cache)), m_ShaderCode({ vertex, fragment }), m_Engine(engine), m_Window(window)
+	GraphicsPipeline::GraphicsPipeline(GraphicsEngine& engine, Window& window, std::filesystem::path&& cache, const ShaderCode& vertex, const ShaderCode& fragment, VkVertexInputRate inputRate)
+		: m_CacheFile(std::move(cache)), m_ShaderCode({ vertex, fragment }), m_Engine(engine), m_Window(window), m_InputRate(inputRate)
 	{
 		// Create one binding blob.
 		std::vector<VkDescriptorSetLayoutBinding> layoutBindings(vertex.m_LayoutBindings.begin(), vertex.m_LayoutBindings.end());
@@ -114,6 +122,9 @@ namespace rapid
 		// Load pipeline cache and creat the pipeline.
 		loadPipelineCache();
 		createPipeline();
+
+		// The driver owns the pipeline's memory, so only the pipeline is counted.
+		m_Engine.getMemoryStatistics().add(MemoryCategory::Pipeline);
 	}
 
 	GraphicsPipeline::~GraphicsPipeline()
@@ -128,8 +139,15 @@ namespace rapid
 		m_Engine.getDeviceTable().vkDestroyPipelineCache(m_Engine.getLogicalDevice(), m_PipelineCache, nullptr);
 		m_Engine.getDeviceTable().vkDestroyPipelineLayout(m_Engine.getLogicalDevice(), m_PipelineLayout, nullptr);
 		m_Engine.getDeviceTable().vkDestroyDescriptorSetLayout(m_Engine.getLogicalDevice(), m_DescriptorSetLayout, nullptr);
-		m_Engine.getDeviceTable().vkDestroyDescriptorPool(m_Engine.getLogicalDevice(), m_DescriptorPool, nullptr);
 
+		// Destroying the pools frees all of their sets.
+		m_ShaderResources.clear();
+		for (const auto& pool : m_DescriptorPools)
+			m_Engine.getDeviceTable().vkDestroyDescriptorPool(m_Engine.getLogicalDevice(), pool.m_Pool, nullptr);
+
+		m_DescriptorPools.clear();
+
+		m_Engine.getMemoryStatistics().remove(MemoryCategory::Pipeline);
 		m_IsTerminated = true;
 	}
 
@@ -141,45 +159,90 @@ namespace rapid
 
 	ShaderResource& GraphicsPipeline::createShaderResource()
 	{
-		// First, let's create a new descriptor pool.
-		VkDescriptorPoolCreateInfo poolCreateInfo = {
-			.sType = VK_STRUCTURE_TYPE_DESCRIPTOR_POOL_CREATE_INFO,
-			.pNext = nullptr,
-			.flags = 0,
-			.maxSets = static_cast<uint32_t>(m_ShaderResources.size()) + 1,
-			.poolSizeCount = static_cast<uint32_t>(m_DescriptorPoolSizes.size()),
-			.pPoolSizes = m_DescriptorPoolSizes.data()
-		};
-
-		VkDescriptorPool vDescriptorPool = VK_NULL_HANDLE;
-		utility::ValidateResult(m_Engine.getDeviceTable().vkCreateDescriptorPool(m_Engine.getLogicalDevice(), &poolCreateInfo, nullptr, &vDescriptorPool), "Failed to create the descriptor pool!");
-
-		// Allocate the new descriptor sets.
 		VkDescriptorSetAllocateInfo allocateInfo = {
 			.sType = VK_STRUCTURE_TYPE_DESCRIPTOR_SET_ALLOCATE_INFO,
 			.pNext = nullptr,
-			.descriptorPool = vDescriptorPool,
+			.descriptorPool = VK_NULL_HANDLE,
 			.descriptorSetCount = 1,
 			.pSetLayouts = &m_DescriptorSetLayout
 		};
 
-		// Now for every resource, we create the new descriptor set and update it.
-		for (auto& resource : m_ShaderResources)
+		// Allocate from the first pool which has room. A pool can still fail if its memory is fragmented, in which case
+		// the next one is tried.
+		VkDescriptorSet vDescriptorSet = VK_NULL_HANDLE;
+		for (auto& pool : m_DescriptorPools)
 		{
-			VkDescriptorSet vDescriptorSet = VK_NULL_HANDLE;
+			if (pool.m_FreeSetCount == 0)
+				continue;
+
+			allocateInfo.descriptorPool = pool.m_Pool;
+			if (m_Engine.getDeviceTable().vkAllocateDescriptorSets(m_Engine.getLogicalDevice(), &allocateInfo, &vDescriptorSet) == VK_SUCCESS)
+			{
+				pool.m_FreeSetCount--;
+				break;
+			}
+
+			vDescriptorSet = VK_NULL_HANDLE;
+		}
+
+		// Every pool is full, so add another one. The existing sets stay where they are.
+		if (vDescriptorSet == VK_NULL_HANDLE)
+		{
+			auto& pool = createDescriptorPool();
+			allocateInfo.descriptorPool = pool.m_Pool;
+
 			utility::ValidateResult(m_Engine.getDeviceTable().vkAllocateDescriptorSets(m_Engine.getLogicalDevice(), &allocateInfo, &vDescriptorSet), "Failed to allocate descriptor set!");
+			pool.m_FreeSetCount--;
+		}
 
-			resource->update(vDescriptorSet);
+		return *m_ShaderResources.emplace_back(std::make_unique<ShaderResource>(m_Engine, m_DescriptorSetLayout, allocateInfo.descriptorPool, vDescriptorSet));
+	}
+
+	void GraphicsPipeline::destroyShaderResource(ShaderResource& resource)
+	{
+		const auto iterator = std::find_if(m_ShaderResources.begin(), m_ShaderResources.end(), [&resource](const std::unique_ptr<ShaderResource>& pResource) { return pResource.get() == &resource; });
+		if (iterator == m_ShaderResources.end())
+		{
+			spdlog::warn("Trying to destroy a shader resource which was not created by the pipeline!");
+			return;
 		}
 
-		// Destroy the old pool and assign the new one.
-		m_Engine.getDeviceTable().vkDestroyDescriptorPool(m_Engine.getLogicalDevice(), m_DescriptorPool, nullptr);
-		m_DescriptorPool = vDescriptorPool;
+		// Return the set to its pool so it can be allocated again.
+		const auto vDescriptorPool = resource.getDescriptorPool();
+		const auto vDescriptorSet = resource.getDescriptorSet();
+		utility::ValidateResult(m_Engine.getDeviceTable().vkFreeDescriptorSets(m_Engine.getLogicalDevice(), vDescriptorPool, 1, &vDescriptorSet), "Failed to free the descriptor set!");
 
-		// Finally, lets create the new descriptor set, assign it to the resource and return its reference.
-		VkDescriptorSet vDescriptorSet = VK_NULL_HANDLE;
-		utility::ValidateResult(m_Engine.getDeviceTable().vkAllocateDescriptorSets(m_Engine.getLogicalDevice(), &allocateInfo, &vDescriptorSet), "Failed to allocate descriptor set!");
-		return *m_ShaderResources.emplace_back(std::make_unique<ShaderResource>(m_Engine, m_DescriptorSetLayout, vDescriptorSet));
+		for (auto& pool : m_DescriptorPools)
+		{
+			if (pool.m_Pool == vDescriptorPool)
+				pool.m_FreeSetCount++;
+		}
+
+		// The order of the resources doesn't matter, so the last one is moved into the gap.
+		std::iter_swap(iterator, m_ShaderResources.end() - 1);
+		m_ShaderResources.pop_back();
+	}
+
+	GraphicsPipeline::DescriptorPool& GraphicsPipeline::createDescriptorPool()
+	{
+		// Every pool has room for a fixed number of sets, so the pool sizes are the set's descriptors times that.
+		auto poolSizes = m_DescriptorPoolSizes;
+		for (auto& poolSize : poolSizes)
+			poolSize.descriptorCount *= DescriptorPoolSetCount;
+
+		const VkDescriptorPoolCreateInfo poolCreateInfo = {
+			.sType = VK_STRUCTURE_TYPE_DESCRIPTOR_POOL_CREATE_INFO,
+			.pNext = nullptr,
+			.flags = VK_DESCRIPTOR_POOL_CREATE_FREE_DESCRIPTOR_SET_BIT,
+			.maxSets = DescriptorPoolSetCount,
+			.poolSizeCount = static_cast<uint32_t>(poolSizes.size()),
+			.pPoolSizes = poolSizes.data()
+		};
+
+		auto& pool = m_DescriptorPools.emplace_back(DescriptorPool{ .m_Pool = VK_NULL_HANDLE, .m_FreeSetCount = DescriptorPoolSetCount });
+		utility::ValidateResult(m_Engine.getDeviceTable().vkCreateDescriptorPool(m_Engine.getLogicalDevice(), &poolCreateInfo, nullptr, &pool.m_Pool), "Failed to create the descriptor pool!");
+
+		return pool;
 	}
 
 	void GraphicsPipeline::setupDescriptorSetLayout(std::vector<VkDescriptorSetLayoutBinding>&& bindings)
@@ -282,7 +345,7 @@ namespace rapid
 		std::vector<VkVertexInputAttributeDescription> attributeDescriptions;
 		VkVertexInputBindingDescription bindingDescription = {
 			.binding = 0,
-			.inputRate = VK_VERTEX_INPUT_RATE_VERTEX
+			.inputRate = m_InputRate
 		};
 
 		VkPipelineShaderStageCreateInfo shaderStageCreateInfo = {
@@ -461,10 +524,22 @@ namespace rapid
 			.pDynamicStates = dynamicStates.data()
 		};
 
+		// With dynamic rendering, the pipeline only needs to know the attachment format.
+		const auto colorFormat = m_Window.getSwapchainFormat();
+		const VkPipelineRenderingCreateInfo renderingCreateInfo = {
+			.sType = VK_STRUCTURE_TYPE_PIPELINE_RENDERING_CREATE_INFO,
+			.pNext = nullptr,
+			.viewMask = 0,
+			.colorAttachmentCount = 1,
+			.pColorAttachmentFormats = &colorFormat,
+			.depthAttachmentFormat = VK_FORMAT_UNDEFINED,
+			.stencilAttachmentFormat = VK_FORMAT_UNDEFINED
+		};
+
 		// Setup pipeline create info.
 		VkGraphicsPipelineCreateInfo pipeineCreateInfo = {
 			.sType = VK_STRUCTURE_TYPE_GRAPHICS_PIPELINE_CREATE_INFO,
-			.pNext = nullptr,
+			.pNext = m_Engine.isDynamicRenderingEnabled() ? &renderingCreateInfo : nullptr,
 			.flags = 0,
 			.stageCount = static_cast<uint32_t>(shaderStageCreateInfos.size()),
 			.pStages = shaderStageCreateInfos.data(),
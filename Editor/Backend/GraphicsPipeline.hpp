@@ -25,8 +25,9 @@ namespace rapid
 		 * @param cache The cache file name.
 		 * @param vertex The vertex shader code.
 		 * @param fragment The fragment shader code.
+		 * @param inputRate The rate the vertex inputs advance at. Use VK_VERTEX_INPUT_RATE_INSTANCE for per instance data. Default is VK_VERTEX_INPUT_RATE_VERTEX.
 		 */
-		explicit GraphicsPipeline(GraphicsEngine& engine, Window& window, std::filesystem::path&& cache, const ShaderCode& vertex, const ShaderCode& fragment);
+		explicit GraphicsPipeline(GraphicsEngine& engine, Window& window, std::filesystem::path&& cache, const ShaderCode& vertex, const ShaderCode& fragment, VkVertexInputRate inputRate = VK_VERTEX_INPUT_RATE_VERTEX);
 
 		/**
 		 * Destructor.
@@ -45,9 +46,21 @@ namespace rapid
 
 		/**
 		 * Create a new shader resource.
+		 * The descriptor set is allocated from a fixed size pool. Another pool is added once all of them are full, so the
+		 * existing sets are never moved or rewritten.
+		 *
+		 * @return The shader resource. This is owned by the pipeline.
 		 */
 		ShaderResource& createShaderResource();
 
+		/**
+		 * Destroy a shader resource.
+		 * Its descriptor set is returned to its pool. The resource must not be used by any frame in flight.
+		 *
+		 * @param resource The resource to destroy.
+		 */
+		void destroyShaderResource(ShaderResource& resource);
+
 		/**
 		 * Get the pipeline handle.
 		 *
@@ -63,6 +76,22 @@ namespace rapid
 		VkPipelineLayout getPipelineLayout() const { return m_PipelineLayout; }
 
 	private:
+		/**
+		 * Descriptor pool structure.
+		 */
+		struct DescriptorPool final
+		{
+			VkDescriptorPool m_Pool = VK_NULL_HANDLE;
+			uint32_t m_FreeSetCount = 0;
+		};
+
+		/**
+		 * Create a new descriptor pool.
+		 *
+		 * @return The created pool.
+		 */
+		DescriptorPool& createDescriptorPool();
+
 		/**
 		 * Setup the descriptor set layout.
 		 *
@@ -97,6 +126,7 @@ namespace rapid
 		std::vector<ShaderCode> m_ShaderCode = {};	// This is not the best move, but we need it for pipeline re-creation.
 		std::vector<VkDescriptorPoolSize> m_DescriptorPoolSizes = {};
 		std::vector<std::unique_ptr<ShaderResource>> m_ShaderResources = {};
+		std::vector<DescriptorPool> m_DescriptorPools = {};
 
 		GraphicsEngine& m_Engine;
 		Window& m_Window;
@@ -106,6 +136,7 @@ namespace rapid
 		VkPipelineLayout m_PipelineLayout = VK_NULL_HANDLE;
 
 		VkDescriptorSetLayout m_DescriptorSetLayout = VK_NULL_HANDLE;
-		VkDescriptorPool m_DescriptorPool = VK_NULL_HANDLE;
+
+		const VkVertexInputRate m_InputRate;
 	};
 }
\ No newline at end of file
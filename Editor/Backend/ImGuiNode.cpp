@@ -2,11 +2,21 @@
 
 #include "ImGuiNode.hpp"
 #include "Window.hpp"
+#include "Utility.hpp"
+#include "FontAtlasCache.hpp"
+
+#include "Core/StreamingCopy.hpp"
+#include "Core/Hash.hpp"
+#include "Core/DistanceField.hpp"
 
 #include <imgui.h>
 #include <SDL.h>
+#include <spdlog/spdlog.h>
 
 #include <array>
+#include <algorithm>
+#include <cmath>
+#include <span>
 
 using vec2 = std::array<float, 2>;
 
@@ -14,6 +24,17 @@ namespace
 {
 	constexpr uint64_t ElementCount = 2500;
 
+	constexpr float DistanceFieldFontSize = 32.0f;
+	constexpr int32_t DistanceFieldSpread = 4;
+
+	// Only the alpha channel of a font atlas is needed, so atlases are stored as single channel images and swizzled to (1, 1, 1, alpha).
+	constexpr VkComponentMapping AlphaSwizzle = {
+		.r = VK_COMPONENT_SWIZZLE_ONE,
+		.g = VK_COMPONENT_SWIZZLE_ONE,
+		.b = VK_COMPONENT_SWIZZLE_ONE,
+		.a = VK_COMPONENT_SWIZZLE_R
+	};
+
 	/**
 	 * Get the new vertex buffer size.
 	 * This will compute a bit more than what we actually need because then we don't have to recreate and update the vertex buffers all the time.
@@ -58,6 +79,173 @@ namespace
 	 * @return The vector.
 	 */
 	vec2 ToVec2(float x, float y) { return { x, y }; }
+
+	/**
+	 * Get the SDL window of a viewport.
+	 *
+	 * @param pViewport The ImGui viewport.
+	 * @return The window handle.
+	 */
+	SDL_Window* GetWindowHandle(const ImGuiViewport* pViewport)
+	{
+		return static_cast<SDL_Window*>(pViewport->PlatformHandle);
+	}
+
+	/**
+	 * Show a platform window.
+	 *
+	 * @param pViewport The ImGui viewport.
+	 */
+	void ShowPlatformWindow(ImGuiViewport* pViewport)
+	{
+		SDL_ShowWindow(GetWindowHandle(pViewport));
+	}
+
+	/**
+	 * Set the position of a platform window.
+	 *
+	 * @param pViewport The ImGui viewport.
+	 * @param position The position in desktop coordinates.
+	 */
+	void SetPlatformWindowPosition(ImGuiViewport* pViewport, ImVec2 position)
+	{
+		SDL_SetWindowPosition(GetWindowHandle(pViewport), static_cast<int32_t>(position.x), static_cast<int32_t>(position.y));
+	}
+
+	/**
+	 * Get the position of a platform window.
+	 *
+	 * @param pViewport The ImGui viewport.
+	 * @return The position in desktop coordinates.
+	 */
+	ImVec2 GetPlatformWindowPosition(ImGuiViewport* pViewport)
+	{
+		int32_t x = 0, y = 0;
+		SDL_GetWindowPosition(GetWindowHandle(pViewport), &x, &y);
+		return ImVec2(static_cast<float>(x), static_cast<float>(y));
+	}
+
+	/**
+	 * Set the size of a platform window.
+	 *
+	 * @param pViewport The ImGui viewport.
+	 * @param size The new size.
+	 */
+	void SetPlatformWindowSize(ImGuiViewport* pViewport, ImVec2 size)
+	{
+		SDL_SetWindowSize(GetWindowHandle(pViewport), static_cast<int32_t>(size.x), static_cast<int32_t>(size.y));
+
+		// The main viewport doesn't have a viewport object, the window handles its own resizes.
+		if (const auto pPlatformViewport = static_cast<rapid::Viewport*>(pViewport->PlatformUserData))
+			pPlatformViewport->invalidateSwapchain();
+	}
+
+	/**
+	 * Get the size of a platform window.
+	 *
+	 * @param pViewport The ImGui viewport.
+	 * @return The size.
+	 */
+	ImVec2 GetPlatformWindowSize(ImGuiViewport* pViewport)
+	{
+		int32_t width = 0, height = 0;
+		SDL_GetWindowSize(GetWindowHandle(pViewport), &width, &height);
+		return ImVec2(static_cast<float>(width), static_cast<float>(height));
+	}
+
+	/**
+	 * Focus a platform window.
+	 *
+	 * @param pViewport The ImGui viewport.
+	 */
+	void SetPlatformWindowFocus(ImGuiViewport* pViewport)
+	{
+		SDL_RaiseWindow(GetWindowHandle(pViewport));
+	}
+
+	/**
+	 * Check if a platform window has the keyboard focus.
+	 *
+	 * @param pViewport The ImGui viewport.
+	 * @return Whether or not the window is focused.
+	 */
+	bool GetPlatformWindowFocus(ImGuiViewport* pViewport)
+	{
+		return SDL_GetWindowFlags(GetWindowHandle(pViewport)) & SDL_WINDOW_INPUT_FOCUS;
+	}
+
+	/**
+	 * Check if a platform window is minimized.
+	 *
+	 * @param pViewport The ImGui viewport.
+	 * @return Whether or not the window is minimized.
+	 */
+	bool GetPlatformWindowMinimized(ImGuiViewport* pViewport)
+	{
+		return SDL_GetWindowFlags(GetWindowHandle(pViewport)) & SDL_WINDOW_MINIMIZED;
+	}
+
+	/**
+	 * Set the title of a platform window.
+	 *
+	 * @param pViewport The ImGui viewport.
+	 * @param title The title.
+	 */
+	void SetPlatformWindowTitle(ImGuiViewport* pViewport, const char* title)
+	{
+		SDL_SetWindowTitle(GetWindowHandle(pViewport), title);
+	}
+
+	/**
+	 * Set the opacity of a platform window.
+	 *
+	 * @param pViewport The ImGui viewport.
+	 * @param alpha The opacity.
+	 */
+	void SetPlatformWindowAlpha(ImGuiViewport* pViewport, float alpha)
+	{
+		SDL_SetWindowOpacity(GetWindowHandle(pViewport), alpha);
+	}
+
+	/**
+	 * Update ImGui's monitor list using the displays reported by SDL.
+	 * ImGui uses these to keep the platform windows on the screen.
+	 */
+	void UpdateMonitors()
+	{
+		auto& platformIO = ImGui::GetPlatformIO();
+		platformIO.Monitors.resize(0);
+
+		const auto displayCount = SDL_GetNumVideoDisplays();
+		for (int32_t i = 0; i < displayCount; i++)
+		{
+			SDL_Rect bounds = {}, usableBounds = {};
+			if (SDL_GetDisplayBounds(i, &bounds) != 0)
+				continue;
+
+			// The usable bounds exclude the task bars and docks. Fall back to the whole display if they're not available.
+			if (SDL_GetDisplayUsableBounds(i, &usableBounds) != 0)
+				usableBounds = bounds;
+
+			ImGuiPlatformMonitor monitor = {};
+			monitor.MainPos = ImVec2(static_cast<float>(bounds.x), static_cast<float>(bounds.y));
+			monitor.MainSize = ImVec2(static_cast<float>(bounds.w), static_cast<float>(bounds.h));
+			monitor.WorkPos = ImVec2(static_cast<float>(usableBounds.x), static_cast<float>(usableBounds.y));
+			monitor.WorkSize = ImVec2(static_cast<float>(usableBounds.w), static_cast<float>(usableBounds.h));
+
+			platformIO.Monitors.push_back(monitor);
+		}
+	}
+
+	/**
+	 * Push constants structure.
+	 * This is used to transform the vertices from screen space to clip space.
+	 */
+	struct PushConstants final
+	{
+		vec2 m_Scale = ToVec2(1.0f);
+		vec2 m_Translate = ToVec2(1.0f);
+	};
 }
 
 namespace rapid
@@ -65,21 +253,25 @@ namespace rapid
 	ImGuiNode::ImGuiNode(GraphicsEngine& engine, Window& window)
 		: ProcessingNode(engine, window)
 	{
-		// Load the font image to a Vulkan image.
-		std::byte* pFontImageData = nullptr;
-		int32_t width = 0, height = 0, bitsPerPixel = 0;
-
+		// Load the font atlas. This will use the baked atlas from the cache if available, so we don't have to rasterize the glyphs.
 		ImGuiIO& imGuiIO = ImGui::GetIO();
-		imGuiIO.Fonts->GetTexDataAsRGBA32(reinterpret_cast<uint8_t**>(&pFontImageData), &width, &height, &bitsPerPixel);
+		{
+			const auto fontAtlasCache = FontAtlasCache(*imGuiIO.Fonts);
+			m_FontImage = std::make_unique<Image>(m_Engine, VkExtent3D{ fontAtlasCache.width(), fontAtlasCache.height(), 1u }, VkFormat::VK_FORMAT_R8_UNORM, fontAtlasCache.data(), AlphaSwizzle);
+			m_FontImage->changeImageLayout(VK_IMAGE_LAYOUT_SHADER_READ_ONLY_OPTIMAL);
+		}
 
-		m_FontImage = std::make_unique<Image>(m_Engine, VkExtent3D{ static_cast<uint32_t>(width), static_cast<uint32_t>(height), 1u }, VkFormat::VK_FORMAT_R8G8B8A8_UNORM, pFontImageData);
-		m_FontImage->changeImageLayout(VK_IMAGE_LAYOUT_SHADER_READ_ONLY_OPTIMAL);
+		// We don't need the pixels on the CPU side anymore.
+		imGuiIO.Fonts->ClearTexData();
 
 		// Also set the window size.
 		const auto windowExtent = m_Window.extent();
 		imGuiIO.DisplaySize.x = windowExtent.width;
 		imGuiIO.DisplaySize.y = windowExtent.height;
 
+		// The draw calls use the command's vertex offset, so large draw lists don't run out of 16 bit indices.
+		imGuiIO.BackendFlags |= ImGuiBackendFlags_RendererHasVtxOffset;
+
 		// The vertex shader needs to be treated differently, because we need to switch data types.
 		auto vertexShader = rapid::ShaderCode("Shaders/vert.spv", VkShaderStageFlagBits::VK_SHADER_STAGE_VERTEX_BIT);
 		vertexShader.m_InputAttributes[2].m_Size = 4;
@@ -89,16 +281,27 @@ namespace rapid
 			vertexShader,
 			rapid::ShaderCode("Shaders/frag.spv", VkShaderStageFlagBits::VK_SHADER_STAGE_FRAGMENT_BIT));
 
-		// Setup shader resources.
-		for (uint8_t i = 0; i < m_Window.frameCount(); i++)
+		// Setup the texture registry and register the font image.
+		m_TextureRegistry = std::make_unique<TextureRegistry>(*m_Pipeline, 0);
+		imGuiIO.Fonts->SetTexID(m_TextureRegistry->registerTexture(*m_FontImage));
+
+		// Create the texture atlas and the image loader. Their images are registered in the same registry.
+		m_TextureAtlas = std::make_unique<TextureAtlas>(m_Engine, m_Window, *m_TextureRegistry);
+		m_ImageLoader = std::make_unique<ImageLoader>(m_Engine, m_Window, *m_TextureRegistry, *m_TextureAtlas);
+
+		// Create the distance field font. This uses the font data of the default font, so it needs to be done before clearing the atlas' input data.
+		createDistanceFieldFont(vertexShader);
+
+		// Create the vertex and index buffers. Every frame in flight has its own, so they can be written while the previous frames are rendered.
+		for (uint32_t i = 0; i < m_Window.frameCount(); i++)
 		{
-			auto& resource = m_ShaderResources.emplace_back(&m_Pipeline->createShaderResource());
-			resource->bindResource(0, *m_FontImage);
+			m_VertexBuffers.emplace_back(std::make_unique<Buffer>(m_Engine, GetNewVertexBufferSize(0), BufferType::ShallowVertex));
+			m_IndexBuffers.emplace_back(std::make_unique<Buffer>(m_Engine, GetNewIndexBufferSize(0), BufferType::ShallowIndex));
 		}
 
-		// Create the vertex and index buffers.
-		m_VertexBuffer = std::make_unique<Buffer>(m_Engine, GetNewVertexBufferSize(0), BufferType::ShallowVertex);
-		m_IndexBuffer = std::make_unique<Buffer>(m_Engine, GetNewIndexBufferSize(0), BufferType::ShallowIndex);
+		// Let ImGui create its platform windows, if multi-viewports are enabled.
+		if (imGuiIO.ConfigFlags & ImGuiConfigFlags_ViewportsEnable)
+			setupViewports();
 	}
 
 	ImGuiNode::~ImGuiNode()
@@ -109,19 +312,67 @@ namespace rapid
 
 	void ImGuiNode::terminate()
 	{
+		// The platform windows are viewports of the window, so they're destroyed while the node can still clean up after them.
+		auto& imGuiIO = ImGui::GetIO();
+		if (imGuiIO.BackendPlatformUserData == this)
+		{
+			ImGui::DestroyPlatformWindows();
+			imGuiIO.BackendPlatformUserData = nullptr;
+			imGuiIO.BackendFlags &= ~(ImGuiBackendFlags_PlatformHasViewports | ImGuiBackendFlags_RendererHasViewports);
+		}
+
+		m_RetainedLayers.clear();
+		m_LinkRenderers.clear();
+		m_ImageLoader.reset();
+		m_TextureAtlas.reset();
+
+		// Wait till the rebuild is done and destroy all the atlases which are not in use.
+		m_FontAtlasBuilder.reset();
+		for (auto& retired : m_RetiredFontAtlases)
+		{
+			retired.m_Image->terminate();
+			IM_DELETE(retired.m_pAtlas);
+		}
+
+		m_RetiredFontAtlases.clear();
+
 		m_Pipeline->terminate();
 		m_FontImage->terminate();
+
+		if (m_DistanceFieldPipeline)
+			m_DistanceFieldPipeline->terminate();
+
+		if (m_DistanceFieldImage)
+			m_DistanceFieldImage->terminate();
+
 		m_IsTerminated = true;
 	}
 
-	void ImGuiNode::onPollEvents(SDL_Event& events)
+	void ImGuiNode::onPollEvents(const std::vector<SDL_Event>& events)
 	{
-		ImGui::NewFrame();
+		// The font atlas can only be swapped before starting the new frame.
+		updateFontAtlas();
+
+		// Transmit events to ImGui. This needs to happen before starting the new frame so that they're all seen by this frame.
+		for (const auto& sdlEvent : events)
+			processEvent(sdlEvent);
 
-		// Resolve the time delta.
+		// Resolve the time delta. Two polls can share a clock tick, so the delta is at least a tick.
 		auto newTime = clock_type::now();
-		const auto diff = newTime - m_TimePoint;
+		const auto diff = std::max(newTime - m_TimePoint, clock_type::duration(1));
 
+		auto& imGuiIO = ImGui::GetIO();
+		imGuiIO.Framerate = std::nano::den / diff.count();
+		imGuiIO.DeltaTime = diff.count() / static_cast<float>(std::nano::den);
+
+		ImGui::NewFrame();
+		BeginDockSpace();
+
+		m_TimePoint = newTime;
+	}
+
+	void ImGuiNode::BeginDockSpace()
+	{
 		const ImGuiViewport* viewport = ImGui::GetMainViewport();
 		ImGui::SetNextWindowPos(viewport->WorkPos);
 		ImGui::SetNextWindowSize(viewport->WorkSize);
@@ -144,267 +395,774 @@ namespace rapid
 
 		ImGui::PopStyleVar(3);
 		ImGui::DockSpace(ImGui::GetID("EditorDockSpace"), ImVec2(0.0f, 0.0f), ImGuiDockNodeFlags_PassthruCentralNode);
+	}
 
-		// Transmit events to ImGui.
+	void ImGuiNode::endFrame()
+	{
+		ImGui::End();
+		ImGui::Render();
+
+		// The render thread could pick the frame up after the next one has started, so the draw data is copied.
+		if (const auto pDrawData = ImGui::GetDrawData())
 		{
-			auto& imGuiIO = ImGui::GetIO();
-			imGuiIO.Framerate = std::nano::den / diff.count();
-			imGuiIO.DeltaTime = diff.count() / static_cast<float>(std::nano::den);
+			m_PendingDrawData.capture(*pDrawData);
+			m_HasPendingDrawData = true;
+		}
+
+		// Create, move and destroy the platform windows, and copy what they draw. The window renders them along with its own frame.
+		if (ImGui::GetIO().ConfigFlags & ImGuiConfigFlags_ViewportsEnable)
+		{
+			ImGui::UpdatePlatformWindows();
 
-			switch (events.type)
+			const auto& platformIO = ImGui::GetPlatformIO();
+			for (int32_t i = 1; i < platformIO.Viewports.Size; i++)
 			{
-			case SDL_KEYDOWN:
-				resolveKeyboardInputs(events.key.keysym.scancode, true);
-				//imGuiIO.AddKeyEvent(ImGuiKey_LeftCtrl, events.key.keysym.mod & KMOD_LCTRL);
-				//imGuiIO.AddKeyEvent(ImGuiKey_LeftShift, events.key.keysym.mod & KMOD_LSHIFT);
-				//imGuiIO.AddKeyEvent(ImGuiKey_LeftAlt, events.key.keysym.mod & KMOD_LALT);
-				//
-				//imGuiIO.AddKeyEvent(ImGuiKey_RightCtrl, events.key.keysym.mod & KMOD_RCTRL);
-				//imGuiIO.AddKeyEvent(ImGuiKey_RightShift, events.key.keysym.mod & KMOD_RSHIFT);
-				//imGuiIO.AddKeyEvent(ImGuiKey_RightAlt, events.key.keysym.mod & KMOD_RALT);
-
-				if (events.key.keysym.mod & KMOD_CTRL)
-					imGuiIO.KeyMods |= ImGuiModFlags_Ctrl;
-
-				if (events.key.keysym.mod & KMOD_SHIFT)
-					imGuiIO.KeyMods |= ImGuiModFlags_Shift;
-
-				if (events.key.keysym.mod & KMOD_ALT)
-					imGuiIO.KeyMods |= ImGuiModFlags_Alt;
-
-				if (events.key.keysym.mod & KMOD_GUI)
-					imGuiIO.KeyMods |= ImGuiModFlags_Super;
-
-				break;
-
-			case SDL_KEYUP:
-				resolveKeyboardInputs(events.key.keysym.scancode, false);
-				//imGuiIO.AddKeyEvent(ImGuiKey_LeftCtrl, events.key.keysym.mod & KMOD_LCTRL);
-				//imGuiIO.AddKeyEvent(ImGuiKey_LeftShift, events.key.keysym.mod & KMOD_LSHIFT);
-				//imGuiIO.AddKeyEvent(ImGuiKey_LeftAlt, events.key.keysym.mod & KMOD_LALT);
-				//
-				//imGuiIO.AddKeyEvent(ImGuiKey_RightCtrl, events.key.keysym.mod & KMOD_RCTRL);
-				//imGuiIO.AddKeyEvent(ImGuiKey_RightShift, events.key.keysym.mod & KMOD_RSHIFT);
-				//imGuiIO.AddKeyEvent(ImGuiKey_RightAlt, events.key.keysym.mod & KMOD_RALT);
-
-				//if (events.key.keysym.mod & KMOD_CTRL)
-				//	imGuiIO.KeyMods |= ImGuiModFlags_Ctrl;
-				//
-				//if (events.key.keysym.mod & KMOD_SHIFT)
-				//	imGuiIO.KeyMods |= ImGuiModFlags_Shift;
-				//
-				//if (events.key.keysym.mod & KMOD_ALT)
-				//	imGuiIO.KeyMods |= ImGuiModFlags_Alt;
-				//
-				//if (events.key.keysym.mod & KMOD_GUI)
-				//	imGuiIO.KeyMods |= ImGuiModFlags_Super;
-
-				break;
-
-			case SDL_TEXTINPUT:
-				imGuiIO.AddInputCharactersUTF8(events.text.text);
-				break;
-
-			case SDL_MOUSEBUTTONDOWN:
-				// Left mouse button press.
-				if (events.button.button == SDL_BUTTON_LEFT)
+				const auto pViewport = platformIO.Viewports[i];
+				if (!pViewport->DrawData || pViewport->Flags & ImGuiViewportFlags_Minimized)
+					continue;
+
+				const auto itr = m_ViewportResources.find(static_cast<const Viewport*>(pViewport->PlatformUserData));
+				if (itr != m_ViewportResources.end())
 				{
-					imGuiIO.AddMouseButtonEvent(ImGuiMouseButton_Left, true);
-					imGuiIO.MouseClickedCount[ImGuiMouseButton_Left] = events.button.clicks;
+					itr->second.m_PendingDrawData.capture(*pViewport->DrawData);
+					itr->second.m_HasPendingDrawData = true;
 				}
+			}
+		}
+	}
+
+	void ImGuiNode::swapFrame(uint32_t frameIndex)
+	{
+		if (m_HasPendingDrawData)
+		{
+			std::swap(m_DrawData, m_PendingDrawData);
+			m_HasPendingDrawData = false;
+		}
 
+		for (auto& [pViewport, resources] : m_ViewportResources)
+		{
+			if (resources.m_HasPendingDrawData)
+			{
+				std::swap(resources.m_DrawData, resources.m_PendingDrawData);
+				resources.m_HasPendingDrawData = false;
+			}
+		}
 
-				// Right mouse button press.
-				if (events.button.button == SDL_BUTTON_RIGHT)
-				{
-					imGuiIO.AddMouseButtonEvent(ImGuiMouseButton_Right, true);
-					imGuiIO.MouseClickedCount[ImGuiMouseButton_Right] = events.button.clicks;
-				}
+		// Every buffer is written on the render thread, so the uploads are submitted from here as well.
+		m_ImageLoader->update();
+		m_TextureAtlas->update();
 
-				// Middle mouse button press.
-				if (events.button.button == SDL_BUTTON_MIDDLE)
-				{
-					imGuiIO.AddMouseButtonEvent(ImGuiMouseButton_Middle, true);
-					imGuiIO.MouseClickedCount[ImGuiMouseButton_Middle] = events.button.clicks;
-				}
-				break;
+		for (const auto& pLayer : m_RetainedLayers)
+			pLayer->swapFrame();
 
-			case SDL_MOUSEBUTTONUP:
-				// Left mouse button release.
-				if (events.button.button == SDL_BUTTON_LEFT)
-					imGuiIO.AddMouseButtonEvent(ImGuiMouseButton_Left, false);
+		for (const auto& pLinkRenderer : m_LinkRenderers)
+			pLinkRenderer->swapFrame(frameIndex);
+	}
 
-				// Right mouse button release.
-				if (events.button.button == SDL_BUTTON_RIGHT)
-					imGuiIO.AddMouseButtonEvent(ImGuiMouseButton_Right, false);
+	VkRect2D ImGuiNode::prepare(uint32_t frameIndex)
+	{
+		// Update the frame's buffers. Its previous submission is done, so they're not in use.
+		updateBuffers(m_DrawData, m_VertexBuffers[frameIndex], m_IndexBuffers[frameIndex]);
 
-				// Middle mouse button release.
-				if (events.button.button == SDL_BUTTON_MIDDLE)
-					imGuiIO.AddMouseButtonEvent(ImGuiMouseButton_Middle, false);
-				break;
+		return resolveDamage();
+	}
 
-			case SDL_MOUSEMOTION:
-				imGuiIO.MousePos.x = static_cast<float>(events.motion.x);
-				imGuiIO.MousePos.y = static_cast<float>(events.motion.y);
-				break;
+	void ImGuiNode::addPasses(RenderGraph& graph, uint32_t frameIndex)
+	{
+		// The defragmented atlas pages are copied before anything draws them.
+		m_SampledResources = m_TextureAtlas->addPasses(graph);
+		for (const auto& pLayer : m_RetainedLayers)
+		{
+			const auto resource = pLayer->addPasses(graph, frameIndex, [this, &layer = *pLayer](CommandBuffer commandBuffer, const VkRect2D& area)
+				{
+					const auto extent = layer.extent();
+					const auto origin = layer.getOrigin();
+
+					const VkViewport viewport = {
+						.x = 0.0f,
+						.y = 0.0f,
+						.width = static_cast<float>(extent.width),
+						.height = static_cast<float>(extent.height),
+						.minDepth = 0.0f,
+						.maxDepth = 1.0f
+					};
 
-			case SDL_MOUSEWHEEL:
-				imGuiIO.AddMouseWheelEvent(events.wheel.preciseX, events.wheel.preciseY);
-				break;
+					commandBuffer.bindViewport(viewport);
 
-			default:
-				break;
-			}
+					// The captured vertices are in screen space, so move them to the layer's origin.
+					DrawState drawState = {
+						.m_pVertexBuffer = &layer.getVertexBuffer(),
+						.m_pIndexBuffer = &layer.getIndexBuffer(),
+						.m_Scale = ImVec2(2.0f / extent.width, 2.0f / extent.height),
+					};
+
+					drawState.m_Translate = ImVec2(-1.0f - origin.x * drawState.m_Scale.x, -1.0f - origin.y * drawState.m_Scale.y);
+
+					setupRenderState(commandBuffer, drawState);
+					drawCommands(commandBuffer, layer.getCommands(), area, 0, 0, drawState);
+				}
+			);
+
+			if (resource)
+				m_SampledResources.emplace_back(*resource);
 		}
+	}
 
-		m_TimePoint = newTime;
+	void ImGuiNode::declareResources(RenderGraph::PassBuilder& builder) const
+	{
+		for (const auto resource : m_SampledResources)
+			builder.read(resource, ResourceUsage::Sampled);
 	}
 
 	void ImGuiNode::bind(CommandBuffer commandBuffer, uint32_t frameIndex)
 	{
-		ImGui::End();
-		ImGui::Render();
+		if (m_DrawData.isValid())
+			drawSnapshot(commandBuffer, m_DrawData, *m_VertexBuffers[frameIndex], *m_IndexBuffers[frameIndex], m_Window.getRenderArea(), &m_Window.getGpuProfiler());
+	}
+
+	void ImGuiNode::bindViewport(CommandBuffer commandBuffer, const Viewport& viewport, uint32_t frameIndex)
+	{
+		const auto itr = m_ViewportResources.find(&viewport);
+		if (itr == m_ViewportResources.end() || !itr->second.m_DrawData.isValid())
+			return;
+
+		auto& resources = itr->second;
+		auto& pVertexBuffer = resources.m_VertexBuffers[frameIndex];
+		auto& pIndexBuffer = resources.m_IndexBuffers[frameIndex];
+		updateBuffers(resources.m_DrawData, pVertexBuffer, pIndexBuffer);
+
+		// Viewports are redrawn completely.
+		const VkRect2D renderArea = { .offset = { 0, 0 }, .extent = viewport.extent() };
+		drawSnapshot(commandBuffer, resources.m_DrawData, *pVertexBuffer, *pIndexBuffer, renderArea);
+	}
+
+	void ImGuiNode::onWindowResize()
+	{
+		m_Pipeline->recreate();
+
+		if (m_DistanceFieldPipeline)
+			m_DistanceFieldPipeline->recreate();
 
-		// Update the buffers.
-		updateBuffers();
+		for (const auto& pLinkRenderer : m_LinkRenderers)
+			pLinkRenderer->recreate();
 
+		// Set the new window size.
+		const auto extent = m_Window.extent();
 		ImGuiIO& imGuiIO = ImGui::GetIO();
-		ImDrawData* pDrawData = ImGui::GetDrawData();
+		imGuiIO.DisplaySize.x = static_cast<float>(extent.width);
+		imGuiIO.DisplaySize.y = static_cast<float>(extent.height);
+	}
+
+	bool ImGuiNode::isAnimating() const
+	{
+		return ImGui::IsAnyItemActive() || ImGui::IsAnyMouseDown() || m_ImageLoader->isBusy();
+	}
+
+	void ImGuiNode::addFont(std::filesystem::path file, float size)
+	{
+		m_FontRequests.emplace_back(FontRequest{ .m_File = std::move(file), .m_Size = size });
+
+		// Start rebuilding if we aren't already. Otherwise the font will be added once the current rebuild is swapped in.
+		if (!m_FontAtlasBuilder)
+			m_FontAtlasBuilder = std::make_unique<FontAtlasBuilder>(m_Engine, *ImGui::GetIO().Fonts, std::exchange(m_FontRequests, {}));
+	}
+
+	RetainedLayer& ImGuiNode::createRetainedLayer()
+	{
+		return *m_RetainedLayers.emplace_back(std::make_unique<RetainedLayer>(m_Engine, m_Window, *m_TextureRegistry));
+	}
 
-		if (!pDrawData)
+	LinkRenderer& ImGuiNode::createLinkRenderer()
+	{
+		return *m_LinkRenderers.emplace_back(std::make_unique<LinkRenderer>(m_Engine, m_Window));
+	}
+
+	void ImGuiNode::setupViewports()
+	{
+		auto& imGuiIO = ImGui::GetIO();
+		imGuiIO.BackendPlatformUserData = this;
+		imGuiIO.BackendFlags |= ImGuiBackendFlags_PlatformHasViewports | ImGuiBackendFlags_RendererHasViewports;
+
+		auto& platformIO = ImGui::GetPlatformIO();
+		platformIO.Platform_CreateWindow = CreatePlatformWindow;
+		platformIO.Platform_DestroyWindow = DestroyPlatformWindow;
+		platformIO.Platform_ShowWindow = ShowPlatformWindow;
+		platformIO.Platform_SetWindowPos = SetPlatformWindowPosition;
+		platformIO.Platform_GetWindowPos = GetPlatformWindowPosition;
+		platformIO.Platform_SetWindowSize = SetPlatformWindowSize;
+		platformIO.Platform_GetWindowSize = GetPlatformWindowSize;
+		platformIO.Platform_SetWindowFocus = SetPlatformWindowFocus;
+		platformIO.Platform_GetWindowFocus = GetPlatformWindowFocus;
+		platformIO.Platform_GetWindowMinimized = GetPlatformWindowMinimized;
+		platformIO.Platform_SetWindowTitle = SetPlatformWindowTitle;
+		platformIO.Platform_SetWindowAlpha = SetPlatformWindowAlpha;
+
+		UpdateMonitors();
+
+		// The main viewport is the node's window.
+		ImGui::GetMainViewport()->PlatformHandle = m_Window.getWindowHandle();
+
+		// Clicking on a viewport which is not focused should click on what's under the cursor, instead of only focusing it.
+		SDL_SetHint(SDL_HINT_MOUSE_FOCUS_CLICKTHROUGH, "1");
+	}
+
+	void ImGuiNode::CreatePlatformWindow(ImGuiViewport* pViewport)
+	{
+		auto& node = *static_cast<ImGuiNode*>(ImGui::GetIO().BackendPlatformUserData);
+
+		// The window is shown once ImGui has placed it.
+		uint32_t windowFlags = SDL_WINDOW_HIDDEN;
+		windowFlags |= pViewport->Flags & ImGuiViewportFlags_NoDecoration ? SDL_WINDOW_BORDERLESS : SDL_WINDOW_RESIZABLE;
+
+		if (pViewport->Flags & ImGuiViewportFlags_NoTaskBarIcon)
+			windowFlags |= SDL_WINDOW_SKIP_TASKBAR;
+
+		if (pViewport->Flags & ImGuiViewportFlags_TopMost)
+			windowFlags |= SDL_WINDOW_ALWAYS_ON_TOP;
+
+		const VkRect2D area = {
+			.offset = { static_cast<int32_t>(pViewport->Pos.x), static_cast<int32_t>(pViewport->Pos.y) },
+			.extent = { static_cast<uint32_t>(pViewport->Size.x), static_cast<uint32_t>(pViewport->Size.y) }
+		};
+
+		auto& viewport = node.m_Window.createViewport("", area, windowFlags);
+		pViewport->PlatformUserData = &viewport;
+		pViewport->PlatformHandle = viewport.getWindowHandle();
+
+		auto& resources = node.m_ViewportResources[&viewport];
+		for (uint32_t i = 0; i < node.m_Window.frameCount(); i++)
+		{
+			resources.m_VertexBuffers.emplace_back(std::make_unique<Buffer>(node.m_Engine, GetNewVertexBufferSize(0), BufferType::ShallowVertex));
+			resources.m_IndexBuffers.emplace_back(std::make_unique<Buffer>(node.m_Engine, GetNewIndexBufferSize(0), BufferType::ShallowIndex));
+		}
+	}
+
+	void ImGuiNode::DestroyPlatformWindow(ImGuiViewport* pViewport)
+	{
+		// The main viewport belongs to the window.
+		const auto pPlatformViewport = static_cast<Viewport*>(pViewport->PlatformUserData);
+		if (!pPlatformViewport)
 			return;
 
-		// Update and Render additional Platform Windows
-		if (imGuiIO.ConfigFlags & ImGuiConfigFlags_ViewportsEnable)
+		auto& node = *static_cast<ImGuiNode*>(ImGui::GetIO().BackendPlatformUserData);
+		const auto itr = node.m_ViewportResources.find(pPlatformViewport);
+
+		// The device is idle once the viewport is destroyed, so the buffers can be destroyed right away.
+		node.m_Window.destroyViewport(*pPlatformViewport);
+		if (itr != node.m_ViewportResources.end())
 		{
-#ifdef RAPID_PLATFORM_WINDOWS
-			ImGui::UpdatePlatformWindows();
-			ImGui::RenderPlatformWindowsDefault();
+			for (const auto& pBuffer : itr->second.m_VertexBuffers)
+				pBuffer->terminate();
+
+			for (const auto& pBuffer : itr->second.m_IndexBuffers)
+				pBuffer->terminate();
 
-#endif
+			node.m_ViewportResources.erase(itr);
 		}
 
-		// Setup push constants.
-		struct PushConstants final
-		{
-			vec2 m_Scale = ToVec2(1.0f);
-			vec2 m_Translate = ToVec2(1.0f);
-		} pushConstants;
+		pViewport->PlatformUserData = nullptr;
+		pViewport->PlatformHandle = nullptr;
+	}
+
+	void ImGuiNode::setupRenderState(CommandBuffer commandBuffer, DrawState& drawState)
+	{
+		const PushConstants pushConstants = {
+			.m_Scale = ToVec2(drawState.m_Scale.x, drawState.m_Scale.y),
+			.m_Translate = ToVec2(drawState.m_Translate.x, drawState.m_Translate.y)
+		};
 
-		pushConstants.m_Scale = ToVec2(2.0f / imGuiIO.DisplaySize.x, 2.0f / imGuiIO.DisplaySize.y);
-		pushConstants.m_Translate = ToVec2(-1.0f);
+		commandBuffer.bindVertexBuffer(*drawState.m_pVertexBuffer);
+		commandBuffer.bindIndexBuffer(*drawState.m_pIndexBuffer, VkIndexType::VK_INDEX_TYPE_UINT16);
+		commandBuffer.bindPipeline(*m_Pipeline);
+		commandBuffer.bindPushConstant(*m_Pipeline, &pushConstants, sizeof(PushConstants), VkShaderStageFlagBits::VK_SHADER_STAGE_VERTEX_BIT);
+
+		drawState.m_pPipeline = m_Pipeline.get();
+		drawState.m_TextureID = nullptr;
+	}
+
+	void ImGuiNode::drawSnapshot(CommandBuffer commandBuffer, const DrawDataSnapshot& drawData, const Buffer& vertexBuffer, const Buffer& indexBuffer, const VkRect2D& renderArea, GpuProfiler* pProfiler)
+	{
+		const auto commandLists = drawData.getCommandLists();
+		if (commandLists.empty())
+			return;
 
 		// Set the viewport.
+		const auto displaySize = drawData.getDisplaySize();
 		const VkViewport viewport = {
 			.x = 0.0f,
 			.y = 0.0f,
-			.width = imGuiIO.DisplaySize.x,
-			.height = imGuiIO.DisplaySize.y,
+			.width = displaySize.x,
+			.height = displaySize.y,
 			.minDepth = 0.0f,
 			.maxDepth = 1.0f
 		};
 
+		commandBuffer.bindViewport(viewport);
+
+		// With multi-viewports, the vertices are in desktop coordinates, so they're moved by the viewport's position.
+		const auto displayPosition = drawData.getDisplayPosition();
+		DrawState drawState = {
+			.m_pVertexBuffer = &vertexBuffer,
+			.m_pIndexBuffer = &indexBuffer,
+			.m_Scale = ImVec2(2.0f / displaySize.x, 2.0f / displaySize.y),
+			.m_ClipOffset = displayPosition,
+			.m_pProfiler = pProfiler
+		};
+
+		drawState.m_Translate = ImVec2(-1.0f - displayPosition.x * drawState.m_Scale.x, -1.0f - displayPosition.y * drawState.m_Scale.y);
+
+		setupRenderState(commandBuffer, drawState);
+
 		// Issue draw calls.
-		if (pDrawData->CmdListsCount)
+		uint64_t vertexOffset = 0, indexOffset = 0;
+		for (const auto& commandList : commandLists)
 		{
-			commandBuffer.bindVertexBuffer(*m_VertexBuffer);
-			commandBuffer.bindIndexBuffer(*m_IndexBuffer, VkIndexType::VK_INDEX_TYPE_UINT16);
-			commandBuffer.bindPipeline(*m_Pipeline);
+			drawCommands(commandBuffer, commandList.m_Commands, renderArea, vertexOffset, indexOffset, drawState);
 
-			uint64_t vertexOffset = 0, indexOffset = 0;
-			for (int32_t i = 0; i < pDrawData->CmdListsCount; i++)
+			vertexOffset += commandList.m_Vertices.size();
+			indexOffset += commandList.m_Indices.size();
+		}
+	}
+
+	void ImGuiNode::drawCommands(CommandBuffer commandBuffer, std::span<const ImDrawCmd> commands, const VkRect2D& renderArea, uint64_t vertexOffset, uint64_t indexOffset, DrawState& drawState)
+	{
+		for (const auto& command : commands)
+		{
+			// Setup scissor. We only have to draw the parts within the render area.
+			const VkRect2D clipRect = {
+				.offset = {
+					.x = static_cast<int32_t>(command.ClipRect.x - drawState.m_ClipOffset.x),
+					.y = static_cast<int32_t>(command.ClipRect.y - drawState.m_ClipOffset.y),
+				},
+				.extent = {
+					.width = static_cast<uint32_t>(std::max(command.ClipRect.z - command.ClipRect.x, 0.0f)),
+					.height = static_cast<uint32_t>(std::max(command.ClipRect.w - command.ClipRect.y, 0.0f)),
+				}
+			};
+
+			const auto scissor = utility::Intersect(clipRect, renderArea);
+
+			if (command.UserCallback == ImDrawCallback_ResetRenderState)
 			{
-				const auto pCommandList = pDrawData->CmdLists[i];
+				setupRenderState(commandBuffer, drawState);
+				continue;
+			}
 
-				for (int32_t j = 0; j < pCommandList->CmdBuffer.Size; j++)
+			// Draw callbacks bind their own pipelines, so the render state needs to be restored afterwards.
+			if (const auto pDrawCallback = DrawCallback::Get(command))
+			{
+				if (!utility::IsEmpty(scissor))
 				{
-					const auto& pCommand = pCommandList->CmdBuffer[j];
-
-					// Setup scissor.
-					const VkRect2D scissor = {
-						.offset = {
-							.x = std::max(static_cast<int32_t>(pCommand.ClipRect.x), 0),
-							.y = std::max(static_cast<int32_t>(pCommand.ClipRect.y), 0),
-						},
-						.extent = {
-							.width = static_cast<uint32_t>(pCommand.ClipRect.z - pCommand.ClipRect.x),
-							.height = static_cast<uint32_t>(pCommand.ClipRect.w - pCommand.ClipRect.y),
-						}
-					};
-
-					// Bind all the resources.
-					commandBuffer.bindShaderResource(*m_Pipeline, *m_ShaderResources[frameIndex]);
-					commandBuffer.bindViewport(viewport);
+					const auto scope = GpuScope(drawState.m_pProfiler, commandBuffer.buffer(), "Draw callback");
 					commandBuffer.bindScissor(scissor);
-					commandBuffer.bindPushConstant(*m_Pipeline, &pushConstants, sizeof(PushConstants), VkShaderStageFlagBits::VK_SHADER_STAGE_VERTEX_BIT);
+					pDrawCallback->draw(commandBuffer, drawState.m_Scale, drawState.m_Translate);
+					setupRenderState(commandBuffer, drawState);
+				}
+
+				continue;
+			}
 
-					// Issue the draw call.
-					commandBuffer.drawIndices(pCommand.ElemCount, indexOffset, vertexOffset);
+			const auto pShaderResource = m_TextureRegistry->getShaderResource(command.TextureId);
+			if (utility::IsEmpty(scissor) || !pShaderResource)
+				continue;
 
-					indexOffset += pCommand.ElemCount;
+			// Only switch the texture when it's different from the last command's.
+			if (command.TextureId != drawState.m_TextureID)
+			{
+				// Distance field textures need their own pipeline. Both pipelines share the same layout, so only the pipeline needs to be switched.
+				const auto pPipeline = m_DistanceFieldPipeline && m_TextureRegistry->isDistanceField(command.TextureId) ? m_DistanceFieldPipeline.get() : m_Pipeline.get();
+				if (pPipeline != drawState.m_pPipeline)
+				{
+					commandBuffer.bindPipeline(*pPipeline);
+					drawState.m_pPipeline = pPipeline;
 				}
 
-				vertexOffset += pCommandList->VtxBuffer.Size;
+				commandBuffer.bindShaderResource(*drawState.m_pPipeline, *pShaderResource);
+				drawState.m_TextureID = command.TextureId;
 			}
+
+			commandBuffer.bindScissor(scissor);
+
+			// Issue the draw call.
+			commandBuffer.drawIndices(command.ElemCount, static_cast<uint32_t>(indexOffset + command.IdxOffset), static_cast<uint32_t>(vertexOffset + command.VtxOffset));
 		}
 	}
 
-	void ImGuiNode::onWindowResize()
+	void ImGuiNode::updateFontAtlas()
 	{
-		m_Pipeline->recreate();
+		m_FrameNumber++;
 
-		// Set the new window size.
-		const auto extent = m_Window.extent();
-		ImGuiIO& imGuiIO = ImGui::GetIO();
-		imGuiIO.DisplaySize.x = static_cast<float>(extent.width);
-		imGuiIO.DisplaySize.y = static_cast<float>(extent.height);
+		// Destroy the retired atlases which are no longer used by any frame.
+		std::erase_if(m_RetiredFontAtlases, [this](RetiredFontAtlas& retired)
+			{
+				if (retired.m_DestroyFrame > m_FrameNumber)
+					return false;
+
+				m_TextureRegistry->unregisterTexture(retired.m_TextureID);
+				retired.m_Image->terminate();
+				IM_DELETE(retired.m_pAtlas);
+				return true;
+			}
+		);
+
+		if (!m_FontAtlasBuilder || !m_FontAtlasBuilder->isReady())
+			return;
+
+		auto result = m_FontAtlasBuilder->get();
+		m_FontAtlasBuilder.reset();
+
+		// The new atlas contains the old fonts in the same order, so the default font can be resolved using its index.
+		auto& imGuiIO = ImGui::GetIO();
+		const auto& oldFonts = imGuiIO.Fonts->Fonts;
+		const auto defaultFontIndex = std::find(oldFonts.begin(), oldFonts.end(), imGuiIO.FontDefault) - oldFonts.begin();
+
+		result.m_pAtlas->SetTexID(m_TextureRegistry->registerTexture(*result.m_Image));
+
+		// Retire the old atlas. The ImGui context owns the atlas it's given, so we have to delete the old one ourselves.
+		m_RetiredFontAtlases.emplace_back(RetiredFontAtlas{
+			.m_pAtlas = imGuiIO.Fonts,
+			.m_Image = std::move(m_FontImage),
+			.m_TextureID = imGuiIO.Fonts->TexID,
+			.m_DestroyFrame = m_FrameNumber + m_Window.retireFrameCount()
+			}
+		);
+
+		imGuiIO.Fonts = result.m_pAtlas;
+		imGuiIO.FontDefault = defaultFontIndex < imGuiIO.Fonts->Fonts.Size ? imGuiIO.Fonts->Fonts[static_cast<int32_t>(defaultFontIndex)] : nullptr;
+		m_FontImage = std::move(result.m_Image);
+
+		// Start the next rebuild if fonts were requested in the meantime.
+		if (!m_FontRequests.empty())
+			m_FontAtlasBuilder = std::make_unique<FontAtlasBuilder>(m_Engine, *imGuiIO.Fonts, std::exchange(m_FontRequests, {}));
+	}
+
+	void ImGuiNode::createDistanceFieldFont(const ShaderCode& vertexShader)
+	{
+		const auto& fontAtlas = *ImGui::GetIO().Fonts;
+		if (fontAtlas.ConfigData.empty())
+		{
+			spdlog::warn("No fonts are loaded, skipping the distance field font.");
+			return;
+		}
+
+		// The padding needs to be at least the spread, so the distances of one glyph won't bleed into another.
+		m_DistanceFieldAtlas = std::make_unique<ImFontAtlas>();
+		m_DistanceFieldAtlas->Flags = ImFontAtlasFlags_NoMouseCursors | ImFontAtlasFlags_NoBakedLines;
+		m_DistanceFieldAtlas->TexGlyphPadding = DistanceFieldSpread;
+
+		// Reuse the default font's data. It's owned by the default atlas, so we must not free it.
+		auto config = fontAtlas.ConfigData[0];
+		config.FontDataOwnedByAtlas = false;
+		config.SizePixels = DistanceFieldFontSize;
+		config.OversampleH = 1;
+		config.OversampleV = 1;
+		config.PixelSnapH = false;
+		config.DstFont = nullptr;
+
+		m_pDistanceFieldFont = m_DistanceFieldAtlas->AddFont(&config);
+
+		// Rasterize the glyphs (or load them from the cache) and convert the coverage to distances.
+		{
+			const auto fontAtlasCache = FontAtlasCache(*m_DistanceFieldAtlas);
+			const auto width = fontAtlasCache.width();
+			const auto height = fontAtlasCache.height();
+
+			std::vector<uint8_t> distanceField(static_cast<uint64_t>(width) * height);
+			GenerateDistanceField(reinterpret_cast<const uint8_t*>(fontAtlasCache.data()), width, height, DistanceFieldSpread, distanceField.data());
+
+			m_DistanceFieldImage = std::make_unique<Image>(m_Engine, VkExtent3D{ width, height, 1u }, VkFormat::VK_FORMAT_R8_UNORM, reinterpret_cast<const std::byte*>(distanceField.data()), AlphaSwizzle);
+			m_DistanceFieldImage->changeImageLayout(VK_IMAGE_LAYOUT_SHADER_READ_ONLY_OPTIMAL);
+		}
+
+		m_DistanceFieldAtlas->ClearTexData();
+
+		// Create the pipeline. It uses the same vertex shader and layout as the default pipeline.
+		m_DistanceFieldPipeline = std::make_unique<GraphicsPipeline>(m_Engine, m_Window, "ImGuiDistanceFieldPipelineCache.bin",
+			vertexShader,
+			rapid::ShaderCode("Shaders/sdf_frag.spv", VkShaderStageFlagBits::VK_SHADER_STAGE_FRAGMENT_BIT));
+
+		m_DistanceFieldAtlas->SetTexID(m_TextureRegistry->registerTexture(*m_DistanceFieldImage, true));
+	}
+
+	VkRect2D ImGuiNode::resolveDamage()
+	{
+		m_DrawCommands.clear();
+
+		// The areas need to be in framebuffer coordinates, which are offset from the draw data's with multi-viewports.
+		const auto displayPosition = m_DrawData.getDisplayPosition();
+
+		if (m_DrawData.isValid())
+		{
+			for (const auto& commandList : m_DrawData.getCommandLists())
+			{
+				for (const auto& command : commandList.m_Commands)
+				{
+					const auto pIndices = commandList.m_Indices.data() + command.IdxOffset;
+
+					// Hash everything that affects the output of the command.
+					uint64_t hash = HashValue(command.ClipRect);
+					hash = HashValue(command.TextureId, hash);
+					hash = HashValue(m_TextureRegistry->getVersion(command.TextureId), hash);
+					hash = HashValue(command.UserCallback, hash);
+					hash = HashBytes(pIndices, sizeof(ImDrawIdx) * command.ElemCount, hash);
+
+					// Find the vertices used by the command.
+					const auto [pFirstIndex, pLastIndex] = std::minmax_element(pIndices, pIndices + command.ElemCount);
+					const auto pVertices = commandList.m_Vertices.data() + command.VtxOffset;
+
+					ImVec2 minimum = { command.ClipRect.z, command.ClipRect.w }, maximum = { command.ClipRect.x, command.ClipRect.y };
+					if (command.ElemCount > 0)
+					{
+						const auto pBegin = pVertices + *pFirstIndex;
+						const auto pEnd = pVertices + *pLastIndex + 1;
+						hash = HashBytes(pBegin, sizeof(ImDrawVert) * (pEnd - pBegin), hash);
+
+						for (auto pVertex = pBegin; pVertex != pEnd; pVertex++)
+						{
+							minimum = { std::min(minimum.x, pVertex->pos.x), std::min(minimum.y, pVertex->pos.y) };
+							maximum = { std::max(maximum.x, pVertex->pos.x), std::max(maximum.y, pVertex->pos.y) };
+						}
+					}
+					else if (const auto pDrawCallback = DrawCallback::Get(command))
+					{
+						// Draw callbacks have no vertices, but can draw anywhere within the clip rect.
+						hash = HashValue(pDrawCallback->getFrameVersion(), hash);
+						minimum = { command.ClipRect.x, command.ClipRect.y };
+						maximum = { command.ClipRect.z, command.ClipRect.w };
+					}
+
+					// The command can only touch the pixels within both the clip rect and the vertex bounds.
+					const auto left = std::max(minimum.x, command.ClipRect.x);
+					const auto top = std::max(minimum.y, command.ClipRect.y);
+					const auto right = std::min(maximum.x, command.ClipRect.z);
+					const auto bottom = std::min(maximum.y, command.ClipRect.w);
+
+					VkRect2D area = {};
+					if (right > left && bottom > top)
+					{
+						area.offset = { static_cast<int32_t>(std::floor(left - displayPosition.x)), static_cast<int32_t>(std::floor(top - displayPosition.y)) };
+						area.extent = {
+							static_cast<uint32_t>(std::ceil(right) - std::floor(left)),
+							static_cast<uint32_t>(std::ceil(bottom) - std::floor(top))
+						};
+					}
+
+					m_DrawCommands.emplace_back(DrawCommandInfo{ .m_Hash = hash, .m_Area = area });
+				}
+			}
+		}
+
+		// If a command is not exactly the same as the one in the same position in the last frame, both of their areas are damaged.
+		// Every command outside of those areas are drawn the same way in the same order, so those pixels stay the same.
+		VkRect2D damage = {};
+		const auto commandCount = std::max(m_DrawCommands.size(), m_PreviousDrawCommands.size());
+		for (size_t i = 0; i < commandCount; i++)
+		{
+			const auto pCurrent = i < m_DrawCommands.size() ? &m_DrawCommands[i] : nullptr;
+			const auto pPrevious = i < m_PreviousDrawCommands.size() ? &m_PreviousDrawCommands[i] : nullptr;
+
+			if (pCurrent && pPrevious && pCurrent->m_Hash == pPrevious->m_Hash)
+				continue;
+
+			if (pCurrent)
+				damage = utility::Combine(damage, pCurrent->m_Area);
+
+			if (pPrevious)
+				damage = utility::Combine(damage, pPrevious->m_Area);
+		}
+
+		std::swap(m_DrawCommands, m_PreviousDrawCommands);
+		return damage;
 	}
 
-	void ImGuiNode::updateBuffers()
+	void ImGuiNode::processEvent(const SDL_Event& sdlEvent)
 	{
-		ImDrawData* pDrawData = ImGui::GetDrawData();
+		auto& imGuiIO = ImGui::GetIO();
+
+		switch (sdlEvent.type)
+		{
+		case SDL_KEYDOWN:
+			resolveKeyboardInputs(sdlEvent.key.keysym.scancode, true);
+			//imGuiIO.AddKeyEvent(ImGuiKey_LeftCtrl, sdlEvent.key.keysym.mod & KMOD_LCTRL);
+			//imGuiIO.AddKeyEvent(ImGuiKey_LeftShift, sdlEvent.key.keysym.mod & KMOD_LSHIFT);
+			//imGuiIO.AddKeyEvent(ImGuiKey_LeftAlt, sdlEvent.key.keysym.mod & KMOD_LALT);
+			//
+			//imGuiIO.AddKeyEvent(ImGuiKey_RightCtrl, sdlEvent.key.keysym.mod & KMOD_RCTRL);
+			//imGuiIO.AddKeyEvent(ImGuiKey_RightShift, sdlEvent.key.keysym.mod & KMOD_RSHIFT);
+			//imGuiIO.AddKeyEvent(ImGuiKey_RightAlt, sdlEvent.key.keysym.mod & KMOD_RALT);
+
+			if (sdlEvent.key.keysym.mod & KMOD_CTRL)
+				imGuiIO.KeyMods |= ImGuiModFlags_Ctrl;
+
+			if (sdlEvent.key.keysym.mod & KMOD_SHIFT)
+				imGuiIO.KeyMods |= ImGuiModFlags_Shift;
+
+			if (sdlEvent.key.keysym.mod & KMOD_ALT)
+				imGuiIO.KeyMods |= ImGuiModFlags_Alt;
+
+			if (sdlEvent.key.keysym.mod & KMOD_GUI)
+				imGuiIO.KeyMods |= ImGuiModFlags_Super;
+
+			break;
+
+		case SDL_KEYUP:
+			resolveKeyboardInputs(sdlEvent.key.keysym.scancode, false);
+			//imGuiIO.AddKeyEvent(ImGuiKey_LeftCtrl, sdlEvent.key.keysym.mod & KMOD_LCTRL);
+			//imGuiIO.AddKeyEvent(ImGuiKey_LeftShift, sdlEvent.key.keysym.mod & KMOD_LSHIFT);
+			//imGuiIO.AddKeyEvent(ImGuiKey_LeftAlt, sdlEvent.key.keysym.mod & KMOD_LALT);
+			//
+			//imGuiIO.AddKeyEvent(ImGuiKey_RightCtrl, sdlEvent.key.keysym.mod & KMOD_RCTRL);
+			//imGuiIO.AddKeyEvent(ImGuiKey_RightShift, sdlEvent.key.keysym.mod & KMOD_RSHIFT);
+			//imGuiIO.AddKeyEvent(ImGuiKey_RightAlt, sdlEvent.key.keysym.mod & KMOD_RALT);
+
+			//if (sdlEvent.key.keysym.mod & KMOD_CTRL)
+			//	imGuiIO.KeyMods |= ImGuiModFlags_Ctrl;
+			//
+			//if (sdlEvent.key.keysym.mod & KMOD_SHIFT)
+			//	imGuiIO.KeyMods |= ImGuiModFlags_Shift;
+			//
+			//if (sdlEvent.key.keysym.mod & KMOD_ALT)
+			//	imGuiIO.KeyMods |= ImGuiModFlags_Alt;
+			//
+			//if (sdlEvent.key.keysym.mod & KMOD_GUI)
+			//	imGuiIO.KeyMods |= ImGuiModFlags_Super;
+
+			break;
+
+		case SDL_TEXTINPUT:
+			imGuiIO.AddInputCharactersUTF8(sdlEvent.text.text);
+			break;
+
+		case SDL_MOUSEBUTTONDOWN:
+			// Left mouse button press.
+			if (sdlEvent.button.button == SDL_BUTTON_LEFT)
+			{
+				imGuiIO.AddMouseButtonEvent(ImGuiMouseButton_Left, true);
+				imGuiIO.MouseClickedCount[ImGuiMouseButton_Left] = sdlEvent.button.clicks;
+			}
+
+
+			// Right mouse button press.
+			if (sdlEvent.button.button == SDL_BUTTON_RIGHT)
+			{
+				imGuiIO.AddMouseButtonEvent(ImGuiMouseButton_Right, true);
+				imGuiIO.MouseClickedCount[ImGuiMouseButton_Right] = sdlEvent.button.clicks;
+			}
+
+			// Middle mouse button press.
+			if (sdlEvent.button.button == SDL_BUTTON_MIDDLE)
+			{
+				imGuiIO.AddMouseButtonEvent(ImGuiMouseButton_Middle, true);
+				imGuiIO.MouseClickedCount[ImGuiMouseButton_Middle] = sdlEvent.button.clicks;
+			}
+			break;
+
+		case SDL_MOUSEBUTTONUP:
+			// Left mouse button release.
+			if (sdlEvent.button.button == SDL_BUTTON_LEFT)
+				imGuiIO.AddMouseButtonEvent(ImGuiMouseButton_Left, false);
+
+			// Right mouse button release.
+			if (sdlEvent.button.button == SDL_BUTTON_RIGHT)
+				imGuiIO.AddMouseButtonEvent(ImGuiMouseButton_Right, false);
+
+			// Middle mouse button release.
+			if (sdlEvent.button.button == SDL_BUTTON_MIDDLE)
+				imGuiIO.AddMouseButtonEvent(ImGuiMouseButton_Middle, false);
+			break;
+
+		case SDL_MOUSEMOTION:
+		{
+			auto position = ImVec2(static_cast<float>(sdlEvent.motion.x), static_cast<float>(sdlEvent.motion.y));
 
+			// With multi-viewports, ImGui works in desktop coordinates, so the position is moved by the position of the window it's in.
+			if (imGuiIO.BackendFlags & ImGuiBackendFlags_PlatformHasViewports)
+			{
+				int32_t windowX = 0, windowY = 0;
+				SDL_GetWindowPosition(SDL_GetWindowFromID(sdlEvent.motion.windowID), &windowX, &windowY);
+				position = ImVec2(position.x + windowX, position.y + windowY);
+			}
+
+			imGuiIO.AddMousePosEvent(position.x, position.y);
+			break;
+		}
+
+		case SDL_MOUSEWHEEL:
+			imGuiIO.AddMouseWheelEvent(sdlEvent.wheel.preciseX, sdlEvent.wheel.preciseY);
+			break;
+
+		case SDL_WINDOWEVENT:
+			// Let ImGui know when the user moves, resizes or closes a platform window.
+			if (const auto pViewport = ImGui::FindViewportByPlatformHandle(SDL_GetWindowFromID(sdlEvent.window.windowID)))
+			{
+				if (sdlEvent.window.event == SDL_WINDOWEVENT_CLOSE)
+					pViewport->PlatformRequestClose = true;
+
+				if (sdlEvent.window.event == SDL_WINDOWEVENT_MOVED)
+					pViewport->PlatformRequestMove = true;
+
+				if (sdlEvent.window.event == SDL_WINDOWEVENT_SIZE_CHANGED)
+				{
+					pViewport->PlatformRequestResize = true;
+
+					if (const auto pPlatformViewport = static_cast<Viewport*>(pViewport->PlatformUserData))
+						pPlatformViewport->invalidateSwapchain();
+				}
+			}
+			break;
+
+		case SDL_DISPLAYEVENT:
+			if (imGuiIO.BackendFlags & ImGuiBackendFlags_PlatformHasViewports)
+				UpdateMonitors();
+			break;
+
+		default:
+			break;
+		}
+	}
+
+	void ImGuiNode::updateBuffers(const DrawDataSnapshot& drawData, std::unique_ptr<Buffer>& pVertexBuffer, std::unique_ptr<Buffer>& pIndexBuffer) const
+	{
 		// We don't have to update anything if there are no 
-		if (!pDrawData)
+		if (!drawData.isValid())
 			return;
 
 		// Get the vertex and index size and return if we don't have anything.
-		const uint64_t vertexSize = GetNewVertexBufferSize(pDrawData->TotalVtxCount * sizeof(ImDrawVert)), indexSize = GetNewIndexBufferSize(pDrawData->TotalIdxCount * sizeof(ImDrawIdx));
+		const auto totalVertexCount = drawData.getVertexCount(), totalIndexCount = drawData.getIndexCount();
+		const uint64_t vertexSize = GetNewVertexBufferSize(totalVertexCount * sizeof(ImDrawVert)), indexSize = GetNewIndexBufferSize(totalIndexCount * sizeof(ImDrawIdx));
 		if (vertexSize == 0 || indexSize == 0)
 			return;
 
-		const auto currentVertexCount = m_VertexBuffer->size() / sizeof(ImDrawVert);
-		const auto currentIndexCount = m_IndexBuffer->size() / sizeof(ImDrawIdx);
+		const auto currentVertexCount = pVertexBuffer->size() / sizeof(ImDrawVert);
+		const auto currentIndexCount = pIndexBuffer->size() / sizeof(ImDrawIdx);
 
 		// Create buffers if we need to.
-		if (currentVertexCount < pDrawData->TotalVtxCount || pDrawData->TotalVtxCount < (currentVertexCount - ElementCount))
+		if (currentVertexCount < totalVertexCount || totalVertexCount < (currentVertexCount - ElementCount))
 		{
-			m_VertexBuffer->terminate();
-			m_VertexBuffer = std::make_unique<Buffer>(m_Engine, GetNewVertexBufferSize(vertexSize), BufferType::ShallowVertex);
+			pVertexBuffer->terminate();
+			pVertexBuffer = std::make_unique<Buffer>(m_Engine, GetNewVertexBufferSize(vertexSize), BufferType::ShallowVertex);
 		}
 
-		if (currentIndexCount < pDrawData->TotalIdxCount || pDrawData->TotalIdxCount < (currentIndexCount - ElementCount))
+		if (currentIndexCount < totalIndexCount || totalIndexCount < (currentIndexCount - ElementCount))
 		{
-			m_IndexBuffer->terminate();
-			m_IndexBuffer = std::make_unique<Buffer>(m_Engine, GetNewIndexBufferSize(indexSize), BufferType::ShallowIndex);
+			pIndexBuffer->terminate();
+			pIndexBuffer = std::make_unique<Buffer>(m_Engine, GetNewIndexBufferSize(indexSize), BufferType::ShallowIndex);
 		}
 
 		// Copy the content.
-		auto pCopyVertexPointer = reinterpret_cast<ImDrawVert*>(m_VertexBuffer->mapMemory());
-		auto pCopyIndexPointer = reinterpret_cast<ImDrawIdx*>(m_IndexBuffer->mapMemory());
-		for (int32_t i = 0; i < pDrawData->CmdListsCount; i++) {
-			const auto pCommandList = pDrawData->CmdLists[i];
-
-			std::copy_n(pCommandList->VtxBuffer.Data, pCommandList->VtxBuffer.Size, pCopyVertexPointer);
-			std::copy_n(pCommandList->IdxBuffer.Data, pCommandList->IdxBuffer.Size, pCopyIndexPointer);
-
-			pCopyVertexPointer += pCommandList->VtxBuffer.Size;
-			pCopyIndexPointer += pCommandList->IdxBuffer.Size;
+		auto pCopyVertexPointer = reinterpret_cast<ImDrawVert*>(pVertexBuffer->mapMemory());
+		auto pCopyIndexPointer = reinterpret_cast<ImDrawIdx*>(pIndexBuffer->mapMemory());
+		for (const auto& commandList : drawData.getCommandLists()) {
+			StreamingCopy(pCopyVertexPointer, commandList.m_Vertices.data(), commandList.m_Vertices.size() * sizeof(ImDrawVert));
+			StreamingCopy(pCopyIndexPointer, commandList.m_Indices.data(), commandList.m_Indices.size() * sizeof(ImDrawIdx));
+
+			pCopyVertexPointer += commandList.m_Vertices.size();
+			pCopyIndexPointer += commandList.m_Indices.size();
 		}
 
 		// Unmap the mapped memory.
-		m_VertexBuffer->unmapMemory();
-		m_IndexBuffer->unmapMemory();
+		pVertexBuffer->unmapMemory();
+		pIndexBuffer->unmapMemory();
 	}
 
 	void ImGuiNode::resolveKeyboardInputs(SDL_Scancode scancode, bool state) const
@@ -4,15 +4,25 @@
 
 #include "ProcessingNode.hpp"
 #include "Image.hpp"
-#include "GraphicsPipeline.hpp"
+#include "TextureRegistry.hpp"
+#include "FontAtlasBuilder.hpp"
+#include "ImageLoader.hpp"
+#include "RetainedLayer.hpp"
+#include "LinkRenderer.hpp"
+#include "DrawDataSnapshot.hpp"
 
 #include <chrono>
+#include <span>
+#include <unordered_map>
 
 namespace rapid
 {
 	/**
 	 * ImGui node object.
 	 * This node acts as a single processing unit in the rendering pipeline, and contains everything needed by ImGui to render to the screen.
+	 *
+	 * If multi-viewports are enabled, the node is also ImGui's platform backend. Platform windows are created as viewports
+	 * of the node's window, and ImGui works in desktop coordinates.
 	 */
 	class ImGuiNode final : public ProcessingNode
 	{
@@ -41,9 +51,52 @@ namespace rapid
 		/**
 		 * Update ImGUI on the new iteration.
 		 * 
-		 * @param events The events.
+		 * @param events The events of this iteration.
 		 */
-		void onPollEvents(SDL_Event& events) override;
+		void onPollEvents(const std::vector<SDL_Event>& events) override;
+
+		/**
+		 * Finish the ImGui frame and capture its draw data.
+		 */
+		void endFrame() override;
+
+		/**
+		 * Hand the captured draw data over to the render thread.
+		 * This also submits the image and atlas uploads, and hands the retained layers and link renderers over.
+		 *
+		 * @param frameIndex The index of the frame which is going to be recorded.
+		 */
+		void swapFrame(uint32_t frameIndex) override;
+
+		/**
+		 * Update the frame's buffers using the captured draw data.
+		 *
+		 * @param frameIndex The frame's index number.
+		 * @return The area of the window which changed since the last frame.
+		 */
+		VkRect2D prepare(uint32_t frameIndex) override;
+
+		/**
+		 * Get the name of the node.
+		 *
+		 * @return The name.
+		 */
+		std::string_view getName() const override { return "ImGui"; }
+
+		/**
+		 * Add the passes which update the retained layers and copy the defragmented atlas pages.
+		 *
+		 * @param graph The frame's render graph.
+		 * @param frameIndex The frame's index number.
+		 */
+		void addPasses(RenderGraph& graph, uint32_t frameIndex) override;
+
+		/**
+		 * Declare the retained layer and atlas page images, which are sampled when binding.
+		 *
+		 * @param builder The builder of the window's pass.
+		 */
+		void declareResources(RenderGraph::PassBuilder& builder) const override;
 
 		/**
 		 * Bind the resources to the command buffer.
@@ -53,17 +106,205 @@ namespace rapid
 		 */
 		void bind(CommandBuffer commandBuffer, uint32_t frameIndex) override;
 
+		/**
+		 * Update the viewport's buffers and draw its captured draw data.
+		 *
+		 * @param commandBuffer The command buffer to bind to.
+		 * @param viewport The viewport which is rendered.
+		 * @param frameIndex The frame's index number.
+		 */
+		void bindViewport(CommandBuffer commandBuffer, const Viewport& viewport, uint32_t frameIndex) override;
+
 		/**
 		 * This method will get called when the window is resized.
 		 */
 		void onWindowResize() override;
 
+		/**
+		 * Check if ImGui is animating.
+		 * This is true while an item is being interacted with (dragging, typing, etc.), or while images are being uploaded.
+		 *
+		 * @return Whether or not ImGui is animating.
+		 */
+		bool isAnimating() const override;
+
+		/**
+		 * Get the texture registry.
+		 * Images registered here can be drawn using their ImTextureID.
+		 *
+		 * @return The texture registry.
+		 */
+		TextureRegistry& getTextureRegistry() { return *m_TextureRegistry; }
+
+		/**
+		 * Get the image loader.
+		 * Images loaded using it are registered in the texture registry once they're resident.
+		 *
+		 * @return The image loader.
+		 */
+		ImageLoader& getImageLoader() { return *m_ImageLoader; }
+
+		/**
+		 * Get the texture atlas.
+		 * Small images inserted here share a few textures, and are drawn using their atlas regions.
+		 *
+		 * @return The texture atlas.
+		 */
+		TextureAtlas& getTextureAtlas() { return *m_TextureAtlas; }
+
+		/**
+		 * Create a new retained layer.
+		 * Draw lists submitted to it are cached in an offscreen target, and are only redrawn where they change.
+		 *
+		 * @return The retained layer. This is owned by the node.
+		 */
+		RetainedLayer& createRetainedLayer();
+
+		/**
+		 * Create a new link renderer.
+		 * Add it to a draw list where the links should be drawn, and upload the links before the frame is rendered.
+		 *
+		 * @return The link renderer. This is owned by the node.
+		 */
+		LinkRenderer& createLinkRenderer();
+
+		/**
+		 * Get the distance field font.
+		 * Text drawn using this font stays sharp at any scale, so it should be used for text which gets zoomed in or out.
+		 * Set the font's scale to change the size before pushing it.
+		 *
+		 * @return The font pointer.
+		 */
+		ImFont* getDistanceFieldFont() const { return m_pDistanceFieldFont; }
+
+		/**
+		 * Add a new font.
+		 * The font atlas is rebuilt and uploaded on a worker thread, and is swapped in at a frame boundary once ready. Fonts
+		 * requested while a rebuild is running are added in the next rebuild.
+		 *
+		 * @param file The font file.
+		 * @param size The font size in pixels.
+		 */
+		void addFont(std::filesystem::path file, float size);
+
+		/**
+		 * Begin the editor's dock space window, which covers the whole main viewport.
+		 * This needs to be called right after starting a new ImGui frame, and ended with ImGui::End() before rendering.
+		 */
+		static void BeginDockSpace();
+
 	private:
+		/**
+		 * Install the platform callbacks, so ImGui's platform windows are created as viewports of the window.
+		 */
+		void setupViewports();
+
+		/**
+		 * Create the viewport of an ImGui platform window.
+		 * This is called by ImGui on the UI thread.
+		 *
+		 * @param pViewport The ImGui viewport.
+		 */
+		static void CreatePlatformWindow(ImGuiViewport* pViewport);
+
+		/**
+		 * Destroy the viewport of an ImGui platform window.
+		 * This is called by ImGui on the UI thread.
+		 *
+		 * @param pViewport The ImGui viewport.
+		 */
+		static void DestroyPlatformWindow(ImGuiViewport* pViewport);
+
+		/**
+		 * Swap in the rebuilt font atlas if it's ready, and destroy the retired atlases which are no longer used.
+		 * This needs to be called before starting a new ImGui frame.
+		 */
+		void updateFontAtlas();
+
+		/**
+		 * Create the distance field font and its pipeline.
+		 * The glyphs of the default font are rasterized at a larger size, and are converted to a signed distance field.
+		 *
+		 * @param vertexShader The vertex shader to use with the pipeline.
+		 */
+		void createDistanceFieldFont(const ShaderCode& vertexShader);
+
+		/**
+		 * Draw state structure.
+		 * This stores the bound pipeline and texture, so they're only switched when needed.
+		 */
+		struct DrawState final
+		{
+			const Buffer* m_pVertexBuffer = nullptr;
+			const Buffer* m_pIndexBuffer = nullptr;
+			const GraphicsPipeline* m_pPipeline = nullptr;
+			ImTextureID m_TextureID = nullptr;
+
+			ImVec2 m_Scale = {};
+			ImVec2 m_Translate = {};
+			ImVec2 m_ClipOffset = {};
+
+			GpuProfiler* m_pProfiler = nullptr;	// Measures the draw callbacks if set.
+		};
+
+		/**
+		 * Bind the buffers, the default pipeline and the push constants.
+		 * The viewport needs to be bound before this.
+		 *
+		 * @param commandBuffer The command buffer to record to.
+		 * @param drawState The draw state. The bound pipeline and texture are reset.
+		 */
+		void setupRenderState(CommandBuffer commandBuffer, DrawState& drawState);
+
+		/**
+		 * Issue the draw calls of a set of draw commands.
+		 * The render state needs to be set up before this.
+		 *
+		 * @param commandBuffer The command buffer to record to.
+		 * @param commands The draw commands.
+		 * @param renderArea The area to draw to. The scissors are clamped to this.
+		 * @param vertexOffset The offset of the command list's vertices in the vertex buffer.
+		 * @param indexOffset The offset of the command list's indices in the index buffer.
+		 * @param drawState The draw state.
+		 */
+		void drawCommands(CommandBuffer commandBuffer, std::span<const ImDrawCmd> commands, const VkRect2D& renderArea, uint64_t vertexOffset, uint64_t indexOffset, DrawState& drawState);
+
+		/**
+		 * Draw captured draw data.
+		 * The vertices are moved by the display position, so the draw data of any viewport can be drawn.
+		 *
+		 * @param commandBuffer The command buffer to record to.
+		 * @param drawData The draw data.
+		 * @param vertexBuffer The vertex buffer containing the draw data's vertices.
+		 * @param indexBuffer The index buffer containing the draw data's indices.
+		 * @param renderArea The area to draw to.
+		 * @param pProfiler The profiler to measure the draw callbacks with. Default is nullptr.
+		 */
+		void drawSnapshot(CommandBuffer commandBuffer, const DrawDataSnapshot& drawData, const Buffer& vertexBuffer, const Buffer& indexBuffer, const VkRect2D& renderArea, GpuProfiler* pProfiler = nullptr);
+
 		/**
 		 * Update the buffers.
-		 * This will get the data from ImGui and update the vertex and index buffers.
+		 * This copies the captured draw data to the vertex and index buffers, and recreates them if their sizes don't fit.
+		 *
+		 * @param drawData The draw data.
+		 * @param pVertexBuffer The vertex buffer.
+		 * @param pIndexBuffer The index buffer.
+		 */
+		void updateBuffers(const DrawDataSnapshot& drawData, std::unique_ptr<Buffer>& pVertexBuffer, std::unique_ptr<Buffer>& pIndexBuffer) const;
+
+		/**
+		 * Resolve the damaged area by comparing the draw commands with the previous frame's.
+		 *
+		 * @return The damaged area.
+		 */
+		VkRect2D resolveDamage();
+
+		/**
+		 * Process a single event and pass it to ImGui.
+		 *
+		 * @param sdlEvent The event to process.
 		 */
-		void updateBuffers();
+		void processEvent(const SDL_Event& sdlEvent);
 
 		/**
 		 * Resolve the keyboard inputs.
@@ -74,13 +315,72 @@ namespace rapid
 		void resolveKeyboardInputs(SDL_Scancode scancode, bool state) const;
 
 	private:
+		/**
+		 * Draw command information.
+		 * This is used to compare the draw commands between frames.
+		 */
+		struct DrawCommandInfo final
+		{
+			uint64_t m_Hash = 0;
+			VkRect2D m_Area = {};
+		};
+
+		/**
+		 * Viewport resources structure.
+		 * Every viewport has its own draw data and buffers, so the viewports can be recorded at the same time. The buffers
+		 * are per frame in flight.
+		 */
+		struct ViewportResources final
+		{
+			DrawDataSnapshot m_DrawData;
+			DrawDataSnapshot m_PendingDrawData;
+			std::vector<std::unique_ptr<Buffer>> m_VertexBuffers = {};
+			std::vector<std::unique_ptr<Buffer>> m_IndexBuffers = {};
+			bool m_HasPendingDrawData = false;
+		};
+
+		/**
+		 * Retired font atlas structure.
+		 * The atlas image could be used by frames in flight, so it's destroyed a few frames later.
+		 */
+		struct RetiredFontAtlas final
+		{
+			ImFontAtlas* m_pAtlas = nullptr;
+			std::unique_ptr<Image> m_Image = nullptr;
+			ImTextureID m_TextureID = nullptr;
+			uint64_t m_DestroyFrame = 0;
+		};
+
 		time_point m_TimePoint;
 
-		std::vector<ShaderResource*> m_ShaderResources = {};
+		DrawDataSnapshot m_DrawData;	// Rendered by the render thread.
+		DrawDataSnapshot m_PendingDrawData;	// Captured by the UI thread, and handed over with the next frame.
+		bool m_HasPendingDrawData = false;
+
+		std::vector<DrawCommandInfo> m_DrawCommands = {};
+		std::vector<DrawCommandInfo> m_PreviousDrawCommands = {};
+
+		std::vector<FontRequest> m_FontRequests = {};
+		std::vector<RetiredFontAtlas> m_RetiredFontAtlases = {};
+		std::unique_ptr<FontAtlasBuilder> m_FontAtlasBuilder = nullptr;
+		uint64_t m_FrameNumber = 0;
+
+		std::unique_ptr<ImFontAtlas> m_DistanceFieldAtlas = nullptr;
+		ImFont* m_pDistanceFieldFont = nullptr;
 
 		std::unique_ptr<Image> m_FontImage = nullptr;
+		std::unique_ptr<Image> m_DistanceFieldImage = nullptr;
 		std::unique_ptr<GraphicsPipeline> m_Pipeline = nullptr;
-		std::unique_ptr<Buffer> m_VertexBuffer = nullptr;
-		std::unique_ptr<Buffer> m_IndexBuffer = nullptr;
+		std::unique_ptr<GraphicsPipeline> m_DistanceFieldPipeline = nullptr;
+		std::unique_ptr<TextureRegistry> m_TextureRegistry = nullptr;
+		std::unique_ptr<TextureAtlas> m_TextureAtlas = nullptr;
+		std::unique_ptr<ImageLoader> m_ImageLoader = nullptr;
+		std::vector<std::unique_ptr<RetainedLayer>> m_RetainedLayers = {};
+		std::vector<std::unique_ptr<LinkRenderer>> m_LinkRenderers = {};
+		std::vector<RenderGraph::ResourceID> m_SampledResources = {};	// The retained layers and the atlas pages written by the frame's passes.
+		std::vector<std::unique_ptr<Buffer>> m_VertexBuffers = {};
+		std::vector<std::unique_ptr<Buffer>> m_IndexBuffers = {};
+
+		std::unordered_map<const Viewport*, ViewportResources> m_ViewportResources = {};
 	};
 }
\ No newline at end of file
@@ -3,57 +3,131 @@
 #include "Image.hpp"
 #include "Utility.hpp"  
 
+#include "Core/StreamingCopy.hpp"
+
 #include <spdlog/spdlog.h>
 
+#include <bit>
+
 namespace
 {
 	/**
-	 * Get the pipeline stage flags from access flags.
+	 * Images smaller than this are allocated with the strategy which wastes the least memory, as the editor creates many
+	 * small images (icons, thumbnails and glyph pages), which would otherwise leave gaps in the memory blocks.
+	 */
+	constexpr uint64_t SmallImageSize = 256 * 1024;
+
+	/**
+	 * Images larger than this get their own memory, so freeing them returns the memory instead of leaving a large gap.
+	 */
+	constexpr uint64_t LargeImageSize = 16 * 1024 * 1024;
+
+	/**
+	 * The access flags which write memory. Only these need to be made available by a barrier.
+	 */
+	constexpr VkAccessFlags2 WriteAccessFlags = VK_ACCESS_2_HOST_WRITE_BIT | VK_ACCESS_2_MEMORY_WRITE_BIT | VK_ACCESS_2_SHADER_WRITE_BIT | VK_ACCESS_2_COLOR_ATTACHMENT_WRITE_BIT | VK_ACCESS_2_DEPTH_STENCIL_ATTACHMENT_WRITE_BIT | VK_ACCESS_2_TRANSFER_WRITE_BIT;
+
+	/**
+	 * Resolve the stages and access flags which use an image in a layout.
+	 *
+	 * @param layout The image layout.
+	 * @param stages The stages to set.
+	 * @param access The access flags to set.
+	 * @return Whether or not the layout is supported.
+	 */
+	bool ResolveLayoutSynchronization(const VkImageLayout layout, VkPipelineStageFlags2& stages, VkAccessFlags2& access)
+	{
+		switch (layout)
+		{
+		case VK_IMAGE_LAYOUT_UNDEFINED:
+		case VK_IMAGE_LAYOUT_PRESENT_SRC_KHR:
+			stages = VK_PIPELINE_STAGE_2_NONE;
+			access = VK_ACCESS_2_NONE;
+			return true;
+
+		case VK_IMAGE_LAYOUT_PREINITIALIZED:
+			stages = VK_PIPELINE_STAGE_2_HOST_BIT;
+			access = VK_ACCESS_2_HOST_WRITE_BIT;
+			return true;
+
+		case VK_IMAGE_LAYOUT_GENERAL:
+			stages = VK_PIPELINE_STAGE_2_ALL_COMMANDS_BIT;
+			access = VK_ACCESS_2_MEMORY_READ_BIT | VK_ACCESS_2_MEMORY_WRITE_BIT;
+			return true;
+
+		case VK_IMAGE_LAYOUT_COLOR_ATTACHMENT_OPTIMAL:
+			stages = VK_PIPELINE_STAGE_2_COLOR_ATTACHMENT_OUTPUT_BIT;
+			access = VK_ACCESS_2_COLOR_ATTACHMENT_READ_BIT | VK_ACCESS_2_COLOR_ATTACHMENT_WRITE_BIT;
+			return true;
+
+		case VK_IMAGE_LAYOUT_DEPTH_STENCIL_ATTACHMENT_OPTIMAL:
+			stages = VK_PIPELINE_STAGE_2_EARLY_FRAGMENT_TESTS_BIT | VK_PIPELINE_STAGE_2_LATE_FRAGMENT_TESTS_BIT;
+			access = VK_ACCESS_2_DEPTH_STENCIL_ATTACHMENT_READ_BIT | VK_ACCESS_2_DEPTH_STENCIL_ATTACHMENT_WRITE_BIT;
+			return true;
+
+		case VK_IMAGE_LAYOUT_DEPTH_STENCIL_READ_ONLY_OPTIMAL:
+			stages = VK_PIPELINE_STAGE_2_EARLY_FRAGMENT_TESTS_BIT | VK_PIPELINE_STAGE_2_LATE_FRAGMENT_TESTS_BIT | VK_PIPELINE_STAGE_2_FRAGMENT_SHADER_BIT;
+			access = VK_ACCESS_2_DEPTH_STENCIL_ATTACHMENT_READ_BIT | VK_ACCESS_2_SHADER_SAMPLED_READ_BIT;
+			return true;
+
+		case VK_IMAGE_LAYOUT_TRANSFER_SRC_OPTIMAL:
+			stages = VK_PIPELINE_STAGE_2_ALL_TRANSFER_BIT;
+			access = VK_ACCESS_2_TRANSFER_READ_BIT;
+			return true;
+
+		case VK_IMAGE_LAYOUT_TRANSFER_DST_OPTIMAL:
+			stages = VK_PIPELINE_STAGE_2_ALL_TRANSFER_BIT;
+			access = VK_ACCESS_2_TRANSFER_WRITE_BIT;
+			return true;
+
+		case VK_IMAGE_LAYOUT_SHADER_READ_ONLY_OPTIMAL:
+			stages = VK_PIPELINE_STAGE_2_FRAGMENT_SHADER_BIT;
+			access = VK_ACCESS_2_SHADER_SAMPLED_READ_BIT;
+			return true;
+
+		default:
+			spdlog::error("Unsupported layout transition!");
+			return false;
+		}
+	}
+
+	/**
+	 * Resolve the number of mip levels of an image.
+	 * The mip chain is generated using linear blits, so formats which don't support them only get a single level.
 	 *
-	 * @param flags Access flags.
-	 * @return The stage flags.
+	 * @param engine The graphics engine.
+	 * @param extent The image extent.
+	 * @param format The image format.
+	 * @param mipLevels The requested mip level count.
+	 * @return The mip level count.
 	 */
-	VkPipelineStageFlags GetPipelineStageFlags(const VkAccessFlags flags)
+	uint32_t ResolveMipLevels(const rapid::GraphicsEngine& engine, const VkExtent3D extent, const VkFormat format, const uint32_t mipLevels)
 	{
-		switch (flags)
+		const auto completeChain = static_cast<uint32_t>(std::bit_width(std::max(std::max(extent.width, extent.height), 1u)));
+		const auto levelCount = mipLevels == rapid::CompleteMipChain ? completeChain : std::min(mipLevels, completeChain);
+
+		if (levelCount > 1)
 		{
-		case VK_ACCESS_INDIRECT_COMMAND_READ_BIT:						return VK_PIPELINE_STAGE_DRAW_INDIRECT_BIT | VK_PIPELINE_STAGE_ACCELERATION_STRUCTURE_BUILD_BIT_KHR;
-		case VK_ACCESS_INDEX_READ_BIT:									return VK_PIPELINE_STAGE_VERTEX_INPUT_BIT;
-		case VK_ACCESS_VERTEX_ATTRIBUTE_READ_BIT:						return VK_PIPELINE_STAGE_VERTEX_INPUT_BIT;
-		case VK_ACCESS_UNIFORM_READ_BIT:								return VK_PIPELINE_STAGE_RAY_TRACING_SHADER_BIT_KHR | VK_PIPELINE_STAGE_VERTEX_SHADER_BIT | VK_PIPELINE_STAGE_TESSELLATION_CONTROL_SHADER_BIT | VK_PIPELINE_STAGE_TESSELLATION_EVALUATION_SHADER_BIT | VK_PIPELINE_STAGE_GEOMETRY_SHADER_BIT | VK_PIPELINE_STAGE_FRAGMENT_SHADER_BIT | VK_PIPELINE_STAGE_COMPUTE_SHADER_BIT;
-		case VK_ACCESS_SHADER_READ_BIT:									return VK_PIPELINE_STAGE_ACCELERATION_STRUCTURE_BUILD_BIT_KHR | VK_PIPELINE_STAGE_RAY_TRACING_SHADER_BIT_KHR | VK_PIPELINE_STAGE_VERTEX_SHADER_BIT | VK_PIPELINE_STAGE_TESSELLATION_CONTROL_SHADER_BIT | VK_PIPELINE_STAGE_TESSELLATION_EVALUATION_SHADER_BIT | VK_PIPELINE_STAGE_GEOMETRY_SHADER_BIT | VK_PIPELINE_STAGE_FRAGMENT_SHADER_BIT | VK_PIPELINE_STAGE_COMPUTE_SHADER_BIT;
-		case VK_ACCESS_SHADER_WRITE_BIT:								return VK_PIPELINE_STAGE_RAY_TRACING_SHADER_BIT_KHR | VK_PIPELINE_STAGE_VERTEX_SHADER_BIT | VK_PIPELINE_STAGE_TESSELLATION_CONTROL_SHADER_BIT | VK_PIPELINE_STAGE_TESSELLATION_EVALUATION_SHADER_BIT | VK_PIPELINE_STAGE_GEOMETRY_SHADER_BIT | VK_PIPELINE_STAGE_FRAGMENT_SHADER_BIT | VK_PIPELINE_STAGE_COMPUTE_SHADER_BIT;
-		case VK_ACCESS_INPUT_ATTACHMENT_READ_BIT:						return VK_PIPELINE_STAGE_FRAGMENT_SHADER_BIT;
-		case VK_ACCESS_COLOR_ATTACHMENT_READ_BIT:						return VK_PIPELINE_STAGE_COLOR_ATTACHMENT_OUTPUT_BIT;
-		case VK_ACCESS_COLOR_ATTACHMENT_WRITE_BIT:						return VK_PIPELINE_STAGE_COLOR_ATTACHMENT_OUTPUT_BIT;
-		case VK_ACCESS_DEPTH_STENCIL_ATTACHMENT_READ_BIT:				return VK_PIPELINE_STAGE_EARLY_FRAGMENT_TESTS_BIT | VK_PIPELINE_STAGE_LATE_FRAGMENT_TESTS_BIT;
-		case VK_ACCESS_DEPTH_STENCIL_ATTACHMENT_WRITE_BIT:				return VK_PIPELINE_STAGE_EARLY_FRAGMENT_TESTS_BIT | VK_PIPELINE_STAGE_LATE_FRAGMENT_TESTS_BIT;
-		case VK_ACCESS_TRANSFER_READ_BIT:								return VK_PIPELINE_STAGE_TRANSFER_BIT | VK_PIPELINE_STAGE_ACCELERATION_STRUCTURE_BUILD_BIT_KHR;
-		case VK_ACCESS_TRANSFER_WRITE_BIT:								return VK_PIPELINE_STAGE_TRANSFER_BIT | VK_PIPELINE_STAGE_ACCELERATION_STRUCTURE_BUILD_BIT_KHR;
-		case VK_ACCESS_HOST_READ_BIT:									return VK_PIPELINE_STAGE_HOST_BIT;
-		case VK_ACCESS_HOST_WRITE_BIT:									return VK_PIPELINE_STAGE_HOST_BIT;
-		case VK_ACCESS_MEMORY_READ_BIT:									return VK_PIPELINE_STAGE_ALL_COMMANDS_BIT;
-		case VK_ACCESS_MEMORY_WRITE_BIT:								return VK_PIPELINE_STAGE_ALL_COMMANDS_BIT;
-		case VK_ACCESS_COLOR_ATTACHMENT_READ_NONCOHERENT_BIT_EXT:		return VK_PIPELINE_STAGE_COLOR_ATTACHMENT_OUTPUT_BIT;
-		case VK_ACCESS_COMMAND_PREPROCESS_READ_BIT_NV:					return VK_PIPELINE_STAGE_COMMAND_PREPROCESS_BIT_NV;
-		case VK_ACCESS_COMMAND_PREPROCESS_WRITE_BIT_NV:					return VK_PIPELINE_STAGE_COMMAND_PREPROCESS_BIT_NV;
-		case VK_ACCESS_CONDITIONAL_RENDERING_READ_BIT_EXT:				return VK_PIPELINE_STAGE_CONDITIONAL_RENDERING_BIT_EXT;
-		case VK_ACCESS_FRAGMENT_SHADING_RATE_ATTACHMENT_READ_BIT_KHR:	return VK_PIPELINE_STAGE_FRAGMENT_SHADING_RATE_ATTACHMENT_BIT_KHR;
-		case VK_ACCESS_TRANSFORM_FEEDBACK_WRITE_BIT_EXT:				return VK_PIPELINE_STAGE_TRANSFORM_FEEDBACK_BIT_EXT;
-		case VK_ACCESS_TRANSFORM_FEEDBACK_COUNTER_WRITE_BIT_EXT:		return VK_PIPELINE_STAGE_TRANSFORM_FEEDBACK_BIT_EXT;
-		case VK_ACCESS_TRANSFORM_FEEDBACK_COUNTER_READ_BIT_EXT:			return VK_PIPELINE_STAGE_TRANSFORM_FEEDBACK_BIT_EXT | VK_PIPELINE_STAGE_DRAW_INDIRECT_BIT;
-		case VK_ACCESS_ACCELERATION_STRUCTURE_READ_BIT_KHR:				return VK_PIPELINE_STAGE_VERTEX_SHADER_BIT | VK_PIPELINE_STAGE_TESSELLATION_CONTROL_SHADER_BIT | VK_PIPELINE_STAGE_TESSELLATION_EVALUATION_SHADER_BIT | VK_PIPELINE_STAGE_GEOMETRY_SHADER_BIT | VK_PIPELINE_STAGE_FRAGMENT_SHADER_BIT | VK_PIPELINE_STAGE_COMPUTE_SHADER_BIT | VK_PIPELINE_STAGE_RAY_TRACING_SHADER_BIT_KHR | VK_PIPELINE_STAGE_ACCELERATION_STRUCTURE_BUILD_BIT_KHR;
-		case VK_ACCESS_ACCELERATION_STRUCTURE_WRITE_BIT_KHR:			return VK_PIPELINE_STAGE_ACCELERATION_STRUCTURE_BUILD_BIT_KHR;
-		case VK_ACCESS_FRAGMENT_DENSITY_MAP_READ_BIT_EXT:				return VK_PIPELINE_STAGE_FRAGMENT_DENSITY_PROCESS_BIT_EXT;
-		default:														return VK_PIPELINE_STAGE_ALL_COMMANDS_BIT;
+			constexpr VkFormatFeatureFlags requiredFeatures = VK_FORMAT_FEATURE_BLIT_SRC_BIT | VK_FORMAT_FEATURE_BLIT_DST_BIT | VK_FORMAT_FEATURE_SAMPLED_IMAGE_FILTER_LINEAR_BIT;
+
+			VkFormatProperties formatProperties = {};
+			vkGetPhysicalDeviceFormatProperties(engine.getPhysicalDevice(), format, &formatProperties);
+
+			if ((formatProperties.optimalTilingFeatures & requiredFeatures) != requiredFeatures)
+			{
+				spdlog::warn("The image format does not support linear blits! Mip maps will not be generated.");
+				return 1;
+			}
 		}
+
+		return levelCount;
 	}
 }
 
 namespace rapid
 {
-	Image::Image(GraphicsEngine& engine, VkExtent3D extent, VkFormat format)
-		: m_Engine(engine), m_Extent(extent), m_Format(format)
+	Image::Image(GraphicsEngine& engine, VkExtent3D extent, VkFormat format, VkComponentMapping components, uint32_t mipLevels, VkImageUsageFlags additionalUsage)
+		: m_Engine(engine), m_Extent(extent), m_Format(format), m_Components(components), m_MipLevels(ResolveMipLevels(engine, extent, format, mipLevels)), m_Usage(DefaultUsage | additionalUsage), m_MipLayouts(m_MipLevels, VK_IMAGE_LAYOUT_UNDEFINED)
 	{
 		// Set up all the primitives.
 		createImage();
@@ -61,8 +135,8 @@ namespace rapid
 		createSampler();
 	}
 
-	Image::Image(GraphicsEngine& engine, VkExtent3D extent, VkFormat format, const std::byte* pImageData)
-		: m_Engine(engine), m_Extent(extent), m_Format(format)
+	Image::Image(GraphicsEngine& engine, VkExtent3D extent, VkFormat format, const std::byte* pImageData, VkComponentMapping components, uint32_t mipLevels)
+		: m_Engine(engine), m_Extent(extent), m_Format(format), m_Components(components), m_MipLevels(ResolveMipLevels(engine, extent, format, mipLevels)), m_MipLayouts(m_MipLevels, VK_IMAGE_LAYOUT_UNDEFINED)
 	{
 		// Set up all the primitives.
 		createImage();
@@ -73,7 +147,7 @@ namespace rapid
 		auto stagingBuffer = Buffer(m_Engine, size(), BufferType::Staging);
 		auto pBufferMemory = stagingBuffer.mapMemory();
 
-		std::copy(pImageData, pImageData + size(), pBufferMemory);
+		StreamingCopy(pBufferMemory, pImageData, size());
 		stagingBuffer.unmapMemory();
 
 		fromBuffer(stagingBuffer);
@@ -90,127 +164,76 @@ namespace rapid
 		vkDestroySampler(m_Engine.getLogicalDevice(), m_Sampler, nullptr);
 		vkDestroyImageView(m_Engine.getLogicalDevice(), m_ImageView, nullptr);
 		vmaDestroyImage(m_Engine.getAllocator(), m_Image, m_Allocation);
+
+		if (m_Allocation)
+			m_Engine.getMemoryStatistics().remove(MemoryCategory::Image, m_AllocationSize);
+
 		m_IsTerminated = true;
 	}
 
-	void Image::changeImageLayout(const VkImageLayout newLayout, const VkCommandBuffer vCommandBuffer)
+	void Image::changeImageLayout(const VkImageLayout newLayout, const VkCommandBuffer vCommandBuffer, const uint32_t baseMipLevel, const uint32_t levelCount)
 	{
-		// Create the memory barrier.
-		VkImageMemoryBarrier memorybarrier = {
-			.sType = VK_STRUCTURE_TYPE_IMAGE_MEMORY_BARRIER,
-			.srcAccessMask = 0,
-			.dstAccessMask = 0,
-			.oldLayout = m_CurrentLayout,
-			.newLayout = newLayout,
-			.srcQueueFamilyIndex = VK_QUEUE_FAMILY_IGNORED,
-			.dstQueueFamilyIndex = VK_QUEUE_FAMILY_IGNORED,
-			.image = m_Image,
-			.subresourceRange = {
-				.aspectMask = VK_IMAGE_ASPECT_COLOR_BIT,
-				.baseMipLevel = 0,
-				.levelCount = 1,
-				.baseArrayLayer = 0,
-				.layerCount = 1,
-			},
-		};
-
-		// Resolve the source access masks.
-		switch (m_CurrentLayout)
-		{
-		case VK_IMAGE_LAYOUT_GENERAL:
-		case VK_IMAGE_LAYOUT_UNDEFINED:
-			memorybarrier.srcAccessMask = 0;
-			break;
-
-		case VK_IMAGE_LAYOUT_PREINITIALIZED:
-			memorybarrier.srcAccessMask = VK_ACCESS_HOST_WRITE_BIT;
-			break;
-
-		case VK_IMAGE_LAYOUT_COLOR_ATTACHMENT_OPTIMAL:
-			memorybarrier.srcAccessMask = VK_ACCESS_COLOR_ATTACHMENT_WRITE_BIT;
-			break;
-
-		case VK_IMAGE_LAYOUT_DEPTH_STENCIL_ATTACHMENT_OPTIMAL:
-			memorybarrier.srcAccessMask = VK_ACCESS_DEPTH_STENCIL_ATTACHMENT_WRITE_BIT;
-			break;
+		const auto lastMipLevel = levelCount == VK_REMAINING_MIP_LEVELS ? m_MipLevels : std::min(m_MipLevels, baseMipLevel + levelCount);
 
-		case VK_IMAGE_LAYOUT_DEPTH_STENCIL_READ_ONLY_OPTIMAL:
-			memorybarrier.srcAccessMask = VK_ACCESS_DEPTH_STENCIL_ATTACHMENT_READ_BIT;
-			break;
-
-		case VK_IMAGE_LAYOUT_TRANSFER_SRC_OPTIMAL:
-			memorybarrier.srcAccessMask = VK_ACCESS_TRANSFER_READ_BIT;
-			break;
-
-		case VK_IMAGE_LAYOUT_PRESENT_SRC_KHR:
-			//vMB.srcAccessMask = VK_ACCESS_;
-			break;
-
-		case VK_IMAGE_LAYOUT_TRANSFER_DST_OPTIMAL:
-			memorybarrier.srcAccessMask = VK_ACCESS_TRANSFER_WRITE_BIT;
-			break;
-
-		case VK_IMAGE_LAYOUT_SHADER_READ_ONLY_OPTIMAL:
-			memorybarrier.srcAccessMask = VK_ACCESS_SHADER_READ_BIT;
-			break;
-
-		default:
-			spdlog::error("Unsupported layout transition!");
+		VkPipelineStageFlags2 destinationStages = VK_PIPELINE_STAGE_2_NONE;
+		VkAccessFlags2 destinationAccess = VK_ACCESS_2_NONE;
+		if (!ResolveLayoutSynchronization(newLayout, destinationStages, destinationAccess))
 			return;
-		}
 
-		// Resolve the destination access masks.
-		switch (newLayout)
+		// Create the memory barriers. Consecutive mip levels which are in the same layout share a single barrier.
+		std::vector<VkImageMemoryBarrier2> memoryBarriers;
+		for (uint32_t mipLevel = baseMipLevel; mipLevel < lastMipLevel; mipLevel++)
 		{
-		case VK_IMAGE_LAYOUT_UNDEFINED:
-		case VK_IMAGE_LAYOUT_GENERAL:
-		case VK_IMAGE_LAYOUT_PRESENT_SRC_KHR:
-			break;
-
-		case VK_IMAGE_LAYOUT_TRANSFER_DST_OPTIMAL:
-			memorybarrier.dstAccessMask = VK_ACCESS_TRANSFER_WRITE_BIT;
-			break;
-
-		case VK_IMAGE_LAYOUT_TRANSFER_SRC_OPTIMAL:
-			memorybarrier.dstAccessMask = VK_ACCESS_TRANSFER_READ_BIT;
-			break;
-
-		case VK_IMAGE_LAYOUT_COLOR_ATTACHMENT_OPTIMAL:
-			memorybarrier.dstAccessMask = VK_ACCESS_COLOR_ATTACHMENT_WRITE_BIT;
-			break;
-
-		case VK_IMAGE_LAYOUT_DEPTH_STENCIL_ATTACHMENT_OPTIMAL:
-			memorybarrier.dstAccessMask = memorybarrier.dstAccessMask | VK_ACCESS_DEPTH_STENCIL_ATTACHMENT_WRITE_BIT;
-			break;
-
-		case VK_IMAGE_LAYOUT_SHADER_READ_ONLY_OPTIMAL:
-			memorybarrier.srcAccessMask |= VK_ACCESS_HOST_WRITE_BIT | VK_ACCESS_TRANSFER_WRITE_BIT;
-			memorybarrier.dstAccessMask = VK_ACCESS_SHADER_READ_BIT;
-			break;
+			if (!memoryBarriers.empty() && memoryBarriers.back().oldLayout == m_MipLayouts[mipLevel])
+			{
+				memoryBarriers.back().subresourceRange.levelCount++;
+				continue;
+			}
 
-		default:
-			spdlog::error("Unsupported layout transition!");
-			return;
+			VkPipelineStageFlags2 sourceStages = VK_PIPELINE_STAGE_2_NONE;
+			VkAccessFlags2 sourceAccess = VK_ACCESS_2_NONE;
+			if (!ResolveLayoutSynchronization(m_MipLayouts[mipLevel], sourceStages, sourceAccess))
+				return;
+
+			memoryBarriers.emplace_back(VkImageMemoryBarrier2{
+				.sType = VK_STRUCTURE_TYPE_IMAGE_MEMORY_BARRIER_2,
+				.pNext = nullptr,
+				.srcStageMask = sourceStages,
+				.srcAccessMask = sourceAccess & WriteAccessFlags,
+				.dstStageMask = destinationStages,
+				.dstAccessMask = destinationAccess,
+				.oldLayout = m_MipLayouts[mipLevel],
+				.newLayout = newLayout,
+				.srcQueueFamilyIndex = VK_QUEUE_FAMILY_IGNORED,
+				.dstQueueFamilyIndex = VK_QUEUE_FAMILY_IGNORED,
+				.image = m_Image,
+				.subresourceRange = {
+					.aspectMask = VK_IMAGE_ASPECT_COLOR_BIT,
+					.baseMipLevel = mipLevel,
+					.levelCount = 1,
+					.baseArrayLayer = 0,
+					.layerCount = 1,
+				},
+				});
 		}
 
-		// Resolve the pipeline stages.
-		const auto sourceStage = GetPipelineStageFlags(memorybarrier.srcAccessMask);
-		const auto destinationStage = GetPipelineStageFlags(memorybarrier.dstAccessMask);
+		if (memoryBarriers.empty())
+			return;
 
 		// Issue the commands. 
 		// Here we begin the buffer recording if a command buffer was not given.
 		if (vCommandBuffer == VK_NULL_HANDLE)
 		{
-			m_Engine.getDeviceTable().vkCmdPipelineBarrier(m_Engine.beginCommandBufferRecording(), sourceStage, destinationStage, 0, 0, nullptr, 0, nullptr, 1, &memorybarrier);
+			m_Engine.recordImageBarriers(m_Engine.beginCommandBufferRecording(), memoryBarriers);
 			m_Engine.executeRecordedCommands();
 		}
 		else
-			m_Engine.getDeviceTable().vkCmdPipelineBarrier(vCommandBuffer, sourceStage, destinationStage, 0, 0, nullptr, 0, nullptr, 1, &memorybarrier);
+			m_Engine.recordImageBarriers(vCommandBuffer, memoryBarriers);
 
-		m_CurrentLayout = newLayout;
+		std::fill(m_MipLayouts.begin() + baseMipLevel, m_MipLayouts.begin() + lastMipLevel, newLayout);
 	}
 
-	void Image::fromBuffer(const Buffer& buffer)
+	void Image::fromBuffer(const Buffer& buffer, const VkCommandBuffer vCommandBuffer)
 	{
 		VkBufferImageCopy imageCopy = {
 			.bufferOffset = 0,
@@ -226,50 +249,55 @@ namespace rapid
 			.imageExtent = m_Extent,
 		};
 
-		const auto oldlayout = m_CurrentLayout;
-		const auto vCommandBuffer = m_Engine.beginCommandBufferRecording();
+		const auto oldlayout = m_MipLayouts.front();
+		const auto vRecordingCommandBuffer = vCommandBuffer == VK_NULL_HANDLE ? m_Engine.beginCommandBufferRecording() : vCommandBuffer;
 
 		// Change the layout to transfer source
-		changeImageLayout(VkImageLayout::VK_IMAGE_LAYOUT_TRANSFER_DST_OPTIMAL, vCommandBuffer);
+		changeImageLayout(VkImageLayout::VK_IMAGE_LAYOUT_TRANSFER_DST_OPTIMAL, vRecordingCommandBuffer);
 
 		// Copy the image.
-		m_Engine.getDeviceTable().vkCmdCopyBufferToImage(vCommandBuffer, buffer.buffer(), m_Image, m_CurrentLayout, 1, &imageCopy);
+		m_Engine.getDeviceTable().vkCmdCopyBufferToImage(vRecordingCommandBuffer, buffer.buffer(), m_Image, VkImageLayout::VK_IMAGE_LAYOUT_TRANSFER_DST_OPTIMAL, 1, &imageCopy);
+
+		// Fill the rest of the mip chain.
+		generateMipMaps(vRecordingCommandBuffer);
 
 		// Get it back to the old layout.
 		if (oldlayout != VkImageLayout::VK_IMAGE_LAYOUT_UNDEFINED && oldlayout != VkImageLayout::VK_IMAGE_LAYOUT_PREINITIALIZED)
-			changeImageLayout(oldlayout, vCommandBuffer);
+			changeImageLayout(oldlayout, vRecordingCommandBuffer);
 
-		// Execute the commands.
-		m_Engine.executeRecordedCommands();
+		// Execute the commands if we own the command buffer.
+		if (vCommandBuffer == VK_NULL_HANDLE)
+			m_Engine.executeRecordedCommands();
 	}
 
-	std::unique_ptr<Buffer> Image::toBuffer()
+	std::unique_ptr<Buffer> Image::toBuffer(const uint32_t mipLevel)
 	{
-		auto pBuffer = std::make_unique<Buffer>(m_Engine, size(), BufferType::Staging);
+		const auto extent = mipExtent(mipLevel);
+		auto pBuffer = std::make_unique<Buffer>(m_Engine, static_cast<uint64_t>(extent.width) * extent.height * extent.depth * getPixelSize(), BufferType::Staging);
 
 		VkBufferImageCopy vImageCopy = {};
-		vImageCopy.imageExtent = m_Extent;
+		vImageCopy.imageExtent = extent;
 		vImageCopy.imageOffset = {};
 		vImageCopy.imageSubresource.aspectMask = getImageAspectFlags();
 		vImageCopy.imageSubresource.baseArrayLayer = 0;
 		vImageCopy.imageSubresource.layerCount = 1;
-		vImageCopy.imageSubresource.mipLevel = 0;
+		vImageCopy.imageSubresource.mipLevel = mipLevel;
 		vImageCopy.bufferOffset = 0;
-		vImageCopy.bufferRowLength = m_Extent.width;
-		vImageCopy.bufferImageHeight = m_Extent.height;
+		vImageCopy.bufferRowLength = extent.width;
+		vImageCopy.bufferImageHeight = extent.height;
 
-		const auto oldlayout = m_CurrentLayout;
+		const auto oldlayout = m_MipLayouts[mipLevel];
 		const auto vCommandBuffer = m_Engine.beginCommandBufferRecording();
 
 		// Change the layout to transfer source
-		changeImageLayout(VkImageLayout::VK_IMAGE_LAYOUT_TRANSFER_SRC_OPTIMAL, vCommandBuffer);
+		changeImageLayout(VkImageLayout::VK_IMAGE_LAYOUT_TRANSFER_SRC_OPTIMAL, vCommandBuffer, mipLevel, 1);
 
 		// Copy the image.
-		m_Engine.getDeviceTable().vkCmdCopyImageToBuffer(vCommandBuffer, m_Image, m_CurrentLayout, pBuffer->buffer(), 1, &vImageCopy);
+		m_Engine.getDeviceTable().vkCmdCopyImageToBuffer(vCommandBuffer, m_Image, VkImageLayout::VK_IMAGE_LAYOUT_TRANSFER_SRC_OPTIMAL, pBuffer->buffer(), 1, &vImageCopy);
 
 		// Get it back to the old layout.
 		if (oldlayout != VkImageLayout::VK_IMAGE_LAYOUT_UNDEFINED && oldlayout != VkImageLayout::VK_IMAGE_LAYOUT_PREINITIALIZED)
-			changeImageLayout(oldlayout, vCommandBuffer);
+			changeImageLayout(oldlayout, vCommandBuffer, mipLevel, 1);
 
 		// Execute the commands.
 		m_Engine.executeRecordedCommands();
@@ -277,6 +305,56 @@ namespace rapid
 		return pBuffer;
 	}
 
+	void Image::generateMipMaps(const VkCommandBuffer vCommandBuffer)
+	{
+		if (m_MipLevels == 1)
+			return;
+
+		const auto vRecordingCommandBuffer = vCommandBuffer == VK_NULL_HANDLE ? m_Engine.beginCommandBufferRecording() : vCommandBuffer;
+
+		// Downsample each level from the one before it.
+		for (uint32_t mipLevel = 1; mipLevel < m_MipLevels; mipLevel++)
+		{
+			changeImageLayout(VkImageLayout::VK_IMAGE_LAYOUT_TRANSFER_SRC_OPTIMAL, vRecordingCommandBuffer, mipLevel - 1, 1);
+			changeImageLayout(VkImageLayout::VK_IMAGE_LAYOUT_TRANSFER_DST_OPTIMAL, vRecordingCommandBuffer, mipLevel, 1);
+
+			const auto sourceExtent = mipExtent(mipLevel - 1);
+			const auto destinationExtent = mipExtent(mipLevel);
+
+			const VkImageBlit imageBlit = {
+				.srcSubresource = {
+					.aspectMask = getImageAspectFlags(),
+					.mipLevel = mipLevel - 1,
+					.baseArrayLayer = 0,
+					.layerCount = 1,
+				},
+				.srcOffsets = { {}, { static_cast<int32_t>(sourceExtent.width), static_cast<int32_t>(sourceExtent.height), 1 } },
+				.dstSubresource = {
+					.aspectMask = getImageAspectFlags(),
+					.mipLevel = mipLevel,
+					.baseArrayLayer = 0,
+					.layerCount = 1,
+				},
+				.dstOffsets = { {}, { static_cast<int32_t>(destinationExtent.width), static_cast<int32_t>(destinationExtent.height), 1 } },
+			};
+
+			m_Engine.getDeviceTable().vkCmdBlitImage(vRecordingCommandBuffer, m_Image, VkImageLayout::VK_IMAGE_LAYOUT_TRANSFER_SRC_OPTIMAL, m_Image, VkImageLayout::VK_IMAGE_LAYOUT_TRANSFER_DST_OPTIMAL, 1, &imageBlit, VK_FILTER_LINEAR);
+		}
+
+		// Execute the commands if we own the command buffer.
+		if (vCommandBuffer == VK_NULL_HANDLE)
+			m_Engine.executeRecordedCommands();
+	}
+
+	VkExtent3D Image::mipExtent(const uint32_t mipLevel) const
+	{
+		return VkExtent3D{
+			.width = std::max(m_Extent.width >> mipLevel, 1u),
+			.height = std::max(m_Extent.height >> mipLevel, 1u),
+			.depth = std::max(m_Extent.depth >> mipLevel, 1u)
+		};
+	}
+
 	VkImageAspectFlags Image::getImageAspectFlags() const
 	{
 		if (m_Usage & VK_IMAGE_USAGE_DEPTH_STENCIL_ATTACHMENT_BIT)
@@ -571,7 +649,7 @@ namespace rapid
 			.imageType = VK_IMAGE_TYPE_2D,
 			.format = m_Format,
 			.extent = m_Extent,
-			.mipLevels = 1,
+			.mipLevels = m_MipLevels,
 			.arrayLayers = 1,
 			.samples = VK_SAMPLE_COUNT_1_BIT,
 			.tiling = VK_IMAGE_TILING_OPTIMAL,
@@ -579,14 +657,29 @@ namespace rapid
 			.sharingMode = VK_SHARING_MODE_EXCLUSIVE,
 			.queueFamilyIndexCount = 0,
 			.pQueueFamilyIndices = nullptr,
-			.initialLayout = m_CurrentLayout,
+			.initialLayout = VK_IMAGE_LAYOUT_UNDEFINED,
 		};
 
+		// Compressed formats report no pixel size, and are treated as small images.
+		const auto estimatedSize = static_cast<uint64_t>(m_Extent.width) * m_Extent.height * m_Extent.depth * getPixelSize();
+
+		VmaAllocationCreateFlags allocationFlags = 0;
+		if (estimatedSize >= LargeImageSize)
+			allocationFlags = VMA_ALLOCATION_CREATE_DEDICATED_MEMORY_BIT;
+
+		else if (estimatedSize < SmallImageSize)
+			allocationFlags = VMA_ALLOCATION_CREATE_STRATEGY_MIN_MEMORY_BIT;
+
 		VmaAllocationCreateInfo allocationCreateInfo = {
-			.usage = VMA_MEMORY_USAGE_GPU_ONLY
+			.flags = allocationFlags,
+			.usage = VMA_MEMORY_USAGE_AUTO_PREFER_DEVICE
 		};
 
-		utility::ValidateResult(vmaCreateImage(m_Engine.getAllocator(), &imageCreateInfo, &allocationCreateInfo, &m_Image, &m_Allocation, nullptr), "Failed to create the image!");
+		VmaAllocationInfo allocationInfo = {};
+		utility::ValidateResult(vmaCreateImage(m_Engine.getAllocator(), &imageCreateInfo, &allocationCreateInfo, &m_Image, &m_Allocation, &allocationInfo), "Failed to create the image!");
+
+		m_AllocationSize = allocationInfo.size;
+		m_Engine.getMemoryStatistics().add(MemoryCategory::Image, m_AllocationSize);
 	}
 
 	void Image::createImageview()
@@ -598,16 +691,11 @@ namespace rapid
 			.image = m_Image,
 			.viewType = VK_IMAGE_VIEW_TYPE_2D,
 			.format = m_Format,
-			.components = {
-				.r = VK_COMPONENT_SWIZZLE_IDENTITY,
-				.g = VK_COMPONENT_SWIZZLE_IDENTITY,
-				.b = VK_COMPONENT_SWIZZLE_IDENTITY,
-				.a = VK_COMPONENT_SWIZZLE_IDENTITY,
-			},
+			.components = m_Components,
 			.subresourceRange = {
 				.aspectMask = getImageAspectFlags(),
 				.baseMipLevel = 0,
-				.levelCount = 1,
+				.levelCount = m_MipLevels,
 				.baseArrayLayer = 0,
 				.layerCount = 1,
 			}
@@ -633,7 +721,7 @@ namespace rapid
 			.compareEnable = VK_FALSE,
 			.compareOp = VK_COMPARE_OP_ALWAYS,
 			.minLod = 0.0,
-			.maxLod = 1,
+			.maxLod = static_cast<float>(m_MipLevels),
 			.borderColor = VK_BORDER_COLOR_FLOAT_OPAQUE_WHITE,
 			.unnormalizedCoordinates = VK_FALSE,
 		};
@@ -4,11 +4,18 @@
 
 #include "Buffer.hpp"
 
+#include <algorithm>
+
 namespace rapid
 {
+	/**
+	 * Mip level count which requests the complete mip chain, down to a 1x1 level.
+	 */
+	constexpr uint32_t CompleteMipChain = 0;
+
 	/**
 	 * Image object.
-	 * This object stores a single 2D image.
+	 * This object stores a single 2D image, optionally with a mip chain. The layout of each mip level is tracked separately.
 	 */
 	class Image final : public BackendObject
 	{
@@ -19,8 +26,11 @@ namespace rapid
 		 * @param engine The graphics engine.
 		 * @param extent The image extent.
 		 * @param format The image format.
+		 * @param components The component mapping (swizzle) of the image view. Default is the identity mapping.
+		 * @param mipLevels The number of mip levels. Use CompleteMipChain for the full chain. Default is 1.
+		 * @param additionalUsage Usage flags on top of the default transfer and sampled usages, like VK_IMAGE_USAGE_COLOR_ATTACHMENT_BIT. Default is 0.
 		 */
-		explicit Image(GraphicsEngine& engine, VkExtent3D extent, VkFormat format);
+		explicit Image(GraphicsEngine& engine, VkExtent3D extent, VkFormat format, VkComponentMapping components = {}, uint32_t mipLevels = 1, VkImageUsageFlags additionalUsage = 0);
 
 		/**
 		 * Explicit constructor.
@@ -29,8 +39,10 @@ namespace rapid
 		 * @param extent The image extent.
 		 * @param format The image format.
 		 * @param pImageData The image data to copy.
+		 * @param components The component mapping (swizzle) of the image view. Default is the identity mapping.
+		 * @param mipLevels The number of mip levels. Use CompleteMipChain for the full chain. Default is 1.
 		 */
-		explicit Image(GraphicsEngine& engine, VkExtent3D extent, VkFormat format, const std::byte* pImageData);
+		explicit Image(GraphicsEngine& engine, VkExtent3D extent, VkFormat format, const std::byte* pImageData, VkComponentMapping components = {}, uint32_t mipLevels = 1);
 
 		/**
 		 * Destructor.
@@ -44,25 +56,44 @@ namespace rapid
 
 		/**
 		 * Change the image layout of the image.
+		 * Mip levels may be in different layouts, and each of them is transitioned from its own layout.
 		 *
 		 * @param newLayout The new layout to set.
 		 * @param vCommandBuffer The command buffer to use. Default is VK_NULL_HANDLE.
+		 * @param baseMipLevel The first mip level to transition. Default is 0.
+		 * @param levelCount The number of mip levels to transition. Default is VK_REMAINING_MIP_LEVELS.
 		 */
-		void changeImageLayout(const VkImageLayout newLayout, const VkCommandBuffer vCommandBuffer = VK_NULL_HANDLE);
+		void changeImageLayout(const VkImageLayout newLayout, const VkCommandBuffer vCommandBuffer = VK_NULL_HANDLE, const uint32_t baseMipLevel = 0, const uint32_t levelCount = VK_REMAINING_MIP_LEVELS);
 
 		/**
 		 * Copy data from a stagging buffer.
+		 * The data is copied to the first mip level, and the rest of the mip chain is generated from it.
+		 * If a command buffer is given, the commands are only recorded to it, and it's up to the caller to submit it.
 		 *
 		 * @param pBuffer The buffer to copy data from.
+		 * @param vCommandBuffer The command buffer to use. Default is VK_NULL_HANDLE.
 		 */
-		void fromBuffer(const Buffer& buffer);
+		void fromBuffer(const Buffer& buffer, const VkCommandBuffer vCommandBuffer = VK_NULL_HANDLE);
 
 		/**
-		 * Copy the whole image to a buffer.
+		 * Copy a mip level of the image to a buffer.
+		 * This waits till the copy is done. Use the window's readback queue to read images without stalling.
 		 *
+		 * @param mipLevel The mip level to copy. Default is 0.
 		 * @return The copied buffer.
 		 */
-		std::unique_ptr<Buffer> toBuffer();
+		std::unique_ptr<Buffer> toBuffer(const uint32_t mipLevel = 0);
+
+		/**
+		 * Generate the mip chain by downsampling the first mip level using linear blits.
+		 * The first mip level needs to have its data and be in the transfer destination layout. Afterwards all the levels
+		 * but the last are in the transfer source layout and the last is in the transfer destination layout, so the caller
+		 * needs to transition the image to the layout it needs.
+		 * If a command buffer is given, the commands are only recorded to it, and it's up to the caller to submit it.
+		 *
+		 * @param vCommandBuffer The command buffer to use. Default is VK_NULL_HANDLE.
+		 */
+		void generateMipMaps(const VkCommandBuffer vCommandBuffer = VK_NULL_HANDLE);
 
 		/**
 		 * Get the image extent.
@@ -71,6 +102,21 @@ namespace rapid
 		 */
 		VkExtent3D extent() const { return m_Extent; }
 
+		/**
+		 * Get the extent of a mip level.
+		 *
+		 * @param mipLevel The mip level.
+		 * @return The mip level's extent.
+		 */
+		VkExtent3D mipExtent(const uint32_t mipLevel) const;
+
+		/**
+		 * Get the number of mip levels.
+		 *
+		 * @return The mip level count.
+		 */
+		uint32_t mipLevels() const { return m_MipLevels; }
+
 		/**
 		 * Get the size of the image.
 		 *
@@ -107,11 +153,20 @@ namespace rapid
 		VkSampler getSampler() const { return m_Sampler; }
 
 		/**
-		 * Get the current image layout.
+		 * Get the current layout of a mip level.
 		 *
+		 * @param mipLevel The mip level. Default is 0.
 		 * @return The image layout.
 		 */
-		VkImageLayout layout() const { return m_CurrentLayout; }
+		VkImageLayout layout(const uint32_t mipLevel = 0) const { return m_MipLayouts[mipLevel]; }
+
+		/**
+		 * Set the tracked layout of all the mip levels.
+		 * This needs to be called when the layout is changed without the image, like by the render graph.
+		 *
+		 * @param newLayout The layout the image is in.
+		 */
+		void setLayout(const VkImageLayout newLayout) { std::fill(m_MipLayouts.begin(), m_MipLayouts.end(), newLayout); }
 
 		/**
 		 * Get the image aspect flags.
@@ -144,6 +199,8 @@ namespace rapid
 		void createSampler();
 
 	private:
+		static constexpr VkImageUsageFlags DefaultUsage = VK_IMAGE_USAGE_TRANSFER_SRC_BIT | VK_IMAGE_USAGE_TRANSFER_DST_BIT | VK_IMAGE_USAGE_SAMPLED_BIT;
+
 		GraphicsEngine& m_Engine;
 
 		VkImage m_Image = VK_NULL_HANDLE;
@@ -151,11 +208,14 @@ namespace rapid
 		VkSampler m_Sampler = VK_NULL_HANDLE;
 
 		VmaAllocation m_Allocation = nullptr;
+		VkDeviceSize m_AllocationSize = 0;
 
 		const VkExtent3D m_Extent;
 		const VkFormat m_Format = VK_FORMAT_UNDEFINED;
-		const VkImageUsageFlags m_Usage = VK_IMAGE_USAGE_TRANSFER_SRC_BIT | VK_IMAGE_USAGE_TRANSFER_DST_BIT | VK_IMAGE_USAGE_SAMPLED_BIT;
+		const VkComponentMapping m_Components = {};
+		const uint32_t m_MipLevels = 1;
+		const VkImageUsageFlags m_Usage = DefaultUsage;
 
-		VkImageLayout m_CurrentLayout = VK_IMAGE_LAYOUT_UNDEFINED;
+		std::vector<VkImageLayout> m_MipLayouts = {};
 	};
 }
\ No newline at end of file
@@ -0,0 +1,682 @@
+// Copyright (c) 2022 Dhiraj Wishal
+
+#include "ImageLoader.hpp"
+#include "Utility.hpp"
+
+#include <spdlog/spdlog.h>
+#include <SDL_events.h>
+
+#define STB_IMAGE_IMPLEMENTATION
+#include <stb_image.h>
+
+#include <algorithm>
+#include <cstdlib>
+#include <iterator>
+#include <limits>
+
+namespace
+{
+	constexpr uint64_t StagingRingSize = 16 * 1024 * 1024;
+	constexpr uint64_t StagingAlignment = 16;
+
+	constexpr VkFormat DecodedFormat = VK_FORMAT_R8G8B8A8_UNORM;	// The decoder always outputs 8 bit RGBA pixels.
+	constexpr VkFormat ImageFormat = VK_FORMAT_R8G8B8A8_UNORM;
+
+	/**
+	 * Align a size to the staging alignment.
+	 *
+	 * @param size The size to align.
+	 * @return The aligned size.
+	 */
+	constexpr uint64_t AlignStaging(uint64_t size)
+	{
+		return (size + StagingAlignment - 1) & ~(StagingAlignment - 1);
+	}
+
+	/**
+	 * Get the slot index from a handle.
+	 *
+	 * @param handle The handle.
+	 * @return The index. This will be out of bounds if the handle is invalid.
+	 */
+	uint64_t ToIndex(rapid::ImageHandle handle) { return (handle & std::numeric_limits<uint32_t>::max()) - 1; }
+
+	/**
+	 * Get the generation from a handle.
+	 *
+	 * @param handle The handle.
+	 * @return The generation.
+	 */
+	uint32_t ToGeneration(rapid::ImageHandle handle) { return static_cast<uint32_t>(handle >> 32); }
+
+	/**
+	 * Create a handle from the slot index and the generation.
+	 *
+	 * @param index The slot index.
+	 * @param generation The slot generation.
+	 * @return The handle.
+	 */
+	rapid::ImageHandle ToHandle(uint64_t index, uint32_t generation) { return (static_cast<uint64_t>(generation) << 32) | (index + 1); }
+
+	/**
+	 * Downscale RGBA pixels to fit a size, keeping the aspect ratio.
+	 * Each destination pixel is the average of the source pixels it covers (box filter).
+	 *
+	 * @param pPixels The source pixels.
+	 * @param width The source width. This is set to the destination width.
+	 * @param height The source height. This is set to the destination height.
+	 * @param size The maximum width and height.
+	 * @return The destination pixels. These need to be freed using std::free.
+	 */
+	std::byte* Downscale(const std::byte* pPixels, int32_t& width, int32_t& height, uint32_t size)
+	{
+		const auto scale = static_cast<float>(size) / std::max(width, height);
+		const auto newWidth = std::max(static_cast<int32_t>(width * scale + 0.5f), 1);
+		const auto newHeight = std::max(static_cast<int32_t>(height * scale + 0.5f), 1);
+
+		const auto pScaled = static_cast<std::byte*>(std::malloc(static_cast<uint64_t>(newWidth) * newHeight * 4));
+		if (!pScaled)
+			return nullptr;
+
+		for (int32_t y = 0; y < newHeight; y++)
+		{
+			const auto firstY = static_cast<int64_t>(y) * height / newHeight;
+			const auto lastY = std::max(static_cast<int64_t>(y + 1) * height / newHeight, firstY + 1);
+
+			for (int32_t x = 0; x < newWidth; x++)
+			{
+				const auto firstX = static_cast<int64_t>(x) * width / newWidth;
+				const auto lastX = std::max(static_cast<int64_t>(x + 1) * width / newWidth, firstX + 1);
+
+				std::array<uint64_t, 4> sum = {};
+				for (auto sourceY = firstY; sourceY < lastY; sourceY++)
+				{
+					for (auto sourceX = firstX; sourceX < lastX; sourceX++)
+					{
+						const auto pSource = pPixels + (sourceY * width + sourceX) * 4;
+						for (uint32_t channel = 0; channel < 4; channel++)
+							sum[channel] += static_cast<uint8_t>(pSource[channel]);
+					}
+				}
+
+				const auto count = static_cast<uint64_t>((lastX - firstX) * (lastY - firstY));
+				const auto pDestination = pScaled + (static_cast<int64_t>(y) * newWidth + x) * 4;
+				for (uint32_t channel = 0; channel < 4; channel++)
+					pDestination[channel] = static_cast<std::byte>((sum[channel] + count / 2) / count);
+			}
+		}
+
+		width = newWidth;
+		height = newHeight;
+		return pScaled;
+	}
+}
+
+namespace rapid
+{
+	ImageLoader::ImageLoader(GraphicsEngine& engine, Window& window, TextureRegistry& textureRegistry, TextureAtlas& textureAtlas)
+		: m_Engine(engine), m_Window(window), m_TextureRegistry(textureRegistry), m_TextureAtlas(textureAtlas)
+	{
+		const auto& deviceTable = m_Engine.getDeviceTable();
+		const auto logicalDevice = m_Engine.getLogicalDevice();
+
+		// Create the staging ring. It stays mapped throughout its lifetime.
+		m_StagingRing = std::make_unique<Buffer>(m_Engine, StagingRingSize, BufferType::Staging);
+		m_pStagingMemory = m_StagingRing->mapMemory();
+
+		// Create the command pool and the upload batches.
+		const VkCommandPoolCreateInfo commandPoolCreateInfo = {
+			.sType = VK_STRUCTURE_TYPE_COMMAND_POOL_CREATE_INFO,
+			.pNext = VK_NULL_HANDLE,
+			.flags = VK_COMMAND_POOL_CREATE_RESET_COMMAND_BUFFER_BIT | VK_COMMAND_POOL_CREATE_TRANSIENT_BIT,
+			.queueFamilyIndex = m_Engine.getQueue().getTransferFamily().value()
+		};
+
+		utility::ValidateResult(deviceTable.vkCreateCommandPool(logicalDevice, &commandPoolCreateInfo, nullptr, &m_CommandPool), "Failed to create the command pool!");
+
+		for (auto& batch : m_UploadBatches)
+		{
+			const VkCommandBufferAllocateInfo allocateInfo = {
+				.sType = VK_STRUCTURE_TYPE_COMMAND_BUFFER_ALLOCATE_INFO,
+				.pNext = VK_NULL_HANDLE,
+				.commandPool = m_CommandPool,
+				.level = VK_COMMAND_BUFFER_LEVEL_PRIMARY,
+				.commandBufferCount = 1,
+			};
+
+			utility::ValidateResult(deviceTable.vkAllocateCommandBuffers(logicalDevice, &allocateInfo, &batch.m_CommandBuffer), "Failed to allocate command buffer!");
+
+			const VkFenceCreateInfo fenceCreateInfo = {
+				.sType = VkStructureType::VK_STRUCTURE_TYPE_FENCE_CREATE_INFO,
+				.pNext = VK_NULL_HANDLE,
+				.flags = 0
+			};
+
+			utility::ValidateResult(deviceTable.vkCreateFence(logicalDevice, &fenceCreateInfo, nullptr, &batch.m_Fence), "Failed to create the synchronization fence!");
+		}
+	}
+
+	ImageLoader::~ImageLoader()
+	{
+		// The worker threads are shared, so wait till our decodes are done. The ones which haven't started are skipped.
+		{
+			auto lock = std::unique_lock(m_DecodedImageMutex);
+			m_IsStopping = true;
+			m_DecodeCondition.wait(lock, [this] { return m_PendingDecodeCount == 0; });
+		}
+
+		const auto& deviceTable = m_Engine.getDeviceTable();
+		const auto logicalDevice = m_Engine.getLogicalDevice();
+
+		// Wait till the uploads are done and destroy the batches.
+		for (auto& batch : m_UploadBatches)
+		{
+			if (batch.m_IsPending)
+				utility::ValidateResult(deviceTable.vkWaitForFences(logicalDevice, 1, &batch.m_Fence, VK_TRUE, std::numeric_limits<uint64_t>::max()), "Failed to wait for the fence!");
+
+			for (auto& pImage : batch.m_ReleasedImages)
+				pImage->terminate();
+
+			for (auto& pBuffer : batch.m_DedicatedBuffers)
+				pBuffer->terminate();
+
+			deviceTable.vkDestroyFence(logicalDevice, batch.m_Fence, nullptr);
+			deviceTable.vkFreeCommandBuffers(logicalDevice, m_CommandPool, 1, &batch.m_CommandBuffer);
+		}
+
+		deviceTable.vkDestroyCommandPool(logicalDevice, m_CommandPool, nullptr);
+		m_StagingRing->terminate();
+
+		// Destroy all the images.
+		for (auto& slot : m_Slots)
+		{
+			if (slot.m_Image)
+				slot.m_Image->terminate();
+		}
+
+		for (auto& retired : m_RetiredImages)
+			retired.m_Image->terminate();
+	}
+
+	ImageHandle ImageLoader::load(std::filesystem::path file)
+	{
+		return acquire(std::move(file), 0);
+	}
+
+	ImageHandle ImageLoader::loadIcon(std::filesystem::path file, uint32_t iconSize)
+	{
+		return acquire(std::move(file), std::max(iconSize, 1u));
+	}
+
+	ImageHandle ImageLoader::acquire(std::filesystem::path file, uint32_t iconSize)
+	{
+		uint64_t index = m_Slots.size();
+
+		// Reuse a free slot if possible.
+		if (!m_FreeSlots.empty())
+		{
+			index = m_FreeSlots.back();
+			m_FreeSlots.pop_back();
+		}
+		else
+		{
+			m_Slots.emplace_back();
+		}
+
+		auto& slot = m_Slots[index];
+		slot.m_File = std::move(file);
+		slot.m_IconSize = iconSize;
+		slot.m_State = State::Decoding;
+
+		const auto handle = ToHandle(index, slot.m_Generation);
+		submitDecode(handle, slot.m_File, iconSize);
+
+		return handle;
+	}
+
+	void ImageLoader::release(ImageHandle handle)
+	{
+		const auto pSlot = getSlot(handle);
+		if (!pSlot)
+		{
+			spdlog::warn("Trying to release an invalid image handle!");
+			return;
+		}
+
+		// If the image is being uploaded, it's destroyed once the upload is done.
+		if (pSlot->m_State == State::Uploading)
+		{
+			for (auto& batch : m_UploadBatches)
+			{
+				if (batch.m_IsPending && std::find(batch.m_Handles.begin(), batch.m_Handles.end(), handle) != batch.m_Handles.end())
+					batch.m_ReleasedImages.emplace_back(std::move(pSlot->m_Image));
+			}
+		}
+
+		// The image could be used by frames in flight, so it's destroyed later.
+		else if (pSlot->m_Image)
+		{
+			m_RetiredImages.emplace_back(RetiredImage{
+				.m_Image = std::move(pSlot->m_Image),
+				.m_TextureID = pSlot->m_TextureID,
+				.m_DestroyFrame = m_FrameNumber + m_Window.retireFrameCount()
+				}
+			);
+		}
+
+		// Icons only need to release their atlas entry.
+		if (pSlot->m_AtlasHandle != InvalidAtlasHandle)
+		{
+			m_TextureAtlas.release(pSlot->m_AtlasHandle);
+			m_AtlasHandles.erase(pSlot->m_AtlasHandle);
+		}
+
+		// Bumping the generation makes the handle stale, so pending decodes and uploads of it are dropped.
+		pSlot->m_File.clear();
+		pSlot->m_AtlasHandle = InvalidAtlasHandle;
+		pSlot->m_TextureID = nullptr;
+		pSlot->m_State = State::Free;
+		pSlot->m_Generation++;
+		m_FreeSlots.emplace_back(static_cast<uint32_t>(ToIndex(handle)));
+	}
+
+	bool ImageLoader::isResident(ImageHandle handle) const
+	{
+		const auto pSlot = getSlot(handle);
+		return pSlot && pSlot->m_State == State::Resident;
+	}
+
+	bool ImageLoader::hasFailed(ImageHandle handle) const
+	{
+		const auto pSlot = getSlot(handle);
+		return pSlot && pSlot->m_State == State::Failed;
+	}
+
+	const Image* ImageLoader::getImage(ImageHandle handle) const
+	{
+		const auto pSlot = getSlot(handle);
+		return pSlot && pSlot->m_State == State::Resident ? pSlot->m_Image.get() : nullptr;
+	}
+
+	ImTextureID ImageLoader::getTextureID(ImageHandle handle) const
+	{
+		const auto pSlot = getSlot(handle);
+		return pSlot && pSlot->m_State == State::Resident ? pSlot->m_TextureID : nullptr;
+	}
+
+	std::optional<AtlasRegion> ImageLoader::getTextureRegion(ImageHandle handle) const
+	{
+		const auto pSlot = getSlot(handle);
+		if (!pSlot)
+			return std::nullopt;
+
+		// Evicted icons are loaded again on the next update.
+		if (pSlot->m_State == State::Evicted)
+		{
+			pSlot->m_IsRequested = true;
+			return std::nullopt;
+		}
+
+		if (pSlot->m_State != State::Resident)
+			return std::nullopt;
+
+		if (pSlot->m_AtlasHandle != InvalidAtlasHandle)
+			return m_TextureAtlas.getRegion(pSlot->m_AtlasHandle);
+
+		const auto extent = pSlot->m_Image->extent();
+		return AtlasRegion{ .m_TextureID = pSlot->m_TextureID, .m_UV0 = ImVec2(0.0f, 0.0f), .m_UV1 = ImVec2(1.0f, 1.0f), .m_Width = extent.width, .m_Height = extent.height };
+	}
+
+	void ImageLoader::update()
+	{
+		m_FrameNumber++;
+
+		completeUploads();
+		reloadEvictedIcons();
+
+		// Destroy the released images which are no longer used by any frame.
+		std::erase_if(m_RetiredImages, [this](RetiredImage& retired)
+			{
+				if (retired.m_DestroyFrame > m_FrameNumber)
+					return false;
+
+				if (retired.m_TextureID)
+					m_TextureRegistry.unregisterTexture(retired.m_TextureID);
+
+				retired.m_Image->terminate();
+				return true;
+			}
+		);
+
+		submitUploads();
+	}
+
+	bool ImageLoader::isBusy() const
+	{
+		if (!m_WaitingImages.empty())
+			return true;
+
+		return std::any_of(m_UploadBatches.begin(), m_UploadBatches.end(), [](const UploadBatch& batch) { return batch.m_IsPending; });
+	}
+
+	ImageLoader::Slot* ImageLoader::getSlot(ImageHandle handle)
+	{
+		const auto index = ToIndex(handle);
+		if (handle == InvalidImageHandle || index >= m_Slots.size())
+			return nullptr;
+
+		auto& slot = m_Slots[index];
+		if (slot.m_Generation != ToGeneration(handle) || slot.m_State == State::Free)
+			return nullptr;
+
+		return &slot;
+	}
+
+	const ImageLoader::Slot* ImageLoader::getSlot(ImageHandle handle) const
+	{
+		return const_cast<ImageLoader*>(this)->getSlot(handle);
+	}
+
+	void ImageLoader::submitDecode(ImageHandle handle, std::filesystem::path file, uint32_t iconSize)
+	{
+		{
+			const auto lock = std::scoped_lock(m_DecodedImageMutex);
+			m_PendingDecodeCount++;
+		}
+
+		GetSharedThreadPool().submit([this, handle, file = std::move(file), iconSize]
+			{
+				if (!m_IsStopping)
+					decode(handle, file, iconSize);
+
+				// Notify while holding the lock, so the destructor can't return before we're done with the condition.
+				const auto lock = std::scoped_lock(m_DecodedImageMutex);
+				m_PendingDecodeCount--;
+				m_DecodeCondition.notify_all();
+			}
+		);
+	}
+
+	void ImageLoader::decode(ImageHandle handle, const std::filesystem::path& file, uint32_t iconSize)
+	{
+		int32_t width = 0, height = 0, channels = 0;
+		auto pPixels = std::unique_ptr<std::byte, void(*)(void*)>(reinterpret_cast<std::byte*>(stbi_load(file.string().c_str(), &width, &height, &channels, STBI_rgb_alpha)), stbi_image_free);
+
+		if (!pPixels)
+			spdlog::warn("Failed to load the image {}: {}", file.string(), stbi_failure_reason());
+
+		// Downscale the icons which are larger than the icon size, so they don't waste atlas space.
+		else if (iconSize > 0 && static_cast<uint32_t>(std::max(width, height)) > iconSize)
+			pPixels = { Downscale(pPixels.get(), width, height, iconSize), std::free };
+
+		{
+			const auto lock = std::scoped_lock(m_DecodedImageMutex);
+			m_DecodedImages.emplace_back(DecodedImage{
+				.m_Handle = handle,
+				.m_pPixels = std::move(pPixels),
+				.m_Width = static_cast<uint32_t>(width),
+				.m_Height = static_cast<uint32_t>(height)
+				}
+			);
+		}
+
+		// Wake up the event loop so the image gets uploaded without waiting for any input.
+		SDL_Event sdlEvent = {};
+		sdlEvent.type = SDL_USEREVENT;
+		SDL_PushEvent(&sdlEvent);
+	}
+
+	void ImageLoader::completeUploads()
+	{
+		const auto& deviceTable = m_Engine.getDeviceTable();
+		const auto logicalDevice = m_Engine.getLogicalDevice();
+
+		// Batches are submitted in order, so they're completed in order starting from the oldest one.
+		for (uint32_t i = 0; i < m_UploadBatches.size(); i++)
+		{
+			auto& batch = m_UploadBatches[(m_NextBatch + i) % m_UploadBatches.size()];
+			if (!batch.m_IsPending)
+				continue;
+
+			if (deviceTable.vkGetFenceStatus(logicalDevice, batch.m_Fence) != VK_SUCCESS)
+				break;
+
+			utility::ValidateResult(deviceTable.vkResetFences(logicalDevice, 1, &batch.m_Fence), "Failed to reset the fence!");
+
+			// Make the images resident. Images which were released during the upload are already retired.
+			for (const auto handle : batch.m_Handles)
+			{
+				const auto pSlot = getSlot(handle);
+				if (pSlot && pSlot->m_State == State::Uploading)
+				{
+					pSlot->m_TextureID = m_TextureRegistry.registerTexture(*pSlot->m_Image);
+					pSlot->m_State = State::Resident;
+				}
+			}
+
+			// The images released during the upload were never rendered, so they can be destroyed right away.
+			for (auto& pImage : batch.m_ReleasedImages)
+				pImage->terminate();
+
+			for (auto& pBuffer : batch.m_DedicatedBuffers)
+				pBuffer->terminate();
+
+			// Free the batch's staging memory.
+			m_RingTail = batch.m_RingHead;
+			m_RingSize -= batch.m_RingSize;
+
+			batch.m_Handles.clear();
+			batch.m_ReleasedImages.clear();
+			batch.m_DedicatedBuffers.clear();
+			batch.m_RingSize = 0;
+			batch.m_IsPending = false;
+		}
+	}
+
+	void ImageLoader::submitUploads()
+	{
+		// Take the newly decoded images.
+		{
+			const auto lock = std::scoped_lock(m_DecodedImageMutex);
+			std::move(m_DecodedImages.begin(), m_DecodedImages.end(), std::back_inserter(m_WaitingImages));
+			m_DecodedImages.clear();
+		}
+
+		auto& batch = m_UploadBatches[m_NextBatch];
+		if (m_WaitingImages.empty() || batch.m_IsPending)
+			return;
+
+		const auto& deviceTable = m_Engine.getDeviceTable();
+		const VkCommandBufferBeginInfo beginInfo = {
+			.sType = VkStructureType::VK_STRUCTURE_TYPE_COMMAND_BUFFER_BEGIN_INFO,
+			.pNext = nullptr,
+			.flags = VkCommandBufferUsageFlagBits::VK_COMMAND_BUFFER_USAGE_ONE_TIME_SUBMIT_BIT
+		};
+
+		utility::ValidateResult(deviceTable.vkBeginCommandBuffer(batch.m_CommandBuffer, &beginInfo), "Failed to begin command buffer recording!");
+
+		uint64_t uploadedCount = 0;
+		for (auto& decodedImage : m_WaitingImages)
+		{
+			// Skip the images which were released while decoding.
+			const auto pSlot = getSlot(decodedImage.m_Handle);
+			if (!pSlot || pSlot->m_State != State::Decoding)
+			{
+				uploadedCount++;
+				continue;
+			}
+
+			if (!decodedImage.m_pPixels)
+			{
+				pSlot->m_State = State::Failed;
+				uploadedCount++;
+				continue;
+			}
+
+			// Icons are copied to the atlas, which uploads them before the next frame.
+			if (pSlot->m_IconSize > 0)
+			{
+				pSlot->m_AtlasHandle = m_TextureAtlas.insert(decodedImage.m_pPixels.get(), decodedImage.m_Width, decodedImage.m_Height);
+				pSlot->m_State = pSlot->m_AtlasHandle != InvalidAtlasHandle ? State::Resident : State::Failed;
+
+				if (pSlot->m_AtlasHandle != InvalidAtlasHandle)
+					m_AtlasHandles[pSlot->m_AtlasHandle] = decodedImage.m_Handle;
+
+				uploadedCount++;
+				continue;
+			}
+
+			const VkExtent3D extent = { decodedImage.m_Width, decodedImage.m_Height, 1u };
+			const auto size = static_cast<uint64_t>(extent.width) * extent.height * 4;
+
+			// Allocate the staging memory. Images larger than the ring get a buffer of their own.
+			const Buffer* pStagingBuffer = m_StagingRing.get();
+			uint64_t offset = 0;
+			if (size > StagingRingSize)
+			{
+				auto& pBuffer = batch.m_DedicatedBuffers.emplace_back(std::make_unique<Buffer>(m_Engine, size, BufferType::Staging));
+				utility::ConvertPixels(pBuffer->mapMemory(), ImageFormat, decodedImage.m_pPixels.get(), DecodedFormat, size / 4);
+				pBuffer->unmapMemory();
+				pStagingBuffer = pBuffer.get();
+			}
+			else
+			{
+				offset = allocateStaging(size, batch);
+
+				// Stop if the ring is full. The rest will be uploaded once the previous uploads are done.
+				if (offset == StagingRingSize)
+					break;
+
+				utility::ConvertPixels(m_pStagingMemory + offset, ImageFormat, decodedImage.m_pPixels.get(), DecodedFormat, size / 4);
+				m_StagingRing->flushMemory(offset, size);
+			}
+
+			// Create the image and record the copy. The mip chain is generated on the GPU, so minified previews stay clean.
+			pSlot->m_Image = std::make_unique<Image>(m_Engine, extent, ImageFormat, VkComponentMapping{}, CompleteMipChain);
+			pSlot->m_Image->changeImageLayout(VK_IMAGE_LAYOUT_TRANSFER_DST_OPTIMAL, batch.m_CommandBuffer);
+
+			const VkBufferImageCopy imageCopy = {
+				.bufferOffset = offset,
+				.bufferRowLength = extent.width,
+				.bufferImageHeight = extent.height,
+				.imageSubresource = {
+					.aspectMask = pSlot->m_Image->getImageAspectFlags(),
+					.mipLevel = 0,
+					.baseArrayLayer = 0,
+					.layerCount = 1,
+				},
+				.imageOffset = {},
+				.imageExtent = extent,
+			};
+
+			deviceTable.vkCmdCopyBufferToImage(batch.m_CommandBuffer, pStagingBuffer->buffer(), pSlot->m_Image->getImage(), VK_IMAGE_LAYOUT_TRANSFER_DST_OPTIMAL, 1, &imageCopy);
+			pSlot->m_Image->generateMipMaps(batch.m_CommandBuffer);
+			pSlot->m_Image->changeImageLayout(VK_IMAGE_LAYOUT_SHADER_READ_ONLY_OPTIMAL, batch.m_CommandBuffer);
+
+			pSlot->m_State = State::Uploading;
+			batch.m_Handles.emplace_back(decodedImage.m_Handle);
+			uploadedCount++;
+		}
+
+		m_WaitingImages.erase(m_WaitingImages.begin(), m_WaitingImages.begin() + uploadedCount);
+		utility::ValidateResult(deviceTable.vkEndCommandBuffer(batch.m_CommandBuffer), "Failed to end command buffer recording!");
+
+		// Nothing to submit if every image was skipped.
+		if (batch.m_Handles.empty())
+			return;
+
+		const VkSubmitInfo submitInfo = {
+			.sType = VkStructureType::VK_STRUCTURE_TYPE_SUBMIT_INFO,
+			.commandBufferCount = 1,
+			.pCommandBuffers = &batch.m_CommandBuffer
+		};
+
+		{
+			const auto lock = m_Engine.lockQueue();
+			utility::ValidateResult(deviceTable.vkQueueSubmit(m_Engine.getQueue().getTransferQueue(), 1, &submitInfo, batch.m_Fence), "Failed to submit the queue!");
+		}
+
+		batch.m_RingHead = m_RingHead;
+		batch.m_IsPending = true;
+		m_NextBatch = (m_NextBatch + 1) % m_UploadBatches.size();
+	}
+
+	void ImageLoader::reloadEvictedIcons()
+	{
+		for (const auto atlasHandle : m_TextureAtlas.takeEvictedHandles())
+		{
+			const auto iterator = m_AtlasHandles.find(atlasHandle);
+			if (iterator == m_AtlasHandles.end())
+				continue;
+
+			if (const auto pSlot = getSlot(iterator->second))
+			{
+				pSlot->m_AtlasHandle = InvalidAtlasHandle;
+				pSlot->m_State = State::Evicted;
+				pSlot->m_IsRequested = false;
+				m_EvictedIcons.emplace_back(iterator->second);
+			}
+
+			m_AtlasHandles.erase(iterator);
+		}
+
+		// Only the icons which are still used are loaded again. The rest stay evicted till they're requested.
+		std::erase_if(m_EvictedIcons, [this](ImageHandle handle)
+			{
+				const auto pSlot = getSlot(handle);
+				if (!pSlot || pSlot->m_State != State::Evicted)
+					return true;
+
+				if (!pSlot->m_IsRequested)
+					return false;
+
+				pSlot->m_State = State::Decoding;
+				submitDecode(handle, pSlot->m_File, pSlot->m_IconSize);
+				return true;
+			}
+		);
+	}
+
+	uint64_t ImageLoader::allocateStaging(uint64_t size, UploadBatch& batch)
+	{
+		size = AlignStaging(size);
+
+		// Start from the beginning if the ring is empty, so we don't have to wrap around.
+		if (m_RingSize == 0)
+		{
+			m_RingHead = 0;
+			m_RingTail = 0;
+		}
+
+		// The used region is [tail, head) here. Either allocate after the head, or wrap around and allocate before the tail.
+		uint64_t offset = StagingRingSize;
+		uint64_t usedSize = size;
+		if (m_RingHead >= m_RingTail && (m_RingHead != m_RingTail || m_RingSize == 0))
+		{
+			if (m_RingHead + size <= StagingRingSize)
+			{
+				offset = m_RingHead;
+			}
+			else if (size <= m_RingTail)
+			{
+				// The space after the head is wasted till the tail wraps around.
+				offset = 0;
+				usedSize += StagingRingSize - m_RingHead;
+			}
+		}
+
+		// The used region wraps around here, so the free region is [head, tail).
+		else if (m_RingHead < m_RingTail && m_RingHead + size <= m_RingTail)
+		{
+			offset = m_RingHead;
+		}
+
+		if (offset == StagingRingSize)
+			return offset;
+
+		m_RingHead = offset + size;
+		m_RingSize += usedSize;
+		batch.m_RingSize += usedSize;
+		return offset;
+	}
+}
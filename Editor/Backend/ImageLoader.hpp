@@ -0,0 +1,311 @@
+// Copyright (c) 2022 Dhiraj Wishal
+
+#pragma once
+
+#include "TextureAtlas.hpp"
+
+#include "Core/ThreadPool.hpp"
+
+#include <array>
+#include <atomic>
+#include <unordered_map>
+
+namespace rapid
+{
+	/**
+	 * Image handle type.
+	 * The lower 32 bits store the slot index (plus one) and the upper 32 bits store the slot's generation, so handles of
+	 * released images never alias new ones.
+	 */
+	using ImageHandle = uint64_t;
+
+	/**
+	 * Invalid image handle.
+	 */
+	constexpr ImageHandle InvalidImageHandle = 0;
+
+	/**
+	 * Image loader class.
+	 * This loads image files (PNG, JPEG, TGA, BMP, etc.) in the background. Files are decoded on the shared worker threads,
+	 * and the pixels are uploaded through a persistently mapped staging ring using its own command buffers, so loading
+	 * hundreds of images never stalls a frame.
+	 *
+	 * Loading returns a handle right away, which becomes resident (and gets an ImGui texture ID) once the upload completes.
+	 * Icons are downscaled while decoding and are packed in the texture atlas instead of getting images of their own. If
+	 * the atlas evicts an icon, it's loaded again the next time it's requested.
+	 */
+	class ImageLoader final
+	{
+	public:
+		/**
+		 * Explicit constructor.
+		 *
+		 * @param engine The graphics engine.
+		 * @param window The window the images are rendered to.
+		 * @param textureRegistry The registry to register the loaded images in.
+		 * @param textureAtlas The atlas to pack the loaded icons in.
+		 */
+		explicit ImageLoader(GraphicsEngine& engine, Window& window, TextureRegistry& textureRegistry, TextureAtlas& textureAtlas);
+
+		/**
+		 * Destructor.
+		 */
+		~ImageLoader();
+
+		ImageLoader(const ImageLoader&) = delete;
+		ImageLoader& operator=(const ImageLoader&) = delete;
+
+		/**
+		 * Load an image file.
+		 *
+		 * @param file The image file.
+		 * @return The image handle.
+		 */
+		[[nodiscard]] ImageHandle load(std::filesystem::path file);
+
+		/**
+		 * Load an image file as an icon.
+		 * Icons are downscaled to fit the icon size and are packed in the texture atlas, so they only have a region and no
+		 * image or texture ID of their own.
+		 *
+		 * @param file The image file.
+		 * @param iconSize The maximum width and height of the icon.
+		 * @return The image handle.
+		 */
+		[[nodiscard]] ImageHandle loadIcon(std::filesystem::path file, uint32_t iconSize);
+
+		/**
+		 * Release an image.
+		 * The image is destroyed once no frame in flight uses it. The handle is invalid after this.
+		 *
+		 * @param handle The image handle.
+		 */
+		void release(ImageHandle handle);
+
+		/**
+		 * Check if an image is resident (uploaded and ready to be rendered).
+		 *
+		 * @param handle The image handle.
+		 * @return Whether or not the image is resident.
+		 */
+		bool isResident(ImageHandle handle) const;
+
+		/**
+		 * Check if an image failed to load.
+		 *
+		 * @param handle The image handle.
+		 * @return Whether or not loading failed.
+		 */
+		bool hasFailed(ImageHandle handle) const;
+
+		/**
+		 * Get the image of a handle.
+		 *
+		 * @param handle The image handle.
+		 * @return The image pointer. This is nullptr if the image is not resident.
+		 */
+		const Image* getImage(ImageHandle handle) const;
+
+		/**
+		 * Get the ImGui texture ID of a handle.
+		 *
+		 * @param handle The image handle.
+		 * @return The texture ID. This is nullptr if the image is not resident.
+		 */
+		ImTextureID getTextureID(ImageHandle handle) const;
+
+		/**
+		 * Get the texture region of a handle.
+		 * This works for both images and icons. Images cover their whole texture.
+		 *
+		 * @param handle The image handle.
+		 * @return The region. This is empty if the image is not resident.
+		 */
+		std::optional<AtlasRegion> getTextureRegion(ImageHandle handle) const;
+
+		/**
+		 * Update the loader.
+		 * This makes the completed uploads resident, destroys released images and uploads the decoded images. This needs to
+		 * be called once every frame, before starting the new ImGui frame.
+		 */
+		void update();
+
+		/**
+		 * Check if the loader has uploads which are waiting or in flight.
+		 * Frames should keep going while this is true, so the images become resident without waiting for any input.
+		 *
+		 * @return Whether or not the loader is busy.
+		 */
+		bool isBusy() const;
+
+	private:
+		/**
+		 * Image state enum.
+		 */
+		enum class State : uint8_t
+		{
+			Free,
+			Decoding,
+			Uploading,
+			Resident,
+			Evicted,
+			Failed
+		};
+
+		/**
+		 * Image slot structure.
+		 */
+		struct Slot final
+		{
+			std::filesystem::path m_File = {};
+			std::unique_ptr<Image> m_Image = nullptr;
+			ImTextureID m_TextureID = nullptr;
+			AtlasHandle m_AtlasHandle = InvalidAtlasHandle;
+			uint32_t m_IconSize = 0;	// This is 0 for images which aren't icons.
+			uint32_t m_Generation = 0;
+			State m_State = State::Free;
+			mutable bool m_IsRequested = false;	// Whether or not an evicted icon was requested since the eviction.
+		};
+
+		/**
+		 * Decoded image structure.
+		 * The pixels are allocated by the decoder and are freed using the deleter.
+		 */
+		struct DecodedImage final
+		{
+			ImageHandle m_Handle = InvalidImageHandle;
+			std::unique_ptr<std::byte, void(*)(void*)> m_pPixels = { nullptr, nullptr };
+			uint32_t m_Width = 0;
+			uint32_t m_Height = 0;
+		};
+
+		/**
+		 * Upload batch structure.
+		 * All the images uploaded in a single frame are recorded to one command buffer.
+		 */
+		struct UploadBatch final
+		{
+			std::vector<ImageHandle> m_Handles = {};
+			std::vector<std::unique_ptr<Buffer>> m_DedicatedBuffers = {};	// Used by images which don't fit in the staging ring.
+			std::vector<std::unique_ptr<Image>> m_ReleasedImages = {};	// Images which were released while being uploaded.
+
+			VkCommandBuffer m_CommandBuffer = VK_NULL_HANDLE;
+			VkFence m_Fence = VK_NULL_HANDLE;
+
+			uint64_t m_RingHead = 0;	// The ring head after this batch's allocations.
+			uint64_t m_RingSize = 0;	// The number of ring bytes used by this batch.
+
+			bool m_IsPending = false;
+		};
+
+		/**
+		 * Retired image structure.
+		 */
+		struct RetiredImage final
+		{
+			std::unique_ptr<Image> m_Image = nullptr;
+			ImTextureID m_TextureID = nullptr;
+			uint64_t m_DestroyFrame = 0;
+		};
+
+		/**
+		 * Get the slot of a handle.
+		 *
+		 * @param handle The image handle.
+		 * @return The slot pointer. This is nullptr if the handle is invalid or stale.
+		 */
+		Slot* getSlot(ImageHandle handle);
+
+		/**
+		 * Get the slot of a handle.
+		 *
+		 * @param handle The image handle.
+		 * @return The slot pointer. This is nullptr if the handle is invalid or stale.
+		 */
+		const Slot* getSlot(ImageHandle handle) const;
+
+		/**
+		 * Acquire a slot and start decoding a file.
+		 *
+		 * @param file The image file.
+		 * @param iconSize The icon size. This is 0 for images which aren't icons.
+		 * @return The image handle.
+		 */
+		ImageHandle acquire(std::filesystem::path file, uint32_t iconSize);
+
+		/**
+		 * Decode an image file on the shared worker threads.
+		 *
+		 * @param handle The image handle.
+		 * @param file The image file.
+		 * @param iconSize The size to downscale icons to. This is 0 for images which aren't icons.
+		 */
+		void submitDecode(ImageHandle handle, std::filesystem::path file, uint32_t iconSize);
+
+		/**
+		 * Decode an image file.
+		 * This runs on a worker thread.
+		 *
+		 * @param handle The image handle.
+		 * @param file The image file.
+		 * @param iconSize The size to downscale icons to. This is 0 for images which aren't icons.
+		 */
+		void decode(ImageHandle handle, const std::filesystem::path& file, uint32_t iconSize);
+
+		/**
+		 * Load the icons which were evicted from the atlas again, once they're requested.
+		 */
+		void reloadEvictedIcons();
+
+		/**
+		 * Make the images of the completed batches resident.
+		 */
+		void completeUploads();
+
+		/**
+		 * Record and submit the uploads of the decoded images.
+		 */
+		void submitUploads();
+
+		/**
+		 * Allocate memory from the staging ring.
+		 *
+		 * @param size The number of bytes to allocate.
+		 * @param batch The batch which uses the memory.
+		 * @return The offset of the allocation in the ring. This is the ring size if there is not enough space.
+		 */
+		uint64_t allocateStaging(uint64_t size, UploadBatch& batch);
+
+	private:
+		std::vector<Slot> m_Slots = {};
+		std::vector<uint32_t> m_FreeSlots = {};
+
+		std::vector<DecodedImage> m_DecodedImages = {};
+		std::vector<DecodedImage> m_WaitingImages = {};	// Decoded images which didn't fit in the staging ring.
+		std::mutex m_DecodedImageMutex;
+		std::condition_variable m_DecodeCondition;
+		uint32_t m_PendingDecodeCount = 0;
+		std::atomic_bool m_IsStopping = false;
+
+		std::vector<RetiredImage> m_RetiredImages = {};
+		std::vector<ImageHandle> m_EvictedIcons = {};
+		std::unordered_map<AtlasHandle, ImageHandle> m_AtlasHandles = {};
+		std::array<UploadBatch, 3> m_UploadBatches = {};
+
+		GraphicsEngine& m_Engine;
+		Window& m_Window;
+		TextureRegistry& m_TextureRegistry;
+		TextureAtlas& m_TextureAtlas;
+
+		std::unique_ptr<Buffer> m_StagingRing = nullptr;
+		std::byte* m_pStagingMemory = nullptr;
+		uint64_t m_RingHead = 0;
+		uint64_t m_RingTail = 0;
+		uint64_t m_RingSize = 0;
+
+		VkCommandPool m_CommandPool = VK_NULL_HANDLE;
+
+		uint64_t m_FrameNumber = 0;
+		uint32_t m_NextBatch = 0;
+	};
+}
@@ -0,0 +1,261 @@
+// Copyright (c) 2022 Dhiraj Wishal
+
+#include "LatencyMeter.hpp"
+#include "Utility.hpp"
+
+#include <spdlog/spdlog.h>
+
+#include <algorithm>
+
+namespace
+{
+	/**
+	 * The number of frames measured before the statistics are logged.
+	 */
+	constexpr uint32_t ReportInterval = 300;
+
+	/**
+	 * Get the milliseconds between two time points.
+	 *
+	 * @param start The start time.
+	 * @param end The end time.
+	 * @return The milliseconds.
+	 */
+	double GetMilliseconds(rapid::LatencyMeter::clock_type::time_point start, rapid::LatencyMeter::clock_type::time_point end)
+	{
+		return std::chrono::duration<double, std::milli>(end - start).count();
+	}
+
+	/**
+	 * Get the number of valid timestamp bits of the graphics queue.
+	 *
+	 * @param engine The graphics engine.
+	 * @return The valid bits, or 0 if the queue doesn't support timestamps.
+	 */
+	uint32_t GetTimestampValidBits(const rapid::GraphicsEngine& engine)
+	{
+		const auto graphicsFamily = engine.getQueue().getGraphicsFamily();
+		if (!graphicsFamily)
+			return 0;
+
+		uint32_t queueFamilyCount = 0;
+		vkGetPhysicalDeviceQueueFamilyProperties(engine.getPhysicalDevice(), &queueFamilyCount, nullptr);
+
+		std::vector<VkQueueFamilyProperties> queueFamilies(queueFamilyCount);
+		vkGetPhysicalDeviceQueueFamilyProperties(engine.getPhysicalDevice(), &queueFamilyCount, queueFamilies.data());
+
+		return *graphicsFamily < queueFamilyCount ? queueFamilies[*graphicsFamily].timestampValidBits : 0;
+	}
+
+	/**
+	 * Check if the device's timestamps can be calibrated against the CPU clock.
+	 *
+	 * @param engine The graphics engine.
+	 * @return Whether or not the device time domain can be calibrated.
+	 */
+	bool IsCalibrationSupported(const rapid::GraphicsEngine& engine)
+	{
+		if (!engine.isExtensionEnabled(VK_EXT_CALIBRATED_TIMESTAMPS_EXTENSION_NAME) || !vkGetPhysicalDeviceCalibrateableTimeDomainsEXT || !engine.getDeviceTable().vkGetCalibratedTimestampsEXT)
+			return false;
+
+		uint32_t timeDomainCount = 0;
+		if (vkGetPhysicalDeviceCalibrateableTimeDomainsEXT(engine.getPhysicalDevice(), &timeDomainCount, nullptr) != VK_SUCCESS)
+			return false;
+
+		std::vector<VkTimeDomainEXT> timeDomains(timeDomainCount);
+		if (vkGetPhysicalDeviceCalibrateableTimeDomainsEXT(engine.getPhysicalDevice(), &timeDomainCount, timeDomains.data()) != VK_SUCCESS)
+			return false;
+
+		return std::find(timeDomains.begin(), timeDomains.end(), VK_TIME_DOMAIN_DEVICE_EXT) != timeDomains.end();
+	}
+}
+
+namespace rapid
+{
+	LatencyMeter::LatencyMeter(GraphicsEngine& engine, uint32_t frameCount)
+		: m_Frames(frameCount), m_Engine(engine)
+	{
+		// The GPU time is only measured if the graphics queue supports timestamps.
+		const auto validBits = GetTimestampValidBits(m_Engine);
+		if (validBits == 0)
+		{
+			spdlog::warn("The graphics queue doesn't support timestamp queries. The GPU time will not be measured.");
+			return;
+		}
+
+		m_TimestampMask = validBits >= 64 ? ~uint64_t(0) : (uint64_t(1) << validBits) - 1;
+
+		// Every frame needs two queries, one before and one after its commands.
+		const VkQueryPoolCreateInfo createInfo = {
+			.sType = VK_STRUCTURE_TYPE_QUERY_POOL_CREATE_INFO,
+			.pNext = nullptr,
+			.flags = 0,
+			.queryType = VK_QUERY_TYPE_TIMESTAMP,
+			.queryCount = frameCount * 2,
+			.pipelineStatistics = 0
+		};
+
+		utility::ValidateResult(m_Engine.getDeviceTable().vkCreateQueryPool(m_Engine.getLogicalDevice(), &createInfo, nullptr, &m_QueryPool), "Failed to create the timestamp query pool!");
+
+		if (IsCalibrationSupported(m_Engine))
+			calibrate();
+
+		if (!m_IsCalibrated)
+			spdlog::warn("The device timestamps can't be calibrated. The input to GPU completion latency will not be measured.");
+	}
+
+	LatencyMeter::~LatencyMeter()
+	{
+		if (m_QueryPool != VK_NULL_HANDLE)
+			m_Engine.getDeviceTable().vkDestroyQueryPool(m_Engine.getLogicalDevice(), m_QueryPool, nullptr);
+	}
+
+	void LatencyMeter::beginFrame(VkCommandBuffer vCommandBuffer, uint32_t frameIndex, std::optional<clock_type::time_point> inputTime, bool isMeasured)
+	{
+		// The frame's fence was waited on, so the last frame which used the index is done.
+		auto& record = m_Frames[frameIndex];
+		if (record.m_IsMeasured)
+			readResults(record, frameIndex);
+
+		record = FrameRecord();
+		m_FrameIndex = frameIndex;
+		m_pFrame = nullptr;
+
+		if (!isMeasured)
+			return;
+
+		record.m_InputTime = inputTime;
+		record.m_IsMeasured = true;
+		m_pFrame = &record;
+
+		if (m_QueryPool == VK_NULL_HANDLE)
+			return;
+
+		m_Engine.getDeviceTable().vkCmdResetQueryPool(vCommandBuffer, m_QueryPool, m_FrameIndex * 2, 2);
+		m_Engine.getDeviceTable().vkCmdWriteTimestamp(vCommandBuffer, VK_PIPELINE_STAGE_TOP_OF_PIPE_BIT, m_QueryPool, m_FrameIndex * 2);
+	}
+
+	void LatencyMeter::endFrame(VkCommandBuffer vCommandBuffer)
+	{
+		if (m_pFrame && m_QueryPool != VK_NULL_HANDLE)
+			m_Engine.getDeviceTable().vkCmdWriteTimestamp(vCommandBuffer, VK_PIPELINE_STAGE_BOTTOM_OF_PIPE_BIT, m_QueryPool, m_FrameIndex * 2 + 1);
+	}
+
+	void LatencyMeter::markSubmit()
+	{
+		if (m_pFrame)
+			m_pFrame->m_SubmitTime = clock_type::now();
+	}
+
+	void LatencyMeter::markPresent()
+	{
+		if (!m_pFrame)
+			return;
+
+		m_pFrame->m_PresentTime = clock_type::now();
+		m_pFrame->m_IsPresented = true;
+	}
+
+	void LatencyMeter::readResults(const FrameRecord& record, uint32_t frameIndex)
+	{
+		if (m_QueryPool != VK_NULL_HANDLE)
+		{
+			// The results are not waited on. If they're not ready yet, the GPU times of the frame are dropped.
+			uint64_t timestamps[2] = {};
+			const auto result = m_Engine.getDeviceTable().vkGetQueryPoolResults(m_Engine.getLogicalDevice(), m_QueryPool, frameIndex * 2, 2, sizeof(timestamps), timestamps, sizeof(uint64_t), VK_QUERY_RESULT_64_BIT);
+			if (result == VK_SUCCESS)
+			{
+				// The timestamp period is the number of nanoseconds per tick.
+				const auto timestampPeriod = static_cast<double>(m_Engine.getPhysicalDeviceProperties().limits.timestampPeriod);
+				const auto ticks = std::max(getTicks(timestamps[0], timestamps[1]), int64_t(0));
+				m_GpuTime.add(static_cast<double>(ticks) * timestampPeriod / 1000000.0);
+
+				if (record.m_InputTime && m_IsCalibrated)
+				{
+					const auto nanoseconds = static_cast<double>(getTicks(m_CalibrationTimestamp, timestamps[1])) * timestampPeriod;
+					const auto completeTime = m_CalibrationTime + std::chrono::duration_cast<clock_type::duration>(std::chrono::duration<double, std::nano>(nanoseconds));
+					m_InputToComplete.add(GetMilliseconds(*record.m_InputTime, completeTime));
+				}
+			}
+		}
+
+		if (record.m_InputTime)
+		{
+			m_InputToSubmit.add(GetMilliseconds(*record.m_InputTime, record.m_SubmitTime));
+
+			if (record.m_IsPresented)
+				m_InputToPresent.add(GetMilliseconds(*record.m_InputTime, record.m_PresentTime));
+		}
+
+		if (++m_MeasuredFrames == ReportInterval)
+			report();
+	}
+
+	int64_t LatencyMeter::getTicks(uint64_t from, uint64_t to) const
+	{
+		// Differences past half the range are taken as the second timestamp being the earlier one.
+		const auto ticks = (to - from) & m_TimestampMask;
+		if (ticks > m_TimestampMask / 2)
+			return -static_cast<int64_t>((from - to) & m_TimestampMask);
+
+		return static_cast<int64_t>(ticks);
+	}
+
+	void LatencyMeter::calibrate()
+	{
+		const VkCalibratedTimestampInfoEXT timestampInfo = {
+			.sType = VK_STRUCTURE_TYPE_CALIBRATED_TIMESTAMP_INFO_EXT,
+			.pNext = nullptr,
+			.timeDomain = VK_TIME_DOMAIN_DEVICE_EXT
+		};
+
+		// The CPU clock is read on both sides of the device timestamp, and the timestamp is paired with the middle.
+		uint64_t timestamp = 0;
+		uint64_t maxDeviation = 0;
+		const auto before = clock_type::now();
+		const auto result = m_Engine.getDeviceTable().vkGetCalibratedTimestampsEXT(m_Engine.getLogicalDevice(), 1, &timestampInfo, &timestamp, &maxDeviation);
+		const auto after = clock_type::now();
+
+		m_IsCalibrated = result == VK_SUCCESS;
+		if (!m_IsCalibrated)
+			return;
+
+		m_CalibrationTimestamp = timestamp & m_TimestampMask;
+		m_CalibrationTime = before + (after - before) / 2;
+	}
+
+	void LatencyMeter::report()
+	{
+		spdlog::info("Latency: {} frames, {} with input.", m_MeasuredFrames, m_InputToSubmit.m_Count);
+
+		if (m_InputToSubmit.m_Count > 0)
+		{
+			spdlog::info("Latency: Input to submit {:.3f} ms average, {:.3f} ms max.", m_InputToSubmit.average(), m_InputToSubmit.m_Max);
+
+			if (m_InputToComplete.m_Count > 0)
+				spdlog::info("Latency: Input to GPU completion {:.3f} ms average, {:.3f} ms max.", m_InputToComplete.average(), m_InputToComplete.m_Max);
+
+			if (m_InputToPresent.m_Count > 0)
+				spdlog::info("Latency: Input to present {:.3f} ms average, {:.3f} ms max.", m_InputToPresent.average(), m_InputToPresent.m_Max);
+		}
+
+		if (m_GpuTime.m_Count > 0)
+			spdlog::info("Latency: GPU time {:.3f} ms average, {:.3f} ms max.", m_GpuTime.average(), m_GpuTime.m_Max);
+
+		m_InputToSubmit = {};
+		m_InputToComplete = {};
+		m_InputToPresent = {};
+		m_GpuTime = {};
+		m_MeasuredFrames = 0;
+
+		if (m_IsCalibrated)
+			calibrate();
+	}
+
+	void LatencyMeter::Statistic::add(double milliseconds)
+	{
+		m_Total += milliseconds;
+		m_Max = std::max(m_Max, milliseconds);
+		m_Count++;
+	}
+}
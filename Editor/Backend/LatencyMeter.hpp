@@ -0,0 +1,169 @@
+// Copyright (c) 2022 Dhiraj Wishal
+
+#pragma once
+
+#include "GraphicsEngine.hpp"
+
+#include <chrono>
+#include <optional>
+#include <vector>
+
+namespace rapid
+{
+	/**
+	 * Latency meter class.
+	 * This measures how long input takes to reach the screen. Each frame is timestamped when its earliest input event was
+	 * generated, when its commands were submitted, when the GPU finished them and when it was presented. The GPU's own
+	 * time is measured using timestamp queries around the frame's commands.
+	 *
+	 * Nothing is waited on. A frame's queries are read when its frame index comes around again, which is after the frame's
+	 * fence is signaled, and the frame is dropped if they're not ready. The GPU completion time is the frame's last
+	 * timestamp converted to the CPU clock, which needs VK_EXT_calibrated_timestamps. Without it, only the GPU time is
+	 * measured on the GPU.
+	 *
+	 * The averages and the maximums are logged every few hundred frames. Frames without input only count towards the GPU
+	 * time. The meter is used by the render thread only.
+	 */
+	class LatencyMeter final
+	{
+	public:
+		using clock_type = std::chrono::steady_clock;
+
+		/**
+		 * Explicit constructor.
+		 *
+		 * @param engine The graphics engine.
+		 * @param frameCount The number of frames in flight.
+		 */
+		explicit LatencyMeter(GraphicsEngine& engine, uint32_t frameCount);
+
+		/**
+		 * Destructor.
+		 */
+		~LatencyMeter();
+
+		LatencyMeter(const LatencyMeter&) = delete;
+		LatencyMeter& operator=(const LatencyMeter&) = delete;
+
+		/**
+		 * Begin a frame.
+		 * This needs to be called for every frame, right after beginning the frame's command buffer, as it also reads the
+		 * results of the last frame which used the frame index. The frame's fence needs to be waited on before this.
+		 *
+		 * @param vCommandBuffer The frame's command buffer.
+		 * @param frameIndex The frame index.
+		 * @param inputTime The time the earliest input event of the frame was generated, if the frame has any.
+		 * @param isMeasured Whether or not the frame is measured.
+		 */
+		void beginFrame(VkCommandBuffer vCommandBuffer, uint32_t frameIndex, std::optional<clock_type::time_point> inputTime, bool isMeasured);
+
+		/**
+		 * End measuring a frame's commands.
+		 * This needs to be called right before ending the frame's command buffer.
+		 *
+		 * @param vCommandBuffer The frame's command buffer.
+		 */
+		void endFrame(VkCommandBuffer vCommandBuffer);
+
+		/**
+		 * Mark the frame as submitted.
+		 */
+		void markSubmit();
+
+		/**
+		 * Mark the frame as presented.
+		 */
+		void markPresent();
+
+	private:
+		/**
+		 * Frame record structure.
+		 * This holds the times of a frame till its queries are read.
+		 */
+		struct FrameRecord final
+		{
+			std::optional<clock_type::time_point> m_InputTime = std::nullopt;
+			clock_type::time_point m_SubmitTime = {};
+			clock_type::time_point m_PresentTime = {};
+
+			bool m_IsMeasured = false;
+			bool m_IsPresented = false;
+		};
+
+		/**
+		 * Read the results of a frame and add them to the statistics.
+		 *
+		 * @param record The frame's record.
+		 * @param frameIndex The frame index.
+		 */
+		void readResults(const FrameRecord& record, uint32_t frameIndex);
+
+		/**
+		 * Get the ticks from one timestamp to another.
+		 * Only the valid bits of the timestamps are used, so the difference is right even if the counter wrapped around.
+		 *
+		 * @param from The first timestamp.
+		 * @param to The second timestamp.
+		 * @return The ticks. This is negative if the second timestamp is the earlier one.
+		 */
+		int64_t getTicks(uint64_t from, uint64_t to) const;
+
+		/**
+		 * Pair a device timestamp with the CPU clock.
+		 * The clocks drift apart, so this is done every time the statistics are logged.
+		 */
+		void calibrate();
+
+		/**
+		 * Log the measurements and reset them.
+		 */
+		void report();
+
+	private:
+		/**
+		 * Latency statistic structure.
+		 * The values are in milliseconds.
+		 */
+		struct Statistic final
+		{
+			double m_Total = 0.0;
+			double m_Max = 0.0;
+			uint32_t m_Count = 0;
+
+			/**
+			 * Add a sample.
+			 *
+			 * @param milliseconds The sample.
+			 */
+			void add(double milliseconds);
+
+			/**
+			 * Get the average.
+			 *
+			 * @return The average of the samples, or 0 if there are none.
+			 */
+			double average() const { return m_Count > 0 ? m_Total / m_Count : 0.0; }
+		};
+
+	private:
+		Statistic m_InputToSubmit;
+		Statistic m_InputToComplete;
+		Statistic m_InputToPresent;
+		Statistic m_GpuTime;
+
+		std::vector<FrameRecord> m_Frames;
+
+		GraphicsEngine& m_Engine;
+
+		VkQueryPool m_QueryPool = VK_NULL_HANDLE;
+
+		FrameRecord* m_pFrame = nullptr;
+		uint32_t m_FrameIndex = 0;
+		uint32_t m_MeasuredFrames = 0;
+
+		uint64_t m_TimestampMask = 0;
+		uint64_t m_CalibrationTimestamp = 0;
+		clock_type::time_point m_CalibrationTime = {};
+		bool m_IsCalibrated = false;
+	};
+}
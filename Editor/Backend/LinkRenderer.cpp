@@ -0,0 +1,141 @@
+// Copyright (c) 2022 Dhiraj Wishal
+
+#include "LinkRenderer.hpp"
+
+#include "Core/StreamingCopy.hpp"
+#include "Core/LinkSegments.hpp"
+#include "Core/Hash.hpp"
+
+#include <algorithm>
+#include <bit>
+#include <cmath>
+
+namespace
+{
+	/**
+	 * The smallest instance buffer size, in links.
+	 */
+	constexpr uint64_t MinimumInstanceCount = 256;
+
+	/**
+	 * Every segment is drawn as two triangles.
+	 */
+	constexpr uint32_t VerticesPerSegment = 6;
+
+	/**
+	 * Push constants structure.
+	 * This needs to match the push constants of the link shader.
+	 */
+	struct PushConstants final
+	{
+		ImVec2 m_Scale = {};
+		ImVec2 m_Translate = {};
+		float m_Thickness = 1.0f;
+		float m_SegmentCount = 1.0f;
+	};
+}
+
+namespace rapid
+{
+	LinkRenderer::LinkRenderer(GraphicsEngine& engine, Window& window)
+		: m_Engine(engine)
+	{
+		// The color is stored as a packed 32 bit value, like ImGui's vertex colors.
+		auto vertexShader = ShaderCode("Shaders/link_vert.spv", VkShaderStageFlagBits::VK_SHADER_STAGE_VERTEX_BIT);
+		vertexShader.m_InputAttributes[1].m_Size = 4;
+
+		m_Pipeline = std::make_unique<GraphicsPipeline>(m_Engine, window, "LinkPipelineCache.bin",
+			vertexShader,
+			ShaderCode("Shaders/link_frag.spv", VkShaderStageFlagBits::VK_SHADER_STAGE_FRAGMENT_BIT),
+			VK_VERTEX_INPUT_RATE_INSTANCE);
+
+		m_InstanceSlots.resize(window.frameCount());
+		for (auto& slot : m_InstanceSlots)
+			slot.m_pBuffer = std::make_unique<Buffer>(m_Engine, MinimumInstanceCount * sizeof(LinkInstance), BufferType::ShallowVertex);
+	}
+
+	LinkRenderer::~LinkRenderer()
+	{
+		for (const auto& slot : m_InstanceSlots)
+			slot.m_pBuffer->terminate();
+
+		m_Pipeline->terminate();
+	}
+
+	void LinkRenderer::addLink(const ImVec2& start, const ImVec2& end, ImU32 color)
+	{
+		m_Links.emplace_back(LinkInstance{ .m_Points = { start.x, start.y, end.x, end.y }, .m_Color = color });
+	}
+
+	void LinkRenderer::upload(float thickness, float segmentsPerLength)
+	{
+		// Every link uses the same number of segments, so the longest one decides how smooth the curves are.
+		float longestLength = 0.0f;
+		for (const auto& link : m_Links)
+			longestLength = std::max(longestLength, std::hypot(link.m_Points[2] - link.m_Points[0], link.m_Points[3] - link.m_Points[1]));
+
+		const auto segmentCount = GetLinkSegmentCount(longestLength, segmentsPerLength);
+
+		uint64_t version = HashBytes(m_Links.data(), m_Links.size() * sizeof(LinkInstance));
+		version = HashValue(thickness, version);
+		version = HashValue(segmentCount, version);
+
+		m_Version = version;
+		m_Thickness = thickness;
+		m_SegmentCount = segmentCount;
+	}
+
+	void LinkRenderer::swapFrame(uint32_t frameIndex)
+	{
+		m_FrameOrigin = m_Origin;
+		m_FrameThickness = m_Thickness;
+		m_FrameSegmentCount = m_SegmentCount;
+
+		if (m_FrameVersion != m_Version)
+		{
+			m_FrameLinks = m_Links;
+			m_FrameVersion = m_Version;
+		}
+
+		m_InstanceCount = static_cast<uint32_t>(m_FrameLinks.size());
+		if (m_FrameLinks.empty())
+			return;
+
+		// The frame's previous submission is done, so its buffer can be written to (or replaced) right away. It's only
+		// written if it holds an older version of the links.
+		auto& slot = m_InstanceSlots[frameIndex];
+		if (slot.m_Version != m_FrameVersion)
+		{
+			const auto size = m_FrameLinks.size() * sizeof(LinkInstance);
+			if (slot.m_pBuffer->size() < size)
+			{
+				slot.m_pBuffer->terminate();
+				slot.m_pBuffer = std::make_unique<Buffer>(m_Engine, std::bit_ceil(size), BufferType::ShallowVertex);
+			}
+
+			StreamingCopy(slot.m_pBuffer->mapMemory(), m_FrameLinks.data(), size);
+			slot.m_pBuffer->unmapMemory();
+			slot.m_Version = m_FrameVersion;
+		}
+
+		m_pInstanceBuffer = slot.m_pBuffer.get();
+	}
+
+	void LinkRenderer::draw(CommandBuffer commandBuffer, const ImVec2& scale, const ImVec2& translate)
+	{
+		if (m_InstanceCount == 0)
+			return;
+
+		const PushConstants pushConstants = {
+			.m_Scale = scale,
+			.m_Translate = ImVec2(translate.x + m_FrameOrigin.x * scale.x, translate.y + m_FrameOrigin.y * scale.y),
+			.m_Thickness = m_FrameThickness,
+			.m_SegmentCount = static_cast<float>(m_FrameSegmentCount)
+		};
+
+		commandBuffer.bindPipeline(*m_Pipeline);
+		commandBuffer.bindVertexBuffer(*m_pInstanceBuffer);
+		commandBuffer.bindPushConstant(*m_Pipeline, &pushConstants, sizeof(PushConstants), VkShaderStageFlagBits::VK_SHADER_STAGE_VERTEX_BIT);
+		commandBuffer.drawVertices(m_FrameSegmentCount * VerticesPerSegment, m_InstanceCount);
+	}
+}
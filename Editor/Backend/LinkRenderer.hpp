@@ -0,0 +1,158 @@
+// Copyright (c) 2022 Dhiraj Wishal
+
+#pragma once
+
+#include "DrawCallback.hpp"
+#include "GraphicsPipeline.hpp"
+#include "Buffer.hpp"
+
+#include <array>
+
+namespace rapid
+{
+	/**
+	 * Link renderer class.
+	 * This draws node editor links (cubic bezier curves) in a single instanced draw call. Every link is a single instance
+	 * with its two endpoints and color, and the vertex shader evaluates the curve and extrudes it, so the CPU only needs
+	 * to write 20 bytes per link instead of tessellating it.
+	 *
+	 * The curves use the same control points as ImNodes, going out of the start point to the right and into the end point
+	 * from the left. The edges are anti-aliased analytically in the fragment shader.
+	 */
+	class LinkRenderer final : public DrawCallback
+	{
+		/**
+		 * Link instance structure.
+		 * This needs to match the vertex inputs of the link shader.
+		 */
+		struct LinkInstance final
+		{
+			std::array<float, 4> m_Points = {};	// Start x, start y, end x, end y.
+			ImU32 m_Color = 0;
+		};
+
+		/**
+		 * Instance slot structure.
+		 * Every frame in flight uploads to its own buffer, so the links can change while the previous frames are rendered.
+		 */
+		struct InstanceSlot final
+		{
+			std::unique_ptr<Buffer> m_pBuffer = nullptr;
+			uint64_t m_Version = 0;
+		};
+
+	public:
+		/**
+		 * Explicit constructor.
+		 *
+		 * @param engine The graphics engine.
+		 * @param window The window the links are rendered to.
+		 */
+		explicit LinkRenderer(GraphicsEngine& engine, Window& window);
+
+		/**
+		 * Destructor.
+		 */
+		~LinkRenderer();
+
+		LinkRenderer(const LinkRenderer&) = delete;
+		LinkRenderer& operator=(const LinkRenderer&) = delete;
+
+		/**
+		 * Clear the links.
+		 * This needs to be called before adding the links of a new frame.
+		 */
+		void clear() { m_Links.clear(); }
+
+		/**
+		 * Add a link.
+		 *
+		 * @param start The start point relative to the origin. This is the output pin.
+		 * @param end The end point relative to the origin. This is the input pin.
+		 * @param color The link color.
+		 */
+		void addLink(const ImVec2& start, const ImVec2& end, ImU32 color);
+
+		/**
+		 * Set the origin of the links.
+		 * The links are stored relative to this, so panning only changes the origin and doesn't require a new upload.
+		 *
+		 * @param origin The origin in screen space.
+		 */
+		void setOrigin(const ImVec2& origin) { m_Origin = origin; }
+
+		/**
+		 * Upload the links.
+		 * This needs to be called after all the links are added, and before ImGui::Render(). The render thread uploads the
+		 * links once the frame is handed over, and only if they changed since the last frame.
+		 *
+		 * @param thickness The link thickness in pixels.
+		 * @param segmentsPerLength The number of curve segments per pixel of the longest link.
+		 */
+		void upload(float thickness, float segmentsPerLength);
+
+		/**
+		 * Draw the links.
+		 *
+		 * @param commandBuffer The command buffer to record to.
+		 * @param scale The scale which converts screen space coordinates to clip space.
+		 * @param translate The translation which converts screen space coordinates to clip space.
+		 */
+		void draw(CommandBuffer commandBuffer, const ImVec2& scale, const ImVec2& translate) override;
+
+		/**
+		 * Hand the uploaded links over to the render thread.
+		 * This needs to be called on the render thread while the UI thread waits.
+		 *
+		 * @param frameIndex The index of the frame which is going to be recorded.
+		 */
+		void swapFrame(uint32_t frameIndex);
+
+		/**
+		 * Get the version of the uploaded links.
+		 * This doesn't include the origin, since moving the links doesn't change how they look.
+		 *
+		 * @return The version.
+		 */
+		uint64_t getVersion() const override { return m_Version; }
+
+		/**
+		 * Get the version of the links the render thread draws.
+		 *
+		 * @return The version.
+		 */
+		uint64_t getFrameVersion() const override { return m_FrameVersion; }
+
+		/**
+		 * Recreate the pipeline.
+		 * This needs to be called when the window is resized.
+		 */
+		void recreate() { m_Pipeline->recreate(); }
+
+	private:
+		// Built on the UI thread.
+		std::vector<LinkInstance> m_Links = {};
+
+		ImVec2 m_Origin = {};
+
+		uint64_t m_Version = 0;
+		uint32_t m_SegmentCount = 1;
+		float m_Thickness = 1.0f;
+
+		// Drawn on the render thread.
+		std::vector<LinkInstance> m_FrameLinks = {};
+		std::vector<InstanceSlot> m_InstanceSlots = {};
+
+		std::unique_ptr<GraphicsPipeline> m_Pipeline = nullptr;
+		Buffer* m_pInstanceBuffer = nullptr;
+
+		GraphicsEngine& m_Engine;
+
+		ImVec2 m_FrameOrigin = {};
+
+		uint64_t m_FrameVersion = 0;
+		uint32_t m_InstanceCount = 0;
+		uint32_t m_FrameSegmentCount = 1;
+		float m_FrameThickness = 1.0f;
+	};
+}
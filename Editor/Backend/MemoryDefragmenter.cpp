@@ -0,0 +1,242 @@
+// Copyright (c) 2022 Dhiraj Wishal
+
+#include "MemoryDefragmenter.hpp"
+#include "Buffer.hpp"
+#include "Utility.hpp"
+
+#include <spdlog/spdlog.h>
+
+#include <algorithm>
+
+namespace
+{
+	/**
+	 * The number of frames between two fragmentation checks.
+	 * Calculating the statistics goes through every block, so it's not done every frame.
+	 */
+	constexpr uint32_t CheckInterval = 600;
+
+	/**
+	 * The unused bytes of the blocks need to be more than this to defragment.
+	 */
+	constexpr VkDeviceSize MinimumUnusedBytes = 16 * 1024 * 1024;
+
+	/**
+	 * The unused part of the blocks needs to be more than 1 / UnusedFraction of them to defragment.
+	 */
+	constexpr VkDeviceSize UnusedFraction = 4;
+
+	/**
+	 * The maximum number of bytes moved in a single pass.
+	 */
+	constexpr VkDeviceSize MaximumBytesPerPass = 8 * 1024 * 1024;
+
+	/**
+	 * The maximum number of allocations moved in a single pass.
+	 */
+	constexpr uint32_t MaximumAllocationsPerPass = 64;
+
+	/**
+	 * The maximum number of passes of a single run. The allocations which can't be moved could otherwise keep a run going.
+	 */
+	constexpr uint32_t MaximumPassCount = 256;
+}
+
+namespace rapid
+{
+	MemoryDefragmenter::MemoryDefragmenter(GraphicsEngine& engine, uint32_t frameCount)
+		: m_Engine(engine), m_FrameCount(std::max(frameCount, 1u))
+	{
+	}
+
+	MemoryDefragmenter::~MemoryDefragmenter()
+	{
+		// The device is idle by now, so the pending copies are done.
+		if (m_IsPassPending)
+			endPass();
+
+		if (m_Context)
+			vmaEndDefragmentation(m_Engine.getAllocator(), m_Context, nullptr);
+	}
+
+	void MemoryDefragmenter::update(VkCommandBuffer vCommandBuffer, uint32_t frameIndex)
+	{
+		// Only one pass is in flight at a time.
+		if (m_IsPassPending)
+			return;
+
+		if (m_Context)
+		{
+			beginPass(vCommandBuffer, frameIndex);
+			return;
+		}
+
+		if (m_IsRequested.exchange(false))
+		{
+			begin();
+			return;
+		}
+
+		if (++m_FramesSinceCheck < CheckInterval)
+			return;
+
+		m_FramesSinceCheck = 0;
+		if (isFragmented())
+			begin();
+	}
+
+	void MemoryDefragmenter::complete(uint32_t frameIndex)
+	{
+		if (m_IsPassPending && m_PassFrameIndex == frameIndex)
+			endPass();
+	}
+
+	void MemoryDefragmenter::flush()
+	{
+		if (m_IsPassPending)
+			endPass();
+
+		// The frame indexes start over from the next frame.
+		m_FirstFrame = m_Engine.getCurrentFrameIndex() + 1;
+	}
+
+	MemoryDefragmenter::Statistics MemoryDefragmenter::getStatistics() const
+	{
+		return Statistics{
+			.m_BytesMoved = m_BytesMoved,
+			.m_BytesFreed = m_BytesFreed,
+			.m_AllocationsMoved = m_AllocationsMoved,
+			.m_Runs = m_Runs
+		};
+	}
+
+	bool MemoryDefragmenter::isFragmented() const
+	{
+		VmaTotalStatistics statistics = {};
+		vmaCalculateStatistics(m_Engine.getAllocator(), &statistics);
+
+		const auto& total = statistics.total.statistics;
+		const auto unusedBytes = total.blockBytes - total.allocationBytes;
+		return unusedBytes > MinimumUnusedBytes && unusedBytes * UnusedFraction > total.blockBytes;
+	}
+
+	void MemoryDefragmenter::begin()
+	{
+		const VmaDefragmentationInfo defragmentationInfo = {
+			.flags = VMA_DEFRAGMENTATION_FLAG_ALGORITHM_BALANCED_BIT,
+			.pool = nullptr,
+			.maxBytesPerPass = MaximumBytesPerPass,
+			.maxAllocationsPerPass = MaximumAllocationsPerPass
+		};
+
+		const auto result = vmaBeginDefragmentation(m_Engine.getAllocator(), &defragmentationInfo, &m_Context);
+		if (result != VK_SUCCESS)
+		{
+			utility::ValidateResult(result, "Failed to begin the defragmentation!");
+			m_Context = nullptr;
+			return;
+		}
+
+		m_PassCount = 0;
+		m_IsDefragmenting = true;
+		spdlog::info("Defragmenting the device memory.");
+	}
+
+	void MemoryDefragmenter::beginPass(VkCommandBuffer vCommandBuffer, uint32_t frameIndex)
+	{
+		m_PassInfo = {};
+		const auto result = vmaBeginDefragmentationPass(m_Engine.getAllocator(), m_Context, &m_PassInfo);
+
+		// Success means that there's nothing left to move.
+		if (result != VK_INCOMPLETE)
+		{
+			if (result != VK_SUCCESS)
+				utility::ValidateResult(result, "Failed to begin the defragmentation pass!");
+
+			end();
+			return;
+		}
+
+		for (uint32_t i = 0; i < m_PassInfo.moveCount; i++)
+		{
+			auto& move = m_PassInfo.pMoves[i];
+
+			const auto pBuffer = getMovableBuffer(move.srcAllocation);
+			if (pBuffer == nullptr)
+			{
+				move.operation = VMA_DEFRAGMENTATION_MOVE_OPERATION_IGNORE;
+				continue;
+			}
+
+			// The old buffers might still be used by the frames in flight, and the copies are done with the frame.
+			m_OldBuffers.emplace_back(pBuffer->move(move, vCommandBuffer));
+		}
+
+		m_IsPassPending = true;
+		m_PassFrameIndex = frameIndex;
+
+		// Nothing was copied, so there's nothing to wait for.
+		if (m_OldBuffers.empty())
+			endPass();
+	}
+
+	void MemoryDefragmenter::endPass()
+	{
+		const auto allocator = m_Engine.getAllocator();
+
+		for (const auto vBuffer : m_OldBuffers)
+			m_Engine.getDeviceTable().vkDestroyBuffer(m_Engine.getLogicalDevice(), vBuffer, nullptr);
+
+		m_OldBuffers.clear();
+
+		// The buffers which were terminated meanwhile marked their moves to be destroyed.
+		for (uint32_t i = 0; i < m_PassInfo.moveCount; i++)
+		{
+			const auto& move = m_PassInfo.pMoves[i];
+			if (move.operation != VMA_DEFRAGMENTATION_MOVE_OPERATION_COPY)
+				continue;
+
+			VmaAllocationInfo allocationInfo = {};
+			vmaGetAllocationInfo(allocator, move.srcAllocation, &allocationInfo);
+			static_cast<Buffer*>(allocationInfo.pUserData)->completeMove();
+		}
+
+		m_IsPassPending = false;
+		if (vmaEndDefragmentationPass(allocator, m_Context, &m_PassInfo) == VK_SUCCESS || ++m_PassCount == MaximumPassCount)
+			end();
+	}
+
+	Buffer* MemoryDefragmenter::getMovableBuffer(VmaAllocation allocation) const
+	{
+		// Only the buffers set their user data, so the images and the transient memory are skipped here.
+		VmaAllocationInfo allocationInfo = {};
+		vmaGetAllocationInfo(m_Engine.getAllocator(), allocation, &allocationInfo);
+
+		const auto pBuffer = static_cast<Buffer*>(allocationInfo.pUserData);
+		if (pBuffer == nullptr || !pBuffer->isMovable())
+			return nullptr;
+
+		// The frame indexes advance with the frames, so a buffer written by a frame with the current frame index isn't
+		// written again till the current frame is done. The others could be written by the next frames.
+		const auto lastMappedFrame = pBuffer->getLastMappedFrame();
+		if (lastMappedFrame < m_FirstFrame || (m_Engine.getCurrentFrameIndex() - lastMappedFrame) % m_FrameCount != 0)
+			return nullptr;
+
+		return pBuffer;
+	}
+
+	void MemoryDefragmenter::end()
+	{
+		VmaDefragmentationStats statistics = {};
+		vmaEndDefragmentation(m_Engine.getAllocator(), m_Context, &statistics);
+		m_Context = nullptr;
+
+		m_BytesMoved += statistics.bytesMoved;
+		m_BytesFreed += statistics.bytesFreed;
+		m_AllocationsMoved += statistics.allocationsMoved;
+		m_Runs++;
+
+		m_IsDefragmenting = false;
+		spdlog::info("Defragmented the device memory. {} allocations ({} bytes) were moved and {} bytes were freed.", statistics.allocationsMoved, statistics.bytesMoved, statistics.bytesFreed);
+	}
+}
@@ -0,0 +1,171 @@
+// Copyright (c) 2022 Dhiraj Wishal
+
+#pragma once
+
+#include "GraphicsEngine.hpp"
+
+#include <atomic>
+#include <vector>
+
+namespace rapid
+{
+	class Buffer;
+
+	/**
+	 * Memory defragmenter class.
+	 * Long sessions keep creating and destroying buffers and images, which leaves gaps in the allocator's memory blocks.
+	 * This checks the allocator every few hundred frames, and once the unused part of the blocks gets too large, moves the
+	 * allocations together a few at a time, so a frame never stalls for long. Emptied blocks are returned to the device.
+	 *
+	 * Nothing is waited on. The copies of a pass are recorded to the frame's command buffer, and the old buffers are
+	 * destroyed and the pass is ended once that frame's fence is signaled. The next pass starts after that.
+	 *
+	 * Only the vertex and index buffers are moved. The other allocations are either mapped or referenced by descriptors,
+	 * so they are left where they are. Those buffers belong to a frame index and are only written by the frames of that
+	 * index, so only the ones last written by a frame with the current frame index are moved. They're not written again
+	 * till the pass ends.
+	 *
+	 * The defragmenter is used by the render thread. The UI thread can keep building the next frame meanwhile.
+	 */
+	class MemoryDefragmenter final
+	{
+	public:
+		/**
+		 * Statistics structure.
+		 * These are totals since the defragmenter was created.
+		 */
+		struct Statistics final
+		{
+			uint64_t m_BytesMoved = 0;
+			uint64_t m_BytesFreed = 0;
+			uint64_t m_AllocationsMoved = 0;
+			uint64_t m_Runs = 0;
+		};
+
+	public:
+		/**
+		 * Explicit constructor.
+		 *
+		 * @param engine The graphics engine.
+		 * @param frameCount The number of frames in flight.
+		 */
+		explicit MemoryDefragmenter(GraphicsEngine& engine, uint32_t frameCount);
+
+		/**
+		 * Destructor.
+		 */
+		~MemoryDefragmenter();
+
+		MemoryDefragmenter(const MemoryDefragmenter&) = delete;
+		MemoryDefragmenter& operator=(const MemoryDefragmenter&) = delete;
+
+		/**
+		 * Update the defragmenter.
+		 * This needs to be called once every frame, before ending the frame's command buffer and after every buffer of the
+		 * frame is written.
+		 *
+		 * @param vCommandBuffer The frame's command buffer.
+		 * @param frameIndex The frame index.
+		 */
+		void update(VkCommandBuffer vCommandBuffer, uint32_t frameIndex);
+
+		/**
+		 * Complete the pass recorded by a frame.
+		 * This needs to be called once the frame's fence is signaled, before any buffer of the frame is written.
+		 *
+		 * @param frameIndex The frame index.
+		 */
+		void complete(uint32_t frameIndex);
+
+		/**
+		 * Complete the pending pass and forget which frames the buffers were written in.
+		 * This needs to be called when the device is idle, before the frame indexes are reset.
+		 */
+		void flush();
+
+		/**
+		 * Request a defragmentation, even if the memory isn't fragmented enough.
+		 * It starts on the next update.
+		 */
+		void request() { m_IsRequested = true; }
+
+		/**
+		 * Check if the defragmentation is running.
+		 *
+		 * @return Whether or not the allocations are being moved.
+		 */
+		bool isDefragmenting() const { return m_IsDefragmenting; }
+
+		/**
+		 * Get the statistics.
+		 *
+		 * @return The statistics.
+		 */
+		Statistics getStatistics() const;
+
+	private:
+		/**
+		 * Check if the memory is fragmented enough to defragment.
+		 *
+		 * @return Whether or not the memory should be defragmented.
+		 */
+		bool isFragmented() const;
+
+		/**
+		 * Begin defragmenting.
+		 */
+		void begin();
+
+		/**
+		 * Begin a single defragmentation pass.
+		 *
+		 * @param vCommandBuffer The command buffer to record the copies to.
+		 * @param frameIndex The frame index.
+		 */
+		void beginPass(VkCommandBuffer vCommandBuffer, uint32_t frameIndex);
+
+		/**
+		 * End the pending pass.
+		 * The copies need to be done before this.
+		 */
+		void endPass();
+
+		/**
+		 * Check if a buffer can be moved in the current frame.
+		 *
+		 * @param allocation The buffer's allocation.
+		 * @return The buffer pointer, or nullptr if it can't be moved.
+		 */
+		Buffer* getMovableBuffer(VmaAllocation allocation) const;
+
+		/**
+		 * End defragmenting and collect the statistics.
+		 */
+		void end();
+
+	private:
+		GraphicsEngine& m_Engine;
+
+		VmaDefragmentationContext m_Context = nullptr;
+		VmaDefragmentationPassMoveInfo m_PassInfo = {};
+
+		std::vector<VkBuffer> m_OldBuffers;
+
+		std::atomic<uint64_t> m_BytesMoved = 0;
+		std::atomic<uint64_t> m_BytesFreed = 0;
+		std::atomic<uint64_t> m_AllocationsMoved = 0;
+		std::atomic<uint64_t> m_Runs = 0;
+
+		uint32_t m_FramesSinceCheck = 0;
+		uint32_t m_PassCount = 0;
+		uint32_t m_PassFrameIndex = 0;
+		uint32_t m_FirstFrame = 1;	// The first frame whose frame index is known.
+
+		const uint32_t m_FrameCount;
+
+		bool m_IsPassPending = false;
+
+		std::atomic_bool m_IsRequested = false;
+		std::atomic_bool m_IsDefragmenting = false;
+	};
+}
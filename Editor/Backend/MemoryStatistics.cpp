@@ -0,0 +1,47 @@
+// Copyright (c) 2022 Dhiraj Wishal
+
+#include "MemoryStatistics.hpp"
+
+namespace rapid
+{
+	std::string_view GetMemoryCategoryName(MemoryCategory category)
+	{
+		switch (category)
+		{
+		case MemoryCategory::VertexBuffer:			return "Vertex buffers";
+		case MemoryCategory::IndexBuffer:			return "Index buffers";
+		case MemoryCategory::ShallowVertexBuffer:	return "Shallow vertex buffers";
+		case MemoryCategory::ShallowIndexBuffer:	return "Shallow index buffers";
+		case MemoryCategory::UniformBuffer:			return "Uniform buffers";
+		case MemoryCategory::StagingBuffer:			return "Staging buffers";
+		case MemoryCategory::ReadbackBuffer:		return "Readback buffers";
+		case MemoryCategory::Image:					return "Images";
+		case MemoryCategory::TransientImage:		return "Transient images";
+		case MemoryCategory::Pipeline:				return "Pipelines";
+		default:									return "Unknown";
+		}
+	}
+
+	void MemoryStatistics::add(MemoryCategory category, uint64_t bytes)
+	{
+		const auto index = static_cast<size_t>(category);
+		m_Counts[index].fetch_add(1, std::memory_order_relaxed);
+		m_Bytes[index].fetch_add(bytes, std::memory_order_relaxed);
+	}
+
+	void MemoryStatistics::remove(MemoryCategory category, uint64_t bytes)
+	{
+		const auto index = static_cast<size_t>(category);
+		m_Counts[index].fetch_sub(1, std::memory_order_relaxed);
+		m_Bytes[index].fetch_sub(bytes, std::memory_order_relaxed);
+	}
+
+	MemoryStatistics::Usage MemoryStatistics::getUsage(MemoryCategory category) const
+	{
+		const auto index = static_cast<size_t>(category);
+		return Usage{
+			.m_Count = m_Counts[index].load(std::memory_order_relaxed),
+			.m_Bytes = m_Bytes[index].load(std::memory_order_relaxed)
+		};
+	}
+}
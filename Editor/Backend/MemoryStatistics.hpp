@@ -0,0 +1,98 @@
+// Copyright (c) 2022 Dhiraj Wishal
+
+#pragma once
+
+#include <array>
+#include <atomic>
+#include <cstdint>
+#include <string_view>
+
+namespace rapid
+{
+	/**
+	 * Memory category enum.
+	 * The buffer categories follow the buffer types.
+	 */
+	enum class MemoryCategory : uint8_t
+	{
+		VertexBuffer,
+		IndexBuffer,
+		ShallowVertexBuffer,
+		ShallowIndexBuffer,
+		UniformBuffer,
+		StagingBuffer,
+		ReadbackBuffer,
+		Image,
+		TransientImage,
+		Pipeline,
+
+		Count
+	};
+
+	/**
+	 * Get the name of a memory category.
+	 *
+	 * @param category The category.
+	 * @return The name.
+	 */
+	std::string_view GetMemoryCategoryName(MemoryCategory category);
+
+	/**
+	 * Memory statistics class.
+	 * This counts the objects and the device memory bytes of each category. The counters are updated by the objects as
+	 * they're created and destroyed, from any thread.
+	 *
+	 * Pipelines are only counted, as the driver owns their memory.
+	 */
+	class MemoryStatistics final
+	{
+	public:
+		/**
+		 * Category usage structure.
+		 */
+		struct Usage final
+		{
+			uint64_t m_Count = 0;
+			uint64_t m_Bytes = 0;
+		};
+
+	public:
+		/**
+		 * Default constructor.
+		 */
+		MemoryStatistics() = default;
+
+		MemoryStatistics(const MemoryStatistics&) = delete;
+		MemoryStatistics& operator=(const MemoryStatistics&) = delete;
+
+		/**
+		 * Add an object to a category.
+		 *
+		 * @param category The category.
+		 * @param bytes The number of bytes the object uses. Default is 0.
+		 */
+		void add(MemoryCategory category, uint64_t bytes = 0);
+
+		/**
+		 * Remove an object from a category.
+		 *
+		 * @param category The category.
+		 * @param bytes The number of bytes the object used. This needs to be what it was added with. Default is 0.
+		 */
+		void remove(MemoryCategory category, uint64_t bytes = 0);
+
+		/**
+		 * Get the usage of a category.
+		 *
+		 * @param category The category.
+		 * @return The usage.
+		 */
+		Usage getUsage(MemoryCategory category) const;
+
+	private:
+		static constexpr auto CategoryCount = static_cast<size_t>(MemoryCategory::Count);
+
+		std::array<std::atomic<uint64_t>, CategoryCount> m_Counts = {};
+		std::array<std::atomic<uint64_t>, CategoryCount> m_Bytes = {};
+	};
+}
@@ -0,0 +1,47 @@
+// Copyright (c) 2022 Dhiraj Wishal
+
+#include "NullWindow.hpp"
+#include "ImGuiNode.hpp"
+
+namespace rapid
+{
+	NullWindow::NullWindow(ImVec2 size, float deltaTime)
+		: m_Size(size), m_DeltaTime(deltaTime)
+	{
+		m_OwnsContext = InitializeImGui();
+
+		// The font atlas needs to be built before the first frame. The pixels are never uploaded.
+		auto& imGuiIO = ImGui::GetIO();
+		if (!imGuiIO.Fonts->IsBuilt())
+			imGuiIO.Fonts->Build();
+
+		// There is no platform backend to create the other viewports.
+		imGuiIO.ConfigFlags &= ~ImGuiConfigFlags_ViewportsEnable;
+	}
+
+	NullWindow::~NullWindow()
+	{
+		if (m_OwnsContext)
+			ImGui::DestroyContext();
+	}
+
+	bool NullWindow::pollEvents()
+	{
+		auto& imGuiIO = ImGui::GetIO();
+		imGuiIO.DisplaySize = m_Size;
+		imGuiIO.DeltaTime = m_DeltaTime;
+
+		ImGui::NewFrame();
+		ImGuiNode::BeginDockSpace();
+
+		return true;
+	}
+
+	void NullWindow::submitFrame()
+	{
+		ImGui::End();
+		ImGui::Render();
+
+		m_pDrawData = ImGui::GetDrawData();
+	}
+}
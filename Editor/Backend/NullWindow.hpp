@@ -0,0 +1,68 @@
+// Copyright (c) 2022 Dhiraj Wishal
+
+#pragma once
+
+#include <imgui.h>
+
+namespace rapid
+{
+	/**
+	 * Null window class.
+	 * This runs the same ImGui frame loop as the window, but without SDL or Vulkan. Frames are built into ImDrawData
+	 * which is never submitted, so the CPU cost of the UI can be measured on any machine.
+	 *
+	 * There are no events, and the time delta of every frame is fixed, so consecutive runs build the same frames. The
+	 * globals which need the renderer (like the ImGui node) stay nullptr, and the frontend falls back as it would without
+	 * them.
+	 */
+	class NullWindow final
+	{
+	public:
+		/**
+		 * Explicit constructor.
+		 * This creates the ImGui context if there isn't one already.
+		 *
+		 * @param size The display size. Default is 1920x1080.
+		 * @param deltaTime The time delta of each frame in seconds. Default is 1/60.
+		 */
+		explicit NullWindow(ImVec2 size = ImVec2(1920.0f, 1080.0f), float deltaTime = 1.0f / 60.0f);
+
+		/**
+		 * Destructor.
+		 * The ImGui context is destroyed if it was created by the window.
+		 */
+		~NullWindow();
+
+		NullWindow(const NullWindow&) = delete;
+		NullWindow& operator=(const NullWindow&) = delete;
+
+		/**
+		 * Begin a new frame.
+		 * This mirrors Window::pollEvents(), and needs to be called before building the UI.
+		 *
+		 * @return Always true, as there's nothing that can close the window.
+		 */
+		bool pollEvents();
+
+		/**
+		 * End the frame and build its draw data.
+		 * Nothing is submitted.
+		 */
+		void submitFrame();
+
+		/**
+		 * Get the draw data of the last submitted frame.
+		 *
+		 * @return The draw data pointer. This is nullptr before the first frame is submitted.
+		 */
+		const ImDrawData* getDrawData() const { return m_pDrawData; }
+
+	private:
+		const ImDrawData* m_pDrawData = nullptr;
+
+		const ImVec2 m_Size;
+		const float m_DeltaTime;
+
+		bool m_OwnsContext = false;
+	};
+}
@@ -2,15 +2,22 @@
 
 #pragma once
 
-#include "CommandBuffer.hpp"
+#include "RenderGraph.hpp"
 
 namespace rapid
 {
 	class Window;
+	class Viewport;
 
 	/**
 	 * Processing node.
 	 * Processing nodes are used to render a set of objects to the screen. In this application, we use nodes to render the UI.
+	 *
+	 * onPollEvents(), endFrame() and isAnimating() are called on the UI thread, and the rest are called on the window's
+	 * render thread. The UI thread builds the next frame while the render thread records, submits and presents the
+	 * previous one, so a node keeps what the UI thread builds apart from what the render thread renders. swapFrame() hands
+	 * a submitted frame over. It and onWindowResize() are the only calls which can touch both, as the UI thread waits
+	 * meanwhile. bindViewport() is called on worker threads while the render thread records the window.
 	 */
 	class ProcessingNode : public BackendObject
 	{
@@ -31,23 +38,93 @@ namespace rapid
 		/**
 		 * This method will be called as soon as the new iteration starts.
 		 *
-		 * @param events The events of this iteration.
+		 * @param events The events of this iteration, in the order they were received.
 		 */
-		virtual void onPollEvents(SDL_Event& events) = 0;
+		virtual void onPollEvents(const std::vector<SDL_Event>& events) = 0;
+
+		/**
+		 * End the frame.
+		 * This is called on the UI thread when the frame is submitted. Everything the render thread needs from the frame
+		 * has to be captured here, and is handed over by swapFrame().
+		 */
+		virtual void endFrame() {}
+
+		/**
+		 * Hand the submitted frame over to the render thread.
+		 * This is called on the render thread before the frame is recorded, while the UI thread waits till it's done. The
+		 * previous submission of the frame index is finished by then, so its resources can be reused.
+		 *
+		 * @param frameIndex The frame's index number.
+		 */
+		virtual void swapFrame(uint32_t frameIndex) {}
+
+		/**
+		 * Prepare the node for rendering.
+		 * This is called before the window's render pass begins, so the node can finalize its data and report what changed.
+		 *
+		 * @param frameIndex The frame's index number.
+		 * @return The area of the window which changed since the last frame. An empty area means that nothing changed.
+		 */
+		virtual VkRect2D prepare(uint32_t frameIndex) = 0;
+
+		/**
+		 * Get the name of the node.
+		 * This names the node's scope in the GPU profiler.
+		 *
+		 * @return The name.
+		 */
+		virtual std::string_view getName() const { return "Node"; }
+
+		/**
+		 * Add the passes which need to run before the window's pass, like rendering to offscreen targets.
+		 * This is called every frame, even if nothing is drawn to the window.
+		 *
+		 * @param graph The frame's render graph.
+		 * @param frameIndex The frame's index number.
+		 */
+		virtual void addPasses(RenderGraph& graph, uint32_t frameIndex) {}
+
+		/**
+		 * Declare the resources which are read by bind(), like the offscreen targets added by addPasses().
+		 * This orders the window's pass after the passes which write them.
+		 *
+		 * @param builder The builder of the window's pass.
+		 */
+		virtual void declareResources(RenderGraph::PassBuilder& builder) const {}
 
 		/**
 		 * Bind the resources to the command buffer.
+		 * Note that only the window's render area needs to be drawn, everything outside of it is discarded.
 		 *
 		 * @param commandBuffer The command buffer to bind to.
 		 * @param frameIndex The frame's index number.
 		 */
 		virtual void bind(CommandBuffer commandBuffer, uint32_t frameIndex) = 0;
 
+		/**
+		 * Bind the resources of a viewport to the command buffer.
+		 * The viewports are recorded on worker threads at the same time as each other and the window, so this should
+		 * only modify the data which belongs to the viewport.
+		 *
+		 * @param commandBuffer The command buffer to bind to.
+		 * @param viewport The viewport which is rendered.
+		 * @param frameIndex The frame's index number.
+		 */
+		virtual void bindViewport(CommandBuffer commandBuffer, const Viewport& viewport, uint32_t frameIndex) {}
+
 		/**
 		 * This method will get called when the window is resized.
 		 */
 		virtual void onWindowResize() = 0;
 
+		/**
+		 * Check if the node is animating.
+		 * If a node is animating, the window will keep on rendering frames even if there are no new inputs.
+		 *
+		 * @return Whether or not the node is animating. Default is false.
+		 */
+		virtual bool isAnimating() const { return false; }
+
 	protected:
 		GraphicsEngine& m_Engine;
 		Window& m_Window;
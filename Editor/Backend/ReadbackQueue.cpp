@@ -0,0 +1,248 @@
+// Copyright (c) 2022 Dhiraj Wishal
+
+#include "ReadbackQueue.hpp"
+#include "Utility.hpp"
+
+#include <spdlog/spdlog.h>
+
+#include <bit>
+
+namespace
+{
+	/**
+	 * The alignment of the readbacks in the staging buffer.
+	 * This satisfies the copy alignment requirements of every format we read.
+	 */
+	constexpr uint64_t ReadbackAlignment = 16;
+
+	/**
+	 * The smallest staging buffer size.
+	 */
+	constexpr uint64_t MinimumStagingSize = 1024 * 1024;
+
+	/**
+	 * Align a size.
+	 *
+	 * @param size The size to align.
+	 * @return The aligned size.
+	 */
+	constexpr uint64_t Align(uint64_t size)
+	{
+		return (size + ReadbackAlignment - 1) & ~(ReadbackAlignment - 1);
+	}
+
+	/**
+	 * Create a layout transition barrier for a raw image.
+	 *
+	 * @param vImage The image.
+	 * @param oldLayout The old layout.
+	 * @param newLayout The new layout.
+	 * @param srcAccessMask The source access mask.
+	 * @param dstAccessMask The destination access mask.
+	 * @return The barrier.
+	 */
+	VkImageMemoryBarrier CreateBarrier(VkImage vImage, VkImageLayout oldLayout, VkImageLayout newLayout, VkAccessFlags srcAccessMask, VkAccessFlags dstAccessMask)
+	{
+		return VkImageMemoryBarrier{
+			.sType = VK_STRUCTURE_TYPE_IMAGE_MEMORY_BARRIER,
+			.srcAccessMask = srcAccessMask,
+			.dstAccessMask = dstAccessMask,
+			.oldLayout = oldLayout,
+			.newLayout = newLayout,
+			.srcQueueFamilyIndex = VK_QUEUE_FAMILY_IGNORED,
+			.dstQueueFamilyIndex = VK_QUEUE_FAMILY_IGNORED,
+			.image = vImage,
+			.subresourceRange = {
+				.aspectMask = VK_IMAGE_ASPECT_COLOR_BIT,
+				.baseMipLevel = 0,
+				.levelCount = 1,
+				.baseArrayLayer = 0,
+				.layerCount = 1,
+			},
+		};
+	}
+}
+
+namespace rapid
+{
+	ReadbackQueue::ReadbackQueue(GraphicsEngine& engine, uint32_t frameCount)
+		: m_Frames(frameCount), m_Engine(engine)
+	{
+	}
+
+	ReadbackQueue::~ReadbackQueue()
+	{
+		for (auto& frame : m_Frames)
+		{
+			if (frame.m_StagingBuffer)
+				frame.m_StagingBuffer->unmapMemory();
+		}
+	}
+
+	void ReadbackQueue::readImage(Image& image, ReadbackCallback&& callback, uint32_t mipLevel, VkFormat outputFormat)
+	{
+		if (mipLevel >= image.mipLevels())
+		{
+			spdlog::error("Cannot read back mip level {} of an image with {} levels!", mipLevel, image.mipLevels());
+			return;
+		}
+
+		auto& request = m_Requests.emplace_back();
+		request.m_Callback = std::move(callback);
+		request.m_pImage = &image;
+		request.m_Image = image.getImage();
+		request.m_Extent = image.mipExtent(mipLevel);
+		request.m_Format = image.format();
+		request.m_OutputFormat = outputFormat;
+		request.m_MipLevel = mipLevel;
+		request.m_PixelSize = image.getPixelSize();
+	}
+
+	void ReadbackQueue::readImage(VkImage vImage, VkExtent3D extent, VkFormat format, uint8_t pixelSize, VkImageLayout layout, ReadbackCallback&& callback, VkFormat outputFormat)
+	{
+		auto& request = m_Requests.emplace_back();
+		request.m_Callback = std::move(callback);
+		request.m_Image = vImage;
+		request.m_Extent = extent;
+		request.m_Format = format;
+		request.m_OutputFormat = outputFormat;
+		request.m_Layout = layout;
+		request.m_PixelSize = pixelSize;
+	}
+
+	void ReadbackQueue::complete(uint32_t frameIndex)
+	{
+		auto& frame = m_Frames[frameIndex];
+		if (frame.m_Readbacks.empty())
+			return;
+
+		const auto& lastReadback = frame.m_Readbacks.back();
+		frame.m_StagingBuffer->invalidateMemory(0, lastReadback.m_Offset + lastReadback.m_Size);
+
+		// The callbacks might request new readbacks, which go to the next recorded frame.
+		for (const auto& readback : std::exchange(frame.m_Readbacks, {}))
+		{
+			const auto pPixels = frame.m_pStagingMemory + readback.m_Offset;
+			const auto pixelCount = static_cast<uint64_t>(readback.m_Extent.width) * readback.m_Extent.height * readback.m_Extent.depth;
+
+			if (readback.m_OutputFormat == VK_FORMAT_UNDEFINED || readback.m_OutputFormat == readback.m_Format)
+				readback.m_Callback(pPixels, readback.m_Extent, readback.m_Format);
+
+			else if (utility::ConvertPixels(pPixels, readback.m_OutputFormat, pPixels, readback.m_Format, pixelCount))
+				readback.m_Callback(pPixels, readback.m_Extent, readback.m_OutputFormat);
+		}
+	}
+
+	void ReadbackQueue::record(VkCommandBuffer vCommandBuffer, uint32_t frameIndex)
+	{
+		if (m_Requests.empty())
+			return;
+
+		auto& frame = m_Frames[frameIndex];
+
+		// Make room for all the requests up front, so the buffer doesn't change under the recorded copies.
+		uint64_t requiredSize = 0;
+		for (const auto& request : m_Requests)
+			requiredSize += Align(static_cast<uint64_t>(request.m_Extent.width) * request.m_Extent.height * request.m_Extent.depth * request.m_PixelSize);
+
+		reserveStaging(frame, requiredSize);
+
+		const auto& deviceTable = m_Engine.getDeviceTable();
+		uint64_t offset = 0;
+
+		for (auto& request : m_Requests)
+		{
+			const auto size = static_cast<uint64_t>(request.m_Extent.width) * request.m_Extent.height * request.m_Extent.depth * request.m_PixelSize;
+
+			const VkBufferImageCopy imageCopy = {
+				.bufferOffset = offset,
+				.bufferRowLength = request.m_Extent.width,
+				.bufferImageHeight = request.m_Extent.height,
+				.imageSubresource = {
+					.aspectMask = VK_IMAGE_ASPECT_COLOR_BIT,
+					.mipLevel = request.m_MipLevel,
+					.baseArrayLayer = 0,
+					.layerCount = 1,
+				},
+				.imageOffset = {},
+				.imageExtent = request.m_Extent,
+			};
+
+			// Image objects track their own layouts.
+			if (request.m_pImage)
+			{
+				const auto oldLayout = request.m_pImage->layout(request.m_MipLevel);
+				request.m_pImage->changeImageLayout(VK_IMAGE_LAYOUT_TRANSFER_SRC_OPTIMAL, vCommandBuffer, request.m_MipLevel, 1);
+				deviceTable.vkCmdCopyImageToBuffer(vCommandBuffer, request.m_Image, VK_IMAGE_LAYOUT_TRANSFER_SRC_OPTIMAL, frame.m_StagingBuffer->buffer(), 1, &imageCopy);
+
+				if (oldLayout != VK_IMAGE_LAYOUT_UNDEFINED && oldLayout != VK_IMAGE_LAYOUT_PREINITIALIZED)
+					request.m_pImage->changeImageLayout(oldLayout, vCommandBuffer, request.m_MipLevel, 1);
+			}
+			else
+			{
+				const auto toTransfer = CreateBarrier(request.m_Image, request.m_Layout, VK_IMAGE_LAYOUT_TRANSFER_SRC_OPTIMAL, VK_ACCESS_COLOR_ATTACHMENT_WRITE_BIT, VK_ACCESS_TRANSFER_READ_BIT);
+				deviceTable.vkCmdPipelineBarrier(vCommandBuffer, VK_PIPELINE_STAGE_COLOR_ATTACHMENT_OUTPUT_BIT, VK_PIPELINE_STAGE_TRANSFER_BIT, 0, 0, nullptr, 0, nullptr, 1, &toTransfer);
+
+				deviceTable.vkCmdCopyImageToBuffer(vCommandBuffer, request.m_Image, VK_IMAGE_LAYOUT_TRANSFER_SRC_OPTIMAL, frame.m_StagingBuffer->buffer(), 1, &imageCopy);
+
+				const auto toOldLayout = CreateBarrier(request.m_Image, VK_IMAGE_LAYOUT_TRANSFER_SRC_OPTIMAL, request.m_Layout, VK_ACCESS_TRANSFER_READ_BIT, 0);
+				deviceTable.vkCmdPipelineBarrier(vCommandBuffer, VK_PIPELINE_STAGE_TRANSFER_BIT, VK_PIPELINE_STAGE_BOTTOM_OF_PIPE_BIT, 0, 0, nullptr, 0, nullptr, 1, &toOldLayout);
+			}
+
+			frame.m_Readbacks.emplace_back(Readback{
+				.m_Callback = std::move(request.m_Callback),
+				.m_Extent = request.m_Extent,
+				.m_Format = request.m_Format,
+				.m_OutputFormat = request.m_OutputFormat,
+				.m_Offset = offset,
+				.m_Size = size
+				});
+
+			offset += Align(size);
+		}
+
+		// Make the copies visible to the host once the frame is done.
+		const VkMemoryBarrier memoryBarrier = {
+			.sType = VK_STRUCTURE_TYPE_MEMORY_BARRIER,
+			.pNext = nullptr,
+			.srcAccessMask = VK_ACCESS_TRANSFER_WRITE_BIT,
+			.dstAccessMask = VK_ACCESS_HOST_READ_BIT
+		};
+
+		deviceTable.vkCmdPipelineBarrier(vCommandBuffer, VK_PIPELINE_STAGE_TRANSFER_BIT, VK_PIPELINE_STAGE_HOST_BIT, 0, 1, &memoryBarrier, 0, nullptr, 0, nullptr);
+		m_Requests.clear();
+	}
+
+	void ReadbackQueue::flush()
+	{
+		for (uint32_t i = 0; i < m_Frames.size(); i++)
+			complete(i);
+	}
+
+	bool ReadbackQueue::isBusy() const
+	{
+		if (!m_Requests.empty())
+			return true;
+
+		for (const auto& frame : m_Frames)
+		{
+			if (!frame.m_Readbacks.empty())
+				return true;
+		}
+
+		return false;
+	}
+
+	void ReadbackQueue::reserveStaging(Frame& frame, uint64_t size)
+	{
+		if (frame.m_StagingBuffer && frame.m_StagingBuffer->size() >= size)
+			return;
+
+		// The frame has no readbacks in flight at this point, so the old buffer can go right away.
+		if (frame.m_StagingBuffer)
+			frame.m_StagingBuffer->unmapMemory();
+
+		frame.m_StagingBuffer = std::make_unique<Buffer>(m_Engine, std::bit_ceil(std::max(size, MinimumStagingSize)), BufferType::Readback);
+		frame.m_pStagingMemory = frame.m_StagingBuffer->mapMemory();
+	}
+}
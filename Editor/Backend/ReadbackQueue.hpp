@@ -0,0 +1,160 @@
+// Copyright (c) 2022 Dhiraj Wishal
+
+#pragma once
+
+#include "Image.hpp"
+
+#include <functional>
+
+namespace rapid
+{
+	/**
+	 * Readback callback type.
+	 * This receives the tightly packed pixels, the extent and the format of the copied image. The pixel pointer is only
+	 * valid during the call.
+	 */
+	using ReadbackCallback = std::function<void(const std::byte*, VkExtent3D, VkFormat)>;
+
+	/**
+	 * Readback queue class.
+	 * This copies images back to the host without stalling. The copies are recorded into a frame's command buffer, and the
+	 * callbacks are invoked once that frame's command buffer comes around again, when the copies are known to be done.
+	 *
+	 * Each frame has its own persistently mapped staging buffer which only grows when a frame needs more space, so
+	 * continuous readbacks don't allocate. The staging memory is host cached, so format conversions run in place.
+	 */
+	class ReadbackQueue final
+	{
+	public:
+		/**
+		 * Explicit constructor.
+		 *
+		 * @param engine The graphics engine.
+		 * @param frameCount The number of frames in flight.
+		 */
+		explicit ReadbackQueue(GraphicsEngine& engine, uint32_t frameCount);
+
+		/**
+		 * Destructor.
+		 */
+		~ReadbackQueue();
+
+		ReadbackQueue(const ReadbackQueue&) = delete;
+		ReadbackQueue& operator=(const ReadbackQueue&) = delete;
+
+		/**
+		 * Read an image back.
+		 * The copy is recorded in the next frame, so the image needs to stay alive until then.
+		 *
+		 * @param image The image to read.
+		 * @param callback The callback to invoke with the pixels.
+		 * @param mipLevel The mip level to read. Default is 0.
+		 * @param outputFormat The format to convert the pixels to before invoking the callback. Default is VK_FORMAT_UNDEFINED, which keeps the image's format.
+		 */
+		void readImage(Image& image, ReadbackCallback&& callback, uint32_t mipLevel = 0, VkFormat outputFormat = VK_FORMAT_UNDEFINED);
+
+		/**
+		 * Read a raw Vulkan image back.
+		 * This is meant for images which aren't owned by an Image object, like the swapchain images. The image is
+		 * transitioned to the transfer source layout for the copy and back to its layout afterwards.
+		 *
+		 * @param vImage The image to read.
+		 * @param extent The image extent.
+		 * @param format The image format.
+		 * @param pixelSize The size of a single pixel in bytes.
+		 * @param layout The current layout of the image.
+		 * @param callback The callback to invoke with the pixels.
+		 * @param outputFormat The format to convert the pixels to before invoking the callback. Default is VK_FORMAT_UNDEFINED, which keeps the image's format.
+		 */
+		void readImage(VkImage vImage, VkExtent3D extent, VkFormat format, uint8_t pixelSize, VkImageLayout layout, ReadbackCallback&& callback, VkFormat outputFormat = VK_FORMAT_UNDEFINED);
+
+		/**
+		 * Complete the readbacks of a frame.
+		 * This needs to be called before re-recording the frame's command buffer, after its previous submission finished.
+		 *
+		 * @param frameIndex The frame index.
+		 */
+		void complete(uint32_t frameIndex);
+
+		/**
+		 * Record the requested copies.
+		 * This needs to be called outside of a render pass.
+		 *
+		 * @param vCommandBuffer The frame's command buffer.
+		 * @param frameIndex The frame index.
+		 */
+		void record(VkCommandBuffer vCommandBuffer, uint32_t frameIndex);
+
+		/**
+		 * Complete all the readbacks in flight.
+		 * The device needs to be idle when calling this.
+		 */
+		void flush();
+
+		/**
+		 * Check if there are readbacks waiting to be recorded or completed.
+		 *
+		 * @return Whether or not the queue is busy.
+		 */
+		bool isBusy() const;
+
+	private:
+		/**
+		 * Readback request structure.
+		 */
+		struct Request final
+		{
+			ReadbackCallback m_Callback = {};
+
+			Image* m_pImage = nullptr;
+			VkImage m_Image = VK_NULL_HANDLE;
+
+			VkExtent3D m_Extent = {};
+			VkFormat m_Format = VK_FORMAT_UNDEFINED;
+			VkFormat m_OutputFormat = VK_FORMAT_UNDEFINED;
+			VkImageLayout m_Layout = VK_IMAGE_LAYOUT_UNDEFINED;
+
+			uint32_t m_MipLevel = 0;
+			uint8_t m_PixelSize = 0;
+		};
+
+		/**
+		 * Recorded readback structure.
+		 */
+		struct Readback final
+		{
+			ReadbackCallback m_Callback = {};
+
+			VkExtent3D m_Extent = {};
+			VkFormat m_Format = VK_FORMAT_UNDEFINED;
+			VkFormat m_OutputFormat = VK_FORMAT_UNDEFINED;
+
+			uint64_t m_Offset = 0;
+			uint64_t m_Size = 0;
+		};
+
+		/**
+		 * Frame structure.
+		 */
+		struct Frame final
+		{
+			std::vector<Readback> m_Readbacks = {};
+			std::unique_ptr<Buffer> m_StagingBuffer = nullptr;
+			std::byte* m_pStagingMemory = nullptr;
+		};
+
+		/**
+		 * Make sure that a frame's staging buffer can hold a number of bytes.
+		 *
+		 * @param frame The frame.
+		 * @param size The required size.
+		 */
+		void reserveStaging(Frame& frame, uint64_t size);
+
+	private:
+		std::vector<Request> m_Requests = {};
+		std::vector<Frame> m_Frames = {};
+
+		GraphicsEngine& m_Engine;
+	};
+}
@@ -0,0 +1,396 @@
+// Copyright (c) 2022 Dhiraj Wishal
+
+#include "RenderGraph.hpp"
+#include "Utility.hpp"
+
+#include "Core/Hash.hpp"
+
+#include <spdlog/spdlog.h>
+
+#include <algorithm>
+#include <tuple>
+
+namespace
+{
+	/**
+	 * Get the layout, stages and access flags of a resource usage.
+	 *
+	 * @param usage The resource usage.
+	 * @param isWrite Whether or not the resource is written.
+	 * @return The layout, stages and access flags.
+	 */
+	std::tuple<VkImageLayout, VkPipelineStageFlags2, VkAccessFlags2> GetUsageInfo(rapid::ResourceUsage usage, bool isWrite)
+	{
+		switch (usage)
+		{
+		case rapid::ResourceUsage::ColorAttachment:
+			return { VK_IMAGE_LAYOUT_COLOR_ATTACHMENT_OPTIMAL, VK_PIPELINE_STAGE_2_COLOR_ATTACHMENT_OUTPUT_BIT, isWrite ? VK_ACCESS_2_COLOR_ATTACHMENT_READ_BIT | VK_ACCESS_2_COLOR_ATTACHMENT_WRITE_BIT : VK_ACCESS_2_COLOR_ATTACHMENT_READ_BIT };
+
+		case rapid::ResourceUsage::Sampled:
+			return { VK_IMAGE_LAYOUT_SHADER_READ_ONLY_OPTIMAL, VK_PIPELINE_STAGE_2_FRAGMENT_SHADER_BIT, VK_ACCESS_2_SHADER_SAMPLED_READ_BIT };
+
+		case rapid::ResourceUsage::TransferSource:
+			return { VK_IMAGE_LAYOUT_TRANSFER_SRC_OPTIMAL, VK_PIPELINE_STAGE_2_ALL_TRANSFER_BIT, VK_ACCESS_2_TRANSFER_READ_BIT };
+
+		case rapid::ResourceUsage::TransferDestination:
+			return { VK_IMAGE_LAYOUT_TRANSFER_DST_OPTIMAL, VK_PIPELINE_STAGE_2_ALL_TRANSFER_BIT, VK_ACCESS_2_TRANSFER_WRITE_BIT };
+
+		case rapid::ResourceUsage::Present:
+		default:
+			return { VK_IMAGE_LAYOUT_PRESENT_SRC_KHR, VK_PIPELINE_STAGE_2_NONE, VK_ACCESS_2_NONE };
+		}
+	}
+}
+
+namespace rapid
+{
+	void RenderGraph::PassBuilder::setSideEffects()
+	{
+		m_Graph.m_Scheduler.setSideEffects(m_PassIndex);
+	}
+
+	RenderGraph::RenderGraph(GraphicsEngine& engine, uint32_t frameCount)
+		: m_Engine(engine), m_FrameCount(frameCount)
+	{
+	}
+
+	RenderGraph::~RenderGraph()
+	{
+		destroyTransients(m_TransientImages, m_MemoryBlocks);
+
+		for (auto& retired : m_RetiredTransients)
+			destroyTransients(retired.m_Images, retired.m_MemoryBlocks);
+	}
+
+	RenderGraph::ResourceID RenderGraph::importImage(std::string_view name, VkImage vImage, VkImageView vImageView, VkImageLayout initialLayout, ResourceUsage finalUsage)
+	{
+		auto& resource = m_Resources.emplace_back();
+		resource.m_Name = name;
+		resource.m_Image = vImage;
+		resource.m_ImageView = vImageView;
+		resource.m_State = ResourceState{ .m_Layout = initialLayout, .m_Stages = VK_PIPELINE_STAGE_2_COLOR_ATTACHMENT_OUTPUT_BIT };
+		resource.m_FinalUsage = finalUsage;
+
+		return m_Scheduler.addResource(false);
+	}
+
+	RenderGraph::ResourceID RenderGraph::importImage(std::string_view name, Image& image, ResourceUsage finalUsage)
+	{
+		auto& resource = m_Resources.emplace_back();
+		resource.m_Name = name;
+		resource.m_pImage = &image;
+		resource.m_Image = image.getImage();
+		resource.m_ImageView = image.getImageView();
+		resource.m_State = ResourceState{ .m_Layout = image.layout() };
+		resource.m_FinalUsage = finalUsage;
+
+		return m_Scheduler.addResource(false);
+	}
+
+	RenderGraph::ResourceID RenderGraph::createImage(std::string_view name, VkExtent2D extent, VkFormat format, VkImageUsageFlags usage)
+	{
+		auto& resource = m_Resources.emplace_back();
+		resource.m_Name = name;
+		resource.m_Extent = extent;
+		resource.m_Format = format;
+		resource.m_Usage = usage;
+		resource.m_IsTransient = true;
+
+		return m_Scheduler.addResource(true);
+	}
+
+	void RenderGraph::addPass(std::string_view name, const SetupFunction& setup, ExecuteFunction&& execute)
+	{
+		auto& pass = m_Passes.emplace_back();
+		pass.m_Name = name;
+		pass.m_Execute = std::move(execute);
+
+		PassBuilder builder(*this, m_Scheduler.addPass());
+		setup(builder);
+	}
+
+	void RenderGraph::execute(CommandBuffer commandBuffer, GpuProfiler* pProfiler)
+	{
+		m_FrameNumber++;
+
+		// Destroy the retired transient images which are no longer used by any frame.
+		std::erase_if(m_RetiredTransients, [this](RetiredTransients& retired)
+			{
+				if (retired.m_DestroyFrame > m_FrameNumber)
+					return false;
+
+				destroyTransients(retired.m_Images, retired.m_MemoryBlocks);
+				return true;
+			}
+		);
+
+		// The passes are recorded group by group, in the order they were added within a group.
+		const auto order = m_Scheduler.schedule();
+		const auto groupCount = m_Scheduler.getGroupCount();
+		resolveTransientImages();
+
+		m_ExecutedPassCount = static_cast<uint32_t>(order.size());
+		m_CulledPassCount = static_cast<uint32_t>(m_Passes.size() - order.size());
+
+		const auto vCommandBuffer = commandBuffer.buffer();
+		std::vector<VkImageMemoryBarrier2> barriers;
+
+		auto itr = order.begin();
+		for (uint32_t group = 0; group < groupCount; group++)
+		{
+			const auto groupEnd = std::find_if(itr, order.end(), [this, group](uint32_t index) { return m_Scheduler.getPass(index).m_Group != group; });
+
+			// Every pass in a group is independent of the others, so their barriers can be issued together.
+			barriers.clear();
+			for (auto passItr = itr; passItr != groupEnd; passItr++)
+			{
+				for (const auto& access : m_Scheduler.getPass(*passItr).m_Accesses)
+				{
+					const auto [layout, stages, accessFlags] = GetUsageInfo(static_cast<ResourceUsage>(access.m_Usage), access.m_IsWrite);
+					transition(m_Resources[access.m_Resource], ResourceState{ .m_Layout = layout, .m_Stages = stages, .m_Access = accessFlags, .m_IsWrite = access.m_IsWrite }, barriers);
+				}
+			}
+
+			m_Engine.recordImageBarriers(vCommandBuffer, barriers);
+
+			for (; itr != groupEnd; itr++)
+			{
+				const auto scope = GpuScope(pProfiler, vCommandBuffer, m_Passes[*itr].m_Name);
+				m_Passes[*itr].m_Execute(commandBuffer);
+			}
+		}
+
+		// Move the imported images to their final layouts. Images which no pass used are left as they are.
+		barriers.clear();
+		for (ResourceID i = 0; i < m_Resources.size(); i++)
+		{
+			auto& resource = m_Resources[i];
+			if (resource.m_IsTransient || !m_Scheduler.getResource(i).m_IsUsed)
+				continue;
+
+			const auto [layout, stages, accessFlags] = GetUsageInfo(resource.m_FinalUsage, false);
+			transition(resource, ResourceState{ .m_Layout = layout, .m_Stages = stages, .m_Access = accessFlags }, barriers);
+
+			if (resource.m_pImage)
+				resource.m_pImage->setLayout(layout);
+		}
+
+		m_Engine.recordImageBarriers(vCommandBuffer, barriers);
+
+		m_Scheduler.clear();
+		m_Passes.clear();
+		m_Resources.clear();
+	}
+
+	void RenderGraph::addAccess(uint32_t passIndex, ResourceID resource, ResourceUsage usage, bool isWrite)
+	{
+		// A pass can only use a resource in one layout. Reading and writing it the same way is a write.
+		if (!m_Scheduler.addAccess(passIndex, resource, static_cast<uint32_t>(usage), isWrite))
+			spdlog::error("The pass '{}' uses the resource '{}' in two different ways! Split it into two passes.", m_Passes[passIndex].m_Name, m_Resources[resource].m_Name);
+	}
+
+	void RenderGraph::resolveTransientImages()
+	{
+		std::vector<ResourceID> transients;
+		uint64_t hash = HashSeed;
+		for (ResourceID i = 0; i < m_Resources.size(); i++)
+		{
+			const auto& resource = m_Resources[i];
+			const auto& scheduled = m_Scheduler.getResource(i);
+			if (!resource.m_IsTransient || !scheduled.m_IsUsed)
+				continue;
+
+			transients.emplace_back(i);
+			hash = HashValue(resource.m_Extent, hash);
+			hash = HashValue(resource.m_Format, hash);
+			hash = HashValue(resource.m_Usage, hash);
+			hash = HashValue(scheduled.m_FirstGroup, hash);
+			hash = HashValue(scheduled.m_LastGroup, hash);
+		}
+
+		// The images of the last frame can be used as they are if nothing changed. Frames without any keep them for later.
+		if (!transients.empty() && hash != m_TransientHash)
+		{
+			retireTransients();
+			m_TransientHash = hash;
+
+			// Create the images first, as their memory requirements decide what can be aliased.
+			std::vector<MemoryRequirement> requirements(transients.size());
+			for (uint64_t i = 0; i < transients.size(); i++)
+			{
+				const auto& resource = m_Resources[transients[i]];
+				const VkImageCreateInfo imageCreateInfo = {
+					.sType = VK_STRUCTURE_TYPE_IMAGE_CREATE_INFO,
+					.pNext = nullptr,
+					.flags = 0,
+					.imageType = VK_IMAGE_TYPE_2D,
+					.format = resource.m_Format,
+					.extent = { resource.m_Extent.width, resource.m_Extent.height, 1 },
+					.mipLevels = 1,
+					.arrayLayers = 1,
+					.samples = VK_SAMPLE_COUNT_1_BIT,
+					.tiling = VK_IMAGE_TILING_OPTIMAL,
+					.usage = resource.m_Usage,
+					.sharingMode = VK_SHARING_MODE_EXCLUSIVE,
+					.queueFamilyIndexCount = 0,
+					.pQueueFamilyIndices = nullptr,
+					.initialLayout = VK_IMAGE_LAYOUT_UNDEFINED,
+				};
+
+				auto& image = m_TransientImages.emplace_back();
+				utility::ValidateResult(m_Engine.getDeviceTable().vkCreateImage(m_Engine.getLogicalDevice(), &imageCreateInfo, nullptr, &image.m_Image), "Failed to create the transient image!");
+
+				VkMemoryRequirements memoryRequirements = {};
+				m_Engine.getDeviceTable().vkGetImageMemoryRequirements(m_Engine.getLogicalDevice(), image.m_Image, &memoryRequirements);
+				requirements[i] = MemoryRequirement{ .m_Size = memoryRequirements.size, .m_Alignment = memoryRequirements.alignment, .m_TypeBits = memoryRequirements.memoryTypeBits };
+			}
+
+			// Images whose lifetimes don't overlap share a block.
+			std::vector<uint32_t> blockIndexes;
+			const auto blocks = m_Scheduler.aliasMemory(transients, requirements, blockIndexes);
+			for (uint64_t i = 0; i < transients.size(); i++)
+				m_TransientImages[i].m_MemoryBlock = blockIndexes[i];
+
+			// Allocate the blocks and bind the images to them.
+			const VmaAllocationCreateInfo allocationCreateInfo = {
+				.usage = VMA_MEMORY_USAGE_GPU_ONLY
+			};
+
+			for (const auto& block : blocks)
+			{
+				const VkMemoryRequirements memoryRequirements = { .size = block.m_Size, .alignment = block.m_Alignment, .memoryTypeBits = block.m_TypeBits };
+
+				VmaAllocation allocation = nullptr;
+				VmaAllocationInfo allocationInfo = {};
+				utility::ValidateResult(vmaAllocateMemory(m_Engine.getAllocator(), &memoryRequirements, &allocationCreateInfo, &allocation, &allocationInfo), "Failed to allocate the transient image memory!");
+				m_MemoryBlocks.emplace_back(allocation);
+
+				m_Engine.getMemoryStatistics().add(MemoryCategory::TransientImage, allocationInfo.size);
+			}
+
+			for (uint64_t i = 0; i < transients.size(); i++)
+			{
+				auto& image = m_TransientImages[i];
+				utility::ValidateResult(vmaBindImageMemory(m_Engine.getAllocator(), m_MemoryBlocks[image.m_MemoryBlock], image.m_Image), "Failed to bind the transient image memory!");
+
+				const VkImageViewCreateInfo imageViewCreateInfo = {
+					.sType = VK_STRUCTURE_TYPE_IMAGE_VIEW_CREATE_INFO,
+					.pNext = nullptr,
+					.flags = 0,
+					.image = image.m_Image,
+					.viewType = VK_IMAGE_VIEW_TYPE_2D,
+					.format = m_Resources[transients[i]].m_Format,
+					.components = {},
+					.subresourceRange = {
+						.aspectMask = VK_IMAGE_ASPECT_COLOR_BIT,
+						.baseMipLevel = 0,
+						.levelCount = 1,
+						.baseArrayLayer = 0,
+						.layerCount = 1,
+					}
+				};
+
+				utility::ValidateResult(m_Engine.getDeviceTable().vkCreateImageView(m_Engine.getLogicalDevice(), &imageViewCreateInfo, nullptr, &image.m_ImageView), "Failed to create the transient image view!");
+			}
+		}
+
+		for (uint64_t i = 0; i < transients.size(); i++)
+		{
+			auto& resource = m_Resources[transients[i]];
+			resource.m_Image = m_TransientImages[i].m_Image;
+			resource.m_ImageView = m_TransientImages[i].m_ImageView;
+			resource.m_TransientIndex = static_cast<uint32_t>(i);
+		}
+
+		// Nothing has touched the memory in this frame yet, but the frames in flight could still be using it, so the first
+		// use waits for them.
+		m_MemoryBlockStates.assign(m_MemoryBlocks.size(), ResourceState{ .m_Stages = VK_PIPELINE_STAGE_2_ALL_COMMANDS_BIT, .m_Access = VK_ACCESS_2_MEMORY_WRITE_BIT, .m_IsWrite = true });
+	}
+
+	void RenderGraph::transition(Resource& resource, const ResourceState& state, std::vector<VkImageMemoryBarrier2>& barriers)
+	{
+		auto& current = resource.m_State;
+
+		// A transient image shares its memory with others, so its first use needs to wait for whatever used the memory last.
+		// The previous contents are discarded.
+		auto pMemoryState = resource.m_IsTransient ? &m_MemoryBlockStates[m_TransientImages[resource.m_TransientIndex].m_MemoryBlock] : nullptr;
+		if (pMemoryState && current.m_Layout == VK_IMAGE_LAYOUT_UNDEFINED)
+		{
+			current.m_Stages = pMemoryState->m_Stages;
+			current.m_Access = pMemoryState->m_Access;
+			current.m_IsWrite = true;
+		}
+
+		// Reads in the same layout don't need a barrier, but a later write needs to wait for all of them.
+		if (current.m_Layout == state.m_Layout && !current.m_IsWrite && !state.m_IsWrite)
+		{
+			current.m_Stages |= state.m_Stages;
+			current.m_Access |= state.m_Access;
+		}
+		else
+		{
+			barriers.emplace_back(VkImageMemoryBarrier2{
+				.sType = VK_STRUCTURE_TYPE_IMAGE_MEMORY_BARRIER_2,
+				.pNext = nullptr,
+				.srcStageMask = current.m_Stages,
+				.srcAccessMask = current.m_IsWrite ? current.m_Access : VK_ACCESS_2_NONE,
+				.dstStageMask = state.m_Stages,
+				.dstAccessMask = state.m_Access,
+				.oldLayout = current.m_Layout,
+				.newLayout = state.m_Layout,
+				.srcQueueFamilyIndex = VK_QUEUE_FAMILY_IGNORED,
+				.dstQueueFamilyIndex = VK_QUEUE_FAMILY_IGNORED,
+				.image = resource.m_Image,
+				.subresourceRange = {
+					.aspectMask = VK_IMAGE_ASPECT_COLOR_BIT,
+					.baseMipLevel = 0,
+					.levelCount = VK_REMAINING_MIP_LEVELS,
+					.baseArrayLayer = 0,
+					.layerCount = 1,
+				}
+				});
+
+			current = state;
+		}
+
+		if (pMemoryState)
+			*pMemoryState = current;
+	}
+
+	void RenderGraph::retireTransients()
+	{
+		if (m_TransientImages.empty() && m_MemoryBlocks.empty())
+			return;
+
+		m_RetiredTransients.emplace_back(RetiredTransients{
+			.m_Images = std::move(m_TransientImages),
+			.m_MemoryBlocks = std::move(m_MemoryBlocks),
+			.m_DestroyFrame = m_FrameNumber + m_FrameCount
+			}
+		);
+
+		m_TransientImages.clear();
+		m_MemoryBlocks.clear();
+	}
+
+	void RenderGraph::destroyTransients(std::vector<TransientImage>& images, std::vector<VmaAllocation>& memoryBlocks)
+	{
+		for (const auto& image : images)
+		{
+			m_Engine.getDeviceTable().vkDestroyImageView(m_Engine.getLogicalDevice(), image.m_ImageView, nullptr);
+			m_Engine.getDeviceTable().vkDestroyImage(m_Engine.getLogicalDevice(), image.m_Image, nullptr);
+		}
+
+		for (const auto allocation : memoryBlocks)
+		{
+			VmaAllocationInfo allocationInfo = {};
+			vmaGetAllocationInfo(m_Engine.getAllocator(), allocation, &allocationInfo);
+			m_Engine.getMemoryStatistics().remove(MemoryCategory::TransientImage, allocationInfo.size);
+
+			vmaFreeMemory(m_Engine.getAllocator(), allocation);
+		}
+
+		images.clear();
+		memoryBlocks.clear();
+	}
+}
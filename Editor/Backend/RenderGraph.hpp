@@ -0,0 +1,321 @@
+// Copyright (c) 2022 Dhiraj Wishal
+
+#pragma once
+
+#include "Image.hpp"
+#include "CommandBuffer.hpp"
+#include "GpuProfiler.hpp"
+
+#include "Core/PassScheduler.hpp"
+
+#include <functional>
+#include <string>
+
+namespace rapid
+{
+	/**
+	 * Resource usage enum.
+	 * This describes how a pass uses an image, which decides the image's layout and the stages which access it.
+	 */
+	enum class ResourceUsage : uint8_t
+	{
+		ColorAttachment,
+		Sampled,
+		TransferSource,
+		TransferDestination,
+		Present
+	};
+
+	/**
+	 * Render graph class.
+	 * Passes declare the images they read and write, and the graph takes care of the rest when it's executed:
+	 * - The passes are ordered by their dependencies. Passes which don't depend on each other form a group, and the
+	 *   barriers of a whole group are issued in a single batch.
+	 * - Passes whose outputs are never used are culled. Writing to an imported image, or having side effects, counts as
+	 *   being used.
+	 * - Transient images only live within the frame, and transient images whose lifetimes don't overlap share memory.
+	 *
+	 * The graph is built from scratch every frame. The transient images are kept as long as the frames keep declaring the
+	 * same ones, so a steady frame doesn't allocate. Frames without transient images keep them as well, so passes which only
+	 * run now and then (like shifting a retained layer) don't recreate them every time.
+	 *
+	 * The ordering, culling and aliasing decisions are made by the pass scheduler.
+	 */
+	class RenderGraph final
+	{
+	public:
+		using ResourceID = uint32_t;
+
+		/**
+		 * Pass builder class.
+		 * This is used to declare the resources used by a pass.
+		 */
+		class PassBuilder final
+		{
+			friend RenderGraph;
+
+			/**
+			 * Explicit constructor.
+			 *
+			 * @param graph The render graph.
+			 * @param passIndex The index of the pass being built.
+			 */
+			explicit PassBuilder(RenderGraph& graph, uint32_t passIndex) : m_Graph(graph), m_PassIndex(passIndex) {}
+
+		public:
+			/**
+			 * Declare that the pass reads a resource.
+			 *
+			 * @param resource The resource ID.
+			 * @param usage How the resource is read.
+			 */
+			void read(ResourceID resource, ResourceUsage usage) { m_Graph.addAccess(m_PassIndex, resource, usage, false); }
+
+			/**
+			 * Declare that the pass writes a resource.
+			 * Writes keep the previous contents, so passes which only update parts of an image depend on its previous writer.
+			 *
+			 * @param resource The resource ID.
+			 * @param usage How the resource is written.
+			 */
+			void write(ResourceID resource, ResourceUsage usage) { m_Graph.addAccess(m_PassIndex, resource, usage, true); }
+
+			/**
+			 * Mark the pass as having side effects.
+			 * These passes are never culled, even if nothing uses their outputs.
+			 */
+			void setSideEffects();
+
+		private:
+			RenderGraph& m_Graph;
+			const uint32_t m_PassIndex;
+		};
+
+		using SetupFunction = std::function<void(PassBuilder&)>;
+		using ExecuteFunction = std::function<void(CommandBuffer)>;
+
+	public:
+		/**
+		 * Explicit constructor.
+		 *
+		 * @param engine The graphics engine.
+		 * @param frameCount The number of frames in flight. Transient images are destroyed once no frame uses them.
+		 */
+		explicit RenderGraph(GraphicsEngine& engine, uint32_t frameCount);
+
+		/**
+		 * Destructor.
+		 */
+		~RenderGraph();
+
+		RenderGraph(const RenderGraph&) = delete;
+		RenderGraph& operator=(const RenderGraph&) = delete;
+
+		/**
+		 * Import an image which is not owned by the graph, like a swapchain image.
+		 * The first access waits for the color attachment output stage, which is where the image acquisition is waited on.
+		 *
+		 * @param name The resource name.
+		 * @param vImage The image.
+		 * @param vImageView The image view.
+		 * @param initialLayout The layout the image is in.
+		 * @param finalUsage The usage the image is transitioned to at the end of the graph.
+		 * @return The resource ID.
+		 */
+		ResourceID importImage(std::string_view name, VkImage vImage, VkImageView vImageView, VkImageLayout initialLayout, ResourceUsage finalUsage);
+
+		/**
+		 * Import an image object.
+		 * The image's tracked layout is updated after the graph is executed.
+		 *
+		 * @param name The resource name.
+		 * @param image The image.
+		 * @param finalUsage The usage the image is transitioned to at the end of the graph. Default is sampled.
+		 * @return The resource ID.
+		 */
+		ResourceID importImage(std::string_view name, Image& image, ResourceUsage finalUsage = ResourceUsage::Sampled);
+
+		/**
+		 * Create a transient image.
+		 * The contents are undefined when the first pass which uses it begins, so it needs to be written before it's read.
+		 *
+		 * @param name The resource name.
+		 * @param extent The image extent.
+		 * @param format The image format.
+		 * @param usage The image usage flags.
+		 * @return The resource ID.
+		 */
+		ResourceID createImage(std::string_view name, VkExtent2D extent, VkFormat format, VkImageUsageFlags usage);
+
+		/**
+		 * Add a pass.
+		 *
+		 * @param name The pass name.
+		 * @param setup The function which declares the resources used by the pass. This is called right away.
+		 * @param execute The function which records the pass. This is only called if the pass is not culled.
+		 */
+		void addPass(std::string_view name, const SetupFunction& setup, ExecuteFunction&& execute);
+
+		/**
+		 * Execute the graph.
+		 * This orders and culls the passes, and records them with their barriers. The graph is cleared afterwards.
+		 *
+		 * @param commandBuffer The command buffer to record to.
+		 * @param pProfiler The profiler to measure each pass with. Default is nullptr.
+		 */
+		void execute(CommandBuffer commandBuffer, GpuProfiler* pProfiler = nullptr);
+
+		/**
+		 * Get the image of a resource.
+		 * Transient images are only valid while the graph is executed.
+		 *
+		 * @param resource The resource ID.
+		 * @return The image.
+		 */
+		VkImage getImage(ResourceID resource) const { return m_Resources[resource].m_Image; }
+
+		/**
+		 * Get the image view of a resource.
+		 * Transient image views are only valid while the graph is executed.
+		 *
+		 * @param resource The resource ID.
+		 * @return The image view.
+		 */
+		VkImageView getImageView(ResourceID resource) const { return m_Resources[resource].m_ImageView; }
+
+		/**
+		 * Get the number of passes recorded by the last execution.
+		 *
+		 * @return The pass count.
+		 */
+		uint32_t getExecutedPassCount() const { return m_ExecutedPassCount; }
+
+		/**
+		 * Get the number of passes culled by the last execution.
+		 *
+		 * @return The pass count.
+		 */
+		uint32_t getCulledPassCount() const { return m_CulledPassCount; }
+
+	private:
+		/**
+		 * Resource state structure.
+		 */
+		struct ResourceState final
+		{
+			VkImageLayout m_Layout = VK_IMAGE_LAYOUT_UNDEFINED;
+			VkPipelineStageFlags2 m_Stages = VK_PIPELINE_STAGE_2_NONE;
+			VkAccessFlags2 m_Access = VK_ACCESS_2_NONE;
+			bool m_IsWrite = false;
+		};
+
+		/**
+		 * Resource structure.
+		 */
+		struct Resource final
+		{
+			std::string m_Name;
+
+			Image* m_pImage = nullptr;
+			VkImage m_Image = VK_NULL_HANDLE;
+			VkImageView m_ImageView = VK_NULL_HANDLE;
+
+			VkExtent2D m_Extent = {};
+			VkFormat m_Format = VK_FORMAT_UNDEFINED;
+			VkImageUsageFlags m_Usage = 0;
+
+			ResourceState m_State = {};
+			ResourceUsage m_FinalUsage = ResourceUsage::Sampled;
+
+			uint32_t m_TransientIndex = 0;
+			bool m_IsTransient = false;
+		};
+
+		/**
+		 * Pass structure.
+		 */
+		struct Pass final
+		{
+			std::string m_Name;
+			ExecuteFunction m_Execute = {};
+		};
+
+		/**
+		 * Transient image structure.
+		 */
+		struct TransientImage final
+		{
+			VkImage m_Image = VK_NULL_HANDLE;
+			VkImageView m_ImageView = VK_NULL_HANDLE;
+			uint32_t m_MemoryBlock = 0;
+		};
+
+		/**
+		 * Retired transient resources structure.
+		 * These could be used by frames in flight, so they're destroyed a few frames later.
+		 */
+		struct RetiredTransients final
+		{
+			std::vector<TransientImage> m_Images = {};
+			std::vector<VmaAllocation> m_MemoryBlocks = {};
+			uint64_t m_DestroyFrame = 0;
+		};
+
+		/**
+		 * Add an access to a pass.
+		 *
+		 * @param passIndex The pass index.
+		 * @param resource The resource ID.
+		 * @param usage The resource usage.
+		 * @param isWrite Whether or not the resource is written.
+		 */
+		void addAccess(uint32_t passIndex, ResourceID resource, ResourceUsage usage, bool isWrite);
+
+		/**
+		 * Make sure that the transient images exist, and alias their memory.
+		 * The images are only recreated if the transient images or their lifetimes changed since the last frame.
+		 */
+		void resolveTransientImages();
+
+		/**
+		 * Add the barrier which moves a resource to a new state.
+		 *
+		 * @param resource The resource.
+		 * @param state The new state.
+		 * @param barriers The barriers to add to.
+		 */
+		void transition(Resource& resource, const ResourceState& state, std::vector<VkImageMemoryBarrier2>& barriers);
+
+		/**
+		 * Retire the current transient images.
+		 */
+		void retireTransients();
+
+		/**
+		 * Destroy transient resources.
+		 *
+		 * @param images The images to destroy.
+		 * @param memoryBlocks The memory blocks to free.
+		 */
+		void destroyTransients(std::vector<TransientImage>& images, std::vector<VmaAllocation>& memoryBlocks);
+
+	private:
+		PassScheduler m_Scheduler = {};
+		std::vector<Resource> m_Resources = {};
+		std::vector<Pass> m_Passes = {};
+
+		std::vector<TransientImage> m_TransientImages = {};
+		std::vector<VmaAllocation> m_MemoryBlocks = {};
+		std::vector<ResourceState> m_MemoryBlockStates = {};
+		std::vector<RetiredTransients> m_RetiredTransients = {};
+
+		GraphicsEngine& m_Engine;
+
+		uint64_t m_TransientHash = 0;
+		uint64_t m_FrameNumber = 0;
+
+		const uint32_t m_FrameCount;
+		uint32_t m_ExecutedPassCount = 0;
+		uint32_t m_CulledPassCount = 0;
+	};
+}
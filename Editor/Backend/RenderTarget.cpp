@@ -0,0 +1,178 @@
+// Copyright (c) 2022 Dhiraj Wishal
+
+#include "RenderTarget.hpp"
+#include "Window.hpp"
+#include "Utility.hpp"
+
+#include <array>
+
+namespace rapid
+{
+	RenderTarget::RenderTarget(GraphicsEngine& engine, const Window& window, VkExtent2D extent)
+		: m_Engine(engine), m_Extent(extent)
+	{
+		m_Image = std::make_unique<Image>(m_Engine, VkExtent3D{ extent.width, extent.height, 1u }, window.getSwapchainFormat(), VkComponentMapping{}, 1, VK_IMAGE_USAGE_COLOR_ATTACHMENT_BIT);
+
+		// Dynamic rendering renders straight to the image view.
+		if (!m_Engine.isDynamicRenderingEnabled())
+		{
+			createRenderPass();
+			createFramebuffer();
+		}
+	}
+
+	RenderTarget::~RenderTarget()
+	{
+		if (isActive())
+			terminate();
+	}
+
+	void RenderTarget::terminate()
+	{
+		m_Engine.getDeviceTable().vkDestroyFramebuffer(m_Engine.getLogicalDevice(), m_Framebuffer, nullptr);
+		m_Engine.getDeviceTable().vkDestroyRenderPass(m_Engine.getLogicalDevice(), m_RenderPass, nullptr);
+		m_Image->terminate();
+
+		m_IsTerminated = true;
+	}
+
+	void RenderTarget::begin(VkCommandBuffer vCommandBuffer, const VkRect2D& renderArea)
+	{
+		if (m_Engine.isDynamicRenderingEnabled())
+		{
+			const VkRenderingAttachmentInfo colorAttachment = {
+				.sType = VK_STRUCTURE_TYPE_RENDERING_ATTACHMENT_INFO,
+				.pNext = nullptr,
+				.imageView = m_Image->getImageView(),
+				.imageLayout = VK_IMAGE_LAYOUT_COLOR_ATTACHMENT_OPTIMAL,
+				.resolveMode = VK_RESOLVE_MODE_NONE,
+				.resolveImageView = VK_NULL_HANDLE,
+				.resolveImageLayout = VK_IMAGE_LAYOUT_UNDEFINED,
+				.loadOp = VK_ATTACHMENT_LOAD_OP_LOAD,
+				.storeOp = VK_ATTACHMENT_STORE_OP_STORE,
+				.clearValue = {}
+			};
+
+			const VkRenderingInfo renderingInfo = {
+				.sType = VK_STRUCTURE_TYPE_RENDERING_INFO,
+				.pNext = nullptr,
+				.flags = 0,
+				.renderArea = renderArea,
+				.layerCount = 1,
+				.viewMask = 0,
+				.colorAttachmentCount = 1,
+				.pColorAttachments = &colorAttachment,
+				.pDepthAttachment = nullptr,
+				.pStencilAttachment = nullptr
+			};
+
+			m_Engine.getDeviceTable().vkCmdBeginRendering(vCommandBuffer, &renderingInfo);
+			return;
+		}
+
+		const VkRenderPassBeginInfo renderPassBeginInfo = {
+			.sType = VkStructureType::VK_STRUCTURE_TYPE_RENDER_PASS_BEGIN_INFO,
+			.pNext = VK_NULL_HANDLE,
+			.renderPass = m_RenderPass,
+			.framebuffer = m_Framebuffer,
+			.renderArea = renderArea,
+			.clearValueCount = 0,
+			.pClearValues = nullptr,
+		};
+
+		m_Engine.getDeviceTable().vkCmdBeginRenderPass(vCommandBuffer, &renderPassBeginInfo, VkSubpassContents::VK_SUBPASS_CONTENTS_INLINE);
+	}
+
+	void RenderTarget::end(VkCommandBuffer vCommandBuffer)
+	{
+		if (m_Engine.isDynamicRenderingEnabled())
+			m_Engine.getDeviceTable().vkCmdEndRendering(vCommandBuffer);
+
+		else
+			m_Engine.getDeviceTable().vkCmdEndRenderPass(vCommandBuffer);
+	}
+
+	void RenderTarget::createRenderPass()
+	{
+		// The layout transitions are done by the render graph, so the render pass keeps the image in the attachment layout.
+		const VkAttachmentDescription attachmentDescription = {
+			.flags = 0,
+			.format = m_Image->format(),
+			.samples = VK_SAMPLE_COUNT_1_BIT,
+			.loadOp = VK_ATTACHMENT_LOAD_OP_LOAD,
+			.storeOp = VK_ATTACHMENT_STORE_OP_STORE,
+			.stencilLoadOp = VK_ATTACHMENT_LOAD_OP_DONT_CARE,
+			.stencilStoreOp = VK_ATTACHMENT_STORE_OP_DONT_CARE,
+			.initialLayout = VK_IMAGE_LAYOUT_COLOR_ATTACHMENT_OPTIMAL,
+			.finalLayout = VK_IMAGE_LAYOUT_COLOR_ATTACHMENT_OPTIMAL
+		};
+
+		// The dependencies need to be the same as the window's, otherwise the render passes aren't compatible.
+		std::array<VkSubpassDependency, 2> subpassDependencies;
+		subpassDependencies[0].srcSubpass = VK_SUBPASS_EXTERNAL;
+		subpassDependencies[0].dstSubpass = 0;
+		subpassDependencies[0].srcStageMask = VK_PIPELINE_STAGE_BOTTOM_OF_PIPE_BIT;
+		subpassDependencies[0].dstStageMask = VK_PIPELINE_STAGE_COLOR_ATTACHMENT_OUTPUT_BIT;
+		subpassDependencies[0].srcAccessMask = VK_ACCESS_MEMORY_READ_BIT;
+		subpassDependencies[0].dstAccessMask = VK_ACCESS_COLOR_ATTACHMENT_READ_BIT | VK_ACCESS_COLOR_ATTACHMENT_WRITE_BIT;
+		subpassDependencies[0].dependencyFlags = VK_DEPENDENCY_BY_REGION_BIT;
+
+		subpassDependencies[1].srcSubpass = 0;
+		subpassDependencies[1].dstSubpass = VK_SUBPASS_EXTERNAL;
+		subpassDependencies[1].srcStageMask = VK_PIPELINE_STAGE_COLOR_ATTACHMENT_OUTPUT_BIT;
+		subpassDependencies[1].dstStageMask = VK_PIPELINE_STAGE_BOTTOM_OF_PIPE_BIT;
+		subpassDependencies[1].srcAccessMask = VK_ACCESS_COLOR_ATTACHMENT_READ_BIT | VK_ACCESS_COLOR_ATTACHMENT_WRITE_BIT;
+		subpassDependencies[1].dstAccessMask = VK_ACCESS_MEMORY_READ_BIT;
+		subpassDependencies[1].dependencyFlags = VK_DEPENDENCY_BY_REGION_BIT;
+
+		const VkAttachmentReference colorAttachmentReference = {
+			.attachment = 0,
+			.layout = VK_IMAGE_LAYOUT_COLOR_ATTACHMENT_OPTIMAL
+		};
+
+		const VkSubpassDescription subpassDescription = {
+			.flags = 0,
+			.pipelineBindPoint = VK_PIPELINE_BIND_POINT_GRAPHICS,
+			.inputAttachmentCount = 0,
+			.pInputAttachments = nullptr,
+			.colorAttachmentCount = 1,
+			.pColorAttachments = &colorAttachmentReference,
+			.pResolveAttachments = nullptr,
+			.pDepthStencilAttachment = nullptr,
+			.preserveAttachmentCount = 0,
+			.pPreserveAttachments = nullptr
+		};
+
+		const VkRenderPassCreateInfo renderPassCreateInfo = {
+			.sType = VkStructureType::VK_STRUCTURE_TYPE_RENDER_PASS_CREATE_INFO,
+			.pNext = nullptr,
+			.flags = 0,
+			.attachmentCount = 1,
+			.pAttachments = &attachmentDescription,
+			.subpassCount = 1,
+			.pSubpasses = &subpassDescription,
+			.dependencyCount = 2,
+			.pDependencies = subpassDependencies.data(),
+		};
+
+		utility::ValidateResult(m_Engine.getDeviceTable().vkCreateRenderPass(m_Engine.getLogicalDevice(), &renderPassCreateInfo, nullptr, &m_RenderPass), "Failed to create the render target's render pass!");
+	}
+
+	void RenderTarget::createFramebuffer()
+	{
+		const auto vImageView = m_Image->getImageView();
+		const VkFramebufferCreateInfo frameBufferCreateInfo = {
+			.sType = VkStructureType::VK_STRUCTURE_TYPE_FRAMEBUFFER_CREATE_INFO,
+			.pNext = VK_NULL_HANDLE,
+			.flags = 0,
+			.renderPass = m_RenderPass,
+			.attachmentCount = 1,
+			.pAttachments = &vImageView,
+			.width = m_Extent.width,
+			.height = m_Extent.height,
+			.layers = 1,
+		};
+
+		utility::ValidateResult(m_Engine.getDeviceTable().vkCreateFramebuffer(m_Engine.getLogicalDevice(), &frameBufferCreateInfo, nullptr, &m_Framebuffer), "Failed to create the render target's frame buffer!");
+	}
+}
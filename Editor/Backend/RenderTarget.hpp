@@ -0,0 +1,100 @@
+// Copyright (c) 2022 Dhiraj Wishal
+
+#pragma once
+
+#include "Image.hpp"
+
+namespace rapid
+{
+	class Window;
+
+	/**
+	 * Render target object.
+	 * This is an offscreen color image which can be rendered to using the window's pipelines, and sampled afterwards. It
+	 * has the same format as the swapchain, so its render pass is compatible with the window's.
+	 *
+	 * The render pass loads the previous contents, so only the parts which changed need to be redrawn. If dynamic rendering
+	 * is enabled, no render pass or frame buffer is created.
+	 */
+	class RenderTarget final : public BackendObject
+	{
+	public:
+		/**
+		 * Explicit constructor.
+		 *
+		 * @param engine The graphics engine.
+		 * @param window The window whose pipelines are used to render to the target.
+		 * @param extent The target extent.
+		 */
+		explicit RenderTarget(GraphicsEngine& engine, const Window& window, VkExtent2D extent);
+
+		/**
+		 * Destructor.
+		 */
+		~RenderTarget();
+
+		/**
+		 * Terminate the render target.
+		 */
+		void terminate() override;
+
+		/**
+		 * Begin the render pass.
+		 * The image needs to be in the color attachment layout, which is taken care of by the render graph.
+		 *
+		 * @param vCommandBuffer The command buffer to record to.
+		 * @param renderArea The area to render to.
+		 */
+		void begin(VkCommandBuffer vCommandBuffer, const VkRect2D& renderArea);
+
+		/**
+		 * End the render pass.
+		 * The image is left in the color attachment layout.
+		 *
+		 * @param vCommandBuffer The command buffer to record to.
+		 */
+		void end(VkCommandBuffer vCommandBuffer);
+
+		/**
+		 * Get the image.
+		 *
+		 * @return The image reference.
+		 */
+		Image& getImage() { return *m_Image; }
+
+		/**
+		 * Get the image.
+		 *
+		 * @return The image reference.
+		 */
+		const Image& getImage() const { return *m_Image; }
+
+		/**
+		 * Get the target extent.
+		 *
+		 * @return The extent.
+		 */
+		VkExtent2D extent() const { return m_Extent; }
+
+	private:
+		/**
+		 * Create the render pass.
+		 */
+		void createRenderPass();
+
+		/**
+		 * Create the frame buffer.
+		 */
+		void createFramebuffer();
+
+	private:
+		GraphicsEngine& m_Engine;
+
+		std::unique_ptr<Image> m_Image = nullptr;
+
+		VkRenderPass m_RenderPass = VK_NULL_HANDLE;
+		VkFramebuffer m_Framebuffer = VK_NULL_HANDLE;
+
+		const VkExtent2D m_Extent;
+	};
+}
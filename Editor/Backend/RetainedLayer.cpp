@@ -0,0 +1,503 @@
+// Copyright (c) 2022 Dhiraj Wishal
+
+#include "RetainedLayer.hpp"
+#include "Window.hpp"
+#include "Utility.hpp"
+
+#include "Core/StreamingCopy.hpp"
+
+#include <algorithm>
+#include <cmath>
+
+namespace
+{
+	/**
+	 * The maximum number of dirty areas. Any more than this are merged into one, because every area needs its own draw calls.
+	 */
+	constexpr uint64_t MaximumDirtyAreaCount = 4;
+
+	/**
+	 * The number of elements the buffers grow by.
+	 */
+	constexpr uint64_t ElementCount = 2500;
+
+	/**
+	 * Get the size of a buffer which can hold a number of elements.
+	 * This rounds up to the next multiple of the element count, so the buffers are not recreated all the time.
+	 *
+	 * @param count The required element count.
+	 * @param elementSize The size of a single element.
+	 * @return The buffer size.
+	 */
+	constexpr uint64_t GetBufferSize(uint64_t count, uint64_t elementSize)
+	{
+		return ((count / ElementCount) + 1) * ElementCount * elementSize;
+	}
+
+	/**
+	 * Convert a screen space area to a rectangle in the target's space.
+	 * The rectangle is expanded to whole pixels.
+	 *
+	 * @param area The area (minimum x, minimum y, maximum x, maximum y).
+	 * @param origin The target's origin.
+	 * @return The rectangle.
+	 */
+	VkRect2D ToTargetRect(const ImVec4& area, const ImVec2& origin)
+	{
+		const auto left = std::floor(area.x - origin.x);
+		const auto top = std::floor(area.y - origin.y);
+		const auto right = std::ceil(area.z - origin.x);
+		const auto bottom = std::ceil(area.w - origin.y);
+
+		if (right <= left || bottom <= top)
+			return VkRect2D{};
+
+		return VkRect2D{
+			.offset = { static_cast<int32_t>(left), static_cast<int32_t>(top) },
+			.extent = { static_cast<uint32_t>(right - left), static_cast<uint32_t>(bottom - top) }
+		};
+	}
+
+	/**
+	 * Get the region to copy a part of an image with.
+	 *
+	 * @param source The offset in the source image.
+	 * @param destination The offset in the destination image.
+	 * @param extent The extent of the copied area.
+	 * @return The image copy.
+	 */
+	VkImageCopy GetImageCopy(VkOffset2D source, VkOffset2D destination, VkExtent2D extent)
+	{
+		return VkImageCopy{
+			.srcSubresource = { .aspectMask = VK_IMAGE_ASPECT_COLOR_BIT, .mipLevel = 0, .baseArrayLayer = 0, .layerCount = 1 },
+			.srcOffset = { source.x, source.y, 0 },
+			.dstSubresource = { .aspectMask = VK_IMAGE_ASPECT_COLOR_BIT, .mipLevel = 0, .baseArrayLayer = 0, .layerCount = 1 },
+			.dstOffset = { destination.x, destination.y, 0 },
+			.extent = { extent.width, extent.height, 1 }
+		};
+	}
+
+	/**
+	 * Check if two rects overlap.
+	 *
+	 * @param lhs The first rect.
+	 * @param rhs The second rect.
+	 * @return Whether or not they overlap.
+	 */
+	bool IsOverlapping(const VkRect2D& lhs, const VkRect2D& rhs)
+	{
+		return lhs.offset.x < rhs.offset.x + static_cast<int64_t>(rhs.extent.width) && rhs.offset.x < lhs.offset.x + static_cast<int64_t>(lhs.extent.width)
+			&& lhs.offset.y < rhs.offset.y + static_cast<int64_t>(rhs.extent.height) && rhs.offset.y < lhs.offset.y + static_cast<int64_t>(lhs.extent.height);
+	}
+}
+
+namespace rapid
+{
+	RetainedLayer::RetainedLayer(GraphicsEngine& engine, Window& window, TextureRegistry& textureRegistry)
+		: m_Engine(engine), m_Window(window), m_TextureRegistry(textureRegistry)
+	{
+		// Every frame in flight uploads to its own buffers.
+		for (uint32_t i = 0; i < m_Window.frameCount(); i++)
+		{
+			m_VertexBuffers.emplace_back(std::make_unique<Buffer>(m_Engine, GetBufferSize(0, sizeof(ImDrawVert)), BufferType::ShallowVertex));
+			m_IndexBuffers.emplace_back(std::make_unique<Buffer>(m_Engine, GetBufferSize(0, sizeof(ImDrawIdx)), BufferType::ShallowIndex));
+		}
+	}
+
+	RetainedLayer::~RetainedLayer()
+	{
+		if (m_Target.m_TextureID)
+			m_TextureRegistry.unregisterTexture(m_Target.m_TextureID);
+
+		for (auto& target : m_PendingRetiredTargets)
+		{
+			if (target.m_TextureID)
+				m_TextureRegistry.unregisterTexture(target.m_TextureID);
+		}
+
+		for (auto& retired : m_RetiredTargets)
+		{
+			if (retired.m_Target.m_TextureID)
+				m_TextureRegistry.unregisterTexture(retired.m_Target.m_TextureID);
+		}
+
+		for (const auto& pBuffer : m_VertexBuffers)
+			pBuffer->terminate();
+
+		for (const auto& pBuffer : m_IndexBuffers)
+			pBuffer->terminate();
+	}
+
+	void RetainedLayer::submit(ImDrawList& drawList, ImVec2 minimum, ImVec2 maximum, ImVec2 scroll, ImU32 backgroundColor, const std::vector<ImVec4>& dirtyAreas, const std::vector<ImVec4>& culledAreas)
+	{
+		const ImVec2 origin = { std::floor(minimum.x), std::floor(minimum.y) };
+		const VkExtent2D extent = {
+			static_cast<uint32_t>(std::max(std::ceil(maximum.x) - origin.x, 0.0f)),
+			static_cast<uint32_t>(std::max(std::ceil(maximum.y) - origin.y, 0.0f))
+		};
+
+		if (extent.width == 0 || extent.height == 0)
+			return;
+
+		if (extent.width != m_Extent.width || extent.height != m_Extent.height)
+		{
+			m_Extent = extent;
+			recreateTarget();
+		}
+
+		// The captured vertices are in screen space, so moving the layer moves everything.
+		if (origin.x != m_Origin.x || origin.y != m_Origin.y)
+		{
+			m_Origin = origin;
+			m_IsValid = false;
+		}
+
+		// The cached contents are stale if any of the textures used to draw them changed.
+		for (const auto& [textureID, version] : m_TextureVersions)
+		{
+			if (m_TextureRegistry.getVersion(textureID) != version)
+				m_IsValid = false;
+		}
+
+		// Draw callbacks can change without the draw list changing, so they're checked the same way.
+		for (const auto& [pDrawCallback, version] : m_CallbackVersions)
+		{
+			if (pDrawCallback->getVersion() != version)
+				m_IsValid = false;
+		}
+
+		const ImVec4 color = ImGui::ColorConvertU32ToFloat4(backgroundColor);
+		m_BackgroundColor = VkClearColorValue{ .float32 = { color.x, color.y, color.z, 1.0f } };
+
+		const ImVec2 delta = { scroll.x - m_Scroll.x, scroll.y - m_Scroll.y };
+		m_Scroll = scroll;
+
+		if (!m_IsValid)
+		{
+			m_DirtyAreas.clear();
+			m_ShouldShift = false;
+			addDirtyArea(VkRect2D{ .offset = {}, .extent = m_Extent });
+		}
+		else if (delta.x != 0.0f || delta.y != 0.0f)
+		{
+			const auto width = static_cast<float>(m_Extent.width);
+			const auto height = static_cast<float>(m_Extent.height);
+
+			// The contents can only be shifted by whole pixels, and only once per recorded frame.
+			if (m_ShouldShift || delta.x != std::round(delta.x) || delta.y != std::round(delta.y) || std::abs(delta.x) >= width || std::abs(delta.y) >= height)
+			{
+				m_DirtyAreas.clear();
+				m_ShouldShift = false;
+				addDirtyArea(VkRect2D{ .offset = {}, .extent = m_Extent });
+			}
+			else
+			{
+				m_ShiftOffset = { static_cast<int32_t>(delta.x), static_cast<int32_t>(delta.y) };
+				m_ShouldShift = true;
+
+				// The previous dirty areas move with the contents.
+				for (auto& area : m_DirtyAreas)
+				{
+					area.offset.x += m_ShiftOffset.x;
+					area.offset.y += m_ShiftOffset.y;
+				}
+
+				// Redraw the strips which were scrolled into view.
+				const auto shiftX = static_cast<uint32_t>(std::abs(m_ShiftOffset.x));
+				const auto shiftY = static_cast<uint32_t>(std::abs(m_ShiftOffset.y));
+
+				if (shiftX > 0)
+					addDirtyArea(VkRect2D{ .offset = { m_ShiftOffset.x > 0 ? 0 : static_cast<int32_t>(m_Extent.width - shiftX), 0 }, .extent = { shiftX, m_Extent.height } });
+
+				if (shiftY > 0)
+					addDirtyArea(VkRect2D{ .offset = { 0, m_ShiftOffset.y > 0 ? 0 : static_cast<int32_t>(m_Extent.height - shiftY) }, .extent = { m_Extent.width, shiftY } });
+			}
+		}
+
+		for (const auto& area : dirtyAreas)
+			addDirtyArea(ToTargetRect(area, m_Origin));
+
+		// The culled contents can't be redrawn, so keep showing the cached image and redraw everything once they're back.
+		const auto isCulled = [this](const ImVec4& area)
+		{
+			const auto rect = ToTargetRect(area, m_Origin);
+			return std::any_of(m_DirtyAreas.begin(), m_DirtyAreas.end(), [&rect](const VkRect2D& dirtyArea) { return IsOverlapping(dirtyArea, rect); });
+		};
+
+		if (std::any_of(culledAreas.begin(), culledAreas.end(), isCulled))
+		{
+			m_DirtyAreas.clear();
+			m_ShouldShift = false;
+			m_IsValid = false;
+		}
+
+		if (!m_DirtyAreas.empty())
+		{
+			if (!capture(drawList))
+			{
+				m_DirtyAreas.clear();
+				m_ShouldShift = false;
+				m_IsValid = false;
+				return;
+			}
+
+			// The contents are up to date once the frame is rendered.
+			m_IsValid = true;
+		}
+
+		// Replace the draw list with the cached image. The image is clipped the same way as the contents were.
+		const ImVec2 imageMaximum = { origin.x + m_Extent.width, origin.y + m_Extent.height };
+
+		ImVec4 clipRect = { imageMaximum.x, imageMaximum.y, origin.x, origin.y };
+		for (const auto& command : drawList.CmdBuffer)
+		{
+			clipRect.x = std::min(clipRect.x, command.ClipRect.x);
+			clipRect.y = std::min(clipRect.y, command.ClipRect.y);
+			clipRect.z = std::max(clipRect.z, command.ClipRect.z);
+			clipRect.w = std::max(clipRect.w, command.ClipRect.w);
+		}
+
+		if (clipRect.z <= clipRect.x || clipRect.w <= clipRect.y)
+			clipRect = { origin.x, origin.y, imageMaximum.x, imageMaximum.y };
+
+		drawList._ResetForNewFrame();
+		drawList.PushClipRect(ImVec2(clipRect.x, clipRect.y), ImVec2(clipRect.z, clipRect.w));
+		drawList.AddImage(m_Target.m_TextureID, origin, imageMaximum);
+		drawList.PopClipRect();
+	}
+
+	void RetainedLayer::swapFrame()
+	{
+		m_pFrameTarget = m_Target.m_RenderTarget.get();
+		m_FrameTextureID = m_Target.m_TextureID;
+
+		// The retired targets could still be used by the frames in flight.
+		for (auto& target : m_PendingRetiredTargets)
+		{
+			m_RetiredTargets.emplace_back(RetiredTarget{
+				.m_Target = std::move(target),
+				.m_DestroyFrame = m_FrameNumber + m_Window.frameCount()
+				}
+			);
+		}
+
+		m_PendingRetiredTargets.clear();
+
+		if (m_DirtyAreas.empty())
+			return;
+
+		m_PendingFrame.m_DirtyAreas = std::move(m_DirtyAreas);
+		m_PendingFrame.m_Extent = m_Extent;
+		m_PendingFrame.m_ShiftOffset = m_ShiftOffset;
+		m_PendingFrame.m_Origin = m_Origin;
+		m_PendingFrame.m_BackgroundColor = m_BackgroundColor;
+		m_PendingFrame.m_ShouldShift = m_ShouldShift;
+		std::swap(m_Frame, m_PendingFrame);
+
+		m_DirtyAreas.clear();
+		m_ShouldShift = false;
+
+		// Everything drawing the cached image needs to be redrawn.
+		m_TextureRegistry.invalidate(m_FrameTextureID);
+	}
+
+	std::optional<RenderGraph::ResourceID> RetainedLayer::addPasses(RenderGraph& graph, uint32_t frameIndex, std::function<void(CommandBuffer, const VkRect2D&)> drawFunction)
+	{
+		m_FrameNumber++;
+
+		// Destroy the retired targets which are no longer used by any frame.
+		std::erase_if(m_RetiredTargets, [this](RetiredTarget& retired)
+			{
+				if (retired.m_DestroyFrame > m_FrameNumber)
+					return false;
+
+				if (retired.m_Target.m_TextureID)
+					m_TextureRegistry.unregisterTexture(retired.m_Target.m_TextureID);
+
+				retired.m_Target.m_RenderTarget->terminate();
+				return true;
+			}
+		);
+
+		if (!m_pFrameTarget)
+			return std::nullopt;
+
+		auto& target = *m_pFrameTarget;
+		const auto targetResource = graph.importImage("Retained Layer", target.getImage());
+
+		if (m_Frame.m_DirtyAreas.empty())
+			return targetResource;
+
+		// The frame's previous submission is done, so its buffers can be written to (or replaced) right away.
+		auto& pVertexBuffer = m_VertexBuffers[frameIndex];
+		auto& pIndexBuffer = m_IndexBuffers[frameIndex];
+		const auto vertexCount = static_cast<uint64_t>(m_Frame.m_Vertices.size());
+		const auto indexCount = static_cast<uint64_t>(m_Frame.m_Indices.size());
+
+		if (pVertexBuffer->size() < vertexCount * sizeof(ImDrawVert))
+		{
+			pVertexBuffer->terminate();
+			pVertexBuffer = std::make_unique<Buffer>(m_Engine, GetBufferSize(vertexCount, sizeof(ImDrawVert)), BufferType::ShallowVertex);
+		}
+
+		if (pIndexBuffer->size() < indexCount * sizeof(ImDrawIdx))
+		{
+			pIndexBuffer->terminate();
+			pIndexBuffer = std::make_unique<Buffer>(m_Engine, GetBufferSize(indexCount, sizeof(ImDrawIdx)), BufferType::ShallowIndex);
+		}
+
+		StreamingCopy(pVertexBuffer->mapMemory(), m_Frame.m_Vertices.data(), vertexCount * sizeof(ImDrawVert));
+		pVertexBuffer->unmapMemory();
+
+		StreamingCopy(pIndexBuffer->mapMemory(), m_Frame.m_Indices.data(), indexCount * sizeof(ImDrawIdx));
+		pIndexBuffer->unmapMemory();
+
+		m_pVertexBuffer = pVertexBuffer.get();
+		m_pIndexBuffer = pIndexBuffer.get();
+
+		const auto extent = m_Frame.m_Extent;
+		const auto shiftOffset = m_Frame.m_ShiftOffset;
+
+		// Move the contents which stay visible through a transient image. The exposed strips are redrawn afterwards. The
+		// transient image has the size of the target, so it stays the same from frame to frame.
+		if (m_Frame.m_ShouldShift)
+		{
+			const VkExtent2D shiftExtent = { extent.width - static_cast<uint32_t>(std::abs(shiftOffset.x)), extent.height - static_cast<uint32_t>(std::abs(shiftOffset.y)) };
+			const VkOffset2D sourceOffset = { std::max(-shiftOffset.x, 0), std::max(-shiftOffset.y, 0) };
+			const VkOffset2D destinationOffset = { std::max(shiftOffset.x, 0), std::max(shiftOffset.y, 0) };
+
+			const auto scratchResource = graph.createImage("Retained Layer Shift", extent, target.getImage().format(), VK_IMAGE_USAGE_TRANSFER_SRC_BIT | VK_IMAGE_USAGE_TRANSFER_DST_BIT);
+
+			graph.addPass("Retained Layer Shift Save", [scratchResource, targetResource](RenderGraph::PassBuilder& builder)
+				{
+					builder.read(targetResource, ResourceUsage::TransferSource);
+					builder.write(scratchResource, ResourceUsage::TransferDestination);
+				},
+				[this, &graph, &target, scratchResource, copy = GetImageCopy(sourceOffset, {}, shiftExtent)](CommandBuffer commandBuffer)
+				{
+					m_Engine.getDeviceTable().vkCmdCopyImage(commandBuffer.buffer(), target.getImage().getImage(), VK_IMAGE_LAYOUT_TRANSFER_SRC_OPTIMAL, graph.getImage(scratchResource), VK_IMAGE_LAYOUT_TRANSFER_DST_OPTIMAL, 1, &copy);
+				}
+			);
+
+			graph.addPass("Retained Layer Shift", [scratchResource, targetResource](RenderGraph::PassBuilder& builder)
+				{
+					builder.read(scratchResource, ResourceUsage::TransferSource);
+					builder.write(targetResource, ResourceUsage::TransferDestination);
+				},
+				[this, &graph, &target, scratchResource, copy = GetImageCopy({}, destinationOffset, shiftExtent)](CommandBuffer commandBuffer)
+				{
+					m_Engine.getDeviceTable().vkCmdCopyImage(commandBuffer.buffer(), graph.getImage(scratchResource), VK_IMAGE_LAYOUT_TRANSFER_SRC_OPTIMAL, target.getImage().getImage(), VK_IMAGE_LAYOUT_TRANSFER_DST_OPTIMAL, 1, &copy);
+				}
+			);
+		}
+
+		graph.addPass("Retained Layer", [targetResource](RenderGraph::PassBuilder& builder) { builder.write(targetResource, ResourceUsage::ColorAttachment); },
+			[this, &target, dirtyAreas = m_Frame.m_DirtyAreas, backgroundColor = m_Frame.m_BackgroundColor, drawFunction = std::move(drawFunction)](CommandBuffer commandBuffer)
+			{
+				const auto vCommandBuffer = commandBuffer.buffer();
+
+				VkRect2D renderArea = {};
+				for (const auto& area : dirtyAreas)
+					renderArea = utility::Combine(renderArea, area);
+
+				target.begin(vCommandBuffer, renderArea);
+
+				// The blending needs a clean background, so clear the dirty areas before drawing.
+				const VkClearAttachment clearAttachment = {
+					.aspectMask = VK_IMAGE_ASPECT_COLOR_BIT,
+					.colorAttachment = 0,
+					.clearValue = {.color = backgroundColor }
+				};
+
+				for (const auto& area : dirtyAreas)
+				{
+					const VkClearRect clearRect = { .rect = area, .baseArrayLayer = 0, .layerCount = 1 };
+					m_Engine.getDeviceTable().vkCmdClearAttachments(vCommandBuffer, 1, &clearAttachment, 1, &clearRect);
+					drawFunction(commandBuffer, area);
+				}
+
+				target.end(vCommandBuffer);
+			}
+		);
+
+		// Writing to an imported image keeps the passes from being culled, so the contents are up to date after this frame.
+		m_Frame.m_DirtyAreas.clear();
+		m_Frame.m_ShouldShift = false;
+
+		return targetResource;
+	}
+
+	void RetainedLayer::recreateTarget()
+	{
+		if (m_Target.m_RenderTarget)
+			retireTarget(m_Target);
+
+		m_Target.m_RenderTarget = std::make_unique<RenderTarget>(m_Engine, m_Window, m_Extent);
+		m_Target.m_TextureID = m_TextureRegistry.registerTexture(m_Target.m_RenderTarget->getImage());
+
+		m_IsValid = false;
+	}
+
+	void RetainedLayer::retireTarget(Target& target)
+	{
+		m_PendingRetiredTargets.emplace_back(std::move(target));
+		target = Target{};
+	}
+
+	void RetainedLayer::addDirtyArea(VkRect2D area)
+	{
+		area = utility::Intersect(area, VkRect2D{ .offset = {}, .extent = m_Extent });
+		if (utility::IsEmpty(area))
+			return;
+
+		m_DirtyAreas.emplace_back(area);
+
+		if (m_DirtyAreas.size() > MaximumDirtyAreaCount)
+		{
+			VkRect2D combined = {};
+			for (const auto& dirtyArea : m_DirtyAreas)
+				combined = utility::Combine(combined, dirtyArea);
+
+			m_DirtyAreas = { combined };
+		}
+	}
+
+	bool RetainedLayer::capture(const ImDrawList& drawList)
+	{
+		// Only draw callbacks can be replayed when redrawing, other callbacks expect to be called by ImGui.
+		for (const auto& command : drawList.CmdBuffer)
+		{
+			if (command.UserCallback && !DrawCallback::Get(command))
+				return false;
+		}
+
+		// The render thread uploads the geometry to the buffers of the frame it's recorded in.
+		m_PendingFrame.m_Vertices.assign(drawList.VtxBuffer.begin(), drawList.VtxBuffer.end());
+		m_PendingFrame.m_Indices.assign(drawList.IdxBuffer.begin(), drawList.IdxBuffer.end());
+
+		// Move the clip rects to the target's space, and remember the texture and callback versions to know when to redraw.
+		m_PendingFrame.m_Commands.clear();
+		m_TextureVersions.clear();
+		m_CallbackVersions.clear();
+		for (const auto& command : drawList.CmdBuffer)
+		{
+			const auto pDrawCallback = DrawCallback::Get(command);
+			if (command.ElemCount == 0 && !pDrawCallback)
+				continue;
+
+			auto& captured = m_PendingFrame.m_Commands.emplace_back(command);
+			captured.ClipRect = ImVec4(command.ClipRect.x - m_Origin.x, command.ClipRect.y - m_Origin.y, command.ClipRect.z - m_Origin.x, command.ClipRect.w - m_Origin.y);
+
+			if (pDrawCallback)
+			{
+				m_CallbackVersions.emplace_back(pDrawCallback, pDrawCallback->getVersion());
+				continue;
+			}
+
+			if (std::none_of(m_TextureVersions.begin(), m_TextureVersions.end(), [&command](const auto& entry) { return entry.first == command.TextureId; }))
+				m_TextureVersions.emplace_back(command.TextureId, m_TextureRegistry.getVersion(command.TextureId));
+		}
+
+		return true;
+	}
+}
@@ -0,0 +1,244 @@
+// Copyright (c) 2022 Dhiraj Wishal
+
+#pragma once
+
+#include "RenderTarget.hpp"
+#include "RenderGraph.hpp"
+#include "TextureRegistry.hpp"
+#include "Buffer.hpp"
+#include "DrawCallback.hpp"
+
+#include <functional>
+#include <optional>
+
+namespace rapid
+{
+	/**
+	 * Retained layer class.
+	 * This caches the contents of an ImGui draw list in a render target, and replaces the draw list with a single image. The
+	 * cached contents are only redrawn in the areas which are marked as dirty, so a large and mostly static area (like the
+	 * node canvas) doesn't need to be redrawn every frame.
+	 *
+	 * Scrolling by whole pixels is handled by shifting the cached contents, so only the exposed strips need to be redrawn.
+	 * An image can't be copied onto itself when the areas overlap, so the contents are moved through a transient image of
+	 * the frame's render graph.
+	 *
+	 * The draw lists are captured on the UI thread, and the captured frame is handed over to the render thread with
+	 * swapFrame(), which uploads it to the buffers of the frame being recorded.
+	 */
+	class RetainedLayer final
+	{
+	public:
+		/**
+		 * Explicit constructor.
+		 *
+		 * @param engine The graphics engine.
+		 * @param window The window the layer is rendered to.
+		 * @param textureRegistry The registry to register the targets in.
+		 */
+		explicit RetainedLayer(GraphicsEngine& engine, Window& window, TextureRegistry& textureRegistry);
+
+		/**
+		 * Destructor.
+		 */
+		~RetainedLayer();
+
+		RetainedLayer(const RetainedLayer&) = delete;
+		RetainedLayer& operator=(const RetainedLayer&) = delete;
+
+		/**
+		 * Submit the draw list.
+		 * The geometry of the draw list is captured on the CPU if any part of the layer needs to be redrawn, and the draw
+		 * list is replaced with the cached image. This needs to be called after the draw list is complete, and before ImGui::Render().
+		 *
+		 * Draw lists with user callbacks (other than draw callbacks) cannot be cached, so they are left as they are.
+		 *
+		 * @param drawList The draw list to cache.
+		 * @param minimum The top left corner of the layer in screen space.
+		 * @param maximum The bottom right corner of the layer in screen space.
+		 * @param scroll The scroll position of the contents. Changes to this are handled by shifting the cached contents.
+		 * @param backgroundColor The color to clear the redrawn areas with.
+		 * @param dirtyAreas The areas which changed since the last frame, in screen space (minimum x, minimum y, maximum x, maximum y).
+		 * @param culledAreas The areas whose contents were left out of the draw list because they were expected to be cached.
+		 * If any of them needs to be redrawn, the cached image is kept for this frame and everything is redrawn on the next one.
+		 */
+		void submit(ImDrawList& drawList, ImVec2 minimum, ImVec2 maximum, ImVec2 scroll, ImU32 backgroundColor, const std::vector<ImVec4>& dirtyAreas, const std::vector<ImVec4>& culledAreas = {});
+
+		/**
+		 * Invalidate the cached contents.
+		 * Everything is redrawn on the next submit.
+		 */
+		void invalidate() { m_IsValid = false; }
+
+		/**
+		 * Check if the cached contents are valid.
+		 * Contents can only be culled from the draw list while this is true.
+		 *
+		 * @return Whether or not the cached contents are valid.
+		 */
+		bool isValid() const { return m_IsValid; }
+
+		/**
+		 * Hand the captured frame over to the render thread.
+		 * This needs to be called on the render thread while the UI thread waits. Nothing is handed over if nothing needs
+		 * to be redrawn.
+		 */
+		void swapFrame();
+
+		/**
+		 * Add the passes which update the cached contents.
+		 * The cached image is imported to the graph even if nothing needs to be redrawn, so passes which sample it can read it.
+		 * The captured geometry is uploaded to the buffers of the frame when anything needs to be redrawn.
+		 *
+		 * @param graph The frame's render graph.
+		 * @param frameIndex The index of the frame which is being recorded.
+		 * @param drawFunction The function which draws the captured commands to the given area of the bound target.
+		 * @return The resource ID of the cached image. This is empty if the layer has no image yet.
+		 */
+		std::optional<RenderGraph::ResourceID> addPasses(RenderGraph& graph, uint32_t frameIndex, std::function<void(CommandBuffer, const VkRect2D&)> drawFunction);
+
+		/**
+		 * Get the captured draw commands.
+		 * The clip rects are in the target's space.
+		 *
+		 * @return The draw commands.
+		 */
+		const std::vector<ImDrawCmd>& getCommands() const { return m_Frame.m_Commands; }
+
+		/**
+		 * Get the vertex buffer which holds the captured vertices.
+		 *
+		 * @return The vertex buffer.
+		 */
+		const Buffer& getVertexBuffer() const { return *m_pVertexBuffer; }
+
+		/**
+		 * Get the index buffer which holds the captured indices.
+		 *
+		 * @return The index buffer.
+		 */
+		const Buffer& getIndexBuffer() const { return *m_pIndexBuffer; }
+
+		/**
+		 * Get the origin of the layer.
+		 * The captured vertices are in screen space, so this needs to be subtracted from them when drawing to the target.
+		 *
+		 * @return The origin in screen space.
+		 */
+		ImVec2 getOrigin() const { return m_Frame.m_Origin; }
+
+		/**
+		 * Get the extent of the layer.
+		 *
+		 * @return The extent.
+		 */
+		VkExtent2D extent() const { return m_Frame.m_Extent; }
+
+	private:
+		/**
+		 * Layer target structure.
+		 */
+		struct Target final
+		{
+			std::unique_ptr<RenderTarget> m_RenderTarget = nullptr;
+			ImTextureID m_TextureID = nullptr;
+		};
+
+		/**
+		 * Layer frame structure.
+		 * This holds everything needed to redraw the dirty areas of a frame.
+		 */
+		struct Frame final
+		{
+			std::vector<ImDrawCmd> m_Commands = {};
+			std::vector<ImDrawVert> m_Vertices = {};
+			std::vector<ImDrawIdx> m_Indices = {};
+			std::vector<VkRect2D> m_DirtyAreas = {};
+
+			VkExtent2D m_Extent = {};
+			VkOffset2D m_ShiftOffset = {};
+			ImVec2 m_Origin = {};
+
+			VkClearColorValue m_BackgroundColor = {};
+
+			bool m_ShouldShift = false;
+		};
+
+		/**
+		 * Retired target structure.
+		 * The target could be used by frames in flight, so it's destroyed a few frames later.
+		 */
+		struct RetiredTarget final
+		{
+			Target m_Target = {};
+			uint64_t m_DestroyFrame = 0;
+		};
+
+		/**
+		 * Recreate the target using the current extent.
+		 */
+		void recreateTarget();
+
+		/**
+		 * Retire a target.
+		 * The target is handed over to the render thread with the next frame, which destroys it once no frame uses it.
+		 *
+		 * @param target The target to retire.
+		 */
+		void retireTarget(Target& target);
+
+		/**
+		 * Add a dirty area.
+		 * The area is clamped to the target, and the areas are merged if there are too many of them.
+		 *
+		 * @param area The area in the target's space.
+		 */
+		void addDirtyArea(VkRect2D area);
+
+		/**
+		 * Capture the geometry of a draw list to the pending frame.
+		 *
+		 * @param drawList The draw list.
+		 * @return Whether or not the geometry was captured.
+		 */
+		bool capture(const ImDrawList& drawList);
+
+	private:
+		GraphicsEngine& m_Engine;
+		Window& m_Window;
+		TextureRegistry& m_TextureRegistry;
+
+		// Built on the UI thread.
+		Target m_Target = {};
+		std::vector<Target> m_PendingRetiredTargets = {};
+
+		Frame m_PendingFrame = {};
+		std::vector<std::pair<ImTextureID, uint64_t>> m_TextureVersions = {};
+		std::vector<std::pair<DrawCallback*, uint64_t>> m_CallbackVersions = {};
+		std::vector<VkRect2D> m_DirtyAreas = {};
+
+		VkExtent2D m_Extent = {};
+		VkOffset2D m_ShiftOffset = {};
+		ImVec2 m_Origin = {};
+		ImVec2 m_Scroll = {};
+
+		VkClearColorValue m_BackgroundColor = {};
+
+		bool m_IsValid = false;
+		bool m_ShouldShift = false;
+
+		// Drawn on the render thread.
+		Frame m_Frame = {};
+		std::vector<RetiredTarget> m_RetiredTargets = {};
+
+		std::vector<std::unique_ptr<Buffer>> m_VertexBuffers = {};
+		std::vector<std::unique_ptr<Buffer>> m_IndexBuffers = {};
+
+		RenderTarget* m_pFrameTarget = nullptr;
+		Buffer* m_pVertexBuffer = nullptr;
+		Buffer* m_pIndexBuffer = nullptr;
+
+		ImTextureID m_FrameTextureID = nullptr;
+		uint64_t m_FrameNumber = 0;
+	};
+}
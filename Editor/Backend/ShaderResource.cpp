@@ -4,39 +4,11 @@
 
 namespace rapid
 {
-	ShaderResource::ShaderResource(GraphicsEngine& engine, VkDescriptorSetLayout layout, VkDescriptorSet set)
-		: m_Engine(engine), m_vDescriptorSetLayout(layout), m_DescriptorSet(set)
+	ShaderResource::ShaderResource(GraphicsEngine& engine, VkDescriptorSetLayout layout, VkDescriptorPool pool, VkDescriptorSet set)
+		: m_Engine(engine), m_vDescriptorSetLayout(layout), m_DescriptorPool(pool), m_DescriptorSet(set)
 	{
 	}
 
-	void ShaderResource::update(VkDescriptorSet set)
-	{
-		std::vector<VkCopyDescriptorSet> vCopies;
-		vCopies.reserve(m_Bindings.size());
-
-		VkCopyDescriptorSet copyDescriptorSet = {
-			.sType = VK_STRUCTURE_TYPE_COPY_DESCRIPTOR_SET,
-			.pNext = nullptr,
-			.srcSet = m_DescriptorSet,
-			.srcArrayElement = 0,
-			.dstSet = set,
-			.dstArrayElement = 0,
-			.descriptorCount = 1
-		};
-
-		// Iterate through the bindings and setup the copy info.
-		for (const auto binding : m_Bindings)
-		{
-			copyDescriptorSet.dstBinding = binding;
-			copyDescriptorSet.srcBinding = binding;
-
-			vCopies.emplace_back(copyDescriptorSet);
-		}
-
-		m_Engine.getDeviceTable().vkUpdateDescriptorSets(m_Engine.getLogicalDevice(), 0, nullptr, static_cast<uint32_t>(vCopies.size()), vCopies.data());
-		m_DescriptorSet = set;
-	}
-
 	void ShaderResource::bindResource(uint32_t location, const Buffer& buffer)
 	{
 		VkDescriptorBufferInfo bufferInfo = {
@@ -59,7 +31,6 @@ namespace rapid
 		};
 
 		m_Engine.getDeviceTable().vkUpdateDescriptorSets(m_Engine.getLogicalDevice(), 1, &writeDescriptorSet, 0, nullptr);
-		m_Bindings.insert(location);
 	}
 
 	void ShaderResource::bindResource(uint32_t location, const Image& image)
@@ -84,6 +55,5 @@ namespace rapid
 		};
 
 		m_Engine.getDeviceTable().vkUpdateDescriptorSets(m_Engine.getLogicalDevice(), 1, &writeDescriptorSet, 0, nullptr);
-		m_Bindings.insert(location);
 	}
 }
\ No newline at end of file
@@ -3,7 +3,6 @@
 #pragma once
 
 #include "Image.hpp"
-#include <set>
 
 namespace rapid
 {
@@ -19,19 +18,10 @@ namespace rapid
 		 *
 		 * @param engine The engine reference.
 		 * @param layout The descriptor set layout.
+		 * @param pool The descriptor pool the set was allocated from.
 		 * @param set The descriptor set.
 		 */
-		explicit ShaderResource(GraphicsEngine& engine, VkDescriptorSetLayout layout, VkDescriptorSet set);
-
-		/**
-		 * Update the descriptor pool and the descriptor set.
-		 * This method is called by the graphics pipeline when a new shader resource object is made.
-		 *
-		 * This will copy all the existing descriptor data to the new set.
-		 *
-		 * @param set The new descriptor set.
-		 */
-		void update(VkDescriptorSet set);
+		explicit ShaderResource(GraphicsEngine& engine, VkDescriptorSetLayout layout, VkDescriptorPool pool, VkDescriptorSet set);
 
 		/**
 		 * Bind a buffer to the given location.
@@ -56,12 +46,18 @@ namespace rapid
 		 */
 		VkDescriptorSet getDescriptorSet() const { return m_DescriptorSet; }
 
-	private:
-		std::set<uint32_t> m_Bindings;
+		/**
+		 * Get the descriptor pool the set was allocated from.
+		 *
+		 * @return The descriptor pool.
+		 */
+		VkDescriptorPool getDescriptorPool() const { return m_DescriptorPool; }
 
+	private:
 		GraphicsEngine& m_Engine;
 
 		const VkDescriptorSetLayout m_vDescriptorSetLayout;
-		VkDescriptorSet m_DescriptorSet = VK_NULL_HANDLE;
+		const VkDescriptorPool m_DescriptorPool;
+		const VkDescriptorSet m_DescriptorSet;
 	};
 }
\ No newline at end of file
@@ -0,0 +1,227 @@
+// Copyright (c) 2022 Dhiraj Wishal
+
+#include "SoftwareRenderer.hpp"
+
+#include <spdlog/spdlog.h>
+
+#define STB_IMAGE_WRITE_IMPLEMENTATION
+#include <stb_image_write.h>
+
+#include <algorithm>
+#include <latch>
+
+namespace
+{
+	/**
+	 * The width and height of a tile in pixels.
+	 * A 64x64 tile of RGBA8 pixels is 16 KiB, which fits in the L1 cache of most CPUs.
+	 */
+	constexpr int32_t TileSize = 64;
+
+	/**
+	 * The texture used for textures which are not registered.
+	 */
+	constexpr uint32_t WhitePixel = 0xFFFFFFFF;
+
+	// The rasterizer expects ImGui's default color layout.
+	static_assert(IM_COL32_R_SHIFT == 0 && IM_COL32_A_SHIFT == 24, "The software renderer needs RGBA packed colors.");
+
+	/**
+	 * Convert an ImGui vertex to framebuffer space.
+	 *
+	 * @param vertex The vertex.
+	 * @param offset The display position.
+	 * @param scale The framebuffer scale.
+	 * @return The raster vertex.
+	 */
+	rapid::RasterVertex ToRasterVertex(const ImDrawVert& vertex, ImVec2 offset, ImVec2 scale)
+	{
+		return rapid::RasterVertex{
+			.m_X = (vertex.pos.x - offset.x) * scale.x,
+			.m_Y = (vertex.pos.y - offset.y) * scale.y,
+			.m_U = vertex.uv.x,
+			.m_V = vertex.uv.y,
+			.m_Color = vertex.col
+		};
+	}
+}
+
+namespace rapid
+{
+	SoftwareRenderer::SoftwareRenderer()
+		: m_ThreadPool(GetSharedThreadPool())
+	{
+		// The first texture is used for the textures which are not registered.
+		m_Textures.emplace_back(Texture{ .m_Image = RasterTexture{.m_pPixels = &WhitePixel, .m_Width = 1, .m_Height = 1 } });
+
+		auto& imGuiIO = ImGui::GetIO();
+		unsigned char* pPixels = nullptr;
+		int32_t width = 0, height = 0;
+		imGuiIO.Fonts->GetTexDataAsRGBA32(&pPixels, &width, &height);
+		registerTexture(imGuiIO.Fonts->TexID, reinterpret_cast<const uint32_t*>(pPixels), static_cast<uint32_t>(width), static_cast<uint32_t>(height));
+
+		spdlog::info("Software renderer is using the {} span kernel with {} worker threads.", GetSpanKernel().m_pName, m_ThreadPool.threadCount());
+	}
+
+	void SoftwareRenderer::registerTexture(ImTextureID textureID, const uint32_t* pPixels, uint32_t width, uint32_t height)
+	{
+		const auto itr = std::find_if(m_Textures.begin() + 1, m_Textures.end(), [textureID](const Texture& texture) { return texture.m_TextureID == textureID; });
+		const auto texture = Texture{ .m_TextureID = textureID, .m_Image = RasterTexture{.m_pPixels = pPixels, .m_Width = width, .m_Height = height } };
+
+		if (itr != m_Textures.end())
+			*itr = texture;
+
+		else
+			m_Textures.emplace_back(texture);
+	}
+
+	void SoftwareRenderer::render(const ImDrawData& drawData, ImU32 clearColor)
+	{
+		const auto width = static_cast<uint32_t>(std::max(drawData.DisplaySize.x * drawData.FramebufferScale.x, 0.0f));
+		const auto height = static_cast<uint32_t>(std::max(drawData.DisplaySize.y * drawData.FramebufferScale.y, 0.0f));
+
+		if (width != m_Width || height != m_Height)
+		{
+			m_Width = width;
+			m_Height = height;
+			m_TileCountX = (width + TileSize - 1) / TileSize;
+			m_TileCountY = (height + TileSize - 1) / TileSize;
+
+			m_Pixels.resize(static_cast<size_t>(width) * height);
+			m_TileTriangles.resize(static_cast<size_t>(m_TileCountX) * m_TileCountY);
+		}
+
+		if (m_TileTriangles.empty())
+			return;
+
+		setupTriangles(drawData);
+
+		// The calling thread rasterizes tiles as well, so there's no need for more workers than the remaining tiles.
+		const auto tileCount = static_cast<uint32_t>(m_TileTriangles.size());
+		const auto workerCount = std::min(m_ThreadPool.threadCount(), tileCount - 1);
+
+		m_NextTile = 0;
+		auto latch = std::latch(workerCount);
+		for (uint32_t i = 0; i < workerCount; i++)
+		{
+			m_ThreadPool.submit([this, &latch, clearColor]
+				{
+					rasterizeTiles(clearColor);
+					latch.count_down();
+				});
+		}
+
+		rasterizeTiles(clearColor);
+		latch.wait();
+	}
+
+	bool SoftwareRenderer::save(const std::filesystem::path& file) const
+	{
+		if (m_Pixels.empty())
+			return false;
+
+		if (stbi_write_png(file.string().c_str(), m_Width, m_Height, 4, m_Pixels.data(), m_Width * sizeof(uint32_t)) == 0)
+		{
+			spdlog::warn("Failed to save the software rendered image to {}.", file.string());
+			return false;
+		}
+
+		return true;
+	}
+
+	void SoftwareRenderer::setupTriangles(const ImDrawData& drawData)
+	{
+		m_Triangles.clear();
+		for (auto& tileTriangles : m_TileTriangles)
+			tileTriangles.clear();
+
+		const auto width = static_cast<int32_t>(m_Width);
+		const auto height = static_cast<int32_t>(m_Height);
+		const auto offset = drawData.DisplayPos;
+		const auto scale = drawData.FramebufferScale;
+
+		for (int32_t listIndex = 0; listIndex < drawData.CmdListsCount; listIndex++)
+		{
+			const auto pCommandList = drawData.CmdLists[listIndex];
+
+			for (const auto& command : pCommandList->CmdBuffer)
+			{
+				// Draw callbacks (and render state resets) need the GPU.
+				if (command.UserCallback)
+					continue;
+
+				auto bounds = RasterTriangle{
+					.m_MinX = std::max(static_cast<int32_t>((command.ClipRect.x - offset.x) * scale.x), 0),
+					.m_MinY = std::max(static_cast<int32_t>((command.ClipRect.y - offset.y) * scale.y), 0),
+					.m_MaxX = std::min(static_cast<int32_t>((command.ClipRect.z - offset.x) * scale.x), width),
+					.m_MaxY = std::min(static_cast<int32_t>((command.ClipRect.w - offset.y) * scale.y), height)
+				};
+
+				if (bounds.m_MinX >= bounds.m_MaxX || bounds.m_MinY >= bounds.m_MaxY)
+					continue;
+
+				const auto itr = std::find_if(m_Textures.begin() + 1, m_Textures.end(), [&command](const Texture& texture) { return texture.m_TextureID == command.TextureId; });
+				bounds.m_TextureIndex = itr == m_Textures.end() ? 0 : static_cast<uint32_t>(itr - m_Textures.begin());
+
+				const auto pIndices = pCommandList->IdxBuffer.Data + command.IdxOffset;
+				const auto pVertices = pCommandList->VtxBuffer.Data + command.VtxOffset;
+				for (uint32_t i = 0; i + 2 < command.ElemCount; i += 3)
+				{
+					const RasterVertex vertices[3] = {
+						ToRasterVertex(pVertices[pIndices[i]], offset, scale),
+						ToRasterVertex(pVertices[pIndices[i + 1]], offset, scale),
+						ToRasterVertex(pVertices[pIndices[i + 2]], offset, scale)
+					};
+
+					auto triangle = bounds;
+					if (!SetupRasterTriangle(triangle, vertices))
+						continue;
+
+					// Bin the triangle to the tiles its bounds overlap.
+					const auto triangleIndex = static_cast<uint32_t>(m_Triangles.size());
+					for (auto tileY = triangle.m_MinY / TileSize; tileY <= (triangle.m_MaxY - 1) / TileSize; tileY++)
+						for (auto tileX = triangle.m_MinX / TileSize; tileX <= (triangle.m_MaxX - 1) / TileSize; tileX++)
+							m_TileTriangles[tileY * m_TileCountX + tileX].emplace_back(triangleIndex);
+
+					m_Triangles.emplace_back(triangle);
+				}
+			}
+		}
+	}
+
+	void SoftwareRenderer::rasterizeTiles(ImU32 clearColor)
+	{
+		const auto tileCount = static_cast<uint32_t>(m_TileTriangles.size());
+		for (auto tileIndex = m_NextTile.fetch_add(1, std::memory_order_relaxed); tileIndex < tileCount; tileIndex = m_NextTile.fetch_add(1, std::memory_order_relaxed))
+			rasterizeTile(tileIndex, clearColor);
+	}
+
+	void SoftwareRenderer::rasterizeTile(uint32_t tileIndex, ImU32 clearColor)
+	{
+		const auto spanKernel = GetSpanKernel().m_Function;
+
+		const auto minX = static_cast<int32_t>(tileIndex % m_TileCountX) * TileSize;
+		const auto minY = static_cast<int32_t>(tileIndex / m_TileCountX) * TileSize;
+		const auto maxX = std::min(minX + TileSize, static_cast<int32_t>(m_Width));
+		const auto maxY = std::min(minY + TileSize, static_cast<int32_t>(m_Height));
+
+		for (auto y = minY; y < maxY; y++)
+		{
+			const auto pRow = m_Pixels.data() + static_cast<size_t>(y) * m_Width;
+			std::fill(pRow + minX, pRow + maxX, clearColor);
+		}
+
+		// The triangles were binned in their draw order, so they're blended in the right order.
+		for (const auto triangleIndex : m_TileTriangles[tileIndex])
+		{
+			const auto& triangle = m_Triangles[triangleIndex];
+			const auto& texture = m_Textures[triangle.m_TextureIndex].m_Image;
+
+			const auto begin = std::max(triangle.m_MinX, minX);
+			const auto end = std::min(triangle.m_MaxX, maxX);
+
+			for (auto y = std::max(triangle.m_MinY, minY); y < std::min(triangle.m_MaxY, maxY); y++)
+				spanKernel(triangle, texture, m_Pixels.data() + static_cast<size_t>(y) * m_Width, begin, end, y);
+		}
+	}
+}
@@ -0,0 +1,147 @@
+// Copyright (c) 2022 Dhiraj Wishal
+
+#pragma once
+
+#include "Core/ThreadPool.hpp"
+#include "Core/Rasterizer.hpp"
+
+#include <imgui.h>
+
+#include <atomic>
+#include <filesystem>
+
+namespace rapid
+{
+	/**
+	 * Software renderer class.
+	 * This rasterizes ImGui draw data on the CPU into an RGBA8 framebuffer in memory, so frames can be rendered on machines
+	 * without a GPU or a Vulkan driver (like with the null window). It also serves as a reference when comparing the
+	 * output of the GPU renderer.
+	 *
+	 * The framebuffer is split into tiles, and the triangles are binned to the tiles they overlap, keeping their draw
+	 * order. The tiles are then rasterized in parallel on a thread pool, using the best span kernel for the CPU.
+	 *
+	 * The output matches the Vulkan renderer's blending, but textures are sampled using the nearest texel. Draw callbacks
+	 * are skipped, as they need the GPU.
+	 */
+	class SoftwareRenderer final
+	{
+	public:
+		/**
+		 * Texture structure.
+		 */
+		struct Texture final
+		{
+			ImTextureID m_TextureID = {};
+			RasterTexture m_Image = {};
+		};
+
+	public:
+		/**
+		 * Default constructor.
+		 * The current ImGui font atlas is registered as a texture, so an ImGui context needs to exist. The tiles are
+		 * rasterized on the shared worker threads.
+		 */
+		SoftwareRenderer();
+
+		SoftwareRenderer(const SoftwareRenderer&) = delete;
+		SoftwareRenderer& operator=(const SoftwareRenderer&) = delete;
+
+		/**
+		 * Register a texture.
+		 * The pixels are not copied, so they need to stay valid while the renderer uses them. Textures which are not
+		 * registered are sampled as white.
+		 *
+		 * @param textureID The ImGui texture ID.
+		 * @param pPixels The RGBA8 pixels.
+		 * @param width The texture width.
+		 * @param height The texture height.
+		 */
+		void registerTexture(ImTextureID textureID, const uint32_t* pPixels, uint32_t width, uint32_t height);
+
+		/**
+		 * Render the draw data.
+		 * The framebuffer is resized to the draw data's display size (scaled by the framebuffer scale) if needed.
+		 *
+		 * @param drawData The draw data to render.
+		 * @param clearColor The color the framebuffer is cleared to. Default is transparent black.
+		 */
+		void render(const ImDrawData& drawData, ImU32 clearColor = 0);
+
+		/**
+		 * Save the framebuffer as a PNG image.
+		 *
+		 * @param file The file to save to.
+		 * @return Whether or not the image was saved.
+		 */
+		bool save(const std::filesystem::path& file) const;
+
+		/**
+		 * Get the framebuffer pixels.
+		 * The pixels are in the same layout as ImGui colors (RGBA8), row by row.
+		 *
+		 * @return The pixels.
+		 */
+		const std::vector<uint32_t>& getPixels() const { return m_Pixels; }
+
+		/**
+		 * Get the framebuffer width.
+		 *
+		 * @return The width in pixels.
+		 */
+		uint32_t getWidth() const { return m_Width; }
+
+		/**
+		 * Get the framebuffer height.
+		 *
+		 * @return The height in pixels.
+		 */
+		uint32_t getHeight() const { return m_Height; }
+
+		/**
+		 * Get the number of triangles rasterized by the last render.
+		 *
+		 * @return The triangle count.
+		 */
+		uint64_t getTriangleCount() const { return m_Triangles.size(); }
+
+	private:
+		/**
+		 * Set up the triangles of the draw data and bin them to the tiles.
+		 *
+		 * @param drawData The draw data.
+		 */
+		void setupTriangles(const ImDrawData& drawData);
+
+		/**
+		 * Rasterize the tiles till there are none left.
+		 * This is run by the worker threads and the calling thread at the same time.
+		 *
+		 * @param clearColor The clear color.
+		 */
+		void rasterizeTiles(ImU32 clearColor);
+
+		/**
+		 * Rasterize a single tile.
+		 *
+		 * @param tileIndex The tile index.
+		 * @param clearColor The clear color.
+		 */
+		void rasterizeTile(uint32_t tileIndex, ImU32 clearColor);
+
+	private:
+		std::vector<uint32_t> m_Pixels = {};
+		std::vector<RasterTriangle> m_Triangles = {};
+		std::vector<Texture> m_Textures = {};
+		std::vector<std::vector<uint32_t>> m_TileTriangles = {};
+
+		ThreadPool& m_ThreadPool;
+
+		std::atomic<uint32_t> m_NextTile = 0;
+
+		uint32_t m_Width = 0;
+		uint32_t m_Height = 0;
+		uint32_t m_TileCountX = 0;
+		uint32_t m_TileCountY = 0;
+	};
+}
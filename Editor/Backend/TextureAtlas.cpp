@@ -0,0 +1,653 @@
+// Copyright (c) 2022 Dhiraj Wishal
+
+#include "TextureAtlas.hpp"
+#include "Utility.hpp"
+
+#include <spdlog/spdlog.h>
+
+#include <algorithm>
+#include <cstring>
+#include <iterator>
+#include <limits>
+
+namespace
+{
+	constexpr uint32_t BorderSize = 1;
+	constexpr uint32_t PixelSize = 4;
+
+	constexpr VkFormat SourceFormat = VK_FORMAT_R8G8B8A8_UNORM;	// The format of the inserted pixels.
+	constexpr VkFormat PageFormat = VK_FORMAT_R8G8B8A8_UNORM;
+	constexpr uint64_t StagingAlignment = 16;
+
+	/**
+	 * Align a size to the staging alignment.
+	 *
+	 * @param size The size to align.
+	 * @return The aligned size.
+	 */
+	constexpr uint64_t AlignStaging(uint64_t size)
+	{
+		return (size + StagingAlignment - 1) & ~(StagingAlignment - 1);
+	}
+
+	/**
+	 * Get the entry index from a handle.
+	 *
+	 * @param handle The handle.
+	 * @return The index. This will be out of bounds if the handle is invalid.
+	 */
+	uint64_t ToIndex(rapid::AtlasHandle handle) { return (handle & std::numeric_limits<uint32_t>::max()) - 1; }
+
+	/**
+	 * Get the generation from a handle.
+	 *
+	 * @param handle The handle.
+	 * @return The generation.
+	 */
+	uint32_t ToGeneration(rapid::AtlasHandle handle) { return static_cast<uint32_t>(handle >> 32); }
+
+	/**
+	 * Create a handle from the entry index and the generation.
+	 *
+	 * @param index The entry index.
+	 * @param generation The entry generation.
+	 * @return The handle.
+	 */
+	rapid::AtlasHandle ToHandle(uint64_t index, uint32_t generation) { return (static_cast<uint64_t>(generation) << 32) | (index + 1); }
+
+	/**
+	 * Copy pixels and surround them with a border which repeats the edge pixels.
+	 *
+	 * @param pDestination The destination pixels. This needs to have space for the border.
+	 * @param pSource The source pixels.
+	 * @param width The source width.
+	 * @param height The source height.
+	 */
+	void CopyWithBorder(std::byte* pDestination, const std::byte* pSource, uint32_t width, uint32_t height)
+	{
+		const auto paddedWidth = width + BorderSize * 2;
+		const auto paddedHeight = height + BorderSize * 2;
+
+		for (uint32_t y = 0; y < paddedHeight; y++)
+		{
+			const auto sourceY = std::clamp(y, BorderSize, height + BorderSize - 1) - BorderSize;
+			const auto pSourceRow = pSource + static_cast<uint64_t>(sourceY) * width * PixelSize;
+			const auto pDestinationRow = pDestination + static_cast<uint64_t>(y) * paddedWidth * PixelSize;
+
+			std::memcpy(pDestinationRow + BorderSize * PixelSize, pSourceRow, static_cast<uint64_t>(width) * PixelSize);
+
+			for (uint32_t x = 0; x < BorderSize; x++)
+			{
+				std::memcpy(pDestinationRow + x * PixelSize, pSourceRow, PixelSize);
+				std::memcpy(pDestinationRow + (paddedWidth - 1 - x) * PixelSize, pSourceRow + (width - 1) * PixelSize, PixelSize);
+			}
+		}
+	}
+}
+
+namespace rapid
+{
+	TextureAtlas::TextureAtlas(GraphicsEngine& engine, Window& window, TextureRegistry& textureRegistry, uint32_t pageSize, uint32_t maxPageCount)
+		: m_Engine(engine), m_Window(window), m_TextureRegistry(textureRegistry), m_PageSize(pageSize), m_MaxPageCount(std::max(maxPageCount, 1u))
+	{
+		const auto& deviceTable = m_Engine.getDeviceTable();
+		const auto logicalDevice = m_Engine.getLogicalDevice();
+
+		// Create the command pool and the upload batches. The staging buffers are created when they're first needed.
+		const VkCommandPoolCreateInfo commandPoolCreateInfo = {
+			.sType = VK_STRUCTURE_TYPE_COMMAND_POOL_CREATE_INFO,
+			.pNext = VK_NULL_HANDLE,
+			.flags = VK_COMMAND_POOL_CREATE_RESET_COMMAND_BUFFER_BIT | VK_COMMAND_POOL_CREATE_TRANSIENT_BIT,
+			.queueFamilyIndex = m_Engine.getQueue().getTransferFamily().value()
+		};
+
+		utility::ValidateResult(deviceTable.vkCreateCommandPool(logicalDevice, &commandPoolCreateInfo, nullptr, &m_CommandPool), "Failed to create the command pool!");
+
+		for (auto& batch : m_UploadBatches)
+		{
+			const VkCommandBufferAllocateInfo allocateInfo = {
+				.sType = VK_STRUCTURE_TYPE_COMMAND_BUFFER_ALLOCATE_INFO,
+				.pNext = VK_NULL_HANDLE,
+				.commandPool = m_CommandPool,
+				.level = VK_COMMAND_BUFFER_LEVEL_PRIMARY,
+				.commandBufferCount = 1,
+			};
+
+			utility::ValidateResult(deviceTable.vkAllocateCommandBuffers(logicalDevice, &allocateInfo, &batch.m_CommandBuffer), "Failed to allocate command buffer!");
+
+			const VkFenceCreateInfo fenceCreateInfo = {
+				.sType = VkStructureType::VK_STRUCTURE_TYPE_FENCE_CREATE_INFO,
+				.pNext = VK_NULL_HANDLE,
+				.flags = 0
+			};
+
+			utility::ValidateResult(deviceTable.vkCreateFence(logicalDevice, &fenceCreateInfo, nullptr, &batch.m_Fence), "Failed to create the synchronization fence!");
+		}
+	}
+
+	TextureAtlas::~TextureAtlas()
+	{
+		const auto& deviceTable = m_Engine.getDeviceTable();
+		const auto logicalDevice = m_Engine.getLogicalDevice();
+
+		// Wait till the uploads are done and destroy the batches.
+		for (auto& batch : m_UploadBatches)
+		{
+			if (batch.m_IsPending)
+				utility::ValidateResult(deviceTable.vkWaitForFences(logicalDevice, 1, &batch.m_Fence, VK_TRUE, std::numeric_limits<uint64_t>::max()), "Failed to wait for the fence!");
+
+			if (batch.m_StagingBuffer)
+				batch.m_StagingBuffer->terminate();
+
+			deviceTable.vkDestroyFence(logicalDevice, batch.m_Fence, nullptr);
+			deviceTable.vkFreeCommandBuffers(logicalDevice, m_CommandPool, 1, &batch.m_CommandBuffer);
+		}
+
+		deviceTable.vkDestroyCommandPool(logicalDevice, m_CommandPool, nullptr);
+
+		for (auto& page : m_Pages)
+			page.m_Image->terminate();
+
+		for (auto& retired : m_RetiredImages)
+			retired.m_Image->terminate();
+	}
+
+	AtlasHandle TextureAtlas::insert(const std::byte* pPixels, uint32_t width, uint32_t height)
+	{
+		const auto paddedWidth = width + BorderSize * 2;
+		const auto paddedHeight = height + BorderSize * 2;
+
+		if (width == 0 || height == 0 || paddedWidth > m_PageSize || paddedHeight > m_PageSize)
+		{
+			spdlog::error("Cannot insert a {}x{} image into an atlas with {}x{} pages!", width, height, m_PageSize, m_PageSize);
+			return InvalidAtlasHandle;
+		}
+
+		// Allocate the space first. This might evict entries, which frees their slots.
+		PackedRect rect = {};
+		const auto pageIndex = allocate(paddedWidth, paddedHeight, rect);
+
+		uint32_t index = static_cast<uint32_t>(m_Entries.size());
+		if (!m_FreeEntries.empty())
+		{
+			index = m_FreeEntries.back();
+			m_FreeEntries.pop_back();
+		}
+		else
+		{
+			m_Entries.emplace_back();
+		}
+
+		auto& entry = m_Entries[index];
+		entry.m_Rect = rect;
+		entry.m_LastUsedFrame = m_FrameNumber;
+		entry.m_Page = pageIndex;
+		entry.m_IsUsed = true;
+		entry.m_IsUploading = false;
+		entry.m_IsUploaded = false;
+
+		auto& page = m_Pages[pageIndex];
+		page.m_Entries.emplace_back(index);
+		page.m_HasFailedRepack = false;
+
+		// Keep a copy of the pixels till the upload.
+		const auto handle = ToHandle(index, entry.m_Generation);
+		auto& upload = m_PendingUploads.emplace_back(PendingUpload{ .m_Handle = handle });
+		upload.m_Pixels.resize(static_cast<uint64_t>(paddedWidth) * paddedHeight * PixelSize);
+		CopyWithBorder(upload.m_Pixels.data(), pPixels, width, height);
+
+		return handle;
+	}
+
+	void TextureAtlas::release(AtlasHandle handle)
+	{
+		const auto pEntry = getEntry(handle);
+		if (!pEntry)
+		{
+			spdlog::warn("Trying to release an invalid atlas handle!");
+			return;
+		}
+
+		// The space is reclaimed when the page is defragmented.
+		auto& page = m_Pages[pEntry->m_Page];
+		std::erase(page.m_Entries, static_cast<uint32_t>(ToIndex(handle)));
+		page.m_ReleasedArea += static_cast<uint64_t>(pEntry->m_Rect.m_Width) * pEntry->m_Rect.m_Height;
+		page.m_HasFailedRepack = false;
+
+		freeEntry(static_cast<uint32_t>(ToIndex(handle)));
+	}
+
+	std::optional<AtlasRegion> TextureAtlas::getRegion(AtlasHandle handle) const
+	{
+		const auto pEntry = getEntry(handle);
+		if (!pEntry || !pEntry->m_IsUploaded)
+			return std::nullopt;
+
+		pEntry->m_LastUsedFrame = m_FrameNumber;
+
+		const auto& rect = pEntry->m_Rect;
+		const auto pageSize = static_cast<float>(m_PageSize);
+		return AtlasRegion{
+			.m_TextureID = m_Pages[pEntry->m_Page].m_TextureID,
+			.m_UV0 = ImVec2((rect.m_X + BorderSize) / pageSize, (rect.m_Y + BorderSize) / pageSize),
+			.m_UV1 = ImVec2((rect.m_X + rect.m_Width - BorderSize) / pageSize, (rect.m_Y + rect.m_Height - BorderSize) / pageSize),
+			.m_Width = rect.m_Width - BorderSize * 2,
+			.m_Height = rect.m_Height - BorderSize * 2
+		};
+	}
+
+	void TextureAtlas::update()
+	{
+		m_FrameNumber++;
+
+		// Destroy the retired images which are no longer used by any frame.
+		std::erase_if(m_RetiredImages, [this](RetiredImage& retired)
+			{
+				if (retired.m_DestroyFrame > m_FrameNumber)
+					return false;
+
+				if (retired.m_TextureID)
+					m_TextureRegistry.unregisterTexture(retired.m_TextureID);
+
+				retired.m_Image->terminate();
+				return true;
+			}
+		);
+
+		// Make the finished uploads drawable.
+		completeUploads();
+
+		// Defragment the pages where more than half of the packed area is released.
+		for (uint32_t i = 0; i < m_Pages.size(); i++)
+		{
+			if (m_Pages[i].m_ReleasedArea * 2 > m_Pages[i].m_Packer.usedArea())
+				defragmentPage(i);
+		}
+
+		// Drop the uploads of the entries which were released or evicted before being uploaded.
+		std::erase_if(m_PendingUploads, [this](const PendingUpload& upload) { return getEntry(upload.m_Handle) == nullptr; });
+		submitUploads();
+
+		// The uploads are submitted before the frame, so the copies see the entries which are still being uploaded.
+		std::move(m_PendingCopies.begin(), m_PendingCopies.end(), std::back_inserter(m_FrameCopies));
+		m_PendingCopies.clear();
+	}
+
+	std::vector<RenderGraph::ResourceID> TextureAtlas::addPasses(RenderGraph& graph)
+	{
+		std::vector<RenderGraph::ResourceID> destinations;
+		if (m_FrameCopies.empty())
+			return destinations;
+
+		// An image can be copied several times in a frame, so each one is imported once.
+		std::vector<std::pair<Image*, RenderGraph::ResourceID>> resources;
+		const auto getResource = [&graph, &resources](Image* pImage)
+		{
+			const auto itr = std::find_if(resources.begin(), resources.end(), [pImage](const auto& resource) { return resource.first == pImage; });
+			if (itr != resources.end())
+				return itr->second;
+
+			return resources.emplace_back(pImage, graph.importImage("Texture Atlas Page", *pImage)).second;
+		};
+
+		for (auto& copy : m_FrameCopies)
+		{
+			const auto sourceResource = getResource(copy.m_pSource);
+			const auto destinationResource = getResource(copy.m_pDestination);
+			destinations.emplace_back(destinationResource);
+
+			graph.addPass("Texture Atlas Defragment", [sourceResource, destinationResource](RenderGraph::PassBuilder& builder)
+				{
+					builder.read(sourceResource, ResourceUsage::TransferSource);
+					builder.write(destinationResource, ResourceUsage::TransferDestination);
+				},
+				[this, copy = std::move(copy)](CommandBuffer commandBuffer)
+				{
+					m_Engine.getDeviceTable().vkCmdCopyImage(commandBuffer.buffer(),
+						copy.m_pSource->getImage(), VK_IMAGE_LAYOUT_TRANSFER_SRC_OPTIMAL,
+						copy.m_pDestination->getImage(), VK_IMAGE_LAYOUT_TRANSFER_DST_OPTIMAL,
+						static_cast<uint32_t>(copy.m_Regions.size()), copy.m_Regions.data());
+				}
+			);
+		}
+
+		m_FrameCopies.clear();
+		return destinations;
+	}
+
+	void TextureAtlas::defragment()
+	{
+		for (uint32_t i = 0; i < m_Pages.size(); i++)
+			defragmentPage(i);
+	}
+
+	TextureAtlas::Entry* TextureAtlas::getEntry(AtlasHandle handle)
+	{
+		const auto index = ToIndex(handle);
+		if (handle == InvalidAtlasHandle || index >= m_Entries.size())
+			return nullptr;
+
+		auto& entry = m_Entries[index];
+		if (entry.m_Generation != ToGeneration(handle) || !entry.m_IsUsed)
+			return nullptr;
+
+		return &entry;
+	}
+
+	const TextureAtlas::Entry* TextureAtlas::getEntry(AtlasHandle handle) const
+	{
+		return const_cast<TextureAtlas*>(this)->getEntry(handle);
+	}
+
+	uint32_t TextureAtlas::allocate(uint32_t width, uint32_t height, PackedRect& rect)
+	{
+		// Try the existing pages first.
+		for (uint32_t i = 0; i < m_Pages.size(); i++)
+		{
+			if (m_Pages[i].m_Packer.pack(width, height, rect))
+				return i;
+		}
+
+		// Then try reclaiming the released space.
+		for (uint32_t i = 0; i < m_Pages.size(); i++)
+		{
+			if (defragmentPage(i) && m_Pages[i].m_Packer.pack(width, height, rect))
+				return i;
+		}
+
+		// Then try creating a new page.
+		if (m_Pages.size() < m_MaxPageCount)
+		{
+			auto& page = m_Pages.emplace_back(m_PageSize);
+			page.m_Image = std::make_unique<Image>(m_Engine, VkExtent3D{ m_PageSize, m_PageSize, 1 }, PageFormat);
+			page.m_Packer.pack(width, height, rect);
+
+			return static_cast<uint32_t>(m_Pages.size() - 1);
+		}
+
+		// Finally evict a page. The rectangle always fits in an empty page.
+		const auto pageIndex = evictPage();
+		m_Pages[pageIndex].m_Packer.pack(width, height, rect);
+
+		return pageIndex;
+	}
+
+	bool TextureAtlas::defragmentPage(uint32_t pageIndex)
+	{
+		auto& page = m_Pages[pageIndex];
+		if (page.m_ReleasedArea == 0 || page.m_HasFailedRepack)
+			return false;
+
+		// Packing the tallest entries first keeps the skyline flat.
+		auto entries = page.m_Entries;
+		std::sort(entries.begin(), entries.end(), [this](uint32_t lhs, uint32_t rhs) { return m_Entries[lhs].m_Rect.m_Height > m_Entries[rhs].m_Rect.m_Height; });
+
+		// Try packing on a scratch packer first, so the page stays intact if the entries don't fit in the new order.
+		auto packer = SkylinePacker(m_PageSize, m_PageSize);
+		std::vector<PackedRect> rects(entries.size());
+		for (uint64_t i = 0; i < entries.size(); i++)
+		{
+			const auto& rect = m_Entries[entries[i]].m_Rect;
+			if (!packer.pack(rect.m_Width, rect.m_Height, rects[i]))
+			{
+				// Packing the same entries again gives the same result, so the page isn't tried again till it changes.
+				page.m_HasFailedRepack = true;
+				return false;
+			}
+		}
+
+		// The packer is deterministic, so packing the page's packer in the same order gives the same rectangles.
+		page.m_Packer.clear();
+		std::vector<VkImageCopy> imageCopies;
+		for (uint64_t i = 0; i < entries.size(); i++)
+		{
+			auto& entry = m_Entries[entries[i]];
+			page.m_Packer.pack(entry.m_Rect.m_Width, entry.m_Rect.m_Height, rects[i]);
+
+			// The uploads which are still in flight are submitted before the copy, so they're moved as well.
+			if (entry.m_IsUploaded || entry.m_IsUploading)
+			{
+				imageCopies.emplace_back(VkImageCopy{
+					.srcSubresource = { VK_IMAGE_ASPECT_COLOR_BIT, 0, 0, 1 },
+					.srcOffset = { static_cast<int32_t>(entry.m_Rect.m_X), static_cast<int32_t>(entry.m_Rect.m_Y), 0 },
+					.dstSubresource = { VK_IMAGE_ASPECT_COLOR_BIT, 0, 0, 1 },
+					.dstOffset = { static_cast<int32_t>(rects[i].m_X), static_cast<int32_t>(rects[i].m_Y), 0 },
+					.extent = { entry.m_Rect.m_Width, entry.m_Rect.m_Height, 1 }
+					}
+				);
+			}
+
+			entry.m_Rect = rects[i];
+		}
+
+		page.m_ReleasedArea = 0;
+
+		// Nothing is uploaded yet, so the pending uploads go to the new places in the same image.
+		if (imageCopies.empty())
+			return true;
+
+		// The old and new places can overlap, so the uploaded entries are copied to a new image by the next frame. The old
+		// one is retired, as frames in flight could still use it.
+		auto pImage = std::make_unique<Image>(m_Engine, VkExtent3D{ m_PageSize, m_PageSize, 1 }, PageFormat);
+		m_PendingCopies.emplace_back(PageCopy{ .m_pSource = page.m_Image.get(), .m_pDestination = pImage.get(), .m_Regions = std::move(imageCopies) });
+
+		retireImage(page);
+		page.m_Image = std::move(pImage);
+		page.m_TextureID = m_TextureRegistry.registerTexture(*page.m_Image);
+
+		return true;
+	}
+
+	uint32_t TextureAtlas::evictPage()
+	{
+		// A page is as recent as its most recently used entry.
+		uint32_t pageIndex = 0;
+		uint64_t oldestFrame = std::numeric_limits<uint64_t>::max();
+		for (uint32_t i = 0; i < m_Pages.size(); i++)
+		{
+			uint64_t lastUsedFrame = 0;
+			for (const auto index : m_Pages[i].m_Entries)
+				lastUsedFrame = std::max(lastUsedFrame, m_Entries[index].m_LastUsedFrame);
+
+			if (lastUsedFrame < oldestFrame)
+			{
+				oldestFrame = lastUsedFrame;
+				pageIndex = i;
+			}
+		}
+
+		auto& page = m_Pages[pageIndex];
+		for (const auto index : page.m_Entries)
+		{
+			m_EvictedHandles.emplace_back(ToHandle(index, m_Entries[index].m_Generation));
+			freeEntry(index);
+		}
+
+		spdlog::info("Evicted {} entries from texture atlas page {}.", page.m_Entries.size(), pageIndex);
+
+		page.m_Entries.clear();
+		page.m_Packer.clear();
+		page.m_ReleasedArea = 0;
+		page.m_HasFailedRepack = false;
+
+		// Frames in flight could still draw the evicted entries, so the new entries go to a new image. It's registered after
+		// its first upload.
+		retireImage(page);
+		page.m_Image = std::make_unique<Image>(m_Engine, VkExtent3D{ m_PageSize, m_PageSize, 1 }, PageFormat);
+
+		return pageIndex;
+	}
+
+	void TextureAtlas::freeEntry(uint32_t index)
+	{
+		// Bumping the generation makes the handle stale.
+		auto& entry = m_Entries[index];
+		entry.m_IsUsed = false;
+		entry.m_IsUploading = false;
+		entry.m_IsUploaded = false;
+		entry.m_Generation++;
+
+		m_FreeEntries.emplace_back(index);
+	}
+
+	void TextureAtlas::completeUploads()
+	{
+		const auto& deviceTable = m_Engine.getDeviceTable();
+		const auto logicalDevice = m_Engine.getLogicalDevice();
+
+		// Batches are submitted in order, so they're completed in order starting from the oldest one.
+		for (uint32_t i = 0; i < m_UploadBatches.size(); i++)
+		{
+			auto& batch = m_UploadBatches[(m_NextBatch + i) % m_UploadBatches.size()];
+			if (!batch.m_IsPending)
+				continue;
+
+			if (deviceTable.vkGetFenceStatus(logicalDevice, batch.m_Fence) != VK_SUCCESS)
+				break;
+
+			utility::ValidateResult(deviceTable.vkResetFences(logicalDevice, 1, &batch.m_Fence), "Failed to reset the fence!");
+
+			// The handles are sorted by page, so each page is registered or invalidated once. Entries which were released
+			// or evicted during the upload are skipped.
+			uint32_t lastPage = std::numeric_limits<uint32_t>::max();
+			for (const auto handle : batch.m_Handles)
+			{
+				const auto pEntry = getEntry(handle);
+				if (!pEntry)
+					continue;
+
+				pEntry->m_IsUploading = false;
+				pEntry->m_IsUploaded = true;
+				if (pEntry->m_Page == lastPage)
+					continue;
+
+				lastPage = pEntry->m_Page;
+				auto& page = m_Pages[lastPage];
+				if (page.m_TextureID)
+					m_TextureRegistry.invalidate(page.m_TextureID);
+
+				else
+					page.m_TextureID = m_TextureRegistry.registerTexture(*page.m_Image);
+			}
+
+			batch.m_Handles.clear();
+			batch.m_IsPending = false;
+		}
+	}
+
+	void TextureAtlas::submitUploads()
+	{
+		auto& batch = m_UploadBatches[m_NextBatch];
+		if (m_PendingUploads.empty() || batch.m_IsPending)
+			return;
+
+		// The staging buffer fits a whole page, so every entry fits in it.
+		const auto stagingSize = static_cast<uint64_t>(m_PageSize) * m_PageSize * PixelSize;
+		if (!batch.m_StagingBuffer)
+		{
+			batch.m_StagingBuffer = std::make_unique<Buffer>(m_Engine, stagingSize, BufferType::Staging);
+			batch.m_pStagingMemory = batch.m_StagingBuffer->mapMemory();
+		}
+
+		// Group the uploads by page, so each page is transitioned once.
+		std::sort(m_PendingUploads.begin(), m_PendingUploads.end(), [this](const PendingUpload& lhs, const PendingUpload& rhs)
+			{
+				return getEntry(lhs.m_Handle)->m_Page < getEntry(rhs.m_Handle)->m_Page;
+			}
+		);
+
+		// Copy as many uploads as fit in the staging buffer. The rest are uploaded by the next batch.
+		std::vector<VkBufferImageCopy> imageCopies;
+		imageCopies.reserve(m_PendingUploads.size());
+
+		uint64_t offset = 0;
+		uint64_t uploadCount = 0;
+		for (const auto& upload : m_PendingUploads)
+		{
+			if (offset + upload.m_Pixels.size() > stagingSize)
+				break;
+
+			utility::ConvertPixels(batch.m_pStagingMemory + offset, PageFormat, upload.m_Pixels.data(), SourceFormat, upload.m_Pixels.size() / PixelSize);
+
+			const auto& rect = getEntry(upload.m_Handle)->m_Rect;
+			imageCopies.emplace_back(VkBufferImageCopy{
+				.bufferOffset = offset,
+				.bufferRowLength = rect.m_Width,
+				.bufferImageHeight = rect.m_Height,
+				.imageSubresource = {
+					.aspectMask = VK_IMAGE_ASPECT_COLOR_BIT,
+					.mipLevel = 0,
+					.baseArrayLayer = 0,
+					.layerCount = 1,
+				},
+				.imageOffset = { static_cast<int32_t>(rect.m_X), static_cast<int32_t>(rect.m_Y), 0 },
+				.imageExtent = { rect.m_Width, rect.m_Height, 1 },
+				}
+			);
+
+			getEntry(upload.m_Handle)->m_IsUploading = true;
+			batch.m_Handles.emplace_back(upload.m_Handle);
+			offset += AlignStaging(upload.m_Pixels.size());
+			uploadCount++;
+		}
+
+		batch.m_StagingBuffer->flushMemory(0, std::min(offset, stagingSize));
+
+		// Record the copies of each page.
+		const auto& deviceTable = m_Engine.getDeviceTable();
+		const VkCommandBufferBeginInfo beginInfo = {
+			.sType = VkStructureType::VK_STRUCTURE_TYPE_COMMAND_BUFFER_BEGIN_INFO,
+			.pNext = nullptr,
+			.flags = VkCommandBufferUsageFlagBits::VK_COMMAND_BUFFER_USAGE_ONE_TIME_SUBMIT_BIT
+		};
+
+		utility::ValidateResult(deviceTable.vkBeginCommandBuffer(batch.m_CommandBuffer, &beginInfo), "Failed to begin command buffer recording!");
+
+		for (uint64_t first = 0; first < uploadCount;)
+		{
+			const auto pageIndex = getEntry(m_PendingUploads[first].m_Handle)->m_Page;
+
+			auto last = first + 1;
+			while (last < uploadCount && getEntry(m_PendingUploads[last].m_Handle)->m_Page == pageIndex)
+				last++;
+
+			auto& page = m_Pages[pageIndex];
+			page.m_Image->changeImageLayout(VK_IMAGE_LAYOUT_TRANSFER_DST_OPTIMAL, batch.m_CommandBuffer);
+			deviceTable.vkCmdCopyBufferToImage(batch.m_CommandBuffer, batch.m_StagingBuffer->buffer(), page.m_Image->getImage(), VK_IMAGE_LAYOUT_TRANSFER_DST_OPTIMAL, static_cast<uint32_t>(last - first), imageCopies.data() + first);
+			page.m_Image->changeImageLayout(VK_IMAGE_LAYOUT_SHADER_READ_ONLY_OPTIMAL, batch.m_CommandBuffer);
+
+			first = last;
+		}
+
+		utility::ValidateResult(deviceTable.vkEndCommandBuffer(batch.m_CommandBuffer), "Failed to end command buffer recording!");
+
+		// The copies go to the same queue as the frames, so they're ordered before the defragmentation copies of the next frame.
+		const VkSubmitInfo submitInfo = {
+			.sType = VkStructureType::VK_STRUCTURE_TYPE_SUBMIT_INFO,
+			.commandBufferCount = 1,
+			.pCommandBuffers = &batch.m_CommandBuffer
+		};
+
+		{
+			const auto lock = m_Engine.lockQueue();
+			utility::ValidateResult(deviceTable.vkQueueSubmit(m_Engine.getQueue().getTransferQueue(), 1, &submitInfo, batch.m_Fence), "Failed to submit the queue!");
+		}
+
+		m_PendingUploads.erase(m_PendingUploads.begin(), m_PendingUploads.begin() + uploadCount);
+		batch.m_IsPending = true;
+		m_NextBatch = (m_NextBatch + 1) % m_UploadBatches.size();
+	}
+
+	void TextureAtlas::retireImage(Page& page)
+	{
+		// The copies from the image are recorded by the frame of the next update at the latest, so it's kept for one more frame.
+		m_RetiredImages.emplace_back(RetiredImage{
+			.m_Image = std::move(page.m_Image),
+			.m_TextureID = page.m_TextureID,
+			.m_DestroyFrame = m_FrameNumber + m_Window.frameCount() + 1
+			}
+		);
+
+		page.m_TextureID = nullptr;
+	}
+}
@@ -0,0 +1,309 @@
+// Copyright (c) 2022 Dhiraj Wishal
+
+#pragma once
+
+#include "TextureRegistry.hpp"
+#include "RenderGraph.hpp"
+
+#include "Core/SkylinePacker.hpp"
+
+#include <array>
+#include <optional>
+
+namespace rapid
+{
+	/**
+	 * Atlas handle type.
+	 * The lower 32 bits store the entry index (plus one) and the upper 32 bits store the entry's generation, so handles of
+	 * released or evicted entries never alias new ones.
+	 */
+	using AtlasHandle = uint64_t;
+
+	/**
+	 * Invalid atlas handle.
+	 */
+	constexpr AtlasHandle InvalidAtlasHandle = 0;
+
+	/**
+	 * Atlas region structure.
+	 * This contains everything needed to draw an atlas entry using ImGui::Image.
+	 */
+	struct AtlasRegion final
+	{
+		ImTextureID m_TextureID = nullptr;
+		ImVec2 m_UV0 = {};
+		ImVec2 m_UV1 = {};
+		uint32_t m_Width = 0;	// The size of the entry in pixels, without the border.
+		uint32_t m_Height = 0;
+	};
+
+	/**
+	 * Texture atlas class.
+	 * This packs small images (like icons) into a few large pages, so drawing hundreds of them doesn't need hundreds of
+	 * images, descriptors and draw calls.
+	 *
+	 * Each entry gets a one pixel border which repeats its edge pixels, so filtering never bleeds in the neighbours.
+	 * Released space is reclaimed by defragmenting the page on the GPU, where the copies are recorded to the next frame.
+	 * When every page is full, the least recently used page is evicted, and the handles of its entries are reported
+	 * through takeEvictedHandles() so they can be inserted again when needed. Nothing here waits for the GPU.
+	 */
+	class TextureAtlas final
+	{
+	public:
+		/**
+		 * Explicit constructor.
+		 *
+		 * @param engine The graphics engine.
+		 * @param window The window the atlas is rendered to.
+		 * @param textureRegistry The registry to register the pages in.
+		 * @param pageSize The width and height of a single page. Default is 1024.
+		 * @param maxPageCount The maximum number of pages. Default is 4.
+		 */
+		explicit TextureAtlas(GraphicsEngine& engine, Window& window, TextureRegistry& textureRegistry, uint32_t pageSize = 1024, uint32_t maxPageCount = 4);
+
+		/**
+		 * Destructor.
+		 */
+		~TextureAtlas();
+
+		TextureAtlas(const TextureAtlas&) = delete;
+		TextureAtlas& operator=(const TextureAtlas&) = delete;
+
+		/**
+		 * Insert an image.
+		 * The pixels are copied, and are uploaded in the next update.
+		 *
+		 * @param pPixels The tightly packed RGBA pixels.
+		 * @param width The image width.
+		 * @param height The image height.
+		 * @return The atlas handle. This is invalid if the image is larger than a page.
+		 */
+		[[nodiscard]] AtlasHandle insert(const std::byte* pPixels, uint32_t width, uint32_t height);
+
+		/**
+		 * Release an entry.
+		 * The space is reclaimed when the page is defragmented. The handle is invalid after this.
+		 *
+		 * @param handle The atlas handle.
+		 */
+		void release(AtlasHandle handle);
+
+		/**
+		 * Get the region of an entry.
+		 * This also marks the entry's page as used in this frame.
+		 *
+		 * @param handle The atlas handle.
+		 * @return The region. This is empty if the handle is invalid or the entry is not uploaded yet.
+		 */
+		std::optional<AtlasRegion> getRegion(AtlasHandle handle) const;
+
+		/**
+		 * Update the atlas.
+		 * This destroys the retired pages, defragments the pages with a lot of released space and uploads the inserted
+		 * images. The uploads are submitted without waiting for them, so the entries become drawable in a later update.
+		 * This needs to be called once every frame, before starting the new ImGui frame.
+		 */
+		void update();
+
+		/**
+		 * Add the passes which copy the entries of the defragmented pages to their new images.
+		 * This needs to be called once every frame, after update().
+		 *
+		 * @param graph The frame's render graph.
+		 * @return The page images written by the passes, which need to be declared as read by the passes drawing them.
+		 */
+		std::vector<RenderGraph::ResourceID> addPasses(RenderGraph& graph);
+
+		/**
+		 * Defragment all the pages which have released space.
+		 */
+		void defragment();
+
+		/**
+		 * Take the handles of the entries evicted since the last call.
+		 *
+		 * @return The evicted handles.
+		 */
+		[[nodiscard]] std::vector<AtlasHandle> takeEvictedHandles() { return std::exchange(m_EvictedHandles, {}); }
+
+		/**
+		 * Get the number of pages.
+		 *
+		 * @return The page count.
+		 */
+		uint64_t getPageCount() const { return m_Pages.size(); }
+
+	private:
+		/**
+		 * Atlas entry structure.
+		 */
+		struct Entry final
+		{
+			PackedRect m_Rect = {};	// Includes the border.
+			mutable uint64_t m_LastUsedFrame = 0;
+			uint32_t m_Page = 0;
+			uint32_t m_Generation = 0;
+			bool m_IsUsed = false;
+			bool m_IsUploading = false;	// Whether the entry's upload is submitted but not completed yet.
+			bool m_IsUploaded = false;
+		};
+
+		/**
+		 * Atlas page structure.
+		 */
+		struct Page final
+		{
+			explicit Page(uint32_t pageSize) : m_Packer(pageSize, pageSize) {}
+
+			std::unique_ptr<Image> m_Image = nullptr;
+			ImTextureID m_TextureID = nullptr;
+
+			SkylinePacker m_Packer;
+			std::vector<uint32_t> m_Entries = {};
+			uint64_t m_ReleasedArea = 0;
+			bool m_HasFailedRepack = false;	// Whether the entries didn't fit when packed again. This is cleared when the page changes.
+		};
+
+		/**
+		 * Pending upload structure.
+		 */
+		struct PendingUpload final
+		{
+			AtlasHandle m_Handle = InvalidAtlasHandle;
+			std::vector<std::byte> m_Pixels = {};	// Includes the border.
+		};
+
+		/**
+		 * Upload batch structure.
+		 * The uploads of a single update are copied to the batch's staging buffer and recorded to its command buffer. The
+		 * staging buffer stays mapped, and is reused once the batch's fence is signaled.
+		 */
+		struct UploadBatch final
+		{
+			std::vector<AtlasHandle> m_Handles = {};
+			std::unique_ptr<Buffer> m_StagingBuffer = nullptr;
+			std::byte* m_pStagingMemory = nullptr;
+
+			VkCommandBuffer m_CommandBuffer = VK_NULL_HANDLE;
+			VkFence m_Fence = VK_NULL_HANDLE;
+
+			bool m_IsPending = false;
+		};
+
+		/**
+		 * Page copy structure.
+		 * This moves the entries of a defragmented page to its new image. The images are kept alive by the page or the
+		 * retired images till the frame which records the copy is done.
+		 */
+		struct PageCopy final
+		{
+			Image* m_pSource = nullptr;
+			Image* m_pDestination = nullptr;
+			std::vector<VkImageCopy> m_Regions = {};
+		};
+
+		/**
+		 * Retired page image structure.
+		 */
+		struct RetiredImage final
+		{
+			std::unique_ptr<Image> m_Image = nullptr;
+			ImTextureID m_TextureID = nullptr;
+			uint64_t m_DestroyFrame = 0;
+		};
+
+		/**
+		 * Get the entry of a handle.
+		 *
+		 * @param handle The atlas handle.
+		 * @return The entry pointer. This is nullptr if the handle is invalid or stale.
+		 */
+		Entry* getEntry(AtlasHandle handle);
+
+		/**
+		 * Get the entry of a handle.
+		 *
+		 * @param handle The atlas handle.
+		 * @return The entry pointer. This is nullptr if the handle is invalid or stale.
+		 */
+		const Entry* getEntry(AtlasHandle handle) const;
+
+		/**
+		 * Allocate space for a rectangle, defragmenting or evicting pages if needed.
+		 *
+		 * @param width The width of the rectangle.
+		 * @param height The height of the rectangle.
+		 * @param rect The allocated rectangle.
+		 * @return The page index.
+		 */
+		uint32_t allocate(uint32_t width, uint32_t height, PackedRect& rect);
+
+		/**
+		 * Defragment a page.
+		 * The live entries are packed again from scratch, and the uploaded ones are copied to a new page image by the next
+		 * frame. A page whose entries don't fit is not tried again till it changes.
+		 *
+		 * @param pageIndex The page index.
+		 * @return Whether or not the page was defragmented.
+		 */
+		bool defragmentPage(uint32_t pageIndex);
+
+		/**
+		 * Evict the least recently used page.
+		 * The page gets a new image, as frames in flight could still draw the evicted entries.
+		 *
+		 * @return The page index.
+		 */
+		uint32_t evictPage();
+
+		/**
+		 * Free an entry and make its handle stale.
+		 *
+		 * @param index The entry index.
+		 */
+		void freeEntry(uint32_t index);
+
+		/**
+		 * Complete the finished upload batches.
+		 * The uploaded entries become drawable, and the pages are registered after their first upload.
+		 */
+		void completeUploads();
+
+		/**
+		 * Record and submit the pending uploads which fit in the next batch's staging buffer.
+		 * The rest stay pending till the next update.
+		 */
+		void submitUploads();
+
+		/**
+		 * Retire a page's image, so it's destroyed once no frame in flight uses it or copies from it.
+		 *
+		 * @param page The page.
+		 */
+		void retireImage(Page& page);
+
+	private:
+		std::vector<Entry> m_Entries = {};
+		std::vector<uint32_t> m_FreeEntries = {};
+
+		std::vector<Page> m_Pages = {};
+		std::vector<PendingUpload> m_PendingUploads = {};
+		std::vector<PageCopy> m_PendingCopies = {};
+		std::vector<PageCopy> m_FrameCopies = {};	// The copies handed over to the render thread by the last update.
+		std::vector<RetiredImage> m_RetiredImages = {};
+		std::vector<AtlasHandle> m_EvictedHandles = {};
+		std::array<UploadBatch, 2> m_UploadBatches = {};
+
+		GraphicsEngine& m_Engine;
+		Window& m_Window;
+		TextureRegistry& m_TextureRegistry;
+
+		VkCommandPool m_CommandPool = VK_NULL_HANDLE;
+
+		uint64_t m_FrameNumber = 0;
+		uint32_t m_NextBatch = 0;
+
+		const uint32_t m_PageSize;
+		const uint32_t m_MaxPageCount;
+	};
+}
@@ -0,0 +1,97 @@
+// Copyright (c) 2022 Dhiraj Wishal
+
+#include "TextureRegistry.hpp"
+
+#include <spdlog/spdlog.h>
+
+namespace rapid
+{
+	ImTextureID TextureRegistry::registerTexture(const Image& image, bool isDistanceField)
+	{
+		const auto lock = std::scoped_lock(m_Mutex);
+
+		uint64_t index = m_Entries.size();
+
+		// Reuse a free entry if possible, so the IDs stay small.
+		if (!m_FreeEntries.empty())
+		{
+			index = m_FreeEntries.back();
+			m_FreeEntries.pop_back();
+		}
+		else
+		{
+			m_Entries.emplace_back();
+		}
+
+		auto& entry = m_Entries[index];
+		entry.m_pImage = &image;
+		entry.m_pShaderResource = &m_Pipeline.createShaderResource();
+		entry.m_Version = ++m_VersionCounter;
+		entry.m_IsDistanceField = isDistanceField;
+		entry.m_pShaderResource->bindResource(m_Binding, image);
+
+		return ToTextureID(index);
+	}
+
+	void TextureRegistry::unregisterTexture(ImTextureID textureID)
+	{
+		const auto lock = std::scoped_lock(m_Mutex);
+
+		const auto index = ToIndex(textureID);
+		if (index >= m_Entries.size() || m_Entries[index].m_pImage == nullptr)
+		{
+			spdlog::warn("Trying to unregister a texture which is not registered!");
+			return;
+		}
+
+		// The callers only unregister once no frame in flight uses the texture, so the descriptor set can be freed here.
+		auto& entry = m_Entries[index];
+		m_Pipeline.destroyShaderResource(*entry.m_pShaderResource);
+
+		entry.m_pImage = nullptr;
+		entry.m_pShaderResource = nullptr;
+		m_FreeEntries.emplace_back(index);
+	}
+
+	void TextureRegistry::invalidate(ImTextureID textureID)
+	{
+		const auto lock = std::scoped_lock(m_Mutex);
+
+		const auto index = ToIndex(textureID);
+		if (index < m_Entries.size())
+			m_Entries[index].m_Version = ++m_VersionCounter;
+	}
+
+	const ShaderResource* TextureRegistry::getShaderResource(ImTextureID textureID) const
+	{
+		const auto lock = std::scoped_lock(m_Mutex);
+
+		const auto index = ToIndex(textureID);
+		if (index >= m_Entries.size() || m_Entries[index].m_pImage == nullptr)
+			return nullptr;
+
+		return m_Entries[index].m_pShaderResource;
+	}
+
+	uint64_t TextureRegistry::getVersion(ImTextureID textureID) const
+	{
+		const auto lock = std::scoped_lock(m_Mutex);
+
+		const auto index = ToIndex(textureID);
+		if (index >= m_Entries.size())
+			return 0;
+
+		return m_Entries[index].m_Version;
+	}
+
+	bool TextureRegistry::isDistanceField(ImTextureID textureID) const
+	{
+		const auto lock = std::scoped_lock(m_Mutex);
+
+		const auto index = ToIndex(textureID);
+		if (index >= m_Entries.size())
+			return false;
+
+		return m_Entries[index].m_IsDistanceField;
+	}
+}
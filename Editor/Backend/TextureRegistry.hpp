@@ -0,0 +1,122 @@
+// Copyright (c) 2022 Dhiraj Wishal
+
+#pragma once
+
+#include "GraphicsPipeline.hpp"
+
+#include <imgui.h>
+
+#include <mutex>
+
+namespace rapid
+{
+	/**
+	 * Texture registry class.
+	 * This maps ImGui texture IDs to images and the shader resources (descriptors) used to sample them, so that any image
+	 * can be drawn using ImGui::Image and friends.
+	 *
+	 * Texture IDs are small integers (starting from 1) stored in the ImTextureID, and are reused once unregistered. The
+	 * registry is used by both the UI thread and the render thread, so every access is locked.
+	 */
+	class TextureRegistry final
+	{
+	public:
+		/**
+		 * Explicit constructor.
+		 *
+		 * @param pipeline The pipeline used to create the shader resources.
+		 * @param binding The binding of the sampled image in the pipeline.
+		 */
+		explicit TextureRegistry(GraphicsPipeline& pipeline, uint32_t binding) : m_Pipeline(pipeline), m_Binding(binding) {}
+
+		/**
+		 * Register an image.
+		 * Note that the image should be in the shader read only layout when it's rendered and should outlive its registration.
+		 *
+		 * @param image The image to register.
+		 * @param isDistanceField Whether or not the image stores a signed distance field (like the distance field font atlas).
+		 * @return The texture ID to use with ImGui.
+		 */
+		[[nodiscard]] ImTextureID registerTexture(const Image& image, bool isDistanceField = false);
+
+		/**
+		 * Unregister a texture.
+		 * This frees the texture's descriptor set, so it must not be used by any frame in flight. The ID can be reused after this.
+		 *
+		 * @param textureID The texture ID to unregister.
+		 */
+		void unregisterTexture(ImTextureID textureID);
+
+		/**
+		 * Let the renderer know that the contents of a texture changed.
+		 * This makes sure that everything using the texture gets redrawn.
+		 *
+		 * @param textureID The texture ID.
+		 */
+		void invalidate(ImTextureID textureID);
+
+		/**
+		 * Get the shader resource of a texture.
+		 *
+		 * @param textureID The texture ID.
+		 * @return The shader resource pointer. This will be nullptr if the ID is not registered.
+		 */
+		const ShaderResource* getShaderResource(ImTextureID textureID) const;
+
+		/**
+		 * Get the version of a texture.
+		 * This changes every time the texture is (re)registered or invalidated.
+		 *
+		 * @param textureID The texture ID.
+		 * @return The version.
+		 */
+		uint64_t getVersion(ImTextureID textureID) const;
+
+		/**
+		 * Check if a texture stores a signed distance field.
+		 * These textures need to be rendered using the distance field pipeline.
+		 *
+		 * @param textureID The texture ID.
+		 * @return Whether or not the texture is a distance field.
+		 */
+		bool isDistanceField(ImTextureID textureID) const;
+
+	private:
+		/**
+		 * Get the entry index from the texture ID.
+		 *
+		 * @param textureID The texture ID.
+		 * @return The index. This will be out of bounds if the ID is invalid.
+		 */
+		static uint64_t ToIndex(ImTextureID textureID) { return reinterpret_cast<uintptr_t>(textureID) - 1; }
+
+		/**
+		 * Get the texture ID from the entry index.
+		 *
+		 * @param index The index.
+		 * @return The texture ID.
+		 */
+		static ImTextureID ToTextureID(uint64_t index) { return reinterpret_cast<ImTextureID>(static_cast<uintptr_t>(index + 1)); }
+
+	private:
+		/**
+		 * Texture entry structure.
+		 */
+		struct Entry final
+		{
+			const Image* m_pImage = nullptr;
+			ShaderResource* m_pShaderResource = nullptr;
+			uint64_t m_Version = 0;
+			bool m_IsDistanceField = false;
+		};
+
+		std::vector<Entry> m_Entries = {};
+		std::vector<uint64_t> m_FreeEntries = {};
+
+		mutable std::mutex m_Mutex;
+
+		GraphicsPipeline& m_Pipeline;
+		const uint32_t m_Binding;
+		uint64_t m_VersionCounter = 0;
+	};
+}
@@ -2,8 +2,94 @@
 
 #include "Utility.hpp"
 
+#include "Core/PixelKernels.hpp"
+#include "Core/StreamingCopy.hpp"
+
 #include <spdlog/spdlog.h>
 
+#include <algorithm>
+#include <array>
+#include <cstring>
+
+namespace
+{
+	/**
+	 * Pixel layout structure.
+	 * This describes an 8 bit, four channel format.
+	 */
+	struct PixelLayout final
+	{
+		bool m_IsBGRA = false;
+		bool m_IsSRGB = false;
+	};
+
+	/**
+	 * Get the pixel layout of a format.
+	 *
+	 * @param format The format.
+	 * @param layout The layout to fill.
+	 * @return Whether or not the format is an 8 bit, four channel format.
+	 */
+	bool GetPixelLayout(VkFormat format, PixelLayout& layout)
+	{
+		switch (format)
+		{
+		case VK_FORMAT_R8G8B8A8_UNORM:
+			layout = { false, false };
+			return true;
+
+		case VK_FORMAT_R8G8B8A8_SRGB:
+			layout = { false, true };
+			return true;
+
+		case VK_FORMAT_B8G8R8A8_UNORM:
+			layout = { true, false };
+			return true;
+
+		case VK_FORMAT_B8G8R8A8_SRGB:
+			layout = { true, true };
+			return true;
+
+		default:
+			return false;
+		}
+	}
+
+	/**
+	 * The number of pixels converted at once when the destination is not the source.
+	 * The chunk stays in the L1 cache, and is then streamed to the destination.
+	 */
+	constexpr uint64_t ConversionChunkPixelCount = 2048;
+
+	/**
+	 * Convert pixels from one layout to another.
+	 * The channels are reordered first, and the transfer function is then applied in place.
+	 *
+	 * @param pDestination The destination pixels. This can be the source.
+	 * @param destinationLayout The destination layout.
+	 * @param pSource The source pixels.
+	 * @param sourceLayout The source layout.
+	 * @param pixelCount The number of pixels to convert.
+	 */
+	void ConvertLayout(std::byte* pDestination, PixelLayout destinationLayout, const std::byte* pSource, PixelLayout sourceLayout, uint64_t pixelCount)
+	{
+		if (destinationLayout.m_IsBGRA != sourceLayout.m_IsBGRA)
+		{
+			rapid::SwizzleRedBlue(pDestination, pSource, pixelCount);
+			pSource = pDestination;
+		}
+
+		if (destinationLayout.m_IsSRGB && !sourceLayout.m_IsSRGB)
+			rapid::ConvertLinearToSRGB(pDestination, pSource, pixelCount);
+
+		else if (!destinationLayout.m_IsSRGB && sourceLayout.m_IsSRGB)
+			rapid::ConvertSRGBToLinear(pDestination, pSource, pixelCount);
+
+		else if (pDestination != pSource)
+			std::memcpy(pDestination, pSource, pixelCount * 4);
+	}
+}
+
 namespace rapid
 {
 	namespace utility
@@ -13,5 +99,115 @@ namespace rapid
 			if (result != VK_SUCCESS)
 				spdlog::error(message);
 		}
+
+		bool IsEmpty(const VkRect2D& rect)
+		{
+			return rect.extent.width == 0 || rect.extent.height == 0;
+		}
+
+		VkRect2D Combine(const VkRect2D& lhs, const VkRect2D& rhs)
+		{
+			if (IsEmpty(lhs))
+				return rhs;
+
+			if (IsEmpty(rhs))
+				return lhs;
+
+			const auto left = std::min(lhs.offset.x, rhs.offset.x);
+			const auto top = std::min(lhs.offset.y, rhs.offset.y);
+			const auto right = std::max(lhs.offset.x + static_cast<int64_t>(lhs.extent.width), rhs.offset.x + static_cast<int64_t>(rhs.extent.width));
+			const auto bottom = std::max(lhs.offset.y + static_cast<int64_t>(lhs.extent.height), rhs.offset.y + static_cast<int64_t>(rhs.extent.height));
+
+			return VkRect2D{
+				.offset = {.x = left, .y = top },
+				.extent = {.width = static_cast<uint32_t>(right - left), .height = static_cast<uint32_t>(bottom - top) }
+			};
+		}
+
+		VkRect2D Intersect(const VkRect2D& lhs, const VkRect2D& rhs)
+		{
+			const auto left = std::max(lhs.offset.x, rhs.offset.x);
+			const auto top = std::max(lhs.offset.y, rhs.offset.y);
+			const auto right = std::min(lhs.offset.x + static_cast<int64_t>(lhs.extent.width), rhs.offset.x + static_cast<int64_t>(rhs.extent.width));
+			const auto bottom = std::min(lhs.offset.y + static_cast<int64_t>(lhs.extent.height), rhs.offset.y + static_cast<int64_t>(rhs.extent.height));
+
+			if (right <= left || bottom <= top)
+				return VkRect2D{};
+
+			return VkRect2D{
+				.offset = {.x = left, .y = top },
+				.extent = {.width = static_cast<uint32_t>(right - left), .height = static_cast<uint32_t>(bottom - top) }
+			};
+		}
+
+		bool ConvertPixels(std::byte* pDestination, VkFormat destinationFormat, const std::byte* pSource, VkFormat sourceFormat, uint64_t pixelCount)
+		{
+			PixelLayout destinationLayout = {};
+			PixelLayout sourceLayout = {};
+			if (!GetPixelLayout(destinationFormat, destinationLayout) || !GetPixelLayout(sourceFormat, sourceLayout))
+			{
+				spdlog::error("Unsupported pixel conversion!");
+				return false;
+			}
+
+			// Matching layouts only need a copy. The destination is usually mapped memory, so the copy is streamed.
+			if (destinationLayout.m_IsBGRA == sourceLayout.m_IsBGRA && destinationLayout.m_IsSRGB == sourceLayout.m_IsSRGB)
+			{
+				if (pDestination != pSource)
+					StreamingCopy(pDestination, pSource, pixelCount * 4);
+
+				return true;
+			}
+
+			if (pDestination == pSource)
+			{
+				ConvertLayout(pDestination, destinationLayout, pSource, sourceLayout, pixelCount);
+				return true;
+			}
+
+			// Otherwise the pixels are converted in small chunks which are then streamed, so the destination is never read.
+			// Reading back from write-combined memory is very slow.
+			std::array<std::byte, ConversionChunkPixelCount * 4> chunk;
+			for (uint64_t offset = 0; offset < pixelCount; offset += ConversionChunkPixelCount)
+			{
+				const auto count = std::min(pixelCount - offset, ConversionChunkPixelCount);
+				ConvertLayout(chunk.data(), destinationLayout, pSource + offset * 4, sourceLayout, count);
+				StreamingCopy(pDestination + offset * 4, chunk.data(), count * 4);
+			}
+
+			return true;
+		}
+
+		std::string_view GetPresentModeName(VkPresentModeKHR presentMode)
+		{
+			switch (presentMode)
+			{
+			case VK_PRESENT_MODE_IMMEDIATE_KHR:
+				return "immediate";
+
+			case VK_PRESENT_MODE_MAILBOX_KHR:
+				return "mailbox";
+
+			case VK_PRESENT_MODE_FIFO_KHR:
+				return "fifo";
+
+			case VK_PRESENT_MODE_FIFO_RELAXED_KHR:
+				return "fifo-relaxed";
+
+			default:
+				return "unknown";
+			}
+		}
+
+		std::optional<VkPresentModeKHR> ParsePresentMode(std::string_view name)
+		{
+			for (const auto presentMode : { VK_PRESENT_MODE_IMMEDIATE_KHR, VK_PRESENT_MODE_MAILBOX_KHR, VK_PRESENT_MODE_FIFO_KHR, VK_PRESENT_MODE_FIFO_RELAXED_KHR })
+			{
+				if (GetPresentModeName(presentMode) == name)
+					return presentMode;
+			}
+
+			return std::nullopt;
+		}
 	}
 }
\ No newline at end of file
@@ -4,6 +4,8 @@
 
 #include <vulkan/vulkan.hpp>
 #include <string>
+#include <optional>
+#include <cstddef>
 
 namespace rapid
 {
@@ -15,5 +17,63 @@ namespace rapid
 		 * @param result The result returned by the function.
 		 */
 		void ValidateResult(VkResult result, std::string_view message);
+
+		/**
+		 * Check if a rectangle is empty.
+		 *
+		 * @param rect The rectangle to check.
+		 * @return Whether or not the rectangle covers no area.
+		 */
+		bool IsEmpty(const VkRect2D& rect);
+
+		/**
+		 * Get the smallest rectangle which contains both the rectangles.
+		 * Empty rectangles are ignored.
+		 *
+		 * @param lhs The first rectangle.
+		 * @param rhs The second rectangle.
+		 * @return The combined rectangle.
+		 */
+		VkRect2D Combine(const VkRect2D& lhs, const VkRect2D& rhs);
+
+		/**
+		 * Get the overlapping area of two rectangles.
+		 *
+		 * @param lhs The first rectangle.
+		 * @param rhs The second rectangle.
+		 * @return The intersection. This will be empty if the two do not overlap.
+		 */
+		VkRect2D Intersect(const VkRect2D& lhs, const VkRect2D& rhs);
+
+		/**
+		 * Convert pixels from one format to another.
+		 * This supports the 8 bit RGBA and BGRA formats, in both their UNORM and SRGB variants. The destination and the
+		 * source can be the same, in which case the pixels are converted in place. Otherwise the destination is only
+		 * written to (never read), so it can be mapped upload memory.
+		 *
+		 * @param pDestination The destination pixels.
+		 * @param destinationFormat The destination format.
+		 * @param pSource The source pixels.
+		 * @param sourceFormat The source format.
+		 * @param pixelCount The number of pixels to convert.
+		 * @return Whether or not the conversion is supported.
+		 */
+		bool ConvertPixels(std::byte* pDestination, VkFormat destinationFormat, const std::byte* pSource, VkFormat sourceFormat, uint64_t pixelCount);
+
+		/**
+		 * Get the name of a present mode.
+		 *
+		 * @param presentMode The present mode.
+		 * @return The name, like "mailbox" or "fifo-relaxed".
+		 */
+		std::string_view GetPresentModeName(VkPresentModeKHR presentMode);
+
+		/**
+		 * Get a present mode from its name.
+		 *
+		 * @param name The name, as returned by GetPresentModeName().
+		 * @return The present mode, or nothing if the name is unknown.
+		 */
+		std::optional<VkPresentModeKHR> ParsePresentMode(std::string_view name);
 	}
 }
\ No newline at end of file
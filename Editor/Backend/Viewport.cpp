@@ -0,0 +1,361 @@
+// Copyright (c) 2022 Dhiraj Wishal
+
+#include "Viewport.hpp"
+#include "Window.hpp"
+#include "Utility.hpp"
+
+#include <spdlog/spdlog.h>
+#include <SDL_vulkan.h>
+
+#include <algorithm>
+
+namespace rapid
+{
+	Viewport::Viewport(GraphicsEngine& engine, const Window& window, std::string_view title, VkRect2D area, uint32_t windowFlags)
+		: m_Engine(engine)
+		, m_Window(window)
+		, m_pWindow(SDL_CreateWindow(title.data(), area.offset.x, area.offset.y, static_cast<int32_t>(area.extent.width), static_cast<int32_t>(area.extent.height), SDL_WINDOW_VULKAN | windowFlags))
+	{
+		// Check if the window creation was successful.
+		if (!m_pWindow)
+		{
+			spdlog::error("Failed to create the viewport window! Error message: {}", SDL_GetError());
+			return;
+		}
+
+		// Create the surface.
+		if (!SDL_Vulkan_CreateSurface(m_pWindow, m_Engine.getInstance(), &m_Surface))
+		{
+			spdlog::error("Failed to create the viewport surface! Error message: {}", SDL_GetError());
+			return;
+		}
+
+		// The viewport is rendered as a part of the window's frames, so it has as many frames as the window.
+		const auto frameCount = m_Window.frameCount();
+
+		createSwapchain();
+		createFramebuffers();
+		createSyncObjects();
+
+		m_CommandBufferAllocator = std::make_unique<CommandBufferAllocator>(m_Engine, static_cast<uint8_t>(frameCount));
+		m_RenderGraph = std::make_unique<RenderGraph>(m_Engine, frameCount);
+	}
+
+	Viewport::~Viewport()
+	{
+		if (isActive())
+			terminate();
+	}
+
+	void Viewport::terminate()
+	{
+		m_RenderGraph.reset();
+
+		if (m_CommandBufferAllocator)
+			m_CommandBufferAllocator->terminate();
+
+		for (const auto vSemaphore : m_ImageAvailableSemaphores)
+			m_Engine.getDeviceTable().vkDestroySemaphore(m_Engine.getLogicalDevice(), vSemaphore, nullptr);
+
+		for (const auto vSemaphore : m_RenderFinishedSemaphores)
+			m_Engine.getDeviceTable().vkDestroySemaphore(m_Engine.getLogicalDevice(), vSemaphore, nullptr);
+
+		m_ImageAvailableSemaphores.clear();
+		m_RenderFinishedSemaphores.clear();
+
+		clearSwapchain();
+		vkDestroySurfaceKHR(m_Engine.getInstance(), m_Surface, nullptr);
+
+		if (m_pWindow)
+			SDL_DestroyWindow(m_pWindow);
+
+		m_IsTerminated = true;
+	}
+
+	bool Viewport::acquireImage(uint32_t frameIndex)
+	{
+		// The presentation engine might never release the images of a window which is not shown, so those are skipped.
+		if (!m_pWindow || SDL_GetWindowFlags(m_pWindow) & (SDL_WINDOW_HIDDEN | SDL_WINDOW_MINIMIZED))
+			return false;
+
+		if (m_IsSwapchainInvalid.exchange(false))
+			recreate();
+
+		while (m_Swapchain != VK_NULL_HANDLE)
+		{
+			const auto result = m_Engine.getDeviceTable().vkAcquireNextImageKHR(m_Engine.getLogicalDevice(), m_Swapchain, std::numeric_limits<uint64_t>::max(), m_ImageAvailableSemaphores[frameIndex], VK_NULL_HANDLE, &m_ImageIndex);
+			if (result == VkResult::VK_ERROR_OUT_OF_DATE_KHR)
+			{
+				recreate();
+				continue;
+			}
+
+			// A suboptimal image can still be presented, so the swapchain is only recreated for the next frame.
+			if (result == VkResult::VK_SUBOPTIMAL_KHR)
+				m_IsSwapchainInvalid = true;
+
+			else
+				utility::ValidateResult(result, "Failed to acquire the next viewport image!");
+
+			return result == VkResult::VK_SUCCESS || result == VkResult::VK_SUBOPTIMAL_KHR;
+		}
+
+		return false;
+	}
+
+	void Viewport::begin(VkCommandBuffer vCommandBuffer, const VkClearValue& clearValue) const
+	{
+		const VkRect2D renderArea = { .offset = { 0, 0 }, .extent = m_Extent };
+
+		if (m_Engine.isDynamicRenderingEnabled())
+		{
+			const VkRenderingAttachmentInfo colorAttachment = {
+				.sType = VK_STRUCTURE_TYPE_RENDERING_ATTACHMENT_INFO,
+				.pNext = nullptr,
+				.imageView = getCurrentImageView(),
+				.imageLayout = VK_IMAGE_LAYOUT_COLOR_ATTACHMENT_OPTIMAL,
+				.resolveMode = VK_RESOLVE_MODE_NONE,
+				.resolveImageView = VK_NULL_HANDLE,
+				.resolveImageLayout = VK_IMAGE_LAYOUT_UNDEFINED,
+				.loadOp = VK_ATTACHMENT_LOAD_OP_CLEAR,
+				.storeOp = VK_ATTACHMENT_STORE_OP_STORE,
+				.clearValue = clearValue
+			};
+
+			const VkRenderingInfo renderingInfo = {
+				.sType = VK_STRUCTURE_TYPE_RENDERING_INFO,
+				.pNext = nullptr,
+				.flags = 0,
+				.renderArea = renderArea,
+				.layerCount = 1,
+				.viewMask = 0,
+				.colorAttachmentCount = 1,
+				.pColorAttachments = &colorAttachment,
+				.pDepthAttachment = nullptr,
+				.pStencilAttachment = nullptr
+			};
+
+			m_Engine.getDeviceTable().vkCmdBeginRendering(vCommandBuffer, &renderingInfo);
+			return;
+		}
+
+		// The window's render pass clears the whole image, and it's compatible with the frame buffers as the formats match.
+		const VkRenderPassBeginInfo renderPassBeginInfo = {
+			.sType = VkStructureType::VK_STRUCTURE_TYPE_RENDER_PASS_BEGIN_INFO,
+			.pNext = VK_NULL_HANDLE,
+			.renderPass = m_Window.getRenderPass(),
+			.framebuffer = m_Framebuffers[m_ImageIndex],
+			.renderArea = renderArea,
+			.clearValueCount = 1,
+			.pClearValues = &clearValue,
+		};
+
+		m_Engine.getDeviceTable().vkCmdBeginRenderPass(vCommandBuffer, &renderPassBeginInfo, VkSubpassContents::VK_SUBPASS_CONTENTS_INLINE);
+	}
+
+	void Viewport::end(VkCommandBuffer vCommandBuffer) const
+	{
+		if (m_Engine.isDynamicRenderingEnabled())
+			m_Engine.getDeviceTable().vkCmdEndRendering(vCommandBuffer);
+
+		else
+			m_Engine.getDeviceTable().vkCmdEndRenderPass(vCommandBuffer);
+	}
+
+	void Viewport::createSwapchain()
+	{
+		// Get the surface capabilities.
+		VkSurfaceCapabilitiesKHR surfaceCapabilities = {};
+		utility::ValidateResult(vkGetPhysicalDeviceSurfaceCapabilitiesKHR(m_Engine.getPhysicalDevice(), m_Surface, &surfaceCapabilities), "Failed to get the viewport surface capabilities!");
+
+		// Use the surface's extent if it decides it, otherwise the window's size.
+		if (surfaceCapabilities.currentExtent.width != std::numeric_limits<uint32_t>::max())
+		{
+			m_Extent = surfaceCapabilities.currentExtent;
+		}
+		else
+		{
+			int32_t width = 0, height = 0;
+			SDL_Vulkan_GetDrawableSize(m_pWindow, &width, &height);
+			m_Extent = { static_cast<uint32_t>(width), static_cast<uint32_t>(height) };
+		}
+
+		// A window without an area can't have a swapchain. It's created once the window gets resized.
+		if (m_Extent.width == 0 || m_Extent.height == 0)
+			return;
+
+		// The window's pipelines are used to render the viewport, so the format needs to be the same.
+		uint32_t formatCount = 0;
+		utility::ValidateResult(vkGetPhysicalDeviceSurfaceFormatsKHR(m_Engine.getPhysicalDevice(), m_Surface, &formatCount, nullptr), "Failed to get the viewport surface format count!");
+
+		std::vector<VkSurfaceFormatKHR> surfaceFormats(formatCount);
+		utility::ValidateResult(vkGetPhysicalDeviceSurfaceFormatsKHR(m_Engine.getPhysicalDevice(), m_Surface, &formatCount, surfaceFormats.data()), "Failed to get the viewport surface formats!");
+
+		const auto pSurfaceFormat = std::find_if(surfaceFormats.begin(), surfaceFormats.end(), [this](const VkSurfaceFormatKHR& surfaceFormat) { return surfaceFormat.format == m_Window.getSwapchainFormat(); });
+		if (pSurfaceFormat == surfaceFormats.end())
+		{
+			spdlog::error("The viewport surface doesn't support the window's swapchain format!");
+			return;
+		}
+
+		// Use the window's present settings, so the viewports behave the same way. FIFO is always supported.
+		const auto presentSettings = m_Window.getPresentSettings();
+		uint32_t presentModeCount = 0;
+		utility::ValidateResult(vkGetPhysicalDeviceSurfacePresentModesKHR(m_Engine.getPhysicalDevice(), m_Surface, &presentModeCount, nullptr), "Failed to get the viewport surface present mode count!");
+
+		std::vector<VkPresentModeKHR> presentModes(presentModeCount);
+		utility::ValidateResult(vkGetPhysicalDeviceSurfacePresentModesKHR(m_Engine.getPhysicalDevice(), m_Surface, &presentModeCount, presentModes.data()), "Failed to get the viewport surface present modes!");
+
+		const auto presentMode = std::find(presentModes.begin(), presentModes.end(), presentSettings.m_PresentMode) != presentModes.end() ? presentSettings.m_PresentMode : VK_PRESENT_MODE_FIFO_KHR;
+
+		// Resolve the image count.
+		uint32_t imageCount = std::max(presentSettings.m_ImageCount, surfaceCapabilities.minImageCount);
+		if (surfaceCapabilities.maxImageCount > 0 && imageCount > surfaceCapabilities.maxImageCount)
+			imageCount = surfaceCapabilities.maxImageCount;
+
+		// Resolve the surface composite.
+		VkCompositeAlphaFlagBitsKHR surfaceComposite = static_cast<VkCompositeAlphaFlagBitsKHR>(surfaceCapabilities.supportedCompositeAlpha);
+		surfaceComposite = (surfaceComposite & VK_COMPOSITE_ALPHA_OPAQUE_BIT_KHR)
+			? VK_COMPOSITE_ALPHA_OPAQUE_BIT_KHR
+			: (surfaceComposite & VK_COMPOSITE_ALPHA_PRE_MULTIPLIED_BIT_KHR)
+			? VK_COMPOSITE_ALPHA_PRE_MULTIPLIED_BIT_KHR
+			: (surfaceComposite & VK_COMPOSITE_ALPHA_POST_MULTIPLIED_BIT_KHR)
+			? VK_COMPOSITE_ALPHA_POST_MULTIPLIED_BIT_KHR
+			: VK_COMPOSITE_ALPHA_INHERIT_BIT_KHR;
+
+		VkSwapchainCreateInfoKHR swapchainCreateInfo = {
+			.sType = VkStructureType::VK_STRUCTURE_TYPE_SWAPCHAIN_CREATE_INFO_KHR,
+			.pNext = VK_NULL_HANDLE,
+			.flags = 0,
+			.surface = m_Surface,
+			.minImageCount = imageCount,
+			.imageFormat = pSurfaceFormat->format,
+			.imageColorSpace = pSurfaceFormat->colorSpace,
+			.imageExtent = m_Extent,
+			.imageArrayLayers = 1,
+			.imageUsage = VK_IMAGE_USAGE_COLOR_ATTACHMENT_BIT,
+			.imageSharingMode = VK_SHARING_MODE_EXCLUSIVE,
+			.queueFamilyIndexCount = 0,
+			.pQueueFamilyIndices = nullptr,
+			.preTransform = surfaceCapabilities.currentTransform,
+			.compositeAlpha = surfaceComposite,
+			.presentMode = presentMode,
+			.clipped = VK_TRUE,
+			.oldSwapchain = VK_NULL_HANDLE,
+		};
+
+		// The images are presented on the transfer queue, like the window's.
+		uint32_t queueFamilyindices[2] = {
+				m_Engine.getQueue().getGraphicsFamily().value(),
+				m_Engine.getQueue().getTransferFamily().value()
+		};
+
+		if (m_Engine.getQueue().getGraphicsFamily() != m_Engine.getQueue().getTransferFamily())
+		{
+			swapchainCreateInfo.imageSharingMode = VK_SHARING_MODE_CONCURRENT;
+			swapchainCreateInfo.queueFamilyIndexCount = 2;
+			swapchainCreateInfo.pQueueFamilyIndices = queueFamilyindices;
+		}
+
+		utility::ValidateResult(m_Engine.getDeviceTable().vkCreateSwapchainKHR(m_Engine.getLogicalDevice(), &swapchainCreateInfo, nullptr, &m_Swapchain), "Failed to create the viewport swapchain!");
+
+		// Get the images. The implementation can create more than we asked for.
+		utility::ValidateResult(m_Engine.getDeviceTable().vkGetSwapchainImagesKHR(m_Engine.getLogicalDevice(), m_Swapchain, &imageCount, nullptr), "Failed to get the viewport swapchain image count!");
+
+		m_SwapchainImages.resize(imageCount);
+		utility::ValidateResult(m_Engine.getDeviceTable().vkGetSwapchainImagesKHR(m_Engine.getLogicalDevice(), m_Swapchain, &imageCount, m_SwapchainImages.data()), "Failed to get the viewport swapchain images!");
+
+		// Create the image views.
+		VkImageViewCreateInfo viewCreateInfo = {
+			.sType = VkStructureType::VK_STRUCTURE_TYPE_IMAGE_VIEW_CREATE_INFO,
+			.pNext = VK_NULL_HANDLE,
+			.flags = 0,
+			.viewType = VK_IMAGE_VIEW_TYPE_2D,
+			.format = pSurfaceFormat->format,
+			.components = {},
+			.subresourceRange = {
+				.aspectMask = VK_IMAGE_ASPECT_COLOR_BIT,
+				.baseMipLevel = 0,
+				.levelCount = 1,
+				.baseArrayLayer = 0,
+				.layerCount = 1,
+			}
+		};
+
+		m_SwapchainImageViews.resize(imageCount);
+		for (uint32_t i = 0; i < imageCount; i++)
+		{
+			viewCreateInfo.image = m_SwapchainImages[i];
+			utility::ValidateResult(m_Engine.getDeviceTable().vkCreateImageView(m_Engine.getLogicalDevice(), &viewCreateInfo, nullptr, &m_SwapchainImageViews[i]), "Failed to create the viewport image view!");
+		}
+	}
+
+	void Viewport::createFramebuffers()
+	{
+		if (m_Engine.isDynamicRenderingEnabled())
+			return;
+
+		VkFramebufferCreateInfo frameBufferCreateInfo = {
+			.sType = VkStructureType::VK_STRUCTURE_TYPE_FRAMEBUFFER_CREATE_INFO,
+			.pNext = VK_NULL_HANDLE,
+			.flags = 0,
+			.renderPass = m_Window.getRenderPass(),
+			.attachmentCount = 1,
+			.width = m_Extent.width,
+			.height = m_Extent.height,
+			.layers = 1,
+		};
+
+		m_Framebuffers.resize(m_SwapchainImageViews.size());
+		for (size_t i = 0; i < m_SwapchainImageViews.size(); i++)
+		{
+			frameBufferCreateInfo.pAttachments = &m_SwapchainImageViews[i];
+			utility::ValidateResult(m_Engine.getDeviceTable().vkCreateFramebuffer(m_Engine.getLogicalDevice(), &frameBufferCreateInfo, nullptr, &m_Framebuffers[i]), "Failed to create the viewport frame buffer!");
+		}
+	}
+
+	void Viewport::createSyncObjects()
+	{
+		VkSemaphoreCreateInfo createInfo = {
+			.sType = VK_STRUCTURE_TYPE_SEMAPHORE_CREATE_INFO,
+			.pNext = nullptr,
+			.flags = 0
+		};
+
+		const auto frameCount = m_Window.frameCount();
+		m_ImageAvailableSemaphores.resize(frameCount);
+		m_RenderFinishedSemaphores.resize(frameCount);
+		for (uint32_t i = 0; i < frameCount; i++)
+		{
+			utility::ValidateResult(m_Engine.getDeviceTable().vkCreateSemaphore(m_Engine.getLogicalDevice(), &createInfo, nullptr, &m_ImageAvailableSemaphores[i]), "Failed to create the viewport semaphore!");
+			utility::ValidateResult(m_Engine.getDeviceTable().vkCreateSemaphore(m_Engine.getLogicalDevice(), &createInfo, nullptr, &m_RenderFinishedSemaphores[i]), "Failed to create the viewport semaphore!");
+		}
+	}
+
+	void Viewport::clearSwapchain()
+	{
+		for (const auto vFramebuffer : m_Framebuffers)
+			m_Engine.getDeviceTable().vkDestroyFramebuffer(m_Engine.getLogicalDevice(), vFramebuffer, nullptr);
+
+		for (const auto vImageView : m_SwapchainImageViews)
+			m_Engine.getDeviceTable().vkDestroyImageView(m_Engine.getLogicalDevice(), vImageView, nullptr);
+
+		m_Engine.getDeviceTable().vkDestroySwapchainKHR(m_Engine.getLogicalDevice(), m_Swapchain, nullptr);
+
+		m_Swapchain = VK_NULL_HANDLE;
+		m_Framebuffers.clear();
+		m_SwapchainImages.clear();
+		m_SwapchainImageViews.clear();
+		m_ImageIndex = 0;
+	}
+
+	void Viewport::recreate()
+	{
+		// The images could still be in use by the previous frames.
+		m_Engine.waitIdle();
+
+		clearSwapchain();
+		createSwapchain();
+		createFramebuffers();
+	}
+}
@@ -0,0 +1,206 @@
+// Copyright (c) 2022 Dhiraj Wishal
+
+#pragma once
+
+#include "CommandBufferAllocator.hpp"
+#include "RenderGraph.hpp"
+
+#include <atomic>
+
+namespace rapid
+{
+	class Window;
+
+	/**
+	 * Viewport class.
+	 * A viewport is an additional platform window which is rendered along with a window, like an ImGui window which is
+	 * dragged out of the main window. It has its own surface and swapchain, but uses the window's render pass and
+	 * pipelines, so the swapchain uses the window's format.
+	 *
+	 * Viewports are created and destroyed through their window. Every viewport records to its own command pool, so the
+	 * viewports are recorded on worker threads, and are submitted and presented in the same batch as the window.
+	 */
+	class Viewport final : public BackendObject
+	{
+	public:
+		/**
+		 * Explicit constructor.
+		 *
+		 * @param engine The engine reference.
+		 * @param window The window which owns the viewport.
+		 * @param title The window title.
+		 * @param area The position and the size of the window, in desktop coordinates.
+		 * @param windowFlags The SDL window flags. The window is always created as a Vulkan window.
+		 */
+		explicit Viewport(GraphicsEngine& engine, const Window& window, std::string_view title, VkRect2D area, uint32_t windowFlags);
+
+		/**
+		 * Destructor.
+		 */
+		~Viewport();
+
+		Viewport(const Viewport&) = delete;
+		Viewport& operator=(const Viewport&) = delete;
+
+		/**
+		 * Terminate the object.
+		 */
+		void terminate() override;
+
+		/**
+		 * Invalidate the swapchain.
+		 * This needs to be called when the window is resized. The swapchain is recreated before the next image is acquired.
+		 */
+		void invalidateSwapchain() { m_IsSwapchainInvalid = true; }
+
+		/**
+		 * Acquire the next swapchain image.
+		 * The swapchain is recreated if it's out of date.
+		 *
+		 * @param frameIndex The window's frame index.
+		 * @return Whether or not an image was acquired. Hidden and minimized viewports are not rendered.
+		 */
+		bool acquireImage(uint32_t frameIndex);
+
+		/**
+		 * Begin rendering to the current swapchain image.
+		 * The whole image is cleared, and the image needs to be in the color attachment layout.
+		 *
+		 * @param vCommandBuffer The command buffer to record to.
+		 * @param clearValue The clear value.
+		 */
+		void begin(VkCommandBuffer vCommandBuffer, const VkClearValue& clearValue) const;
+
+		/**
+		 * End rendering to the current swapchain image.
+		 *
+		 * @param vCommandBuffer The command buffer to record to.
+		 */
+		void end(VkCommandBuffer vCommandBuffer) const;
+
+		/**
+		 * Get the SDL window handle.
+		 *
+		 * @return The window handle.
+		 */
+		SDL_Window* getWindowHandle() const { return m_pWindow; }
+
+		/**
+		 * Get the swapchain extent.
+		 *
+		 * @return The extent.
+		 */
+		VkExtent2D extent() const { return m_Extent; }
+
+		/**
+		 * Get the viewport's render graph.
+		 *
+		 * @return The render graph.
+		 */
+		RenderGraph& getRenderGraph() { return *m_RenderGraph; }
+
+		/**
+		 * Get the command buffer of a frame.
+		 *
+		 * @param frameIndex The window's frame index.
+		 * @return The command buffer.
+		 */
+		CommandBuffer getCommandBuffer(uint32_t frameIndex) const { return m_CommandBufferAllocator->getCommandBuffer(frameIndex); }
+
+		/**
+		 * Get the swapchain.
+		 *
+		 * @return The swapchain.
+		 */
+		VkSwapchainKHR getSwapchain() const { return m_Swapchain; }
+
+		/**
+		 * Get the index of the acquired swapchain image.
+		 *
+		 * @return The image index.
+		 */
+		uint32_t getImageIndex() const { return m_ImageIndex; }
+
+		/**
+		 * Get the acquired swapchain image.
+		 *
+		 * @return The image.
+		 */
+		VkImage getCurrentImage() const { return m_SwapchainImages[m_ImageIndex]; }
+
+		/**
+		 * Get the image view of the acquired swapchain image.
+		 *
+		 * @return The image view.
+		 */
+		VkImageView getCurrentImageView() const { return m_SwapchainImageViews[m_ImageIndex]; }
+
+		/**
+		 * Get the semaphore which is signaled when the acquired image is ready to be rendered to.
+		 *
+		 * @param frameIndex The window's frame index.
+		 * @return The semaphore.
+		 */
+		VkSemaphore getImageAvailableSemaphore(uint32_t frameIndex) const { return m_ImageAvailableSemaphores[frameIndex]; }
+
+		/**
+		 * Get the semaphore which is signaled when the frame is rendered.
+		 *
+		 * @param frameIndex The window's frame index.
+		 * @return The semaphore.
+		 */
+		VkSemaphore getRenderFinishedSemaphore(uint32_t frameIndex) const { return m_RenderFinishedSemaphores[frameIndex]; }
+
+	private:
+		/**
+		 * Create the swapchain.
+		 * Nothing is created if the window has no area.
+		 */
+		void createSwapchain();
+
+		/**
+		 * Create the frame buffers.
+		 * Nothing is created if dynamic rendering is enabled.
+		 */
+		void createFramebuffers();
+
+		/**
+		 * Create the semaphores.
+		 */
+		void createSyncObjects();
+
+		/**
+		 * Destroy the swapchain, its image views and the frame buffers.
+		 */
+		void clearSwapchain();
+
+		/**
+		 * Recreate the swapchain and the frame buffers.
+		 */
+		void recreate();
+
+	private:
+		std::vector<VkImage> m_SwapchainImages = {};
+		std::vector<VkImageView> m_SwapchainImageViews = {};
+		std::vector<VkFramebuffer> m_Framebuffers = {};
+
+		std::vector<VkSemaphore> m_ImageAvailableSemaphores = {};
+		std::vector<VkSemaphore> m_RenderFinishedSemaphores = {};
+
+		std::unique_ptr<CommandBufferAllocator> m_CommandBufferAllocator = nullptr;
+		std::unique_ptr<RenderGraph> m_RenderGraph = nullptr;
+
+		GraphicsEngine& m_Engine;
+		const Window& m_Window;
+
+		VkExtent2D m_Extent = {};
+
+		SDL_Window* m_pWindow = nullptr;
+		VkSurfaceKHR m_Surface = VK_NULL_HANDLE;
+		VkSwapchainKHR m_Swapchain = VK_NULL_HANDLE;
+
+		uint32_t m_ImageIndex = 0;
+
+		std::atomic<bool> m_IsSwapchainInvalid = false;
+	};
+}
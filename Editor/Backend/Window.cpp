@@ -8,8 +8,57 @@
 #include <SDL_vulkan.h>
 #include <imgui.h>
 
+#include <algorithm>
+#include <iterator>
+#include <latch>
+
 namespace
 {
+	/**
+	 * The number of frames to render after the last event before going idle.
+	 * ImGui needs a couple of frames to settle its hover and layout states.
+	 */
+	constexpr uint8_t PendingFrameCount = 3;
+
+	/**
+	 * The maximum time to wait for a new event when idling, in milliseconds.
+	 * This makes sure that timed elements like the text cursor still get updated.
+	 */
+	constexpr int32_t IdleTimeout = 500;
+
+	/**
+	 * The color the window and the viewports are cleared to.
+	 */
+	constexpr VkClearValue ClearValue = {
+		.color = {
+			.float32 = {0.0f, 0.0f, 0.0f, 1.0f}
+		}
+	};
+
+	/**
+	 * Check if an event is caused by the user's input.
+	 *
+	 * @param sdlEvent The event to check.
+	 * @return Whether or not the event is an input event.
+	 */
+	bool IsInputEvent(const SDL_Event& sdlEvent)
+	{
+		switch (sdlEvent.type)
+		{
+		case SDL_KEYDOWN:
+		case SDL_KEYUP:
+		case SDL_TEXTINPUT:
+		case SDL_MOUSEMOTION:
+		case SDL_MOUSEBUTTONDOWN:
+		case SDL_MOUSEBUTTONUP:
+		case SDL_MOUSEWHEEL:
+			return true;
+
+		default:
+			return false;
+		}
+	}
+
 	/**
 	 * Get clipboard data.
 	 *
@@ -35,7 +84,7 @@ namespace
 
 namespace rapid
 {
-	Window::Window(GraphicsEngine& engine, std::string_view title)
+	Window::Window(GraphicsEngine& engine, std::string_view title, const PresentSettings& presentSettings)
 		: m_Engine(engine)
 		, m_pWindow(SDL_CreateWindow(title.data(), SDL_WINDOWPOS_UNDEFINED, SDL_WINDOWPOS_UNDEFINED, 1280, 720, SDL_WINDOW_VULKAN | SDL_WINDOW_RESIZABLE | SDL_WINDOW_MAXIMIZED))
 	{
@@ -60,8 +109,9 @@ namespace rapid
 			return;
 		}
 
-		// Get the frame count.
+		// Get the frame count. The swapchain can have more images than the frames in flight.
 		m_FrameCount = getBestBufferCount();
+		m_RequestedPresentSettings = presentSettings;
 
 		// Create the swapchain and the rest of rendering components.
 		createSwapchain();
@@ -69,13 +119,34 @@ namespace rapid
 		createFramebuffers();
 		createSyncObjects();
 
+		// Every image needs to be drawn completely the first time.
+		m_DamageTracker.reset(static_cast<uint32_t>(m_SwapchainImages.size()), extent());
+
 		// Create the command buffer allocator.
 		m_CommandBufferAllocator = std::make_unique<CommandBufferAllocator>(m_Engine, m_FrameCount);
 
+		// Create the readback queue.
+		m_ReadbackQueue = std::make_unique<ReadbackQueue>(m_Engine, m_FrameCount);
+
+		// Create the render graph.
+		m_RenderGraph = std::make_unique<RenderGraph>(m_Engine, m_FrameCount);
+
+		// Create the latency meter. It only records anything while the latency is measured.
+		m_LatencyMeter = std::make_unique<LatencyMeter>(m_Engine, m_FrameCount);
+
+		// Create the memory defragmenter.
+		m_MemoryDefragmenter = std::make_unique<MemoryDefragmenter>(m_Engine, m_FrameCount);
+
+		// Create the GPU profiler. It only records anything while it's enabled.
+		m_GpuProfiler = std::make_unique<GpuProfiler>(m_Engine, m_FrameCount);
+
 		// Now that we're here, let's also set the copy and paste functions.
 		auto& imGuiIO = ImGui::GetIO();
 		imGuiIO.SetClipboardTextFn = SetClipboardText;
 		imGuiIO.GetClipboardTextFn = GetClipboardText;
+
+		// Finally start the render thread. It sleeps till the first frame is submitted.
+		m_RenderThread = std::thread([this] { renderFrames(); });
 	}
 
 	Window::~Window()
@@ -86,16 +157,48 @@ namespace rapid
 
 	void Window::terminate()
 	{
+		// Stop the render thread before destroying anything it uses. A frame which is not picked up yet is dropped.
+		{
+			const auto lock = std::scoped_lock(m_FrameMutex);
+			m_ShouldStop = true;
+		}
+
+		m_FrameCondition.notify_all();
+		if (m_RenderThread.joinable())
+			m_RenderThread.join();
+
+		// The render thread doesn't wait for its submissions, so the GPU could still be using everything.
+		m_Engine.waitIdle();
+
+		// The nodes destroy the viewports they created, the rest are destroyed here.
 		m_ProcessingNodes.clear();
+		m_Viewports.clear();
+		m_RenderGraph.reset();
+		m_LatencyMeter.reset();
+		m_MemoryDefragmenter.reset();
+		m_GpuProfiler.reset();
+
+		// The pending readbacks are dropped, as whatever they would report to might be gone by now.
+		m_ReadbackQueue.reset();
+		m_Captures.clear();
+		m_PendingCaptures.clear();
+		m_ContinuousCapture = {};
+		m_PendingContinuousCapture = {};
 
 		m_CommandBufferAllocator->terminate();
 		m_Engine.getDeviceTable().vkDestroyRenderPass(m_Engine.getLogicalDevice(), m_RenderPass, nullptr);
+		m_Engine.getDeviceTable().vkDestroyRenderPass(m_Engine.getLogicalDevice(), m_LoadRenderPass, nullptr);
+
+		for (const auto vFramebuffer : m_Framebuffers)
+			m_Engine.getDeviceTable().vkDestroyFramebuffer(m_Engine.getLogicalDevice(), vFramebuffer, nullptr);
+
+		m_Framebuffers.clear();
 
 		for (uint32_t i = 0; i < m_FrameCount; i++)
 		{
-			m_Engine.getDeviceTable().vkDestroyFramebuffer(m_Engine.getLogicalDevice(), m_Framebuffers[i], nullptr);
 			m_Engine.getDeviceTable().vkDestroySemaphore(m_Engine.getLogicalDevice(), m_RenderFinishedSemaphores[i], nullptr);
 			m_Engine.getDeviceTable().vkDestroySemaphore(m_Engine.getLogicalDevice(), m_InFlightSemaphores[i], nullptr);
+			m_Engine.getDeviceTable().vkDestroyFence(m_Engine.getLogicalDevice(), m_InFlightFences[i], nullptr);
 		}
 
 		clearSwapchain();
@@ -103,64 +206,491 @@ namespace rapid
 		m_IsTerminated = true;
 	}
 
+	void Window::invalidate()
+	{
+		m_IsInvalidated = true;
+
+		// Wake up pollEvents if it's waiting for events.
+		SDL_Event sdlEvent = {};
+		sdlEvent.type = SDL_USEREVENT;
+		SDL_PushEvent(&sdlEvent);
+	}
+
 	bool Window::pollEvents()
 	{
+		m_Events.clear();
+
+		// Don't get more than a frame ahead of the render thread, as the frames would be replaced before they're rendered.
+		// The render thread hands the submitted frame over to the nodes meanwhile.
+		auto lock = std::unique_lock(m_FrameMutex);
+		m_FrameCondition.wait(lock, [this] { return !m_HasPendingFrame; });
+
+		const auto shouldIdle = canIdle();
+		lock.unlock();
+
 		SDL_Event sdlEvent = {};
-		[[maybe_unused]] const auto isAvailable = SDL_PollEvent(&sdlEvent);
+		auto isAvailable = SDL_PollEvent(&sdlEvent);
 
-		// Close the application.
-		if (sdlEvent.type == SDL_QUIT)
-			return false;
+		// If nothing happened and nothing is animating, we can wait till something happens.
+		if (!isAvailable && shouldIdle)
+			isAvailable = SDL_WaitEventTimeout(&sdlEvent, IdleTimeout);
+
+		// Drain the whole event queue so that every event gets handled in this frame.
+		while (isAvailable)
+		{
+			// Close the application. SDL only quits once every window is closed, so closing the main window is checked too.
+			if (sdlEvent.type == SDL_QUIT || (sdlEvent.type == SDL_WINDOWEVENT && sdlEvent.window.event == SDL_WINDOWEVENT_CLOSE && sdlEvent.window.windowID == SDL_GetWindowID(m_pWindow)))
+				return false;
 
-		ImGui::GetIO().MouseDrawCursor = m_pWindow == SDL_GetMouseFocus();
+			// The event's timestamp is when SDL received it, which can be a while before we poll it.
+			if (m_IsMeasuringLatency && IsInputEvent(sdlEvent))
+			{
+				const auto inputTime = LatencyMeter::clock_type::now() - std::chrono::milliseconds(SDL_GetTicks() - sdlEvent.common.timestamp);
+				if (!m_InputTime || inputTime < *m_InputTime)
+					m_InputTime = inputTime;
+			}
+
+			addEvent(sdlEvent);
+			isAvailable = SDL_PollEvent(&sdlEvent);
+		}
+
+		// Render a few more frames after the last event so that the UI can settle down.
+		if (!m_Events.empty())
+			m_PendingFrames = PendingFrameCount;
+
+		else if (m_PendingFrames > 0)
+			m_PendingFrames--;
+
+		m_IsInvalidated = false;
+
+		// The cursor is hidden on every window, including the viewports, so it needs to be drawn whenever one has the mouse.
+		ImGui::GetIO().MouseDrawCursor = SDL_GetMouseFocus() != nullptr;
 
 		// Transmit the data to the nodes.
 		for (auto& pNode : m_ProcessingNodes)
-			pNode->onPollEvents(sdlEvent);
+			pNode->onPollEvents(m_Events);
+
+		return true;
+	}
+
+	void Window::submitFrame()
+	{
+		// The next frame is built while this one is rendered, so the nodes need to copy what they render now.
+		for (auto& pNode : m_ProcessingNodes)
+			pNode->endFrame();
 
-		// Acquire the next swapchain image.
-		const auto result = m_Engine.getDeviceTable().vkAcquireNextImageKHR(m_Engine.getLogicalDevice(), m_Swapchain, std::numeric_limits<uint64_t>::max(), m_InFlightSemaphores[m_FrameIndex], VK_NULL_HANDLE, &m_ImageIndex);
-		if (result == VkResult::VK_ERROR_OUT_OF_DATE_KHR || result == VkResult::VK_SUBOPTIMAL_KHR)
 		{
-			recreate();
-			return pollEvents();
+			const auto lock = std::scoped_lock(m_FrameMutex);
+			m_HasPendingFrame = true;
 		}
 
-		utility::ValidateResult(result, "Failed to acquire the next swap chain image!");
-		return true;
+		m_FrameCondition.notify_all();
 	}
 
-	void Window::submitFrame()
+	void Window::renderFrames()
+	{
+		while (true)
+		{
+			// Wait till a frame is submitted.
+			{
+				auto lock = std::unique_lock(m_FrameMutex);
+				m_FrameCondition.wait(lock, [this] { return m_ShouldStop || m_HasPendingFrame; });
+
+				if (m_ShouldStop)
+					return;
+
+				// The UI thread doesn't create or destroy viewports till we're done with the frame.
+				m_IsRendering = true;
+				m_FrameViewports.clear();
+				for (const auto& pViewport : m_Viewports)
+					m_FrameViewports.emplace_back(pViewport.get());
+			}
+
+			// Wait till the frame's previous submission is done, so its resources can be reused and its readbacks are ready.
+			utility::ValidateResult(m_Engine.getDeviceTable().vkWaitForFences(m_Engine.getLogicalDevice(), 1, &m_InFlightFences[m_FrameIndex], VK_TRUE, std::numeric_limits<uint64_t>::max()), "Failed to wait for the frame fence!");
+			m_ReadbackQueue->complete(m_FrameIndex);
+			m_MemoryDefragmenter->complete(m_FrameIndex);
+
+			// The UI thread waits for the frame to be handed over, so acquiring and recreating the swapchain doesn't need
+			// the frame lock. The frame is dropped if there's no image to render to. The nodes keep their pending frame, so
+			// the next one carries its damage.
+			const auto isImageAcquired = acquireImage();
+			if (isImageAcquired)
+			{
+				std::erase_if(m_FrameViewports, [this](Viewport* pViewport) { return !pViewport->acquireImage(m_FrameIndex); });
+
+				// The allocator refreshes the heap budgets when the frame index changes. The nodes write their buffers from
+				// here on, so the buffers know which frame wrote them.
+				m_Engine.setCurrentFrameIndex(++m_FrameNumber);
+
+				for (auto& pNode : m_ProcessingNodes)
+					pNode->swapFrame(m_FrameIndex);
+			}
+
+			// The UI thread can start the next frame now.
+			{
+				const auto lock = std::scoped_lock(m_FrameMutex);
+				m_HasPendingFrame = false;
+				m_IsReadingBack = m_ReadbackQueue->isBusy();
+
+				if (isImageAcquired)
+				{
+					std::move(m_PendingCaptures.begin(), m_PendingCaptures.end(), std::back_inserter(m_Captures));
+					m_PendingCaptures.clear();
+					m_ContinuousCapture = m_PendingContinuousCapture;
+
+					m_FrameInputTime = std::exchange(m_InputTime, std::nullopt);
+					m_IsFrameMeasured = m_IsMeasuringLatency;
+				}
+				else
+				{
+					m_IsRendering = false;
+				}
+			}
+
+			m_FrameCondition.notify_all();
+			if (!isImageAcquired)
+				continue;
+
+			const auto damage = recordFrame();
+			m_FrameIndex = ++m_FrameIndex % m_FrameCount;
+			present(damage);
+
+			// Viewports can be created and destroyed now that they're not used.
+			{
+				const auto lock = std::scoped_lock(m_FrameMutex);
+				m_IsRendering = false;
+				m_IsReadingBack = m_ReadbackQueue->isBusy();
+			}
+
+			m_FrameCondition.notify_all();
+		}
+	}
+
+	bool Window::acquireImage()
+	{
+		// Nothing is shown while the window is minimized, and a swapchain can't be created without an extent.
+		if (isMinimized())
+			return false;
+
+		// Apply the new present settings before acquiring from the old swapchain.
+		if (m_ShouldRecreate)
+			recreate();
+
+		// Acquire the next swapchain image. If the swapchain is out of date, recreate it and try again. The semaphore is
+		// not signaled in that case, and the recreated swapchain comes with new ones.
+		while (true)
+		{
+			const auto result = m_Engine.getDeviceTable().vkAcquireNextImageKHR(m_Engine.getLogicalDevice(), m_Swapchain, std::numeric_limits<uint64_t>::max(), m_InFlightSemaphores[m_FrameIndex], VK_NULL_HANDLE, &m_ImageIndex);
+			if (result == VkResult::VK_ERROR_OUT_OF_DATE_KHR)
+			{
+				recreate();
+
+				// The window could have been minimized meanwhile.
+				if (isMinimized())
+					return false;
+
+				continue;
+			}
+
+			// A suboptimal image can still be presented, so the swapchain is only recreated once the frame is presented.
+			if (result == VkResult::VK_SUBOPTIMAL_KHR)
+			{
+				m_ShouldRecreate = true;
+				return true;
+			}
+
+			utility::ValidateResult(result, "Failed to acquire the next swap chain image!");
+			return result == VkResult::VK_SUCCESS;
+		}
+	}
+
+	VkRect2D Window::recordFrame()
 	{
+		// The viewports record to their own command pools, so they're recorded on the shared worker threads while the window is recorded here. They're
+		// submitted as high priority, so background work like decoding images doesn't hold the frame up.
+		auto viewportLatch = std::latch(static_cast<ptrdiff_t>(m_FrameViewports.size()));
+		for (const auto pViewport : m_FrameViewports)
+		{
+			GetSharedThreadPool().submit([this, pViewport, &viewportLatch]
+				{
+					recordViewport(*pViewport);
+					viewportLatch.count_down();
+				}, TaskPriority::High);
+		}
+
+		// Prepare the nodes and get the area which changed since the last frame.
+		VkRect2D damage = {};
+		for (auto& pNode : m_ProcessingNodes)
+			damage = utility::Combine(damage, pNode->prepare(m_FrameIndex));
+
+		damage = m_DamageTracker.addDamage(damage);
+
+		// The image might be a few frames old, so we need to redraw everything that changed since then.
+		m_RenderArea = m_DamageTracker.getDamage(m_ImageIndex);
+
+		// If the previous contents are not loaded, they don't need to be kept either.
+		auto& graph = *m_RenderGraph;
+		const auto swapchainImage = graph.importImage("Swapchain", m_SwapchainImages[m_ImageIndex], m_SwapchainImageViews[m_ImageIndex], shouldLoadPreviousContent() ? VK_IMAGE_LAYOUT_PRESENT_SRC_KHR : VK_IMAGE_LAYOUT_UNDEFINED, ResourceUsage::Present);
+
+		// The nodes add their offscreen work first.
+		for (auto& pNode : m_ProcessingNodes)
+			pNode->addPasses(graph, m_FrameIndex);
+
+		// We don't have to draw anything if the image is up to date.
+		if (!utility::IsEmpty(m_RenderArea))
+		{
+			graph.addPass("Window", [this, swapchainImage](RenderGraph::PassBuilder& builder)
+				{
+					builder.write(swapchainImage, ResourceUsage::ColorAttachment);
+
+					for (const auto& pNode : m_ProcessingNodes)
+						pNode->declareResources(builder);
+				},
+				[this](CommandBuffer commandBuffer)
+				{
+					// Bind the render pass.
+					commandBuffer.bindWindow(*this, { ClearValue });
+
+					// Bind all the nodes.
+					for (auto& pNode : m_ProcessingNodes)
+					{
+						const auto scope = GpuScope(m_GpuProfiler.get(), commandBuffer.buffer(), pNode->getName());
+						pNode->bind(commandBuffer, m_FrameIndex);
+					}
+
+					// End the render pass.
+					commandBuffer.unbindWindow();
+				}
+			);
+
+			if (m_ContinuousCapture.first)
+				m_Captures.emplace_back(m_ContinuousCapture);
+		}
+
+		// Record the readbacks after rendering, so the captures contain this frame.
+		graph.addPass("Readback", [this, swapchainImage](RenderGraph::PassBuilder& builder)
+			{
+				builder.setSideEffects();
+
+				if (!m_Captures.empty())
+					builder.read(swapchainImage, ResourceUsage::TransferSource);
+			},
+			[this](CommandBuffer commandBuffer)
+			{
+				captureSwapchainImage();
+				m_ReadbackQueue->record(commandBuffer.buffer(), m_FrameIndex);
+			}
+		);
+
 		auto commandBuffer = m_CommandBufferAllocator->getCommandBuffer(m_FrameIndex);
 		commandBuffer.begin();
 
-		// Set the clear value.
-		VkClearValue clearValue = {
-			.color = {
-				.float32 = {0.0f, 0.0f, 0.0f, 1.0f}
+		m_LatencyMeter->beginFrame(commandBuffer.buffer(), m_FrameIndex, m_FrameInputTime, m_IsFrameMeasured);
+
+		m_GpuProfiler->beginFrame(commandBuffer.buffer(), m_FrameIndex);
+		graph.execute(commandBuffer, m_GpuProfiler.get());
+
+		if (m_IsFrameMeasured)
+			m_LatencyMeter->endFrame(commandBuffer.buffer());
+
+		// The viewports write their buffers while they're recorded, so the allocations are moved once they're done.
+		viewportLatch.wait();
+		m_MemoryDefragmenter->update(commandBuffer.buffer(), m_FrameIndex);
+
+		// End the command buffer.
+		commandBuffer.end();
+
+		// Submit the window and the viewports together, so several windows don't cost more submissions.
+		auto& submission = m_Submission;
+		submission.m_CommandBuffers.assign(1, commandBuffer.buffer());
+		submission.m_WaitSemaphores.assign(1, m_InFlightSemaphores[m_FrameIndex]);
+		submission.m_SignalSemaphores.assign(1, m_RenderFinishedSemaphores[m_FrameIndex]);
+		submission.m_Swapchains.assign(1, m_Swapchain);
+		submission.m_ImageIndices.assign(1, m_ImageIndex);
+
+		for (const auto pViewport : m_FrameViewports)
+		{
+			submission.m_CommandBuffers.emplace_back(pViewport->getCommandBuffer(m_FrameIndex).buffer());
+			submission.m_WaitSemaphores.emplace_back(pViewport->getImageAvailableSemaphore(m_FrameIndex));
+			submission.m_SignalSemaphores.emplace_back(pViewport->getRenderFinishedSemaphore(m_FrameIndex));
+			submission.m_Swapchains.emplace_back(pViewport->getSwapchain());
+			submission.m_ImageIndices.emplace_back(pViewport->getImageIndex());
+		}
+
+		if (m_IsFrameMeasured)
+			m_LatencyMeter->markSubmit();
+
+		m_GpuProfiler->markSubmit();
+
+		// Submit the commands. The fence tells when the frame's resources can be reused.
+		const auto vFence = m_InFlightFences[m_FrameIndex];
+		utility::ValidateResult(m_Engine.getDeviceTable().vkResetFences(m_Engine.getLogicalDevice(), 1, &vFence), "Failed to reset the frame fence!");
+		CommandBuffer::Submit(m_Engine, submission.m_CommandBuffers, submission.m_WaitSemaphores, submission.m_SignalSemaphores, false, vFence);
+
+		// The queue executes the frames in order, so the image is up to date for anything which uses it after this.
+		m_DamageTracker.validate(m_ImageIndex);
+
+		return damage;
+	}
+
+	void Window::recordViewport(Viewport& viewport)
+	{
+		// Viewports are small and rarely change, so they're redrawn completely every frame.
+		auto& graph = viewport.getRenderGraph();
+		const auto swapchainImage = graph.importImage("Swapchain", viewport.getCurrentImage(), viewport.getCurrentImageView(), VK_IMAGE_LAYOUT_UNDEFINED, ResourceUsage::Present);
+
+		graph.addPass("Viewport", [swapchainImage](RenderGraph::PassBuilder& builder)
+			{
+				builder.write(swapchainImage, ResourceUsage::ColorAttachment);
+			},
+			[this, &viewport](CommandBuffer commandBuffer)
+			{
+				viewport.begin(commandBuffer.buffer(), ClearValue);
+
+				for (auto& pNode : m_ProcessingNodes)
+					pNode->bindViewport(commandBuffer, viewport, m_FrameIndex);
+
+				viewport.end(commandBuffer.buffer());
 			}
-		};
+		);
 
-		// Bind the render pass.
-		commandBuffer.bindWindow(*this, { clearValue });
+		auto commandBuffer = viewport.getCommandBuffer(m_FrameIndex);
+		commandBuffer.begin();
 
-		// Bind all the nodes.
-		for (auto& pNode : m_ProcessingNodes)
-			pNode->bind(commandBuffer, m_FrameIndex);
+		graph.execute(commandBuffer);
 
-		// End the render pass and command buffer.
-		commandBuffer.unbindWindow();
 		commandBuffer.end();
+	}
+
+	Viewport& Window::createViewport(std::string_view title, VkRect2D area, uint32_t windowFlags)
+	{
+		auto pViewport = std::make_unique<Viewport>(m_Engine, *this, title, area, windowFlags);
+
+		// The render thread could be copying the viewports of the previous frame, so it needs to be done with it first.
+		auto lock = std::unique_lock(m_FrameMutex);
+		m_FrameCondition.wait(lock, [this] { return !m_IsRendering; });
+
+		return *m_Viewports.emplace_back(std::move(pViewport));
+	}
+
+	void Window::destroyViewport(Viewport& viewport)
+	{
+		// The render thread can't start another frame meanwhile, as the current one is not submitted yet.
+		auto lock = std::unique_lock(m_FrameMutex);
+		m_FrameCondition.wait(lock, [this] { return !m_IsRendering; });
+
+		m_Engine.waitIdle();
+		std::erase_if(m_Viewports, [&viewport](const std::unique_ptr<Viewport>& pViewport) { return pViewport.get() == &viewport; });
+	}
+
+	void Window::setPresentSettings(const PresentSettings& settings)
+	{
+		{
+			const auto lock = std::scoped_lock(m_PresentSettingsMutex);
+			m_RequestedPresentSettings = settings;
+		}
+
+		m_ShouldRecreate = true;
+
+		// The viewports use the window's settings, so they need to be recreated as well.
+		for (const auto& pViewport : m_Viewports)
+			pViewport->invalidateSwapchain();
+	}
+
+	PresentSettings Window::getPresentSettings() const
+	{
+		const auto lock = std::scoped_lock(m_PresentSettingsMutex);
+		return m_PresentSettings;
+	}
+
+	std::vector<VkPresentModeKHR> Window::getSupportedPresentModes() const
+	{
+		uint32_t presentModeCount = 0;
+		utility::ValidateResult(vkGetPhysicalDeviceSurfacePresentModesKHR(m_Engine.getPhysicalDevice(), m_Surface, &presentModeCount, nullptr), "Failed to get the surface present mode count!");
+
+		std::vector<VkPresentModeKHR> presentModes(presentModeCount);
+		utility::ValidateResult(vkGetPhysicalDeviceSurfacePresentModesKHR(m_Engine.getPhysicalDevice(), m_Surface, &presentModeCount, presentModes.data()), "Failed to get the surface present modes!");
+
+		return presentModes;
+	}
+
+	void Window::captureFrame(ReadbackCallback&& callback, VkFormat outputFormat)
+	{
+		if (!m_IsCaptureSupported)
+		{
+			spdlog::error("The swapchain images cannot be captured on this surface!");
+			return;
+		}
+
+		{
+			const auto lock = std::scoped_lock(m_FrameMutex);
+			m_PendingCaptures.emplace_back(std::move(callback), outputFormat);
+		}
+
+		invalidate();
+	}
+
+	void Window::setContinuousCapture(ReadbackCallback&& callback, VkFormat outputFormat)
+	{
+		const auto lock = std::scoped_lock(m_FrameMutex);
+		m_PendingContinuousCapture = { std::move(callback), outputFormat };
+	}
+
+	void Window::addEvent(const SDL_Event& sdlEvent)
+	{
+		if (!m_Events.empty())
+		{
+			auto& previous = m_Events.back();
+
+			// Only the last mouse position matters, so we can replace the previous motion event.
+			if (sdlEvent.type == SDL_MOUSEMOTION && previous.type == SDL_MOUSEMOTION && sdlEvent.motion.windowID == previous.motion.windowID)
+			{
+				const auto relativeX = previous.motion.xrel + sdlEvent.motion.xrel;
+				const auto relativeY = previous.motion.yrel + sdlEvent.motion.yrel;
+
+				previous = sdlEvent;
+				previous.motion.xrel = relativeX;
+				previous.motion.yrel = relativeY;
+				return;
+			}
 
-		// Submit the commands.
-		commandBuffer.submit(m_RenderFinishedSemaphores[m_FrameIndex], m_InFlightSemaphores[m_FrameIndex], true);	// Remove the true here later.
+			// Wheel events can be accumulated.
+			if (sdlEvent.type == SDL_MOUSEWHEEL && previous.type == SDL_MOUSEWHEEL && sdlEvent.wheel.windowID == previous.wheel.windowID && sdlEvent.wheel.direction == previous.wheel.direction)
+			{
+				previous.wheel.x += sdlEvent.wheel.x;
+				previous.wheel.y += sdlEvent.wheel.y;
+				previous.wheel.preciseX += sdlEvent.wheel.preciseX;
+				previous.wheel.preciseY += sdlEvent.wheel.preciseY;
+				previous.wheel.timestamp = sdlEvent.wheel.timestamp;
+				return;
+			}
+		}
 
-		// Finally, increment the frame index.
-		m_FrameIndex = ++m_FrameIndex % m_FrameCount;
+		m_Events.emplace_back(sdlEvent);
+	}
 
-		// We can now present it.
-		present();
+	bool Window::canIdle() const
+	{
+		// Frames are not rendered while the window is minimized, so there's no point in building them.
+		if (isMinimized())
+			return true;
+
+		if (!m_IsIdleModeEnabled || m_IsInvalidated || m_PendingFrames > 0)
+			return false;
+
+		// Keep rendering till the readbacks complete, otherwise their callbacks would be delayed until the next input.
+		if (m_IsReadingBack || !m_PendingCaptures.empty())
+			return false;
+
+		// We cannot idle if any of the nodes are animating.
+		for (const auto& pNode : m_ProcessingNodes)
+		{
+			if (pNode->isAnimating())
+				return false;
+		}
+
+		return true;
 	}
 
 	uint32_t Window::getBestBufferCount() const
@@ -177,6 +707,17 @@ namespace rapid
 		return bufferCount;
 	}
 
+	bool Window::isMinimized() const
+	{
+		if (SDL_GetWindowFlags(m_pWindow) & SDL_WINDOW_MINIMIZED)
+			return true;
+
+		int32_t width = 0, height = 0;
+		SDL_Vulkan_GetDrawableSize(m_pWindow, &width, &height);
+
+		return width == 0 || height == 0;
+	}
+
 	void Window::refreshExtent()
 	{
 		int32_t width = 0, height = 0;
@@ -261,21 +802,23 @@ namespace rapid
 		std::vector<VkPresentModeKHR> presentModes(presentModeCount);
 		utility::ValidateResult(vkGetPhysicalDeviceSurfacePresentModesKHR(m_Engine.getPhysicalDevice(), m_Surface, &presentModeCount, presentModes.data()), "Failed to get the surface present modes!");
 
-		// Check if we have the present mode we need.
-		bool bPresentModeAvailable = false;
-		VkPresentModeKHR presentMode = VK_PRESENT_MODE_MAILBOX_KHR;
-		for (const auto availablePresentMode : presentModes)
+		// The settings could be requested again meanwhile, so they're copied once.
+		PresentSettings requestedSettings = {};
 		{
-			if (availablePresentMode == presentMode)
-			{
-				bPresentModeAvailable = true;
-				break;
-			}
+			const auto lock = std::scoped_lock(m_PresentSettingsMutex);
+			requestedSettings = m_RequestedPresentSettings;
 		}
 
-		// If not available, let's just use the first one we got.
-		if (!bPresentModeAvailable)
-			presentMode = presentModes.front();
+		// Use the requested present mode if it's available. FIFO is always supported.
+		auto presentMode = requestedSettings.m_PresentMode;
+		if (std::find(presentModes.begin(), presentModes.end(), presentMode) == presentModes.end())
+			presentMode = VK_PRESENT_MODE_FIFO_KHR;
+
+		// Resolve the image count within what the surface supports.
+		uint32_t imageCount = requestedSettings.m_ImageCount > 0 ? requestedSettings.m_ImageCount : surfaceCapabilities.minImageCount + 1;
+		imageCount = std::max(imageCount, surfaceCapabilities.minImageCount);
+		if (surfaceCapabilities.maxImageCount > 0)
+			imageCount = std::min(imageCount, surfaceCapabilities.maxImageCount);
 
 		// Resolve the surface composite.
 		VkCompositeAlphaFlagBitsKHR surfaceComposite = static_cast<VkCompositeAlphaFlagBitsKHR>(surfaceCapabilities.supportedCompositeAlpha);
@@ -297,6 +840,9 @@ namespace rapid
 
 		m_SwapchainFormat = surfaceFormat.format;
 
+		// The images need to be transfer sources to be captured.
+		m_IsCaptureSupported = surfaceCapabilities.supportedUsageFlags & VK_IMAGE_USAGE_TRANSFER_SRC_BIT;
+
 		// Get the extent.
 		const auto imageExtent = extent();
 
@@ -306,12 +852,12 @@ namespace rapid
 			.pNext = VK_NULL_HANDLE,
 			.flags = 0,
 			.surface = m_Surface,
-			.minImageCount = m_FrameCount,
+			.minImageCount = imageCount,
 			.imageFormat = m_SwapchainFormat,
 			.imageColorSpace = surfaceFormat.colorSpace,
 			.imageExtent = imageExtent,
 			.imageArrayLayers = 1,
-			.imageUsage = VK_IMAGE_USAGE_COLOR_ATTACHMENT_BIT,
+			.imageUsage = VK_IMAGE_USAGE_COLOR_ATTACHMENT_BIT | (m_IsCaptureSupported ? VK_IMAGE_USAGE_TRANSFER_SRC_BIT : 0u),
 			.imageSharingMode = VK_SHARING_MODE_EXCLUSIVE,
 			.queueFamilyIndexCount = 0,
 			.pQueueFamilyIndices = nullptr,
@@ -337,9 +883,23 @@ namespace rapid
 
 		utility::ValidateResult(m_Engine.getDeviceTable().vkCreateSwapchainKHR(m_Engine.getLogicalDevice(), &swapchainCreateInfo, nullptr, &m_Swapchain), "Failed to create the swapchain!");
 
-		// Get the image views.
-		m_SwapchainImages.resize(swapchainCreateInfo.minImageCount);
-		utility::ValidateResult(m_Engine.getDeviceTable().vkGetSwapchainImagesKHR(m_Engine.getLogicalDevice(), m_Swapchain, &swapchainCreateInfo.minImageCount, m_SwapchainImages.data()), "Failed to get the swapchain images!");
+		// Get the images. The implementation can create more than we asked for.
+		utility::ValidateResult(m_Engine.getDeviceTable().vkGetSwapchainImagesKHR(m_Engine.getLogicalDevice(), m_Swapchain, &imageCount, nullptr), "Failed to get the swapchain image count!");
+
+		m_SwapchainImages.resize(imageCount);
+		utility::ValidateResult(m_Engine.getDeviceTable().vkGetSwapchainImagesKHR(m_Engine.getLogicalDevice(), m_Swapchain, &imageCount, m_SwapchainImages.data()), "Failed to get the swapchain images!");
+
+		// Let the user know when the settings change, as they might not be the requested ones.
+		if (presentMode != m_PresentSettings.m_PresentMode || imageCount != m_PresentSettings.m_ImageCount)
+		{
+			spdlog::info("Presenting using {} with {} images (requested {} with {} images).", utility::GetPresentModeName(presentMode), imageCount,
+				utility::GetPresentModeName(requestedSettings.m_PresentMode), requestedSettings.m_ImageCount);
+		}
+
+		{
+			const auto lock = std::scoped_lock(m_PresentSettingsMutex);
+			m_PresentSettings = { .m_PresentMode = presentMode, .m_ImageCount = imageCount };
+		}
 
 		// Finally we can resolve the swapchain image views.
 		resolveImageViews();
@@ -347,6 +907,10 @@ namespace rapid
 
 	void Window::createRenderPass()
 	{
+		// Dynamic rendering doesn't need render passes.
+		if (m_Engine.isDynamicRenderingEnabled())
+			return;
+
 		// Crate attachment descriptions.
 		VkAttachmentDescription attachmentDescription = {
 			.flags = 0,
@@ -356,8 +920,8 @@ namespace rapid
 			.storeOp = VK_ATTACHMENT_STORE_OP_STORE,
 			.stencilLoadOp = VK_ATTACHMENT_LOAD_OP_DONT_CARE,
 			.stencilStoreOp = VK_ATTACHMENT_STORE_OP_DONT_CARE,
-			.initialLayout = VK_IMAGE_LAYOUT_UNDEFINED,
-			.finalLayout = VK_IMAGE_LAYOUT_PRESENT_SRC_KHR
+			.initialLayout = VK_IMAGE_LAYOUT_COLOR_ATTACHMENT_OPTIMAL,
+			.finalLayout = VK_IMAGE_LAYOUT_COLOR_ATTACHMENT_OPTIMAL
 		};
 
 		// Create the subpass dependencies.
@@ -411,10 +975,19 @@ namespace rapid
 		};
 
 		utility::ValidateResult(m_Engine.getDeviceTable().vkCreateRenderPass(m_Engine.getLogicalDevice(), &renderPassCreateInfo, nullptr, &m_RenderPass), "Failed to create render pass!");
+
+		// Create the load render pass. This keeps the previous contents of the image so that we only have to redraw the damaged area.
+		attachmentDescription.loadOp = VK_ATTACHMENT_LOAD_OP_LOAD;
+
+		utility::ValidateResult(m_Engine.getDeviceTable().vkCreateRenderPass(m_Engine.getLogicalDevice(), &renderPassCreateInfo, nullptr, &m_LoadRenderPass), "Failed to create the load render pass!");
 	}
 
 	void Window::createFramebuffers()
 	{
+		// Dynamic rendering renders straight to the image views, so there's nothing to rebuild when the window is resized.
+		if (m_Engine.isDynamicRenderingEnabled())
+			return;
+
 		const auto imageExtent = extent();
 
 		VkFramebufferCreateInfo frameBufferCreateInfo = {
@@ -429,8 +1002,8 @@ namespace rapid
 		};
 
 		// Iterate and create the frame buffers.
-		m_Framebuffers.resize(m_FrameCount);
-		for (uint8_t i = 0; i < m_FrameCount; i++)
+		m_Framebuffers.resize(m_SwapchainImageViews.size());
+		for (size_t i = 0; i < m_Framebuffers.size(); i++)
 		{
 			frameBufferCreateInfo.pAttachments = &m_SwapchainImageViews[i];
 			utility::ValidateResult(m_Engine.getDeviceTable().vkCreateFramebuffer(m_Engine.getLogicalDevice(), &frameBufferCreateInfo, nullptr, &m_Framebuffers[i]), "Failed to create the frame buffer!");
@@ -445,9 +1018,17 @@ namespace rapid
 			.flags = 0
 		};
 
+		// The fences start signaled, as the frames have nothing to wait for the first time.
+		VkFenceCreateInfo fenceCreateInfo = {
+			.sType = VK_STRUCTURE_TYPE_FENCE_CREATE_INFO,
+			.pNext = nullptr,
+			.flags = VK_FENCE_CREATE_SIGNALED_BIT
+		};
+
 		m_RenderFinishedSemaphores.reserve(m_FrameCount);
 		m_InFlightSemaphores.reserve(m_FrameCount);
-		for (uint8_t i = 0; i < m_FrameCount; i++)
+		m_InFlightFences.reserve(m_FrameCount);
+		for (uint32_t i = 0; i < m_FrameCount; i++)
 		{
 			VkSemaphore vRenderFinishedSemaphore = VK_NULL_HANDLE;
 			utility::ValidateResult(m_Engine.getDeviceTable().vkCreateSemaphore(m_Engine.getLogicalDevice(), &createInfo, nullptr, &vRenderFinishedSemaphore), "Failed to create the frame buffer!");
@@ -456,27 +1037,83 @@ namespace rapid
 			VkSemaphore vInFlightSemaphore = VK_NULL_HANDLE;
 			utility::ValidateResult(m_Engine.getDeviceTable().vkCreateSemaphore(m_Engine.getLogicalDevice(), &createInfo, nullptr, &vInFlightSemaphore), "Failed to create the frame buffer!");
 			m_InFlightSemaphores.emplace_back(vInFlightSemaphore);
+
+			VkFence vInFlightFence = VK_NULL_HANDLE;
+			utility::ValidateResult(m_Engine.getDeviceTable().vkCreateFence(m_Engine.getLogicalDevice(), &fenceCreateInfo, nullptr, &vInFlightFence), "Failed to create the frame fence!");
+			m_InFlightFences.emplace_back(vInFlightFence);
 		}
 	}
 
-	void Window::present()
+	void Window::captureSwapchainImage()
 	{
+		// Every swapchain format we pick uses four bytes per pixel.
+		for (auto& [callback, outputFormat] : m_Captures)
+			m_ReadbackQueue->readImage(m_SwapchainImages[m_ImageIndex], { m_Extent.width, m_Extent.height, 1 }, m_SwapchainFormat, 4, VK_IMAGE_LAYOUT_TRANSFER_SRC_OPTIMAL, std::move(callback), outputFormat);
+
+		m_Captures.clear();
+	}
+
+	void Window::present(VkRect2D damage)
+	{
+		auto& submission = m_Submission;
+		submission.m_Results.resize(submission.m_Swapchains.size());
+
 		VkPresentInfoKHR presentInfo = {
 			.sType = VkStructureType::VK_STRUCTURE_TYPE_PRESENT_INFO_KHR,
 			.pNext = nullptr,
-			.waitSemaphoreCount = 1,
-			.pWaitSemaphores = &m_RenderFinishedSemaphores[m_ImageIndex],
-			.swapchainCount = 1,
-			.pSwapchains = &m_Swapchain,
-			.pImageIndices = &m_ImageIndex,
-			.pResults = VK_NULL_HANDLE,
+			.waitSemaphoreCount = static_cast<uint32_t>(submission.m_SignalSemaphores.size()),
+			.pWaitSemaphores = submission.m_SignalSemaphores.data(),
+			.swapchainCount = static_cast<uint32_t>(submission.m_Swapchains.size()),
+			.pSwapchains = submission.m_Swapchains.data(),
+			.pImageIndices = submission.m_ImageIndices.data(),
+			.pResults = submission.m_Results.data(),
+		};
+
+		// Let the presentation engine know which part of the image changed, if it supports it.
+		// An empty region would mean that the whole image changed, so we report a single pixel if nothing did.
+		VkRectLayerKHR presentRectangle = {
+			.offset = damage.offset,
+			.extent = utility::IsEmpty(damage) ? VkExtent2D{ 1, 1 } : damage.extent,
+			.layer = 0
 		};
 
+		// The viewports are redrawn completely, which is what an empty region means.
+		submission.m_PresentRegions.assign(submission.m_Swapchains.size(), VkPresentRegionKHR{ .rectangleCount = 0, .pRectangles = nullptr });
+		submission.m_PresentRegions.front() = {
+			.rectangleCount = 1,
+			.pRectangles = &presentRectangle
+		};
+
+		VkPresentRegionsKHR presentRegions = {
+			.sType = VkStructureType::VK_STRUCTURE_TYPE_PRESENT_REGIONS_KHR,
+			.pNext = nullptr,
+			.swapchainCount = presentInfo.swapchainCount,
+			.pRegions = submission.m_PresentRegions.data()
+		};
+
+		if (m_Engine.isExtensionEnabled(VK_KHR_INCREMENTAL_PRESENT_EXTENSION_NAME))
+			presentInfo.pNext = &presentRegions;
+
+		auto lock = m_Engine.lockQueue();
 		const auto result = m_Engine.getDeviceTable().vkQueuePresentKHR(m_Engine.getQueue().getTransferQueue(), &presentInfo);
-		if (result == VK_ERROR_OUT_OF_DATE_KHR || result == VK_SUBOPTIMAL_KHR)
-			recreate();
+		lock.unlock();
+
+		if (m_IsFrameMeasured)
+			m_LatencyMeter->markPresent();
+
+		// Every swapchain reports its own result, so only the ones which are out of date are recreated.
+		for (size_t i = 1; i < submission.m_Results.size(); i++)
+		{
+			if (submission.m_Results[i] == VK_ERROR_OUT_OF_DATE_KHR || submission.m_Results[i] == VK_SUBOPTIMAL_KHR)
+				m_FrameViewports[i - 1]->invalidateSwapchain();
+		}
 
-		else
+		// The swapchain is recreated before the next image is acquired, unless the window is minimized by then.
+		const auto windowResult = submission.m_Results.front();
+		if (windowResult == VK_ERROR_OUT_OF_DATE_KHR || windowResult == VK_SUBOPTIMAL_KHR)
+			m_ShouldRecreate = true;
+
+		else if (result != VK_ERROR_OUT_OF_DATE_KHR && result != VK_SUBOPTIMAL_KHR)
 			utility::ValidateResult(result, "Failed to present the swapchain image!");
 	}
 
@@ -484,22 +1121,34 @@ namespace rapid
 	{
 		// Wait till we finish whatever we are running.
 		m_Engine.waitIdle();
+		m_ShouldRecreate = false;
+
+		// The frame indexes are reset, so complete the readbacks and the defragmentation pass now.
+		m_ReadbackQueue->flush();
+		m_MemoryDefragmenter->flush();
 
 		// Get the new extent.
 		refreshExtent();
 
 		// Destroy the previous stuff.
 		m_Engine.getDeviceTable().vkDestroyRenderPass(m_Engine.getLogicalDevice(), m_RenderPass, nullptr);
+		m_Engine.getDeviceTable().vkDestroyRenderPass(m_Engine.getLogicalDevice(), m_LoadRenderPass, nullptr);
+
+		for (const auto vFramebuffer : m_Framebuffers)
+			m_Engine.getDeviceTable().vkDestroyFramebuffer(m_Engine.getLogicalDevice(), vFramebuffer, nullptr);
+
+		m_Framebuffers.clear();
 
 		for (uint32_t i = 0; i < m_FrameCount; i++)
 		{
-			m_Engine.getDeviceTable().vkDestroyFramebuffer(m_Engine.getLogicalDevice(), m_Framebuffers[i], nullptr);
 			m_Engine.getDeviceTable().vkDestroySemaphore(m_Engine.getLogicalDevice(), m_RenderFinishedSemaphores[i], nullptr);
 			m_Engine.getDeviceTable().vkDestroySemaphore(m_Engine.getLogicalDevice(), m_InFlightSemaphores[i], nullptr);
+			m_Engine.getDeviceTable().vkDestroyFence(m_Engine.getLogicalDevice(), m_InFlightFences[i], nullptr);
 		}
 
 		m_RenderFinishedSemaphores.clear();
 		m_InFlightSemaphores.clear();
+		m_InFlightFences.clear();
 
 		// Make sure to destroy the old surface!
 		clearSwapchain();
@@ -518,6 +1167,9 @@ namespace rapid
 		createFramebuffers();
 		createSyncObjects();
 
+		// Every image needs to be drawn completely the first time.
+		m_DamageTracker.reset(static_cast<uint32_t>(m_SwapchainImages.size()), extent());
+
 		// Now we just have to update the pipelines.
 		for (auto& pNode : m_ProcessingNodes)
 			pNode->onWindowResize();
@@ -525,5 +1177,8 @@ namespace rapid
 		// Reset the indexes.
 		m_FrameIndex = 0;
 		m_ImageIndex = 0;
+
+		// Make sure that we render the next frame with the new size.
+		m_IsInvalidated = true;
 	}
 }
\ No newline at end of file
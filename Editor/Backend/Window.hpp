@@ -4,12 +4,46 @@
 
 #include "CommandBufferAllocator.hpp"
 #include "ProcessingNode.hpp"
+#include "DamageTracker.hpp"
+#include "ReadbackQueue.hpp"
+#include "LatencyMeter.hpp"
+#include "MemoryDefragmenter.hpp"
+#include "GpuProfiler.hpp"
+#include "Viewport.hpp"
+
+#include "Core/ThreadPool.hpp"
+
+#include <atomic>
+#include <condition_variable>
+#include <mutex>
+#include <thread>
 
 namespace rapid
 {
+	/**
+	 * Present settings structure.
+	 * These trade latency against power and tearing.
+	 */
+	struct PresentSettings final
+	{
+		VkPresentModeKHR m_PresentMode = VK_PRESENT_MODE_MAILBOX_KHR;	// FIFO is used if the surface doesn't support this.
+		uint32_t m_ImageCount = 0;	// The number of swapchain images. If 0, one more than the surface's minimum is used.
+	};
+
 	/**
 	 * Window class.
 	 * This contains the basic information about the window, and all the rendering parts are done here.
+	 *
+	 * Frames are built on the UI thread (the thread which polls the events), and are recorded, submitted and presented on
+	 * the window's render thread. Once the render thread has an image to render to, it hands the submitted frame over to
+	 * the nodes while the UI thread waits, and the UI thread builds the next frame while the frame is recorded, executed
+	 * and presented. The frame lock is only held to hand the frames over, and the UI thread never gets more than a frame
+	 * ahead. The render thread doesn't wait for the GPU after submitting, but waits for a frame's previous submission
+	 * before reusing its resources.
+	 *
+	 * A window can have additional viewports, which are separate platform windows sharing the window's device,
+	 * pipelines and frames. They're recorded on worker threads while the window is recorded, and everything is submitted
+	 * in a single queue submission and presented in a single present call.
 	 */
 	class Window final : public BackendObject
 	{
@@ -19,8 +53,9 @@ namespace rapid
 		 *
 		 * @param engine The engine reference.
 		 * @param title The window title.
+		 * @param presentSettings The present settings to start with. Default is mailbox with the default image count.
 		 */
-		explicit Window(GraphicsEngine& engine, std::string_view title);
+		explicit Window(GraphicsEngine& engine, std::string_view title, const PresentSettings& presentSettings = {});
 
 		/**
 		 * Destructor.
@@ -36,17 +71,135 @@ namespace rapid
 		 * Poll the events.
 		 * This needs to be called as the first function in every iteration.
 		 *
+		 * If the idle mode is enabled, this will block until a new event arrives, the idle timeout expires or the window
+		 * is invalidated, as long as none of the nodes are animating.
+		 *
+		 * This waits till the render thread hands the previously submitted frame over to the nodes.
+		 *
 		 * @return true if the window is active.
 		 */
 		bool pollEvents();
 
 		/**
-		 * Submit the frame to the GPU.
+		 * Invalidate the window.
+		 * This will make sure that the next frame is rendered even if the window is idle, and wakes up pollEvents if it's
+		 * waiting. Note that this is safe to be called from any thread.
+		 */
+		void invalidate();
+
+		/**
+		 * Enable or disable the idle mode.
+		 * When enabled, the window only renders on input, timeouts or invalidation.
+		 *
+		 * @param enable Whether or not to enable the idle mode.
+		 */
+		void setIdleMode(bool enable) { m_IsIdleModeEnabled = enable; }
+
+		/**
+		 * Check if the idle mode is enabled.
+		 *
+		 * @return Whether or not the idle mode is enabled.
+		 */
+		bool isIdleModeEnabled() const { return m_IsIdleModeEnabled; }
+
+		/**
+		 * Set the present settings.
+		 * This needs to be called on the UI thread while building a frame. The swapchains of the window and the viewports
+		 * are recreated before the next frame is rendered.
+		 *
+		 * @param settings The settings to use.
+		 */
+		void setPresentSettings(const PresentSettings& settings);
+
+		/**
+		 * Get the present settings which are in use.
+		 * These can differ from the requested ones, as they're limited to what the surface supports. This can be called
+		 * on any thread.
+		 *
+		 * @return The settings.
+		 */
+		PresentSettings getPresentSettings() const;
+
+		/**
+		 * Get the present modes supported by the window's surface.
+		 * This needs to be called on the UI thread while building a frame.
+		 *
+		 * @return The present modes.
+		 */
+		std::vector<VkPresentModeKHR> getSupportedPresentModes() const;
+
+		/**
+		 * Enable or disable the latency measurement.
+		 * When enabled, the time from input to submit, GPU completion and present is measured along with the GPU time,
+		 * and the results are logged periodically. The frames are not waited on, so their results are read once their
+		 * frame index comes around again.
+		 *
+		 * @param enable Whether or not to measure the latency.
+		 */
+		void setLatencyMeasurement(bool enable) { m_IsMeasuringLatency = enable; }
+
+		/**
+		 * Check if the latency is being measured.
+		 *
+		 * @return Whether or not the latency is measured.
+		 */
+		bool isMeasuringLatency() const { return m_IsMeasuringLatency; }
+
+		/**
+		 * Submit the frame to the render thread.
+		 * This ends the frame on the nodes, so they capture what the render thread needs. It doesn't wait till the frame is
+		 * rendered.
 		 */
 		void submitFrame();
 
+		/**
+		 * Capture the next rendered frame.
+		 * The callback is invoked a few frames later on the render thread with the swapchain image's pixels, without
+		 * stalling the frame.
+		 *
+		 * @param callback The callback to invoke with the pixels.
+		 * @param outputFormat The format to convert the pixels to. Default is VK_FORMAT_UNDEFINED, which keeps the swapchain format.
+		 */
+		void captureFrame(ReadbackCallback&& callback, VkFormat outputFormat = VK_FORMAT_UNDEFINED);
+
+		/**
+		 * Set the continuous capture callback.
+		 * When set, every frame which redraws something is captured, and the callback is invoked on the render thread. Set
+		 * an empty callback to stop capturing.
+		 *
+		 * @param callback The callback to invoke with the pixels of each frame.
+		 * @param outputFormat The format to convert the pixels to. Default is VK_FORMAT_UNDEFINED, which keeps the swapchain format.
+		 */
+		void setContinuousCapture(ReadbackCallback&& callback, VkFormat outputFormat = VK_FORMAT_UNDEFINED);
+
+		/**
+		 * Get the readback queue.
+		 * Readbacks requested through it are recorded into the next frame. This needs to be used on the render thread,
+		 * like from a readback callback.
+		 *
+		 * @return The readback queue.
+		 */
+		ReadbackQueue& getReadbackQueue() { return *m_ReadbackQueue; }
+
+		/**
+		 * Get the memory defragmenter.
+		 * It's updated by the render thread after every frame.
+		 *
+		 * @return The defragmenter.
+		 */
+		MemoryDefragmenter& getMemoryDefragmenter() { return *m_MemoryDefragmenter; }
+
+		/**
+		 * Get the GPU profiler.
+		 * The window's frames are measured by the render graph's passes and by the nodes.
+		 *
+		 * @return The profiler.
+		 */
+		GpuProfiler& getGpuProfiler() { return *m_GpuProfiler; }
+
 		/**
 		 * Create a new node.
+		 * This needs to be called on the UI thread, either before the first frame or while building a frame.
 		 *
 		 * @tparam Type The node type.
 		 * @tparam Args The constructor argument types.
@@ -56,6 +209,36 @@ namespace rapid
 		template<node_type Type, class...Args>
 		Type& createNode(Args&&... arguments) { return static_cast<Type&>(*m_ProcessingNodes.emplace_back(std::make_unique<Type>(m_Engine, *this, std::forward<Args>(arguments)...))); }
 
+		/**
+		 * Create a new viewport.
+		 * This needs to be called on the UI thread while building a frame. It waits till the render thread is done with
+		 * the previous frame, and the render thread stays idle till the next one is submitted. The viewport is rendered
+		 * from the next frame.
+		 *
+		 * @param title The window title.
+		 * @param area The position and the size of the viewport's window, in desktop coordinates.
+		 * @param windowFlags The SDL window flags.
+		 * @return The created viewport. This is owned by the window.
+		 */
+		Viewport& createViewport(std::string_view title, VkRect2D area, uint32_t windowFlags);
+
+		/**
+		 * Destroy a viewport.
+		 * This needs to be called on the UI thread while building a frame, or after the window is terminated. It waits
+		 * till the render thread is done with the previous frame, and the render thread stays idle till the next one is
+		 * submitted.
+		 *
+		 * @param viewport The viewport to destroy.
+		 */
+		void destroyViewport(Viewport& viewport);
+
+		/**
+		 * Get the SDL window handle.
+		 *
+		 * @return The window handle.
+		 */
+		SDL_Window* getWindowHandle() const { return m_pWindow; }
+
 		/**
 		 * Get the window extent.
 		 *
@@ -63,19 +246,60 @@ namespace rapid
 		 */
 		VkExtent2D extent() const { return m_Extent; }
 
+		/**
+		 * Get the swapchain image format.
+		 * Offscreen targets which use the window's pipelines need to have the same format.
+		 *
+		 * @return The format.
+		 */
+		VkFormat getSwapchainFormat() const { return m_SwapchainFormat; }
+
 		/**
 		 * Get the render pass.
+		 * This render pass clears the whole image. Pipelines can use it as it's compatible with the load render pass.
+		 * This is VK_NULL_HANDLE if dynamic rendering is enabled.
 		 *
 		 * @return The render pass.
 		 */
 		VkRenderPass getRenderPass() const { return m_RenderPass; }
 
+		/**
+		 * Get the render pass which needs to be used by the current frame.
+		 * If the current image contains the previous contents, the render pass would load them instead of clearing.
+		 *
+		 * @return The render pass.
+		 */
+		VkRenderPass getCurrentRenderPass() const { return shouldLoadPreviousContent() ? m_LoadRenderPass : m_RenderPass; }
+
+		/**
+		 * Check if the current frame reuses the contents of the swapchain image.
+		 * If so, only the render area needs to be cleared and redrawn.
+		 *
+		 * @return Whether or not the previous contents are loaded.
+		 */
+		bool shouldLoadPreviousContent() const { return m_DamageTracker.isValid(m_ImageIndex); }
+
+		/**
+		 * Get the area of the window which is redrawn in the current frame.
+		 *
+		 * @return The render area.
+		 */
+		VkRect2D getRenderArea() const { return m_RenderArea; }
+
 		/**
 		 * Get the current frame buffer.
+		 * This is only available if dynamic rendering is disabled.
 		 *
 		 * @return The frame buffer.
 		 */
-		VkFramebuffer getCurrentFrameBuffer() const { return m_Framebuffers[m_FrameIndex]; }
+		VkFramebuffer getCurrentFrameBuffer() const { return m_Framebuffers[m_ImageIndex]; }
+
+		/**
+		 * Get the image view of the current swapchain image.
+		 *
+		 * @return The image view.
+		 */
+		VkImageView getCurrentImageView() const { return m_SwapchainImageViews[m_ImageIndex]; }
 
 		/**
 		 * Get the frame count.
@@ -84,6 +308,14 @@ namespace rapid
 		 */
 		uint32_t frameCount() const { return m_FrameCount; }
 
+		/**
+		 * Get the number of frames a resource released while building a frame needs to be kept for.
+		 * The frame being built can still use it once it's rendered, along with the frames in flight.
+		 *
+		 * @return The frame count.
+		 */
+		uint32_t retireFrameCount() const { return m_FrameCount + 1; }
+
 	private:
 		/**
 		 * Get the best buffer count.
@@ -92,6 +324,60 @@ namespace rapid
 		 */
 		uint32_t getBestBufferCount() const;
 
+		/**
+		 * Add an event to the current frame's event list.
+		 * Consecutive mouse motion and wheel events are merged together.
+		 *
+		 * @param sdlEvent The event to add.
+		 */
+		void addEvent(const SDL_Event& sdlEvent);
+
+		/**
+		 * The render thread's function.
+		 * This renders the submitted frames till the window is terminated.
+		 */
+		void renderFrames();
+
+		/**
+		 * Acquire the next swapchain image.
+		 * The swapchain is recreated if it's out of date. If the image is suboptimal, it's still used and the swapchain is
+		 * recreated after it's presented.
+		 *
+		 * @return Whether or not an image was acquired. Nothing is acquired while the window is minimized.
+		 */
+		bool acquireImage();
+
+		/**
+		 * Record the submitted frame and submit it to the GPU.
+		 * The viewports are recorded on the worker threads meanwhile, and are submitted along with the window. The frame
+		 * needs to be handed over to the nodes before calling this.
+		 *
+		 * @return The area of the image which changed since the last presented frame.
+		 */
+		VkRect2D recordFrame();
+
+		/**
+		 * Record a viewport's command buffer.
+		 * This is called on a worker thread.
+		 *
+		 * @param viewport The viewport to record.
+		 */
+		void recordViewport(Viewport& viewport);
+
+		/**
+		 * Check if the window can go idle.
+		 *
+		 * @return Whether or not we can wait for new events.
+		 */
+		bool canIdle() const;
+
+		/**
+		 * Check if the window is minimized or has no area to render to.
+		 *
+		 * @return Whether or not the window can't be rendered to.
+		 */
+		bool isMinimized() const;
+
 		/**
 		 * Refresh the extent and get the current size.
 		 */
@@ -109,16 +395,20 @@ namespace rapid
 
 		/**
 		 * Create the swapchain.
+		 * The requested present settings are used as far as the surface supports them.
 		 */
 		void createSwapchain();
 
 		/**
-		 * Create the required render pass.
+		 * Create the render passes.
+		 * This creates a render pass which clears the images and another which loads their previous contents. The layout
+		 * transitions are done by the render graph. Nothing is created if dynamic rendering is enabled.
 		 */
 		void createRenderPass();
 
 		/**
 		 * Create the frame buffers.
+		 * Nothing is created if dynamic rendering is enabled.
 		 */
 		void createFramebuffers();
 
@@ -128,25 +418,72 @@ namespace rapid
 		void createSyncObjects();
 
 		/**
-		 * Present the images to the screen.
+		 * Request the readbacks of the current swapchain image.
+		 * The image needs to be in the transfer source layout when the readbacks are recorded.
 		 */
-		void present();
+		void captureSwapchainImage();
+
+		/**
+		 * Present the images of the window and the viewports to the screen.
+		 *
+		 * @param damage The area of the window's image which changed since the last presented frame.
+		 */
+		void present(VkRect2D damage);
 
 		/**
 		 * Recreate the swapchain and the resources.
 		 */
 		void recreate();
 
+	private:
+		/**
+		 * Frame submission structure.
+		 * This holds what's submitted and presented together. The window comes first, followed by the viewports, and the
+		 * vectors are reused between frames.
+		 */
+		struct FrameSubmission final
+		{
+			std::vector<VkCommandBuffer> m_CommandBuffers = {};
+			std::vector<VkSemaphore> m_WaitSemaphores = {};
+			std::vector<VkSemaphore> m_SignalSemaphores = {};
+			std::vector<VkSwapchainKHR> m_Swapchains = {};
+			std::vector<uint32_t> m_ImageIndices = {};
+			std::vector<VkPresentRegionKHR> m_PresentRegions = {};
+			std::vector<VkResult> m_Results = {};
+		};
+
 	private:
 		std::vector<VkImage> m_SwapchainImages = {};
 		std::vector<VkImageView> m_SwapchainImageViews = {};
 		std::vector<VkFramebuffer> m_Framebuffers = {};
 		std::vector<std::unique_ptr<ProcessingNode>> m_ProcessingNodes = {};
+		std::vector<SDL_Event> m_Events = {};
+		std::vector<std::pair<ReadbackCallback, VkFormat>> m_Captures = {};
+		std::vector<std::pair<ReadbackCallback, VkFormat>> m_PendingCaptures = {};	// Requested by the UI thread, and handed over with the next frame.
+
+		std::pair<ReadbackCallback, VkFormat> m_ContinuousCapture = {};
+		std::pair<ReadbackCallback, VkFormat> m_PendingContinuousCapture = {};
+
+		std::vector<std::unique_ptr<Viewport>> m_Viewports = {};
+		std::vector<Viewport*> m_FrameViewports = {};	// The viewports rendered by the render thread's current frame.
+
+		FrameSubmission m_Submission;
+
+		DamageTracker m_DamageTracker;
 
 		std::vector<VkSemaphore> m_RenderFinishedSemaphores = {};
 		std::vector<VkSemaphore> m_InFlightSemaphores = {};
+		std::vector<VkFence> m_InFlightFences = {};
 
 		std::unique_ptr<CommandBufferAllocator> m_CommandBufferAllocator = nullptr;
+		std::unique_ptr<ReadbackQueue> m_ReadbackQueue = nullptr;
+		std::unique_ptr<RenderGraph> m_RenderGraph = nullptr;
+		std::unique_ptr<LatencyMeter> m_LatencyMeter = nullptr;
+		std::unique_ptr<MemoryDefragmenter> m_MemoryDefragmenter = nullptr;
+		std::unique_ptr<GpuProfiler> m_GpuProfiler = nullptr;
+
+		std::optional<LatencyMeter::clock_type::time_point> m_InputTime = std::nullopt;	// The earliest input of the frame being built.
+		std::optional<LatencyMeter::clock_type::time_point> m_FrameInputTime = std::nullopt;	// The earliest input of the render thread's current frame.
 
 		GraphicsEngine& m_Engine;
 
@@ -157,11 +494,37 @@ namespace rapid
 
 		VkSwapchainKHR m_Swapchain = VK_NULL_HANDLE;
 		VkRenderPass m_RenderPass = VK_NULL_HANDLE;
+		VkRenderPass m_LoadRenderPass = VK_NULL_HANDLE;
+
+		VkRect2D m_RenderArea = {};
 
 		VkFormat m_SwapchainFormat = VK_FORMAT_UNDEFINED;
 
+		// The settings are requested on the UI thread and applied on the render thread.
+		PresentSettings m_RequestedPresentSettings = {};
+		PresentSettings m_PresentSettings = {};
+		mutable std::mutex m_PresentSettingsMutex;
+
 		uint32_t m_FrameCount = 0;
 		uint32_t m_FrameIndex = 0;
 		uint32_t m_ImageIndex = 0;
+		uint32_t m_FrameNumber = 0;
+
+		uint8_t m_PendingFrames = 0;
+
+		std::thread m_RenderThread;
+		std::mutex m_FrameMutex;
+		std::condition_variable m_FrameCondition;
+
+		bool m_IsCaptureSupported = false;
+		bool m_IsIdleModeEnabled = true;
+		bool m_HasPendingFrame = false;
+		bool m_IsRendering = false;	// Whether the render thread picked up a frame and is not done with it yet.
+		bool m_IsReadingBack = false;	// Whether the readback queue had work left after the last frame.
+		bool m_IsFrameMeasured = false;	// Whether the render thread's current frame is measured by the latency meter.
+		bool m_ShouldStop = false;
+		std::atomic<bool> m_IsInvalidated = true;
+		std::atomic<bool> m_IsMeasuringLatency = false;
+		std::atomic<bool> m_ShouldRecreate = false;
 	};
 }
\ No newline at end of file
@@ -0,0 +1,81 @@
+// Copyright (c) 2022 Dhiraj Wishal
+
+#pragma once
+
+#include <chrono>
+#include <cstdint>
+#include <cstdio>
+
+namespace rapid
+{
+	namespace benchmark
+	{
+		/**
+		 * The minimum time a single measurement runs for.
+		 * Short operations are repeated till this is reached, so the timer's resolution doesn't matter.
+		 */
+		constexpr std::chrono::milliseconds MinimumDuration = std::chrono::milliseconds(200);
+
+		/**
+		 * Measure how long an operation takes.
+		 * The operation is run once to warm up the caches, and is then repeated till the minimum duration is reached.
+		 *
+		 * @tparam Function The operation type.
+		 * @param function The operation to measure.
+		 * @return The average time of a single run, in seconds.
+		 */
+		template<class Function>
+		double Measure(Function&& function)
+		{
+			using clock_type = std::chrono::steady_clock;
+
+			function();
+
+			uint64_t runCount = 0;
+			const auto start = clock_type::now();
+			auto end = start;
+			do
+			{
+				function();
+				runCount++;
+				end = clock_type::now();
+			} while (end - start < MinimumDuration);
+
+			return std::chrono::duration<double>(end - start).count() / static_cast<double>(runCount);
+		}
+
+		/**
+		 * Get the throughput of an operation.
+		 *
+		 * @param bytes The number of bytes processed by a single run.
+		 * @param seconds The time of a single run.
+		 * @return The throughput in GiB per second.
+		 */
+		constexpr double GetThroughput(uint64_t bytes, double seconds)
+		{
+			return static_cast<double>(bytes) / seconds / (1024.0 * 1024.0 * 1024.0);
+		}
+
+		/**
+		 * Format a size as a short human readable string, like "64 KiB".
+		 *
+		 * @param bytes The size in bytes.
+		 * @param pBuffer The buffer to write to.
+		 * @param bufferSize The size of the buffer.
+		 * @return The buffer.
+		 */
+		inline const char* FormatSize(uint64_t bytes, char* pBuffer, size_t bufferSize)
+		{
+			if (bytes >= 1024 * 1024)
+				std::snprintf(pBuffer, bufferSize, "%llu MiB", static_cast<unsigned long long>(bytes / (1024 * 1024)));
+
+			else if (bytes >= 1024)
+				std::snprintf(pBuffer, bufferSize, "%llu KiB", static_cast<unsigned long long>(bytes / 1024));
+
+			else
+				std::snprintf(pBuffer, bufferSize, "%llu B", static_cast<unsigned long long>(bytes));
+
+			return pBuffer;
+		}
+	}
+}
@@ -0,0 +1,47 @@
+// Copyright (c) 2022 Dhiraj Wishal
+
+#include "Benchmark.hpp"
+
+#include "Core/PixelKernels.hpp"
+
+#include <cstddef>
+#include <vector>
+
+/**
+ * Pixel kernels benchmark.
+ * This measures the throughput of every pixel kernel which the CPU supports, for images from 16x16 to 4096x4096. The
+ * pixel count is odd, so the tails are measured too.
+ */
+int main()
+{
+	constexpr uint64_t MinimumWidth = 16;
+	constexpr uint64_t MaximumWidth = 4096;
+
+	std::vector<uint8_t> source(MaximumWidth * MaximumWidth * 4 + 4, 0x5A);
+	std::vector<uint8_t> destination(source.size());
+
+	const auto kernels = rapid::GetSupportedPixelKernels();
+	std::printf("Selected pixel kernel: %s\n", rapid::GetPixelKernelName());
+	std::printf("%-10s %-10s %-8s %18s %18s\n", "Image", "Size", "Kernel", "Swizzle GiB/s", "Premultiply GiB/s");
+
+	for (uint64_t width = MinimumWidth; width <= MaximumWidth; width *= 4)
+	{
+		const auto pixelCount = width * width + 1;
+		const auto size = pixelCount * 4;
+
+		for (const auto& kernel : kernels)
+		{
+			const auto swizzleTime = rapid::benchmark::Measure([&] { kernel.m_SwizzleRedBlue(destination.data(), source.data(), pixelCount); });
+			const auto premultiplyTime = rapid::benchmark::Measure([&] { kernel.m_PremultiplyAlpha(destination.data(), source.data(), pixelCount); });
+
+			char imageString[32] = {};
+			std::snprintf(imageString, sizeof(imageString), "%llux%llu", static_cast<unsigned long long>(width), static_cast<unsigned long long>(width));
+
+			char sizeString[32] = {};
+			std::printf("%-10s %-10s %-8s %18.2f %18.2f\n", imageString, rapid::benchmark::FormatSize(size, sizeString, sizeof(sizeString)), kernel.m_pName,
+				rapid::benchmark::GetThroughput(size, swizzleTime), rapid::benchmark::GetThroughput(size, premultiplyTime));
+		}
+	}
+
+	return 0;
+}
@@ -0,0 +1,42 @@
+// Copyright (c) 2022 Dhiraj Wishal
+
+#include "Benchmark.hpp"
+
+#include "Core/StreamingCopy.hpp"
+
+#include <algorithm>
+#include <cstddef>
+#include <vector>
+
+/**
+ * Streaming copy benchmark.
+ * This compares the streaming copy kernel against std::copy for sizes from 1 KiB to 64 MiB. Both copy to ordinary host
+ * memory, so the gap is smaller than on write-combined GPU memory, but large copies still show the cost of the cache
+ * traffic which the streaming stores avoid.
+ */
+int main()
+{
+	constexpr uint64_t MinimumSize = 1024;
+	constexpr uint64_t MaximumSize = 64 * 1024 * 1024;
+
+	// The source is offset by a byte so the kernel's unaligned head is measured too.
+	std::vector<std::byte> source(MaximumSize + 1, std::byte{ 0x5A });
+	std::vector<std::byte> destination(MaximumSize);
+
+	std::printf("Streaming copy kernel: %s\n", rapid::GetStreamingCopyKernelName());
+	std::printf("%-10s %16s %16s\n", "Size", "std::copy GiB/s", "Streaming GiB/s");
+
+	for (uint64_t size = MinimumSize; size <= MaximumSize; size *= 2)
+	{
+		const auto pSource = source.data() + 1;
+
+		const auto copyTime = rapid::benchmark::Measure([&] { std::copy(pSource, pSource + size, destination.data()); });
+		const auto streamingTime = rapid::benchmark::Measure([&] { rapid::StreamingCopy(destination.data(), pSource, size); });
+
+		char sizeString[32] = {};
+		std::printf("%-10s %16.2f %16.2f\n", rapid::benchmark::FormatSize(size, sizeString, sizeof(sizeString)),
+			rapid::benchmark::GetThroughput(size, copyTime), rapid::benchmark::GetThroughput(size, streamingTime));
+	}
+
+	return 0;
+}
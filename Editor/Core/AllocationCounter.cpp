@@ -0,0 +1,146 @@
+// Copyright (c) 2022 Dhiraj Wishal
+
+#include "AllocationCounter.hpp"
+
+#include <atomic>
+#include <cstdlib>
+#include <new>
+
+#ifdef RAPID_COUNT_ALLOCATIONS
+namespace
+{
+	std::atomic<uint64_t> g_AllocationCount = 0;
+	std::atomic<uint64_t> g_AllocatedBytes = 0;
+
+	/**
+	 * Allocate memory and count the allocation.
+	 * This calls the new handler till the allocation succeeds, like the default operator new.
+	 *
+	 * @param size The size of the allocation.
+	 * @param alignment The alignment of the allocation. 0 uses the default alignment.
+	 * @return The allocated memory.
+	 */
+	void* Allocate(std::size_t size, std::size_t alignment)
+	{
+		g_AllocationCount.fetch_add(1, std::memory_order_relaxed);
+		g_AllocatedBytes.fetch_add(size, std::memory_order_relaxed);
+
+		if (size == 0)
+			size = 1;
+
+		while (true)
+		{
+			void* pMemory = nullptr;
+			if (alignment == 0)
+				pMemory = std::malloc(size);
+
+#ifdef RAPID_PLATFORM_WINDOWS
+			else
+				pMemory = _aligned_malloc(size, alignment);
+
+#else
+			// The size needs to be a multiple of the alignment.
+			else
+				pMemory = std::aligned_alloc(alignment, (size + alignment - 1) / alignment * alignment);
+
+#endif
+
+			if (pMemory)
+				return pMemory;
+
+			const auto handler = std::get_new_handler();
+			if (!handler)
+				throw std::bad_alloc();
+
+			handler();
+		}
+	}
+
+	/**
+	 * Allocate memory without throwing.
+	 *
+	 * @param size The size of the allocation.
+	 * @param alignment The alignment of the allocation. 0 uses the default alignment.
+	 * @return The allocated memory, or nullptr if it failed.
+	 */
+	void* AllocateNoThrow(std::size_t size, std::size_t alignment) noexcept
+	{
+		// The new handler is allowed to throw, and that counts as a failure as well.
+		try
+		{
+			return Allocate(size, alignment);
+		}
+		catch (...)
+		{
+			return nullptr;
+		}
+	}
+
+	/**
+	 * Free memory allocated by Allocate().
+	 *
+	 * @param pMemory The memory to free.
+	 * @param alignment The alignment it was allocated with.
+	 */
+	void Free(void* pMemory, std::size_t alignment) noexcept
+	{
+#ifdef RAPID_PLATFORM_WINDOWS
+		if (alignment != 0)
+			_aligned_free(pMemory);
+
+		else
+			std::free(pMemory);
+
+#else
+		// Memory from aligned_alloc() is freed like any other.
+		static_cast<void>(alignment);
+		std::free(pMemory);
+
+#endif
+	}
+}
+
+// Every variant is replaced, as the defaults of the aligned ones don't go through the plain operator new.
+void* operator new(std::size_t size) { return Allocate(size, 0); }
+void* operator new[](std::size_t size) { return Allocate(size, 0); }
+void* operator new(std::size_t size, const std::nothrow_t&) noexcept { return AllocateNoThrow(size, 0); }
+void* operator new[](std::size_t size, const std::nothrow_t&) noexcept { return AllocateNoThrow(size, 0); }
+void* operator new(std::size_t size, std::align_val_t alignment) { return Allocate(size, static_cast<std::size_t>(alignment)); }
+void* operator new[](std::size_t size, std::align_val_t alignment) { return Allocate(size, static_cast<std::size_t>(alignment)); }
+void* operator new(std::size_t size, std::align_val_t alignment, const std::nothrow_t&) noexcept { return AllocateNoThrow(size, static_cast<std::size_t>(alignment)); }
+void* operator new[](std::size_t size, std::align_val_t alignment, const std::nothrow_t&) noexcept { return AllocateNoThrow(size, static_cast<std::size_t>(alignment)); }
+
+void operator delete(void* pMemory) noexcept { Free(pMemory, 0); }
+void operator delete[](void* pMemory) noexcept { Free(pMemory, 0); }
+void operator delete(void* pMemory, std::size_t) noexcept { Free(pMemory, 0); }
+void operator delete[](void* pMemory, std::size_t) noexcept { Free(pMemory, 0); }
+void operator delete(void* pMemory, const std::nothrow_t&) noexcept { Free(pMemory, 0); }
+void operator delete[](void* pMemory, const std::nothrow_t&) noexcept { Free(pMemory, 0); }
+void operator delete(void* pMemory, std::align_val_t alignment) noexcept { Free(pMemory, static_cast<std::size_t>(alignment)); }
+void operator delete[](void* pMemory, std::align_val_t alignment) noexcept { Free(pMemory, static_cast<std::size_t>(alignment)); }
+void operator delete(void* pMemory, std::size_t, std::align_val_t alignment) noexcept { Free(pMemory, static_cast<std::size_t>(alignment)); }
+void operator delete[](void* pMemory, std::size_t, std::align_val_t alignment) noexcept { Free(pMemory, static_cast<std::size_t>(alignment)); }
+void operator delete(void* pMemory, std::align_val_t alignment, const std::nothrow_t&) noexcept { Free(pMemory, static_cast<std::size_t>(alignment)); }
+void operator delete[](void* pMemory, std::align_val_t alignment, const std::nothrow_t&) noexcept { Free(pMemory, static_cast<std::size_t>(alignment)); }
+
+namespace rapid
+{
+	AllocationStatistics GetAllocationStatistics()
+	{
+		return AllocationStatistics{
+			.m_AllocationCount = g_AllocationCount.load(std::memory_order_relaxed),
+			.m_AllocatedBytes = g_AllocatedBytes.load(std::memory_order_relaxed)
+		};
+	}
+}
+
+#else
+namespace rapid
+{
+	AllocationStatistics GetAllocationStatistics()
+	{
+		return AllocationStatistics{};
+	}
+}
+
+#endif
\ No newline at end of file
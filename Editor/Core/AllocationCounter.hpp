@@ -0,0 +1,39 @@
+// Copyright (c) 2022 Dhiraj Wishal
+
+#pragma once
+
+#include <cstdint>
+
+namespace rapid
+{
+	/**
+	 * Allocation statistics structure.
+	 */
+	struct AllocationStatistics final
+	{
+		uint64_t m_AllocationCount = 0;
+		uint64_t m_AllocatedBytes = 0;
+	};
+
+	/**
+	 * Whether or not allocations are counted.
+	 * Counting replaces the global operator new and delete, so it's only done when the RAPID_COUNT_ALLOCATIONS CMake
+	 * option is enabled.
+	 */
+#ifdef RAPID_COUNT_ALLOCATIONS
+	constexpr bool IsAllocationCountingEnabled = true;
+
+#else
+	constexpr bool IsAllocationCountingEnabled = false;
+
+#endif
+
+	/**
+	 * Get the allocation statistics.
+	 * Every allocation made through the global operator new (and so every standard container using the default
+	 * allocator) is counted from the start of the process. Subtract two samples to get the allocations in between.
+	 *
+	 * @return The statistics. These are always 0 if allocations are not counted.
+	 */
+	AllocationStatistics GetAllocationStatistics();
+}
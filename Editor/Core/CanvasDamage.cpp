@@ -0,0 +1,55 @@
+// Copyright (c) 2022 Dhiraj Wishal
+
+#include "CanvasDamage.hpp"
+
+namespace rapid
+{
+	bool CanvasDamage::update(std::vector<Node>&& nodes)
+	{
+		m_DamagedNodes.clear();
+
+		bool isDamaged = nodes.size() != m_Nodes.size();
+		for (uint64_t i = 0; i < nodes.size() && !isDamaged; i++)
+		{
+			const auto& current = nodes[i];
+			const auto& previous = m_Nodes[i];
+
+			isDamaged = current.m_NodeID != previous.m_NodeID
+				|| current.m_X != previous.m_X || current.m_Y != previous.m_Y
+				|| current.m_Width != previous.m_Width || current.m_Height != previous.m_Height;
+		}
+
+		// Culled nodes didn't generate anything to hash, so they're assumed to be unchanged.
+		for (uint64_t i = 0; i < nodes.size(); i++)
+		{
+			auto& current = nodes[i];
+			const auto hasPrevious = i < m_Nodes.size() && m_Nodes[i].m_NodeID == current.m_NodeID;
+
+			if (current.m_IsCulled && hasPrevious)
+				current.m_Hash = m_Nodes[i].m_Hash;
+
+			else if (!isDamaged && current.m_Hash != m_Nodes[i].m_Hash)
+				m_DamagedNodes.emplace_back(i);
+		}
+
+		m_Nodes = std::move(nodes);
+		m_IsStable.assign(m_Nodes.size(), !isDamaged);
+
+		for (const auto index : m_DamagedNodes)
+			m_IsStable[index] = false;
+
+		return isDamaged;
+	}
+
+	void CanvasDamage::reset()
+	{
+		m_Nodes.clear();
+		m_DamagedNodes.clear();
+		m_IsStable.clear();
+	}
+
+	bool CanvasDamage::isStable(uint64_t index, int32_t nodeID) const
+	{
+		return index < m_Nodes.size() && m_Nodes[index].m_NodeID == nodeID && m_IsStable[index];
+	}
+}
\ No newline at end of file
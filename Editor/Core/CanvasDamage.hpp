@@ -0,0 +1,84 @@
+// Copyright (c) 2022 Dhiraj Wishal
+
+#pragma once
+
+#include <cstdint>
+#include <vector>
+
+namespace rapid
+{
+	/**
+	 * Canvas damage class.
+	 * This compares the nodes of a canvas with the last frame's to find the ones which need to be redrawn. Each node is
+	 * described by its rect and a hash of everything it draws, so any change to its contents (hovered buttons, edited text,
+	 * a blinking caret) damages it, while the other nodes are left alone.
+	 *
+	 * Nodes can also be culled, which means their contents were not generated this frame. A culled node keeps its last
+	 * hash, so it's only safe to cull nodes which are stable (see isStable()).
+	 */
+	class CanvasDamage final
+	{
+	public:
+		/**
+		 * Node structure.
+		 */
+		struct Node final
+		{
+			float m_X = 0.0f;
+			float m_Y = 0.0f;
+			float m_Width = 0.0f;
+			float m_Height = 0.0f;
+
+			uint64_t m_Hash = 0;
+			int32_t m_NodeID = 0;
+			bool m_IsCulled = false;
+		};
+
+	public:
+		/**
+		 * Update the damage using the nodes of a new frame.
+		 *
+		 * @param nodes The nodes, in the order they're drawn. The rects need to be in a space which doesn't move with panning.
+		 * @return Whether or not the whole canvas is damaged. This is the case when nodes are added, removed, reordered, moved
+		 * or resized.
+		 */
+		bool update(std::vector<Node>&& nodes);
+
+		/**
+		 * Reset the damage.
+		 * The next update damages the whole canvas, and no node is stable till then.
+		 */
+		void reset();
+
+		/**
+		 * Get the indexes of the nodes which were damaged by the last update.
+		 * This is empty if the whole canvas was damaged.
+		 *
+		 * @return The node indexes.
+		 */
+		const std::vector<uint64_t>& getDamagedNodes() const { return m_DamagedNodes; }
+
+		/**
+		 * Check if a node was left untouched by the last update.
+		 * Nodes which are still changing (for example, ones with an animation) are never stable.
+		 *
+		 * @param index The index of the node in the next update.
+		 * @param nodeID The ID of the node.
+		 * @return Whether or not the node is stable.
+		 */
+		bool isStable(uint64_t index, int32_t nodeID) const;
+
+		/**
+		 * Get the nodes of the last update.
+		 * The hashes of culled nodes are the ones they were last drawn with.
+		 *
+		 * @return The nodes.
+		 */
+		const std::vector<Node>& getNodes() const { return m_Nodes; }
+
+	private:
+		std::vector<Node> m_Nodes = {};
+		std::vector<uint64_t> m_DamagedNodes = {};
+		std::vector<bool> m_IsStable = {};
+	};
+}
\ No newline at end of file
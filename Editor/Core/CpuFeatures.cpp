@@ -0,0 +1,58 @@
+// Copyright (c) 2022 Dhiraj Wishal
+
+#include "CpuFeatures.hpp"
+
+#include <cstdint>
+
+#if defined(RAPID_ARCHITECTURE_X86) && defined(_MSC_VER)
+#include <intrin.h>
+
+#endif
+
+namespace rapid
+{
+	bool IsSSSE3Supported()
+	{
+#if defined(RAPID_ARCHITECTURE_X86) && defined(_MSC_VER)
+		int32_t registers[4] = {};
+		__cpuid(registers, 1);
+		return (registers[2] & (1 << 9)) != 0;
+
+#elif defined(RAPID_ARCHITECTURE_X86)
+		__builtin_cpu_init();
+		return __builtin_cpu_supports("ssse3");
+
+#else
+		return false;
+
+#endif
+	}
+
+	bool IsAVX2Supported()
+	{
+#if defined(RAPID_ARCHITECTURE_X86) && defined(_MSC_VER)
+		int32_t registers[4] = {};
+		__cpuid(registers, 0);
+		if (registers[0] < 7)
+			return false;
+
+		// Check if the OS saves the YMM registers.
+		__cpuid(registers, 1);
+		const bool osxsave = (registers[2] & (1 << 27)) != 0;
+		const bool avx = (registers[2] & (1 << 28)) != 0;
+		if (!osxsave || !avx || (_xgetbv(0) & 0x6) != 0x6)
+			return false;
+
+		__cpuidex(registers, 7, 0);
+		return (registers[1] & (1 << 5)) != 0;
+
+#elif defined(RAPID_ARCHITECTURE_X86)
+		__builtin_cpu_init();
+		return __builtin_cpu_supports("avx2");
+
+#else
+		return false;
+
+#endif
+	}
+}
@@ -0,0 +1,38 @@
+// Copyright (c) 2022 Dhiraj Wishal
+
+#pragma once
+
+#if defined(__x86_64__) || defined(_M_X64) || defined(__i386__) || defined(_M_IX86)
+#define RAPID_ARCHITECTURE_X86
+
+#elif defined(__aarch64__) || defined(_M_ARM64) || defined(__ARM_NEON)
+#define RAPID_ARCHITECTURE_NEON
+
+#endif
+
+#if defined(__GNUC__) || defined(__clang__)
+#define RAPID_TARGET(name) __attribute__((target(name)))
+
+#else
+#define RAPID_TARGET(name)
+
+#endif
+
+namespace rapid
+{
+	/**
+	 * Check if the CPU supports SSSE3.
+	 * This is always false on non-x86 CPUs.
+	 *
+	 * @return Whether or not SSSE3 can be used.
+	 */
+	bool IsSSSE3Supported();
+
+	/**
+	 * Check if the CPU and the OS supports AVX2.
+	 * This is always false on non-x86 CPUs.
+	 *
+	 * @return Whether or not AVX2 can be used.
+	 */
+	bool IsAVX2Supported();
+}
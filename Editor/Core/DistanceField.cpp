@@ -0,0 +1,129 @@
+// Copyright (c) 2022 Dhiraj Wishal
+
+#include "DistanceField.hpp"
+
+#include <algorithm>
+#include <cmath>
+#include <limits>
+#include <vector>
+
+namespace
+{
+	constexpr float Infinity = std::numeric_limits<float>::max() / 4;
+
+	/**
+	 * Compute the 1D squared distance transform of a sampled function.
+	 *
+	 * @param pFunction The input function values.
+	 * @param pDistances The output distances.
+	 * @param count The number of samples.
+	 * @param pVertices The parabola vertex buffer. Must be able to hold count elements.
+	 * @param pBoundaries The parabola boundary buffer. Must be able to hold count + 1 elements.
+	 */
+	void Transform(const float* pFunction, float* pDistances, uint32_t count, uint32_t* pVertices, float* pBoundaries)
+	{
+		uint32_t k = 0;
+		pVertices[0] = 0;
+		pBoundaries[0] = -Infinity;
+		pBoundaries[1] = Infinity;
+
+		for (uint32_t q = 1; q < count; q++)
+		{
+			const auto intersect = [&]()
+			{
+				const auto p = pVertices[k];
+				return ((pFunction[q] + static_cast<float>(q) * q) - (pFunction[p] + static_cast<float>(p) * p)) / (2.0f * q - 2.0f * p);
+			};
+
+			auto s = intersect();
+			while (s <= pBoundaries[k])
+			{
+				k--;
+				s = intersect();
+			}
+
+			k++;
+			pVertices[k] = q;
+			pBoundaries[k] = s;
+			pBoundaries[k + 1] = Infinity;
+		}
+
+		k = 0;
+		for (uint32_t q = 0; q < count; q++)
+		{
+			while (pBoundaries[k + 1] < q)
+				k++;
+
+			const auto difference = static_cast<float>(q) - pVertices[k];
+			pDistances[q] = difference * difference + pFunction[pVertices[k]];
+		}
+	}
+
+	/**
+	 * Compute the 2D squared distance transform of an image in place.
+	 * Pixels with a value of 0 are the features, and everything else should be infinity.
+	 *
+	 * @param image The image.
+	 * @param width The image width.
+	 * @param height The image height.
+	 */
+	void Transform(std::vector<float>& image, uint32_t width, uint32_t height)
+	{
+		const auto length = std::max(width, height);
+		std::vector<float> function(length), distances(length), boundaries(length + 1);
+		std::vector<uint32_t> vertices(length);
+
+		// Transform the columns.
+		for (uint32_t x = 0; x < width; x++)
+		{
+			for (uint32_t y = 0; y < height; y++)
+				function[y] = image[static_cast<uint64_t>(y) * width + x];
+
+			Transform(function.data(), distances.data(), height, vertices.data(), boundaries.data());
+
+			for (uint32_t y = 0; y < height; y++)
+				image[static_cast<uint64_t>(y) * width + x] = distances[y];
+		}
+
+		// Transform the rows.
+		for (uint32_t y = 0; y < height; y++)
+		{
+			const auto pRow = image.data() + static_cast<uint64_t>(y) * width;
+			Transform(pRow, distances.data(), width, vertices.data(), boundaries.data());
+			std::copy_n(distances.data(), width, pRow);
+		}
+	}
+}
+
+namespace rapid
+{
+	void GenerateDistanceField(const uint8_t* pCoverage, uint32_t width, uint32_t height, float spread, uint8_t* pDistanceField)
+	{
+		const auto pixelCount = static_cast<uint64_t>(width) * height;
+		if (pixelCount == 0)
+			return;
+
+		// Compute the distance to the closest inside and outside pixels.
+		std::vector<float> insideDistances(pixelCount), outsideDistances(pixelCount);
+		for (uint64_t i = 0; i < pixelCount; i++)
+		{
+			const bool isInside = pCoverage[i] >= 128;
+			insideDistances[i] = isInside ? 0.0f : Infinity;
+			outsideDistances[i] = isInside ? Infinity : 0.0f;
+		}
+
+		Transform(insideDistances, width, height);
+		Transform(outsideDistances, width, height);
+
+		// Combine the two and map them to the output range. The edge lies half way between an inside and an outside pixel.
+		for (uint64_t i = 0; i < pixelCount; i++)
+		{
+			const auto distance = pCoverage[i] >= 128
+				? std::sqrt(outsideDistances[i]) - 0.5f
+				: 0.5f - std::sqrt(insideDistances[i]);
+
+			const auto value = std::clamp(0.5f + distance / (2.0f * spread), 0.0f, 1.0f);
+			pDistanceField[i] = static_cast<uint8_t>(std::lround(value * 255.0f));
+		}
+	}
+}
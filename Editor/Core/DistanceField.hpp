@@ -0,0 +1,23 @@
+// Copyright (c) 2022 Dhiraj Wishal
+
+#pragma once
+
+#include <cstdint>
+
+namespace rapid
+{
+	/**
+	 * Generate a signed distance field from a coverage (alpha) image.
+	 * Every output pixel stores the distance to the closest edge, mapped so that 0.5 (128) is the edge, values above it
+	 * are inside the shape and values below it are outside. Distances beyond the spread are clamped.
+	 *
+	 * This uses the exact Euclidean distance transform by Felzenszwalb and Huttenlocher, so it runs in linear time.
+	 *
+	 * @param pCoverage The coverage values. A value of 128 or above is considered to be inside.
+	 * @param width The image width.
+	 * @param height The image height.
+	 * @param spread The maximum distance in pixels which can be represented.
+	 * @param pDistanceField The output image. This must have the same size as the coverage image.
+	 */
+	void GenerateDistanceField(const uint8_t* pCoverage, uint32_t width, uint32_t height, float spread, uint8_t* pDistanceField);
+}
@@ -0,0 +1,190 @@
+// Copyright (c) 2022 Dhiraj Wishal
+
+#include "FramePacer.hpp"
+
+#include <algorithm>
+#include <cmath>
+#include <thread>
+
+namespace
+{
+	/**
+	 * The number of recent frames the statistics are taken from.
+	 */
+	constexpr uint32_t SampleCount = 240;
+
+	/**
+	 * The shortest time spent spinning before a deadline.
+	 */
+	constexpr rapid::FramePacer::clock_type::duration MinimumSpinTime = std::chrono::microseconds(100);
+
+	/**
+	 * The longest time spent spinning before a deadline.
+	 */
+	constexpr rapid::FramePacer::clock_type::duration MaximumSpinTime = std::chrono::milliseconds(4);
+
+	/**
+	 * How much the sleep error estimate shrinks every frame.
+	 */
+	constexpr double SleepErrorDecay = 0.99;
+
+	/**
+	 * Convert a duration to milliseconds.
+	 *
+	 * @param duration The duration.
+	 * @return The milliseconds.
+	 */
+	double ToMilliseconds(rapid::FramePacer::clock_type::duration duration)
+	{
+		return std::chrono::duration<double, std::milli>(duration).count();
+	}
+
+	/**
+	 * Get a percentile of the sorted values.
+	 *
+	 * @param values The sorted values.
+	 * @param percentile The percentile, from 0 to 1.
+	 * @return The value.
+	 */
+	double GetPercentile(const std::vector<double>& values, double percentile)
+	{
+		return values[static_cast<size_t>(percentile * static_cast<double>(values.size() - 1) + 0.5)];
+	}
+}
+
+namespace rapid
+{
+	FrameTimeHistory::FrameTimeHistory(uint32_t capacity)
+		: m_Capacity(std::max(capacity, 1u))
+	{
+		m_FrameTimes.reserve(m_Capacity);
+	}
+
+	void FrameTimeHistory::add(double frameTime)
+	{
+		if (m_FrameTimes.size() < m_Capacity)
+			m_FrameTimes.emplace_back(frameTime);
+
+		else
+			m_FrameTimes[m_Next] = frameTime;
+
+		m_Next = (m_Next + 1) % m_Capacity;
+	}
+
+	FrameTimeHistory::Summary FrameTimeHistory::summarize() const
+	{
+		if (m_FrameTimes.empty())
+			return Summary{};
+
+		auto frameTimes = m_FrameTimes;
+		std::sort(frameTimes.begin(), frameTimes.end());
+
+		return Summary{
+			.m_Median = GetPercentile(frameTimes, 0.5),
+			.m_Percentile99 = GetPercentile(frameTimes, 0.99),
+			.m_Maximum = frameTimes.back()
+		};
+	}
+
+	FramePacer::FramePacer(double targetFrameRate)
+		: m_FrameTimes(SampleCount), m_TargetFrameRate(targetFrameRate)
+	{
+	}
+
+	void FramePacer::wait()
+	{
+		const auto interval = getInterval();
+		m_LastInterval = interval;
+
+		auto now = clock_type::now();
+		if (!m_HasStarted)
+		{
+			m_HasStarted = true;
+			m_Deadline = now;
+			m_FrameStart = now;
+			return;
+		}
+
+		auto hasStalled = false;
+		if (interval > clock_type::duration::zero())
+		{
+			m_Deadline += interval;
+
+			if (now < m_Deadline)
+				waitUntil(m_Deadline);
+
+			// A late frame starts the next one right away. The deadlines restart from here, so the next frames don't rush
+			// to catch up.
+			else
+			{
+				m_MissedDeadlines++;
+				hasStalled = now - m_Deadline > interval;
+				m_Deadline = now;
+			}
+
+			now = clock_type::now();
+		}
+		else
+			m_Deadline = now;
+
+		// Frames which stalled for longer than a whole interval, like when the window was idle, would hide the jitter of
+		// the rest.
+		if (!hasStalled)
+			m_FrameTimes.add(ToMilliseconds(now - m_FrameStart));
+
+		m_FrameStart = now;
+	}
+
+	FramePacer::Statistics FramePacer::getStatistics() const
+	{
+		const auto summary = m_FrameTimes.summarize();
+		return Statistics{
+			.m_TargetFrameTime = ToMilliseconds(m_LastInterval),
+			.m_MedianFrameTime = summary.m_Median,
+			.m_Percentile99FrameTime = summary.m_Percentile99,
+			.m_MaxFrameTime = summary.m_Maximum,
+			.m_MissedDeadlines = m_MissedDeadlines
+		};
+	}
+
+	FramePacer::clock_type::duration FramePacer::getInterval() const
+	{
+		// Throttle the frames while the window is in the background.
+		auto frameRate = m_TargetFrameRate;
+		const auto backgroundFrameRate = m_Activity == Activity::Minimized ? m_BackgroundPolicy.m_MinimizedFrameRate
+			: m_Activity == Activity::Unfocused ? m_BackgroundPolicy.m_UnfocusedFrameRate
+			: 0.0;
+
+		if (backgroundFrameRate > 0.0)
+			frameRate = frameRate > 0.0 ? std::min(frameRate, backgroundFrameRate) : backgroundFrameRate;
+
+		// Keep to a whole number of refresh intervals, so every frame is shown for the same time.
+		if (m_RefreshRate > 0.0)
+			frameRate = frameRate > 0.0 && frameRate < m_RefreshRate ? m_RefreshRate / std::round(m_RefreshRate / frameRate) : m_RefreshRate;
+
+		if (frameRate <= 0.0)
+			return clock_type::duration::zero();
+
+		return std::chrono::duration_cast<clock_type::duration>(std::chrono::duration<double>(1.0 / frameRate));
+	}
+
+	void FramePacer::waitUntil(clock_type::time_point deadline)
+	{
+		// Sleep till the point where waking up as late as before is still on time.
+		const auto spinTime = std::clamp(m_SleepError, MinimumSpinTime, MaximumSpinTime);
+		const auto sleepDeadline = deadline - spinTime;
+
+		if (clock_type::now() < sleepDeadline)
+		{
+			std::this_thread::sleep_until(sleepDeadline);
+
+			// The estimate grows right away and shrinks slowly, so a single quick wake up doesn't make us miss the next deadline.
+			const auto sleepError = clock_type::now() - sleepDeadline;
+			m_SleepError = std::max(sleepError, std::chrono::duration_cast<clock_type::duration>(m_SleepError * SleepErrorDecay));
+		}
+
+		// Spin for the rest. Yielding lets other threads run meanwhile.
+		while (clock_type::now() < deadline)
+			std::this_thread::yield();
+	}
+}
\ No newline at end of file
@@ -0,0 +1,205 @@
+// Copyright (c) 2022 Dhiraj Wishal
+
+#pragma once
+
+#include <chrono>
+#include <cstdint>
+#include <vector>
+
+namespace rapid
+{
+	/**
+	 * Frame time history class.
+	 * This keeps the times of the recent frames, and summarizes them using the nearest rank percentiles.
+	 */
+	class FrameTimeHistory final
+	{
+	public:
+		/**
+		 * Summary structure.
+		 * The frame times are in the unit they were added in.
+		 */
+		struct Summary final
+		{
+			double m_Median = 0.0;
+			double m_Percentile99 = 0.0;
+			double m_Maximum = 0.0;
+		};
+
+	public:
+		/**
+		 * Explicit constructor.
+		 *
+		 * @param capacity The number of recent frames to keep. Older frames are replaced.
+		 */
+		explicit FrameTimeHistory(uint32_t capacity);
+
+		/**
+		 * Add a frame time.
+		 *
+		 * @param frameTime The frame time.
+		 */
+		void add(double frameTime);
+
+		/**
+		 * Summarize the recent frame times.
+		 *
+		 * @return The summary. Everything is 0 if no frame times were added.
+		 */
+		Summary summarize() const;
+
+		/**
+		 * Get the number of frame times kept.
+		 *
+		 * @return The count.
+		 */
+		uint64_t size() const { return m_FrameTimes.size(); }
+
+	private:
+		std::vector<double> m_FrameTimes = {};
+
+		const uint32_t m_Capacity;
+		uint32_t m_Next = 0;
+	};
+
+	/**
+	 * Frame pacer class.
+	 * This keeps the frames at a steady rate by waiting till each frame's deadline. The deadlines advance by a fixed
+	 * interval, so the time spent on a frame doesn't add to the wait. Most of the wait is slept, and the last part, where
+	 * the scheduler could wake us too late, is spun. How late the sleeps wake up is measured, so the spin is only as long
+	 * as it needs to be.
+	 *
+	 * If the display's refresh rate is known, the interval is a whole number of refresh intervals, so every frame stays on
+	 * the screen for the same time. The rate can be lowered further while the window is in the background.
+	 */
+	class FramePacer final
+	{
+	public:
+		using clock_type = std::chrono::steady_clock;
+
+		/**
+		 * Window activity enum.
+		 */
+		enum class Activity : uint8_t
+		{
+			Focused,
+			Unfocused,
+			Minimized
+		};
+
+		/**
+		 * Background policy structure.
+		 * The frame rates are only used when they're lower than the target frame rate.
+		 */
+		struct BackgroundPolicy final
+		{
+			double m_UnfocusedFrameRate = 30.0;	// The frame rate while the window doesn't have the focus. 0 doesn't throttle.
+			double m_MinimizedFrameRate = 4.0;	// The frame rate while the window is minimized. 0 doesn't throttle.
+		};
+
+		/**
+		 * Statistics structure.
+		 * The frame times are in milliseconds, and are taken from the recent frames.
+		 */
+		struct Statistics final
+		{
+			double m_TargetFrameTime = 0.0;
+			double m_MedianFrameTime = 0.0;
+			double m_Percentile99FrameTime = 0.0;
+			double m_MaxFrameTime = 0.0;
+			uint64_t m_MissedDeadlines = 0;	// The number of frames which started after their deadline, since the pacer was created.
+		};
+
+	public:
+		/**
+		 * Explicit constructor.
+		 *
+		 * @param targetFrameRate The frame rate to keep. If 0, the display's refresh rate is used. Default is 0.
+		 */
+		explicit FramePacer(double targetFrameRate = 0.0);
+
+		/**
+		 * Wait till the next frame should start.
+		 * Call this once every frame.
+		 */
+		void wait();
+
+		/**
+		 * Set the target frame rate.
+		 *
+		 * @param frameRate The frame rate. If 0, the display's refresh rate is used, or the frames are not limited if it's unknown.
+		 */
+		void setTargetFrameRate(double frameRate) { m_TargetFrameRate = frameRate; }
+
+		/**
+		 * Get the target frame rate.
+		 *
+		 * @return The frame rate.
+		 */
+		double getTargetFrameRate() const { return m_TargetFrameRate; }
+
+		/**
+		 * Set the display's refresh rate.
+		 *
+		 * @param refreshRate The refresh rate. 0 if unknown.
+		 */
+		void setRefreshRate(double refreshRate) { m_RefreshRate = refreshRate; }
+
+		/**
+		 * Set the window's activity.
+		 * The background policy is applied while the window is not focused.
+		 *
+		 * @param activity The activity.
+		 */
+		void setActivity(Activity activity) { m_Activity = activity; }
+
+		/**
+		 * Set the background policy.
+		 *
+		 * @param policy The policy.
+		 */
+		void setBackgroundPolicy(const BackgroundPolicy& policy) { m_BackgroundPolicy = policy; }
+
+		/**
+		 * Get the frame time statistics.
+		 *
+		 * @return The statistics.
+		 */
+		Statistics getStatistics() const;
+
+		/**
+		 * Get the interval between two frames.
+		 * This applies the background policy and the refresh rate to the target frame rate.
+		 *
+		 * @return The interval. This is zero if the frames are not limited.
+		 */
+		clock_type::duration getInterval() const;
+
+	private:
+		/**
+		 * Wait till a time point.
+		 * This sleeps for as long as it can without waking up too late, and spins for the rest.
+		 *
+		 * @param deadline The time point to wait till.
+		 */
+		void waitUntil(clock_type::time_point deadline);
+
+	private:
+		FrameTimeHistory m_FrameTimes;
+
+		BackgroundPolicy m_BackgroundPolicy = {};
+
+		clock_type::time_point m_Deadline = {};
+		clock_type::time_point m_FrameStart = {};
+		clock_type::duration m_SleepError = std::chrono::milliseconds(1);
+		clock_type::duration m_LastInterval = {};
+
+		double m_TargetFrameRate = 0.0;
+		double m_RefreshRate = 0.0;
+
+		uint64_t m_MissedDeadlines = 0;
+
+		Activity m_Activity = Activity::Focused;
+		bool m_HasStarted = false;
+	};
+}
@@ -0,0 +1,27 @@
+// Copyright (c) 2022 Dhiraj Wishal
+
+#include "Hash.hpp"
+
+#include <cstring>
+
+namespace rapid
+{
+	uint64_t HashBytes(const void* pData, uint64_t size, uint64_t hash)
+	{
+		constexpr uint64_t prime = 1099511628211ull;
+
+		const auto pBytes = static_cast<const uint8_t*>(pData);
+		uint64_t i = 0;
+		for (; i + sizeof(uint32_t) <= size; i += sizeof(uint32_t))
+		{
+			uint32_t word = 0;
+			std::memcpy(&word, pBytes + i, sizeof(uint32_t));
+			hash = (hash ^ word) * prime;
+		}
+
+		for (; i < size; i++)
+			hash = (hash ^ pBytes[i]) * prime;
+
+		return hash;
+	}
+}
@@ -0,0 +1,37 @@
+// Copyright (c) 2022 Dhiraj Wishal
+
+#pragma once
+
+#include <cstdint>
+
+namespace rapid
+{
+	/**
+	 * The seed to start hashing from.
+	 * This is the 64 bit FNV offset basis.
+	 */
+	constexpr uint64_t HashSeed = 14695981039346656037ull;
+
+	/**
+	 * Hash a block of data.
+	 * This uses the 64 bit FNV-1a algorithm, but over 32 bit words to keep it fast over large buffers.
+	 * Note that this is not meant to be used for anything security related.
+	 *
+	 * @param pData The data pointer.
+	 * @param size The size of the data in bytes.
+	 * @param hash The hash to continue from. Default is the seed.
+	 * @return The hash value.
+	 */
+	uint64_t HashBytes(const void* pData, uint64_t size, uint64_t hash = HashSeed);
+
+	/**
+	 * Hash a trivially copyable value.
+	 *
+	 * @tparam Type The value type.
+	 * @param value The value to hash.
+	 * @param hash The hash to continue from. Default is the seed.
+	 * @return The hash value.
+	 */
+	template<class Type>
+	uint64_t HashValue(const Type& value, uint64_t hash = HashSeed) { return HashBytes(&value, sizeof(Type), hash); }
+}
@@ -0,0 +1,24 @@
+// Copyright (c) 2022 Dhiraj Wishal
+
+#include "LinkSegments.hpp"
+
+#include <cmath>
+
+namespace rapid
+{
+	uint32_t GetLinkSegmentCount(float longestLength, float segmentsPerLength)
+	{
+		// The count is clamped before it's converted, since converting a value which doesn't fit is undefined.
+		const auto segmentCount = std::ceil(longestLength * segmentsPerLength);
+		if (std::isnan(segmentCount))
+			return MaximumLinkSegmentCount;
+
+		if (segmentCount <= 1.0f)
+			return 1;
+
+		if (segmentCount >= static_cast<float>(MaximumLinkSegmentCount))
+			return MaximumLinkSegmentCount;
+
+		return static_cast<uint32_t>(segmentCount);
+	}
+}
\ No newline at end of file
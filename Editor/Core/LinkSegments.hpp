@@ -0,0 +1,24 @@
+// Copyright (c) 2022 Dhiraj Wishal
+
+#pragma once
+
+#include <cstdint>
+
+namespace rapid
+{
+	/**
+	 * The maximum number of segments per link.
+	 */
+	constexpr uint32_t MaximumLinkSegmentCount = 64;
+
+	/**
+	 * Get the number of segments the links are drawn with.
+	 * Every link is drawn with the same number of segments, so the longest link decides how smooth the curves are. Lengths
+	 * which are not finite, or too long, use the maximum.
+	 *
+	 * @param longestLength The length of the longest link in pixels.
+	 * @param segmentsPerLength The number of segments per pixel.
+	 * @return The segment count, between 1 and MaximumLinkSegmentCount.
+	 */
+	uint32_t GetLinkSegmentCount(float longestLength, float segmentsPerLength);
+}
\ No newline at end of file
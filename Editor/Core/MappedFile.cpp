@@ -0,0 +1,84 @@
+// Copyright (c) 2022 Dhiraj Wishal
+
+#include "MappedFile.hpp"
+
+#ifdef RAPID_PLATFORM_WINDOWS
+#define WIN32_LEAN_AND_MEAN
+#define NOMINMAX
+#include <Windows.h>
+
+#else
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+
+#endif
+
+namespace rapid
+{
+#ifdef RAPID_PLATFORM_WINDOWS
+	MappedFile::MappedFile(const std::filesystem::path& path)
+	{
+		m_pFile = CreateFileW(path.c_str(), GENERIC_READ, FILE_SHARE_READ, nullptr, OPEN_EXISTING, FILE_ATTRIBUTE_NORMAL | FILE_FLAG_SEQUENTIAL_SCAN, nullptr);
+		if (m_pFile == INVALID_HANDLE_VALUE)
+		{
+			m_pFile = nullptr;
+			return;
+		}
+
+		LARGE_INTEGER fileSize = {};
+		if (!GetFileSizeEx(m_pFile, &fileSize) || fileSize.QuadPart == 0)
+			return;
+
+		m_pMapping = CreateFileMappingW(m_pFile, nullptr, PAGE_READONLY, 0, 0, nullptr);
+		if (!m_pMapping)
+			return;
+
+		m_pData = static_cast<const std::byte*>(MapViewOfFile(m_pMapping, FILE_MAP_READ, 0, 0, 0));
+		if (m_pData)
+			m_Size = static_cast<uint64_t>(fileSize.QuadPart);
+	}
+
+	MappedFile::~MappedFile()
+	{
+		if (m_pData)
+			UnmapViewOfFile(m_pData);
+
+		if (m_pMapping)
+			CloseHandle(m_pMapping);
+
+		if (m_pFile)
+			CloseHandle(m_pFile);
+	}
+
+#else
+	MappedFile::MappedFile(const std::filesystem::path& path)
+	{
+		const auto file = open(path.c_str(), O_RDONLY);
+		if (file < 0)
+			return;
+
+		struct stat fileStatus = {};
+		if (fstat(file, &fileStatus) == 0 && fileStatus.st_size > 0)
+		{
+			const auto pData = mmap(nullptr, static_cast<size_t>(fileStatus.st_size), PROT_READ, MAP_PRIVATE, file, 0);
+			if (pData != MAP_FAILED)
+			{
+				m_pData = static_cast<const std::byte*>(pData);
+				m_Size = static_cast<uint64_t>(fileStatus.st_size);
+			}
+		}
+
+		// The mapping stays valid after the file is closed.
+		close(file);
+	}
+
+	MappedFile::~MappedFile()
+	{
+		if (m_pData)
+			munmap(const_cast<std::byte*>(m_pData), static_cast<size_t>(m_Size));
+	}
+
+#endif
+}
@@ -0,0 +1,65 @@
+// Copyright (c) 2022 Dhiraj Wishal
+
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+#include <filesystem>
+
+namespace rapid
+{
+	/**
+	 * Mapped file class.
+	 * This maps a whole file to the address space as read only memory, so it can be read without copying it to a buffer.
+	 */
+	class MappedFile final
+	{
+	public:
+		/**
+		 * Explicit constructor.
+		 * If the file could not be mapped, the object would be invalid.
+		 *
+		 * @param path The file path.
+		 */
+		explicit MappedFile(const std::filesystem::path& path);
+
+		/**
+		 * Destructor.
+		 */
+		~MappedFile();
+
+		MappedFile(const MappedFile&) = delete;
+		MappedFile& operator=(const MappedFile&) = delete;
+
+		/**
+		 * Check if the file was mapped successfully.
+		 *
+		 * @return Whether or not the mapping is valid.
+		 */
+		bool isValid() const { return m_pData != nullptr; }
+
+		/**
+		 * Get the mapped data.
+		 *
+		 * @return The data pointer.
+		 */
+		const std::byte* data() const { return m_pData; }
+
+		/**
+		 * Get the size of the file.
+		 *
+		 * @return The size in bytes.
+		 */
+		uint64_t size() const { return m_Size; }
+
+	private:
+		const std::byte* m_pData = nullptr;
+		uint64_t m_Size = 0;
+
+#ifdef RAPID_PLATFORM_WINDOWS
+		void* m_pFile = nullptr;
+		void* m_pMapping = nullptr;
+
+#endif
+	};
+}
@@ -0,0 +1,198 @@
+// Copyright (c) 2022 Dhiraj Wishal
+
+#include "PassScheduler.hpp"
+
+#include <algorithm>
+#include <numeric>
+
+namespace rapid
+{
+	uint32_t PassScheduler::addResource(bool isTransient)
+	{
+		m_Resources.emplace_back(Resource{ .m_IsTransient = isTransient });
+		return static_cast<uint32_t>(m_Resources.size() - 1);
+	}
+
+	uint32_t PassScheduler::addPass()
+	{
+		m_Passes.emplace_back();
+		return static_cast<uint32_t>(m_Passes.size() - 1);
+	}
+
+	bool PassScheduler::addAccess(uint32_t pass, uint32_t resource, uint32_t usage, bool isWrite)
+	{
+		auto& accesses = m_Passes[pass].m_Accesses;
+
+		const auto itr = std::find_if(accesses.begin(), accesses.end(), [resource](const Access& access) { return access.m_Resource == resource; });
+		if (itr != accesses.end())
+		{
+			if (itr->m_Usage != usage)
+				return false;
+
+			itr->m_IsWrite |= isWrite;
+			return true;
+		}
+
+		accesses.emplace_back(Access{ .m_Resource = resource, .m_Usage = usage, .m_IsWrite = isWrite });
+		return true;
+	}
+
+	std::vector<uint32_t> PassScheduler::schedule()
+	{
+		cullPasses();
+		groupPasses();
+
+		std::vector<uint32_t> order;
+		order.reserve(m_Passes.size());
+		for (uint32_t i = 0; i < m_Passes.size(); i++)
+		{
+			if (!m_Passes[i].m_IsCulled)
+				order.emplace_back(i);
+		}
+
+		std::stable_sort(order.begin(), order.end(), [this](uint32_t lhs, uint32_t rhs) { return m_Passes[lhs].m_Group < m_Passes[rhs].m_Group; });
+		return order;
+	}
+
+	std::vector<MemoryRequirement> PassScheduler::aliasMemory(const std::vector<uint32_t>& resources, const std::vector<MemoryRequirement>& requirements, std::vector<uint32_t>& blockIndexes) const
+	{
+		// The resources are placed in the order of their first use, so a block is free if its last resource is done before
+		// the new one starts.
+		std::vector<uint64_t> sortedIndexes(resources.size());
+		std::iota(sortedIndexes.begin(), sortedIndexes.end(), 0);
+		std::stable_sort(sortedIndexes.begin(), sortedIndexes.end(), [this, &resources](uint64_t lhs, uint64_t rhs) { return m_Resources[resources[lhs]].m_FirstGroup < m_Resources[resources[rhs]].m_FirstGroup; });
+
+		std::vector<MemoryRequirement> blocks;
+		std::vector<uint32_t> blockLastGroups;
+		blockIndexes.assign(resources.size(), 0);
+
+		for (const auto index : sortedIndexes)
+		{
+			const auto& resource = m_Resources[resources[index]];
+			const auto& requirement = requirements[index];
+
+			uint32_t block = 0;
+			while (block < blocks.size() && (blockLastGroups[block] >= resource.m_FirstGroup || (blocks[block].m_TypeBits & requirement.m_TypeBits) == 0))
+				block++;
+
+			if (block == blocks.size())
+			{
+				blocks.emplace_back(requirement);
+				blockLastGroups.emplace_back(resource.m_LastGroup);
+			}
+			else
+			{
+				auto& memory = blocks[block];
+				memory.m_Size = std::max(memory.m_Size, requirement.m_Size);
+				memory.m_Alignment = std::max(memory.m_Alignment, requirement.m_Alignment);
+				memory.m_TypeBits &= requirement.m_TypeBits;
+				blockLastGroups[block] = resource.m_LastGroup;
+			}
+
+			blockIndexes[index] = block;
+		}
+
+		return blocks;
+	}
+
+	void PassScheduler::clear()
+	{
+		m_Passes.clear();
+		m_Resources.clear();
+		m_GroupCount = 0;
+	}
+
+	void PassScheduler::cullPasses()
+	{
+		// Find the last writer of each resource, which is the pass that produces what another pass uses.
+		std::vector<std::vector<uint32_t>> producers(m_Passes.size());
+		std::vector<int64_t> lastWriters(m_Resources.size(), -1);
+		for (uint32_t i = 0; i < m_Passes.size(); i++)
+		{
+			for (const auto& access : m_Passes[i].m_Accesses)
+			{
+				if (lastWriters[access.m_Resource] >= 0)
+					producers[i].emplace_back(static_cast<uint32_t>(lastWriters[access.m_Resource]));
+			}
+
+			for (const auto& access : m_Passes[i].m_Accesses)
+			{
+				if (access.m_IsWrite)
+					lastWriters[access.m_Resource] = i;
+			}
+		}
+
+		// Walk back from the passes whose results are visible outside the graph. Producers always come before the passes
+		// which use them, so a single reverse pass is enough.
+		for (auto i = static_cast<int64_t>(m_Passes.size()) - 1; i >= 0; i--)
+		{
+			auto& pass = m_Passes[i];
+			if (pass.m_HasSideEffects || std::any_of(pass.m_Accesses.begin(), pass.m_Accesses.end(), [this](const Access& access) { return access.m_IsWrite && !m_Resources[access.m_Resource].m_IsTransient; }))
+				pass.m_IsCulled = false;
+
+			if (pass.m_IsCulled)
+				continue;
+
+			for (const auto producer : producers[i])
+				m_Passes[producer].m_IsCulled = false;
+		}
+	}
+
+	void PassScheduler::groupPasses()
+	{
+		/**
+		 * Group state structure.
+		 * This holds the passes which last accessed a resource, and the ones before them.
+		 */
+		struct GroupState final
+		{
+			std::vector<uint32_t> m_PreviousGroup = {};
+			std::vector<uint32_t> m_CurrentGroup = {};
+			uint32_t m_Usage = 0;
+			bool m_IsReadGroup = false;
+		};
+
+		std::vector<GroupState> states(m_Resources.size());
+		m_GroupCount = 0;
+
+		for (uint32_t i = 0; i < m_Passes.size(); i++)
+		{
+			auto& pass = m_Passes[i];
+			if (pass.m_IsCulled)
+				continue;
+
+			// Reads with the same usage don't depend on each other, but everything else depends on the previous accesses.
+			uint32_t group = 0;
+			for (const auto& access : pass.m_Accesses)
+			{
+				auto& state = states[access.m_Resource];
+
+				const auto joinsGroup = !access.m_IsWrite && state.m_IsReadGroup && state.m_Usage == access.m_Usage;
+				if (!joinsGroup)
+				{
+					state.m_PreviousGroup = std::move(state.m_CurrentGroup);
+					state.m_CurrentGroup.clear();
+					state.m_IsReadGroup = !access.m_IsWrite;
+					state.m_Usage = access.m_Usage;
+				}
+
+				for (const auto dependency : state.m_PreviousGroup)
+					group = std::max(group, m_Passes[dependency].m_Group + 1);
+
+				state.m_CurrentGroup.emplace_back(i);
+			}
+
+			pass.m_Group = group;
+			m_GroupCount = std::max(m_GroupCount, group + 1);
+
+			// Note the lifetimes, to know which transient resources can share memory.
+			for (const auto& access : pass.m_Accesses)
+			{
+				auto& resource = m_Resources[access.m_Resource];
+				resource.m_FirstGroup = resource.m_IsUsed ? std::min(resource.m_FirstGroup, group) : group;
+				resource.m_LastGroup = resource.m_IsUsed ? std::max(resource.m_LastGroup, group) : group;
+				resource.m_IsUsed = true;
+			}
+		}
+	}
+}
\ No newline at end of file
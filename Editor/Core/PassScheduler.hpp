@@ -0,0 +1,176 @@
+// Copyright (c) 2022 Dhiraj Wishal
+
+#pragma once
+
+#include <cstdint>
+#include <vector>
+
+namespace rapid
+{
+	/**
+	 * Memory requirement structure.
+	 */
+	struct MemoryRequirement final
+	{
+		uint64_t m_Size = 0;
+		uint64_t m_Alignment = 0;
+		uint32_t m_TypeBits = 0;
+	};
+
+	/**
+	 * Pass scheduler class.
+	 * This decides which passes of a render graph run and in what order, using only the resources each pass reads and writes:
+	 * - Passes whose outputs are never used are culled. Writing to a resource which is not transient, or having side
+	 *   effects, counts as being used.
+	 * - The passes which are left are put into groups. Each pass goes to the group after the last group it depends on, so
+	 *   the passes of a group don't depend on each other.
+	 * - The lifetimes of the resources are noted in groups, so transient resources whose lifetimes don't overlap can share
+	 *   memory.
+	 *
+	 * Usages are opaque values. Reads with the same usage don't depend on each other, everything else does.
+	 */
+	class PassScheduler final
+	{
+	public:
+		/**
+		 * Access structure.
+		 */
+		struct Access final
+		{
+			uint32_t m_Resource = 0;
+			uint32_t m_Usage = 0;
+			bool m_IsWrite = false;
+		};
+
+		/**
+		 * Pass structure.
+		 */
+		struct Pass final
+		{
+			std::vector<Access> m_Accesses = {};
+
+			uint32_t m_Group = 0;
+			bool m_HasSideEffects = false;
+			bool m_IsCulled = true;
+		};
+
+		/**
+		 * Resource structure.
+		 */
+		struct Resource final
+		{
+			uint32_t m_FirstGroup = 0;
+			uint32_t m_LastGroup = 0;
+
+			bool m_IsTransient = false;
+			bool m_IsUsed = false;
+		};
+
+	public:
+		/**
+		 * Add a resource.
+		 *
+		 * @param isTransient Whether or not the resource only lives within the graph.
+		 * @return The resource index.
+		 */
+		uint32_t addResource(bool isTransient);
+
+		/**
+		 * Add a pass.
+		 *
+		 * @return The pass index.
+		 */
+		uint32_t addPass();
+
+		/**
+		 * Add an access to a pass.
+		 * A pass can only use a resource with one usage. Reading and writing it with the same usage is a write.
+		 *
+		 * @param pass The pass index.
+		 * @param resource The resource index.
+		 * @param usage The usage.
+		 * @param isWrite Whether or not the resource is written.
+		 * @return False if the pass already uses the resource with a different usage.
+		 */
+		bool addAccess(uint32_t pass, uint32_t resource, uint32_t usage, bool isWrite);
+
+		/**
+		 * Mark a pass as having side effects.
+		 * These passes are never culled, even if nothing uses their outputs.
+		 *
+		 * @param pass The pass index.
+		 */
+		void setSideEffects(uint32_t pass) { m_Passes[pass].m_HasSideEffects = true; }
+
+		/**
+		 * Cull and group the passes.
+		 *
+		 * @return The passes which are not culled, group by group, in the order they were added within a group.
+		 */
+		std::vector<uint32_t> schedule();
+
+		/**
+		 * Place transient resources in memory blocks.
+		 * Each resource goes to the first block which is free during its lifetime and has a compatible memory type. This
+		 * needs to be called after scheduling.
+		 *
+		 * @param resources The resources to place.
+		 * @param requirements The memory requirements of the resources.
+		 * @param blockIndexes The index of each resource's block is stored in this.
+		 * @return The memory requirements of the blocks.
+		 */
+		std::vector<MemoryRequirement> aliasMemory(const std::vector<uint32_t>& resources, const std::vector<MemoryRequirement>& requirements, std::vector<uint32_t>& blockIndexes) const;
+
+		/**
+		 * Remove all the passes and resources.
+		 */
+		void clear();
+
+		/**
+		 * Get a pass.
+		 *
+		 * @param pass The pass index.
+		 * @return The pass.
+		 */
+		const Pass& getPass(uint32_t pass) const { return m_Passes[pass]; }
+
+		/**
+		 * Get a resource.
+		 *
+		 * @param resource The resource index.
+		 * @return The resource.
+		 */
+		const Resource& getResource(uint32_t resource) const { return m_Resources[resource]; }
+
+		/**
+		 * Get the number of passes.
+		 *
+		 * @return The pass count.
+		 */
+		uint32_t getPassCount() const { return static_cast<uint32_t>(m_Passes.size()); }
+
+		/**
+		 * Get the number of groups made by the last schedule.
+		 *
+		 * @return The group count.
+		 */
+		uint32_t getGroupCount() const { return m_GroupCount; }
+
+	private:
+		/**
+		 * Cull the passes whose outputs are not used.
+		 */
+		void cullPasses();
+
+		/**
+		 * Put the passes into groups.
+		 */
+		void groupPasses();
+
+	private:
+		std::vector<Pass> m_Passes = {};
+		std::vector<Resource> m_Resources = {};
+
+		uint32_t m_GroupCount = 0;
+	};
+}
\ No newline at end of file
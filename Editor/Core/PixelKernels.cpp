@@ -0,0 +1,331 @@
+// Copyright (c) 2022 Dhiraj Wishal
+
+#include "PixelKernels.hpp"
+
+#include "CpuFeatures.hpp"
+
+#include <algorithm>
+#include <array>
+#include <cmath>
+#include <cstring>
+
+#if defined(RAPID_ARCHITECTURE_X86)
+#include <immintrin.h>
+
+#elif defined(RAPID_ARCHITECTURE_NEON)
+#include <arm_neon.h>
+
+#endif
+
+namespace
+{
+	using lookup_table = std::array<uint8_t, 256>;
+
+	/**
+	 * Multiply two 8 bit values as if they were in the [0, 1] range, rounding to the nearest value.
+	 *
+	 * @param value The value.
+	 * @param factor The factor.
+	 * @return The product.
+	 */
+	constexpr uint8_t MultiplyNormalized(uint32_t value, uint32_t factor)
+	{
+		const auto product = value * factor + 128;
+		return static_cast<uint8_t>((product + (product >> 8)) >> 8);
+	}
+
+	/**
+	 * Scalar red and blue swizzle kernel.
+	 */
+	void SwizzleRedBlueScalar(uint8_t* pDestination, const uint8_t* pSource, uint64_t pixelCount)
+	{
+		for (uint64_t i = 0; i < pixelCount; i++, pDestination += 4, pSource += 4)
+		{
+			const uint8_t pixel[4] = { pSource[2], pSource[1], pSource[0], pSource[3] };
+			std::memcpy(pDestination, pixel, 4);
+		}
+	}
+
+	/**
+	 * Scalar alpha premultiplication kernel.
+	 */
+	void PremultiplyAlphaScalar(uint8_t* pDestination, const uint8_t* pSource, uint64_t pixelCount)
+	{
+		for (uint64_t i = 0; i < pixelCount; i++, pDestination += 4, pSource += 4)
+		{
+			const auto alpha = pSource[3];
+			pDestination[0] = MultiplyNormalized(pSource[0], alpha);
+			pDestination[1] = MultiplyNormalized(pSource[1], alpha);
+			pDestination[2] = MultiplyNormalized(pSource[2], alpha);
+			pDestination[3] = alpha;
+		}
+	}
+
+#ifdef RAPID_ARCHITECTURE_X86
+	/**
+	 * SSSE3 red and blue swizzle kernel.
+	 * This converts 4 pixels per iteration using a byte shuffle.
+	 */
+	RAPID_TARGET("ssse3") void SwizzleRedBlueSSSE3(uint8_t* pDestination, const uint8_t* pSource, uint64_t pixelCount)
+	{
+		const auto mask = _mm_setr_epi8(2, 1, 0, 3, 6, 5, 4, 7, 10, 9, 8, 11, 14, 13, 12, 15);
+
+		for (; pixelCount >= 4; pixelCount -= 4, pDestination += 16, pSource += 16)
+		{
+			const auto pixels = _mm_loadu_si128(reinterpret_cast<const __m128i*>(pSource));
+			_mm_storeu_si128(reinterpret_cast<__m128i*>(pDestination), _mm_shuffle_epi8(pixels, mask));
+		}
+
+		SwizzleRedBlueScalar(pDestination, pSource, pixelCount);
+	}
+
+	/**
+	 * SSSE3 alpha premultiplication kernel.
+	 * This converts 4 pixels per iteration. The channels are widened to 16 bits, multiplied by the broadcasted alpha and
+	 * rounded using the same formula as the scalar kernel, so the results are bit exact.
+	 */
+	RAPID_TARGET("ssse3") void PremultiplyAlphaSSSE3(uint8_t* pDestination, const uint8_t* pSource, uint64_t pixelCount)
+	{
+		const auto zero = _mm_setzero_si128();
+		const auto rounding = _mm_set1_epi16(128);
+		const auto alphaMask = _mm_set1_epi32(static_cast<int32_t>(0xFF000000));
+		const auto lowAlphas = _mm_setr_epi8(3, -1, 3, -1, 3, -1, 3, -1, 7, -1, 7, -1, 7, -1, 7, -1);
+		const auto highAlphas = _mm_setr_epi8(11, -1, 11, -1, 11, -1, 11, -1, 15, -1, 15, -1, 15, -1, 15, -1);
+
+		for (; pixelCount >= 4; pixelCount -= 4, pDestination += 16, pSource += 16)
+		{
+			const auto pixels = _mm_loadu_si128(reinterpret_cast<const __m128i*>(pSource));
+
+			auto low = _mm_add_epi16(_mm_mullo_epi16(_mm_unpacklo_epi8(pixels, zero), _mm_shuffle_epi8(pixels, lowAlphas)), rounding);
+			auto high = _mm_add_epi16(_mm_mullo_epi16(_mm_unpackhi_epi8(pixels, zero), _mm_shuffle_epi8(pixels, highAlphas)), rounding);
+			low = _mm_srli_epi16(_mm_add_epi16(low, _mm_srli_epi16(low, 8)), 8);
+			high = _mm_srli_epi16(_mm_add_epi16(high, _mm_srli_epi16(high, 8)), 8);
+
+			// Put the original alpha values back.
+			const auto result = _mm_or_si128(_mm_andnot_si128(alphaMask, _mm_packus_epi16(low, high)), _mm_and_si128(alphaMask, pixels));
+			_mm_storeu_si128(reinterpret_cast<__m128i*>(pDestination), result);
+		}
+
+		PremultiplyAlphaScalar(pDestination, pSource, pixelCount);
+	}
+
+	/**
+	 * AVX2 red and blue swizzle kernel.
+	 * This converts 8 pixels per iteration using a byte shuffle.
+	 */
+	RAPID_TARGET("avx2") void SwizzleRedBlueAVX2(uint8_t* pDestination, const uint8_t* pSource, uint64_t pixelCount)
+	{
+		const auto mask = _mm256_setr_epi8(
+			2, 1, 0, 3, 6, 5, 4, 7, 10, 9, 8, 11, 14, 13, 12, 15,
+			2, 1, 0, 3, 6, 5, 4, 7, 10, 9, 8, 11, 14, 13, 12, 15);
+
+		for (; pixelCount >= 8; pixelCount -= 8, pDestination += 32, pSource += 32)
+		{
+			const auto pixels = _mm256_loadu_si256(reinterpret_cast<const __m256i*>(pSource));
+			_mm256_storeu_si256(reinterpret_cast<__m256i*>(pDestination), _mm256_shuffle_epi8(pixels, mask));
+		}
+
+		_mm256_zeroupper();
+		SwizzleRedBlueScalar(pDestination, pSource, pixelCount);
+	}
+
+	/**
+	 * AVX2 alpha premultiplication kernel.
+	 * This is the same as the SSSE3 kernel, but converts 8 pixels per iteration. The unpacks and the pack work within
+	 * each 128 bit lane, so the pixels end up in their original order.
+	 */
+	RAPID_TARGET("avx2") void PremultiplyAlphaAVX2(uint8_t* pDestination, const uint8_t* pSource, uint64_t pixelCount)
+	{
+		const auto zero = _mm256_setzero_si256();
+		const auto rounding = _mm256_set1_epi16(128);
+		const auto alphaMask = _mm256_set1_epi32(static_cast<int32_t>(0xFF000000));
+		const auto lowAlphas = _mm256_setr_epi8(
+			3, -1, 3, -1, 3, -1, 3, -1, 7, -1, 7, -1, 7, -1, 7, -1,
+			3, -1, 3, -1, 3, -1, 3, -1, 7, -1, 7, -1, 7, -1, 7, -1);
+		const auto highAlphas = _mm256_setr_epi8(
+			11, -1, 11, -1, 11, -1, 11, -1, 15, -1, 15, -1, 15, -1, 15, -1,
+			11, -1, 11, -1, 11, -1, 11, -1, 15, -1, 15, -1, 15, -1, 15, -1);
+
+		for (; pixelCount >= 8; pixelCount -= 8, pDestination += 32, pSource += 32)
+		{
+			const auto pixels = _mm256_loadu_si256(reinterpret_cast<const __m256i*>(pSource));
+
+			auto low = _mm256_add_epi16(_mm256_mullo_epi16(_mm256_unpacklo_epi8(pixels, zero), _mm256_shuffle_epi8(pixels, lowAlphas)), rounding);
+			auto high = _mm256_add_epi16(_mm256_mullo_epi16(_mm256_unpackhi_epi8(pixels, zero), _mm256_shuffle_epi8(pixels, highAlphas)), rounding);
+			low = _mm256_srli_epi16(_mm256_add_epi16(low, _mm256_srli_epi16(low, 8)), 8);
+			high = _mm256_srli_epi16(_mm256_add_epi16(high, _mm256_srli_epi16(high, 8)), 8);
+
+			const auto result = _mm256_or_si256(_mm256_andnot_si256(alphaMask, _mm256_packus_epi16(low, high)), _mm256_and_si256(alphaMask, pixels));
+			_mm256_storeu_si256(reinterpret_cast<__m256i*>(pDestination), result);
+		}
+
+		_mm256_zeroupper();
+		PremultiplyAlphaScalar(pDestination, pSource, pixelCount);
+	}
+
+#endif
+
+#ifdef RAPID_ARCHITECTURE_NEON
+	/**
+	 * NEON red and blue swizzle kernel.
+	 * This converts 16 pixels per iteration using de-interleaving loads and stores.
+	 */
+	void SwizzleRedBlueNEON(uint8_t* pDestination, const uint8_t* pSource, uint64_t pixelCount)
+	{
+		for (; pixelCount >= 16; pixelCount -= 16, pDestination += 64, pSource += 64)
+		{
+			auto pixels = vld4q_u8(pSource);
+			const auto red = pixels.val[0];
+			pixels.val[0] = pixels.val[2];
+			pixels.val[2] = red;
+			vst4q_u8(pDestination, pixels);
+		}
+
+		SwizzleRedBlueScalar(pDestination, pSource, pixelCount);
+	}
+
+	/**
+	 * Multiply 16 channel values by their alphas.
+	 *
+	 * @param values The channel values.
+	 * @param alphas The alpha values.
+	 * @return The products.
+	 */
+	uint8x16_t MultiplyNormalizedNEON(uint8x16_t values, uint8x16_t alphas)
+	{
+		const auto low = vmull_u8(vget_low_u8(values), vget_low_u8(alphas));
+		const auto high = vmull_u8(vget_high_u8(values), vget_high_u8(alphas));
+
+		// (x + ((x + 128) >> 8) + 128) >> 8, which is the same as the scalar rounding.
+		return vcombine_u8(vraddhn_u16(low, vrshrq_n_u16(low, 8)), vraddhn_u16(high, vrshrq_n_u16(high, 8)));
+	}
+
+	/**
+	 * NEON alpha premultiplication kernel.
+	 * This converts 16 pixels per iteration.
+	 */
+	void PremultiplyAlphaNEON(uint8_t* pDestination, const uint8_t* pSource, uint64_t pixelCount)
+	{
+		for (; pixelCount >= 16; pixelCount -= 16, pDestination += 64, pSource += 64)
+		{
+			auto pixels = vld4q_u8(pSource);
+			pixels.val[0] = MultiplyNormalizedNEON(pixels.val[0], pixels.val[3]);
+			pixels.val[1] = MultiplyNormalizedNEON(pixels.val[1], pixels.val[3]);
+			pixels.val[2] = MultiplyNormalizedNEON(pixels.val[2], pixels.val[3]);
+			vst4q_u8(pDestination, pixels);
+		}
+
+		PremultiplyAlphaScalar(pDestination, pSource, pixelCount);
+	}
+
+#endif
+
+	/**
+	 * Select the best kernels for the current CPU.
+	 *
+	 * @return The kernel table.
+	 */
+	rapid::PixelKernelTable SelectKernels()
+	{
+		// The supported kernels are ordered from the slowest to the fastest.
+		return rapid::GetSupportedPixelKernels().back();
+	}
+
+	/**
+	 * Get the selected kernels.
+	 * The selection is done only once.
+	 *
+	 * @return The kernel table.
+	 */
+	const rapid::PixelKernelTable& GetKernels()
+	{
+		static const auto kernels = SelectKernels();
+		return kernels;
+	}
+
+	/**
+	 * Create a lookup table for a transfer function.
+	 *
+	 * @tparam Function The function type.
+	 * @param function The function which maps a [0, 1] value.
+	 * @return The table.
+	 */
+	template<class Function>
+	lookup_table CreateLookupTable(Function&& function)
+	{
+		lookup_table table = {};
+		for (uint32_t i = 0; i < table.size(); i++)
+			table[i] = static_cast<uint8_t>(std::lround(std::clamp(function(i / 255.0f), 0.0f, 1.0f) * 255.0f));
+
+		return table;
+	}
+
+	/**
+	 * Convert the color channels using a lookup table.
+	 * With only 256 possible inputs, a table lookup is cheaper than evaluating the transfer function in vector registers.
+	 *
+	 * @param pDestination The destination pixels.
+	 * @param pSource The source pixels.
+	 * @param pixelCount The number of pixels to convert.
+	 * @param table The lookup table.
+	 */
+	void ConvertColors(uint8_t* pDestination, const uint8_t* pSource, uint64_t pixelCount, const lookup_table& table)
+	{
+		for (uint64_t i = 0; i < pixelCount; i++, pDestination += 4, pSource += 4)
+		{
+			pDestination[0] = table[pSource[0]];
+			pDestination[1] = table[pSource[1]];
+			pDestination[2] = table[pSource[2]];
+			pDestination[3] = pSource[3];
+		}
+	}
+}
+
+namespace rapid
+{
+	void SwizzleRedBlue(void* pDestination, const void* pSource, uint64_t pixelCount)
+	{
+		GetKernels().m_SwizzleRedBlue(static_cast<uint8_t*>(pDestination), static_cast<const uint8_t*>(pSource), pixelCount);
+	}
+
+	void PremultiplyAlpha(void* pDestination, const void* pSource, uint64_t pixelCount)
+	{
+		GetKernels().m_PremultiplyAlpha(static_cast<uint8_t*>(pDestination), static_cast<const uint8_t*>(pSource), pixelCount);
+	}
+
+	void ConvertSRGBToLinear(void* pDestination, const void* pSource, uint64_t pixelCount)
+	{
+		static const auto table = CreateLookupTable([](float value) { return value <= 0.04045f ? value / 12.92f : std::pow((value + 0.055f) / 1.055f, 2.4f); });
+		ConvertColors(static_cast<uint8_t*>(pDestination), static_cast<const uint8_t*>(pSource), pixelCount, table);
+	}
+
+	void ConvertLinearToSRGB(void* pDestination, const void* pSource, uint64_t pixelCount)
+	{
+		static const auto table = CreateLookupTable([](float value) { return value <= 0.0031308f ? value * 12.92f : 1.055f * std::pow(value, 1.0f / 2.4f) - 0.055f; });
+		ConvertColors(static_cast<uint8_t*>(pDestination), static_cast<const uint8_t*>(pSource), pixelCount, table);
+	}
+
+	const char* GetPixelKernelName()
+	{
+		return GetKernels().m_pName;
+	}
+
+	std::vector<PixelKernelTable> GetSupportedPixelKernels()
+	{
+		std::vector<PixelKernelTable> kernels = { { SwizzleRedBlueScalar, PremultiplyAlphaScalar, "Scalar" } };
+
+#if defined(RAPID_ARCHITECTURE_X86)
+		if (IsSSSE3Supported())
+			kernels.emplace_back(PixelKernelTable{ SwizzleRedBlueSSSE3, PremultiplyAlphaSSSE3, "SSSE3" });
+
+		if (IsAVX2Supported())
+			kernels.emplace_back(PixelKernelTable{ SwizzleRedBlueAVX2, PremultiplyAlphaAVX2, "AVX2" });
+
+#elif defined(RAPID_ARCHITECTURE_NEON)
+		kernels.emplace_back(PixelKernelTable{ SwizzleRedBlueNEON, PremultiplyAlphaNEON, "NEON" });
+
+#endif
+
+		return kernels;
+	}
+}
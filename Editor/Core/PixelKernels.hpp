@@ -0,0 +1,87 @@
+// Copyright (c) 2022 Dhiraj Wishal
+
+#pragma once
+
+#include <cstdint>
+#include <vector>
+
+namespace rapid
+{
+	/**
+	 * Pixel kernels.
+	 * These convert tightly packed 8 bit, four channel pixels (RGBA or BGRA). The best kernel for the CPU (AVX2, SSSE3 or
+	 * NEON) is selected at runtime the first time any of them is called.
+	 *
+	 * The destination and the source can be the same, in which case the pixels are converted in place. Otherwise they must
+	 * not overlap.
+	 */
+
+	/**
+	 * Swap the red and the blue channels.
+	 * This converts RGBA to BGRA and the other way around.
+	 *
+	 * @param pDestination The destination pixels.
+	 * @param pSource The source pixels.
+	 * @param pixelCount The number of pixels to convert.
+	 */
+	void SwizzleRedBlue(void* pDestination, const void* pSource, uint64_t pixelCount);
+
+	/**
+	 * Multiply the color channels by the alpha channel.
+	 * The result is rounded to the nearest value, so fully opaque pixels don't change.
+	 *
+	 * @param pDestination The destination pixels.
+	 * @param pSource The source pixels.
+	 * @param pixelCount The number of pixels to convert.
+	 */
+	void PremultiplyAlpha(void* pDestination, const void* pSource, uint64_t pixelCount);
+
+	/**
+	 * Decode sRGB encoded color channels to linear values.
+	 * The alpha channel is always linear, so it's copied as it is.
+	 *
+	 * @param pDestination The destination pixels.
+	 * @param pSource The source pixels.
+	 * @param pixelCount The number of pixels to convert.
+	 */
+	void ConvertSRGBToLinear(void* pDestination, const void* pSource, uint64_t pixelCount);
+
+	/**
+	 * Encode linear color channels to sRGB.
+	 * The alpha channel is always linear, so it's copied as it is.
+	 *
+	 * @param pDestination The destination pixels.
+	 * @param pSource The source pixels.
+	 * @param pixelCount The number of pixels to convert.
+	 */
+	void ConvertLinearToSRGB(void* pDestination, const void* pSource, uint64_t pixelCount);
+
+	/**
+	 * Get the name of the pixel kernels selected for this CPU.
+	 *
+	 * @return The kernel name.
+	 */
+	const char* GetPixelKernelName();
+
+	/**
+	 * Pixel kernel table structure.
+	 * This contains one implementation of the vectorized kernels, so the implementations can be compared against each
+	 * other. Use the functions above for everything else.
+	 */
+	struct PixelKernelTable final
+	{
+		using kernel_type = void(*)(uint8_t*, const uint8_t*, uint64_t);
+
+		kernel_type m_SwizzleRedBlue = nullptr;
+		kernel_type m_PremultiplyAlpha = nullptr;
+		const char* m_pName = nullptr;
+	};
+
+	/**
+	 * Get all the pixel kernel tables which this CPU supports.
+	 * The scalar kernels are always first.
+	 *
+	 * @return The kernel tables.
+	 */
+	std::vector<PixelKernelTable> GetSupportedPixelKernels();
+}
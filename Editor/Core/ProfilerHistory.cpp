@@ -0,0 +1,249 @@
+// Copyright (c) 2022 Dhiraj Wishal
+
+#include "ProfilerHistory.hpp"
+
+#include <algorithm>
+#include <iomanip>
+#include <utility>
+
+namespace
+{
+	/**
+	 * Get the microseconds between two time points.
+	 *
+	 * @param start The start time.
+	 * @param end The end time.
+	 * @return The microseconds.
+	 */
+	double GetMicroseconds(rapid::ProfilerHistory::clock_type::time_point start, rapid::ProfilerHistory::clock_type::time_point end)
+	{
+		return std::chrono::duration<double, std::micro>(end - start).count();
+	}
+
+	/**
+	 * Write a string as a JSON string, with the quotes and the special characters escaped.
+	 * Control characters are dropped.
+	 *
+	 * @param stream The stream to write to.
+	 * @param string The string to write.
+	 */
+	void WriteString(std::ostream& stream, std::string_view string)
+	{
+		stream << '"';
+		for (const auto character : string)
+		{
+			if (character == '"' || character == '\\')
+				stream << '\\' << character;
+
+			else if (static_cast<unsigned char>(character) >= 0x20)
+				stream << character;
+		}
+
+		stream << '"';
+	}
+
+	/**
+	 * Add an element to a ring.
+	 *
+	 * @param ring The ring.
+	 * @param next The index of the next element to be replaced. This is advanced.
+	 * @param capacity The ring's capacity.
+	 * @param element The element to add.
+	 */
+	template<class Type>
+	void AddToRing(std::vector<Type>& ring, uint32_t& next, uint32_t capacity, Type&& element)
+	{
+		if (ring.size() < capacity)
+			ring.emplace_back(std::move(element));
+
+		else
+			ring[next] = std::move(element);
+
+		next = (next + 1) % capacity;
+	}
+
+	/**
+	 * Get the elements of a ring, from the oldest to the newest.
+	 *
+	 * @param ring The ring.
+	 * @param next The index of the next element to be replaced.
+	 * @param capacity The ring's capacity.
+	 * @return The elements.
+	 */
+	template<class Type>
+	std::vector<Type> GetOrdered(const std::vector<Type>& ring, uint32_t next, uint32_t capacity)
+	{
+		// The ring starts from the beginning till it's full.
+		if (ring.size() < capacity)
+			next = 0;
+
+		std::vector<Type> elements;
+		elements.reserve(ring.size());
+		elements.insert(elements.end(), ring.begin() + next, ring.end());
+		elements.insert(elements.end(), ring.begin(), ring.begin() + next);
+		return elements;
+	}
+}
+
+namespace rapid
+{
+	ProfilerHistory::ProfilerHistory(uint32_t frameCount, uint32_t cpuScopeCount)
+		: m_FrameCount(std::max(frameCount, 1u)), m_CpuScopeCount(std::max(cpuScopeCount, 1u))
+	{
+	}
+
+	void ProfilerHistory::addFrame(FrameResult&& frame)
+	{
+		AddToRing(m_Frames, m_NextFrame, m_FrameCount, std::move(frame));
+	}
+
+	void ProfilerHistory::addCpuScope(const CpuScope& scope)
+	{
+		AddToRing(m_CpuScopes, m_NextCpuScope, m_CpuScopeCount, CpuScope(scope));
+	}
+
+	std::vector<ProfilerHistory::FrameResult> ProfilerHistory::getFrames() const
+	{
+		return GetOrdered(m_Frames, m_NextFrame, m_FrameCount);
+	}
+
+	std::vector<ProfilerHistory::CpuScope> ProfilerHistory::getCpuScopes() const
+	{
+		return GetOrdered(m_CpuScopes, m_NextCpuScope, m_CpuScopeCount);
+	}
+
+	void SetScopeTimes(std::vector<ProfilerHistory::ScopeResult>& scopes, const std::vector<uint64_t>& timestamps, double timestampPeriod)
+	{
+		if (scopes.empty() || timestamps.size() < scopes.size() * 2)
+			return;
+
+		// The first scope begins first, so the starts are relative to it.
+		const auto tickTime = timestampPeriod / 1000000.0;
+		const auto firstTimestamp = timestamps[0];
+		for (uint64_t i = 0; i < scopes.size(); i++)
+		{
+			const auto begin = timestamps[i * 2];
+			const auto end = timestamps[i * 2 + 1];
+
+			scopes[i].m_Start = static_cast<double>(begin - std::min(begin, firstTimestamp)) * tickTime;
+			scopes[i].m_Duration = static_cast<double>(end - std::min(begin, end)) * tickTime;
+		}
+	}
+
+	std::vector<ProfilerHistory::ScopeSummary> SummarizeScopes(const std::vector<ProfilerHistory::FrameResult>& frames)
+	{
+		std::vector<ProfilerHistory::ScopeSummary> summaries;
+		if (frames.empty())
+			return summaries;
+
+		summaries.reserve(frames.back().m_Scopes.size());
+		for (const auto& scope : frames.back().m_Scopes)
+		{
+			const auto itr = std::find_if(summaries.begin(), summaries.end(), [&scope](const ProfilerHistory::ScopeSummary& summary) { return summary.m_Depth == scope.m_Depth && summary.m_Name == scope.m_Name; });
+			if (itr == summaries.end())
+				summaries.emplace_back(ProfilerHistory::ScopeSummary{ .m_Name = scope.m_Name, .m_Depth = scope.m_Depth });
+		}
+
+		// The averages are summed up first, and divided once every frame is added.
+		for (const auto& frame : frames)
+		{
+			for (const auto& scope : frame.m_Scopes)
+			{
+				const auto itr = std::find_if(summaries.begin(), summaries.end(), [&scope](const ProfilerHistory::ScopeSummary& summary) { return summary.m_Depth == scope.m_Depth && summary.m_Name == scope.m_Name; });
+				if (itr == summaries.end())
+					continue;
+
+				itr->m_Average += scope.m_Duration;
+				itr->m_Max = std::max(itr->m_Max, scope.m_Duration);
+				itr->m_Count++;
+
+				if (scope.m_HasPipelineStatistics)
+				{
+					itr->m_PipelineStatistics = scope.m_PipelineStatistics;
+					itr->m_HasPipelineStatistics = true;
+				}
+			}
+		}
+
+		for (auto& summary : summaries)
+			summary.m_Average /= static_cast<double>(std::max(summary.m_Count, 1u));
+
+		return summaries;
+	}
+
+	void WriteProfilerTrace(std::ostream& stream, const std::vector<ProfilerHistory::FrameResult>& frames, const std::vector<ProfilerHistory::CpuScope>& cpuScopes, ProfilerHistory::clock_type::time_point startTime)
+	{
+		// The GPU gets the first thread, and the CPU threads are numbered in the order they show up.
+		std::vector<std::string_view> threads = { "GPU" };
+		const auto getThread = [&threads](std::string_view thread)
+		{
+			const auto itr = std::find(threads.begin(), threads.end(), thread);
+			if (itr != threads.end())
+				return static_cast<uint64_t>(itr - threads.begin());
+
+			threads.emplace_back(thread);
+			return static_cast<uint64_t>(threads.size() - 1);
+		};
+
+		// The times are in microseconds, which need to keep their fractions over a long session.
+		const auto flags = stream.flags();
+		const auto precision = stream.precision();
+		stream << std::fixed << std::setprecision(3);
+		stream << "{\"traceEvents\":[\n";
+
+		auto isFirst = true;
+		const auto beginEvent = [&stream, &isFirst]
+		{
+			if (!isFirst)
+				stream << ",\n";
+
+			isFirst = false;
+		};
+
+		for (const auto& scope : cpuScopes)
+		{
+			beginEvent();
+			stream << "{\"name\":";
+			WriteString(stream, scope.m_Name);
+			stream << ",\"cat\":\"CPU\",\"ph\":\"X\",\"pid\":0,\"tid\":" << getThread(scope.m_Thread);
+			stream << ",\"ts\":" << GetMicroseconds(startTime, scope.m_Start) << ",\"dur\":" << GetMicroseconds(scope.m_Start, scope.m_End) << "}";
+		}
+
+		for (const auto& frame : frames)
+		{
+			const auto submitTime = GetMicroseconds(startTime, frame.m_SubmitTime);
+			for (const auto& scope : frame.m_Scopes)
+			{
+				beginEvent();
+				stream << "{\"name\":";
+				WriteString(stream, scope.m_Name);
+				stream << ",\"cat\":\"GPU\",\"ph\":\"X\",\"pid\":0,\"tid\":0";
+				stream << ",\"ts\":" << submitTime + scope.m_Start * 1000.0 << ",\"dur\":" << scope.m_Duration * 1000.0;
+				stream << ",\"args\":{\"frame\":" << frame.m_FrameNumber;
+
+				if (scope.m_HasPipelineStatistics)
+				{
+					const auto& statistics = scope.m_PipelineStatistics;
+					stream << ",\"input vertices\":" << statistics.m_InputVertices << ",\"input primitives\":" << statistics.m_InputPrimitives;
+					stream << ",\"vertex shader invocations\":" << statistics.m_VertexShaderInvocations << ",\"clipping primitives\":" << statistics.m_ClippingPrimitives;
+					stream << ",\"fragment shader invocations\":" << statistics.m_FragmentShaderInvocations;
+				}
+
+				stream << "}}";
+			}
+		}
+
+		// Name the threads.
+		for (uint64_t i = 0; i < threads.size(); i++)
+		{
+			beginEvent();
+			stream << "{\"name\":\"thread_name\",\"ph\":\"M\",\"pid\":0,\"tid\":" << i << ",\"args\":{\"name\":";
+			WriteString(stream, threads[i]);
+			stream << "}}";
+		}
+
+		stream << "\n]}\n";
+		stream.flags(flags);
+		stream.precision(precision);
+	}
+}
\ No newline at end of file
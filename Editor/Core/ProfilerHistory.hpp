@@ -0,0 +1,165 @@
+// Copyright (c) 2022 Dhiraj Wishal
+
+#pragma once
+
+#include <chrono>
+#include <cstdint>
+#include <ostream>
+#include <string>
+#include <string_view>
+#include <vector>
+
+namespace rapid
+{
+	/**
+	 * Profiler history class.
+	 * This keeps the results of the recent profiled frames and the recent CPU scopes. Both are kept in rings, so the oldest
+	 * ones are replaced once they are full. This doesn't lock, the owner needs to if it's used from more than one thread.
+	 */
+	class ProfilerHistory final
+	{
+	public:
+		using clock_type = std::chrono::steady_clock;
+
+		/**
+		 * Pipeline statistics structure.
+		 */
+		struct PipelineStatistics final
+		{
+			uint64_t m_InputVertices = 0;
+			uint64_t m_InputPrimitives = 0;
+			uint64_t m_VertexShaderInvocations = 0;
+			uint64_t m_ClippingPrimitives = 0;
+			uint64_t m_FragmentShaderInvocations = 0;
+		};
+
+		/**
+		 * Scope result structure.
+		 * The times are in milliseconds. The start is relative to the frame's first scope.
+		 */
+		struct ScopeResult final
+		{
+			std::string m_Name;
+			PipelineStatistics m_PipelineStatistics = {};
+			double m_Start = 0.0;
+			double m_Duration = 0.0;
+			uint32_t m_Depth = 0;
+			bool m_HasPipelineStatistics = false;
+		};
+
+		/**
+		 * Frame result structure.
+		 */
+		struct FrameResult final
+		{
+			std::vector<ScopeResult> m_Scopes = {};
+			clock_type::time_point m_SubmitTime = {};
+			uint64_t m_FrameNumber = 0;
+		};
+
+		/**
+		 * CPU scope structure.
+		 */
+		struct CpuScope final
+		{
+			std::string_view m_Name;
+			std::string_view m_Thread;
+			clock_type::time_point m_Start = {};
+			clock_type::time_point m_End = {};
+		};
+
+		/**
+		 * Scope summary structure.
+		 * The times are in milliseconds.
+		 */
+		struct ScopeSummary final
+		{
+			std::string_view m_Name;
+			PipelineStatistics m_PipelineStatistics = {};	// The statistics of the latest frame which has them.
+			double m_Average = 0.0;
+			double m_Max = 0.0;
+			uint32_t m_Count = 0;
+			uint32_t m_Depth = 0;
+			bool m_HasPipelineStatistics = false;
+		};
+
+	public:
+		/**
+		 * Explicit constructor.
+		 *
+		 * @param frameCount The number of frames to keep. This is at least 1.
+		 * @param cpuScopeCount The number of CPU scopes to keep. This is at least 1.
+		 */
+		explicit ProfilerHistory(uint32_t frameCount, uint32_t cpuScopeCount);
+
+		/**
+		 * Add the results of a frame.
+		 *
+		 * @param frame The frame's results.
+		 */
+		void addFrame(FrameResult&& frame);
+
+		/**
+		 * Add a CPU scope.
+		 *
+		 * @param scope The scope. The names need to outlive the history.
+		 */
+		void addCpuScope(const CpuScope& scope);
+
+		/**
+		 * Get the frames.
+		 *
+		 * @return The frames, from the oldest to the newest.
+		 */
+		std::vector<FrameResult> getFrames() const;
+
+		/**
+		 * Get the CPU scopes.
+		 *
+		 * @return The CPU scopes, from the oldest to the newest.
+		 */
+		std::vector<CpuScope> getCpuScopes() const;
+
+	private:
+		std::vector<FrameResult> m_Frames = {};
+		std::vector<CpuScope> m_CpuScopes = {};
+
+		const uint32_t m_FrameCount = 0;
+		const uint32_t m_CpuScopeCount = 0;
+
+		uint32_t m_NextFrame = 0;
+		uint32_t m_NextCpuScope = 0;
+	};
+
+	/**
+	 * Set the times of a frame's scopes from their timestamps.
+	 * Scopes whose end timestamp is before their beginning get no duration.
+	 *
+	 * @param scopes The scopes.
+	 * @param timestamps The timestamps, two for each scope: the beginning and the end.
+	 * @param timestampPeriod The number of nanoseconds per timestamp tick.
+	 */
+	void SetScopeTimes(std::vector<ProfilerHistory::ScopeResult>& scopes, const std::vector<uint64_t>& timestamps, double timestampPeriod);
+
+	/**
+	 * Summarize the scopes of some frames.
+	 * The scopes are listed in the order of the latest frame, and the scopes with the same name and depth are combined.
+	 * Scopes which are not in the latest frame are left out.
+	 *
+	 * @param frames The frames, from the oldest to the newest. The summaries refer to their names.
+	 * @return The scope summaries.
+	 */
+	std::vector<ProfilerHistory::ScopeSummary> SummarizeScopes(const std::vector<ProfilerHistory::FrameResult>& frames);
+
+	/**
+	 * Write frames and CPU scopes as a trace.
+	 * The trace uses the trace event format, which can be opened in chrome://tracing or Perfetto. The GPU and CPU clocks
+	 * are not calibrated, so the GPU scopes are placed from the time their frame was submitted.
+	 *
+	 * @param stream The stream to write to.
+	 * @param frames The frames.
+	 * @param cpuScopes The CPU scopes.
+	 * @param startTime The time the trace starts from.
+	 */
+	void WriteProfilerTrace(std::ostream& stream, const std::vector<ProfilerHistory::FrameResult>& frames, const std::vector<ProfilerHistory::CpuScope>& cpuScopes, ProfilerHistory::clock_type::time_point startTime);
+}
\ No newline at end of file
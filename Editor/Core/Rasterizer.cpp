@@ -0,0 +1,768 @@
+// Copyright (c) 2022 Dhiraj Wishal
+
+#include "Rasterizer.hpp"
+
+#include "CpuFeatures.hpp"
+
+#include <algorithm>
+#include <cmath>
+
+#if defined(RAPID_ARCHITECTURE_X86)
+#include <immintrin.h>
+
+#elif defined(RAPID_ARCHITECTURE_NEON)
+#include <arm_neon.h>
+
+#endif
+
+namespace
+{
+	using rapid::RasterTriangle;
+	using rapid::RasterTexture;
+
+	/**
+	 * The number of interpolated attributes (u, v, red, green, blue, alpha).
+	 */
+	constexpr uint32_t AttributeCount = 6;
+
+	/**
+	 * The shifts of the color channels.
+	 */
+	constexpr int32_t RedShift = 0;
+	constexpr int32_t GreenShift = 8;
+	constexpr int32_t BlueShift = 16;
+	constexpr int32_t AlphaShift = 24;
+
+	/**
+	 * Get a color channel as a float.
+	 *
+	 * @param color The color.
+	 * @param shift The channel's shift.
+	 * @return The channel value, from 0 to 255.
+	 */
+	float GetChannel(uint32_t color, int32_t shift)
+	{
+		return static_cast<float>((color >> shift) & 0xFF);
+	}
+
+	/**
+	 * Convert a [0, 255] float to a color channel.
+	 *
+	 * @param value The value.
+	 * @param shift The channel's shift.
+	 * @return The channel, shifted into place.
+	 */
+	uint32_t ToChannel(float value, int32_t shift)
+	{
+		return static_cast<uint32_t>(std::clamp(value, 0.0f, 255.0f) + 0.5f) << shift;
+	}
+
+	/**
+	 * Get the nearest texel coordinate.
+	 * The coordinate is clamped before it's converted, like the vectorized kernels do.
+	 *
+	 * @param coordinate The normalized coordinate.
+	 * @param size The texture size along the coordinate.
+	 * @return The texel coordinate.
+	 */
+	uint32_t GetTexelCoordinate(float coordinate, uint32_t size)
+	{
+		return static_cast<uint32_t>(std::min(std::clamp(coordinate, 0.0f, 1.0f) * static_cast<float>(size), static_cast<float>(size - 1)));
+	}
+
+	/**
+	 * Shade and blend a single pixel.
+	 *
+	 * @param pixel The framebuffer pixel.
+	 * @param texture The texture.
+	 * @param attributes The interpolated attributes.
+	 */
+	void ShadePixel(uint32_t& pixel, const RasterTexture& texture, const float(&attributes)[AttributeCount])
+	{
+		const auto x = GetTexelCoordinate(attributes[0], texture.m_Width);
+		const auto y = GetTexelCoordinate(attributes[1], texture.m_Height);
+		const auto texel = texture.m_pPixels[static_cast<size_t>(y) * texture.m_Width + x];
+
+		constexpr auto normalize = 1.0f / 255.0f;
+		const auto alpha = std::clamp(attributes[5] * GetChannel(texel, AlphaShift) * normalize * normalize, 0.0f, 1.0f);
+		if (!(alpha > 0.0f))
+			return;
+
+		const auto inverseAlpha = 1.0f - alpha;
+		const auto destination = pixel;
+		pixel = ToChannel(attributes[2] * GetChannel(texel, RedShift) * normalize * alpha + GetChannel(destination, RedShift) * inverseAlpha, RedShift)
+			| ToChannel(attributes[3] * GetChannel(texel, GreenShift) * normalize * alpha + GetChannel(destination, GreenShift) * inverseAlpha, GreenShift)
+			| ToChannel(attributes[4] * GetChannel(texel, BlueShift) * normalize * alpha + GetChannel(destination, BlueShift) * inverseAlpha, BlueShift)
+			| ToChannel(255.0f * alpha + GetChannel(destination, AlphaShift) * inverseAlpha, AlphaShift);
+	}
+
+	/**
+	 * Check if an edge function value is inside the triangle.
+	 * Pixels exactly on an edge are only inside for top and left edges, so pixels on shared edges are drawn once.
+	 *
+	 * @param value The edge function value.
+	 * @param isTopLeft Whether or not the edge is a top or a left edge.
+	 * @return Whether or not the value is inside.
+	 */
+	bool IsInside(float value, bool isTopLeft)
+	{
+		return value > 0.0f || (value == 0.0f && isTopLeft);
+	}
+
+	/**
+	 * Scalar span kernel.
+	 * The row's part of each function is added last, like the vectorized kernels do, so the results are the same.
+	 */
+	void RasterizeSpanScalar(const RasterTriangle& triangle, const RasterTexture& texture, uint32_t* pRow, int32_t begin, int32_t end, int32_t y)
+	{
+		const auto rowY = static_cast<float>(y);
+
+		float edgeRow[3] = {};
+		for (uint32_t i = 0; i < 3; i++)
+			edgeRow[i] = triangle.m_EdgeB[i] * rowY + triangle.m_EdgeC[i];
+
+		float planeRow[AttributeCount] = {};
+		for (uint32_t i = 0; i < AttributeCount; i++)
+			planeRow[i] = triangle.m_PlaneB[i] * rowY + triangle.m_PlaneC[i];
+
+		for (int32_t x = begin; x < end; x++)
+		{
+			const auto pixelX = static_cast<float>(x);
+
+			bool isInside = true;
+			for (uint32_t i = 0; i < 3; i++)
+				isInside &= IsInside(triangle.m_EdgeA[i] * pixelX + edgeRow[i], triangle.m_IsTopLeft[i]);
+
+			if (!isInside)
+				continue;
+
+			float attributes[AttributeCount] = {};
+			for (uint32_t i = 0; i < AttributeCount; i++)
+				attributes[i] = triangle.m_PlaneA[i] * pixelX + planeRow[i];
+
+			ShadePixel(pRow[x], texture, attributes);
+		}
+	}
+
+#ifdef RAPID_ARCHITECTURE_X86
+	/**
+	 * Get a color channel of 4 pixels as floats.
+	 *
+	 * @param pixels The pixels.
+	 * @param shift The channel's shift.
+	 * @return The channel values, from 0 to 255.
+	 */
+	RAPID_TARGET("sse2") __m128 GetChannelsSSE2(__m128i pixels, int32_t shift)
+	{
+		return _mm_cvtepi32_ps(_mm_and_si128(_mm_srl_epi32(pixels, _mm_cvtsi32_si128(shift)), _mm_set1_epi32(0xFF)));
+	}
+
+	/**
+	 * Convert 4 [0, 255] floats to color channels.
+	 *
+	 * @param values The values.
+	 * @param shift The channel's shift.
+	 * @return The channels, shifted into place.
+	 */
+	RAPID_TARGET("sse2") __m128i ToChannelsSSE2(__m128 values, int32_t shift)
+	{
+		const auto clamped = _mm_min_ps(_mm_max_ps(values, _mm_setzero_ps()), _mm_set1_ps(255.0f));
+		return _mm_sll_epi32(_mm_cvttps_epi32(_mm_add_ps(clamped, _mm_set1_ps(0.5f))), _mm_cvtsi32_si128(shift));
+	}
+
+	/**
+	 * Get the nearest texel coordinates of 4 pixels.
+	 * The maximum comes first, so a NaN coordinate becomes 0.
+	 *
+	 * @param coordinates The normalized coordinates.
+	 * @param size The texture size along the coordinates.
+	 * @return The texel coordinates.
+	 */
+	RAPID_TARGET("sse2") __m128i GetTexelCoordinatesSSE2(__m128 coordinates, uint32_t size)
+	{
+		const auto clamped = _mm_min_ps(_mm_max_ps(coordinates, _mm_setzero_ps()), _mm_set1_ps(1.0f));
+		return _mm_cvttps_epi32(_mm_min_ps(_mm_mul_ps(clamped, _mm_set1_ps(static_cast<float>(size))), _mm_set1_ps(static_cast<float>(size - 1))));
+	}
+
+	/**
+	 * Blend a color channel of 4 pixels.
+	 *
+	 * @param color The interpolated vertex color channel.
+	 * @param texels The texels.
+	 * @param destination The framebuffer pixels.
+	 * @param alpha The source alpha.
+	 * @param inverseAlpha One minus the source alpha.
+	 * @param shift The channel's shift.
+	 * @return The blended channels, shifted into place.
+	 */
+	RAPID_TARGET("sse2") __m128i BlendChannelsSSE2(__m128 color, __m128i texels, __m128i destination, __m128 alpha, __m128 inverseAlpha, int32_t shift)
+	{
+		const auto source = _mm_mul_ps(_mm_mul_ps(_mm_mul_ps(color, GetChannelsSSE2(texels, shift)), _mm_set1_ps(1.0f / 255.0f)), alpha);
+		return ToChannelsSSE2(_mm_add_ps(source, _mm_mul_ps(GetChannelsSSE2(destination, shift), inverseAlpha)), shift);
+	}
+
+	/**
+	 * Shade and blend 4 pixels.
+	 * SSE2 has no gathers, so the texels are fetched one at a time, and everything else is done for all the lanes at once.
+	 *
+	 * @param pPixels The first framebuffer pixel.
+	 * @param texture The texture.
+	 * @param inside The lanes which are inside the triangle.
+	 * @param attributes The interpolated attributes.
+	 */
+	RAPID_TARGET("sse2") void ShadeLanesSSE2(uint32_t* pPixels, const RasterTexture& texture, __m128 inside, const __m128(&attributes)[AttributeCount])
+	{
+		const auto zero = _mm_setzero_ps();
+		const auto one = _mm_set1_ps(1.0f);
+		const auto normalize = _mm_set1_ps(1.0f / 255.0f);
+
+		alignas(16) int32_t texelX[4], texelY[4];
+		_mm_store_si128(reinterpret_cast<__m128i*>(texelX), GetTexelCoordinatesSSE2(attributes[0], texture.m_Width));
+		_mm_store_si128(reinterpret_cast<__m128i*>(texelY), GetTexelCoordinatesSSE2(attributes[1], texture.m_Height));
+
+		alignas(16) uint32_t texels[4];
+		for (uint32_t i = 0; i < 4; i++)
+			texels[i] = texture.m_pPixels[static_cast<size_t>(texelY[i]) * texture.m_Width + texelX[i]];
+
+		const auto texel = _mm_load_si128(reinterpret_cast<const __m128i*>(texels));
+		const auto alpha = _mm_min_ps(_mm_max_ps(_mm_mul_ps(_mm_mul_ps(_mm_mul_ps(attributes[5], GetChannelsSSE2(texel, AlphaShift)), normalize), normalize), zero), one);
+
+		// Transparent pixels don't change the framebuffer.
+		const auto coverage = static_cast<uint32_t>(_mm_movemask_ps(_mm_and_ps(inside, _mm_cmpgt_ps(alpha, zero))));
+		if (coverage == 0)
+			return;
+
+		// Only the covered pixels are read and written, as the others can belong to a tile on another thread.
+		alignas(16) uint32_t pixels[4] = {};
+		if (coverage == 0xF)
+			_mm_store_si128(reinterpret_cast<__m128i*>(pixels), _mm_loadu_si128(reinterpret_cast<const __m128i*>(pPixels)));
+
+		else
+		{
+			for (uint32_t i = 0; i < 4; i++)
+			{
+				if (coverage & (1 << i))
+					pixels[i] = pPixels[i];
+			}
+		}
+
+		const auto destination = _mm_load_si128(reinterpret_cast<const __m128i*>(pixels));
+		const auto inverseAlpha = _mm_sub_ps(one, alpha);
+
+		const auto red = BlendChannelsSSE2(attributes[2], texel, destination, alpha, inverseAlpha, RedShift);
+		const auto green = BlendChannelsSSE2(attributes[3], texel, destination, alpha, inverseAlpha, GreenShift);
+		const auto blue = BlendChannelsSSE2(attributes[4], texel, destination, alpha, inverseAlpha, BlueShift);
+		const auto resultAlpha = ToChannelsSSE2(_mm_add_ps(_mm_mul_ps(_mm_set1_ps(255.0f), alpha), _mm_mul_ps(GetChannelsSSE2(destination, AlphaShift), inverseAlpha)), AlphaShift);
+		const auto result = _mm_or_si128(_mm_or_si128(red, green), _mm_or_si128(blue, resultAlpha));
+
+		if (coverage == 0xF)
+		{
+			_mm_storeu_si128(reinterpret_cast<__m128i*>(pPixels), result);
+			return;
+		}
+
+		_mm_store_si128(reinterpret_cast<__m128i*>(pixels), result);
+		for (uint32_t i = 0; i < 4; i++)
+		{
+			if (coverage & (1 << i))
+				pPixels[i] = pixels[i];
+		}
+	}
+
+	/**
+	 * SSE2 span kernel.
+	 * This rasterizes 4 pixels per iteration.
+	 */
+	RAPID_TARGET("sse2") void RasterizeSpanSSE2(const RasterTriangle& triangle, const RasterTexture& texture, uint32_t* pRow, int32_t begin, int32_t end, int32_t y)
+	{
+		const auto rowY = static_cast<float>(y);
+		const auto zero = _mm_setzero_ps();
+		const auto lanes = _mm_setr_ps(0.0f, 1.0f, 2.0f, 3.0f);
+		const auto spanEnd = _mm_set1_ps(static_cast<float>(end));
+
+		__m128 edgeA[3], edgeRow[3], isTopLeft[3];
+		for (uint32_t i = 0; i < 3; i++)
+		{
+			edgeA[i] = _mm_set1_ps(triangle.m_EdgeA[i]);
+			edgeRow[i] = _mm_set1_ps(triangle.m_EdgeB[i] * rowY + triangle.m_EdgeC[i]);
+			isTopLeft[i] = _mm_castsi128_ps(_mm_set1_epi32(triangle.m_IsTopLeft[i] ? -1 : 0));
+		}
+
+		__m128 planeA[AttributeCount], planeRow[AttributeCount];
+		for (uint32_t i = 0; i < AttributeCount; i++)
+		{
+			planeA[i] = _mm_set1_ps(triangle.m_PlaneA[i]);
+			planeRow[i] = _mm_set1_ps(triangle.m_PlaneB[i] * rowY + triangle.m_PlaneC[i]);
+		}
+
+		for (int32_t x = begin; x < end; x += 4)
+		{
+			const auto pixelX = _mm_add_ps(_mm_set1_ps(static_cast<float>(x)), lanes);
+
+			auto inside = _mm_cmplt_ps(pixelX, spanEnd);
+			for (uint32_t i = 0; i < 3; i++)
+			{
+				const auto value = _mm_add_ps(_mm_mul_ps(edgeA[i], pixelX), edgeRow[i]);
+				inside = _mm_and_ps(inside, _mm_or_ps(_mm_cmpgt_ps(value, zero), _mm_and_ps(_mm_cmpeq_ps(value, zero), isTopLeft[i])));
+			}
+
+			if (_mm_movemask_ps(inside) == 0)
+				continue;
+
+			__m128 attributes[AttributeCount];
+			for (uint32_t i = 0; i < AttributeCount; i++)
+				attributes[i] = _mm_add_ps(_mm_mul_ps(planeA[i], pixelX), planeRow[i]);
+
+			ShadeLanesSSE2(pRow + x, texture, inside, attributes);
+		}
+	}
+
+	/**
+	 * Get a color channel of 8 pixels as floats.
+	 *
+	 * @param pixels The pixels.
+	 * @param shift The channel's shift.
+	 * @return The channel values, from 0 to 255.
+	 */
+	RAPID_TARGET("avx2") __m256 GetChannelsAVX2(__m256i pixels, int32_t shift)
+	{
+		return _mm256_cvtepi32_ps(_mm256_and_si256(_mm256_srl_epi32(pixels, _mm_cvtsi32_si128(shift)), _mm256_set1_epi32(0xFF)));
+	}
+
+	/**
+	 * Convert 8 [0, 255] floats to color channels.
+	 *
+	 * @param values The values.
+	 * @param shift The channel's shift.
+	 * @return The channels, shifted into place.
+	 */
+	RAPID_TARGET("avx2") __m256i ToChannelsAVX2(__m256 values, int32_t shift)
+	{
+		const auto clamped = _mm256_min_ps(_mm256_max_ps(values, _mm256_setzero_ps()), _mm256_set1_ps(255.0f));
+		return _mm256_sll_epi32(_mm256_cvttps_epi32(_mm256_add_ps(clamped, _mm256_set1_ps(0.5f))), _mm_cvtsi32_si128(shift));
+	}
+
+	/**
+	 * Get the nearest texel coordinates of 8 pixels.
+	 * The maximum comes first, so a NaN coordinate becomes 0.
+	 *
+	 * @param coordinates The normalized coordinates.
+	 * @param size The texture size along the coordinates.
+	 * @return The texel coordinates.
+	 */
+	RAPID_TARGET("avx2") __m256i GetTexelCoordinatesAVX2(__m256 coordinates, uint32_t size)
+	{
+		const auto clamped = _mm256_min_ps(_mm256_max_ps(coordinates, _mm256_setzero_ps()), _mm256_set1_ps(1.0f));
+		return _mm256_cvttps_epi32(_mm256_min_ps(_mm256_mul_ps(clamped, _mm256_set1_ps(static_cast<float>(size))), _mm256_set1_ps(static_cast<float>(size - 1))));
+	}
+
+	/**
+	 * Blend a color channel of 8 pixels.
+	 *
+	 * @param color The interpolated vertex color channel.
+	 * @param texels The texels.
+	 * @param destination The framebuffer pixels.
+	 * @param alpha The source alpha.
+	 * @param inverseAlpha One minus the source alpha.
+	 * @param shift The channel's shift.
+	 * @return The blended channels, shifted into place.
+	 */
+	RAPID_TARGET("avx2") __m256i BlendChannelsAVX2(__m256 color, __m256i texels, __m256i destination, __m256 alpha, __m256 inverseAlpha, int32_t shift)
+	{
+		const auto source = _mm256_mul_ps(_mm256_mul_ps(_mm256_mul_ps(color, GetChannelsAVX2(texels, shift)), _mm256_set1_ps(1.0f / 255.0f)), alpha);
+		return ToChannelsAVX2(_mm256_add_ps(source, _mm256_mul_ps(GetChannelsAVX2(destination, shift), inverseAlpha)), shift);
+	}
+
+	/**
+	 * Shade and blend 8 pixels.
+	 * The texels are fetched with a gather, and partially covered pixels are read and written with masked loads and stores.
+	 *
+	 * @param pPixels The first framebuffer pixel.
+	 * @param texture The texture.
+	 * @param inside The lanes which are inside the triangle.
+	 * @param attributes The interpolated attributes.
+	 */
+	RAPID_TARGET("avx2") void ShadeLanesAVX2(uint32_t* pPixels, const RasterTexture& texture, __m256 inside, const __m256(&attributes)[AttributeCount])
+	{
+		const auto zero = _mm256_setzero_ps();
+		const auto one = _mm256_set1_ps(1.0f);
+		const auto normalize = _mm256_set1_ps(1.0f / 255.0f);
+
+		const auto texelX = GetTexelCoordinatesAVX2(attributes[0], texture.m_Width);
+		const auto texelY = GetTexelCoordinatesAVX2(attributes[1], texture.m_Height);
+		const auto texelIndex = _mm256_add_epi32(_mm256_mullo_epi32(texelY, _mm256_set1_epi32(static_cast<int32_t>(texture.m_Width))), texelX);
+		const auto texel = _mm256_i32gather_epi32(reinterpret_cast<const int32_t*>(texture.m_pPixels), texelIndex, 4);
+
+		const auto alpha = _mm256_min_ps(_mm256_max_ps(_mm256_mul_ps(_mm256_mul_ps(_mm256_mul_ps(attributes[5], GetChannelsAVX2(texel, AlphaShift)), normalize), normalize), zero), one);
+
+		// Transparent pixels don't change the framebuffer.
+		const auto mask = _mm256_and_ps(inside, _mm256_cmp_ps(alpha, zero, _CMP_GT_OQ));
+		const auto coverage = static_cast<uint32_t>(_mm256_movemask_ps(mask));
+		if (coverage == 0)
+			return;
+
+		// Only the covered pixels are read and written, as the others can belong to a tile on another thread.
+		const auto isFullyCovered = coverage == 0xFF;
+		const auto pixelMask = _mm256_castps_si256(mask);
+		const auto destination = isFullyCovered
+			? _mm256_loadu_si256(reinterpret_cast<const __m256i*>(pPixels))
+			: _mm256_maskload_epi32(reinterpret_cast<const int32_t*>(pPixels), pixelMask);
+
+		const auto inverseAlpha = _mm256_sub_ps(one, alpha);
+
+		const auto red = BlendChannelsAVX2(attributes[2], texel, destination, alpha, inverseAlpha, RedShift);
+		const auto green = BlendChannelsAVX2(attributes[3], texel, destination, alpha, inverseAlpha, GreenShift);
+		const auto blue = BlendChannelsAVX2(attributes[4], texel, destination, alpha, inverseAlpha, BlueShift);
+		const auto resultAlpha = ToChannelsAVX2(_mm256_add_ps(_mm256_mul_ps(_mm256_set1_ps(255.0f), alpha), _mm256_mul_ps(GetChannelsAVX2(destination, AlphaShift), inverseAlpha)), AlphaShift);
+		const auto result = _mm256_or_si256(_mm256_or_si256(red, green), _mm256_or_si256(blue, resultAlpha));
+
+		if (isFullyCovered)
+			_mm256_storeu_si256(reinterpret_cast<__m256i*>(pPixels), result);
+
+		else
+			_mm256_maskstore_epi32(reinterpret_cast<int32_t*>(pPixels), pixelMask, result);
+	}
+
+	/**
+	 * AVX2 span kernel.
+	 * This is the same as the SSE2 kernel, but rasterizes 8 pixels per iteration.
+	 */
+	RAPID_TARGET("avx2") void RasterizeSpanAVX2(const RasterTriangle& triangle, const RasterTexture& texture, uint32_t* pRow, int32_t begin, int32_t end, int32_t y)
+	{
+		const auto rowY = static_cast<float>(y);
+		const auto zero = _mm256_setzero_ps();
+		const auto lanes = _mm256_setr_ps(0.0f, 1.0f, 2.0f, 3.0f, 4.0f, 5.0f, 6.0f, 7.0f);
+		const auto spanEnd = _mm256_set1_ps(static_cast<float>(end));
+
+		__m256 edgeA[3], edgeRow[3], isTopLeft[3];
+		for (uint32_t i = 0; i < 3; i++)
+		{
+			edgeA[i] = _mm256_set1_ps(triangle.m_EdgeA[i]);
+			edgeRow[i] = _mm256_set1_ps(triangle.m_EdgeB[i] * rowY + triangle.m_EdgeC[i]);
+			isTopLeft[i] = _mm256_castsi256_ps(_mm256_set1_epi32(triangle.m_IsTopLeft[i] ? -1 : 0));
+		}
+
+		__m256 planeA[AttributeCount], planeRow[AttributeCount];
+		for (uint32_t i = 0; i < AttributeCount; i++)
+		{
+			planeA[i] = _mm256_set1_ps(triangle.m_PlaneA[i]);
+			planeRow[i] = _mm256_set1_ps(triangle.m_PlaneB[i] * rowY + triangle.m_PlaneC[i]);
+		}
+
+		for (int32_t x = begin; x < end; x += 8)
+		{
+			const auto pixelX = _mm256_add_ps(_mm256_set1_ps(static_cast<float>(x)), lanes);
+
+			auto inside = _mm256_cmp_ps(pixelX, spanEnd, _CMP_LT_OQ);
+			for (uint32_t i = 0; i < 3; i++)
+			{
+				const auto value = _mm256_add_ps(_mm256_mul_ps(edgeA[i], pixelX), edgeRow[i]);
+				inside = _mm256_and_ps(inside, _mm256_or_ps(_mm256_cmp_ps(value, zero, _CMP_GT_OQ), _mm256_and_ps(_mm256_cmp_ps(value, zero, _CMP_EQ_OQ), isTopLeft[i])));
+			}
+
+			if (_mm256_movemask_ps(inside) == 0)
+				continue;
+
+			__m256 attributes[AttributeCount];
+			for (uint32_t i = 0; i < AttributeCount; i++)
+				attributes[i] = _mm256_add_ps(_mm256_mul_ps(planeA[i], pixelX), planeRow[i]);
+
+			ShadeLanesAVX2(pRow + x, texture, inside, attributes);
+		}
+
+		_mm256_zeroupper();
+	}
+
+#endif
+
+#ifdef RAPID_ARCHITECTURE_NEON
+	/**
+	 * Get a color channel of 4 pixels as floats.
+	 *
+	 * @param pixels The pixels.
+	 * @param shift The channel's shift.
+	 * @return The channel values, from 0 to 255.
+	 */
+	float32x4_t GetChannelsNEON(uint32x4_t pixels, int32_t shift)
+	{
+		return vcvtq_f32_u32(vandq_u32(vshlq_u32(pixels, vdupq_n_s32(-shift)), vdupq_n_u32(0xFF)));
+	}
+
+	/**
+	 * Convert 4 [0, 255] floats to color channels.
+	 *
+	 * @param values The values.
+	 * @param shift The channel's shift.
+	 * @return The channels, shifted into place.
+	 */
+	uint32x4_t ToChannelsNEON(float32x4_t values, int32_t shift)
+	{
+		const auto clamped = vminq_f32(vmaxq_f32(values, vdupq_n_f32(0.0f)), vdupq_n_f32(255.0f));
+		return vshlq_u32(vcvtq_u32_f32(vaddq_f32(clamped, vdupq_n_f32(0.5f))), vdupq_n_s32(shift));
+	}
+
+	/**
+	 * Get the nearest texel coordinates of 4 pixels.
+	 *
+	 * @param coordinates The normalized coordinates.
+	 * @param size The texture size along the coordinates.
+	 * @return The texel coordinates.
+	 */
+	uint32x4_t GetTexelCoordinatesNEON(float32x4_t coordinates, uint32_t size)
+	{
+		const auto clamped = vminq_f32(vmaxq_f32(coordinates, vdupq_n_f32(0.0f)), vdupq_n_f32(1.0f));
+		return vcvtq_u32_f32(vminq_f32(vmulq_f32(clamped, vdupq_n_f32(static_cast<float>(size))), vdupq_n_f32(static_cast<float>(size - 1))));
+	}
+
+	/**
+	 * Get the coverage bit mask of a lane mask.
+	 *
+	 * @param mask The lane mask.
+	 * @return The coverage bit mask. Bit i is set if lane i is set.
+	 */
+	uint32_t GetCoverageNEON(uint32x4_t mask)
+	{
+		const uint32_t laneBitValues[4] = { 1, 2, 4, 8 };
+		const auto bits = vandq_u32(mask, vld1q_u32(laneBitValues));
+		const auto pairs = vpadd_u32(vget_low_u32(bits), vget_high_u32(bits));
+		return vget_lane_u32(vpadd_u32(pairs, pairs), 0);
+	}
+
+	/**
+	 * Blend a color channel of 4 pixels.
+	 *
+	 * @param color The interpolated vertex color channel.
+	 * @param texels The texels.
+	 * @param destination The framebuffer pixels.
+	 * @param alpha The source alpha.
+	 * @param inverseAlpha One minus the source alpha.
+	 * @param shift The channel's shift.
+	 * @return The blended channels, shifted into place.
+	 */
+	uint32x4_t BlendChannelsNEON(float32x4_t color, uint32x4_t texels, uint32x4_t destination, float32x4_t alpha, float32x4_t inverseAlpha, int32_t shift)
+	{
+		const auto source = vmulq_f32(vmulq_f32(vmulq_f32(color, GetChannelsNEON(texels, shift)), vdupq_n_f32(1.0f / 255.0f)), alpha);
+		return ToChannelsNEON(vaddq_f32(source, vmulq_f32(GetChannelsNEON(destination, shift), inverseAlpha)), shift);
+	}
+
+	/**
+	 * Shade and blend 4 pixels.
+	 * NEON has no gathers, so the texels are fetched one at a time, and everything else is done for all the lanes at once.
+	 *
+	 * @param pPixels The first framebuffer pixel.
+	 * @param texture The texture.
+	 * @param inside The lanes which are inside the triangle.
+	 * @param attributes The interpolated attributes.
+	 */
+	void ShadeLanesNEON(uint32_t* pPixels, const RasterTexture& texture, uint32x4_t inside, const float32x4_t(&attributes)[AttributeCount])
+	{
+		const auto zero = vdupq_n_f32(0.0f);
+		const auto one = vdupq_n_f32(1.0f);
+		const auto normalize = vdupq_n_f32(1.0f / 255.0f);
+
+		uint32_t texelX[4], texelY[4];
+		vst1q_u32(texelX, GetTexelCoordinatesNEON(attributes[0], texture.m_Width));
+		vst1q_u32(texelY, GetTexelCoordinatesNEON(attributes[1], texture.m_Height));
+
+		uint32_t texels[4];
+		for (uint32_t i = 0; i < 4; i++)
+			texels[i] = texture.m_pPixels[static_cast<size_t>(texelY[i]) * texture.m_Width + texelX[i]];
+
+		const auto texel = vld1q_u32(texels);
+		const auto alpha = vminq_f32(vmaxq_f32(vmulq_f32(vmulq_f32(vmulq_f32(attributes[5], GetChannelsNEON(texel, AlphaShift)), normalize), normalize), zero), one);
+
+		// Transparent pixels don't change the framebuffer.
+		const auto coverage = GetCoverageNEON(vandq_u32(inside, vcgtq_f32(alpha, zero)));
+		if (coverage == 0)
+			return;
+
+		// Only the covered pixels are read and written, as the others can belong to a tile on another thread.
+		uint32_t pixels[4] = {};
+		for (uint32_t i = 0; i < 4; i++)
+		{
+			if (coverage & (1 << i))
+				pixels[i] = pPixels[i];
+		}
+
+		const auto destination = vld1q_u32(pixels);
+		const auto inverseAlpha = vsubq_f32(one, alpha);
+
+		const auto red = BlendChannelsNEON(attributes[2], texel, destination, alpha, inverseAlpha, RedShift);
+		const auto green = BlendChannelsNEON(attributes[3], texel, destination, alpha, inverseAlpha, GreenShift);
+		const auto blue = BlendChannelsNEON(attributes[4], texel, destination, alpha, inverseAlpha, BlueShift);
+		const auto resultAlpha = ToChannelsNEON(vaddq_f32(vmulq_f32(vdupq_n_f32(255.0f), alpha), vmulq_f32(GetChannelsNEON(destination, AlphaShift), inverseAlpha)), AlphaShift);
+		vst1q_u32(pixels, vorrq_u32(vorrq_u32(red, green), vorrq_u32(blue, resultAlpha)));
+
+		for (uint32_t i = 0; i < 4; i++)
+		{
+			if (coverage & (1 << i))
+				pPixels[i] = pixels[i];
+		}
+	}
+
+	/**
+	 * NEON span kernel.
+	 * This rasterizes 4 pixels per iteration, like the SSE2 kernel.
+	 */
+	void RasterizeSpanNEON(const RasterTriangle& triangle, const RasterTexture& texture, uint32_t* pRow, int32_t begin, int32_t end, int32_t y)
+	{
+		const auto rowY = static_cast<float>(y);
+		const auto zero = vdupq_n_f32(0.0f);
+		const float laneOffsets[4] = { 0.0f, 1.0f, 2.0f, 3.0f };
+		const auto lanes = vld1q_f32(laneOffsets);
+		const auto spanEnd = vdupq_n_f32(static_cast<float>(end));
+
+		float32x4_t edgeA[3], edgeRow[3];
+		uint32x4_t isTopLeft[3];
+		for (uint32_t i = 0; i < 3; i++)
+		{
+			edgeA[i] = vdupq_n_f32(triangle.m_EdgeA[i]);
+			edgeRow[i] = vdupq_n_f32(triangle.m_EdgeB[i] * rowY + triangle.m_EdgeC[i]);
+			isTopLeft[i] = vdupq_n_u32(triangle.m_IsTopLeft[i] ? 0xFFFFFFFF : 0);
+		}
+
+		float32x4_t planeA[AttributeCount], planeRow[AttributeCount];
+		for (uint32_t i = 0; i < AttributeCount; i++)
+		{
+			planeA[i] = vdupq_n_f32(triangle.m_PlaneA[i]);
+			planeRow[i] = vdupq_n_f32(triangle.m_PlaneB[i] * rowY + triangle.m_PlaneC[i]);
+		}
+
+		for (int32_t x = begin; x < end; x += 4)
+		{
+			const auto pixelX = vaddq_f32(vdupq_n_f32(static_cast<float>(x)), lanes);
+
+			// The multiplies and adds are kept separate, as a fused multiply-add would round differently from the scalar kernel.
+			auto inside = vcltq_f32(pixelX, spanEnd);
+			for (uint32_t i = 0; i < 3; i++)
+			{
+				const auto value = vaddq_f32(vmulq_f32(edgeA[i], pixelX), edgeRow[i]);
+				inside = vandq_u32(inside, vorrq_u32(vcgtq_f32(value, zero), vandq_u32(vceqq_f32(value, zero), isTopLeft[i])));
+			}
+
+			if (GetCoverageNEON(inside) == 0)
+				continue;
+
+			float32x4_t attributes[AttributeCount];
+			for (uint32_t i = 0; i < AttributeCount; i++)
+				attributes[i] = vaddq_f32(vmulq_f32(planeA[i], pixelX), planeRow[i]);
+
+			ShadeLanesNEON(pRow + x, texture, inside, attributes);
+		}
+	}
+
+#endif
+}
+
+namespace rapid
+{
+	bool SetupRasterTriangle(RasterTriangle& triangle, const RasterVertex(&vertices)[3])
+	{
+		const RasterVertex* pVertices[3] = { &vertices[0], &vertices[1], &vertices[2] };
+
+		// The triangles are made counter clockwise (in a y up space), so the edge functions are positive inside them.
+		auto area = (pVertices[1]->m_X - pVertices[0]->m_X) * (pVertices[2]->m_Y - pVertices[0]->m_Y) - (pVertices[1]->m_Y - pVertices[0]->m_Y) * (pVertices[2]->m_X - pVertices[0]->m_X);
+		if (area < 0.0f)
+		{
+			std::swap(pVertices[1], pVertices[2]);
+			area = -area;
+		}
+
+		if (!(area > 0.0f))
+			return false;
+
+		float x[3] = {}, y[3] = {};
+		for (uint32_t i = 0; i < 3; i++)
+		{
+			x[i] = pVertices[i]->m_X;
+			y[i] = pVertices[i]->m_Y;
+		}
+
+		// The vertices can be far outside the framebuffer, so they're clamped before being converted.
+		const auto clampX = [&triangle](float value) { return static_cast<int32_t>(std::clamp(value, static_cast<float>(triangle.m_MinX), static_cast<float>(triangle.m_MaxX))); };
+		const auto clampY = [&triangle](float value) { return static_cast<int32_t>(std::clamp(value, static_cast<float>(triangle.m_MinY), static_cast<float>(triangle.m_MaxY))); };
+
+		const auto minX = clampX(std::floor(std::min({ x[0], x[1], x[2] })));
+		const auto minY = clampY(std::floor(std::min({ y[0], y[1], y[2] })));
+		const auto maxX = clampX(std::ceil(std::max({ x[0], x[1], x[2] })));
+		const auto maxY = clampY(std::ceil(std::max({ y[0], y[1], y[2] })));
+
+		triangle.m_MinX = minX;
+		triangle.m_MinY = minY;
+		triangle.m_MaxX = maxX;
+		triangle.m_MaxY = maxY;
+
+		if (triangle.m_MinX >= triangle.m_MaxX || triangle.m_MinY >= triangle.m_MaxY)
+			return false;
+
+		// Edge i is the one opposite to vertex i. The half pixel offset is baked in, so the functions can be evaluated at
+		// the integer pixel coordinates.
+		for (uint32_t i = 0; i < 3; i++)
+		{
+			const auto j = (i + 1) % 3, k = (i + 2) % 3;
+			const auto a = y[j] - y[k];
+			const auto b = x[k] - x[j];
+
+			triangle.m_EdgeA[i] = a;
+			triangle.m_EdgeB[i] = b;
+			triangle.m_EdgeC[i] = x[j] * y[k] - x[k] * y[j] + 0.5f * (a + b);
+			triangle.m_IsTopLeft[i] = a > 0.0f || (a == 0.0f && b > 0.0f);
+		}
+
+		// The attributes are interpolated using the barycentric coordinates, which are the edge functions divided by the area.
+		float attributes[3][AttributeCount] = {};
+		for (uint32_t i = 0; i < 3; i++)
+		{
+			const auto& vertex = *pVertices[i];
+			attributes[i][0] = vertex.m_U;
+			attributes[i][1] = vertex.m_V;
+			attributes[i][2] = GetChannel(vertex.m_Color, RedShift);
+			attributes[i][3] = GetChannel(vertex.m_Color, GreenShift);
+			attributes[i][4] = GetChannel(vertex.m_Color, BlueShift);
+			attributes[i][5] = GetChannel(vertex.m_Color, AlphaShift);
+		}
+
+		const auto inverseArea = 1.0f / area;
+		for (uint32_t attribute = 0; attribute < AttributeCount; attribute++)
+		{
+			float a = 0.0f, b = 0.0f, c = 0.0f;
+			for (uint32_t i = 0; i < 3; i++)
+			{
+				a += triangle.m_EdgeA[i] * attributes[i][attribute];
+				b += triangle.m_EdgeB[i] * attributes[i][attribute];
+				c += triangle.m_EdgeC[i] * attributes[i][attribute];
+			}
+
+			triangle.m_PlaneA[attribute] = a * inverseArea;
+			triangle.m_PlaneB[attribute] = b * inverseArea;
+			triangle.m_PlaneC[attribute] = c * inverseArea;
+		}
+
+		return true;
+	}
+
+	const SpanKernel& GetSpanKernel()
+	{
+		// The supported kernels are ordered from the slowest to the fastest.
+		static const auto kernel = GetSupportedSpanKernels().back();
+		return kernel;
+	}
+
+	std::vector<SpanKernel> GetSupportedSpanKernels()
+	{
+		std::vector<SpanKernel> kernels = { { RasterizeSpanScalar, "Scalar" } };
+
+#if defined(RAPID_ARCHITECTURE_X86)
+		kernels.emplace_back(SpanKernel{ RasterizeSpanSSE2, "SSE2" });
+
+		if (IsAVX2Supported())
+			kernels.emplace_back(SpanKernel{ RasterizeSpanAVX2, "AVX2" });
+
+#elif defined(RAPID_ARCHITECTURE_NEON)
+		kernels.emplace_back(SpanKernel{ RasterizeSpanNEON, "NEON" });
+
+#endif
+
+		return kernels;
+	}
+}
\ No newline at end of file
@@ -0,0 +1,103 @@
+// Copyright (c) 2022 Dhiraj Wishal
+
+#pragma once
+
+#include <cstdint>
+#include <vector>
+
+namespace rapid
+{
+	/**
+	 * Raster vertex structure.
+	 * The position is in framebuffer space. The color is RGBA8 with red in the lowest byte, like ImGui's colors.
+	 */
+	struct RasterVertex final
+	{
+		float m_X = 0.0f;
+		float m_Y = 0.0f;
+		float m_U = 0.0f;
+		float m_V = 0.0f;
+		uint32_t m_Color = 0;
+	};
+
+	/**
+	 * Raster triangle structure.
+	 * The edge functions and the attribute planes are in framebuffer space, and are evaluated at the pixel centers.
+	 */
+	struct RasterTriangle final
+	{
+		// The edge functions (a * x + b * y + c), and whether an edge is a top or a left edge.
+		float m_EdgeA[3] = {};
+		float m_EdgeB[3] = {};
+		float m_EdgeC[3] = {};
+		bool m_IsTopLeft[3] = {};
+
+		// The attribute planes (u, v, red, green, blue, alpha), in the same form as the edge functions.
+		float m_PlaneA[6] = {};
+		float m_PlaneB[6] = {};
+		float m_PlaneC[6] = {};
+
+		// The bounds, clipped to the scissor and the framebuffer.
+		int32_t m_MinX = 0;
+		int32_t m_MinY = 0;
+		int32_t m_MaxX = 0;
+		int32_t m_MaxY = 0;
+
+		uint32_t m_TextureIndex = 0;
+	};
+
+	/**
+	 * Raster texture structure.
+	 * The pixels are RGBA8, in the same layout as the vertex colors.
+	 */
+	struct RasterTexture final
+	{
+		const uint32_t* m_pPixels = nullptr;
+		uint32_t m_Width = 0;
+		uint32_t m_Height = 0;
+	};
+
+	/**
+	 * Set up a triangle.
+	 * The bounds need to be set to the scissor before calling this, and are shrunk to the triangle's bounds.
+	 *
+	 * @param triangle The triangle to set up.
+	 * @param vertices The vertices.
+	 * @return Whether or not the triangle covers any pixels. Degenerate triangles and triangles outside their bounds don't.
+	 */
+	bool SetupRasterTriangle(RasterTriangle& triangle, const RasterVertex(&vertices)[3]);
+
+	/**
+	 * Span kernel structure.
+	 * A span kernel rasterizes a triangle in a span of a single row. Textures are sampled using the nearest texel, and the
+	 * pixels are blended using source alpha, one minus source alpha for the colors, and one, one minus source alpha for the
+	 * alpha, like the Vulkan pipeline.
+	 *
+	 * The vectorized kernels test the edges, interpolate the attributes, sample the texture and blend 8 (AVX2) or 4 (SSE2
+	 * or NEON) pixels at a time, and give the same results as the scalar kernel. Only the pixels within the span are read
+	 * or written, so spans of different tiles can be rasterized at the same time.
+	 */
+	struct SpanKernel final
+	{
+		using kernel_type = void(*)(const RasterTriangle&, const RasterTexture&, uint32_t*, int32_t, int32_t, int32_t);
+
+		kernel_type m_Function = nullptr;
+		const char* m_pName = nullptr;
+	};
+
+	/**
+	 * Get the best span kernel for the current CPU.
+	 * The selection is done only once.
+	 *
+	 * @return The span kernel.
+	 */
+	const SpanKernel& GetSpanKernel();
+
+	/**
+	 * Get all the span kernels which this CPU supports.
+	 * The scalar kernel is always first.
+	 *
+	 * @return The span kernels.
+	 */
+	std::vector<SpanKernel> GetSupportedSpanKernels();
+}
\ No newline at end of file
@@ -0,0 +1,112 @@
+// Copyright (c) 2022 Dhiraj Wishal
+
+#include "SkylinePacker.hpp"
+
+#include <algorithm>
+#include <limits>
+
+namespace rapid
+{
+	SkylinePacker::SkylinePacker(uint32_t width, uint32_t height)
+		: m_Width(width), m_Height(height)
+	{
+		clear();
+	}
+
+	bool SkylinePacker::pack(uint32_t width, uint32_t height, PackedRect& rect)
+	{
+		if (width == 0 || height == 0)
+			return false;
+
+		// Find the segment which keeps the skyline the lowest. Ties go to the narrower segment, to leave wide gaps open.
+		auto bestTop = std::numeric_limits<uint32_t>::max();
+		auto bestWidth = std::numeric_limits<uint32_t>::max();
+		auto bestIndex = m_Skyline.size();
+		uint32_t bestY = 0;
+
+		for (uint64_t i = 0; i < m_Skyline.size(); i++)
+		{
+			uint32_t y = 0;
+			if (!fit(i, width, height, y))
+				continue;
+
+			const auto top = y + height;
+			if (top < bestTop || (top == bestTop && m_Skyline[i].m_Width < bestWidth))
+			{
+				bestTop = top;
+				bestWidth = m_Skyline[i].m_Width;
+				bestIndex = i;
+				bestY = y;
+			}
+		}
+
+		if (bestIndex == m_Skyline.size())
+			return false;
+
+		rect = PackedRect{ m_Skyline[bestIndex].m_X, bestY, width, height };
+
+		// Add the new segment and shrink or remove the ones it covers.
+		m_Skyline.insert(m_Skyline.begin() + bestIndex, Segment{ rect.m_X, bestTop, width });
+
+		const auto right = rect.m_X + width;
+		auto index = bestIndex + 1;
+		while (index < m_Skyline.size() && m_Skyline[index].m_X < right)
+		{
+			auto& segment = m_Skyline[index];
+			const auto segmentRight = segment.m_X + segment.m_Width;
+
+			if (segmentRight <= right)
+			{
+				m_Skyline.erase(m_Skyline.begin() + index);
+				continue;
+			}
+
+			segment.m_Width = segmentRight - right;
+			segment.m_X = right;
+			break;
+		}
+
+		// Merge the neighboring segments which are at the same height.
+		for (uint64_t i = 0; i + 1 < m_Skyline.size();)
+		{
+			if (m_Skyline[i].m_Y == m_Skyline[i + 1].m_Y)
+			{
+				m_Skyline[i].m_Width += m_Skyline[i + 1].m_Width;
+				m_Skyline.erase(m_Skyline.begin() + i + 1);
+			}
+			else
+				i++;
+		}
+
+		m_UsedArea += static_cast<uint64_t>(width) * height;
+		return true;
+	}
+
+	void SkylinePacker::clear()
+	{
+		m_Skyline.clear();
+		m_Skyline.emplace_back(Segment{ 0, 0, m_Width });
+		m_UsedArea = 0;
+	}
+
+	bool SkylinePacker::fit(uint64_t index, uint32_t width, uint32_t height, uint32_t& y) const
+	{
+		if (m_Skyline[index].m_X + width > m_Width)
+			return false;
+
+		// The rectangle rests on the highest segment below it.
+		auto remainingWidth = static_cast<int64_t>(width);
+		y = 0;
+
+		for (; remainingWidth > 0; index++)
+		{
+			y = std::max(y, m_Skyline[index].m_Y);
+			if (y + height > m_Height)
+				return false;
+
+			remainingWidth -= m_Skyline[index].m_Width;
+		}
+
+		return true;
+	}
+}
@@ -0,0 +1,106 @@
+// Copyright (c) 2022 Dhiraj Wishal
+
+#pragma once
+
+#include <cstdint>
+#include <vector>
+
+namespace rapid
+{
+	/**
+	 * Packed rectangle structure.
+	 */
+	struct PackedRect final
+	{
+		uint32_t m_X = 0;
+		uint32_t m_Y = 0;
+		uint32_t m_Width = 0;
+		uint32_t m_Height = 0;
+	};
+
+	/**
+	 * Skyline packer class.
+	 * This packs rectangles into a fixed size area by keeping track of the top edge (the skyline) of the rectangles packed
+	 * so far, and placing each new rectangle where it raises the skyline the least (bottom-left rule).
+	 *
+	 * Packing is incremental, but rectangles cannot be removed individually. To reclaim space, clear the packer and pack
+	 * the remaining rectangles again.
+	 */
+	class SkylinePacker final
+	{
+	public:
+		/**
+		 * Explicit constructor.
+		 *
+		 * @param width The width of the area.
+		 * @param height The height of the area.
+		 */
+		explicit SkylinePacker(uint32_t width, uint32_t height);
+
+		/**
+		 * Pack a rectangle.
+		 *
+		 * @param width The width of the rectangle.
+		 * @param height The height of the rectangle.
+		 * @param rect The packed rectangle. This is only set if the rectangle fits.
+		 * @return Whether or not the rectangle fits.
+		 */
+		bool pack(uint32_t width, uint32_t height, PackedRect& rect);
+
+		/**
+		 * Remove all the packed rectangles.
+		 */
+		void clear();
+
+		/**
+		 * Get the width of the area.
+		 *
+		 * @return The width.
+		 */
+		uint32_t width() const { return m_Width; }
+
+		/**
+		 * Get the height of the area.
+		 *
+		 * @return The height.
+		 */
+		uint32_t height() const { return m_Height; }
+
+		/**
+		 * Get the area covered by the packed rectangles.
+		 *
+		 * @return The used area.
+		 */
+		uint64_t usedArea() const { return m_UsedArea; }
+
+	private:
+		/**
+		 * Skyline segment structure.
+		 */
+		struct Segment final
+		{
+			uint32_t m_X = 0;
+			uint32_t m_Y = 0;
+			uint32_t m_Width = 0;
+		};
+
+		/**
+		 * Find the height at which a rectangle fits when placed at a segment.
+		 *
+		 * @param index The index of the segment to place the rectangle's left edge at.
+		 * @param width The width of the rectangle.
+		 * @param height The height of the rectangle.
+		 * @param y The height of the rectangle's bottom edge. This is only set if the rectangle fits.
+		 * @return Whether or not the rectangle fits.
+		 */
+		bool fit(uint64_t index, uint32_t width, uint32_t height, uint32_t& y) const;
+
+	private:
+		std::vector<Segment> m_Skyline = {};
+
+		uint64_t m_UsedArea = 0;
+
+		const uint32_t m_Width;
+		const uint32_t m_Height;
+	};
+}
@@ -0,0 +1,195 @@
+// Copyright (c) 2022 Dhiraj Wishal
+
+#include "StreamingCopy.hpp"
+
+#include "CpuFeatures.hpp"
+
+#include <cstring>
+#include <utility>
+
+#if defined(RAPID_ARCHITECTURE_X86)
+#include <immintrin.h>
+
+#elif defined(RAPID_ARCHITECTURE_NEON)
+#include <arm_neon.h>
+
+#endif
+
+namespace
+{
+	/**
+	 * Copies smaller than this are not worth streaming, so they're passed to memcpy.
+	 */
+	constexpr uint64_t StreamingThreshold = 256;
+
+	using kernel_type = void(*)(uint8_t*, const uint8_t*, uint64_t);
+
+	/**
+	 * Copy the bytes until the destination is aligned to the required boundary.
+	 *
+	 * @param pDestination The destination pointer. This will be moved forward.
+	 * @param pSource The source pointer. This will be moved forward.
+	 * @param size The size. This will be reduced by the number of bytes copied.
+	 * @param alignment The required alignment.
+	 */
+	void AlignDestination(uint8_t*& pDestination, const uint8_t*& pSource, uint64_t& size, uint64_t alignment)
+	{
+		const auto misalignment = reinterpret_cast<uintptr_t>(pDestination) & (alignment - 1);
+		if (misalignment == 0)
+			return;
+
+		const auto head = alignment - misalignment;
+		std::memcpy(pDestination, pSource, head);
+
+		pDestination += head;
+		pSource += head;
+		size -= head;
+	}
+
+	/**
+	 * Fallback kernel.
+	 */
+	void CopyScalar(uint8_t* pDestination, const uint8_t* pSource, uint64_t size)
+	{
+		std::memcpy(pDestination, pSource, size);
+	}
+
+#ifdef RAPID_ARCHITECTURE_X86
+	/**
+	 * SSE2 kernel.
+	 * This copies 64 bytes per iteration using 16 byte streaming stores.
+	 */
+	RAPID_TARGET("sse2") void CopySSE2(uint8_t* pDestination, const uint8_t* pSource, uint64_t size)
+	{
+		AlignDestination(pDestination, pSource, size, 16);
+
+		for (; size >= 64; size -= 64)
+		{
+			const auto first = _mm_loadu_si128(reinterpret_cast<const __m128i*>(pSource));
+			const auto second = _mm_loadu_si128(reinterpret_cast<const __m128i*>(pSource + 16));
+			const auto third = _mm_loadu_si128(reinterpret_cast<const __m128i*>(pSource + 32));
+			const auto fourth = _mm_loadu_si128(reinterpret_cast<const __m128i*>(pSource + 48));
+
+			_mm_stream_si128(reinterpret_cast<__m128i*>(pDestination), first);
+			_mm_stream_si128(reinterpret_cast<__m128i*>(pDestination + 16), second);
+			_mm_stream_si128(reinterpret_cast<__m128i*>(pDestination + 32), third);
+			_mm_stream_si128(reinterpret_cast<__m128i*>(pDestination + 48), fourth);
+
+			pDestination += 64;
+			pSource += 64;
+		}
+
+		// Make sure the streaming stores are visible before anyone else (like the GPU) reads the memory.
+		_mm_sfence();
+		std::memcpy(pDestination, pSource, size);
+	}
+
+	/**
+	 * AVX2 kernel.
+	 * This copies 128 bytes per iteration using 32 byte streaming stores.
+	 */
+	RAPID_TARGET("avx2") void CopyAVX2(uint8_t* pDestination, const uint8_t* pSource, uint64_t size)
+	{
+		AlignDestination(pDestination, pSource, size, 32);
+
+		for (; size >= 128; size -= 128)
+		{
+			const auto first = _mm256_loadu_si256(reinterpret_cast<const __m256i*>(pSource));
+			const auto second = _mm256_loadu_si256(reinterpret_cast<const __m256i*>(pSource + 32));
+			const auto third = _mm256_loadu_si256(reinterpret_cast<const __m256i*>(pSource + 64));
+			const auto fourth = _mm256_loadu_si256(reinterpret_cast<const __m256i*>(pSource + 96));
+
+			_mm256_stream_si256(reinterpret_cast<__m256i*>(pDestination), first);
+			_mm256_stream_si256(reinterpret_cast<__m256i*>(pDestination + 32), second);
+			_mm256_stream_si256(reinterpret_cast<__m256i*>(pDestination + 64), third);
+			_mm256_stream_si256(reinterpret_cast<__m256i*>(pDestination + 96), fourth);
+
+			pDestination += 128;
+			pSource += 128;
+		}
+
+		_mm_sfence();
+		_mm256_zeroupper();
+		std::memcpy(pDestination, pSource, size);
+	}
+
+#endif
+
+#ifdef RAPID_ARCHITECTURE_NEON
+	/**
+	 * NEON kernel.
+	 * ARM does not expose non-temporal stores through intrinsics, so this uses wide paired loads and stores which the
+	 * CPU can merge into full cache line writes.
+	 */
+	void CopyNEON(uint8_t* pDestination, const uint8_t* pSource, uint64_t size)
+	{
+		AlignDestination(pDestination, pSource, size, 16);
+
+		for (; size >= 64; size -= 64)
+		{
+			const auto data = vld1q_u8_x4(pSource);
+			vst1q_u8_x4(pDestination, data);
+
+			pDestination += 64;
+			pSource += 64;
+		}
+
+		std::memcpy(pDestination, pSource, size);
+	}
+
+#endif
+
+	/**
+	 * Select the best kernel for the current CPU.
+	 *
+	 * @return The kernel and its name.
+	 */
+	std::pair<kernel_type, const char*> SelectKernel()
+	{
+#if defined(RAPID_ARCHITECTURE_X86)
+		if (rapid::IsAVX2Supported())
+			return { CopyAVX2, "AVX2" };
+
+		return { CopySSE2, "SSE2" };
+
+#elif defined(RAPID_ARCHITECTURE_NEON)
+		return { CopyNEON, "NEON" };
+
+#else
+		return { CopyScalar, "Scalar" };
+
+#endif
+	}
+
+	/**
+	 * Get the selected kernel.
+	 * The selection is done only once.
+	 *
+	 * @return The kernel and its name.
+	 */
+	const std::pair<kernel_type, const char*>& GetKernel()
+	{
+		static const auto kernel = SelectKernel();
+		return kernel;
+	}
+}
+
+namespace rapid
+{
+	void StreamingCopy(void* pDestination, const void* pSource, uint64_t size)
+	{
+		const auto pDestinationBytes = static_cast<uint8_t*>(pDestination);
+		const auto pSourceBytes = static_cast<const uint8_t*>(pSource);
+
+		if (size < StreamingThreshold)
+			CopyScalar(pDestinationBytes, pSourceBytes, size);
+
+		else
+			GetKernel().first(pDestinationBytes, pSourceBytes, size);
+	}
+
+	const char* GetStreamingCopyKernelName()
+	{
+		return GetKernel().second;
+	}
+}
@@ -0,0 +1,30 @@
+// Copyright (c) 2022 Dhiraj Wishal
+
+#pragma once
+
+#include <cstdint>
+
+namespace rapid
+{
+	/**
+	 * Copy data to an upload destination.
+	 * This is meant to be used when writing to mapped GPU memory, which is usually write-combined and uncached. Large copies
+	 * use non-temporal (streaming) stores so that the data does not go through the CPU cache, and reading back from the
+	 * destination is avoided entirely.
+	 *
+	 * The best kernel for the CPU (AVX2, SSE2 or NEON) is selected at runtime the first time this is called.
+	 * Note that the destination should not be read by the CPU right after this, as the stores may still be in flight.
+	 *
+	 * @param pDestination The destination pointer.
+	 * @param pSource The source pointer.
+	 * @param size The number of bytes to copy.
+	 */
+	void StreamingCopy(void* pDestination, const void* pSource, uint64_t size);
+
+	/**
+	 * Get the name of the copy kernel selected for this CPU.
+	 *
+	 * @return The kernel name.
+	 */
+	const char* GetStreamingCopyKernelName();
+}
@@ -0,0 +1,74 @@
+// Copyright (c) 2022 Dhiraj Wishal
+
+#include "ThreadPool.hpp"
+
+#include <algorithm>
+
+namespace rapid
+{
+	ThreadPool::ThreadPool(uint32_t threadCount)
+	{
+		// Leave one hardware thread for the main thread.
+		if (threadCount == 0)
+			threadCount = std::max(std::thread::hardware_concurrency(), 2u) - 1;
+
+		m_Workers.reserve(threadCount);
+		for (uint32_t i = 0; i < threadCount; i++)
+			m_Workers.emplace_back([this] { work(); });
+	}
+
+	ThreadPool::~ThreadPool()
+	{
+		{
+			const auto lock = std::scoped_lock(m_Mutex);
+			m_ShouldStop = true;
+		}
+
+		m_Condition.notify_all();
+		for (auto& worker : m_Workers)
+			worker.join();
+	}
+
+	void ThreadPool::submit(task_type&& task, TaskPriority priority)
+	{
+		{
+			const auto lock = std::scoped_lock(m_Mutex);
+			if (priority == TaskPriority::High)
+				m_HighPriorityTasks.emplace(std::move(task));
+
+			else
+				m_Tasks.emplace(std::move(task));
+		}
+
+		m_Condition.notify_one();
+	}
+
+	void ThreadPool::work()
+	{
+		while (true)
+		{
+			task_type task;
+
+			// Wait till we get a task or are asked to stop.
+			{
+				auto lock = std::unique_lock(m_Mutex);
+				m_Condition.wait(lock, [this] { return m_ShouldStop || !m_Tasks.empty() || !m_HighPriorityTasks.empty(); });
+
+				if (m_ShouldStop)
+					return;
+
+				auto& tasks = m_HighPriorityTasks.empty() ? m_Tasks : m_HighPriorityTasks;
+				task = std::move(tasks.front());
+				tasks.pop();
+			}
+
+			task();
+		}
+	}
+
+	ThreadPool& GetSharedThreadPool()
+	{
+		static ThreadPool threadPool;
+		return threadPool;
+	}
+}
\ No newline at end of file
@@ -0,0 +1,90 @@
+// Copyright (c) 2022 Dhiraj Wishal
+
+#pragma once
+
+#include <condition_variable>
+#include <cstdint>
+#include <functional>
+#include <mutex>
+#include <queue>
+#include <thread>
+#include <vector>
+
+namespace rapid
+{
+	/**
+	 * Task priority enum.
+	 */
+	enum class TaskPriority : uint8_t
+	{
+		Normal,	// Background work, like decoding images.
+		High	// Work which a frame is waiting for, like recording command buffers.
+	};
+
+	/**
+	 * Thread pool class.
+	 * This runs the submitted tasks on a fixed set of worker threads. High priority tasks are started before normal ones,
+	 * otherwise tasks are started in the order they were submitted.
+	 */
+	class ThreadPool final
+	{
+	public:
+		using task_type = std::function<void()>;
+
+		/**
+		 * Explicit constructor.
+		 *
+		 * @param threadCount The number of worker threads. If 0, one less than the hardware concurrency is used (at least one).
+		 */
+		explicit ThreadPool(uint32_t threadCount = 0);
+
+		/**
+		 * Destructor.
+		 * This waits till the running tasks are done. Tasks which haven't started yet are dropped.
+		 */
+		~ThreadPool();
+
+		ThreadPool(const ThreadPool&) = delete;
+		ThreadPool& operator=(const ThreadPool&) = delete;
+
+		/**
+		 * Submit a new task.
+		 *
+		 * @param task The task to run.
+		 * @param priority The task's priority. Default is normal.
+		 */
+		void submit(task_type&& task, TaskPriority priority = TaskPriority::Normal);
+
+		/**
+		 * Get the number of worker threads.
+		 *
+		 * @return The thread count.
+		 */
+		uint32_t threadCount() const { return static_cast<uint32_t>(m_Workers.size()); }
+
+	private:
+		/**
+		 * The worker thread's function.
+		 */
+		void work();
+
+	private:
+		std::vector<std::thread> m_Workers;
+		std::queue<task_type> m_Tasks;
+		std::queue<task_type> m_HighPriorityTasks;
+
+		std::mutex m_Mutex;
+		std::condition_variable m_Condition;
+
+		bool m_ShouldStop = false;
+	};
+
+	/**
+	 * Get the thread pool shared by the whole editor.
+	 * Sharing one pool keeps the number of worker threads at the hardware concurrency, instead of every subsystem
+	 * spawning its own set. It's created the first time it's used.
+	 *
+	 * @return The shared thread pool.
+	 */
+	ThreadPool& GetSharedThreadPool();
+}
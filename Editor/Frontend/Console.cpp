@@ -39,6 +39,9 @@ namespace rapid
 		const auto rawtime = time(nullptr);
 		strftime(buffer, sizeof(buffer), "%d-%m-%Y %H:%M:%S", localtime(&rawtime));
 		m_Messages.emplace_back(std::move("[" + std::string(buffer) + "] " + message), severity);
+
+		// Make sure the new message gets shown.
+		invalidate();
 	}
 
 	void Console::begin()
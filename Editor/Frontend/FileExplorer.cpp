@@ -1,9 +1,35 @@
 // Copyright (c) 2022 Dhiraj Wishal
 
 #include "FileExplorer.hpp"
+#include "Globals.hpp"
 
 #include <imgui.h>
 
+#include <algorithm>
+#include <array>
+#include <cctype>
+
+namespace
+{
+	constexpr uint32_t ThumbnailSize = 128;
+	constexpr uint32_t IconSize = 32;
+
+	/**
+	 * Check if a file is an image which can be loaded.
+	 *
+	 * @param file The file path.
+	 * @return Whether or not it's an image.
+	 */
+	bool IsImageFile(const std::filesystem::path& file)
+	{
+		constexpr std::array<std::string_view, 6> Extensions = { ".png", ".jpg", ".jpeg", ".tga", ".bmp", ".gif" };
+
+		auto extension = file.extension().string();
+		std::transform(extension.begin(), extension.end(), extension.begin(), [](char character) { return static_cast<char>(std::tolower(character)); });
+		return std::find(Extensions.begin(), Extensions.end(), extension) != Extensions.end();
+	}
+}
+
 namespace rapid
 {
 	FileExplorer::FileExplorer()
@@ -17,6 +43,9 @@ namespace rapid
 
 		// Recursively get the directories and show them.
 		showDirectory(std::filesystem::directory_entry(m_SearchPath));
+
+		// Release the images of the files which are no longer shown (like the ones in collapsed directories).
+		releaseHiddenImages();
 	}
 
 	void FileExplorer::end()
@@ -24,7 +53,7 @@ namespace rapid
 		ImGui::End();
 	}
 	
-	void FileExplorer::showDirectory(const std::filesystem::directory_entry& directory) const
+	void FileExplorer::showDirectory(const std::filesystem::directory_entry& directory)
 	{
 		for (const auto entry : std::filesystem::directory_iterator(directory))
 		{
@@ -39,7 +68,96 @@ namespace rapid
 				}
 			}
 			else
+			{
+				const auto isImage = IsImageFile(entry.path());
+				if (isImage)
+				{
+					m_VisibleImages.insert(entry.path().string());
+					showIcon(entry.path());
+				}
+
 				ImGui::Text(string.c_str());
+
+				// Show the thumbnail when hovering over an image.
+				if (isImage && ImGui::IsItemHovered())
+					showThumbnail(entry.path());
+			}
+		}
+	}
+
+	void FileExplorer::showIcon(const std::filesystem::path& file)
+	{
+		const auto pImageLoader = GetGlobals().m_pImageLoader;
+		if (!pImageLoader)
+			return;
+
+		// Icons are packed in the texture atlas, so listing a lot of images stays cheap.
+		auto& handle = m_Icons[file.string()];
+		if (handle == InvalidImageHandle)
+			handle = pImageLoader->loadIcon(file, IconSize);
+
+		// Keep the space while loading, so the names don't jump around.
+		const auto size = ImGui::GetTextLineHeight();
+		if (const auto region = pImageLoader->getTextureRegion(handle))
+		{
+			// Fit the icon in the square with its own aspect ratio, centered.
+			const auto scale = size / static_cast<float>(std::max({ region->m_Width, region->m_Height, 1u }));
+			const auto iconSize = ImVec2(region->m_Width * scale, region->m_Height * scale);
+			const auto cursor = ImGui::GetCursorScreenPos();
+			const auto minimum = ImVec2(cursor.x + (size - iconSize.x) * 0.5f, cursor.y + (size - iconSize.y) * 0.5f);
+
+			ImGui::GetWindowDrawList()->AddImage(region->m_TextureID, minimum, ImVec2(minimum.x + iconSize.x, minimum.y + iconSize.y), region->m_UV0, region->m_UV1);
 		}
+
+		ImGui::Dummy(ImVec2(size, size));
+		ImGui::SameLine();
+	}
+
+	void FileExplorer::showThumbnail(const std::filesystem::path& file)
+	{
+		const auto pImageLoader = GetGlobals().m_pImageLoader;
+		if (!pImageLoader)
+			return;
+
+		// Thumbnails are downscaled while decoding and packed in the atlas as well, so hovering over large images doesn't
+		// upload them at full size.
+		auto& handle = m_Thumbnails[file.string()];
+		if (handle == InvalidImageHandle)
+			handle = pImageLoader->loadIcon(file, ThumbnailSize);
+
+		ImGui::BeginTooltip();
+		if (const auto region = pImageLoader->getTextureRegion(handle))
+			ImGui::Image(region->m_TextureID, ImVec2(static_cast<float>(region->m_Width), static_cast<float>(region->m_Height)), region->m_UV0, region->m_UV1);
+
+		else if (pImageLoader->hasFailed(handle))
+			ImGui::TextUnformatted("Failed to load the image.");
+
+		else
+			ImGui::TextUnformatted("Loading...");
+
+		ImGui::EndTooltip();
+	}
+
+	void FileExplorer::releaseHiddenImages()
+	{
+		const auto pImageLoader = GetGlobals().m_pImageLoader;
+		const auto releaseHidden = [this, pImageLoader](std::unordered_map<std::string, ImageHandle>& images)
+		{
+			std::erase_if(images, [this, pImageLoader](const auto& entry)
+				{
+					if (m_VisibleImages.contains(entry.first))
+						return false;
+
+					if (pImageLoader && entry.second != InvalidImageHandle)
+						pImageLoader->release(entry.second);
+
+					return true;
+				}
+			);
+		};
+
+		releaseHidden(m_Icons);
+		releaseHidden(m_Thumbnails);
+		m_VisibleImages.clear();
 	}
 }
\ No newline at end of file
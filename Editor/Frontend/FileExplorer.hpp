@@ -3,8 +3,11 @@
 #pragma once
 
 #include "UIComponent.hpp"
+#include "Backend/ImageLoader.hpp"
 
 #include <filesystem>
+#include <unordered_map>
+#include <unordered_set>
 
 namespace rapid
 {
@@ -36,9 +39,32 @@ namespace rapid
 		 * 
 		 * @param directory The directory to iterate and show.
 		 */
-		void showDirectory(const std::filesystem::directory_entry& directory) const;
+		void showDirectory(const std::filesystem::directory_entry& directory);
+
+		/**
+		 * Show the icon of an image file in front of its name.
+		 *
+		 * @param file The image file.
+		 */
+		void showIcon(const std::filesystem::path& file);
+
+		/**
+		 * Show the thumbnail of an image file as a tooltip.
+		 * The image is loaded in the background the first time, and "Loading..." is shown till it's ready.
+		 *
+		 * @param file The image file.
+		 */
+		void showThumbnail(const std::filesystem::path& file);
+
+		/**
+		 * Release the icons and thumbnails of the image files which were not shown this frame.
+		 */
+		void releaseHiddenImages();
 
 	private:
 		std::filesystem::path m_SearchPath;
+		std::unordered_map<std::string, ImageHandle> m_Thumbnails;
+		std::unordered_map<std::string, ImageHandle> m_Icons;
+		std::unordered_set<std::string> m_VisibleImages;
 	};
 }
\ No newline at end of file
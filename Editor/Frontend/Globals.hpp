@@ -2,14 +2,34 @@
 
 #pragma once
 
+#include <filesystem>
+#include <vector>
+
+struct ImFont;
+
 namespace rapid
 {
+	class FramePacer;
+	class GraphicsEngine;
+	class ImageLoader;
+	class ImGuiNode;
+	class Window;
+
 	/**
 	 * Globals structure.
 	 * This contains all the global information used by the application.
 	 */
 	struct Globals final
 	{
+		std::vector<std::pair<std::filesystem::path, float>> m_FontRequests;	// Fonts to add (file and size). These are loaded in the background.
+		ImGuiNode* m_pImGuiNode = nullptr;	// The node which renders ImGui. This is nullptr if not available.
+		Window* m_pWindow = nullptr;	// The window which shows the UI. This is nullptr if not available.
+		GraphicsEngine* m_pGraphicsEngine = nullptr;	// The engine the window renders with. This is nullptr if not available.
+		FramePacer* m_pFramePacer = nullptr;	// Paces the window's frames. This is nullptr if not available.
+		ImageLoader* m_pImageLoader = nullptr;	// Loads images in the background. This is nullptr if not available.
+		ImFont* m_pDistanceFieldFont = nullptr;	// Font which stays sharp at any scale. This is nullptr if not available.
+		bool m_ShowMemoryPanel = false;
+		bool m_ShowProfilerPanel = false;
 		bool m_ShouldRun = true;
 	};
 
@@ -0,0 +1,158 @@
+// Copyright (c) 2022 Dhiraj Wishal
+
+#include "MemoryPanel.hpp"
+#include "Globals.hpp"
+
+#include "Backend/Window.hpp"
+
+#include <imgui.h>
+
+#include <cstdio>
+#include <iterator>
+
+namespace
+{
+	/**
+	 * Format a number of bytes in the largest unit which keeps it above 1.
+	 *
+	 * @param bytes The number of bytes.
+	 * @param pBuffer The buffer to write to.
+	 * @param size The size of the buffer.
+	 */
+	void FormatBytes(uint64_t bytes, char* pBuffer, size_t size)
+	{
+		constexpr const char* Units[] = { "B", "KiB", "MiB", "GiB" };
+
+		auto value = static_cast<double>(bytes);
+		uint32_t unit = 0;
+		while (value >= 1024.0 && unit < std::size(Units) - 1)
+		{
+			value /= 1024.0;
+			unit++;
+		}
+
+		std::snprintf(pBuffer, size, unit == 0 ? "%.0f %s" : "%.2f %s", value, Units[unit]);
+	}
+}
+
+namespace rapid
+{
+	MemoryPanel::MemoryPanel()
+		: UIComponent("Memory")
+	{
+	}
+
+	void MemoryPanel::begin()
+	{
+		ImGui::Begin(m_Title.c_str(), &GetGlobals().m_ShowMemoryPanel);
+
+		if (!GetGlobals().m_pGraphicsEngine)
+		{
+			ImGui::TextUnformatted("There's no device to show the memory of.");
+			return;
+		}
+
+		showHeaps();
+		ImGui::Separator();
+		showCategories();
+		ImGui::Separator();
+		showDefragmentation();
+	}
+
+	void MemoryPanel::end()
+	{
+		ImGui::End();
+	}
+
+	void MemoryPanel::showHeaps() const
+	{
+		const auto& engine = *GetGlobals().m_pGraphicsEngine;
+		ImGui::TextUnformatted(engine.isMemoryBudgetEnabled() ? "Budgets are reported by the device." : "Budgets are estimated from the heap sizes.");
+
+		char usage[32] = {};
+		char budget[32] = {};
+		char overlay[96] = {};
+
+		const auto heapBudgets = engine.getHeapBudgets();
+		for (size_t i = 0; i < heapBudgets.size(); i++)
+		{
+			const auto& heapBudget = heapBudgets[i];
+			ImGui::Text("Heap %zu%s", i, heapBudget.m_IsDeviceLocal ? " (device local)" : "");
+
+			FormatBytes(heapBudget.m_Usage, usage, sizeof(usage));
+			FormatBytes(heapBudget.m_Budget, budget, sizeof(budget));
+			std::snprintf(overlay, sizeof(overlay), "%s / %s", usage, budget);
+
+			const auto fraction = heapBudget.m_Budget > 0 ? static_cast<float>(static_cast<double>(heapBudget.m_Usage) / static_cast<double>(heapBudget.m_Budget)) : 0.0f;
+			ImGui::ProgressBar(fraction, ImVec2(-1.0f, 0.0f), overlay);
+
+			// The blocks hold the editor's allocations, so the difference is what's lost to fragmentation.
+			FormatBytes(heapBudget.m_AllocatedBytes, usage, sizeof(usage));
+			FormatBytes(heapBudget.m_BlockBytes, budget, sizeof(budget));
+			ImGui::Text("Allocated %s in %s of blocks", usage, budget);
+		}
+	}
+
+	void MemoryPanel::showCategories() const
+	{
+		if (!ImGui::BeginTable("Categories", 3, ImGuiTableFlags_RowBg | ImGuiTableFlags_BordersInnerV))
+			return;
+
+		ImGui::TableSetupColumn("Category");
+		ImGui::TableSetupColumn("Count");
+		ImGui::TableSetupColumn("Size");
+		ImGui::TableHeadersRow();
+
+		char size[32] = {};
+		const auto& statistics = GetGlobals().m_pGraphicsEngine->getMemoryStatistics();
+		for (uint8_t i = 0; i < static_cast<uint8_t>(MemoryCategory::Count); i++)
+		{
+			const auto category = static_cast<MemoryCategory>(i);
+			const auto usage = statistics.getUsage(category);
+
+			ImGui::TableNextRow();
+			ImGui::TableNextColumn();
+			ImGui::TextUnformatted(GetMemoryCategoryName(category).data());
+
+			ImGui::TableNextColumn();
+			ImGui::Text("%llu", static_cast<unsigned long long>(usage.m_Count));
+
+			// The driver owns the pipelines' memory, so there's no size to show.
+			ImGui::TableNextColumn();
+			if (category == MemoryCategory::Pipeline)
+				ImGui::TextDisabled("Driver");
+
+			else
+			{
+				FormatBytes(usage.m_Bytes, size, sizeof(size));
+				ImGui::TextUnformatted(size);
+			}
+		}
+
+		ImGui::EndTable();
+	}
+
+	void MemoryPanel::showDefragmentation() const
+	{
+		const auto pWindow = GetGlobals().m_pWindow;
+		if (!pWindow)
+			return;
+
+		auto& defragmenter = pWindow->getMemoryDefragmenter();
+		const auto statistics = defragmenter.getStatistics();
+
+		char moved[32] = {};
+		char freed[32] = {};
+		FormatBytes(statistics.m_BytesMoved, moved, sizeof(moved));
+		FormatBytes(statistics.m_BytesFreed, freed, sizeof(freed));
+
+		ImGui::Text("Defragmented %llu times, moved %llu allocations (%s) and freed %s.", static_cast<unsigned long long>(statistics.m_Runs), static_cast<unsigned long long>(statistics.m_AllocationsMoved), moved, freed);
+
+		const auto isDefragmenting = defragmenter.isDefragmenting();
+		ImGui::BeginDisabled(isDefragmenting);
+		if (ImGui::Button(isDefragmenting ? "Defragmenting..." : "Defragment"))
+			defragmenter.request();
+
+		ImGui::EndDisabled();
+	}
+}
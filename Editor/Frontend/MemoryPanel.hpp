@@ -0,0 +1,48 @@
+// Copyright (c) 2022 Dhiraj Wishal
+
+#pragma once
+
+#include "UIComponent.hpp"
+
+namespace rapid
+{
+	/**
+	 * Memory panel class.
+	 * This shows how much device memory the editor uses, against the budget of each heap, and how it's split between
+	 * the kinds of resources. The device memory can be defragmented from here as well.
+	 */
+	class MemoryPanel final : public UIComponent
+	{
+	public:
+		/**
+		 * Default constructor.
+		 */
+		MemoryPanel();
+
+		/**
+		 * Begin the stack.
+		 */
+		void begin() override;
+
+		/**
+		 * End the stack.
+		 */
+		void end() override;
+
+	private:
+		/**
+		 * Show the heap budgets.
+		 */
+		void showHeaps() const;
+
+		/**
+		 * Show the memory usage of each category.
+		 */
+		void showCategories() const;
+
+		/**
+		 * Show the defragmentation state and controls.
+		 */
+		void showDefragmentation() const;
+	};
+}
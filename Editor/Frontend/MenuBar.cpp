@@ -5,6 +5,11 @@
 #include "Utility/ThemeParser.hpp"
 #include "Utility/CloseEvent.hpp"
 
+#include "Backend/Window.hpp"
+#include "Backend/Utility.hpp"
+
+#include "Core/FramePacer.hpp"
+
 #include <imgui.h>
 #include <SDL.h>
 
@@ -55,6 +60,11 @@ namespace rapid
 				if (ImGui::MenuItem("Themes"))
 					m_ThemeSelected = true;
 
+				// Toggle the memory and profiler panels.
+				ImGui::MenuItem("Memory", nullptr, &GetGlobals().m_ShowMemoryPanel);
+				ImGui::MenuItem("GPU Profiler", nullptr, &GetGlobals().m_ShowProfilerPanel);
+
+				showPresentMenu();
 				ImGui::EndMenu();
 			}
 		}
@@ -95,4 +105,59 @@ namespace rapid
 	{
 		ImGui::EndMainMenuBar();
 	}
+
+	void MenuBar::showPresentMenu() const
+	{
+		const auto pWindow = GetGlobals().m_pWindow;
+		if (!pWindow || !ImGui::BeginMenu("Present"))
+			return;
+
+		auto settings = pWindow->getPresentSettings();
+		auto hasChanged = false;
+
+		// Only the modes the surface supports are listed.
+		for (const auto presentMode : pWindow->getSupportedPresentModes())
+		{
+			if (ImGui::MenuItem(utility::GetPresentModeName(presentMode).data(), nullptr, presentMode == settings.m_PresentMode))
+			{
+				settings.m_PresentMode = presentMode;
+				hasChanged = true;
+			}
+		}
+
+		ImGui::Separator();
+
+		// The swapchain is recreated once the value is set, not while it's being dragged.
+		auto imageCount = static_cast<int32_t>(settings.m_ImageCount);
+		ImGui::SliderInt("Images", &imageCount, 1, 8);
+		if (ImGui::IsItemDeactivatedAfterEdit())
+		{
+			settings.m_ImageCount = static_cast<uint32_t>(imageCount);
+			hasChanged = true;
+		}
+
+		if (hasChanged)
+			pWindow->setPresentSettings(settings);
+
+		// Show the frame pacing, if the frames are paced.
+		if (const auto pFramePacer = GetGlobals().m_pFramePacer)
+		{
+			ImGui::Separator();
+
+			auto frameRate = static_cast<int32_t>(pFramePacer->getTargetFrameRate());
+			if (ImGui::SliderInt("Frame rate", &frameRate, 0, 240, frameRate == 0 ? "Display" : "%d"))
+				pFramePacer->setTargetFrameRate(static_cast<double>(frameRate));
+
+			const auto statistics = pFramePacer->getStatistics();
+			ImGui::Text("Target %.2f ms, median %.2f ms, 99th percentile %.2f ms", statistics.m_TargetFrameTime, statistics.m_MedianFrameTime, statistics.m_Percentile99FrameTime);
+			ImGui::Text("Max %.2f ms, %llu missed deadlines", statistics.m_MaxFrameTime, static_cast<unsigned long long>(statistics.m_MissedDeadlines));
+		}
+
+		ImGui::Separator();
+
+		if (ImGui::MenuItem("Measure latency", nullptr, pWindow->isMeasuringLatency()))
+			pWindow->setLatencyMeasurement(!pWindow->isMeasuringLatency());
+
+		ImGui::EndMenu();
+	}
 }
\ No newline at end of file
@@ -28,6 +28,14 @@ namespace rapid
 		 */
 		void end() override;
 
+	private:
+		/**
+		 * Show the present menu.
+		 * This lets the user change the window's present settings and frame rate, toggle the latency measurement and see
+		 * how steady the frames are.
+		 */
+		void showPresentMenu() const;
+
 	private:
 		char m_ThemePath[256] = "";
 
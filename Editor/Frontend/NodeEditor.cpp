@@ -2,6 +2,11 @@
 
 #include "NodeEditor.hpp"
 #include "Console.hpp"
+#include "Globals.hpp"
+
+#include "Backend/ImGuiNode.hpp"
+
+#include "Core/Hash.hpp"
 
 #include <imgui.h>
 #include <imnodes.h>
@@ -12,6 +17,8 @@
 #endif
 
 #include <fstream>
+#include <algorithm>
+#include <cmath>
 
 namespace
 {
@@ -35,6 +42,31 @@ namespace
 
 	constexpr auto DefaultProtectedColor = IM_COL32(0, 0, 255, 196);
 	constexpr auto DefaultProtectedColorHovered = IM_COL32(0, 0, 255, 255);
+
+	constexpr float MinimumTextScale = 0.25f;
+	constexpr float MaximumTextScale = 4.0f;
+	constexpr float TextScaleStep = 1.1f;
+
+	constexpr float MiniMapSizeFraction = 0.2f;
+
+	/**
+	 * Show a line of node text.
+	 * The distance field font is only pushed around the text, so the node's shapes keep using the default font atlas and
+	 * are not drawn using the distance field pipeline.
+	 *
+	 * @param pText The text to show.
+	 */
+	void ShowNodeText(const char* pText)
+	{
+		const auto pFont = rapid::GetGlobals().m_pDistanceFieldFont;
+		if (pFont)
+			ImGui::PushFont(pFont);
+
+		ImGui::TextUnformatted(pText);
+
+		if (pFont)
+			ImGui::PopFont();
+	}
 }
 
 namespace rapid
@@ -56,7 +88,7 @@ namespace rapid
 		return m_OutputAttributes.emplace_back(std::move(name), m_AttributeID++, prop);
 	}
 
-	void NodeBuilder::show() const
+	uint64_t NodeBuilder::show(std::unordered_map<int32_t, PinPosition>& pinPositions, bool shouldCull) const
 	{
 		ImNodes::PushColorStyle(ImNodesCol_TitleBar, m_TitleColor);
 		ImNodes::PushColorStyle(ImNodesCol_TitleBarHovered, m_TitleHoveredColor);
@@ -64,8 +96,18 @@ namespace rapid
 
 		// Begin and show the title.
 		ImNodes::BeginNode(m_NodeID);
+
+		// The contents are drawn to the node's channel, but all the channels share the vertex buffer, so the contents' vertices
+		// are the ones added till the node ends. Clipping everything away makes ImGui skip drawing the items, but not laying
+		// them out.
+		const auto pDrawList = ImGui::GetWindowDrawList();
+		const auto firstVertex = pDrawList->VtxBuffer.Size;
+
+		if (shouldCull)
+			ImGui::PushClipRect(ImVec2(-FLT_MAX, -FLT_MAX), ImVec2(-FLT_MAX, -FLT_MAX), false);
+
 		ImNodes::BeginNodeTitleBar();
-		ImGui::TextUnformatted(m_Title.data());
+		ShowNodeText(m_Title.data());
 		ImNodes::EndNodeTitleBar();
 
 		// Get the IO information.
@@ -79,9 +121,12 @@ namespace rapid
 
 			// Set the attribute info.
 			ImNodes::BeginInputAttribute(attribute.m_AttributeID, ImNodesPinShape_TriangleFilled);
-			ImGui::Text(attribute.m_AttributeName.data());
+			ShowNodeText(attribute.m_AttributeName.data());
 			ImNodes::EndInputAttribute();
 
+			// The item rect is the attribute's rect. The x coordinate is set once the node's rect is known.
+			pinPositions[attribute.m_AttributeID] = PinPosition{ .m_Position = ImVec2(0.0f, (ImGui::GetItemRectMin().y + ImGui::GetItemRectMax().y) * 0.5f), .m_IsOutput = false };
+
 			// Don't forget to pop the attribute flag!
 			ImNodes::PopAttributeFlag();
 		}
@@ -101,9 +146,11 @@ namespace rapid
 
 				// Set the attribute info.
 				ImNodes::BeginOutputAttribute(attribute.m_AttributeID, ImNodesPinShape_TriangleFilled);
-				ImGui::Text(attribute.m_AttributeName.data());
+				ShowNodeText(attribute.m_AttributeName.data());
 				ImNodes::EndOutputAttribute();
 
+				pinPositions[attribute.m_AttributeID] = PinPosition{ .m_Position = ImVec2(0.0f, (ImGui::GetItemRectMin().y + ImGui::GetItemRectMax().y) * 0.5f), .m_IsOutput = true };
+
 				// Pop the color styles.
 				ImNodes::PopColorStyle();
 				ImNodes::PopColorStyle();
@@ -120,26 +167,63 @@ namespace rapid
 					previousProperty = attribute.m_Property;
 
 					if (attribute.m_Property == 0)
-						ImGui::Text("public:");
+						ShowNodeText("public:");
 
 					else if (attribute.m_Property == 1)
-						ImGui::Text("private:");
+						ShowNodeText("private:");
 
 					else if (attribute.m_Property == 2)
-						ImGui::Text("protected:");
+						ShowNodeText("protected:");
 				}
 
-				ImGui::Text(("\t" + attribute.m_AttributeName).data());
+				ShowNodeText(("\t" + attribute.m_AttributeName).data());
 				ImNodes::EndStaticAttribute();
 			}
 		}
 
+		// Hash the contents relative to the node, so panning doesn't change them.
+		uint64_t hash = 0;
+		if (shouldCull)
+		{
+			ImGui::PopClipRect();
+		}
+		else
+		{
+			const auto origin = ImNodes::GetNodeScreenSpacePos(m_NodeID);
+
+			hash = HashSeed;
+			for (auto i = firstVertex; i < pDrawList->VtxBuffer.Size; i++)
+			{
+				auto vertex = pDrawList->VtxBuffer[i];
+				vertex.pos.x -= origin.x;
+				vertex.pos.y -= origin.y;
+
+				hash = HashValue(vertex, hash);
+			}
+		}
+
 		// Let's end the node.
 		ImNodes::EndNode();
 
+		// The pins are placed just outside the node's rect, which is the item rect expanded by the node padding.
+		const auto& style = ImNodes::GetStyle();
+		const auto left = ImGui::GetItemRectMin().x - style.NodePadding.x - style.PinOffset;
+		const auto right = ImGui::GetItemRectMax().x + style.NodePadding.x + style.PinOffset;
+
+		for (const auto& attribute : m_InputAttributes)
+			pinPositions[attribute.m_AttributeID].m_Position.x = left;
+
+		for (const auto& attribute : m_OutputAttributes)
+		{
+			if (attribute.m_Property == -1)
+				pinPositions[attribute.m_AttributeID].m_Position.x = right;
+		}
+
 		ImNodes::PopColorStyle();
 		ImNodes::PopColorStyle();
 		ImNodes::PopColorStyle();
+
+		return hash;
 	}
 
 	NodeBuilder NodeBuilder::clone(const int32_t nodeID) const
@@ -203,6 +287,21 @@ namespace rapid
 		ImGui::Begin(m_Title.c_str());
 		ImNodes::BeginNodeEditor();
 
+		// The canvas is drawn to its own child window, so remember its draw list to cache it once it's complete.
+		m_pCanvasDrawList = ImGui::GetWindowDrawList();
+		m_CanvasMinimum = ImGui::GetWindowPos();
+		m_CanvasMaximum = ImVec2(m_CanvasMinimum.x + ImGui::GetWindowWidth(), m_CanvasMinimum.y + ImGui::GetWindowHeight());
+
+		// The links are drawn on the GPU, under the nodes.
+		const auto pImGuiNode = GetGlobals().m_pImGuiNode;
+		if (pImGuiNode)
+		{
+			if (!m_pLinkRenderer)
+				m_pLinkRenderer = &pImGuiNode->createLinkRenderer();
+
+			m_pLinkRenderer->addTo(*m_pCanvasDrawList);
+		}
+
 		const auto& jsonNode = m_JsonDocument["name"];
 
 		for (const auto& node : jsonNode)
@@ -252,69 +351,115 @@ namespace rapid
 
 		ImGui::PopStyleVar();
 
+		// Zoom the node text using Ctrl + mouse wheel.
+		const auto& imGuiIO = ImGui::GetIO();
+		if (ImGui::IsWindowHovered() && imGuiIO.KeyCtrl && imGuiIO.MouseWheel != 0.0f)
+			m_TextScale = std::clamp(m_TextScale * std::pow(TextScaleStep, imGuiIO.MouseWheel), MinimumTextScale, MaximumTextScale);
+
+		// Node titles and pin labels are drawn using the distance field font, so they stay sharp at any scale. The font is
+		// only pushed around the text (see ShowNodeText), so only the glyphs use the distance field pipeline.
+		if (const auto pFont = GetGlobals().m_pDistanceFieldFont)
+			pFont->Scale = m_TextScale * ImGui::GetFontSize() / pFont->FontSize;
+
+		// The contents of the nodes which haven't changed lately are already cached by the canvas layer, so they don't need to
+		// be drawn again. This is only done while nothing can interact with them: the mouse is outside the canvas and no item
+		// in the editor is being edited.
+		const auto& mousePosition = imGuiIO.MousePos;
+		const auto isCanvasHovered = mousePosition.x >= m_CanvasMinimum.x && mousePosition.y >= m_CanvasMinimum.y && mousePosition.x < m_CanvasMaximum.x && mousePosition.y < m_CanvasMaximum.y;
+		const auto isEditing = ImGui::IsWindowFocused(ImGuiFocusedFlags_RootAndChildWindows) && ImGui::IsAnyItemActive();
+		const auto canCull = m_pCanvasLayer && m_pCanvasLayer->isValid() && !isCanvasHovered && !isEditing;
+
 		// Finally we can show the nodes.
+		m_PinPositions.clear();
+		m_CanvasNodes.clear();
 		for (const auto& node : m_ActiveNodeBuilders)
-			node.show();
+		{
+			const auto shouldCull = canCull && m_CanvasDamage.isStable(m_CanvasNodes.size(), node.getID());
+			const auto hash = node.show(m_PinPositions, shouldCull);
+
+			m_CanvasNodes.emplace_back(CanvasDamage::Node{ .m_Hash = hash, .m_NodeID = node.getID(), .m_IsCulled = shouldCull });
+		}
 	}
 
 	void NodeEditor::end()
 	{
-		// Create the links if we have any.
-		for (int i = 0; i < m_Links.size(); ++i)
+		// When the link renderer draws the links, ImNodes only needs them for interaction. Transparent links are not
+		// tessellated by ImGui, so they don't cost anything to draw.
+		if (m_pLinkRenderer)
 		{
-			const auto p = m_Links[i];
-			bool shouldPop = true;
+			ImNodes::PushColorStyle(ImNodesCol_Link, IM_COL32(0, 0, 0, 0));
+			ImNodes::PushColorStyle(ImNodesCol_LinkHovered, IM_COL32(0, 0, 0, 0));
+			ImNodes::PushColorStyle(ImNodesCol_LinkSelected, IM_COL32(0, 0, 0, 0));
 
-			for (const auto& node : m_ActiveNodeBuilders)
+			for (int i = 0; i < m_Links.size(); ++i)
+				ImNodes::Link(i, m_Links[i].first.second, m_Links[i].second.second);
+
+			ImNodes::PopColorStyle();
+			ImNodes::PopColorStyle();
+			ImNodes::PopColorStyle();
+		}
+
+		// Otherwise ImNodes draws them, with the property colors.
+		else
+		{
+			for (int i = 0; i < m_Links.size(); ++i)
 			{
-				if (node.getID() == p.first.first || node.getID() == p.second.first)
-				{
-					auto prop = node.getAttributeProperty(p.first.second);
-					if (prop < 0)
-						prop = node.getAttributeProperty(p.second.second);
+				const auto p = m_Links[i];
+				bool shouldPop = true;
 
-					if (prop == -1)
-					{
-						shouldPop = false;
-					}
-					else if (prop == 0)
-					{
-						ImNodes::PushColorStyle(ImNodesCol_Link, DefaultPublicColor);
-						ImNodes::PushColorStyle(ImNodesCol_LinkHovered, DefaultPublicColorHovered);
-						ImNodes::PushColorStyle(ImNodesCol_LinkSelected, DefaultPublicColorHovered);
-					}
-					else if (prop == 1)
-					{
-						ImNodes::PushColorStyle(ImNodesCol_Link, DefaultPrivateColor);
-						ImNodes::PushColorStyle(ImNodesCol_LinkHovered, DefaultPrivateColorHovered);
-						ImNodes::PushColorStyle(ImNodesCol_LinkSelected, DefaultPrivateColorHovered);
-					}
-					else if (prop == 2)
+				for (const auto& node : m_ActiveNodeBuilders)
+				{
+					if (node.getID() == p.first.first || node.getID() == p.second.first)
 					{
-						ImNodes::PushColorStyle(ImNodesCol_Link, DefaultProtectedColor);
-						ImNodes::PushColorStyle(ImNodesCol_LinkHovered, DefaultProtectedColorHovered);
-						ImNodes::PushColorStyle(ImNodesCol_LinkSelected, DefaultProtectedColorHovered);
+						auto prop = node.getAttributeProperty(p.first.second);
+						if (prop < 0)
+							prop = node.getAttributeProperty(p.second.second);
+
+						if (prop == -1)
+						{
+							shouldPop = false;
+						}
+						else if (prop == 0)
+						{
+							ImNodes::PushColorStyle(ImNodesCol_Link, DefaultPublicColor);
+							ImNodes::PushColorStyle(ImNodesCol_LinkHovered, DefaultPublicColorHovered);
+							ImNodes::PushColorStyle(ImNodesCol_LinkSelected, DefaultPublicColorHovered);
+						}
+						else if (prop == 1)
+						{
+							ImNodes::PushColorStyle(ImNodesCol_Link, DefaultPrivateColor);
+							ImNodes::PushColorStyle(ImNodesCol_LinkHovered, DefaultPrivateColorHovered);
+							ImNodes::PushColorStyle(ImNodesCol_LinkSelected, DefaultPrivateColorHovered);
+						}
+						else if (prop == 2)
+						{
+							ImNodes::PushColorStyle(ImNodesCol_Link, DefaultProtectedColor);
+							ImNodes::PushColorStyle(ImNodesCol_LinkHovered, DefaultProtectedColorHovered);
+							ImNodes::PushColorStyle(ImNodesCol_LinkSelected, DefaultProtectedColorHovered);
+						}
+
+						break;
 					}
-
-					break;
 				}
-			}
 
-			ImNodes::Link(i, p.first.second, p.second.second);
+				ImNodes::Link(i, p.first.second, p.second.second);
 
-			if (shouldPop)
-			{
-				ImNodes::PopColorStyle();
-				ImNodes::PopColorStyle();
-				ImNodes::PopColorStyle();
+				if (shouldPop)
+				{
+					ImNodes::PopColorStyle();
+					ImNodes::PopColorStyle();
+					ImNodes::PopColorStyle();
+				}
 			}
 		}
 
 		// Make sure to show the mini map before we end!
-		ImNodes::MiniMap(0.2f, ImNodesMiniMapLocation_BottomRight, MiniMapHoveredCallback, m_ActiveNodeBuilders.data());
+		ImNodes::MiniMap(MiniMapSizeFraction, ImNodesMiniMapLocation_BottomRight, MiniMapHoveredCallback, m_ActiveNodeBuilders.data());
 
 		//ImNodes::PopAttributeFlag();
 		ImNodes::EndNodeEditor();
+		updateLinks();
+		updateCanvasLayer();
 		ImGui::End();
 
 		// Resolve the links.
@@ -360,13 +505,13 @@ namespace rapid
 					previousProperty = prop;
 
 					if (prop == 0)
-						ImGui::Text("public:");
+						ShowNodeText("public:");
 
 					else if (prop == 1)
-						ImGui::Text("private:");
+						ShowNodeText("private:");
 
 					else if (prop == 2)
-						ImGui::Text("protected:");
+						ShowNodeText("protected:");
 				}
 
 				ImGui::Text(("\t" + type + " " + name).c_str());
@@ -779,4 +924,179 @@ namespace rapid
 		jsonFile << m_JsonDocument.dump(0);
 		jsonFile.close();
 	}
-}
\ No newline at end of file
+
+	void NodeEditor::updateCanvasLayer()
+	{
+		const auto pImGuiNode = GetGlobals().m_pImGuiNode;
+		if (!pImGuiNode || !m_pCanvasDrawList)
+			return;
+
+		if (!m_pCanvasLayer)
+			m_pCanvasLayer = &pImGuiNode->createRetainedLayer();
+
+		// Collect the current state of the canvas.
+		CanvasState state = {};
+		state.m_Panning = ImNodes::EditorContextGetPanning();
+		state.m_LinkCount = m_Links.size();
+		state.m_TextScale = m_TextScale;
+		state.m_SelectedLinkCount = ImNodes::NumSelectedLinks();
+		ImNodes::IsLinkHovered(&state.m_HoveredLink);
+
+		int32_t hoveredNode = -1, hoveredPin = -1;
+		ImNodes::IsNodeHovered(&hoveredNode);
+		ImNodes::IsPinHovered(&hoveredPin);
+
+		// The nodes' hashes cover their contents, and the hover and selection state covers the title bar, the background and
+		// the pins, which ImNodes draws once the node ends.
+		for (uint64_t i = 0; i < m_CanvasNodes.size(); i++)
+		{
+			const auto& node = m_ActiveNodeBuilders[i];
+			const auto isPinOfNode = [hoveredPin](const auto& attribute) { return attribute.m_AttributeID == hoveredPin; };
+
+			auto& canvasNode = m_CanvasNodes[i];
+			const auto position = ImNodes::GetNodeGridSpacePos(node.getID());
+			const auto dimensions = ImNodes::GetNodeDimensions(node.getID());
+			canvasNode.m_X = position.x;
+			canvasNode.m_Y = position.y;
+			canvasNode.m_Width = dimensions.x;
+			canvasNode.m_Height = dimensions.y;
+
+			const std::array<bool, 3> flags = {
+				hoveredNode == node.getID(),
+				ImNodes::IsNodeSelected(node.getID()),
+				hoveredPin != -1 && (std::any_of(node.getInputs().begin(), node.getInputs().end(), isPinOfNode) || std::any_of(node.getOutputs().begin(), node.getOutputs().end(), isPinOfNode))
+			};
+
+			if (!canvasNode.m_IsCulled)
+				canvasNode.m_Hash = HashValue(flags, canvasNode.m_Hash);
+		}
+
+		// Anything which moves or resizes nodes or links redraws the whole canvas. This includes dragging, since links
+		// follow the mouse while they're being created.
+		const auto& previous = m_CanvasState;
+		const auto isDamaged = m_CanvasDamage.update(std::move(m_CanvasNodes));
+		const auto shouldRedraw = isDamaged
+			|| state.m_LinkCount != previous.m_LinkCount
+			|| state.m_TextScale != previous.m_TextScale
+			|| state.m_HoveredLink != previous.m_HoveredLink
+			|| state.m_SelectedLinkCount != previous.m_SelectedLinkCount
+			|| (ImNodes::IsEditorHovered() && ImGui::IsMouseDown(ImGuiMouseButton_Left));
+
+		// Otherwise only the nodes which changed need to be redrawn. Pins stick out of the node, so the areas are expanded to
+		// cover them. The culled nodes can't be redrawn this frame, so the layer needs to know where they are.
+		m_CanvasDirtyAreas.clear();
+		m_CanvasCulledAreas.clear();
+
+		const auto margin = ImNodes::GetStyle().PinHoverRadius + 2.0f;
+		const auto getNodeArea = [margin](const CanvasDamage::Node& node)
+		{
+			const auto position = ImNodes::GetNodeScreenSpacePos(node.m_NodeID);
+			return ImVec4(position.x - margin, position.y - margin, position.x + node.m_Width + margin, position.y + node.m_Height + margin);
+		};
+
+		const auto& canvasNodes = m_CanvasDamage.getNodes();
+		if (!shouldRedraw)
+		{
+			for (const auto index : m_CanvasDamage.getDamagedNodes())
+				m_CanvasDirtyAreas.emplace_back(getNodeArea(canvasNodes[index]));
+		}
+
+		for (const auto& node : canvasNodes)
+		{
+			if (node.m_IsCulled)
+				m_CanvasCulledAreas.emplace_back(getNodeArea(node));
+		}
+
+		// The mini map stays in place while panning, and reacts to the mouse, so redraw it whenever anything else changes.
+		const auto canvasWidth = m_CanvasMaximum.x - m_CanvasMinimum.x;
+		const auto canvasHeight = m_CanvasMaximum.y - m_CanvasMinimum.y;
+		const auto miniMapSize = std::max(canvasWidth, canvasHeight) * MiniMapSizeFraction + ImNodes::GetStyle().MiniMapPadding.x + ImNodes::GetStyle().MiniMapPadding.y;
+		const ImVec4 miniMapArea = { std::max(m_CanvasMaximum.x - miniMapSize, m_CanvasMinimum.x), std::max(m_CanvasMaximum.y - miniMapSize, m_CanvasMinimum.y), m_CanvasMaximum.x, m_CanvasMaximum.y };
+
+		const auto& mousePosition = ImGui::GetIO().MousePos;
+		const auto isMiniMapHovered = mousePosition.x >= miniMapArea.x && mousePosition.y >= miniMapArea.y && mousePosition.x < miniMapArea.z && mousePosition.y < miniMapArea.w;
+		if (state.m_Panning.x != previous.m_Panning.x || state.m_Panning.y != previous.m_Panning.y || !m_CanvasDirtyAreas.empty() || isMiniMapHovered)
+			m_CanvasDirtyAreas.emplace_back(miniMapArea);
+
+		if (shouldRedraw)
+			m_pCanvasLayer->invalidate();
+
+		m_pCanvasLayer->submit(*m_pCanvasDrawList, m_CanvasMinimum, m_CanvasMaximum, state.m_Panning, ImGui::GetColorU32(ImGuiCol_WindowBg), m_CanvasDirtyAreas, m_CanvasCulledAreas);
+
+		m_CanvasState = std::move(state);
+		m_pCanvasDrawList = nullptr;
+	}
+
+	void NodeEditor::updateLinks()
+	{
+		if (!m_pLinkRenderer)
+			return;
+
+		const auto& colors = ImNodes::GetStyle().Colors;
+
+		int32_t hoveredLink = -1;
+		ImNodes::IsLinkHovered(&hoveredLink);
+
+		// The links are relative to the canvas' grid origin, so panning doesn't change them.
+		const auto panning = ImNodes::EditorContextGetPanning();
+		const ImVec2 origin = { m_CanvasMinimum.x + panning.x, m_CanvasMinimum.y + panning.y };
+
+		m_pLinkRenderer->clear();
+		m_pLinkRenderer->setOrigin(origin);
+		for (int i = 0; i < m_Links.size(); ++i)
+		{
+			const auto& link = m_Links[i];
+
+			const auto start = m_PinPositions.find(link.first.second);
+			const auto end = m_PinPositions.find(link.second.second);
+			if (start == m_PinPositions.end() || end == m_PinPositions.end())
+				continue;
+
+			// Object properties decide the color, like the attribute's pin.
+			ImU32 color = colors[ImNodesCol_Link], hoveredColor = colors[ImNodesCol_LinkHovered], selectedColor = colors[ImNodesCol_LinkSelected];
+			for (const auto& node : m_ActiveNodeBuilders)
+			{
+				if (node.getID() == link.first.first || node.getID() == link.second.first)
+				{
+					auto prop = node.getAttributeProperty(link.first.second);
+					if (prop < 0)
+						prop = node.getAttributeProperty(link.second.second);
+
+					if (prop == 0)
+					{
+						color = DefaultPublicColor;
+						hoveredColor = selectedColor = DefaultPublicColorHovered;
+					}
+					else if (prop == 1)
+					{
+						color = DefaultPrivateColor;
+						hoveredColor = selectedColor = DefaultPrivateColorHovered;
+					}
+					else if (prop == 2)
+					{
+						color = DefaultProtectedColor;
+						hoveredColor = selectedColor = DefaultProtectedColorHovered;
+					}
+
+					break;
+				}
+			}
+
+			if (hoveredLink == i)
+				color = hoveredColor;
+
+			else if (ImNodes::IsLinkSelected(i))
+				color = selectedColor;
+
+			// The curve always starts at the output pin.
+			auto startPosition = start->second.m_Position, endPosition = end->second.m_Position;
+			if (!start->second.m_IsOutput)
+				std::swap(startPosition, endPosition);
+
+			m_pLinkRenderer->addLink(ImVec2(startPosition.x - origin.x, startPosition.y - origin.y), ImVec2(endPosition.x - origin.x, endPosition.y - origin.y), color);
+		}
+
+		const auto& style = ImNodes::GetStyle();
+		m_pLinkRenderer->upload(style.LinkThickness, style.LinkLineSegmentsPerLength);
+	}
+}
@@ -4,8 +4,13 @@
 
 #include "Components/Defaults.hpp"
 #include "UIComponent.hpp"
+#include "Backend/RetainedLayer.hpp"
+#include "Backend/LinkRenderer.hpp"
+
+#include "Core/CanvasDamage.hpp"
 
 #include <vector>
+#include <unordered_map>
 #include <array>
 #include <filesystem>
 #include <nlohmann/json.hpp>
@@ -25,6 +30,16 @@ namespace rapid
 		Function
 	};
 
+	/**
+	 * Pin position structure.
+	 * This is used to draw the links without ImNodes.
+	 */
+	struct PinPosition final
+	{
+		ImVec2 m_Position = {};
+		bool m_IsOutput = false;
+	};
+
 	/**
 	 * Node builder class.
 	 * This is used to build a new node.
@@ -85,8 +100,14 @@ namespace rapid
 
 		/**
 		 * Show the node to the user.
+		 * The node's contents can be culled when they're already cached. They are still laid out, so the node keeps its size
+		 * and pins, but nothing is drawn for them.
+		 *
+		 * @param pinPositions The pin positions of the node's attributes are stored in this, in screen space.
+		 * @param shouldCull Whether or not to cull the node's contents. Default is false.
+		 * @return The hash of the vertices drawn for the node's contents, relative to the node. This is 0 if they were culled.
 		 */
-		void show() const;
+		uint64_t show(std::unordered_map<int32_t, PinPosition>& pinPositions, bool shouldCull = false) const;
 
 		/**
 		 * Get the node builder's title.
@@ -228,7 +249,45 @@ namespace rapid
 		 */
 		void generateSource() const;
 
+		/**
+		 * Submit the canvas to its retained layer.
+		 * The canvas state is compared with the last frame's to find the areas which need to be redrawn. This needs to be
+		 * called after ending the node editor, and before ending the window.
+		 */
+		void updateCanvasLayer();
+
+		/**
+		 * Submit the links to the link renderer.
+		 * This needs to be called after ending the node editor, so the hovered and selected links are known.
+		 */
+		void updateLinks();
+
 	private:
+		/**
+		 * Canvas state structure.
+		 * This stores everything which affects how the canvas is drawn.
+		 */
+		struct CanvasState final
+		{
+			ImVec2 m_Panning = {};
+			uint64_t m_LinkCount = 0;
+			float m_TextScale = 1.0f;
+			int32_t m_HoveredLink = -1;
+			int32_t m_SelectedLinkCount = 0;
+		};
+
+		CanvasState m_CanvasState = {};
+		CanvasDamage m_CanvasDamage = {};
+		std::vector<CanvasDamage::Node> m_CanvasNodes = {};
+		std::vector<ImVec4> m_CanvasDirtyAreas = {};
+		std::vector<ImVec4> m_CanvasCulledAreas = {};
+		RetainedLayer* m_pCanvasLayer = nullptr;
+		LinkRenderer* m_pLinkRenderer = nullptr;
+		std::unordered_map<int32_t, PinPosition> m_PinPositions = {};
+		ImDrawList* m_pCanvasDrawList = nullptr;
+		ImVec2 m_CanvasMinimum = {};
+		ImVec2 m_CanvasMaximum = {};
+
 		nlohmann::json m_JsonDocument;
 
 		char m_NewNodeNameBuffer[MaximumStringLength] = "";
@@ -256,6 +315,8 @@ namespace rapid
 		int32_t m_NodeID = 0;
 		int32_t m_NodeAttributeID = 0;
 
+		float m_TextScale = 1.0f;
+
 		bool m_ShouldCreateMemberVariable = false;
 		bool m_ShouldCreateMemberFunction = false;
 		bool m_ShouldCreateFunction = false;
@@ -0,0 +1,124 @@
+// Copyright (c) 2022 Dhiraj Wishal
+
+#include "ProfilerPanel.hpp"
+#include "Globals.hpp"
+#include "Console.hpp"
+
+#include "Backend/Window.hpp"
+
+#include <imgui.h>
+
+#include <vector>
+
+namespace
+{
+	/**
+	 * The file the traces are exported to.
+	 */
+	constexpr const char* TraceFile = "RapidTrace.json";
+}
+
+namespace rapid
+{
+	ProfilerPanel::ProfilerPanel()
+		: UIComponent("GPU Profiler")
+	{
+	}
+
+	void ProfilerPanel::begin()
+	{
+		ImGui::Begin(m_Title.c_str(), &GetGlobals().m_ShowProfilerPanel);
+
+		const auto pWindow = GetGlobals().m_pWindow;
+		if (!pWindow)
+		{
+			ImGui::TextUnformatted("There's no window to profile.");
+			return;
+		}
+
+		auto& profiler = pWindow->getGpuProfiler();
+		if (!profiler.isSupported())
+		{
+			ImGui::TextUnformatted("The device doesn't support timestamp queries.");
+			return;
+		}
+
+		auto isEnabled = profiler.isEnabled();
+		if (ImGui::Checkbox("Profile", &isEnabled))
+			profiler.setEnabled(isEnabled);
+
+		ImGui::SameLine();
+		if (ImGui::Button("Export trace"))
+		{
+			if (profiler.exportTrace(TraceFile))
+				GetConsole().log(std::string("Exported the trace to ") + TraceFile + ".", Severity::Info);
+
+			else
+				GetConsole().log(std::string("Failed to export the trace to ") + TraceFile + "!", Severity::Error);
+		}
+
+		showScopes(profiler);
+	}
+
+	void ProfilerPanel::end()
+	{
+		ImGui::End();
+	}
+
+	void ProfilerPanel::showScopes(const GpuProfiler& profiler) const
+	{
+		const auto results = profiler.getResults();
+		if (results.empty())
+		{
+			ImGui::TextUnformatted("No frames were measured yet.");
+			return;
+		}
+
+		// The scopes are listed in the order of the latest frame. Scopes with the same name and depth are combined.
+		const auto scopeSummaries = SummarizeScopes(results);
+
+		ImGui::Text("%zu frames, the latest is frame %llu.", results.size(), static_cast<unsigned long long>(results.back().m_FrameNumber));
+
+		if (!ImGui::BeginTable("Scopes", 5, ImGuiTableFlags_RowBg | ImGuiTableFlags_BordersInnerV))
+			return;
+
+		ImGui::TableSetupColumn("Scope");
+		ImGui::TableSetupColumn("Average (ms)");
+		ImGui::TableSetupColumn("Max (ms)");
+		ImGui::TableSetupColumn("Primitives");
+		ImGui::TableSetupColumn("Fragments");
+		ImGui::TableHeadersRow();
+
+		for (const auto& summary : scopeSummaries)
+		{
+			ImGui::TableNextRow();
+			ImGui::TableNextColumn();
+			// Nested scopes are indented under their parents.
+			const auto indent = static_cast<float>(summary.m_Depth) * ImGui::GetStyle().IndentSpacing;
+			if (indent > 0.0f)
+				ImGui::Indent(indent);
+
+			ImGui::TextUnformatted(summary.m_Name.data(), summary.m_Name.data() + summary.m_Name.size());
+
+			if (indent > 0.0f)
+				ImGui::Unindent(indent);
+
+			ImGui::TableNextColumn();
+			ImGui::Text("%.3f", summary.m_Average);
+
+			ImGui::TableNextColumn();
+			ImGui::Text("%.3f", summary.m_Max);
+
+			// The pipeline statistics are from the latest frame which has them.
+			ImGui::TableNextColumn();
+			if (summary.m_HasPipelineStatistics)
+				ImGui::Text("%llu", static_cast<unsigned long long>(summary.m_PipelineStatistics.m_InputPrimitives));
+
+			ImGui::TableNextColumn();
+			if (summary.m_HasPipelineStatistics)
+				ImGui::Text("%llu", static_cast<unsigned long long>(summary.m_PipelineStatistics.m_FragmentShaderInvocations));
+		}
+
+		ImGui::EndTable();
+	}
+}
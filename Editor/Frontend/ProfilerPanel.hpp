@@ -0,0 +1,42 @@
+// Copyright (c) 2022 Dhiraj Wishal
+
+#pragma once
+
+#include "UIComponent.hpp"
+
+namespace rapid
+{
+	class GpuProfiler;
+
+	/**
+	 * Profiler panel class.
+	 * This shows how long the GPU spends on each pass and node, averaged over the recent frames, and exports the recent
+	 * frames as a trace.
+	 */
+	class ProfilerPanel final : public UIComponent
+	{
+	public:
+		/**
+		 * Default constructor.
+		 */
+		ProfilerPanel();
+
+		/**
+		 * Begin the stack.
+		 */
+		void begin() override;
+
+		/**
+		 * End the stack.
+		 */
+		void end() override;
+
+	private:
+		/**
+		 * Show the scopes of the recent frames.
+		 *
+		 * @param profiler The profiler.
+		 */
+		void showScopes(const GpuProfiler& profiler) const;
+	};
+}
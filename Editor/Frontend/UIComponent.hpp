@@ -4,6 +4,8 @@
 
 #include <string>
 
+#include <SDL_events.h>
+
 namespace rapid
 {
 	/**
@@ -33,6 +35,18 @@ namespace rapid
 		 */
 		virtual void end() = 0;
 
+		/**
+		 * Invalidate the component.
+		 * This wakes up the window if it's idling, so the component's new content gets rendered.
+		 * Note that this is safe to be called from any thread.
+		 */
+		void invalidate() const
+		{
+			SDL_Event sdlEvent = {};
+			sdlEvent.type = SDL_USEREVENT;
+			SDL_PushEvent(&sdlEvent);
+		}
+
 	protected:
 		std::string m_Title;
 	};
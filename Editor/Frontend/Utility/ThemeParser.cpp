@@ -2,6 +2,7 @@
 
 #include "ThemeParser.hpp"
 #include "../Console.hpp"
+#include "../Globals.hpp"
 
 #include <imgui.h>
 #include <nlohmann/json.hpp>
@@ -181,14 +182,25 @@ namespace rapid
 			return;
 
 		// Parse the document.
-		nlohmann::json document;
-		document.parse(content.c_str());
+		const auto document = nlohmann::json::parse(content, nullptr, false);
+		if (document.is_discarded() || !document.is_object())
+		{
+			GetConsole().log("Failed to parse the theme file!", Severity::Warning);
+			return;
+		}
 
 		auto& styles = ImGui::GetStyle();
 
 		// Iterate over the members and get the values.
 		for (auto memberItr = document.begin(); memberItr != document.end(); ++memberItr)
 		{
+			// Try and parse font. The font atlas is rebuilt in the background, so this won't stall the UI.
+			if (memberItr.key() == "Font" && memberItr->is_array() && memberItr->size() == 2 && memberItr->at(0).is_string() && memberItr->at(1).is_number())
+			{
+				const auto fontFile = ResolvePath(memberItr->at(0).get<std::string>(), themeFile.parent_path());
+				GetGlobals().m_FontRequests.emplace_back(fontFile, memberItr->at(1).get<float>());
+			}
+
 			//// Try and parse the colors.
 			//if (memberItr->name == "Colors")
 			//{
@@ -208,14 +220,6 @@ namespace rapid
 			//// Try and parse alpha.
 			//else if (memberItr->name == "DisabledAlpha")
 			//	styles.DisabledAlpha = memberItr->value.IsFloat() ? memberItr->value.GetFloat() : memberItr->value.IsInt() ? memberItr->value.GetInt() : styles.DisabledAlpha;
-			//
-			//// Try and parse font.
-			//else if (memberItr->name == "Font" && memberItr->value.Size() == 2)
-			//{
-			//	const auto& fontData = memberItr->value;
-			//	const auto fontFile = ResolvePath(fontData[0].GetString(), themeFile.parent_path());
-			//	ImGui::GetIO().Fonts->AddFontFromFileTTF(fontFile.string().c_str(), fontData[1].GetFloat());
-			//}
 		}
 	}
 }
@@ -0,0 +1,58 @@
+// Copyright (c) 2022 Dhiraj Wishal
+
+#include "Test.hpp"
+
+#include "Core/AllocationCounter.hpp"
+
+#include <new>
+
+namespace
+{
+	/**
+	 * Aligned structure.
+	 * This is aligned more than the default, so it goes through the aligned operator new.
+	 */
+	struct alignas(64) Aligned final
+	{
+		uint8_t m_Data[64] = {};
+	};
+
+	/**
+	 * Check that an allocation is counted.
+	 *
+	 * @tparam Function The function type.
+	 * @param function The function which allocates and frees the memory.
+	 * @param bytes The number of bytes it allocates.
+	 */
+	template<class Function>
+	void CheckCounted(Function&& function, uint64_t bytes)
+	{
+		const auto start = rapid::GetAllocationStatistics();
+		function();
+		const auto end = rapid::GetAllocationStatistics();
+
+		RAPID_CHECK(end.m_AllocationCount - start.m_AllocationCount == 1);
+		RAPID_CHECK(end.m_AllocatedBytes - start.m_AllocatedBytes == bytes);
+	}
+}
+
+int main()
+{
+	RAPID_CHECK(rapid::IsAllocationCountingEnabled);
+
+	// The volatile pointers keep the allocations from being optimized out.
+	CheckCounted([] { int* volatile pValue = new int(1); delete pValue; }, sizeof(int));
+	CheckCounted([] { int* volatile pValues = new int[16]; delete[] pValues; }, sizeof(int) * 16);
+	CheckCounted([] { int* volatile pValue = new(std::nothrow) int(1); delete pValue; }, sizeof(int));
+	CheckCounted([] { int* volatile pValues = new(std::nothrow) int[16]; delete[] pValues; }, sizeof(int) * 16);
+
+	CheckCounted([] { Aligned* volatile pValue = new Aligned(); RAPID_CHECK(reinterpret_cast<uintptr_t>(pValue) % alignof(Aligned) == 0); delete pValue; }, sizeof(Aligned));
+	CheckCounted([] { Aligned* volatile pValues = new Aligned[4]; RAPID_CHECK(reinterpret_cast<uintptr_t>(pValues) % alignof(Aligned) == 0); delete[] pValues; }, sizeof(Aligned) * 4);
+	CheckCounted([] { Aligned* volatile pValue = new(std::nothrow) Aligned(); RAPID_CHECK(reinterpret_cast<uintptr_t>(pValue) % alignof(Aligned) == 0); delete pValue; }, sizeof(Aligned));
+
+	// Odd sizes still need to be aligned.
+	CheckCounted([] { void* volatile pMemory = ::operator new(3, std::align_val_t(256)); RAPID_CHECK(reinterpret_cast<uintptr_t>(pMemory) % 256 == 0); ::operator delete(pMemory, 3, std::align_val_t(256)); }, 3);
+	CheckCounted([] { void* volatile pMemory = ::operator new(0); ::operator delete(pMemory); }, 0);
+
+	return rapid::test::GetExitCode();
+}
\ No newline at end of file
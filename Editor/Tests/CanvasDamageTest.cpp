@@ -0,0 +1,143 @@
+// Copyright (c) 2022 Dhiraj Wishal
+
+#include "Test.hpp"
+
+#include "Core/CanvasDamage.hpp"
+
+#include <vector>
+
+namespace
+{
+	/**
+	 * Create the nodes of a frame.
+	 * The nodes are placed in a row, and each node's hash is its index unless it's overridden.
+	 *
+	 * @param count The number of nodes.
+	 * @return The nodes.
+	 */
+	std::vector<rapid::CanvasDamage::Node> CreateNodes(int32_t count)
+	{
+		std::vector<rapid::CanvasDamage::Node> nodes;
+		for (int32_t i = 0; i < count; i++)
+		{
+			nodes.emplace_back(rapid::CanvasDamage::Node{
+				.m_X = static_cast<float>(i) * 100.0f,
+				.m_Y = 0.0f,
+				.m_Width = 80.0f,
+				.m_Height = 40.0f,
+				.m_Hash = static_cast<uint64_t>(i),
+				.m_NodeID = i
+				});
+		}
+
+		return nodes;
+	}
+
+	/**
+	 * Check that structural changes damage the whole canvas.
+	 */
+	void CheckStructuralChanges()
+	{
+		auto damage = rapid::CanvasDamage();
+
+		// The first frame has nothing to compare against.
+		RAPID_CHECK(damage.update(CreateNodes(3)));
+		RAPID_CHECK(damage.getDamagedNodes().empty());
+		RAPID_CHECK(!damage.isStable(0, 0));
+
+		// Nothing changed.
+		RAPID_CHECK(!damage.update(CreateNodes(3)));
+		RAPID_CHECK(damage.getDamagedNodes().empty());
+		RAPID_CHECK(damage.isStable(0, 0) && damage.isStable(2, 2));
+		RAPID_CHECK(!damage.isStable(3, 3) && !damage.isStable(1, 2));
+
+		// Adding a node.
+		RAPID_CHECK(damage.update(CreateNodes(4)));
+		RAPID_CHECK(!damage.update(CreateNodes(4)));
+
+		// Moving a node.
+		auto nodes = CreateNodes(4);
+		nodes[1].m_X += 1.0f;
+		RAPID_CHECK(damage.update(std::move(nodes)));
+
+		// Resizing a node.
+		nodes = CreateNodes(4);
+		nodes[2].m_Height += 1.0f;
+		RAPID_CHECK(damage.update(std::move(nodes)));
+
+		// Reordering the nodes.
+		nodes = CreateNodes(4);
+		std::swap(nodes[0].m_NodeID, nodes[3].m_NodeID);
+		RAPID_CHECK(damage.update(std::move(nodes)));
+		RAPID_CHECK(!damage.isStable(0, 3));
+
+		// Resetting.
+		damage.reset();
+		RAPID_CHECK(damage.update(CreateNodes(4)));
+	}
+
+	/**
+	 * Check that content changes only damage the node which changed.
+	 */
+	void CheckContentChanges()
+	{
+		auto damage = rapid::CanvasDamage();
+		damage.update(CreateNodes(4));
+		damage.update(CreateNodes(4));
+
+		auto nodes = CreateNodes(4);
+		nodes[2].m_Hash = 42;
+		RAPID_CHECK(!damage.update(std::move(nodes)));
+		RAPID_CHECK(damage.getDamagedNodes() == std::vector<uint64_t>{ 2 });
+		RAPID_CHECK(damage.isStable(1, 1) && !damage.isStable(2, 2));
+
+		// Changing back is a change as well.
+		RAPID_CHECK(!damage.update(CreateNodes(4)));
+		RAPID_CHECK(damage.getDamagedNodes() == std::vector<uint64_t>{ 2 });
+
+		// And once it stops changing, it becomes stable again.
+		RAPID_CHECK(!damage.update(CreateNodes(4)));
+		RAPID_CHECK(damage.getDamagedNodes().empty());
+		RAPID_CHECK(damage.isStable(2, 2));
+	}
+
+	/**
+	 * Check that culled nodes keep their last hash.
+	 */
+	void CheckCulledNodes()
+	{
+		auto damage = rapid::CanvasDamage();
+		damage.update(CreateNodes(3));
+		damage.update(CreateNodes(3));
+
+		// Culled nodes don't have a hash, but they aren't damaged.
+		auto nodes = CreateNodes(3);
+		nodes[0].m_IsCulled = true;
+		nodes[0].m_Hash = 0xdead;
+		nodes[1].m_IsCulled = true;
+		nodes[1].m_Hash = 0;
+		RAPID_CHECK(!damage.update(std::move(nodes)));
+		RAPID_CHECK(damage.getDamagedNodes().empty());
+		RAPID_CHECK(damage.getNodes()[0].m_Hash == 0 && damage.getNodes()[1].m_Hash == 1);
+
+		// When they're drawn again, they're compared with the hash they were last drawn with.
+		RAPID_CHECK(!damage.update(CreateNodes(3)));
+		RAPID_CHECK(damage.getDamagedNodes().empty());
+
+		// The hash is kept through a full damage, as long as the node is in the same place in the list.
+		nodes = CreateNodes(4);
+		nodes[1].m_IsCulled = true;
+		nodes[1].m_Hash = 0;
+		RAPID_CHECK(damage.update(std::move(nodes)));
+		RAPID_CHECK(damage.getNodes()[1].m_Hash == 1);
+	}
+}
+
+int main()
+{
+	CheckStructuralChanges();
+	CheckContentChanges();
+	CheckCulledNodes();
+
+	return rapid::test::GetExitCode();
+}
\ No newline at end of file
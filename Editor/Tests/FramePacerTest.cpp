@@ -0,0 +1,190 @@
+// Copyright (c) 2022 Dhiraj Wishal
+
+#include "Test.hpp"
+
+#include "Core/FramePacer.hpp"
+
+#include <chrono>
+#include <cmath>
+
+namespace
+{
+	/**
+	 * Check if an interval is the one of a frame rate, allowing for the rounding of the clock.
+	 *
+	 * @param interval The interval.
+	 * @param frameRate The expected frame rate.
+	 * @return Whether or not the interval matches.
+	 */
+	bool IsInterval(rapid::FramePacer::clock_type::duration interval, double frameRate)
+	{
+		const auto seconds = std::chrono::duration<double>(interval).count();
+		return std::abs(seconds - 1.0 / frameRate) < 1e-6;
+	}
+
+	/**
+	 * Check the percentiles of the frame time history.
+	 */
+	void CheckHistory()
+	{
+		// Nothing to summarize yet.
+		{
+			const auto summary = rapid::FrameTimeHistory(8).summarize();
+			RAPID_CHECK(summary.m_Median == 0.0 && summary.m_Percentile99 == 0.0 && summary.m_Maximum == 0.0);
+		}
+
+		// A single frame is every percentile.
+		{
+			auto history = rapid::FrameTimeHistory(8);
+			history.add(16.0);
+
+			const auto summary = history.summarize();
+			RAPID_CHECK(summary.m_Median == 16.0 && summary.m_Percentile99 == 16.0 && summary.m_Maximum == 16.0);
+		}
+
+		// The percentiles use the nearest rank, and don't depend on the order the frames were added in.
+		{
+			auto history = rapid::FrameTimeHistory(100);
+			for (int32_t i = 0; i < 100; i++)
+				history.add(static_cast<double>((i * 37) % 100 + 1));
+
+			const auto summary = history.summarize();
+			RAPID_CHECK(summary.m_Median == 51.0);
+			RAPID_CHECK(summary.m_Percentile99 == 99.0);
+			RAPID_CHECK(summary.m_Maximum == 100.0);
+		}
+
+		// A single slow frame shows up in the 99th percentile, but not in the median.
+		{
+			auto history = rapid::FrameTimeHistory(240);
+			for (int32_t i = 0; i < 239; i++)
+				history.add(16.0);
+
+			history.add(50.0);
+
+			const auto summary = history.summarize();
+			RAPID_CHECK(summary.m_Median == 16.0);
+			RAPID_CHECK(summary.m_Percentile99 == 16.0);
+			RAPID_CHECK(summary.m_Maximum == 50.0);
+
+			// Three slow frames are more than 1% of them.
+			history.add(40.0);
+			history.add(45.0);
+
+			const auto slowSummary = history.summarize();
+			RAPID_CHECK(slowSummary.m_Percentile99 == 40.0);
+			RAPID_CHECK(slowSummary.m_Maximum == 50.0);
+		}
+
+		// Old frames are replaced once the history is full.
+		{
+			auto history = rapid::FrameTimeHistory(4);
+			for (int32_t i = 1; i <= 6; i++)
+				history.add(static_cast<double>(i * 10));
+
+			RAPID_CHECK(history.size() == 4);
+
+			const auto summary = history.summarize();
+			RAPID_CHECK(summary.m_Median == 50.0);
+			RAPID_CHECK(summary.m_Maximum == 60.0);
+
+			// The oldest frames go first, so the slow ones age out.
+			for (int32_t i = 0; i < 4; i++)
+				history.add(1.0);
+
+			RAPID_CHECK(history.summarize().m_Maximum == 1.0);
+		}
+	}
+
+	/**
+	 * Check the intervals the pacer waits for.
+	 */
+	void CheckInterval()
+	{
+		using Activity = rapid::FramePacer::Activity;
+
+		// Nothing is limited without a target or a refresh rate.
+		{
+			const auto pacer = rapid::FramePacer();
+			RAPID_CHECK(pacer.getInterval() == rapid::FramePacer::clock_type::duration::zero());
+		}
+
+		// The target is used as it is if the refresh rate is unknown.
+		RAPID_CHECK(IsInterval(rapid::FramePacer(100.0).getInterval(), 100.0));
+
+		// A target of 0 follows the refresh rate, and faster targets are limited to it.
+		{
+			auto pacer = rapid::FramePacer();
+			pacer.setRefreshRate(60.0);
+			RAPID_CHECK(IsInterval(pacer.getInterval(), 60.0));
+
+			pacer.setTargetFrameRate(240.0);
+			RAPID_CHECK(IsInterval(pacer.getInterval(), 60.0));
+		}
+
+		// Slower targets are rounded to a whole number of refresh intervals.
+		{
+			auto pacer = rapid::FramePacer(25.0);
+			pacer.setRefreshRate(144.0);
+			RAPID_CHECK(IsInterval(pacer.getInterval(), 24.0));
+
+			pacer.setTargetFrameRate(50.0);
+			pacer.setRefreshRate(60.0);
+			RAPID_CHECK(IsInterval(pacer.getInterval(), 60.0));
+		}
+
+		// The background policy only lowers the frame rate.
+		{
+			auto pacer = rapid::FramePacer();
+			pacer.setRefreshRate(60.0);
+
+			pacer.setActivity(Activity::Unfocused);
+			RAPID_CHECK(IsInterval(pacer.getInterval(), 30.0));
+
+			pacer.setActivity(Activity::Minimized);
+			RAPID_CHECK(IsInterval(pacer.getInterval(), 4.0));
+
+			pacer.setTargetFrameRate(2.0);
+			RAPID_CHECK(IsInterval(pacer.getInterval(), 2.0));
+
+			// A background frame rate of 0 doesn't throttle.
+			pacer.setTargetFrameRate(0.0);
+			pacer.setBackgroundPolicy({ .m_UnfocusedFrameRate = 0.0, .m_MinimizedFrameRate = 0.0 });
+			RAPID_CHECK(IsInterval(pacer.getInterval(), 60.0));
+
+			pacer.setActivity(Activity::Focused);
+			RAPID_CHECK(IsInterval(pacer.getInterval(), 60.0));
+		}
+	}
+
+	/**
+	 * Check that the pacer keeps a frame rate.
+	 * The frames are only checked to not be faster than the target, as the machine could be busy.
+	 */
+	void CheckPacing()
+	{
+		auto pacer = rapid::FramePacer(200.0);
+
+		const auto start = rapid::FramePacer::clock_type::now();
+		for (uint32_t i = 0; i <= 20; i++)
+			pacer.wait();
+
+		// The first wait only starts the deadlines.
+		const auto elapsed = std::chrono::duration<double>(rapid::FramePacer::clock_type::now() - start).count();
+		RAPID_CHECK(elapsed >= 20.0 / 200.0 - 1e-3);
+
+		const auto statistics = pacer.getStatistics();
+		RAPID_CHECK(std::abs(statistics.m_TargetFrameTime - 5.0) < 1e-3);
+		RAPID_CHECK(statistics.m_MaxFrameTime >= statistics.m_Percentile99FrameTime);
+		RAPID_CHECK(statistics.m_Percentile99FrameTime >= statistics.m_MedianFrameTime);
+	}
+}
+
+int main()
+{
+	CheckHistory();
+	CheckInterval();
+	CheckPacing();
+
+	return rapid::test::GetExitCode();
+}
\ No newline at end of file
@@ -0,0 +1,63 @@
+// Copyright (c) 2022 Dhiraj Wishal
+
+#include "Test.hpp"
+
+#include "Core/LinkSegments.hpp"
+
+#include <limits>
+
+namespace
+{
+	/**
+	 * Check the segment counts of links of ordinary lengths.
+	 * The count is rounded up, so a link is never drawn with fewer segments than it asked for.
+	 */
+	void CheckRounding()
+	{
+		RAPID_CHECK(rapid::GetLinkSegmentCount(100.0f, 0.1f) == 10);
+		RAPID_CHECK(rapid::GetLinkSegmentCount(101.0f, 0.1f) == 11);
+		RAPID_CHECK(rapid::GetLinkSegmentCount(5.0f, 1.0f) == 5);
+		RAPID_CHECK(rapid::GetLinkSegmentCount(63.5f, 1.0f) == 64);
+	}
+
+	/**
+	 * Check that the segment counts stay between 1 and the maximum.
+	 */
+	void CheckLimits()
+	{
+		// There's always at least one segment, even without links.
+		RAPID_CHECK(rapid::GetLinkSegmentCount(0.0f, 0.1f) == 1);
+		RAPID_CHECK(rapid::GetLinkSegmentCount(100.0f, 0.0f) == 1);
+		RAPID_CHECK(rapid::GetLinkSegmentCount(100.0f, -1.0f) == 1);
+		RAPID_CHECK(rapid::GetLinkSegmentCount(0.25f, 1.0f) == 1);
+
+		RAPID_CHECK(rapid::GetLinkSegmentCount(1000.0f, 1.0f) == rapid::MaximumLinkSegmentCount);
+
+		// Counts which don't fit in 32 bits are clamped before they're converted.
+		RAPID_CHECK(rapid::GetLinkSegmentCount(std::numeric_limits<float>::max(), 1.0f) == rapid::MaximumLinkSegmentCount);
+		RAPID_CHECK(rapid::GetLinkSegmentCount(1e10f, 1e10f) == rapid::MaximumLinkSegmentCount);
+	}
+
+	/**
+	 * Check the lengths which are not finite.
+	 */
+	void CheckNonFinite()
+	{
+		const auto infinity = std::numeric_limits<float>::infinity();
+		const auto nan = std::numeric_limits<float>::quiet_NaN();
+
+		RAPID_CHECK(rapid::GetLinkSegmentCount(infinity, 0.1f) == rapid::MaximumLinkSegmentCount);
+		RAPID_CHECK(rapid::GetLinkSegmentCount(infinity, 0.0f) == rapid::MaximumLinkSegmentCount);
+		RAPID_CHECK(rapid::GetLinkSegmentCount(nan, 0.1f) == rapid::MaximumLinkSegmentCount);
+		RAPID_CHECK(rapid::GetLinkSegmentCount(100.0f, nan) == rapid::MaximumLinkSegmentCount);
+	}
+}
+
+int main()
+{
+	CheckRounding();
+	CheckLimits();
+	CheckNonFinite();
+
+	return rapid::test::GetExitCode();
+}
\ No newline at end of file
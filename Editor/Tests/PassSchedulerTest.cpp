@@ -0,0 +1,210 @@
+// Copyright (c) 2022 Dhiraj Wishal
+
+#include "Test.hpp"
+
+#include "Core/PassScheduler.hpp"
+
+#include <vector>
+
+namespace
+{
+	constexpr uint32_t ColorAttachment = 0;
+	constexpr uint32_t Sampled = 1;
+	constexpr uint32_t TransferSource = 2;
+
+	/**
+	 * Check the culling.
+	 * Passes are kept if they write to an imported resource, have side effects, or produce something a kept pass uses.
+	 */
+	void CheckCulling()
+	{
+		auto scheduler = rapid::PassScheduler();
+		const auto swapchain = scheduler.addResource(false);
+		const auto used = scheduler.addResource(true);
+		const auto unused = scheduler.addResource(true);
+
+		// Only writes a transient image which nothing reads.
+		const auto deadPass = scheduler.addPass();
+		scheduler.addAccess(deadPass, unused, ColorAttachment, true);
+
+		// Produces an image for the final pass.
+		const auto producerPass = scheduler.addPass();
+		scheduler.addAccess(producerPass, used, ColorAttachment, true);
+
+		// Reads the dead pass' output, but doesn't write anything that's used.
+		const auto deadReaderPass = scheduler.addPass();
+		scheduler.addAccess(deadReaderPass, unused, Sampled, false);
+
+		// Writes nothing, but has side effects.
+		const auto sideEffectPass = scheduler.addPass();
+		scheduler.setSideEffects(sideEffectPass);
+
+		const auto finalPass = scheduler.addPass();
+		scheduler.addAccess(finalPass, used, Sampled, false);
+		scheduler.addAccess(finalPass, swapchain, ColorAttachment, true);
+
+		const auto order = scheduler.schedule();
+		RAPID_CHECK(scheduler.getPass(deadPass).m_IsCulled);
+		RAPID_CHECK(scheduler.getPass(deadReaderPass).m_IsCulled);
+		RAPID_CHECK(!scheduler.getPass(producerPass).m_IsCulled);
+		RAPID_CHECK(!scheduler.getPass(sideEffectPass).m_IsCulled);
+		RAPID_CHECK(!scheduler.getPass(finalPass).m_IsCulled);
+		RAPID_CHECK(order.size() == 3);
+
+		// The culled passes don't make the resources they use live.
+		RAPID_CHECK(!scheduler.getResource(unused).m_IsUsed);
+		RAPID_CHECK(scheduler.getResource(used).m_IsUsed);
+	}
+
+	/**
+	 * Check the grouping and the order.
+	 */
+	void CheckGrouping()
+	{
+		auto scheduler = rapid::PassScheduler();
+		const auto target = scheduler.addResource(false);
+		const auto first = scheduler.addResource(true);
+		const auto second = scheduler.addResource(true);
+
+		// Two independent producers go to the first group.
+		const auto firstProducer = scheduler.addPass();
+		scheduler.addAccess(firstProducer, first, ColorAttachment, true);
+
+		const auto secondProducer = scheduler.addPass();
+		scheduler.addAccess(secondProducer, second, ColorAttachment, true);
+
+		// Two readers of the same image with the same usage share a group, after the producers.
+		const auto firstReader = scheduler.addPass();
+		scheduler.addAccess(firstReader, first, Sampled, false);
+		scheduler.addAccess(firstReader, second, Sampled, false);
+		scheduler.addAccess(firstReader, target, ColorAttachment, true);
+
+		const auto secondReader = scheduler.addPass();
+		scheduler.addAccess(secondReader, first, Sampled, false);
+		scheduler.setSideEffects(secondReader);
+
+		// A read with another usage depends on the reads before it.
+		const auto copyPass = scheduler.addPass();
+		scheduler.addAccess(copyPass, first, TransferSource, false);
+		scheduler.setSideEffects(copyPass);
+
+		// And a write depends on everything before it.
+		const auto writePass = scheduler.addPass();
+		scheduler.addAccess(writePass, first, ColorAttachment, true);
+		scheduler.addAccess(writePass, target, ColorAttachment, true);
+
+		const auto order = scheduler.schedule();
+		RAPID_CHECK(scheduler.getPass(firstProducer).m_Group == 0);
+		RAPID_CHECK(scheduler.getPass(secondProducer).m_Group == 0);
+		RAPID_CHECK(scheduler.getPass(firstReader).m_Group == 1);
+		RAPID_CHECK(scheduler.getPass(secondReader).m_Group == 1);
+		RAPID_CHECK(scheduler.getPass(copyPass).m_Group == 2);
+		RAPID_CHECK(scheduler.getPass(writePass).m_Group == 3);
+		RAPID_CHECK(scheduler.getGroupCount() == 4);
+		RAPID_CHECK((order == std::vector<uint32_t>{ firstProducer, secondProducer, firstReader, secondReader, copyPass, writePass }));
+
+		RAPID_CHECK(scheduler.getResource(first).m_FirstGroup == 0 && scheduler.getResource(first).m_LastGroup == 3);
+		RAPID_CHECK(scheduler.getResource(second).m_FirstGroup == 0 && scheduler.getResource(second).m_LastGroup == 1);
+
+		// Passes added later can run before earlier ones if they don't depend on them.
+		scheduler.clear();
+		const auto image = scheduler.addResource(false);
+		const auto other = scheduler.addResource(false);
+
+		const auto writer = scheduler.addPass();
+		scheduler.addAccess(writer, image, ColorAttachment, true);
+
+		const auto reader = scheduler.addPass();
+		scheduler.addAccess(reader, image, Sampled, false);
+		scheduler.setSideEffects(reader);
+
+		const auto independent = scheduler.addPass();
+		scheduler.addAccess(independent, other, ColorAttachment, true);
+
+		RAPID_CHECK((scheduler.schedule() == std::vector<uint32_t>{ writer, independent, reader }));
+	}
+
+	/**
+	 * Check the access rules.
+	 */
+	void CheckAccesses()
+	{
+		auto scheduler = rapid::PassScheduler();
+		const auto resource = scheduler.addResource(false);
+		const auto pass = scheduler.addPass();
+
+		RAPID_CHECK(scheduler.addAccess(pass, resource, Sampled, false));
+		RAPID_CHECK(!scheduler.addAccess(pass, resource, ColorAttachment, true));
+		RAPID_CHECK(scheduler.addAccess(pass, resource, Sampled, true));
+		RAPID_CHECK(scheduler.getPass(pass).m_Accesses.size() == 1 && scheduler.getPass(pass).m_Accesses.front().m_IsWrite);
+	}
+
+	/**
+	 * Check the memory aliasing.
+	 * The images form a chain: each one is written from the previous one, so the first and the third don't overlap.
+	 */
+	void CheckAliasing()
+	{
+		auto scheduler = rapid::PassScheduler();
+		const auto target = scheduler.addResource(false);
+		const std::vector<uint32_t> images = { scheduler.addResource(true), scheduler.addResource(true), scheduler.addResource(true), scheduler.addResource(true) };
+
+		for (uint64_t i = 0; i < images.size(); i++)
+		{
+			const auto pass = scheduler.addPass();
+			if (i > 0)
+				scheduler.addAccess(pass, images[i - 1], Sampled, false);
+
+			scheduler.addAccess(pass, images[i], ColorAttachment, true);
+		}
+
+		const auto finalPass = scheduler.addPass();
+		scheduler.addAccess(finalPass, images.back(), Sampled, false);
+		scheduler.addAccess(finalPass, target, ColorAttachment, true);
+		scheduler.schedule();
+
+		// Image i lives from group i to group i + 1, so images two apart can share memory.
+		std::vector<rapid::MemoryRequirement> requirements = {
+			{.m_Size = 1024, .m_Alignment = 256, .m_TypeBits = 0b11 },
+			{.m_Size = 2048, .m_Alignment = 256, .m_TypeBits = 0b11 },
+			{.m_Size = 4096, .m_Alignment = 1024, .m_TypeBits = 0b01 },
+			{.m_Size = 512, .m_Alignment = 256, .m_TypeBits = 0b10 }
+		};
+
+		std::vector<uint32_t> blockIndexes;
+		auto blocks = scheduler.aliasMemory(images, requirements, blockIndexes);
+
+		RAPID_CHECK(blocks.size() == 2);
+		RAPID_CHECK((blockIndexes == std::vector<uint32_t>{ 0, 1, 0, 1 }));
+		RAPID_CHECK(blocks[0].m_Size == 4096 && blocks[0].m_Alignment == 1024 && blocks[0].m_TypeBits == 0b01);
+		RAPID_CHECK(blocks[1].m_Size == 2048 && blocks[1].m_Alignment == 256 && blocks[1].m_TypeBits == 0b10);
+
+		// Images with incompatible memory types can't share a block.
+		requirements[3].m_TypeBits = 0b100;
+		blocks = scheduler.aliasMemory(images, requirements, blockIndexes);
+		RAPID_CHECK(blocks.size() == 3);
+		RAPID_CHECK((blockIndexes == std::vector<uint32_t>{ 0, 1, 0, 2 }));
+
+		// Images which are alive at the same time never share memory.
+		for (uint64_t i = 0; i < images.size(); i++)
+		{
+			for (uint64_t j = i + 1; j < images.size(); j++)
+			{
+				const auto& lhs = scheduler.getResource(images[i]);
+				const auto& rhs = scheduler.getResource(images[j]);
+				if (lhs.m_FirstGroup <= rhs.m_LastGroup && rhs.m_FirstGroup <= lhs.m_LastGroup)
+					RAPID_CHECK(blockIndexes[i] != blockIndexes[j]);
+			}
+		}
+	}
+}
+
+int main()
+{
+	CheckCulling();
+	CheckGrouping();
+	CheckAccesses();
+	CheckAliasing();
+
+	return rapid::test::GetExitCode();
+}
\ No newline at end of file
@@ -0,0 +1,144 @@
+// Copyright (c) 2022 Dhiraj Wishal
+
+#include "Test.hpp"
+
+#include "Core/PixelKernels.hpp"
+
+#include <cstdlib>
+#include <cstring>
+#include <random>
+#include <vector>
+
+namespace
+{
+	/**
+	 * Check a kernel against the scalar one.
+	 * The pixel counts cover every tail length of the widest kernel, and the pixels are offset by a byte so the loads and
+	 * stores are unaligned. Both the out of place and the in place conversions are checked.
+	 *
+	 * @param kernel The kernel to check.
+	 * @param reference The scalar kernel.
+	 * @param pName The kernel's name.
+	 */
+	void CheckKernel(rapid::PixelKernelTable::kernel_type kernel, rapid::PixelKernelTable::kernel_type reference, const char* pName)
+	{
+		constexpr uint64_t PixelCounts[] = { 0, 1, 2, 3, 5, 7, 9, 13, 15, 17, 31, 33, 63, 65, 127, 129, 1023, 1025 };
+
+		auto engine = std::mt19937(1234);
+		auto distribution = std::uniform_int_distribution<uint32_t>(0, 255);
+
+		for (const auto pixelCount : PixelCounts)
+		{
+			const auto size = pixelCount * 4;
+
+			// One extra byte for the offset, and a few more to catch writes past the end.
+			std::vector<uint8_t> source(size + 17);
+			for (auto& value : source)
+				value = static_cast<uint8_t>(distribution(engine));
+
+			// Fully transparent and fully opaque pixels are the edge cases of the premultiplication.
+			if (pixelCount > 2)
+			{
+				source[1 + 3] = 0;
+				source[1 + 7] = 255;
+			}
+
+			auto expected = source;
+			auto result = source;
+			reference(expected.data() + 1, source.data() + 1, pixelCount);
+			kernel(result.data() + 1, source.data() + 1, pixelCount);
+
+			const auto isOutOfPlaceEqual = result == expected;
+			RAPID_CHECK(isOutOfPlaceEqual);
+
+			auto inPlace = source;
+			kernel(inPlace.data() + 1, inPlace.data() + 1, pixelCount);
+
+			const auto isInPlaceEqual = inPlace == expected;
+			RAPID_CHECK(isInPlaceEqual);
+
+			if (!isOutOfPlaceEqual || !isInPlaceEqual)
+				std::fprintf(stderr, "The %s kernel differs from the scalar kernel for %llu pixels.\n", pName, static_cast<unsigned long long>(pixelCount));
+		}
+	}
+
+	/**
+	 * Check the scalar kernels against known values.
+	 */
+	void CheckScalarKernels(const rapid::PixelKernelTable& scalar)
+	{
+		const uint8_t source[8] = { 10, 20, 30, 255, 200, 100, 50, 128 };
+
+		uint8_t swizzled[8] = {};
+		scalar.m_SwizzleRedBlue(swizzled, source, 2);
+
+		const uint8_t expectedSwizzle[8] = { 30, 20, 10, 255, 50, 100, 200, 128 };
+		RAPID_CHECK(std::memcmp(swizzled, expectedSwizzle, sizeof(swizzled)) == 0);
+
+		uint8_t premultiplied[8] = {};
+		scalar.m_PremultiplyAlpha(premultiplied, source, 2);
+
+		// Opaque pixels don't change, and the rest are rounded to the nearest value.
+		const uint8_t expectedPremultiply[8] = { 10, 20, 30, 255, 100, 50, 25, 128 };
+		RAPID_CHECK(std::memcmp(premultiplied, expectedPremultiply, sizeof(premultiplied)) == 0);
+	}
+
+	/**
+	 * Check the sRGB conversions.
+	 * The end points map to themselves, the alpha channel is copied and decoding an encoded value gives it back, within the
+	 * precision which 8 bit sRGB has for the bright values.
+	 */
+	void CheckTransferFunctions()
+	{
+		std::vector<uint8_t> source(256 * 4);
+		for (uint32_t i = 0; i < 256; i++)
+		{
+			source[i * 4 + 0] = static_cast<uint8_t>(i);
+			source[i * 4 + 1] = static_cast<uint8_t>(i);
+			source[i * 4 + 2] = static_cast<uint8_t>(i);
+			source[i * 4 + 3] = static_cast<uint8_t>(255 - i);
+		}
+
+		std::vector<uint8_t> encoded(source.size());
+		std::vector<uint8_t> decoded(source.size());
+		rapid::ConvertLinearToSRGB(encoded.data(), source.data(), 256);
+		rapid::ConvertSRGBToLinear(decoded.data(), encoded.data(), 256);
+
+		RAPID_CHECK(encoded[0] == 0 && encoded[255 * 4] == 255);
+
+		bool isAlphaCopied = true;
+		bool isRoundTripped = true;
+		for (uint32_t i = 0; i < 256; i++)
+		{
+			isAlphaCopied &= encoded[i * 4 + 3] == 255 - i && decoded[i * 4 + 3] == 255 - i;
+
+			isRoundTripped &= std::abs(static_cast<int32_t>(decoded[i * 4]) - static_cast<int32_t>(i)) <= 2;
+		}
+
+		RAPID_CHECK(isAlphaCopied);
+		RAPID_CHECK(isRoundTripped);
+	}
+}
+
+/**
+ * Pixel kernels test.
+ * This compares every vectorized kernel which the CPU supports against the scalar kernel.
+ */
+int main()
+{
+	const auto kernels = rapid::GetSupportedPixelKernels();
+	RAPID_CHECK(!kernels.empty() && std::strcmp(kernels.front().m_pName, "Scalar") == 0);
+
+	const auto& scalar = kernels.front();
+	CheckScalarKernels(scalar);
+
+	for (const auto& kernel : kernels)
+	{
+		std::printf("Checking the %s pixel kernels.\n", kernel.m_pName);
+		CheckKernel(kernel.m_SwizzleRedBlue, scalar.m_SwizzleRedBlue, kernel.m_pName);
+		CheckKernel(kernel.m_PremultiplyAlpha, scalar.m_PremultiplyAlpha, kernel.m_pName);
+	}
+
+	CheckTransferFunctions();
+	return rapid::test::GetExitCode();
+}
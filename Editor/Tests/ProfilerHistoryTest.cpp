@@ -0,0 +1,194 @@
+// Copyright (c) 2022 Dhiraj Wishal
+
+#include "Test.hpp"
+
+#include "Core/ProfilerHistory.hpp"
+
+#include <cmath>
+#include <sstream>
+#include <string>
+#include <vector>
+
+namespace
+{
+	using ScopeResult = rapid::ProfilerHistory::ScopeResult;
+	using FrameResult = rapid::ProfilerHistory::FrameResult;
+
+	/**
+	 * Check if two times are the same, allowing for the rounding of floating point numbers.
+	 *
+	 * @param lhs The first time.
+	 * @param rhs The second time.
+	 * @return Whether or not the times are the same.
+	 */
+	bool IsSameTime(double lhs, double rhs)
+	{
+		return std::abs(lhs - rhs) < 1e-9;
+	}
+
+	/**
+	 * Create a frame with a top level scope and a nested one.
+	 *
+	 * @param frameNumber The frame number.
+	 * @param duration The duration of the top level scope.
+	 * @return The frame.
+	 */
+	FrameResult CreateFrame(uint64_t frameNumber, double duration)
+	{
+		FrameResult frame = { .m_FrameNumber = frameNumber };
+		frame.m_Scopes.emplace_back(ScopeResult{ .m_Name = "Render graph", .m_Duration = duration, .m_Depth = 0 });
+		frame.m_Scopes.emplace_back(ScopeResult{ .m_Name = "ImGui", .m_Duration = duration / 2.0, .m_Depth = 1 });
+		return frame;
+	}
+
+	/**
+	 * Check that the history keeps the recent frames and CPU scopes in order.
+	 */
+	void CheckHistory()
+	{
+		auto history = rapid::ProfilerHistory(3, 2);
+		RAPID_CHECK(history.getFrames().empty());
+		RAPID_CHECK(history.getCpuScopes().empty());
+
+		history.addFrame(CreateFrame(1, 1.0));
+		history.addFrame(CreateFrame(2, 1.0));
+		{
+			const auto frames = history.getFrames();
+			RAPID_CHECK(frames.size() == 2 && frames[0].m_FrameNumber == 1 && frames[1].m_FrameNumber == 2);
+		}
+
+		// The oldest frames are replaced once the history is full.
+		for (uint64_t i = 3; i <= 7; i++)
+			history.addFrame(CreateFrame(i, 1.0));
+
+		{
+			const auto frames = history.getFrames();
+			RAPID_CHECK(frames.size() == 3);
+			RAPID_CHECK(frames[0].m_FrameNumber == 5 && frames[1].m_FrameNumber == 6 && frames[2].m_FrameNumber == 7);
+		}
+
+		history.addCpuScope({ .m_Name = "Build frame", .m_Thread = "UI thread" });
+		history.addCpuScope({ .m_Name = "Pace frame", .m_Thread = "UI thread" });
+		history.addCpuScope({ .m_Name = "Record frame", .m_Thread = "UI thread" });
+
+		const auto cpuScopes = history.getCpuScopes();
+		RAPID_CHECK(cpuScopes.size() == 2 && cpuScopes[0].m_Name == "Pace frame" && cpuScopes[1].m_Name == "Record frame");
+	}
+
+	/**
+	 * Check the scope times which are read from the timestamps.
+	 */
+	void CheckScopeTimes()
+	{
+		std::vector<ScopeResult> scopes(3);
+
+		// A tick is 2 microseconds, and the third scope's end was written before its beginning.
+		const std::vector<uint64_t> timestamps = { 1000, 1500, 1100, 1200, 1600, 1550 };
+		rapid::SetScopeTimes(scopes, timestamps, 2000.0);
+
+		RAPID_CHECK(IsSameTime(scopes[0].m_Start, 0.0) && IsSameTime(scopes[0].m_Duration, 1.0));
+		RAPID_CHECK(IsSameTime(scopes[1].m_Start, 0.2) && IsSameTime(scopes[1].m_Duration, 0.2));
+		RAPID_CHECK(IsSameTime(scopes[2].m_Start, 1.2) && IsSameTime(scopes[2].m_Duration, 0.0));
+
+		// Scopes without enough timestamps are left alone.
+		std::vector<ScopeResult> unmeasured(2, ScopeResult{ .m_Name = "Unmeasured", .m_Duration = 5.0 });
+		rapid::SetScopeTimes(unmeasured, { 1, 2 }, 1.0);
+		RAPID_CHECK(unmeasured[0].m_Duration == 5.0 && unmeasured[1].m_Duration == 5.0);
+	}
+
+	/**
+	 * Check the summaries shown in the profiler panel.
+	 */
+	void CheckSummaries()
+	{
+		RAPID_CHECK(rapid::SummarizeScopes({}).empty());
+
+		std::vector<FrameResult> frames = { CreateFrame(1, 2.0), CreateFrame(2, 4.0), CreateFrame(3, 6.0) };
+
+		// A scope which only the older frames have is left out.
+		frames[0].m_Scopes.emplace_back(ScopeResult{ .m_Name = "Removed node", .m_Duration = 100.0 });
+
+		// A scope with the same name at another depth is a different scope.
+		frames[1].m_Scopes.emplace_back(ScopeResult{ .m_Name = "ImGui", .m_Duration = 10.0, .m_Depth = 0 });
+		frames[2].m_Scopes.emplace_back(ScopeResult{ .m_Name = "ImGui", .m_Duration = 20.0, .m_Depth = 0 });
+
+		// The pipeline statistics are from the latest frame which has them.
+		frames[0].m_Scopes[0].m_PipelineStatistics.m_InputPrimitives = 10;
+		frames[0].m_Scopes[0].m_HasPipelineStatistics = true;
+		frames[1].m_Scopes[0].m_PipelineStatistics.m_InputPrimitives = 20;
+		frames[1].m_Scopes[0].m_HasPipelineStatistics = true;
+
+		const auto summaries = rapid::SummarizeScopes(frames);
+		RAPID_CHECK(summaries.size() == 3);
+		if (summaries.size() != 3)
+			return;
+
+		RAPID_CHECK(summaries[0].m_Name == "Render graph" && summaries[0].m_Depth == 0 && summaries[0].m_Count == 3);
+		RAPID_CHECK(IsSameTime(summaries[0].m_Average, 4.0) && IsSameTime(summaries[0].m_Max, 6.0));
+		RAPID_CHECK(summaries[0].m_HasPipelineStatistics && summaries[0].m_PipelineStatistics.m_InputPrimitives == 20);
+
+		RAPID_CHECK(summaries[1].m_Name == "ImGui" && summaries[1].m_Depth == 1 && summaries[1].m_Count == 3);
+		RAPID_CHECK(IsSameTime(summaries[1].m_Average, 2.0) && IsSameTime(summaries[1].m_Max, 3.0));
+		RAPID_CHECK(!summaries[1].m_HasPipelineStatistics);
+
+		RAPID_CHECK(summaries[2].m_Name == "ImGui" && summaries[2].m_Depth == 0 && summaries[2].m_Count == 2);
+		RAPID_CHECK(IsSameTime(summaries[2].m_Average, 15.0) && IsSameTime(summaries[2].m_Max, 20.0));
+	}
+
+	/**
+	 * Check the trace which is exported.
+	 */
+	void CheckTrace()
+	{
+		using namespace std::chrono_literals;
+
+		const auto startTime = rapid::ProfilerHistory::clock_type::time_point(1s);
+
+		FrameResult frame = { .m_SubmitTime = startTime + 2ms, .m_FrameNumber = 9 };
+		frame.m_Scopes.emplace_back(ScopeResult{ .m_Name = "Pass \"main\"\n", .m_Start = 0.5, .m_Duration = 0.25 });
+		frame.m_Scopes.back().m_PipelineStatistics.m_FragmentShaderInvocations = 42;
+		frame.m_Scopes.back().m_HasPipelineStatistics = true;
+
+		const std::vector<rapid::ProfilerHistory::CpuScope> cpuScopes = {
+			{ .m_Name = "Build frame", .m_Thread = "UI thread", .m_Start = startTime + 1ms, .m_End = startTime + 3ms },
+			{ .m_Name = "Record frame", .m_Thread = "Render thread", .m_Start = startTime + 2ms, .m_End = startTime + 4ms },
+			{ .m_Name = "Pace frame", .m_Thread = "UI thread", .m_Start = startTime + 3ms, .m_End = startTime + 5ms }
+		};
+
+		auto stream = std::ostringstream();
+		stream << 1.5 << ' ';
+		rapid::WriteProfilerTrace(stream, { frame }, cpuScopes, startTime);
+
+		// The stream's formatting is put back once the trace is written.
+		stream << 1.5;
+
+		const auto trace = stream.str();
+		const auto contains = [&trace](const char* pText) { return trace.find(pText) != std::string::npos; };
+
+		RAPID_CHECK(trace.starts_with("1.5 {\"traceEvents\":[\n"));
+		RAPID_CHECK(trace.ends_with("\n]}\n1.5"));
+
+		// The CPU threads are numbered in the order they show up, after the GPU.
+		RAPID_CHECK(contains("{\"name\":\"Build frame\",\"cat\":\"CPU\",\"ph\":\"X\",\"pid\":0,\"tid\":1,\"ts\":1000.000,\"dur\":2000.000}"));
+		RAPID_CHECK(contains("{\"name\":\"Record frame\",\"cat\":\"CPU\",\"ph\":\"X\",\"pid\":0,\"tid\":2,\"ts\":2000.000,\"dur\":2000.000}"));
+		RAPID_CHECK(contains("{\"name\":\"Pace frame\",\"cat\":\"CPU\",\"ph\":\"X\",\"pid\":0,\"tid\":1,\"ts\":3000.000,\"dur\":2000.000}"));
+
+		// The GPU scopes are placed from the submit time, and their names are escaped.
+		RAPID_CHECK(contains("{\"name\":\"Pass \\\"main\\\"\",\"cat\":\"GPU\",\"ph\":\"X\",\"pid\":0,\"tid\":0,\"ts\":2500.000,\"dur\":250.000,\"args\":{\"frame\":9,"));
+		RAPID_CHECK(contains("\"fragment shader invocations\":42}}"));
+
+		RAPID_CHECK(contains("{\"name\":\"thread_name\",\"ph\":\"M\",\"pid\":0,\"tid\":0,\"args\":{\"name\":\"GPU\"}}"));
+		RAPID_CHECK(contains("{\"name\":\"thread_name\",\"ph\":\"M\",\"pid\":0,\"tid\":1,\"args\":{\"name\":\"UI thread\"}}"));
+		RAPID_CHECK(contains("{\"name\":\"thread_name\",\"ph\":\"M\",\"pid\":0,\"tid\":2,\"args\":{\"name\":\"Render thread\"}}"));
+	}
+}
+
+int main()
+{
+	CheckHistory();
+	CheckScopeTimes();
+	CheckSummaries();
+	CheckTrace();
+
+	return rapid::test::GetExitCode();
+}
\ No newline at end of file
@@ -0,0 +1,274 @@
+// Copyright (c) 2022 Dhiraj Wishal
+
+#include "Test.hpp"
+
+#include "Core/Rasterizer.hpp"
+
+#include <cmath>
+#include <cstdio>
+#include <cstdlib>
+#include <random>
+#include <vector>
+
+namespace
+{
+	constexpr int32_t Width = 37;
+	constexpr int32_t Height = 20;
+
+	/**
+	 * The spans are split at this column, like they are at the tile borders.
+	 */
+	constexpr int32_t TileBorder = 16;
+
+	constexpr uint32_t WhitePixel = 0xFFFFFFFF;
+	constexpr uint32_t ClearColor = 0xFF102030;
+
+	/**
+	 * Image structure.
+	 */
+	struct Image final
+	{
+		std::vector<uint32_t> m_Pixels = std::vector<uint32_t>(Width * Height, ClearColor);
+
+		uint32_t& at(int32_t x, int32_t y) { return m_Pixels[y * Width + x]; }
+	};
+
+	/**
+	 * Create a rectangle out of two triangles.
+	 *
+	 * @param minX The left edge.
+	 * @param minY The top edge.
+	 * @param maxX The right edge.
+	 * @param maxY The bottom edge.
+	 * @param color The vertex color.
+	 * @return The vertices of the two triangles.
+	 */
+	std::vector<rapid::RasterVertex> CreateRectangle(float minX, float minY, float maxX, float maxY, uint32_t color)
+	{
+		const auto topLeft = rapid::RasterVertex{ .m_X = minX, .m_Y = minY, .m_U = 0.0f, .m_V = 0.0f, .m_Color = color };
+		const auto topRight = rapid::RasterVertex{ .m_X = maxX, .m_Y = minY, .m_U = 1.0f, .m_V = 0.0f, .m_Color = color };
+		const auto bottomLeft = rapid::RasterVertex{ .m_X = minX, .m_Y = maxY, .m_U = 0.0f, .m_V = 1.0f, .m_Color = color };
+		const auto bottomRight = rapid::RasterVertex{ .m_X = maxX, .m_Y = maxY, .m_U = 1.0f, .m_V = 1.0f, .m_Color = color };
+
+		return { topLeft, topRight, bottomRight, topLeft, bottomRight, bottomLeft };
+	}
+
+	/**
+	 * Draw triangles to an image.
+	 *
+	 * @param image The image to draw to.
+	 * @param kernel The span kernel.
+	 * @param vertices The vertices, three per triangle.
+	 * @param texture The texture.
+	 */
+	void Draw(Image& image, const rapid::SpanKernel& kernel, const std::vector<rapid::RasterVertex>& vertices, const rapid::RasterTexture& texture)
+	{
+		for (uint64_t i = 0; i + 2 < vertices.size(); i += 3)
+		{
+			const rapid::RasterVertex triangleVertices[3] = { vertices[i], vertices[i + 1], vertices[i + 2] };
+
+			auto triangle = rapid::RasterTriangle{ .m_MinX = 0, .m_MinY = 0, .m_MaxX = Width, .m_MaxY = Height };
+			if (!rapid::SetupRasterTriangle(triangle, triangleVertices))
+				continue;
+
+			for (auto y = triangle.m_MinY; y < triangle.m_MaxY; y++)
+			{
+				const auto pRow = image.m_Pixels.data() + y * Width;
+				if (triangle.m_MinX < TileBorder)
+					kernel.m_Function(triangle, texture, pRow, triangle.m_MinX, std::min(triangle.m_MaxX, TileBorder), y);
+
+				if (triangle.m_MaxX > TileBorder)
+					kernel.m_Function(triangle, texture, pRow, std::max(triangle.m_MinX, TileBorder), triangle.m_MaxX, y);
+			}
+		}
+	}
+
+	/**
+	 * Blend a color over another one, the way the Vulkan pipeline does.
+	 *
+	 * @param source The source color.
+	 * @param destination The destination color.
+	 * @return The blended color.
+	 */
+	uint32_t Blend(uint32_t source, uint32_t destination)
+	{
+		const auto alpha = static_cast<double>(source >> 24) / 255.0;
+
+		uint32_t result = 0;
+		for (uint32_t shift = 0; shift < 24; shift += 8)
+		{
+			const auto value = static_cast<double>((source >> shift) & 0xFF) * alpha + static_cast<double>((destination >> shift) & 0xFF) * (1.0 - alpha);
+			result |= static_cast<uint32_t>(std::lround(value)) << shift;
+		}
+
+		return result | static_cast<uint32_t>(std::lround(255.0 * alpha + static_cast<double>(destination >> 24) * (1.0 - alpha))) << 24;
+	}
+
+	/**
+	 * Check if two colors are the same, allowing for a rounding difference of one in each channel.
+	 *
+	 * @param lhs The first color.
+	 * @param rhs The second color.
+	 * @return Whether or not the colors are the same.
+	 */
+	bool IsSameColor(uint32_t lhs, uint32_t rhs)
+	{
+		for (uint32_t shift = 0; shift < 32; shift += 8)
+		{
+			if (std::abs(static_cast<int32_t>((lhs >> shift) & 0xFF) - static_cast<int32_t>((rhs >> shift) & 0xFF)) > 1)
+				return false;
+		}
+
+		return true;
+	}
+
+	/**
+	 * Check an image against the expected one.
+	 *
+	 * @param image The image.
+	 * @param expected The expected image.
+	 * @param pName The kernel name.
+	 * @param pScene The scene name.
+	 */
+	void CheckImage(const Image& image, const Image& expected, const char* pName, const char* pScene)
+	{
+		for (int32_t i = 0; i < Width * Height; i++)
+		{
+			if (!IsSameColor(image.m_Pixels[i], expected.m_Pixels[i]))
+			{
+				std::fprintf(stderr, "The %s kernel drew %08X instead of %08X at (%d, %d) in the %s scene.\n", pName, image.m_Pixels[i], expected.m_Pixels[i], i % Width, i / Width, pScene);
+				RAPID_CHECK(false);
+				return;
+			}
+		}
+	}
+
+	/**
+	 * Check a kernel against known images.
+	 *
+	 * @param kernel The kernel to check.
+	 */
+	void CheckKnownImages(const rapid::SpanKernel& kernel)
+	{
+		const auto white = rapid::RasterTexture{ .m_pPixels = &WhitePixel, .m_Width = 1, .m_Height = 1 };
+
+		// An opaque rectangle covers the pixels whose centers are inside it.
+		{
+			auto image = Image();
+			Draw(image, kernel, CreateRectangle(3.0f, 2.0f, 30.0f, 15.0f, 0xFF336699), white);
+
+			auto expected = Image();
+			for (int32_t y = 2; y < 15; y++)
+				for (int32_t x = 3; x < 30; x++)
+					expected.at(x, y) = 0xFF336699;
+
+			CheckImage(image, expected, kernel.m_pName, "opaque rectangle");
+		}
+
+		// A translucent rectangle is blended once everywhere, including the pixels on the shared diagonal.
+		{
+			auto image = Image();
+			Draw(image, kernel, CreateRectangle(0.5f, 1.25f, 35.5f, 18.75f, 0x80336699), white);
+
+			auto expected = Image();
+			for (int32_t y = 1; y < 19; y++)
+				for (int32_t x = 0; x < 35; x++)
+					expected.at(x, y) = Blend(0x80336699, ClearColor);
+
+			CheckImage(image, expected, kernel.m_pName, "translucent rectangle");
+		}
+
+		// A texture is sampled using the nearest texel, and multiplied by the vertex color.
+		{
+			const uint32_t texels[8] = {
+				0xFF0000FF, 0xFF00FF00, 0xFFFF0000, 0xFFFFFFFF,
+				0xFF000000, 0x80FF00FF, 0x00FFFFFF, 0xFF808080
+			};
+
+			const auto texture = rapid::RasterTexture{ .m_pPixels = texels, .m_Width = 4, .m_Height = 2 };
+
+			auto image = Image();
+			Draw(image, kernel, CreateRectangle(8.0f, 4.0f, 24.0f, 8.0f, 0xFFFFFFFF), texture);
+
+			auto expected = Image();
+			for (int32_t y = 4; y < 8; y++)
+				for (int32_t x = 8; x < 24; x++)
+					expected.at(x, y) = Blend(texels[(y - 4) / 2 * 4 + (x - 8) / 4], ClearColor);
+
+			CheckImage(image, expected, kernel.m_pName, "textured rectangle");
+		}
+
+		// Overlapping triangles are blended in their order.
+		{
+			auto vertices = CreateRectangle(2.0f, 2.0f, 20.0f, 12.0f, 0xFF0000FF);
+			const auto overlay = CreateRectangle(10.0f, 6.0f, 36.0f, 19.0f, 0x40FF8000);
+			vertices.insert(vertices.end(), overlay.begin(), overlay.end());
+
+			auto image = Image();
+			Draw(image, kernel, vertices, white);
+
+			auto expected = Image();
+			for (int32_t y = 2; y < 12; y++)
+				for (int32_t x = 2; x < 20; x++)
+					expected.at(x, y) = 0xFF0000FF;
+
+			for (int32_t y = 6; y < 19; y++)
+				for (int32_t x = 10; x < 36; x++)
+					expected.at(x, y) = Blend(0x40FF8000, expected.at(x, y));
+
+			CheckImage(image, expected, kernel.m_pName, "overlapping rectangles");
+		}
+	}
+
+	/**
+	 * Check a kernel against the scalar one.
+	 * Random triangles are drawn over each other, some of them partly outside the image, so every lane and tail is used.
+	 *
+	 * @param kernel The kernel to check.
+	 * @param scalar The scalar kernel.
+	 */
+	void CheckAgainstScalar(const rapid::SpanKernel& kernel, const rapid::SpanKernel& scalar)
+	{
+		auto engine = std::mt19937(1234);
+		auto positionX = std::uniform_real_distribution<float>(-8.0f, Width + 8.0f);
+		auto positionY = std::uniform_real_distribution<float>(-8.0f, Height + 8.0f);
+		auto coordinate = std::uniform_real_distribution<float>(-0.25f, 1.25f);
+		auto color = std::uniform_int_distribution<uint32_t>();
+
+		std::vector<uint32_t> texels(5 * 3);
+		for (auto& texel : texels)
+			texel = color(engine);
+
+		const auto texture = rapid::RasterTexture{ .m_pPixels = texels.data(), .m_Width = 5, .m_Height = 3 };
+
+		std::vector<rapid::RasterVertex> vertices(3 * 200);
+		for (auto& vertex : vertices)
+			vertex = rapid::RasterVertex{ .m_X = positionX(engine), .m_Y = positionY(engine), .m_U = coordinate(engine), .m_V = coordinate(engine), .m_Color = color(engine) };
+
+		auto expected = Image();
+		Draw(expected, scalar, vertices, texture);
+
+		auto image = Image();
+		Draw(image, kernel, vertices, texture);
+
+		const auto isEqual = image.m_Pixels == expected.m_Pixels;
+		RAPID_CHECK(isEqual);
+
+		if (!isEqual)
+			std::fprintf(stderr, "The %s kernel differs from the scalar kernel.\n", kernel.m_pName);
+	}
+}
+
+int main()
+{
+	const auto kernels = rapid::GetSupportedSpanKernels();
+	RAPID_CHECK(!kernels.empty());
+
+	for (const auto& kernel : kernels)
+	{
+		CheckKnownImages(kernel);
+		CheckAgainstScalar(kernel, kernels.front());
+	}
+
+	return rapid::test::GetExitCode();
+}
\ No newline at end of file
@@ -0,0 +1,135 @@
+// Copyright (c) 2022 Dhiraj Wishal
+
+#include "Test.hpp"
+
+#include "Core/SkylinePacker.hpp"
+
+#include <random>
+#include <vector>
+
+namespace
+{
+	/**
+	 * Check if two rectangles overlap.
+	 *
+	 * @param lhs The first rectangle.
+	 * @param rhs The second rectangle.
+	 * @return Whether or not they overlap.
+	 */
+	bool IsOverlapping(const rapid::PackedRect& lhs, const rapid::PackedRect& rhs)
+	{
+		return lhs.m_X < rhs.m_X + rhs.m_Width && rhs.m_X < lhs.m_X + lhs.m_Width
+			&& lhs.m_Y < rhs.m_Y + rhs.m_Height && rhs.m_Y < lhs.m_Y + lhs.m_Height;
+	}
+
+	/**
+	 * Check the simple cases.
+	 * The first rectangle goes to the origin, rectangles larger than the area don't fit and the whole area can be filled.
+	 */
+	void CheckSimpleCases()
+	{
+		auto packer = rapid::SkylinePacker(64, 64);
+		rapid::PackedRect rect = {};
+
+		RAPID_CHECK(packer.pack(16, 8, rect));
+		RAPID_CHECK(rect.m_X == 0 && rect.m_Y == 0 && rect.m_Width == 16 && rect.m_Height == 8);
+
+		// The next one goes next to it, on the lowest part of the skyline.
+		RAPID_CHECK(packer.pack(16, 16, rect));
+		RAPID_CHECK(rect.m_X == 16 && rect.m_Y == 0);
+
+		RAPID_CHECK(!packer.pack(65, 1, rect));
+		RAPID_CHECK(!packer.pack(1, 65, rect));
+		RAPID_CHECK(packer.usedArea() == 16 * 8 + 16 * 16);
+
+		// After clearing, the whole area is available again and can be filled exactly.
+		packer.clear();
+		RAPID_CHECK(packer.usedArea() == 0);
+
+		for (uint32_t i = 0; i < 16; i++)
+			RAPID_CHECK(packer.pack(16, 16, rect));
+
+		RAPID_CHECK(packer.usedArea() == 64 * 64);
+		RAPID_CHECK(!packer.pack(1, 1, rect));
+	}
+
+	/**
+	 * Pack random rectangles till the area is full, and check that none of them overlap or leave the area.
+	 */
+	void CheckRandomRectangles()
+	{
+		constexpr uint32_t AreaSize = 512;
+
+		auto engine = std::mt19937(42);
+		auto distribution = std::uniform_int_distribution<uint32_t>(1, 48);
+
+		auto packer = rapid::SkylinePacker(AreaSize, AreaSize);
+		std::vector<rapid::PackedRect> rects;
+
+		uint64_t area = 0;
+		uint32_t failureCount = 0;
+		while (failureCount < 32)
+		{
+			rapid::PackedRect rect = {};
+			const auto width = distribution(engine);
+			const auto height = distribution(engine);
+
+			if (!packer.pack(width, height, rect))
+			{
+				failureCount++;
+				continue;
+			}
+
+			RAPID_CHECK(rect.m_Width == width && rect.m_Height == height);
+			RAPID_CHECK(rect.m_X + rect.m_Width <= AreaSize && rect.m_Y + rect.m_Height <= AreaSize);
+
+			rects.emplace_back(rect);
+			area += static_cast<uint64_t>(width) * height;
+		}
+
+		bool isOverlapping = false;
+		for (uint64_t i = 0; i < rects.size(); i++)
+		{
+			for (uint64_t j = i + 1; j < rects.size(); j++)
+				isOverlapping |= IsOverlapping(rects[i], rects[j]);
+		}
+
+		RAPID_CHECK(!isOverlapping);
+		RAPID_CHECK(packer.usedArea() == area);
+
+		// The skyline wastes the space under the overhangs, but it should still fill most of the area.
+		RAPID_CHECK(area * 10 >= static_cast<uint64_t>(AreaSize) * AreaSize * 7);
+		std::printf("Packed %llu rectangles covering %.1f%% of the area.\n", static_cast<unsigned long long>(rects.size()), 100.0 * area / (AreaSize * AreaSize));
+	}
+
+	/**
+	 * Packing is deterministic, so packing the same rectangles again gives the same places.
+	 * The texture atlas relies on this when it defragments a page.
+	 */
+	void CheckDeterminism()
+	{
+		const uint32_t sizes[][2] = { { 30, 12 }, { 7, 40 }, { 25, 25 }, { 64, 3 }, { 9, 9 }, { 18, 33 } };
+
+		auto first = rapid::SkylinePacker(100, 100);
+		auto second = rapid::SkylinePacker(100, 100);
+		for (const auto& size : sizes)
+		{
+			rapid::PackedRect lhs = {}, rhs = {};
+			RAPID_CHECK(first.pack(size[0], size[1], lhs));
+			RAPID_CHECK(second.pack(size[0], size[1], rhs));
+			RAPID_CHECK(lhs.m_X == rhs.m_X && lhs.m_Y == rhs.m_Y);
+		}
+	}
+}
+
+/**
+ * Skyline packer test.
+ */
+int main()
+{
+	CheckSimpleCases();
+	CheckRandomRectangles();
+	CheckDeterminism();
+
+	return rapid::test::GetExitCode();
+}
@@ -0,0 +1,64 @@
+// Copyright (c) 2022 Dhiraj Wishal
+
+#pragma once
+
+#include <cstdint>
+#include <cstdio>
+
+namespace rapid
+{
+	namespace test
+	{
+		/**
+		 * Get the number of failed checks.
+		 *
+		 * @return The failure count reference.
+		 */
+		inline uint32_t& GetFailureCount()
+		{
+			static uint32_t failureCount = 0;
+			return failureCount;
+		}
+
+		/**
+		 * Record the result of a check.
+		 *
+		 * @param isPassed Whether or not the check passed.
+		 * @param pExpression The checked expression.
+		 * @param pFile The file of the check.
+		 * @param line The line of the check.
+		 */
+		inline void Check(bool isPassed, const char* pExpression, const char* pFile, int32_t line)
+		{
+			if (isPassed)
+				return;
+
+			std::fprintf(stderr, "%s(%d): Check failed: %s\n", pFile, line, pExpression);
+			GetFailureCount()++;
+		}
+
+		/**
+		 * Get the exit code of the test.
+		 * This also prints a summary.
+		 *
+		 * @return The exit code. This is 0 if all the checks passed.
+		 */
+		inline int32_t GetExitCode()
+		{
+			if (GetFailureCount() == 0)
+			{
+				std::printf("All checks passed.\n");
+				return 0;
+			}
+
+			std::printf("%u check(s) failed.\n", GetFailureCount());
+			return 1;
+		}
+	}
+}
+
+/**
+ * Check if an expression is true.
+ * Failing checks are printed, and the test keeps going so all the failures are reported at once.
+ */
+#define RAPID_CHECK(expression) ::rapid::test::Check(static_cast<bool>(expression), #expression, __FILE__, __LINE__)
@@ -0,0 +1,108 @@
+// Copyright (c) 2022 Dhiraj Wishal
+
+#include "Test.hpp"
+
+#include "Core/ThreadPool.hpp"
+
+#include <atomic>
+#include <future>
+#include <latch>
+#include <vector>
+
+namespace
+{
+	/**
+	 * Check that high priority tasks are started before the normal ones which were queued earlier.
+	 * The viewports are recorded as high priority tasks, so they don't wait behind background work like image decoding.
+	 */
+	void CheckPriorityOrder()
+	{
+		auto pool = rapid::ThreadPool(1);
+
+		// Keep the only worker busy till every task is queued.
+		auto gate = std::promise<void>();
+		auto started = std::promise<void>();
+		pool.submit([&gate, &started]
+			{
+				started.set_value();
+				gate.get_future().wait();
+			}
+		);
+
+		started.get_future().wait();
+
+		std::vector<int32_t> order;
+		auto latch = std::latch(5);
+		const auto push = [&order, &latch](int32_t value)
+		{
+			return [&order, &latch, value]
+			{
+				order.emplace_back(value);
+				latch.count_down();
+			};
+		};
+
+		pool.submit(push(1));
+		pool.submit(push(2));
+		pool.submit(push(10), rapid::TaskPriority::High);
+		pool.submit(push(3));
+		pool.submit(push(20), rapid::TaskPriority::High);
+
+		gate.set_value();
+		latch.wait();
+
+		// There's a single worker, so the tasks run one after another.
+		RAPID_CHECK((order == std::vector<int32_t>{ 10, 20, 1, 2, 3 }));
+	}
+
+	/**
+	 * Check that tasks fanned out over the pool all run, and can be joined with a latch.
+	 * This is how the window records its viewports while it records itself.
+	 */
+	void CheckFanOut()
+	{
+		constexpr uint32_t TaskCount = 64;
+
+		auto pool = rapid::ThreadPool(4);
+		RAPID_CHECK(pool.threadCount() == 4);
+
+		// Every task writes to its own slot, like every viewport records to its own command pool.
+		std::vector<uint32_t> results(TaskCount);
+		auto runCount = std::atomic<uint32_t>(0);
+		auto latch = std::latch(TaskCount);
+
+		for (uint32_t i = 0; i < TaskCount; i++)
+		{
+			pool.submit([&results, &runCount, &latch, i]
+				{
+					results[i] = i * i;
+					runCount.fetch_add(1, std::memory_order_relaxed);
+					latch.count_down();
+				}, rapid::TaskPriority::High);
+		}
+
+		latch.wait();
+		RAPID_CHECK(runCount.load() == TaskCount);
+
+		for (uint32_t i = 0; i < TaskCount; i++)
+			RAPID_CHECK(results[i] == i * i);
+	}
+
+	/**
+	 * Check that a pool created without a thread count has at least one worker.
+	 */
+	void CheckDefaultThreadCount()
+	{
+		auto pool = rapid::ThreadPool();
+		RAPID_CHECK(pool.threadCount() >= 1);
+	}
+}
+
+int main()
+{
+	CheckPriorityOrder();
+	CheckFanOut();
+	CheckDefaultThreadCount();
+
+	return rapid::test::GetExitCode();
+}
\ No newline at end of file